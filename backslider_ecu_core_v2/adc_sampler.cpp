@@ -0,0 +1,261 @@
+// adc_sampler.cpp
+// Interrupt-chained, double-buffered ADC scanning
+
+#include "adc_sampler.h"
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+    // Pin to ADC channel map from the Teensy core (analog.c): bit 7 set = ADC2 only, 255 = not analog
+    extern const uint8_t pin_to_channel[];
+    #define ADC_SAMPLER_HIGHEST_PIN 41
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+// Scan list for one ADC instance
+typedef struct {
+    uint8_t slots[ADC_SAMPLER_MAX_PINS];    // Sample slots converted by this ADC, in scan order
+    uint8_t channels[ADC_SAMPLER_MAX_PINS]; // Matching hardware channel numbers
+    uint8_t count;
+    volatile uint8_t position;              // Next entry to convert in the running scan
+} adc_scan_list_t;
+
+static uint8_t sampled_pins[ADC_SAMPLER_MAX_PINS];
+static uint8_t sampled_pin_count = 0;
+
+static adc_scan_list_t adc1_list;
+static adc_scan_list_t adc2_list;
+
+// Double buffer: ISRs fill samples[back], readers use samples[front]
+static volatile uint16_t samples[2][ADC_SAMPLER_MAX_PINS];
+static volatile uint8_t front_buffer = 0;
+static volatile uint8_t adcs_busy = 0;          // ADCs still converting in the current scan
+static volatile uint32_t scan_count = 0;
+static volatile uint32_t overrun_count = 0;
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static int16_t find_slot(uint8_t pin) {
+    for (uint8_t i = 0; i < sampled_pin_count; i++) {
+        if (sampled_pins[i] == pin) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Called (in ISR context on hardware) when one ADC finishes its part of a scan
+static void finish_adc_scan(void) {
+    if (--adcs_busy == 0) {
+        front_buffer ^= 1;
+        scan_count++;
+    }
+}
+
+#ifdef ARDUINO
+
+static IntervalTimer scan_timer;
+static bool scan_timer_running = false;
+
+static void adc1_complete_isr(void) {
+    uint8_t back = front_buffer ^ 1;
+    uint8_t pos = adc1_list.position;
+    samples[back][adc1_list.slots[pos]] = (uint16_t)ADC1_R0;  // Reading R0 clears COCO
+    if (++pos < adc1_list.count) {
+        adc1_list.position = pos;
+        ADC1_HC0 = ADC_HC_AIEN | adc1_list.channels[pos];
+    } else {
+        finish_adc_scan();
+    }
+}
+
+static void adc2_complete_isr(void) {
+    uint8_t back = front_buffer ^ 1;
+    uint8_t pos = adc2_list.position;
+    samples[back][adc2_list.slots[pos]] = (uint16_t)ADC2_R0;
+    if (++pos < adc2_list.count) {
+        adc2_list.position = pos;
+        ADC2_HC0 = ADC_HC_AIEN | adc2_list.channels[pos];
+    } else {
+        finish_adc_scan();
+    }
+}
+
+// Timer ISR: start the next scan on both ADCs
+static void start_scan_isr(void) {
+    static uint8_t busy_ticks = 0;
+    if (adcs_busy != 0) {
+        overrun_count++;
+        // A scan normally takes a fraction of a period; if a completion was
+        // lost (someone else wrote HCn) restart instead of stalling forever
+        if (++busy_ticks < 4) {
+            return;
+        }
+    }
+    busy_ticks = 0;
+
+    adcs_busy = (adc1_list.count > 0 ? 1 : 0) + (adc2_list.count > 0 ? 1 : 0);
+    if (adc1_list.count > 0) {
+        adc1_list.position = 0;
+        ADC1_HC0 = ADC_HC_AIEN | adc1_list.channels[0];
+    }
+    if (adc2_list.count > 0) {
+        adc2_list.position = 0;
+        ADC2_HC0 = ADC_HC_AIEN | adc2_list.channels[0];
+    }
+}
+
+static void start_scanning(void) {
+    if (scan_timer_running) {
+        return;
+    }
+
+    // One priority for the timer and both ADC interrupts, so they never
+    // preempt each other and the busy count needs no locking
+    attachInterruptVector(IRQ_ADC1, adc1_complete_isr);
+    attachInterruptVector(IRQ_ADC2, adc2_complete_isr);
+    NVIC_SET_PRIORITY(IRQ_ADC1, 128);
+    NVIC_SET_PRIORITY(IRQ_ADC2, 128);
+    NVIC_ENABLE_IRQ(IRQ_ADC1);
+    NVIC_ENABLE_IRQ(IRQ_ADC2);
+
+    scan_timer.priority(128);
+    scan_timer_running = scan_timer.begin(start_scan_isr, ADC_SAMPLER_SCAN_PERIOD_US);
+}
+
+static void stop_scanning(void) {
+    if (!scan_timer_running) {
+        return;
+    }
+    scan_timer.end();
+    scan_timer_running = false;
+
+    // Let a scan in flight finish (a few conversions) so no completion
+    // interrupt fires later against an edited scan list. A lost completion
+    // never clears the busy count, so give up after a scan period.
+    uint32_t start_us = micros();
+    while (adcs_busy != 0 && (micros() - start_us) < ADC_SAMPLER_SCAN_PERIOD_US) {
+    }
+    NVIC_DISABLE_IRQ(IRQ_ADC1);
+    NVIC_DISABLE_IRQ(IRQ_ADC2);
+    if (adcs_busy != 0) {
+        // Abort whatever is converting (ADCH = 31 disables conversion)
+        ADC1_HC0 = 0x1F;
+        ADC2_HC0 = 0x1F;
+        NVIC_CLEAR_PENDING(IRQ_ADC1);
+        NVIC_CLEAR_PENDING(IRQ_ADC2);
+        adcs_busy = 0;
+    }
+}
+
+#endif
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void adc_sampler_init(void) {
+    #ifdef ARDUINO
+    stop_scanning();
+    #endif
+
+    sampled_pin_count = 0;
+    adc1_list.count = 0;
+    adc1_list.position = 0;
+    adc2_list.count = 0;
+    adc2_list.position = 0;
+    front_buffer = 0;
+    adcs_busy = 0;
+    scan_count = 0;
+    overrun_count = 0;
+}
+
+bool adc_sampler_add_pin(uint8_t pin) {
+    if (find_slot(pin) >= 0) {
+        return true;
+    }
+    if (sampled_pin_count >= ADC_SAMPLER_MAX_PINS) {
+        return false;
+    }
+
+    #ifdef ARDUINO
+    if (pin > ADC_SAMPLER_HIGHEST_PIN) {
+        return false;
+    }
+    uint8_t channel = pin_to_channel[pin];
+    if (channel == 255) {
+        return false;
+    }
+    // Pins available on both ADCs use ADC1 (as analogRead does)
+    adc_scan_list_t* list = (channel & 0x80) ? &adc2_list : &adc1_list;
+    channel &= 0x7F;
+
+    // Scan lists are read by the ISRs - pause scanning while editing them
+    stop_scanning();
+    #else
+    uint8_t channel = pin;
+    adc_scan_list_t* list = &adc1_list;
+    #endif
+
+    uint8_t slot = sampled_pin_count++;
+    sampled_pins[slot] = pin;
+    list->slots[list->count] = slot;
+    list->channels[list->count] = channel;
+    list->count++;
+
+    // Previous scans did not include this pin
+    scan_count = 0;
+
+    #ifdef ARDUINO
+    start_scanning();
+    #endif
+    return true;
+}
+
+bool adc_sampler_get(uint8_t pin, uint16_t* counts) {
+    if (scan_count == 0) {
+        return false;
+    }
+    int16_t slot = find_slot(pin);
+    if (slot < 0) {
+        return false;
+    }
+    *counts = samples[front_buffer][slot];
+    return true;
+}
+
+bool adc_sampler_is_sampled(uint8_t pin) {
+    return find_slot(pin) >= 0;
+}
+
+uint8_t adc_sampler_get_pin_count(void) {
+    return sampled_pin_count;
+}
+
+uint32_t adc_sampler_get_scan_count(void) {
+    return scan_count;
+}
+
+uint32_t adc_sampler_get_overrun_count(void) {
+    return overrun_count;
+}
+
+#ifdef TESTING
+void adc_sampler_complete_scan_for_testing(void) {
+    if (adc1_list.count == 0) {
+        return;
+    }
+    adcs_busy = 1;
+    uint8_t back = front_buffer ^ 1;
+    for (uint8_t i = 0; i < adc1_list.count; i++) {
+        samples[back][adc1_list.slots[i]] = mock_get_analog_reading(adc1_list.channels[i]);   // DMA: no CPU time
+    }
+    finish_adc_scan();
+}
+#endif
@@ -0,0 +1,73 @@
+// adc_sampler.h
+// Background ADC acquisition for on-chip analog inputs
+
+/* =============================================================================
+ * ADC SAMPLER OVERVIEW
+ * =============================================================================
+ *
+ * analogRead() busy-waits for each conversion (10-20 µs on Teensy 4.1), so a
+ * dozen analog sensors cost a few hundred microseconds of main-loop time. The
+ * sampler moves acquisition out of the loop:
+ *
+ * - An IntervalTimer starts a scan of every registered pin each
+ *   ADC_SAMPLER_SCAN_PERIOD_US, so sample timing is fixed and independent of
+ *   loop jitter.
+ * - Each scan is a conversion-complete interrupt chain: the ADC ISR stores a
+ *   result and starts the next channel. ADC1 and ADC2 scan their own pins in
+ *   parallel. No CPU time is spent waiting for conversions.
+ * - Results land in the back half of a double buffer; when both ADCs finish
+ *   the buffers are swapped, so readers always see one complete scan.
+ *
+ * input_manager registers SENSOR_ANALOG_LINEAR / SENSOR_THERMISTOR pins and
+ * reads the latest counts with adc_sampler_get(). Pins the sampler could
+ * not take still use analogRead(); sampled pins skip updates until the first
+ * scan completes (about one scan period after registration).
+ *
+ * While the sampler is running it owns both ADCs: nothing else may call
+ * analogRead() on ADC pins.
+ *
+ * Hardware note: the i.MX RT ADC_ETC + DMA path would also remove the
+ * per-conversion interrupt. The interrupt chain was chosen because it gives
+ * the same loop-side cost (none) with plain register access and no extra
+ * library; conversions still happen entirely in hardware.
+ * =============================================================================
+ */
+
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <stdint.h>
+
+#define ADC_SAMPLER_MAX_PINS        24      // Sampled pins across both ADCs
+#define ADC_SAMPLER_SCAN_PERIOD_US  1000    // One full scan per millisecond
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Stop scanning and forget all pins
+void adc_sampler_init(void);
+
+// Add a pin to the scan list and (re)start scanning on hardware.
+// Returns false if the pin is not an on-chip ADC pin or the list is full.
+// Adding a pin twice is a no-op that returns true.
+bool adc_sampler_add_pin(uint8_t pin);
+
+// Latest counts for a pin from the most recent complete scan.
+// Returns false if the pin is not sampled or no scan has completed yet.
+bool adc_sampler_get(uint8_t pin, uint16_t* counts);
+
+// True if the pin is in the scan list (whether or not a scan has completed)
+bool adc_sampler_is_sampled(uint8_t pin);
+
+// Diagnostics
+uint8_t adc_sampler_get_pin_count(void);
+uint32_t adc_sampler_get_scan_count(void);      // Completed scans
+uint32_t adc_sampler_get_overrun_count(void);   // Scan starts skipped because the previous scan was still running
+
+#ifdef TESTING
+// Run one complete scan synchronously with the mocked analogRead()
+void adc_sampler_complete_scan_for_testing(void);
+#endif
+
+#endif
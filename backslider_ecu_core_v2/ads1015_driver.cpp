@@ -0,0 +1,319 @@
+// ads1015_driver.cpp
+// Continuous-conversion ADS1015 state machine with per-channel result cache
+
+#include "ads1015_driver.h"
+#include "i2c_bus.h"
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+// =============================================================================
+// REGISTER DEFINITIONS
+// =============================================================================
+
+#define ADS1015_REG_CONVERSION      0x00
+#define ADS1015_REG_CONFIG          0x01
+#define ADS1015_REG_LO_THRESH       0x02
+#define ADS1015_REG_HI_THRESH       0x03
+
+#define ADS1015_MUX_SINGLE_0        0x4000  // AINx vs GND: 0x4000 + (x << 12)
+#define ADS1015_PGA_6_144V          0x0000
+#define ADS1015_MODE_CONTINUOUS     0x0000
+#define ADS1015_DR_3300SPS          0x00E0
+#define ADS1015_COMP_QUE_1CONV      0x0000  // ALERT/RDY pulses after every conversion
+#define ADS1015_COMP_QUE_DISABLE    0x0003
+
+// Lo_thresh MSB clear and Hi_thresh MSB set turn ALERT/RDY into a ready signal
+#define ADS1015_READY_LO_THRESH     0x0000
+#define ADS1015_READY_HI_THRESH     0x8000
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+typedef enum {
+    ADS_STATE_IDLE,     // Not started or no channels enabled
+    ADS_STATE_SELECT,   // Next: write config with the current channel's mux
+    ADS_STATE_POINT,    // Next: set the register pointer to the conversion register
+    ADS_STATE_WAIT,     // Waiting for conversions to complete
+    ADS_STATE_READ,     // Next: read the conversion register
+    ADS_STATE_BUSY      // A transaction is queued; its callback picks the next state
+} ads_state_t;
+
+static uint8_t device_address = 0;
+static uint8_t ready_pin = ADS1015_DRIVER_NO_READY_PIN;
+static bool device_started = false;
+
+static uint8_t enabled_channels[ADS1015_DRIVER_CHANNELS];
+static uint8_t enabled_count = 0;
+static uint8_t current_slot = 0;        // Index into enabled_channels being converted
+
+static ads_state_t state = ADS_STATE_IDLE;
+static uint32_t wait_start_us = 0;
+static uint32_t wait_start_ready = 0;
+static uint8_t conversions_needed = 0;  // Conversions to wait for before READ
+
+static int16_t cached_value[ADS1015_DRIVER_CHANNELS];
+static bool cached_valid[ADS1015_DRIVER_CHANNELS];
+
+static uint32_t result_count = 0;
+static uint32_t error_count = 0;
+
+static volatile uint32_t ready_edges = 0;
+
+static uint8_t generation = 0;          // Bumped when the state machine restarts
+
+#ifdef TESTING
+// Mocked converter: pointer and config writes, conversion register reads
+static uint8_t mock_pointer = ADS1015_REG_CONVERSION;
+static uint8_t mock_selected_channel = 0;
+#endif
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+#ifdef ARDUINO
+static void ready_isr(void) {
+    ready_edges++;
+}
+#endif
+
+#ifdef TESTING
+// Config writes select the mocked channel; conversion reads return its
+// reading with the four unused low bits clear like the real register
+static bool mock_device(uint8_t address, const uint8_t* write_data, uint8_t write_length,
+                        uint8_t* read_data, uint8_t read_length) {
+    (void)address;
+    if (write_length >= 1) {
+        mock_pointer = write_data[0];
+    }
+    if (write_length >= 3 && mock_pointer == ADS1015_REG_CONFIG) {
+        mock_selected_channel = (uint8_t)((write_data[1] >> 4) & 0x03);
+    }
+    if (read_length >= 2 && mock_pointer == ADS1015_REG_CONVERSION) {
+        uint16_t value = (uint16_t)(mock_ads1015_read_channel(mock_selected_channel) & 0xFFF0);
+        read_data[0] = (uint8_t)(value >> 8);
+        read_data[1] = (uint8_t)(value & 0xFF);
+    }
+    return true;
+}
+#endif
+
+static inline void* current_generation(void) {
+    return (void*)(uintptr_t)generation;
+}
+
+static inline bool is_stale(void* context) {
+    return (uint8_t)(uintptr_t)context != generation;
+}
+
+// Queue a transaction for the step in progress; on a full queue the step is
+// retried on the next call
+static void submit_step(const uint8_t* write_data, uint8_t write_length, uint8_t read_length,
+                        i2c_bus_callback_t done, ads_state_t retry_state) {
+    state = ADS_STATE_BUSY;
+    if (!i2c_bus_submit(ADS1015_DRIVER_I2C_BUS, device_address, write_data, write_length,
+                        read_length, done, current_generation())) {
+        state = retry_state;
+    }
+}
+
+static void write_register(uint8_t reg, uint16_t value, i2c_bus_callback_t done, ads_state_t retry_state) {
+    uint8_t data[3] = { reg, (uint8_t)(value >> 8), (uint8_t)(value & 0xFF) };
+    submit_step(data, sizeof(data), 0, done, retry_state);
+}
+
+static void start_wait(uint8_t conversions) {
+    wait_start_us = micros();
+    wait_start_ready = ready_edges;
+    conversions_needed = conversions;
+    state = ADS_STATE_WAIT;
+}
+
+static bool conversions_complete(void) {
+    if (ready_pin != ADS1015_DRIVER_NO_READY_PIN) {
+        return (uint32_t)(ready_edges - wait_start_ready) >= conversions_needed;
+    }
+    return (uint32_t)(micros() - wait_start_us) >=
+           (uint32_t)conversions_needed * ADS1015_DRIVER_CONVERSION_US;
+}
+
+static uint16_t config_for_channel(uint8_t channel) {
+    uint16_t config = (uint16_t)(ADS1015_MUX_SINGLE_0 | ((uint16_t)channel << 12)) |
+                      ADS1015_PGA_6_144V | ADS1015_MODE_CONTINUOUS | ADS1015_DR_3300SPS;
+    config |= (ready_pin != ADS1015_DRIVER_NO_READY_PIN) ? ADS1015_COMP_QUE_1CONV
+                                                         : ADS1015_COMP_QUE_DISABLE;
+    return config;
+}
+
+// Threshold writes from begin(): only failures matter
+static void on_threshold_written(i2c_result_t result, const uint8_t* read_data, uint8_t read_length, void* context) {
+    (void)read_data; (void)read_length; (void)context;
+    if (result != I2C_RESULT_OK) {
+        error_count++;
+    }
+}
+
+static void on_config_written(i2c_result_t result, const uint8_t* read_data, uint8_t read_length, void* context) {
+    (void)read_data; (void)read_length;
+    if (is_stale(context)) {
+        return;
+    }
+    if (result != I2C_RESULT_OK) {
+        error_count++;
+        state = ADS_STATE_SELECT;   // Retry on the next call
+        return;
+    }
+    state = ADS_STATE_POINT;
+}
+
+static void on_pointer_written(i2c_result_t result, const uint8_t* read_data, uint8_t read_length, void* context) {
+    (void)read_data; (void)read_length;
+    if (is_stale(context)) {
+        return;
+    }
+    if (result != I2C_RESULT_OK) {
+        error_count++;
+        state = ADS_STATE_SELECT;
+        return;
+    }
+    // The conversion running when the mux changed is discarded
+    start_wait(2);
+}
+
+static void on_conversion_read(i2c_result_t result, const uint8_t* read_data, uint8_t read_length, void* context) {
+    if (is_stale(context)) {
+        return;
+    }
+    if (result != I2C_RESULT_OK || read_length != 2) {
+        error_count++;
+        state = ADS_STATE_SELECT;
+        return;
+    }
+    uint8_t channel = enabled_channels[current_slot];
+    cached_value[channel] = (int16_t)(((uint16_t)read_data[0] << 8) | read_data[1]);
+    cached_valid[channel] = true;
+    result_count++;
+
+    if (enabled_count > 1) {
+        current_slot = (uint8_t)((current_slot + 1) % enabled_count);
+        state = ADS_STATE_SELECT;
+    } else {
+        // Same mux and pointer: just wait for the next conversion
+        start_wait(1);
+    }
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void ads1015_driver_init(void) {
+    // The device binding from ads1015_driver_begin() survives; only the
+    // channel list and cache belong to the sensors being registered
+    enabled_count = 0;
+    current_slot = 0;
+    state = ADS_STATE_IDLE;
+    generation++;               // A transaction still queued no longer steers the state
+    for (uint8_t ch = 0; ch < ADS1015_DRIVER_CHANNELS; ch++) {
+        cached_value[ch] = 0;
+        cached_valid[ch] = false;
+    }
+    result_count = 0;
+    error_count = 0;
+}
+
+void ads1015_driver_begin(uint8_t address, uint8_t pin) {
+    device_address = address;
+    ready_pin = pin;
+    device_started = true;
+    #ifdef TESTING
+    i2c_bus_attach_mock_device(ADS1015_DRIVER_I2C_BUS, address, mock_device);
+    #endif
+
+    // Comparator thresholds are queued ahead of the first SELECT
+    if (ready_pin != ADS1015_DRIVER_NO_READY_PIN) {
+        uint8_t lo[3] = { ADS1015_REG_LO_THRESH, (uint8_t)(ADS1015_READY_LO_THRESH >> 8), (uint8_t)ADS1015_READY_LO_THRESH };
+        uint8_t hi[3] = { ADS1015_REG_HI_THRESH, (uint8_t)(ADS1015_READY_HI_THRESH >> 8), (uint8_t)ADS1015_READY_HI_THRESH };
+        if (!i2c_bus_submit(ADS1015_DRIVER_I2C_BUS, device_address, lo, sizeof(lo), 0, on_threshold_written, nullptr) ||
+            !i2c_bus_submit(ADS1015_DRIVER_I2C_BUS, device_address, hi, sizeof(hi), 0, on_threshold_written, nullptr)) {
+            error_count++;
+        }
+        #ifdef ARDUINO
+        pinMode(ready_pin, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(ready_pin), ready_isr, FALLING);
+        #endif
+    }
+
+    generation++;
+    state = (enabled_count > 0) ? ADS_STATE_SELECT : ADS_STATE_IDLE;
+}
+
+bool ads1015_driver_enable_channel(uint8_t channel) {
+    if (channel >= ADS1015_DRIVER_CHANNELS) {
+        return false;
+    }
+    for (uint8_t i = 0; i < enabled_count; i++) {
+        if (enabled_channels[i] == channel) {
+            return true;
+        }
+    }
+    enabled_channels[enabled_count++] = channel;
+
+    // Restart the round robin so the new channel is picked up by the next SELECT
+    if (device_started) {
+        current_slot = 0;
+        generation++;
+        state = ADS_STATE_SELECT;
+    }
+    return true;
+}
+
+void ads1015_driver_service(void) {
+    switch (state) {
+        case ADS_STATE_IDLE:
+        case ADS_STATE_BUSY:
+            return;
+
+        case ADS_STATE_SELECT:
+            write_register(ADS1015_REG_CONFIG, config_for_channel(enabled_channels[current_slot]),
+                           on_config_written, ADS_STATE_SELECT);
+            return;
+
+        case ADS_STATE_POINT: {
+            uint8_t pointer = ADS1015_REG_CONVERSION;
+            submit_step(&pointer, 1, 0, on_pointer_written, ADS_STATE_POINT);
+            return;
+        }
+
+        case ADS_STATE_WAIT:
+            if (conversions_complete()) {
+                state = ADS_STATE_READ;
+            }
+            return;
+
+        case ADS_STATE_READ:
+            submit_step(nullptr, 0, 2, on_conversion_read, ADS_STATE_READ);
+            return;
+    }
+}
+
+bool ads1015_driver_get(uint8_t channel, int16_t* value) {
+    if (channel >= ADS1015_DRIVER_CHANNELS || !cached_valid[channel]) {
+        return false;
+    }
+    *value = cached_value[channel];
+    return true;
+}
+
+uint32_t ads1015_driver_get_result_count(void) {
+    return result_count;
+}
+
+uint32_t ads1015_driver_get_error_count(void) {
+    return error_count;
+}
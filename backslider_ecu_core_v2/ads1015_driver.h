@@ -0,0 +1,86 @@
+// ads1015_driver.h
+// Non-blocking continuous-conversion driver for the ADS1015 I2C ADC
+
+/* =============================================================================
+ * ADS1015 DRIVER OVERVIEW
+ * =============================================================================
+ *
+ * A single-shot ADS1015 read (Adafruit readADC_SingleEnded) writes the config
+ * register, polls until the conversion finishes and reads the result - about
+ * 1 ms of blocked loop per channel. This driver keeps the converter running
+ * instead:
+ *
+ * - The ADS1015 runs in continuous-conversion mode at 3300 SPS, ±6.144 V.
+ * - ads1015_driver_service() advances a small state machine by queueing at
+ *   most one short I2C transaction per call (2-4 bytes, ~100 µs at 400 kHz)
+ *   on the i2c_bus queue; the step completes in the transaction's callback,
+ *   so the loop never waits for the wire:
+ *     SELECT  write the config register with the next channel's mux
+ *     POINT   point the register pointer at the conversion register
+ *     WAIT    let conversions finish (no bus traffic)
+ *     READ    read the 2-byte result into the per-channel cache
+ *   and then moves round-robin to the next enabled channel. The first
+ *   conversion after a mux change may still use the old input and is skipped.
+ *   With one enabled channel the mux is never rewritten and every conversion
+ *   is read.
+ * - Conversion completion comes from the ALERT/RDY pin when one is wired
+ *   (a FALLING-edge interrupt counts conversions), otherwise from elapsed
+ *   time at the slowest data rate the internal oscillator allows.
+ *
+ * input_manager enables a channel for every SENSOR_I2C_ADC sensor, services
+ * the driver once per update pass and only reads cached results; sensors skip
+ * their update until the first result for their channel is cached.
+ *
+ * Cached results are the raw left-justified 16-bit conversion register
+ * (12-bit result << 4), so ±32767 spans the full ±6.144 V range.
+ * =============================================================================
+ */
+
+#ifndef ADS1015_DRIVER_H
+#define ADS1015_DRIVER_H
+
+#include <stdint.h>
+#include "i2c_bus.h"
+
+#define ADS1015_DRIVER_CHANNELS         4
+#define ADS1015_DRIVER_NO_READY_PIN     0xFF
+#define ADS1015_DRIVER_CONVERSION_US    340     // 3300 SPS period (303 µs) plus oscillator tolerance
+
+// i2c_bus the converter is on (the Adafruit setup in main_application uses Wire)
+#ifndef ADS1015_DRIVER_I2C_BUS
+#define ADS1015_DRIVER_I2C_BUS          I2C_BUS_PRIMARY
+#endif
+
+// Teensy pin wired to ALERT/RDY, or ADS1015_DRIVER_NO_READY_PIN for timed waits
+#ifndef ADS1015_DRIVER_READY_PIN
+#define ADS1015_DRIVER_READY_PIN        ADS1015_DRIVER_NO_READY_PIN
+#endif
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Forget enabled channels and cached results and stop the state machine
+void ads1015_driver_init(void);
+
+// Take over the device at an I2C address: queues the comparator threshold
+// writes for conversion-ready signalling and attaches the ready interrupt when
+// ready_pin is wired. Conversions start once a channel is enabled.
+void ads1015_driver_begin(uint8_t address, uint8_t ready_pin);
+
+// Add a single-ended channel (0-3) to the round robin.
+// Returns false for an invalid channel. Enabling twice is a no-op.
+bool ads1015_driver_enable_channel(uint8_t channel);
+
+// Advance the state machine by queueing at most one I2C transaction. Never waits.
+void ads1015_driver_service(void);
+
+// Latest cached conversion for a channel.
+// Returns false if the channel is not enabled or has no result yet.
+bool ads1015_driver_get(uint8_t channel, int16_t* value);
+
+// Diagnostics
+uint32_t ads1015_driver_get_result_count(void);    // Conversions read into the cache
+uint32_t ads1015_driver_get_error_count(void);     // Failed I2C transactions
+
+#endif
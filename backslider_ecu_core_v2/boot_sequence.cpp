@@ -0,0 +1,154 @@
+// boot_sequence.cpp
+// Stage timing, deferred stage queue and the boot report
+
+#include "boot_sequence.h"
+#include "msg_definitions.h"
+#include "msg_bus.h"
+#include "memory_placement.h"
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+static boot_stage_t stages[BOOT_SEQUENCE_MAX_STAGES];
+static uint8_t stage_count = 0;
+static uint8_t next_deferred = 0;       // Scan position for boot_sequence_update()
+static uint8_t failed_count = 0;
+
+static uint32_t ready_us = 0;
+static uint32_t complete_us = 0;
+static bool is_ready = false;
+static bool is_complete = false;
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static boot_stage_t* add_stage(const char* name, boot_stage_function_t function, void* context, bool deferred) {
+    if (function == nullptr || stage_count >= BOOT_SEQUENCE_MAX_STAGES) {
+        return nullptr;
+    }
+    boot_stage_t* stage = &stages[stage_count++];
+    stage->name = name;
+    stage->function = function;
+    stage->context = context;
+    stage->deferred = deferred;
+    stage->done = false;
+    stage->ok = false;
+    stage->start_us = 0;
+    stage->duration_us = 0;
+    return stage;
+}
+
+static bool run_stage(boot_stage_t* stage) {
+    stage->start_us = micros();
+    stage->ok = stage->function(stage->context);
+    stage->duration_us = micros() - stage->start_us;
+    stage->done = true;
+    if (!stage->ok) {
+        failed_count++;
+    }
+    return stage->ok;
+}
+
+static ECU_COLD_CODE void report(void) {
+    #ifdef ARDUINO
+    Serial.println("=== Boot stages ===");
+    for (uint8_t i = 0; i < stage_count; i++) {
+        const boot_stage_t* stage = &stages[i];
+        Serial.print(stage->deferred ? "  [bg] " : "  [fg] ");
+        Serial.print(stage->name);
+        Serial.print(": ");
+        Serial.print(stage->duration_us);
+        Serial.print(" µs at ");
+        Serial.print(stage->start_us);
+        Serial.println(stage->ok ? " µs" : " µs FAILED");
+    }
+    Serial.print("Engine ready at ");
+    Serial.print(ready_us);
+    Serial.print(" µs, boot complete at ");
+    Serial.print(complete_us);
+    Serial.println(" µs");
+    #endif
+
+    g_message_bus.publishFloat(MSG_BOOT_READY_US, (float)ready_us);
+    g_message_bus.publishFloat(MSG_BOOT_COMPLETE_US, (float)complete_us);
+    g_message_bus.publishFloat(MSG_BOOT_FAILED_STAGES, (float)failed_count);
+    for (uint8_t i = 0; i < stage_count; i++) {
+        g_message_bus.publishFloat(MSG_BOOT_STAGE_US(i), (float)stages[i].duration_us);
+    }
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void boot_sequence_init(void) {
+    stage_count = 0;
+    next_deferred = 0;
+    failed_count = 0;
+    ready_us = 0;
+    complete_us = 0;
+    is_ready = false;
+    is_complete = false;
+}
+
+ECU_COLD_CODE bool boot_sequence_run(const char* name, boot_stage_function_t function, void* context) {
+    boot_stage_t* stage = add_stage(name, function, context, false);
+    return stage ? run_stage(stage) : false;
+}
+
+bool boot_sequence_defer(const char* name, boot_stage_function_t function, void* context) {
+    return add_stage(name, function, context, true) != nullptr;
+}
+
+void boot_sequence_ready(void) {
+    ready_us = micros();
+    is_ready = true;
+}
+
+void boot_sequence_update(void) {
+    if (!is_ready || is_complete) {
+        return;
+    }
+    while (next_deferred < stage_count) {
+        boot_stage_t* stage = &stages[next_deferred++];
+        if (stage->deferred && !stage->done) {
+            run_stage(stage);
+            return;         // One stage per call
+        }
+    }
+    complete_us = micros();
+    is_complete = true;
+    report();
+}
+
+bool boot_sequence_is_complete(void) {
+    return is_complete;
+}
+
+uint32_t boot_sequence_get_ready_us(void) {
+    return ready_us;
+}
+
+uint32_t boot_sequence_get_complete_us(void) {
+    return complete_us;
+}
+
+uint8_t boot_sequence_get_failed_count(void) {
+    return failed_count;
+}
+
+uint8_t boot_sequence_get_stage_count(void) {
+    return stage_count;
+}
+
+const boot_stage_t* boot_sequence_get_stage(uint8_t index) {
+    return (index < stage_count) ? &stages[index] : nullptr;
+}
@@ -0,0 +1,90 @@
+// boot_sequence.h
+// Timed boot stages, with the non-critical ones finished from the main loop
+
+/* =============================================================================
+ * BOOT SEQUENCE OVERVIEW
+ * =============================================================================
+ *
+ * MainApplication::init() is split into named stages instead of one long
+ * run of init calls, so the time to engine-ready is what the engine needs
+ * and nothing else:
+ *
+ * - Foreground stages run in boot_sequence_run(), in order, before the
+ *   control loop starts: outputs to their safe state first, then storage
+ *   and configuration, critical sensors and the engine schedulers.
+ * - boot_sequence_ready() marks engine-ready: the control tasks are
+ *   registered and the main loop takes over.
+ * - Deferred stages (storage diagnostics, tooling links, external CAN,
+ *   broadcasting, SD logging) are queued with boot_sequence_defer() and
+ *   run one per call of boot_sequence_update(), a background task. A
+ *   deferred stage is one uninterrupted call, so it holds the loop for its
+ *   duration - keep each one short; a stage that starts a periodic job
+ *   registers its own task when it is done.
+ *
+ * Every stage is timed with micros(). Times are from reset (micros() starts
+ * at zero on the Teensy), so the ready time is the true engine-ready time.
+ * Once the last deferred stage has run, the module prints a table and
+ * publishes MSG_BOOT_READY_US, MSG_BOOT_COMPLETE_US, MSG_BOOT_FAILED_STAGES
+ * and MSG_BOOT_STAGE_US(index) per stage, in the order they were added.
+ *
+ * EXAMPLE:
+ *   boot_sequence_init();
+ *   boot_sequence_run("outputs_safe", stage_outputs_safe, this);
+ *   boot_sequence_defer("sd_logger", stage_sd_logger, this);
+ *   task_executive_add("boot", boot_sequence_update, TASK_RATE_BACKGROUND, BOOT_SEQUENCE_TASK_BUDGET_US);
+ *   boot_sequence_ready();
+ * =============================================================================
+ */
+
+#ifndef BOOT_SEQUENCE_H
+#define BOOT_SEQUENCE_H
+
+#include <stdint.h>
+
+#define BOOT_SEQUENCE_MAX_STAGES        16
+#define BOOT_SEQUENCE_TASK_BUDGET_US    500     // Background budget; long stages overrun it once
+
+// Returns false if the stage failed. A failed stage is recorded and the
+// boot carries on; the caller decides whether a foreground failure is fatal.
+typedef bool (*boot_stage_function_t)(void* context);
+
+typedef struct {
+    const char* name;
+    boot_stage_function_t function;
+    void* context;
+    bool deferred;
+    bool done;
+    bool ok;
+    uint32_t start_us;              // micros() when the stage started
+    uint32_t duration_us;
+} boot_stage_t;
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Drop all stages
+void boot_sequence_init(void);
+
+// Run a foreground stage now. Returns its result (false if the stage
+// table is full).
+bool boot_sequence_run(const char* name, boot_stage_function_t function, void* context);
+
+// Queue a stage for boot_sequence_update(). Returns false if the table is full.
+bool boot_sequence_defer(const char* name, boot_stage_function_t function, void* context);
+
+// Foreground boot done: records the engine-ready time
+void boot_sequence_ready(void);
+
+// Background task: run the next deferred stage; report once all are done
+void boot_sequence_update(void);
+
+// Diagnostics
+bool boot_sequence_is_complete(void);           // Ready and every deferred stage run
+uint32_t boot_sequence_get_ready_us(void);      // 0 until boot_sequence_ready()
+uint32_t boot_sequence_get_complete_us(void);   // 0 until complete
+uint8_t boot_sequence_get_failed_count(void);
+uint8_t boot_sequence_get_stage_count(void);
+const boot_stage_t* boot_sequence_get_stage(uint8_t index);
+
+#endif
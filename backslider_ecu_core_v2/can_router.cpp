@@ -0,0 +1,235 @@
+// can_router.cpp
+// Route table, rate-limited forwarding to CAN and remote frame delivery
+
+#include "can_router.h"
+#include "msg_definitions.h"
+#include "msg_bus.h"
+#include "id_hash.h"
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+// Timing and held value for one forwarded ID
+typedef struct {
+    uint32_t id;
+    uint32_t last_sent_us;
+    uint8_t route;
+    uint8_t len;
+    bool used;
+    bool sent;                      // last_sent_us is valid
+    bool pending;                   // buf waits for can_router_update()
+    uint8_t buf[8];
+} forward_slot_t;
+
+static can_route_t routes[CAN_ROUTER_MAX_ROUTES];
+static uint8_t route_count = 0;
+static forward_slot_t slots[CAN_ROUTER_ID_SLOTS];
+static uint8_t pending_count = 0;
+static can_router_stats_t stats;
+static can_router_transmit_t transmit_hook = nullptr;
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static int find_route(uint32_t msg_id) {
+    for (uint8_t i = 0; i < route_count; i++) {
+        if ((msg_id & routes[i].mask) == (routes[i].pattern & routes[i].mask)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Parameter requests and responses keep to their own protocol
+static bool is_routable_length(uint8_t length) {
+    return length <= 8 && length != sizeof(parameter_msg_t);
+}
+
+static_assert(CAN_ROUTER_ID_SLOTS == 64, "get_slot() takes 6 hash bits");
+static forward_slot_t* get_slot(uint32_t msg_id) {
+    uint32_t index = fib_hash(msg_id, 6);
+    for (uint8_t probe = 0; probe < CAN_ROUTER_ID_SLOTS; probe++) {
+        forward_slot_t* slot = &slots[(index + probe) & (CAN_ROUTER_ID_SLOTS - 1)];
+        if (!slot->used) {
+            slot->used = true;
+            slot->id = msg_id;
+            return slot;
+        }
+        if (slot->id == msg_id) {
+            return slot;
+        }
+    }
+    return nullptr;
+}
+
+static void hold(forward_slot_t* slot, const uint8_t* data, uint8_t length) {
+    if (!slot->pending) {
+        slot->pending = true;
+        pending_count++;
+    }
+    slot->len = length;
+    memcpy(slot->buf, data, length);
+}
+
+static void send(forward_slot_t* slot, const uint8_t* data, uint8_t length, uint32_t now_us) {
+    if (transmit_hook == nullptr || !transmit_hook(slot->id, data, length)) {
+        stats.transmit_failures++;
+        if (data != slot->buf) {
+            hold(slot, data, length);
+        }
+        return;
+    }
+    slot->last_sent_us = now_us;
+    slot->sent = true;
+    if (slot->pending) {
+        slot->pending = false;
+        pending_count--;
+    }
+    stats.forwarded++;
+    routes[slot->route].frames++;
+}
+
+// Bus handler for every replicated route
+static void forward_message(const CANMessage* msg) {
+    int route = find_route(msg->id);
+    if (route < 0 || routes[route].mode != CAN_ROUTE_REPLICATED || !is_routable_length(msg->len)) {
+        return;         // Exempted by an earlier route
+    }
+
+    forward_slot_t* slot = get_slot(msg->id);
+    if (slot == nullptr) {
+        stats.untracked++;
+        if (transmit_hook == nullptr || !transmit_hook(msg->id, msg->buf, msg->len)) {
+            stats.transmit_failures++;
+            return;
+        }
+        stats.forwarded++;
+        routes[route].frames++;
+        return;
+    }
+
+    uint32_t now_us = micros();
+    slot->route = (uint8_t)route;
+    if (slot->sent && (now_us - slot->last_sent_us) < routes[route].min_interval_us) {
+        if (slot->pending) {
+            stats.superseded++;
+        } else {
+            stats.held++;
+        }
+        hold(slot, msg->buf, msg->len);
+        return;
+    }
+    send(slot, msg->buf, msg->len, now_us);
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void can_router_init(void) {
+    memset(routes, 0, sizeof(routes));
+    memset(slots, 0, sizeof(slots));
+    memset(&stats, 0, sizeof(stats));
+    route_count = 0;
+    pending_count = 0;
+    transmit_hook = nullptr;
+}
+
+void can_router_set_transmit(can_router_transmit_t transmit) {
+    transmit_hook = transmit;
+}
+
+bool can_router_add_route(uint32_t pattern, uint32_t mask, can_route_mode_t mode, uint32_t min_interval_us) {
+    if (route_count >= CAN_ROUTER_MAX_ROUTES) {
+        return false;
+    }
+    if (mode == CAN_ROUTE_REPLICATED && !g_message_bus.subscribeMasked(pattern, mask, forward_message)) {
+        return false;
+    }
+    can_route_t* route = &routes[route_count++];
+    route->pattern = pattern;
+    route->mask = mask;
+    route->mode = (uint8_t)mode;
+    route->min_interval_us = min_interval_us;
+    route->frames = 0;
+    return true;
+}
+
+bool can_router_place_module(const can_module_routes_t* module, bool hosted_here, uint32_t interval_us) {
+    // What the host produces goes out; everything else comes in
+    can_route_mode_t produced = hosted_here ? CAN_ROUTE_REPLICATED : CAN_ROUTE_REMOTE;
+    can_route_mode_t consumed = hosted_here ? CAN_ROUTE_REMOTE : CAN_ROUTE_REPLICATED;
+    uint32_t produced_interval = hosted_here ? interval_us : 0;
+    uint32_t consumed_interval = hosted_here ? 0 : interval_us;
+
+    bool ok = can_router_add_route(module->family, module->family_mask, produced, produced_interval);
+    for (uint8_t i = 0; i < module->output_count; i++) {
+        ok &= can_router_add_route(module->outputs[i], 0xFFFFFFFF, produced, produced_interval);
+    }
+    for (uint8_t i = 0; i < module->input_count; i++) {
+        ok &= can_router_add_route(module->inputs[i], 0xFFFFFFFF, consumed, consumed_interval);
+    }
+    return ok;
+}
+
+can_route_mode_t can_router_get_mode(uint32_t msg_id) {
+    int route = find_route(msg_id);
+    return (route < 0) ? CAN_ROUTE_LOCAL : (can_route_mode_t)routes[route].mode;
+}
+
+bool can_router_receive(uint32_t can_id, const uint8_t* data, uint8_t length) {
+    if (!is_routable_length(length)) {
+        return false;
+    }
+    int route = find_route(can_id);
+    if (route < 0 || routes[route].mode != CAN_ROUTE_REMOTE) {
+        return false;
+    }
+    routes[route].frames++;
+    stats.received++;
+    if (!g_message_bus.publish(can_id, data, length)) {
+        stats.receive_overflows++;
+    }
+    return true;
+}
+
+void can_router_update(void) {
+    if (pending_count == 0) {
+        return;
+    }
+    uint32_t now_us = micros();
+    for (uint8_t i = 0; i < CAN_ROUTER_ID_SLOTS && pending_count > 0; i++) {
+        forward_slot_t* slot = &slots[i];
+        if (!slot->pending) {
+            continue;
+        }
+        if (slot->sent && (now_us - slot->last_sent_us) < routes[slot->route].min_interval_us) {
+            continue;
+        }
+        send(slot, slot->buf, slot->len, now_us);
+    }
+}
+
+uint8_t can_router_get_route_count(void) {
+    return route_count;
+}
+
+const can_route_t* can_router_get_route(uint8_t index) {
+    return (index < route_count) ? &routes[index] : nullptr;
+}
+
+const can_router_stats_t* can_router_get_stats(void) {
+    return &stats;
+}
+
+uint8_t can_router_get_pending(void) {
+    return pending_count;
+}
@@ -0,0 +1,132 @@
+// can_router.h
+// Message routing between the internal bus and other ECUs on physical CAN
+
+/* =============================================================================
+ * CAN ROUTER OVERVIEW
+ * =============================================================================
+ *
+ * Module code publishes and subscribes on g_message_bus without knowing
+ * which ECU it runs on. The router decides, per message ID, whether a
+ * message crosses the external CAN bus:
+ *
+ *   CAN_ROUTE_LOCAL        stays on this ECU (every ID without a route)
+ *   CAN_ROUTE_REMOTE       produced by a module on another ECU: frames from
+ *                          CAN are published on the internal bus, so local
+ *                          subscribers see them as if the module ran here
+ *   CAN_ROUTE_REPLICATED   produced here and needed elsewhere: delivered
+ *                          locally as usual and also sent to CAN
+ *
+ * Routes are ID pattern/mask filters, first match wins; replicated routes
+ * must not overlap each other or a message is offered twice. An ID is produced
+ * by exactly one ECU, so it is remote on every ECU but its producer and no
+ * frame is ever sent back where it came from.
+ *
+ * Outbound: each replicated route is one masked bus subscription. A
+ * forwarded ID is sent at most once per route interval; a value published
+ * sooner is held (latest wins) and sent from can_router_update() once the
+ * interval is up, so the last value always arrives. Per-ID timing lives in
+ * an open-addressed table of CAN_ROUTER_ID_SLOTS; IDs beyond that are sent
+ * unthrottled and counted. A frame the transmit hook refuses (TX queue
+ * full, CAN not up yet) is held and retried the same way.
+ *
+ * Inbound: ExternalCanBus offers every extended frame to
+ * can_router_receive() (set_link_receiver()), which takes those on remote
+ * routes. Parameter frames (sizeof(parameter_msg_t)) are never routed here
+ * in either direction - the parameter protocol has its own request routing
+ * through ExternalCanBus.
+ *
+ * Module placement (which ECU runs e.g. the transmission module) comes from
+ * ECUConfiguration::distribution. A module that can move declares its
+ * traffic as a can_module_routes_t - its own ID family, the IDs it reads
+ * from other modules and the IDs it produces outside its family - and
+ * can_router_place_module() turns that into routes pointing the right way
+ * on both sides. MainApplication skips the module on ECUs that do not
+ * host it.
+ *
+ * EXAMPLE (transmission module on the secondary ECU, seen from the primary):
+ *   can_router_init();
+ *   can_router_set_transmit(send_to_external_canbus);
+ *   can_router_place_module(&TRANSMISSION_MODULE_ROUTES, false, 10000);
+ *   g_external_canbus.set_link_receiver(can_router_receive);
+ * =============================================================================
+ */
+
+#ifndef CAN_ROUTER_H
+#define CAN_ROUTER_H
+
+#include <stdint.h>
+
+#define CAN_ROUTER_MAX_ROUTES           16
+#define CAN_ROUTER_ID_SLOTS             64          // Forwarded IDs tracked (power of two)
+#define CAN_ROUTER_DEFAULT_INTERVAL_US  10000
+
+typedef enum {
+    CAN_ROUTE_LOCAL = 0,
+    CAN_ROUTE_REMOTE,
+    CAN_ROUTE_REPLICATED
+} can_route_mode_t;
+
+// Sends one frame to the other ECUs. Returns false if it could not be queued.
+typedef bool (*can_router_transmit_t)(uint32_t can_id, const uint8_t* data, uint8_t length);
+
+typedef struct {
+    uint32_t pattern;
+    uint32_t mask;
+    uint8_t mode;                   // can_route_mode_t
+    uint32_t min_interval_us;       // Replicated: spacing per ID (0 = every publish)
+    uint32_t frames;                // Forwarded (replicated) or received (remote)
+} can_route_t;
+
+typedef struct {
+    uint32_t forwarded;             // Frames handed to the transmit hook
+    uint32_t held;                  // Publishes held back by the interval
+    uint32_t superseded;            // Held values replaced before they were sent
+    uint32_t transmit_failures;     // Refused by the transmit hook, retried
+    uint32_t untracked;             // Sent unthrottled, ID table full
+    uint32_t received;              // Remote frames published locally
+    uint32_t receive_overflows;     // Remote frames the bus queue refused
+} can_router_stats_t;
+
+// Traffic of a module that can run on another ECU
+typedef struct {
+    uint32_t family;                // The module's own IDs (pattern)
+    uint32_t family_mask;
+    const uint32_t* inputs;         // Read from modules outside the family
+    uint8_t input_count;
+    const uint32_t* outputs;        // Produced outside the family
+    uint8_t output_count;
+} can_module_routes_t;
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Drop all routes and counters. Bus subscriptions of earlier routes stay
+// until MessageBus::resetSubscribers(), so routes are added once at boot.
+void can_router_init(void);
+
+void can_router_set_transmit(can_router_transmit_t transmit);
+
+// Add a route; mode CAN_ROUTE_LOCAL exempts IDs from a broader later route.
+// Returns false if the table or the bus subscriptions are full.
+bool can_router_add_route(uint32_t pattern, uint32_t mask, can_route_mode_t mode, uint32_t min_interval_us);
+
+// Routes for a module hosted here (family and outputs replicated, inputs
+// remote) or elsewhere (the reverse). Returns false if a route did not fit.
+bool can_router_place_module(const can_module_routes_t* module, bool hosted_here, uint32_t interval_us);
+
+can_route_mode_t can_router_get_mode(uint32_t msg_id);
+
+// Link receiver for ExternalCanBus: publishes frames on remote routes
+bool can_router_receive(uint32_t can_id, const uint8_t* data, uint8_t length);
+
+// Send held values whose interval is up (call from the loop)
+void can_router_update(void);
+
+// Diagnostics
+uint8_t can_router_get_route_count(void);
+const can_route_t* can_router_get_route(uint8_t index);
+const can_router_stats_t* can_router_get_stats(void);
+uint8_t can_router_get_pending(void);       // Held values waiting to go
+
+#endif
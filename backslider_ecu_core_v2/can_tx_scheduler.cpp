@@ -0,0 +1,544 @@
+// can_tx_scheduler.cpp
+// Implementation of the external CAN transmit scheduler
+
+#include "can_tx_scheduler.h"
+#include "ecu_time.h"
+#include <string.h>
+
+// Queued release of a slot removed before it was sent
+#define CAN_TX_REMOVED_SLOT     0xFE
+
+// Budget units: one bit on the wire costs this much, and the bucket gains
+// bitrate x cap_pct per microsecond
+#define CAN_TX_BUDGET_PER_BIT   100000000LL
+
+// Longest classic frame: extended ID, 8 data bytes
+#define CAN_TX_MAX_FRAME_BITS   160
+
+// Davis et al.: g control bits exposed to stuffing, 13 that are not, and at
+// most one stuff bit per four bits after the first
+static uint32_t worst_case_frame_bits(bool extended, uint8_t length) {
+    uint32_t stuffed = (extended ? 54u : 34u) + 8u * (length > 8 ? 8 : length);
+    return stuffed + 13 + (stuffed - 1) / 4;
+}
+
+// CAN FD: arbitration and end fields at the nominal rate, control, data
+// and CRC fields (with fixed stuff bits) at the data rate when BRS is set
+static uint32_t worst_case_fd_frame_bits(bool extended, uint8_t length, bool brs,
+                                         uint32_t bitrate, uint32_t data_bitrate) {
+    uint32_t arbitration = extended ? 35u : 17u;
+    uint32_t nominal = arbitration + (arbitration - 1) / 4 + 13;
+    uint32_t crc = (length > 16) ? 21u : 17u;
+    uint32_t data = 5u + 8u * length;
+    uint32_t data_phase = data + (data - 1) / 4 + 4 + crc + (4 + crc + 3) / 4;
+    if (!brs || data_bitrate == 0) {
+        return nominal + data_phase;
+    }
+    return nominal + (uint32_t)(((uint64_t)data_phase * bitrate + data_bitrate - 1) / data_bitrate);
+}
+
+// TX wait bucket limits (µs): <100, <250, <500, <1ms, <2ms, <5ms, <10ms, slower
+static const uint32_t tx_wait_limits_us[CAN_TX_WAIT_BUCKETS - 1] = {
+    100, 250, 500, 1000, 2000, 5000, 10000
+};
+
+static uint32_t gcd_u32(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// ============================================================================
+// CONSTRUCTOR AND INITIALIZATION
+// ============================================================================
+
+CanTxScheduler::CanTxScheduler() :
+    bitrate(500000),
+    data_bitrate(0),
+    max_frame_bits(CAN_TX_MAX_FRAME_BITS),
+    cap_pct(CAN_TX_DEFAULT_UTILISATION_CAP_PCT),
+    write(nullptr),
+    write_context(nullptr),
+    initialized(false),
+    epoch_us(0),
+    last_now_us(0),
+    slot_count(0),
+    budget(0),
+    budget_time_us(0),
+    window_start_us(0),
+    window_bits(0)
+{
+    clear_queues();
+    memset(slots, 0, sizeof(slots));
+    reset_statistics();
+}
+
+void CanTxScheduler::init(uint32_t bitrate, uint8_t utilisation_cap_pct,
+                          can_tx_write_t write, void* context, uint32_t data_bitrate) {
+    this->bitrate = (bitrate > 0) ? bitrate : 500000;
+    this->data_bitrate = data_bitrate;
+    max_frame_bits = CAN_TX_MAX_FRAME_BITS;
+    if (data_bitrate > 0) {
+        uint32_t fd_max = worst_case_fd_frame_bits(true, 64, true, this->bitrate, data_bitrate);
+        if (fd_max > max_frame_bits) {
+            max_frame_bits = fd_max;
+        }
+    }
+    this->write = write;
+    write_context = context;
+    set_utilisation_cap(utilisation_cap_pct);
+
+    clear_queues();
+    slot_count = 0;
+
+    uint32_t now_us = ecu_time_us();
+    epoch_us = now_us;
+    last_now_us = now_us;
+    budget = budget_limit();
+    budget_time_us = now_us;
+    window_start_us = now_us;
+    window_bits = 0;
+
+    reset_statistics();
+    initialized = true;
+}
+
+void CanTxScheduler::shutdown() {
+    clear_queues();
+    slot_count = 0;
+    write = nullptr;
+    write_context = nullptr;
+    initialized = false;
+}
+
+void CanTxScheduler::clear_queues() {
+    for (uint8_t priority = 0; priority < CAN_TX_PRIORITY_COUNT; priority++) {
+        queues[priority].head = 0;
+        queues[priority].count = 0;
+    }
+}
+
+void CanTxScheduler::set_utilisation_cap(uint8_t cap) {
+    if (cap == 0) {
+        cap = CAN_TX_DEFAULT_UTILISATION_CAP_PCT;
+    }
+    cap_pct = (cap > 100) ? 100 : cap;
+}
+
+void CanTxScheduler::reset_statistics() {
+    stats = {};
+}
+
+// ============================================================================
+// FRAME TIMING
+// ============================================================================
+
+uint32_t CanTxScheduler::frame_bits(uint32_t can_id, uint8_t length) {
+    return worst_case_frame_bits(can_id > 0x7FF, length);
+}
+
+uint32_t CanTxScheduler::frame_bits(const CAN_message_t& msg) {
+    return worst_case_frame_bits(msg.flags.extended || msg.id > 0x7FF, msg.len);
+}
+
+uint32_t CanTxScheduler::frame_bits(const CANFD_message_t& msg) const {
+    bool extended = msg.flags.extended || msg.id > 0x7FF;
+    if (!msg.edl) {
+        return worst_case_frame_bits(extended, msg.len);
+    }
+    return worst_case_fd_frame_bits(extended, msg.len, msg.brs, bitrate, data_bitrate);
+}
+
+void CanTxScheduler::classic_to_fd(const CAN_message_t& msg, CANFD_message_t* fd) {
+    *fd = CANFD_message_t();
+    fd->id = msg.id;
+    fd->flags.extended = msg.flags.extended;
+    fd->len = (msg.len > 8) ? 8 : msg.len;
+    memcpy(fd->buf, msg.buf, fd->len);
+    fd->edl = 0;
+    fd->brs = 0;
+}
+
+uint32_t CanTxScheduler::frame_time_us(uint32_t bits) const {
+    return (uint32_t)(((uint64_t)bits * 1000000u + bitrate - 1) / bitrate);
+}
+
+int64_t CanTxScheduler::budget_limit() const {
+    return (int64_t)CAN_TX_BURST_FRAMES * max_frame_bits * CAN_TX_BUDGET_PER_BIT;
+}
+
+void CanTxScheduler::refill_budget(uint32_t now_us) {
+    uint32_t elapsed = now_us - budget_time_us;
+    budget_time_us = now_us;
+    if (elapsed > 1000000) {
+        elapsed = 1000000;      // A full bucket refills well within a second
+    }
+    budget += (int64_t)elapsed * bitrate * cap_pct;
+    if (budget > budget_limit()) {
+        budget = budget_limit();
+    }
+}
+
+void CanTxScheduler::update_load_window(uint32_t now_us) {
+    uint32_t elapsed = now_us - window_start_us;
+    if (elapsed < CAN_TX_LOAD_WINDOW_US) {
+        return;
+    }
+    stats.bus_load_percent = (float)((double)window_bits * 100.0e6 / ((double)elapsed * bitrate));
+    if (stats.bus_load_percent > stats.peak_bus_load_percent) {
+        stats.peak_bus_load_percent = stats.bus_load_percent;
+    }
+    window_start_us = now_us;
+    window_bits = 0;
+}
+
+uint32_t CanTxScheduler::wait_bucket_limit_us(uint8_t bucket) {
+    return (bucket < CAN_TX_WAIT_BUCKETS - 1) ? tx_wait_limits_us[bucket] : 0xFFFFFFFFu;
+}
+
+void CanTxScheduler::record_tx_wait(uint32_t wait_us) {
+    can_tx_wait_histogram_t& hist = stats.tx_wait;
+    uint8_t bucket = 0;
+    while (bucket < CAN_TX_WAIT_BUCKETS - 1 && wait_us >= tx_wait_limits_us[bucket]) {
+        bucket++;
+    }
+    hist.counts[bucket]++;
+    hist.samples++;
+    hist.total_us += wait_us;
+    if (wait_us > hist.max_us) {
+        hist.max_us = wait_us;
+    }
+}
+
+float CanTxScheduler::get_periodic_load_percent() const {
+    double bits_per_second = 0.0;
+    for (uint8_t i = 0; i < slot_count; i++) {
+        bits_per_second += (double)frame_bits(slots[i].can_id, 8) * 1.0e6 / slots[i].period_us;
+    }
+    return (float)(bits_per_second * 100.0 / bitrate);
+}
+
+uint32_t CanTxScheduler::get_critical_latency_bound_us() const {
+    // Blocking frame, one frame per other class's mailbox, one sporadic
+    // critical frame, then every critical slot
+    uint32_t bits = max_frame_bits * (1 + (CAN_TX_PRIORITY_COUNT - 1) + 1);
+    for (uint8_t i = 0; i < slot_count; i++) {
+        if (slots[i].priority == CAN_TX_PRIORITY_CRITICAL) {
+            bits += frame_bits(slots[i].can_id, 8);
+        }
+    }
+    return frame_time_us(bits);
+}
+
+// ============================================================================
+// QUEUES AND DISPATCH
+// ============================================================================
+
+void CanTxScheduler::update(uint32_t now_us) {
+    if (!initialized) {
+        return;
+    }
+    last_now_us = now_us;
+    release_periodic(now_us);
+    dispatch(now_us);
+    update_load_window(now_us);
+}
+
+bool CanTxScheduler::submit(const CAN_message_t& msg, can_tx_priority_t priority, uint32_t now_us) {
+    CANFD_message_t fd;
+    classic_to_fd(msg, &fd);
+    return submit(fd, priority, now_us);
+}
+
+bool CanTxScheduler::submit(const CANFD_message_t& msg, can_tx_priority_t priority, uint32_t now_us) {
+    if (!initialized || priority >= CAN_TX_PRIORITY_COUNT) {
+        return false;
+    }
+    last_now_us = now_us;
+    if (!enqueue(msg, priority, CAN_TX_NO_SLOT, now_us)) {
+        stats.frames_dropped++;
+        return false;
+    }
+    dispatch(now_us);
+    return true;
+}
+
+bool CanTxScheduler::enqueue(const CANFD_message_t& msg, uint8_t priority, uint8_t slot, uint32_t now_us) {
+    tx_queue_t& queue = queues[priority];
+    if (queue.count >= CAN_TX_QUEUE_SIZE) {
+        return false;
+    }
+    tx_entry_t& entry = queue.entries[(queue.head + queue.count) & (CAN_TX_QUEUE_SIZE - 1)];
+    entry.msg = msg;
+    entry.queued_us = now_us;
+    entry.slot = slot;
+    queue.count++;
+    if (queue.count > stats.queue_high_water[priority]) {
+        stats.queue_high_water[priority] = queue.count;
+    }
+    stats.frames_queued++;
+    return true;
+}
+
+uint8_t CanTxScheduler::get_queue_depth(can_tx_priority_t priority) const {
+    return (priority < CAN_TX_PRIORITY_COUNT) ? queues[priority].count : 0;
+}
+
+bool CanTxScheduler::build_frame(const tx_entry_t& entry, CANFD_message_t* msg) {
+    *msg = entry.msg;
+    if (entry.slot == CAN_TX_NO_SLOT) {
+        return true;
+    }
+    periodic_slot_t& slot = slots[entry.slot];
+    if (slot.fill != nullptr) {
+        CAN_message_t classic = {};
+        classic.id = slot.can_id;
+        classic.flags.extended = msg->flags.extended;
+        if (!slot.fill(slot.can_id, &classic, slot.context)) {
+            return false;
+        }
+        classic_to_fd(classic, msg);
+        return true;
+    }
+    if (!slot.has_payload) {
+        return false;
+    }
+    msg->len = slot.length;
+    memcpy(msg->buf, slot.data, slot.length);
+    return true;
+}
+
+void CanTxScheduler::dispatch(uint32_t now_us) {
+    if (write == nullptr) {
+        return;
+    }
+    refill_budget(now_us);
+
+    for (uint8_t priority = 0; priority < CAN_TX_PRIORITY_COUNT; priority++) {
+        tx_queue_t& queue = queues[priority];
+
+        while (queue.count > 0) {
+            tx_entry_t& entry = queue.entries[queue.head];
+
+            if (entry.slot != CAN_TX_REMOVED_SLOT) {
+                CANFD_message_t msg;
+                if (build_frame(entry, &msg)) {
+                    uint32_t bits = frame_bits(msg);
+                    int64_t cost = (int64_t)bits * CAN_TX_BUDGET_PER_BIT;
+
+                    // Lower classes must not overtake a frame held by the cap
+                    if (priority != CAN_TX_PRIORITY_CRITICAL && budget < cost) {
+                        stats.budget_deferrals++;
+                        return;
+                    }
+                    if (!write(CAN_TX_FIRST_MAILBOX + priority, msg, write_context)) {
+                        stats.mailbox_busy++;
+                        break;      // Next class, its own mailbox may be free
+                    }
+
+                    budget -= cost;
+                    window_bits += bits;
+                    stats.frames_sent++;
+                    uint32_t latency = now_us - entry.queued_us;
+                    record_tx_wait(latency);
+                    if (priority == CAN_TX_PRIORITY_CRITICAL &&
+                        latency > stats.critical_latency_max_us) {
+                        stats.critical_latency_max_us = latency;
+                    }
+                }
+                if (entry.slot != CAN_TX_NO_SLOT) {
+                    slots[entry.slot].pending = false;
+                }
+            }
+
+            queue.head = (queue.head + 1) & (CAN_TX_QUEUE_SIZE - 1);
+            queue.count--;
+        }
+    }
+}
+
+// ============================================================================
+// PERIODIC SLOTS
+// ============================================================================
+
+void CanTxScheduler::release_periodic(uint32_t now_us) {
+    for (uint8_t i = 0; i < slot_count; i++) {
+        periodic_slot_t& slot = slots[i];
+        if ((int32_t)(now_us - slot.next_release_us) < 0) {
+            continue;
+        }
+
+        if (slot.pending) {
+            stats.periodic_overruns++;
+        } else {
+            CANFD_message_t msg;
+            msg.id = slot.can_id;
+            msg.flags.extended = (slot.can_id > 0x7FF);
+            msg.edl = 0;
+            msg.brs = 0;
+            if (enqueue(msg, slot.priority, i, now_us)) {
+                slot.pending = true;
+                stats.periodic_releases++;
+            } else {
+                stats.periodic_overruns++;
+            }
+        }
+
+        // Stay on the slot's grid; releases missed entirely are overruns too
+        slot.next_release_us += slot.period_us;
+        uint32_t late = now_us - slot.next_release_us;
+        if ((int32_t)late >= 0) {
+            uint32_t missed = late / slot.period_us + 1;
+            slot.next_release_us += missed * slot.period_us;
+            stats.periodic_overruns += missed;
+        }
+    }
+}
+
+int8_t CanTxScheduler::find_slot(uint32_t can_id) const {
+    for (uint8_t i = 0; i < slot_count; i++) {
+        if (slots[i].can_id == can_id) {
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
+
+uint32_t CanTxScheduler::choose_phase_us(uint32_t period_us, int8_t skip_slot) const {
+    // Pick the phase (whole ms) that can coincide with the fewest slots; two
+    // slots ever release together when their phases agree modulo the gcd of
+    // their periods. Ties go to the phase furthest from any other slot.
+    uint32_t period_ms = period_us / 1000;
+    uint32_t step_ms = (period_ms > 256) ? period_ms / 256 : 1;
+    uint32_t best_phase = 0;
+    uint32_t best_collisions = 0xFFFFFFFFu;
+    uint32_t best_distance = 0;
+
+    for (uint32_t phase = 0; phase < period_ms; phase += step_ms) {
+        uint32_t collisions = 0;
+        uint32_t distance = 0xFFFFFFFFu;
+        for (uint8_t i = 0; i < slot_count; i++) {
+            if ((int8_t)i == skip_slot) {
+                continue;
+            }
+            uint32_t g = gcd_u32(period_ms, slots[i].period_us / 1000);
+            uint32_t other = (slots[i].phase_us / 1000) % g;
+            uint32_t offset = (phase % g + g - other) % g;
+            if (offset == 0) {
+                collisions++;
+            }
+            uint32_t d = (offset < g - offset) ? offset : g - offset;
+            if (d < distance) {
+                distance = d;
+            }
+        }
+        if (collisions < best_collisions ||
+            (collisions == best_collisions && distance > best_distance)) {
+            best_collisions = collisions;
+            best_distance = distance;
+            best_phase = phase;
+        }
+    }
+    return best_phase * 1000;
+}
+
+bool CanTxScheduler::add_periodic_slot(uint32_t can_id, uint32_t period_ms, can_tx_priority_t priority,
+                                       can_tx_fill_t fill, void* context, uint32_t phase_ms) {
+    if (!initialized || period_ms == 0 || priority >= CAN_TX_PRIORITY_COUNT) {
+        return false;
+    }
+
+    int8_t index = find_slot(can_id);
+    if (index < 0 && slot_count >= CAN_TX_MAX_PERIODIC_SLOTS) {
+        stats.slots_rejected++;
+        return false;
+    }
+
+    // Admission: worst-case periodic load, with this slot, must fit the cap
+    double load = get_periodic_load_percent();
+    if (index >= 0) {
+        load -= (double)frame_bits(can_id, 8) * 1.0e8 / ((double)slots[index].period_us * bitrate);
+    }
+    load += (double)frame_bits(can_id, 8) * 1.0e5 / ((double)period_ms * bitrate);
+    if (load > cap_pct) {
+        stats.slots_rejected++;
+        return false;
+    }
+
+    uint32_t period_us = period_ms * 1000;
+    uint32_t phase_us = (phase_ms == CAN_TX_PHASE_AUTO) ?
+                        choose_phase_us(period_us, index) : (phase_ms % period_ms) * 1000;
+
+    if (index < 0) {
+        index = (int8_t)slot_count++;
+        slots[index].pending = false;
+        slots[index].has_payload = false;
+        slots[index].length = 0;
+    }
+    periodic_slot_t& slot = slots[index];
+    slot.can_id = can_id;
+    slot.period_us = period_us;
+    slot.phase_us = phase_us;
+    slot.fill = fill;
+    slot.context = context;
+    slot.priority = (uint8_t)priority;
+
+    // First release on the slot's grid at or after the last time seen
+    uint32_t first = epoch_us + phase_us;
+    int32_t since = (int32_t)(last_now_us - first);
+    if (since > 0) {
+        first += (((uint32_t)since + period_us - 1) / period_us) * period_us;
+    }
+    slot.next_release_us = first;
+    return true;
+}
+
+void CanTxScheduler::renumber_queued_slot(uint8_t from, uint8_t to) {
+    for (uint8_t priority = 0; priority < CAN_TX_PRIORITY_COUNT; priority++) {
+        tx_queue_t& queue = queues[priority];
+        for (uint8_t n = 0; n < queue.count; n++) {
+            tx_entry_t& entry = queue.entries[(queue.head + n) & (CAN_TX_QUEUE_SIZE - 1)];
+            if (entry.slot == from) {
+                entry.slot = to;
+            }
+        }
+    }
+}
+
+bool CanTxScheduler::remove_periodic_slot(uint32_t can_id) {
+    int8_t index = find_slot(can_id);
+    if (index < 0) {
+        return false;
+    }
+
+    renumber_queued_slot((uint8_t)index, CAN_TX_REMOVED_SLOT);
+    slot_count--;
+    if ((uint8_t)index != slot_count) {
+        slots[index] = slots[slot_count];
+        renumber_queued_slot(slot_count, (uint8_t)index);
+    }
+    return true;
+}
+
+bool CanTxScheduler::set_periodic_payload(uint32_t can_id, const uint8_t* data, uint8_t length) {
+    int8_t index = find_slot(can_id);
+    if (index < 0 || data == nullptr || length > 8) {
+        return false;
+    }
+    memcpy(slots[index].data, data, length);
+    slots[index].length = length;
+    slots[index].has_payload = true;
+    return true;
+}
+
+bool CanTxScheduler::get_periodic_phase_ms(uint32_t can_id, uint32_t* phase_ms) const {
+    int8_t index = find_slot(can_id);
+    if (index < 0 || phase_ms == nullptr) {
+        return false;
+    }
+    *phase_ms = slots[index].phase_us / 1000;
+    return true;
+}
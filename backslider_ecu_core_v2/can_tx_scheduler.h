@@ -0,0 +1,259 @@
+// can_tx_scheduler.h
+// Central transmit scheduler for the external CAN bus
+
+/* =============================================================================
+ * CAN TX SCHEDULER OVERVIEW
+ * =============================================================================
+ *
+ * Every frame the ECU puts on the external bus goes through one scheduler, so
+ * bursts from different modules are spread out and the bus load is known:
+ *
+ *   send_custom_message() ──┐
+ *   parameter responses ────┼─► priority queue ──► budget ──► TX mailbox
+ *   periodic slots ─────────┘   (one per class)    (cap %)    (one per class)
+ *
+ * PRIORITY CLASSES:
+ * - Each class has its own queue and its own FlexCAN TX mailbox
+ *   (CAN_TX_FIRST_MAILBOX + class), so a low-priority frame waiting in its
+ *   mailbox never holds up a critical one. On the wire the controller still
+ *   arbitrates by CAN ID.
+ * - Queues are drained critical first. A class whose mailbox is busy keeps
+ *   its frames and the next class is tried.
+ *
+ * UTILISATION CAP:
+ * - Non-critical frames spend from a token bucket that fills at cap % of the
+ *   bit rate and holds CAN_TX_BURST_FRAMES worst-case frames. A frame that
+ *   does not fit waits, and so does everything below it.
+ * - Critical frames are never held back; they are charged to the bucket, so
+ *   they squeeze the other classes rather than the bus.
+ * - Periodic slots are admitted only while their worst-case load fits under
+ *   the cap.
+ *
+ * PERIODIC SLOTS:
+ * - A slot releases its CAN ID every period_ms at phase_ms past a common
+ *   epoch (init()), so phases compare across slots. CAN_TX_PHASE_AUTO picks the phase that coincides with the
+ *   fewest existing slots, so slots with related periods don't line up.
+ * - The payload is built when the frame reaches its mailbox (fill callback)
+ *   or taken from the last set_periodic_payload(). A release while the last
+ *   one is still queued is skipped and counted as an overrun.
+ *
+ * LATENCY:
+ * - submit() and update() dispatch straight away, so a critical frame reaches
+ *   its mailbox in the call that queued or released it.
+ * - get_critical_latency_bound_us() is the worst case from release to the
+ *   end of transmission, for critical IDs that win arbitration against other
+ *   nodes: one frame already on the wire, one frame from each other class's
+ *   mailbox (the controller picks the lowest ID among its own mailboxes),
+ *   every critical slot released at once and one sporadic critical frame.
+ *
+ * CAN FD:
+ * - Queues hold CANFD_message_t; classic frames ride in them with edl clear.
+ *   With a data bit rate set, FD frames are costed as their nominal-rate
+ *   arbitration and end fields plus the data phase scaled to nominal bits,
+ *   so the budget and load figures stay in nominal bit times.
+ * - Periodic slots send classic frames.
+ *
+ * TX WAIT:
+ * - Every frame written to a mailbox records its wait since submit() (or
+ *   since its periodic release) in a histogram. A mailbox still busy with
+ *   the previous frame - which includes that frame losing arbitration and
+ *   being retried by the controller - shows up as mailbox_busy and as wait.
+ *
+ * BUS LOAD:
+ * - Every frame sent, and every frame received through the acceptance
+ *   filters (note_rx_bits()), is counted at its worst-case stuffed length.
+ *   The load of each CAN_TX_LOAD_WINDOW_US window is in the statistics.
+ *   Frames rejected by the hardware filters are not seen, so the figure is a
+ *   lower bound on a bus shared with other nodes.
+ * =============================================================================
+ */
+
+#ifndef CAN_TX_SCHEDULER_H
+#define CAN_TX_SCHEDULER_H
+
+#include <stdint.h>
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+    #include <FlexCAN_T4.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+
+typedef enum {
+    CAN_TX_PRIORITY_CRITICAL = 0,   // Never throttled, bounded latency
+    CAN_TX_PRIORITY_HIGH     = 1,   // Parameter responses, diagnostics
+    CAN_TX_PRIORITY_NORMAL   = 2,   // Custom messages, broadcasts
+    CAN_TX_PRIORITY_LOW      = 3,   // Bulk / best-effort
+    CAN_TX_PRIORITY_COUNT    = 4
+} can_tx_priority_t;
+
+#define CAN_TX_QUEUE_SIZE                   16      // Frames per class (power of two)
+#define CAN_TX_MAX_PERIODIC_SLOTS           32
+#define CAN_TX_FIRST_MAILBOX                10      // MB0-9 hold the RX FIFO and RFFN_16 filters
+#define CAN_TX_DEFAULT_UTILISATION_CAP_PCT  60
+#define CAN_TX_BURST_FRAMES                 8       // Token bucket depth in worst-case frames
+#define CAN_TX_LOAD_WINDOW_US               100000  // Bus load averaging window
+#define CAN_TX_PHASE_AUTO                   0xFFFFFFFFu
+#define CAN_TX_NO_SLOT                      0xFF
+#define CAN_TX_WAIT_BUCKETS                 8       // TX wait histogram buckets
+
+// Writes one frame to a TX mailbox; false when the mailbox is still busy
+typedef bool (*can_tx_write_t)(uint8_t mailbox, const CANFD_message_t& msg, void* context);
+
+// Builds a periodic frame (id already set); false skips this release
+typedef bool (*can_tx_fill_t)(uint32_t can_id, CAN_message_t* msg, void* context);
+
+// Time from queueing (or periodic release) to the TX mailbox, every class
+struct can_tx_wait_histogram_t {
+    uint32_t counts[CAN_TX_WAIT_BUCKETS];   // See CanTxScheduler::wait_bucket_limit_us()
+    uint32_t samples;
+    uint64_t total_us;
+    uint32_t max_us;
+};
+
+// Scheduler statistics
+struct can_tx_stats_t {
+    uint32_t frames_queued;
+    uint32_t frames_sent;
+    uint32_t frames_dropped;            // Queue full at submit()
+    uint32_t budget_deferrals;          // Dispatch stopped by the utilisation cap
+    uint32_t mailbox_busy;              // Write refused, frame kept queued
+    uint32_t periodic_releases;
+    uint32_t periodic_overruns;         // Release skipped, last one still queued
+    uint32_t slots_rejected;            // Periodic slot over the cap or table full
+    uint32_t critical_latency_max_us;   // Release to mailbox, critical class
+    uint8_t queue_high_water[CAN_TX_PRIORITY_COUNT];
+    can_tx_wait_histogram_t tx_wait;
+    float bus_load_percent;             // Last complete load window
+    float peak_bus_load_percent;
+};
+
+// =============================================================================
+// SCHEDULER
+// =============================================================================
+
+class CanTxScheduler {
+public:
+    CanTxScheduler();
+
+    // Bit rate sets frame times; cap_pct of 0 selects the default. A data
+    // bit rate enables CAN FD costing (0 = classic CAN only).
+    void init(uint32_t bitrate, uint8_t utilisation_cap_pct, can_tx_write_t write, void* context,
+              uint32_t data_bitrate = 0);
+    void shutdown();
+
+    // Release due periodic slots, then dispatch; call from the main loop
+    void update(uint32_t now_us);
+
+    // Queue a frame and dispatch at once if its class and the budget allow
+    bool submit(const CAN_message_t& msg, can_tx_priority_t priority, uint32_t now_us);
+    bool submit(const CANFD_message_t& msg, can_tx_priority_t priority, uint32_t now_us);
+
+    // Periodic slots, one per CAN ID (re-adding an ID replaces its slot)
+    bool add_periodic_slot(uint32_t can_id, uint32_t period_ms, can_tx_priority_t priority,
+                           can_tx_fill_t fill, void* context,
+                           uint32_t phase_ms = CAN_TX_PHASE_AUTO);
+    bool remove_periodic_slot(uint32_t can_id);
+    bool set_periodic_payload(uint32_t can_id, const uint8_t* data, uint8_t length);
+    bool get_periodic_phase_ms(uint32_t can_id, uint32_t* phase_ms) const;
+    uint8_t get_periodic_slot_count() const { return slot_count; }
+
+    // Bits of frames received from the bus, for the load figure
+    void note_rx_bits(uint32_t bits) { window_bits += bits; }
+
+    // Utilisation cap
+    void set_utilisation_cap(uint8_t cap_pct);
+    uint8_t get_utilisation_cap() const { return cap_pct; }
+
+    // Worst-case periodic load of the admitted slots, percent of the bit rate
+    float get_periodic_load_percent() const;
+    uint32_t get_critical_latency_bound_us() const;
+
+    uint8_t get_queue_depth(can_tx_priority_t priority) const;
+    const can_tx_stats_t& get_statistics() const { return stats; }
+    void reset_statistics();
+
+    // Worst-case length of a frame on the wire, stuff bits included; FD
+    // frames in nominal bit times
+    static uint32_t frame_bits(const CAN_message_t& msg);
+    static uint32_t frame_bits(uint32_t can_id, uint8_t length);
+    uint32_t frame_bits(const CANFD_message_t& msg) const;
+    uint32_t frame_time_us(uint32_t bits) const;
+
+    // Upper limit of a TX wait bucket (the last one is open-ended)
+    static uint32_t wait_bucket_limit_us(uint8_t bucket);
+
+    // Classic frame as a CANFD_message_t with edl and brs clear
+    static void classic_to_fd(const CAN_message_t& msg, CANFD_message_t* fd);
+
+private:
+    struct tx_entry_t {
+        CANFD_message_t msg;
+        uint32_t queued_us;
+        uint8_t slot;                   // CAN_TX_NO_SLOT for one-off frames
+    };
+
+    struct tx_queue_t {
+        tx_entry_t entries[CAN_TX_QUEUE_SIZE];
+        uint8_t head;
+        uint8_t count;
+    };
+
+    struct periodic_slot_t {
+        uint32_t can_id;
+        uint32_t period_us;
+        uint32_t phase_us;
+        uint32_t next_release_us;
+        can_tx_fill_t fill;
+        void* context;
+        uint8_t priority;
+        uint8_t length;
+        uint8_t data[8];
+        bool has_payload;
+        bool pending;                   // Released and still queued
+    };
+
+    uint32_t bitrate;
+    uint32_t data_bitrate;              // 0 without CAN FD
+    uint32_t max_frame_bits;            // Longest frame this bus can carry
+    uint8_t cap_pct;
+    can_tx_write_t write;
+    void* write_context;
+    bool initialized;
+    uint32_t epoch_us;                  // Slot phases are relative to init()
+    uint32_t last_now_us;
+
+    tx_queue_t queues[CAN_TX_PRIORITY_COUNT];
+    periodic_slot_t slots[CAN_TX_MAX_PERIODIC_SLOTS];
+    uint8_t slot_count;
+
+    // Token bucket, in bit x microsecond x percent units so refill is exact
+    int64_t budget;
+    uint32_t budget_time_us;
+
+    // Bus load window
+    uint32_t window_start_us;
+    uint32_t window_bits;
+
+    can_tx_stats_t stats;
+
+    void clear_queues();
+    void release_periodic(uint32_t now_us);
+    void dispatch(uint32_t now_us);
+    void refill_budget(uint32_t now_us);
+    void update_load_window(uint32_t now_us);
+    void record_tx_wait(uint32_t wait_us);
+    bool enqueue(const CANFD_message_t& msg, uint8_t priority, uint8_t slot, uint32_t now_us);
+    bool build_frame(const tx_entry_t& entry, CANFD_message_t* msg);
+    void renumber_queued_slot(uint8_t from, uint8_t to);
+    int8_t find_slot(uint32_t can_id) const;
+    uint32_t choose_phase_us(uint32_t period_us, int8_t skip_slot) const;
+    int64_t budget_limit() const;
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "config_manager.h"
+#include <stddef.h>
 #include <string.h>
 
 #ifndef ARDUINO
@@ -9,6 +10,7 @@ extern MockSerial Serial;
 #endif
 
 // Static configuration storage keys
+const char* ConfigManager::CONFIG_KEY_IMAGE = "cfg_image";
 const char* ConfigManager::CONFIG_KEY_ECU_TYPE = "cfg_ecu_type";
 const char* ConfigManager::CONFIG_KEY_ECU_NAME = "cfg_ecu_name";
 const char* ConfigManager::CONFIG_KEY_SERIAL_NUMBER = "cfg_serial_num";
@@ -16,7 +18,7 @@ const char* ConfigManager::CONFIG_KEY_FIRMWARE_VERSION = "cfg_fw_ver";
 const char* ConfigManager::CONFIG_KEY_BOOT_TIMEOUT = "cfg_boot_timeout";
 
 ConfigManager::ConfigManager(StorageManager* storage_mgr) 
-    : storage(storage_mgr), config_loaded(false) {
+    : storage(storage_mgr), config_loaded(false), config_source(CONFIG_SOURCE_NONE) {
     // Initialize with default config
     memset(&current_config, 0, sizeof(current_config));
 }
@@ -32,6 +34,11 @@ bool ConfigManager::initialize() {
     // Try to load configuration from storage first
     if (loadConfigurationFromStorage()) {
         Serial.println("ConfigManager: Configuration loaded from storage");
+        config_source = CONFIG_SOURCE_IMAGE;
+        config_loaded = true;
+    } else if (migrateConfiguration()) {
+        Serial.println("ConfigManager: Configuration migrated to the current image");
+        config_source = CONFIG_SOURCE_MIGRATED;
         config_loaded = true;
     } else {
         Serial.println("ConfigManager: No valid configuration found, loading defaults");
@@ -49,6 +56,7 @@ bool ConfigManager::initialize() {
             Serial.println("WARNING: ConfigManager - Failed to save default configuration");
         }
         
+        config_source = CONFIG_SOURCE_DEFAULTS;
         config_loaded = true;
     }
     
@@ -65,51 +73,83 @@ bool ConfigManager::initialize() {
 }
 
 bool ConfigManager::loadDefaultConfiguration() {
-    // Load the default transmission configuration
+    // Load the default transmission configuration (constant image in flash)
     memcpy(&current_config, &ECU_TRANSMISSION_CONFIG, sizeof(ECUConfiguration));
     
     Serial.println("ConfigManager: Default transmission configuration loaded");
     return true;
 }
 
+void ConfigManager::buildStorageItems(StorageItem* items, uint8_t* ecu_type_val) {
+    items[0] = {storage->convert_string_to_extended_can_id(CONFIG_KEY_ECU_TYPE),
+                ecu_type_val, sizeof(*ecu_type_val), false};
+    items[1] = {storage->convert_string_to_extended_can_id(CONFIG_KEY_ECU_NAME),
+                current_config.ecu_name, sizeof(current_config.ecu_name), false};
+    items[2] = {storage->convert_string_to_extended_can_id(CONFIG_KEY_SERIAL_NUMBER),
+                &current_config.serial_number, sizeof(current_config.serial_number), false};
+    items[3] = {storage->convert_string_to_extended_can_id(CONFIG_KEY_FIRMWARE_VERSION),
+                current_config.firmware_version, sizeof(current_config.firmware_version), false};
+    items[4] = {storage->convert_string_to_extended_can_id(CONFIG_KEY_BOOT_TIMEOUT),
+                &current_config.boot_timeout_ms, sizeof(current_config.boot_timeout_ms), false};
+}
+
 bool ConfigManager::loadConfigurationFromStorage() {
     if (!storage) return false;
     
-    // Try to load basic configuration items
-    uint8_t ecu_type_val;
-    if (storage->load_data(CONFIG_KEY_ECU_TYPE, &ecu_type_val, sizeof(ecu_type_val))) {
-        // Load default config first
-        loadDefaultConfiguration();
-        
-        // Override with stored values
-        current_config.ecu_type = (ECUType)ecu_type_val;
-        
-        // Load other stored values if they exist
-        storage->load_data(CONFIG_KEY_ECU_NAME, current_config.ecu_name, sizeof(current_config.ecu_name));
-        storage->load_data(CONFIG_KEY_SERIAL_NUMBER, &current_config.serial_number, sizeof(current_config.serial_number));
-        storage->load_data(CONFIG_KEY_FIRMWARE_VERSION, current_config.firmware_version, sizeof(current_config.firmware_version));
-        storage->load_data(CONFIG_KEY_BOOT_TIMEOUT, &current_config.boot_timeout_ms, sizeof(current_config.boot_timeout_ms));
-        
+    // The whole configuration in one read, checked by the blob CRC
+    StorageSegment image = {&current_config, sizeof(current_config)};
+    if (storage->load_blob(storage->convert_string_to_extended_can_id(CONFIG_KEY_IMAGE),
+                           CONFIG_IMAGE_VERSION, &image, 1)) {
         return true;
     }
     
+    // A failed load may leave part of an image behind
+    loadDefaultConfiguration();
     return false;
 }
 
-bool ConfigManager::saveConfigurationToStorage() {
+bool ConfigManager::migrateConfiguration() {
     if (!storage) return false;
     
-    bool success = true;
+    // Version 1: the current layout up to the distribution block, which
+    // keeps its defaults (every module local)
+    loadDefaultConfiguration();
+    StorageSegment image_v1 = {&current_config, offsetof(ECUConfiguration, distribution)};
+    if (storage->load_blob(storage->convert_string_to_extended_can_id(CONFIG_KEY_IMAGE),
+                           1, &image_v1, 1)) {
+        current_config.distribution = ECU_TRANSMISSION_CONFIG.distribution;
+        if (!saveConfigurationToStorage()) {
+            Serial.println("WARNING: ConfigManager - Failed to save migrated configuration");
+        }
+        return true;
+    }
     
-    // Save basic configuration items
-    uint8_t ecu_type_val = (uint8_t)current_config.ecu_type;
-    success &= storage->save_data(CONFIG_KEY_ECU_TYPE, &ecu_type_val, sizeof(ecu_type_val));
-    success &= storage->save_data(CONFIG_KEY_ECU_NAME, current_config.ecu_name, sizeof(current_config.ecu_name));
-    success &= storage->save_data(CONFIG_KEY_SERIAL_NUMBER, &current_config.serial_number, sizeof(current_config.serial_number));
-    success &= storage->save_data(CONFIG_KEY_FIRMWARE_VERSION, current_config.firmware_version, sizeof(current_config.firmware_version));
-    success &= storage->save_data(CONFIG_KEY_BOOT_TIMEOUT, &current_config.boot_timeout_ms, sizeof(current_config.boot_timeout_ms));
+    // Version 0: stored values override the defaults; every key in one batch
+    loadDefaultConfiguration();
+    uint8_t ecu_type_val;
+    StorageItem items[CONFIG_ITEM_COUNT];
+    buildStorageItems(items, &ecu_type_val);
+    storage->load_many(items, CONFIG_ITEM_COUNT);
     
-    return success;
+    // No ECU type means nothing was ever saved
+    if (!items[0].ok) {
+        loadDefaultConfiguration();
+        return false;
+    }
+    current_config.ecu_type = (ECUType)ecu_type_val;
+    
+    if (!saveConfigurationToStorage()) {
+        Serial.println("WARNING: ConfigManager - Failed to save migrated configuration");
+    }
+    return true;
+}
+
+bool ConfigManager::saveConfigurationToStorage() {
+    if (!storage) return false;
+    
+    StorageSegment image = {&current_config, sizeof(current_config)};
+    return storage->save_blob(storage->convert_string_to_extended_can_id(CONFIG_KEY_IMAGE),
+                              CONFIG_IMAGE_VERSION, &image, 1);
 }
 
 bool ConfigManager::validateConfiguration() {
@@ -142,6 +182,13 @@ bool ConfigManager::validateConfiguration() {
         return false;
     }
     
+    // Validate module placement
+    if (!isNodeBase(current_config.distribution.node_base) ||
+        !isNodeBase(current_config.distribution.transmission_node)) {
+        Serial.println("ERROR: Invalid module placement");
+        return false;
+    }
+    
     return true;
 }
 
@@ -214,6 +261,15 @@ void ConfigManager::printConfiguration() {
     Serial.print(current_config.transmission.shift_debounce_ms);
     Serial.println(" ms");
     
+    Serial.println("\n--- Module Placement ---");
+    Serial.print("This Node: 0x");
+    Serial.println(current_config.distribution.node_base, HEX);
+    Serial.print("Transmission Node: 0x");
+    Serial.println(current_config.distribution.transmission_node, HEX);
+    Serial.print("Forward Interval: ");
+    Serial.print(current_config.distribution.forward_interval_us);
+    Serial.println(" us");
+    
     Serial.println("========================\n");
 }
 
@@ -273,6 +329,14 @@ bool ConfigManager::updateStatusReportInterval(uint32_t interval_ms) {
     return saveConfigurationToStorage();
 }
 
+bool ConfigManager::updateModulePlacement(uint32_t node_base, uint32_t transmission_node) {
+    if (!isNodeBase(node_base) || !isNodeBase(transmission_node)) return false;
+    
+    current_config.distribution.node_base = node_base;
+    current_config.distribution.transmission_node = transmission_node;
+    return saveConfigurationToStorage();
+}
+
 bool ConfigManager::resetToDefaults() {
     Serial.println("ConfigManager: Resetting to default configuration");
     
@@ -288,15 +352,4 @@ bool ConfigManager::resetToDefaults() {
     Serial.println("ConfigManager: Reset to defaults complete");
     return true;
 }
-
-uint16_t ConfigManager::calculateConfigChecksum() {
-    // Simple checksum calculation
-    uint16_t checksum = 0;
-    uint8_t* data = (uint8_t*)&current_config;
-    
-    for (size_t i = 0; i < sizeof(ECUConfiguration); i++) {
-        checksum += data[i];
-    }
-    
-    return checksum;
-} 
\ No newline at end of file
+ 
\ No newline at end of file
@@ -4,24 +4,50 @@
 #include "ecu_config.h"
 #include "storage_manager.h"
 
+// The configuration is stored as one blob (see storage_manager.h): the
+// whole ECUConfiguration behind a versioned, CRC32-protected header, so boot
+// is one backend read plus one CRC. Bump CONFIG_IMAGE_VERSION whenever the
+// ECUConfiguration layout changes, and teach migrateConfiguration() to read
+// the previous layout. Version 0 is the format before the image: one
+// storage key per field. Version 1 is the image without the distribution
+// block.
+#define CONFIG_IMAGE_VERSION    2
+
+// Where the running configuration came from
+enum ConfigSource : uint8_t {
+    CONFIG_SOURCE_NONE = 0,
+    CONFIG_SOURCE_IMAGE,        // Current-version image
+    CONFIG_SOURCE_MIGRATED,     // Older format, rewritten as a current image
+    CONFIG_SOURCE_DEFAULTS      // Nothing usable stored
+};
+
 class ConfigManager {
 private:
     ECUConfiguration current_config;
     StorageManager* storage;
     bool config_loaded;
+    ConfigSource config_source;
     
-    // Configuration storage keys
+    // Configuration image key
+    static const char* CONFIG_KEY_IMAGE;
+    
+    // Version 0 storage keys, read only to migrate
     static const char* CONFIG_KEY_ECU_TYPE;
     static const char* CONFIG_KEY_ECU_NAME;
     static const char* CONFIG_KEY_SERIAL_NUMBER;
     static const char* CONFIG_KEY_FIRMWARE_VERSION;
     static const char* CONFIG_KEY_BOOT_TIMEOUT;
+    static const uint8_t CONFIG_ITEM_COUNT = 5;
     
     // Helper methods
+    void buildStorageItems(StorageItem* items, uint8_t* ecu_type_val);   // CONFIG_ITEM_COUNT items
     bool loadDefaultConfiguration();
     bool saveConfigurationToStorage();
+    
+    // A placement node is exactly one ECU_BASE_* value
+    static bool isNodeBase(uint32_t node) { return node != 0 && (node & ~ECU_BASE_MASK) == 0; }
     bool loadConfigurationFromStorage();
-    uint16_t calculateConfigChecksum();
+    bool migrateConfiguration();
     
 public:
     ConfigManager(StorageManager* storage_mgr);
@@ -68,12 +94,20 @@ public:
     bool isTemperatureMonitoringEnabled() const { return current_config.transmission.enable_temperature_monitoring; }
     uint32_t getShiftDebounceMs() const { return current_config.transmission.shift_debounce_ms; }
     
+    // Module placement access
+    uint32_t getNodeBase() const { return current_config.distribution.node_base; }
+    uint32_t getTransmissionNode() const { return current_config.distribution.transmission_node; }
+    bool isTransmissionLocal() const {
+        return current_config.distribution.transmission_node == current_config.distribution.node_base;
+    }
+    
     // Runtime configuration updates
     bool updateECUType(ECUType new_type);
     bool updateECUName(const char* new_name);
     bool updateSerialNumber(uint32_t new_serial);
     bool updateBootTimeout(uint32_t timeout_ms);
     bool updateStatusReportInterval(uint32_t interval_ms);
+    bool updateModulePlacement(uint32_t node_base, uint32_t transmission_node);  // Applies at next boot
     
     // Configuration validation and diagnostics
     bool validateConfiguration();
@@ -85,6 +119,7 @@ public:
     
     // Status
     bool isConfigurationLoaded() const { return config_loaded; }
+    ConfigSource getConfigSource() const { return config_source; }
 };
 
 #endif 
\ No newline at end of file
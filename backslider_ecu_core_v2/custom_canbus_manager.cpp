@@ -4,6 +4,11 @@
 #include "custom_canbus_manager.h"
 #include "external_canbus.h"
 #include "storage_manager.h"
+#include "id_hash.h"
+#include "memory_placement.h"
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
 
 // Global instance
 CustomCanBusManager g_custom_canbus_manager;
@@ -20,13 +25,17 @@ static CustomCanBusManager* g_manager_instance = nullptr;
 
 CustomCanBusManager::CustomCanBusManager() :
     mapping_count(0),
-    initialized(false)
+    initialized(false),
+    plan_count(0)
 {
     // Initialize mappings array
     for (uint8_t i = 0; i < MAX_MAPPINGS; i++) {
         mappings[i] = {};
     }
     
+    // Empty plan table
+    compile_plans();
+    
     // Initialize statistics
     reset_statistics();
 }
@@ -49,6 +58,8 @@ bool CustomCanBusManager::init() {
     //     // Continue with empty configuration
     // }
     
+    compile_plans();
+    
     // Register message handlers for all configured mappings
     for (uint8_t i = 0; i < mapping_count; i++) {
         if (mappings[i].enabled) {
@@ -114,14 +125,16 @@ bool CustomCanBusManager::add_mapping(const can_mapping_t& mapping) {
         return false;
     }
     
-    // Check for duplicate CAN ID
-    if (find_mapping_by_can_id(mapping.basic.external_can_id) >= 0) {
-        debug_print("CustomCanBusManager: CAN ID already mapped");
+    // Several signals may share a CAN ID, but not the same target
+    if (find_mapping(mapping.basic.external_can_id, mapping.basic.internal_msg_id) >= 0) {
+        debug_print("CustomCanBusManager: CAN ID already mapped to this message");
         return false;
     }
     
     // Add mapping
     mappings[mapping_count] = mapping;
+    mapping_count++;
+    compile_plans();
     
     // Register handler if enabled
     if (mapping.enabled) {
@@ -132,8 +145,6 @@ bool CustomCanBusManager::add_mapping(const can_mapping_t& mapping) {
         }
     }
     
-    mapping_count++;
-    
     debug_print("CustomCanBusManager: Added mapping");
     debug_print_mapping(mapping);
     
@@ -145,10 +156,7 @@ bool CustomCanBusManager::remove_mapping(uint8_t index) {
         return false;
     }
     
-    // Unregister handler if enabled
-    if (mappings[index].enabled) {
-        g_external_canbus.unregister_custom_handler(mappings[index].basic.external_can_id);
-    }
+    uint32_t can_id = mappings[index].basic.external_can_id;
     
     // Shift remaining mappings down
     for (uint8_t i = index; i < mapping_count - 1; i++) {
@@ -158,6 +166,10 @@ bool CustomCanBusManager::remove_mapping(uint8_t index) {
     // Clear the last mapping
     mappings[mapping_count - 1] = {};
     mapping_count--;
+    compile_plans();
+    
+    // Keep the handler while other signals still come from this frame
+    update_handler_registration(can_id);
     
     debug_print("CustomCanBusManager: Removed mapping");
     
@@ -174,18 +186,8 @@ bool CustomCanBusManager::enable_mapping(uint8_t index, bool enabled) {
     }
     
     mappings[index].enabled = enabled;
-    
-    if (enabled) {
-        // Register handler
-        if (!g_external_canbus.register_custom_handler(
-            mappings[index].basic.external_can_id, 
-            message_handler_wrapper)) {
-            debug_print("CustomCanBusManager: Warning - Failed to register handler");
-        }
-    } else {
-        // Unregister handler
-        g_external_canbus.unregister_custom_handler(mappings[index].basic.external_can_id);
-    }
+    compile_plans();
+    update_handler_registration(mappings[index].basic.external_can_id);
     
     return true;
 }
@@ -217,10 +219,168 @@ void CustomCanBusManager::clear_all_mappings() {
     }
     
     mapping_count = 0;
+    compile_plans();
     
     debug_print("CustomCanBusManager: Cleared all mappings");
 }
 
+// =============================================================================
+// DBC IMPORT
+// =============================================================================
+
+// DBC message IDs flag extended frames in bit 31
+#define DBC_EXTENDED_ID_FLAG        0x80000000u
+#define DBC_INDEPENDENT_SIGNALS_ID  0xC0000000u   // VECTOR__INDEPENDENT_SIG_MSG
+
+static const char* dbc_skip_spaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    return p;
+}
+
+// Consumes one expected character after optional spaces
+static bool dbc_expect(const char** p, const char* end, char c) {
+    *p = dbc_skip_spaces(*p, end);
+    if (*p < end && **p == c) {
+        (*p)++;
+        return true;
+    }
+    return false;
+}
+
+static const char* dbc_token_end(const char* p, const char* end) {
+    while (p < end && *p != ' ' && *p != '\t' && *p != ':') {
+        p++;
+    }
+    return p;
+}
+
+// Numbers never run past the line: strtoul/strtof stop at '|', ',', ')' etc.
+static bool dbc_number(const char** p, const char* end, float* value) {
+    *p = dbc_skip_spaces(*p, end);
+    char* after;
+    *value = strtof(*p, &after);
+    if (after == *p || after > end) {
+        return false;
+    }
+    *p = after;
+    return true;
+}
+
+static bool dbc_integer(const char** p, const char* end, uint32_t* value) {
+    *p = dbc_skip_spaces(*p, end);
+    char* after;
+    *value = (uint32_t)strtoul(*p, &after, 10);
+    if (after == *p || after > end) {
+        return false;
+    }
+    *p = after;
+    return true;
+}
+
+// SG_ <name> [M] : <start>|<length>@<order><sign> (<factor>,<offset>) [<min>|<max>] ...
+// Returns false for lines that are not importable signals.
+static bool dbc_parse_signal(const char* p, const char* end, uint32_t can_id,
+                             const char** name, size_t* name_length, can_mapping_t* mapping) {
+    p = dbc_skip_spaces(p, end);
+    *name = p;
+    p = dbc_token_end(p, end);
+    *name_length = p - *name;
+    
+    // The multiplexor switch imports; multiplexed signals (mN) do not
+    p = dbc_skip_spaces(p, end);
+    if (p < end && *p != ':') {
+        const char* indicator = p;
+        p = dbc_token_end(p, end);
+        if (p - indicator != 1 || *indicator != 'M') {
+            return false;
+        }
+    }
+    
+    uint32_t start_bit, bit_length;
+    float factor, offset, min_value, max_value;
+    if (!dbc_expect(&p, end, ':') || !dbc_integer(&p, end, &start_bit) ||
+        !dbc_expect(&p, end, '|') || !dbc_integer(&p, end, &bit_length) ||
+        !dbc_expect(&p, end, '@') || p + 2 > end) {
+        return false;
+    }
+    bool is_motorola = (p[0] == '0');
+    bool is_signed = (p[1] == '-');
+    p += 2;
+    if (!dbc_expect(&p, end, '(') || !dbc_number(&p, end, &factor) ||
+        !dbc_expect(&p, end, ',') || !dbc_number(&p, end, &offset) ||
+        !dbc_expect(&p, end, ')') ||
+        !dbc_expect(&p, end, '[') || !dbc_number(&p, end, &min_value) ||
+        !dbc_expect(&p, end, '|') || !dbc_number(&p, end, &max_value) ||
+        !dbc_expect(&p, end, ']')) {
+        return false;
+    }
+    if (start_bit > 63 || bit_length == 0 || bit_length > 32) {
+        return false;
+    }
+    
+    // [0|0] is the DBC way of leaving the range open
+    if (min_value == 0.0f && max_value == 0.0f) {
+        min_value = -FLT_MAX;
+        max_value = FLT_MAX;
+    }
+    
+    *mapping = create_can_signal(can_id, 0, (uint8_t)start_bit, (uint8_t)bit_length,
+                                 is_motorola, is_signed, factor, offset, min_value, max_value);
+    return true;
+}
+
+uint8_t CustomCanBusManager::import_dbc(const char* dbc_text, const can_dbc_binding_t* bindings, uint8_t binding_count) {
+    if (!initialized || dbc_text == nullptr || bindings == nullptr) {
+        return 0;
+    }
+    
+    uint8_t added = 0;
+    uint32_t can_id = 0;            // Message the following SG_ lines belong to
+    const char* line = dbc_text;
+    while (*line) {
+        const char* end = strchr(line, '\n');
+        if (end == nullptr) {
+            end = line + strlen(line);
+        }
+        const char* p = dbc_skip_spaces(line, end);
+        
+        if (end - p > 4 && strncmp(p, "BO_ ", 4) == 0) {
+            uint32_t dbc_id = 0;
+            p += 4;
+            if (!dbc_integer(&p, end, &dbc_id) || dbc_id == DBC_INDEPENDENT_SIGNALS_ID) {
+                can_id = 0;
+            } else {
+                can_id = (dbc_id & DBC_EXTENDED_ID_FLAG) ? (dbc_id & ~DBC_EXTENDED_ID_FLAG) : dbc_id;
+            }
+        } else if (end - p > 4 && strncmp(p, "SG_ ", 4) == 0 && can_id != 0) {
+            const char* name;
+            size_t name_length;
+            can_mapping_t mapping;
+            if (dbc_parse_signal(p + 4, end, can_id, &name, &name_length, &mapping)) {
+                for (uint8_t i = 0; i < binding_count; i++) {
+                    const can_dbc_binding_t& binding = bindings[i];
+                    if ((binding.can_id == 0 || binding.can_id == can_id) &&
+                        strlen(binding.signal_name) == name_length &&
+                        strncmp(binding.signal_name, name, name_length) == 0) {
+                        mapping.basic.internal_msg_id = binding.internal_msg_id;
+                        added += add_mapping(mapping) ? 1 : 0;
+                        break;
+                    }
+                }
+            }
+        } else if (p < end && *p != '\r') {
+            can_id = 0;                 // Any other section ends the message
+        }
+        
+        line = (*end == '\n') ? end + 1 : end;
+    }
+    
+    debug_print("CustomCanBusManager: DBC import complete");
+    return added;
+}
+
 // =============================================================================
 // PERSISTENT STORAGE
 // =============================================================================
@@ -230,19 +390,18 @@ bool CustomCanBusManager::save_configuration() {
         return false;
     }
     
-    // Save mapping count
+    // Mapping count, then 3 storage entries per mapping, in one batch
     uint8_t count = mapping_count;
-    if (!g_storage_manager.save_data(CONFIG_EXTERNAL_CANBUS_COUNT, &count, sizeof(count))) {
-        debug_print("CustomCanBusManager: Failed to save mapping count");
-        return false;
+    StorageItem items[1 + MAX_MAPPINGS * 3];
+    items[0] = {CONFIG_EXTERNAL_CANBUS_COUNT, &count, sizeof(count), false};
+    for (uint8_t i = 0; i < mapping_count; i++) {
+        mapping_storage_items(i, &mappings[i], &items[1 + i * 3]);
     }
     
-    // Save each mapping (3 storage entries per mapping)
-    for (uint8_t i = 0; i < mapping_count; i++) {
-        if (!save_mapping_to_storage(i, mappings[i])) {
-            debug_print("CustomCanBusManager: Failed to save mapping");
-            return false;
-        }
+    uint8_t total = 1 + mapping_count * 3;
+    if (g_storage_manager.save_many(items, total) != total) {
+        debug_print("CustomCanBusManager: Failed to save configuration");
+        return false;
     }
     
     debug_print("CustomCanBusManager: Configuration saved successfully");
@@ -263,21 +422,42 @@ bool CustomCanBusManager::load_configuration() {
         count = MAX_MAPPINGS;  // Clamp to maximum
     }
     
-    // Load each mapping
+    // Every mapping's entries in one batch, straight into the table
+    StorageItem items[MAX_MAPPINGS * 3];
+    for (uint8_t i = 0; i < count; i++) {
+        mappings[i] = {};
+        mapping_storage_items(i, &mappings[i], &items[i * 3]);
+    }
+    g_storage_manager.load_many(items, count * 3);
+    
+    // Extraction records saved before bit-level signals are the first 8 bytes
+    for (uint8_t i = 0; i < count; i++) {
+        if (!items[i * 3 + 1].ok) {
+            mappings[i].extraction = {};
+            items[i * 3 + 1].ok = g_storage_manager.load_data(
+                CONFIG_EXTERNAL_CANBUS_EXTRACTION(i), &mappings[i].extraction, CAN_EXTRACTION_PARAMS_V1_SIZE);
+        }
+    }
+    
+    // Keep the complete, valid ones, packed to the front
     mapping_count = 0;
     for (uint8_t i = 0; i < count; i++) {
-        can_mapping_t mapping = {};
+        if (!items[i * 3].ok || !items[i * 3 + 1].ok || !items[i * 3 + 2].ok) {
+            debug_print("CustomCanBusManager: Failed to load mapping from storage");
+            continue;
+        }
         
-        if (load_mapping_from_storage(i, &mapping)) {
-            if (is_mapping_valid(mapping)) {
-                mappings[mapping_count++] = mapping;
-            } else {
-                debug_print("CustomCanBusManager: Invalid mapping in storage - skipping");
-            }
+        // Set enabled state to true by default
+        mappings[i].enabled = true;
+        if (!is_mapping_valid(mappings[i])) {
+            debug_print("CustomCanBusManager: Invalid mapping in storage - skipping");
+        } else if (find_mapping(mappings[i].basic.external_can_id, mappings[i].basic.internal_msg_id) >= 0) {
+            debug_print("CustomCanBusManager: Duplicate mapping in storage - skipping");
         } else {
-            debug_print("CustomCanBusManager: Failed to load mapping from storage");
+            mappings[mapping_count++] = mappings[i];
         }
     }
+    compile_plans();
     
     debug_print("CustomCanBusManager: Configuration loaded successfully");
     return true;
@@ -287,52 +467,52 @@ bool CustomCanBusManager::load_configuration() {
 // MESSAGE PROCESSING
 // =============================================================================
 
-void CustomCanBusManager::handle_can_message(uint32_t can_id, const uint8_t* data, uint8_t length) {
+ECU_HOT_CODE void CustomCanBusManager::handle_can_message(uint32_t can_id, const uint8_t* data, uint8_t length) {
     if (!initialized) {
         return;
     }
     
     stats.messages_processed++;
     
-    // Find mapping for this CAN ID
-    int mapping_index = find_mapping_by_can_id(can_id);
-    if (mapping_index < 0) {
+    const PlanIndexSlot* slot = find_plans(can_id);
+    if (slot == nullptr) {
         stats.unknown_messages++;
         return;
     }
     
-    const can_mapping_t& mapping = mappings[mapping_index];
-    
-    if (!mapping.enabled) {
-        return;  // Mapping is disabled
-    }
-    
-    // Extract value from CAN message
-    float value = 0.0f;
-    if (!extract_value(data, length, mapping, &value)) {
-        // Extraction failed - error already logged in extract_value
-        return;
-    }
-    
-    // Validate extracted value
-    if (!validate_value(value, mapping)) {
-        stats.validation_errors++;
+    if (data == nullptr) {
+        stats.extraction_errors++;
         return;
     }
     
-    // Publish to internal message bus
-    g_message_bus.publishFloat(mapping.basic.internal_msg_id, value);
-    
-    stats.messages_translated++;
+    // The frame as one word in each byte order, zero past its length
+    uint64_t intel_word = 0;
+    memcpy(&intel_word, data, length < 8 ? length : 8);
+    uint64_t motorola_word = __builtin_bswap64(intel_word);
     
-    #ifdef ARDUINO
-    // Serial.print("CustomCanBusManager: CAN 0x");
-    // Serial.print(can_id, HEX);
-    // Serial.print(" -> MSG 0x");
-    // Serial.print(mapping.basic.internal_msg_id, HEX);
-    // Serial.print(" = ");
-    // Serial.println(value);
-    #endif
+    // Every signal carried by this frame
+    const SignalPlan* plan = &plans[slot->first_plan];
+    const SignalPlan* end = plan + slot->plan_count;
+    for (; plan < end; plan++) {
+        if (length < plan->frame_length) {
+            stats.extraction_errors++;
+            continue;
+        }
+        
+        uint64_t word = plan->motorola ? motorola_word : intel_word;
+        uint32_t raw = (uint32_t)(word >> plan->shift) & plan->mask;
+        float magnitude = plan->sign_bit ? (float)(int32_t)((raw ^ plan->sign_bit) - plan->sign_bit)
+                                         : (float)raw;
+        float value = magnitude * plan->scale + plan->offset;
+        
+        if (value < plan->min_value || value > plan->max_value) {
+            stats.validation_errors++;
+            continue;
+        }
+        
+        g_message_bus.publishFloat(plan->internal_msg_id, value);
+        stats.messages_translated++;
+    }
 }
 
 // Static wrapper for message handler callback
@@ -343,103 +523,163 @@ void CustomCanBusManager::message_handler_wrapper(uint32_t can_id, const uint8_t
 }
 
 // =============================================================================
-// VALUE EXTRACTION AND VALIDATION
+// PLAN COMPILATION
 // =============================================================================
 
-bool CustomCanBusManager::extract_value(const uint8_t* data, uint8_t length, const can_mapping_t& mapping, float* value) {
-    const auto& extract = mapping.extraction;
+bool CustomCanBusManager::signal_layout(const can_extraction_params_t& extract, SignalLayout* layout) {
+    bool motorola = (extract.flags & CAN_EXTRACT_FLAG_BIG_ENDIAN) != 0;
+    uint8_t start_bit = extract.start_bit;
+    uint8_t bits = extract.bit_length;
     
-    // Validate input parameters
-    if (data == nullptr || value == nullptr) {
-        stats.extraction_errors++;
-        return false;
+    // Byte-aligned fields are the DBC signal covering the same bytes
+    if (bits == 0) {
+        if (extract.byte_length == 0 || extract.byte_length > 2 || extract.byte_start > 7) {
+            return false;
+        }
+        bits = extract.byte_length * 8;
+        start_bit = extract.byte_start * 8 + (motorola ? 7 : 0);
     }
     
-    // Validate byte positions
-    if (extract.byte_start + extract.byte_length > length) {
-        stats.extraction_errors++;
+    if (bits > 32 || start_bit > 63) {
         return false;
     }
     
-    // Extract raw value based on byte length
-    uint32_t raw_value = 0;
-    
-    if (extract.byte_length == 1) {
-        // Single byte value
-        raw_value = data[extract.byte_start];
-    } else if (extract.byte_length == 2) {
-        // 16-bit value
-        if (extract.flags & CAN_EXTRACT_FLAG_BIG_ENDIAN) {
-            // Big endian: MSB first
-            raw_value = (data[extract.byte_start] << 8) | data[extract.byte_start + 1];
-        } else {
-            // Little endian: LSB first
-            raw_value = (data[extract.byte_start + 1] << 8) | data[extract.byte_start];
+    // Intel counts from the LSB of the little endian word. Motorola start bits
+    // are an MSB in byte * 8 + bit numbering; in the big endian word that bit
+    // sits (start / 8) * 8 + (7 - start % 8) places below the top.
+    uint8_t last;
+    if (motorola) {
+        last = (start_bit / 8) * 8 + (7 - start_bit % 8) + bits - 1;
+        if (last > 63) {
+            return false;
         }
+        layout->shift = 63 - last;
     } else {
-        // Invalid byte length
-        stats.extraction_errors++;
-        return false;
-    }
-    
-    // Handle signed values
-    if (extract.flags & CAN_EXTRACT_FLAG_SIGNED) {
-        if (extract.byte_length == 1) {
-            // Convert to signed 8-bit
-            int8_t signed_value = (int8_t)raw_value;
-            raw_value = (uint32_t)signed_value;
-        } else if (extract.byte_length == 2) {
-            // Convert to signed 16-bit
-            int16_t signed_value = (int16_t)raw_value;
-            raw_value = (uint32_t)signed_value;
+        last = start_bit + bits - 1;
+        if (last > 63) {
+            return false;
         }
+        layout->shift = start_bit;
     }
     
-    // Apply scale factor
-    *value = (float)raw_value * extract.scale_factor;
-    
+    layout->bits = bits;
+    layout->frame_length = last / 8 + 1;
+    layout->motorola = motorola;
     return true;
 }
 
-bool CustomCanBusManager::validate_value(float value, const can_mapping_t& mapping) {
-    const auto& validation = mapping.validation;
-    
-    // Check range
-    if (value < validation.min_value || value > validation.max_value) {
-        return false;
+void CustomCanBusManager::compile_plan(const can_mapping_t& mapping, SignalPlan* plan) {
+    const auto& extract = mapping.extraction;
+    SignalLayout layout = {};
+    signal_layout(extract, &layout);    // Mappings are validated on the way in
+    uint32_t top_bit = 1u << (layout.bits - 1);
+    
+    plan->internal_msg_id = mapping.basic.internal_msg_id;
+    plan->mask = (layout.bits == 32) ? 0xFFFFFFFFu : ((1u << layout.bits) - 1);
+    plan->scale = extract.scale_factor;
+    plan->min_value = mapping.validation.min_value;
+    plan->max_value = mapping.validation.max_value;
+    plan->shift = layout.shift;
+    plan->motorola = layout.motorola;
+    plan->frame_length = layout.frame_length;
+    
+    // Offset binary takes precedence over two's complement
+    if (extract.flags & CAN_EXTRACT_FLAG_OFFSET_BINARY) {
+        plan->sign_bit = 0;
+        plan->offset = extract.offset - (float)top_bit * extract.scale_factor;
+    } else {
+        plan->sign_bit = (extract.flags & CAN_EXTRACT_FLAG_SIGNED) ? top_bit : 0;
+        plan->offset = extract.offset;
+    }
+}
+
+void CustomCanBusManager::compile_plans() {
+    for (uint16_t i = 0; i < PLAN_INDEX_SIZE; i++) {
+        plan_index[i] = {};
     }
+    plan_count = 0;
     
-    return true;
+    // Group the enabled mappings by CAN ID, keeping configuration order
+    // within a frame; an ID's plans are all placed when it is first seen
+    for (uint8_t i = 0; i < mapping_count; i++) {
+        const can_mapping_t& first = mappings[i];
+        if (!first.enabled || find_plans(first.basic.external_can_id) != nullptr) {
+            continue;
+        }
+        
+        uint16_t position = plan_hash(first.basic.external_can_id);
+        while (plan_index[position].plan_count != 0) {
+            position = (position + 1) & (PLAN_INDEX_SIZE - 1);
+        }
+        
+        PlanIndexSlot& slot = plan_index[position];
+        slot.can_id = first.basic.external_can_id;
+        slot.first_plan = plan_count;
+        for (uint8_t j = i; j < mapping_count; j++) {
+            if (mappings[j].enabled && mappings[j].basic.external_can_id == slot.can_id) {
+                compile_plan(mappings[j], &plans[plan_count++]);
+                slot.plan_count++;
+            }
+        }
+    }
+}
+
+uint16_t CustomCanBusManager::plan_hash(uint32_t can_id) {
+    return fib_hash(can_id, PLAN_INDEX_BITS);
+}
+
+ECU_HOT_CODE const CustomCanBusManager::PlanIndexSlot* CustomCanBusManager::find_plans(uint32_t can_id) const {
+    uint16_t position = plan_hash(can_id);
+    for (uint16_t probe = 0; probe < PLAN_INDEX_SIZE; probe++) {
+        const PlanIndexSlot& slot = plan_index[position];
+        if (slot.plan_count == 0) {
+            return nullptr;
+        }
+        if (slot.can_id == can_id) {
+            return &slot;
+        }
+        position = (position + 1) & (PLAN_INDEX_SIZE - 1);
+    }
+    return nullptr;
 }
 
 // =============================================================================
 // MAPPING MANAGEMENT
 // =============================================================================
 
-int CustomCanBusManager::find_mapping_by_can_id(uint32_t can_id) {
+int CustomCanBusManager::find_mapping(uint32_t can_id, uint32_t internal_msg_id) const {
     for (uint8_t i = 0; i < mapping_count; i++) {
-        if (mappings[i].basic.external_can_id == can_id) {
+        if (mappings[i].basic.external_can_id == can_id &&
+            mappings[i].basic.internal_msg_id == internal_msg_id) {
             return i;
         }
     }
     return -1;
 }
 
+bool CustomCanBusManager::is_can_id_enabled(uint32_t can_id) const {
+    return find_plans(can_id) != nullptr;
+}
+
+void CustomCanBusManager::update_handler_registration(uint32_t can_id) {
+    if (is_can_id_enabled(can_id)) {
+        if (!g_external_canbus.register_custom_handler(can_id, message_handler_wrapper)) {
+            debug_print("CustomCanBusManager: Warning - Failed to register handler");
+        }
+    } else {
+        g_external_canbus.unregister_custom_handler(can_id);
+    }
+}
+
 bool CustomCanBusManager::is_mapping_valid(const can_mapping_t& mapping) {
     // Check basic parameters
     if (mapping.basic.external_can_id == 0 || mapping.basic.internal_msg_id == 0) {
         return false;
     }
     
-    // Check extraction parameters
-    if (mapping.extraction.byte_start > 7 || 
-        mapping.extraction.byte_length == 0 || 
-        mapping.extraction.byte_length > 2) {
-        return false;
-    }
-    
-    // Check that extraction doesn't exceed CAN message size
-    if (mapping.extraction.byte_start + mapping.extraction.byte_length > 8) {
+    // Check extraction parameters: byte or bit range inside the 8-byte frame
+    SignalLayout layout;
+    if (!signal_layout(mapping.extraction, &layout)) {
         return false;
     }
     
@@ -460,59 +700,10 @@ bool CustomCanBusManager::is_mapping_valid(const can_mapping_t& mapping) {
 // STORAGE HELPERS
 // =============================================================================
 
-bool CustomCanBusManager::save_mapping_to_storage(uint8_t index, const can_mapping_t& mapping) {
-    if (index >= MAX_MAPPINGS) {
-        return false;
-    }
-    
-    // Save basic mapping
-    if (!g_storage_manager.save_data(CONFIG_EXTERNAL_CANBUS_MAPPING(index), 
-                                   &mapping.basic, sizeof(mapping.basic))) {
-        return false;
-    }
-    
-    // Save extraction parameters
-    if (!g_storage_manager.save_data(CONFIG_EXTERNAL_CANBUS_EXTRACTION(index), 
-                                   &mapping.extraction, sizeof(mapping.extraction))) {
-        return false;
-    }
-    
-    // Save validation parameters
-    if (!g_storage_manager.save_data(CONFIG_EXTERNAL_CANBUS_VALIDATION(index), 
-                                   &mapping.validation, sizeof(mapping.validation))) {
-        return false;
-    }
-    
-    return true;
-}
-
-bool CustomCanBusManager::load_mapping_from_storage(uint8_t index, can_mapping_t* mapping) {
-    if (index >= MAX_MAPPINGS || mapping == nullptr) {
-        return false;
-    }
-    
-    // Load basic mapping
-    if (!g_storage_manager.load_data(CONFIG_EXTERNAL_CANBUS_MAPPING(index), 
-                                   &mapping->basic, sizeof(mapping->basic))) {
-        return false;
-    }
-    
-    // Load extraction parameters
-    if (!g_storage_manager.load_data(CONFIG_EXTERNAL_CANBUS_EXTRACTION(index), 
-                                   &mapping->extraction, sizeof(mapping->extraction))) {
-        return false;
-    }
-    
-    // Load validation parameters
-    if (!g_storage_manager.load_data(CONFIG_EXTERNAL_CANBUS_VALIDATION(index), 
-                                   &mapping->validation, sizeof(mapping->validation))) {
-        return false;
-    }
-    
-    // Set enabled state to true by default
-    mapping->enabled = true;
-    
-    return true;
+void CustomCanBusManager::mapping_storage_items(uint8_t index, can_mapping_t* mapping, StorageItem* items) {
+    items[0] = {CONFIG_EXTERNAL_CANBUS_MAPPING(index), &mapping->basic, sizeof(mapping->basic), false};
+    items[1] = {CONFIG_EXTERNAL_CANBUS_EXTRACTION(index), &mapping->extraction, sizeof(mapping->extraction), false};
+    items[2] = {CONFIG_EXTERNAL_CANBUS_VALIDATION(index), &mapping->validation, sizeof(mapping->validation), false};
 }
 
 // =============================================================================
@@ -571,10 +762,16 @@ void CustomCanBusManager::debug_print_mapping(const can_mapping_t& mapping) {
     #ifdef ARDUINO
     Serial.print("  External CAN ID: 0x"); Serial.println(mapping.basic.external_can_id, HEX);
     Serial.print("  Internal MSG ID: 0x"); Serial.println(mapping.basic.internal_msg_id, HEX);
-    Serial.print("  Byte Start: "); Serial.println(mapping.extraction.byte_start);
-    Serial.print("  Byte Length: "); Serial.println(mapping.extraction.byte_length);
+    if (mapping.extraction.bit_length != 0) {
+        Serial.print("  Start Bit: "); Serial.println(mapping.extraction.start_bit);
+        Serial.print("  Bit Length: "); Serial.println(mapping.extraction.bit_length);
+    } else {
+        Serial.print("  Byte Start: "); Serial.println(mapping.extraction.byte_start);
+        Serial.print("  Byte Length: "); Serial.println(mapping.extraction.byte_length);
+    }
     Serial.print("  Big Endian: "); Serial.println((mapping.extraction.flags & CAN_EXTRACT_FLAG_BIG_ENDIAN) ? "Yes" : "No");
     Serial.print("  Scale Factor: "); Serial.println(mapping.extraction.scale_factor);
+    Serial.print("  Offset: "); Serial.println(mapping.extraction.offset);
     Serial.print("  Min Value: "); Serial.println(mapping.validation.min_value);
     Serial.print("  Max Value: "); Serial.println(mapping.validation.max_value);
     Serial.print("  Enabled: "); Serial.println(mapping.enabled ? "Yes" : "No");
@@ -625,6 +822,39 @@ can_mapping_t create_can_mapping(
     return mapping;
 }
 
+can_mapping_t create_can_signal(
+    uint32_t external_can_id,
+    uint32_t internal_msg_id,
+    uint8_t start_bit,
+    uint8_t bit_length,
+    bool is_motorola,
+    bool is_signed,
+    float factor,
+    float offset,
+    float min_value,
+    float max_value
+) {
+    can_mapping_t mapping = {};
+    
+    mapping.basic.external_can_id = external_can_id;
+    mapping.basic.internal_msg_id = internal_msg_id;
+    
+    // Bit-level extraction; byte_start/byte_length stay unused
+    mapping.extraction.start_bit = start_bit;
+    mapping.extraction.bit_length = bit_length;
+    mapping.extraction.flags = (is_motorola ? CAN_EXTRACT_FLAG_BIG_ENDIAN : 0) |
+                               (is_signed ? CAN_EXTRACT_FLAG_SIGNED : 0);
+    mapping.extraction.scale_factor = factor;
+    mapping.extraction.offset = offset;
+    
+    mapping.validation.min_value = min_value;
+    mapping.validation.max_value = max_value;
+    
+    mapping.enabled = true;
+    
+    return mapping;
+}
+
 can_mapping_t create_simple_can_mapping(
     uint32_t external_can_id,
     uint32_t internal_msg_id,
@@ -7,7 +7,11 @@
 //
 // Key Features:
 // - Generic CAN message extraction (1-2 bytes, big/little endian)
+// - Bit-level signals: any start bit and length, Intel or Motorola order
+// - Import of signal definitions from a DBC subset
 // - Configurable scaling and validation
+// - Several signals per CAN frame, all extracted in one pass
+// - Mappings compiled into an ID-indexed table of extraction plans
 // - Integration with internal message bus
 // - Persistent configuration storage
 // - No vendor-specific code or dependencies
@@ -18,6 +22,37 @@
 //   3. Save configuration using save_configuration()
 //   4. Manager automatically handles incoming CAN messages
 //
+// Compiled plans:
+//   Every add/remove/enable/load recompiles the enabled mappings into plans
+//   grouped by CAN ID: byte positions, mask, sign bit, scale, offset and
+//   bounds are worked out once, so a received frame costs one hashed lookup
+//   and a straight loop over its signals. A CAN ID may feed several internal
+//   messages; only an identical (CAN ID, internal message) pair is rejected.
+//   Byte-aligned and bit-level mappings compile to the same plan: a shift and
+//   mask into the frame read as one 64-bit word (little endian for Intel,
+//   big endian for Motorola), both words loaded once per frame.
+//
+// Bit-level signals (DBC conventions):
+//   A mapping with extraction.bit_length != 0 ignores byte_start/byte_length.
+//   start_bit is the DBC start bit - the LSB for Intel, the MSB for Motorola
+//   (CAN_EXTRACT_FLAG_BIG_ENDIAN), numbered byte * 8 + bit. Values are
+//   raw * scale_factor + offset, as a DBC "(factor,offset)".
+//
+//   can_mapping_t speed = create_can_signal(
+//       0x4B0, MSG_VEHICLE_SPEED, 0, 16, false, false, 0.01f, -100.0f, 0.0f, 300.0f);
+//
+// DBC import:
+//   import_dbc() reads BO_/SG_ lines from DBC text and adds a mapping for every
+//   signal the caller binds to an internal message. Multiplexed signals (mN),
+//   float signals and signals wider than 32 bits are skipped. A [0|0] range
+//   means "unbounded".
+//
+//   static const can_dbc_binding_t bindings[] = {
+//       {"VEHICLE_SPEED", 0, MSG_VEHICLE_SPEED},
+//       {"ENGINE_SPEED",  0, MSG_ENGINE_RPM},
+//   };
+//   g_custom_canbus_manager.import_dbc(dbc_text, bindings, 2);
+//
 // Example:
 //   // Map external CAN ID 0x360 to internal throttle position
 //   can_mapping_t throttle_mapping = create_can_mapping(
@@ -56,15 +91,23 @@ typedef struct {
     uint32_t internal_msg_id;      // 4 bytes - Target internal message ID
 } __attribute__((packed)) can_mapping_basic_t;
 
-// Generic extraction parameters (8 bytes)
+// Generic extraction parameters (16 bytes; the first 8 are the original
+// byte-aligned record, which still loads from storage)
 typedef struct {
     uint8_t byte_start;             // 1 byte - Starting byte position (0-7)
     uint8_t byte_length;            // 1 byte - Number of bytes (1-2)
     uint8_t flags;                  // 1 byte - Extraction flags (endianness, signed, etc.)
     uint8_t reserved;               // 1 byte - Reserved for future use
     float scale_factor;             // 4 bytes - Scale factor (raw_value * scale_factor)
+    uint8_t start_bit;              // 1 byte - Bit-level: DBC start bit (0-63)
+    uint8_t bit_length;             // 1 byte - Bit-level: length in bits (1-32), 0 = byte-aligned
+    uint16_t reserved2;             // 2 bytes - Reserved for future use
+    float offset;                   // 4 bytes - Added after scaling
 } __attribute__((packed)) can_extraction_params_t;
 
+// Size of the byte-aligned record saved before bit-level signals existed
+#define CAN_EXTRACTION_PARAMS_V1_SIZE   8
+
 // Generic validation parameters (8 bytes)
 typedef struct {
     float min_value;                // 4 bytes - Minimum valid value
@@ -72,9 +115,9 @@ typedef struct {
 } __attribute__((packed)) can_validation_params_t;
 
 // Flags for extraction parameters
-#define CAN_EXTRACT_FLAG_BIG_ENDIAN     0x01    // Use big endian byte order
+#define CAN_EXTRACT_FLAG_BIG_ENDIAN     0x01    // Use big endian (Motorola) byte order
 #define CAN_EXTRACT_FLAG_SIGNED         0x02    // Interpret as signed value
-#define CAN_EXTRACT_FLAG_OFFSET_BINARY  0x04    // Use offset binary encoding
+#define CAN_EXTRACT_FLAG_OFFSET_BINARY  0x04    // Use offset binary encoding (raw - 2^(bits-1))
 
 // Complete mapping definition (runtime structure)
 typedef struct {
@@ -84,6 +127,13 @@ typedef struct {
     bool enabled;                       // Enable/disable this mapping
 } can_mapping_t;
 
+// Binds a DBC signal to the internal message it is published as
+typedef struct {
+    const char* signal_name;            // SG_ name in the DBC
+    uint32_t can_id;                    // Only in this message; 0 = any message
+    uint32_t internal_msg_id;           // Target internal message ID
+} can_dbc_binding_t;
+
 // Statistics structure
 typedef struct {
     uint32_t messages_processed;        // Total messages processed
@@ -100,7 +150,11 @@ typedef struct {
 class CustomCanBusManager {
 public:
     // Configuration constants
-    static const uint8_t MAX_MAPPINGS = 16;     // Maximum number of mappings
+    static const uint8_t MAX_MAPPINGS = 64;     // Maximum number of mappings
+    
+    // Plan index sizing (power of two, >= 2x MAX_MAPPINGS so probes stay short)
+    static const uint8_t PLAN_INDEX_BITS = 7;
+    static const uint16_t PLAN_INDEX_SIZE = (1u << PLAN_INDEX_BITS);
     
     // Constructor
     CustomCanBusManager();
@@ -138,6 +192,9 @@ public:
     // Clear all mappings
     void clear_all_mappings();
     
+    // Add a mapping for every bound signal in DBC text; returns mappings added
+    uint8_t import_dbc(const char* dbc_text, const can_dbc_binding_t* bindings, uint8_t binding_count);
+    
     // =========================================================================
     // PERSISTENT STORAGE
     // =========================================================================
@@ -185,6 +242,39 @@ private:
     // Statistics
     custom_canbus_stats_t stats;
     
+    // One enabled mapping, compiled for the receive path
+    struct SignalPlan {
+        uint32_t internal_msg_id;
+        uint32_t mask;                  // Low bit_length bits
+        uint32_t sign_bit;              // Top bit for signed values, else 0
+        float scale;
+        float offset;                   // Mapping offset plus any offset binary bias
+        float min_value;
+        float max_value;
+        uint8_t shift;                  // Of the LSB within the frame word
+        uint8_t motorola;               // Read the big endian frame word
+        uint8_t frame_length;           // Bytes the frame must carry
+    };
+    
+    // Where a mapping's bits sit in the frame, in plan terms
+    struct SignalLayout {
+        uint8_t shift;
+        uint8_t bits;
+        uint8_t frame_length;
+        bool motorola;
+    };
+    
+    // Plans of one CAN ID are contiguous: plans[first_plan .. first_plan + plan_count)
+    struct PlanIndexSlot {
+        uint32_t can_id;
+        uint8_t first_plan;
+        uint8_t plan_count;             // 0 = empty slot
+    };
+    
+    SignalPlan plans[MAX_MAPPINGS];
+    uint8_t plan_count;
+    PlanIndexSlot plan_index[PLAN_INDEX_SIZE];
+    
     // =========================================================================
     // PRIVATE METHODS
     // =========================================================================
@@ -193,17 +283,21 @@ private:
     void handle_can_message(uint32_t can_id, const uint8_t* data, uint8_t length);
     static void message_handler_wrapper(uint32_t can_id, const uint8_t* data, uint8_t length);
     
-    // Value extraction and validation
-    bool extract_value(const uint8_t* data, uint8_t length, const can_mapping_t& mapping, float* value);
-    bool validate_value(float value, const can_mapping_t& mapping);
+    // Plan compilation and lookup
+    void compile_plans();
+    static void compile_plan(const can_mapping_t& mapping, SignalPlan* plan);
+    static bool signal_layout(const can_extraction_params_t& extract, SignalLayout* layout);
+    static uint16_t plan_hash(uint32_t can_id);
+    const PlanIndexSlot* find_plans(uint32_t can_id) const;
     
     // Mapping management
-    int find_mapping_by_can_id(uint32_t can_id);
+    int find_mapping(uint32_t can_id, uint32_t internal_msg_id) const;
+    bool is_can_id_enabled(uint32_t can_id) const;
+    void update_handler_registration(uint32_t can_id);
     bool is_mapping_valid(const can_mapping_t& mapping);
     
-    // Storage helpers
-    bool save_mapping_to_storage(uint8_t index, const can_mapping_t& mapping);
-    bool load_mapping_from_storage(uint8_t index, can_mapping_t* mapping);
+    // Storage helpers: the three batch items of one mapping
+    void mapping_storage_items(uint8_t index, can_mapping_t* mapping, StorageItem* items);
     
     // Debug helpers
     void debug_print(const char* message);
@@ -221,9 +315,9 @@ private:
 #define CONFIG_EXTERNAL_CANBUS_MAPPING_BASE  MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x0100)
 
 // Individual mapping storage keys
-#define CONFIG_EXTERNAL_CANBUS_MAPPING(index)      (CONFIG_EXTERNAL_CANBUS_MAPPING_BASE + (index * 3))
-#define CONFIG_EXTERNAL_CANBUS_EXTRACTION(index)   (CONFIG_EXTERNAL_CANBUS_MAPPING_BASE + (index * 3) + 1)
-#define CONFIG_EXTERNAL_CANBUS_VALIDATION(index)   (CONFIG_EXTERNAL_CANBUS_MAPPING_BASE + (index * 3) + 2)
+#define CONFIG_EXTERNAL_CANBUS_MAPPING(index)      ((uint32_t)(CONFIG_EXTERNAL_CANBUS_MAPPING_BASE + (index) * 3))
+#define CONFIG_EXTERNAL_CANBUS_EXTRACTION(index)   ((uint32_t)(CONFIG_EXTERNAL_CANBUS_MAPPING_BASE + (index) * 3 + 1))
+#define CONFIG_EXTERNAL_CANBUS_VALIDATION(index)   ((uint32_t)(CONFIG_EXTERNAL_CANBUS_MAPPING_BASE + (index) * 3 + 2))
 
 // =============================================================================
 // HELPER FUNCTIONS
@@ -241,6 +335,20 @@ can_mapping_t create_can_mapping(
     float max_value
 );
 
+// Create a bit-level signal mapping (DBC start bit, length, factor and offset)
+can_mapping_t create_can_signal(
+    uint32_t external_can_id,
+    uint32_t internal_msg_id,
+    uint8_t start_bit,
+    uint8_t bit_length,
+    bool is_motorola,
+    bool is_signed,
+    float factor,
+    float offset,
+    float min_value,
+    float max_value
+);
+
 // Create a simple CAN mapping with default parameters
 can_mapping_t create_simple_can_mapping(
     uint32_t external_can_id,
@@ -2,6 +2,7 @@
 // Implementation of custom message protocol handler
 
 #include "custom_message_handler.h"
+#include "ecu_time.h"
 
 // ============================================================================
 // CONSTRUCTOR AND INITIALIZATION
@@ -9,8 +10,10 @@
 
 CustomMessageHandler::CustomMessageHandler(ExternalCanBusCache* cache) :
     cache(cache),
+    tx_scheduler(nullptr),
     initialized(false),
-    last_update_time(0)
+    last_update_time(0),
+    receive_set_version(0)
 {
     // Initialize statistics
     reset_statistics();
@@ -36,6 +39,7 @@ bool CustomMessageHandler::init() {
     value_providers.clear();
     message_configs.clear();
     last_transmission_time.clear();
+    receive_set_version++;
     
     // Reset statistics
     reset_statistics();
@@ -52,11 +56,18 @@ void CustomMessageHandler::shutdown() {
         return;
     }
     
+    if (tx_scheduler != nullptr) {
+        for (auto& config_pair : message_configs) {
+            tx_scheduler->remove_periodic_slot(config_pair.first);
+        }
+    }
+    
     // Clear all containers
     message_handlers.clear();
     value_providers.clear();
     message_configs.clear();
     last_transmission_time.clear();
+    receive_set_version++;
     
     initialized = false;
     debug_print("CustomMessageHandler: Shutdown complete");
@@ -67,12 +78,18 @@ void CustomMessageHandler::update() {
         return;
     }
     
-    // Process scheduled transmissions
-    process_scheduled_transmissions();
+    // Process scheduled transmissions (the TX scheduler times them otherwise)
+    if (tx_scheduler == nullptr) {
+        process_scheduled_transmissions();
+    }
     
     last_update_time = millis();
 }
 
+void CustomMessageHandler::set_tx_scheduler(CanTxScheduler* scheduler) {
+    tx_scheduler = scheduler;
+}
+
 // ============================================================================
 // MESSAGE HANDLER REGISTRATION
 // ============================================================================
@@ -83,6 +100,7 @@ bool CustomMessageHandler::register_handler(uint32_t can_id, custom_message_hand
     }
     
     message_handlers[can_id] = handler;
+    receive_set_version++;
     
     char debug_msg[60];
     snprintf(debug_msg, sizeof(debug_msg), 
@@ -100,6 +118,7 @@ bool CustomMessageHandler::unregister_handler(uint32_t can_id) {
     auto it = message_handlers.find(can_id);
     if (it != message_handlers.end()) {
         message_handlers.erase(it);
+        receive_set_version++;
         
         char debug_msg[60];
         snprintf(debug_msg, sizeof(debug_msg), 
@@ -151,10 +170,18 @@ bool CustomMessageHandler::configure_message(const custom_message_config_t& conf
     }
     
     message_configs[config.can_id] = config;
+    receive_set_version++;
     
     // Initialize transmission tracking for transmit messages
     if (config.is_transmit && config.transmit_interval_ms > 0) {
         last_transmission_time[config.can_id] = 0;
+        if (tx_scheduler != nullptr &&
+            !tx_scheduler->add_periodic_slot(config.can_id, config.transmit_interval_ms,
+                                             CAN_TX_PRIORITY_NORMAL, fill_periodic_frame, this)) {
+            stats.transmission_timeouts++;
+        }
+    } else if (tx_scheduler != nullptr) {
+        tx_scheduler->remove_periodic_slot(config.can_id);
     }
     
     char debug_msg[100];
@@ -191,6 +218,7 @@ bool CustomMessageHandler::remove_message_config(uint32_t can_id) {
     auto config_it = message_configs.find(can_id);
     if (config_it != message_configs.end()) {
         message_configs.erase(config_it);
+        receive_set_version++;
     }
     
     auto time_it = last_transmission_time.find(can_id);
@@ -198,9 +226,50 @@ bool CustomMessageHandler::remove_message_config(uint32_t can_id) {
         last_transmission_time.erase(time_it);
     }
     
+    if (tx_scheduler != nullptr) {
+        tx_scheduler->remove_periodic_slot(can_id);
+    }
+    
     return true;
 }
 
+bool CustomMessageHandler::wants_message(uint32_t can_id) const {
+    if (message_handlers.find(can_id) != message_handlers.end()) {
+        return true;
+    }
+    auto config_it = message_configs.find(can_id);
+    return (config_it != message_configs.end() && !config_it->second.is_transmit);
+}
+
+uint32_t CustomMessageHandler::get_receive_ids(uint32_t* ids, uint32_t max_ids) const {
+    // Merge the two sorted maps, skipping transmit-only configs
+    uint32_t count = 0;
+    auto handler_it = message_handlers.begin();
+    auto config_it = message_configs.begin();
+    while (handler_it != message_handlers.end() || config_it != message_configs.end()) {
+        if (config_it != message_configs.end() && config_it->second.is_transmit) {
+            ++config_it;
+            continue;
+        }
+        uint32_t can_id;
+        if (config_it == message_configs.end() ||
+            (handler_it != message_handlers.end() && handler_it->first < config_it->first)) {
+            can_id = (handler_it++)->first;
+        } else if (handler_it == message_handlers.end() || config_it->first < handler_it->first) {
+            can_id = (config_it++)->first;
+        } else {
+            can_id = handler_it->first;
+            ++handler_it;
+            ++config_it;
+        }
+        if (ids != nullptr && count < max_ids) {
+            ids[count] = can_id;
+        }
+        count++;
+    }
+    return count;
+}
+
 // ============================================================================
 // MESSAGE PROCESSING
 // ============================================================================
@@ -269,13 +338,39 @@ void CustomMessageHandler::process_scheduled_transmissions() {
     }
 }
 
+bool CustomMessageHandler::fill_periodic_frame(uint32_t can_id, CAN_message_t* msg, void* context) {
+    CustomMessageHandler* handler = static_cast<CustomMessageHandler*>(context);
+    custom_message_config_t* config = handler->find_message_config(can_id);
+    float value;
+    if (config == nullptr || !handler->get_value_for_transmission(config->external_key, &value)) {
+        return false;
+    }
+    
+    msg->len = sizeof(float);
+    memcpy(msg->buf, &value, sizeof(float));
+    handler->last_transmission_time[can_id] = millis();
+    handler->stats.messages_sent++;
+    return true;
+}
+
 bool CustomMessageHandler::send_message(uint32_t can_id, const uint8_t* data, uint8_t length) {
     if (!initialized || data == nullptr || length > 8) {
         return false;
     }
     
-    // For this implementation, we'll just track statistics
-    // In a real implementation, this would send via the parent ExternalCanBus
+    if (tx_scheduler != nullptr) {
+        CAN_message_t msg = {};
+        msg.id = can_id;
+        msg.len = length;
+        msg.flags.extended = (can_id > 0x7FF);
+        memcpy(msg.buf, data, length);
+        if (!tx_scheduler->submit(msg, CAN_TX_PRIORITY_NORMAL, ecu_time_us())) {
+            stats.transmission_timeouts++;
+            return false;
+        }
+    }
+    
+    // Without a scheduler there is no bus to send on; just track statistics
     stats.messages_sent++;
     
     char debug_msg[80];
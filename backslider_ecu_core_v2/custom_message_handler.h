@@ -7,6 +7,7 @@
 
 #include "msg_definitions.h"
 #include "external_canbus_cache.h"
+#include "can_tx_scheduler.h"
 
 #ifdef ARDUINO
     #include <Arduino.h>
@@ -64,6 +65,10 @@ public:
     // Update function - call periodically for scheduled transmissions
     void update();
     
+    // With a scheduler, TX configs with an interval become periodic slots and
+    // send_message() queues through it; without one, update() times them
+    void set_tx_scheduler(CanTxScheduler* scheduler);
+    
     // =========================================================================
     // MESSAGE HANDLER REGISTRATION
     // =========================================================================
@@ -88,6 +93,13 @@ public:
     // Remove message configuration
     bool remove_message_config(uint32_t can_id);
     
+    // CAN IDs this handler receives: registered handlers plus RX configs.
+    // get_receive_ids() fills up to max_ids in ascending order and returns
+    // the total; the version changes whenever the set may have changed.
+    bool wants_message(uint32_t can_id) const;
+    uint32_t get_receive_ids(uint32_t* ids, uint32_t max_ids) const;
+    uint32_t get_receive_set_version() const { return receive_set_version; }
+    
     // =========================================================================
     // MESSAGE PROCESSING
     // =========================================================================
@@ -161,8 +173,10 @@ private:
     // =========================================================================
     
     ExternalCanBusCache* cache;         // Reference to cache system
+    CanTxScheduler* tx_scheduler;       // Owned by ExternalCanBus, may be null
     bool initialized;
     uint32_t last_update_time;
+    uint32_t receive_set_version;
     
     // Statistics
     custom_message_stats_t stats;
@@ -186,6 +200,7 @@ private:
     // Message processing
     void process_incoming_message(const CAN_message_t& msg);
     void process_scheduled_transmissions();
+    static bool fill_periodic_frame(uint32_t can_id, CAN_message_t* msg, void* context);
     
     // Data conversion
     float extract_float_from_message(const CAN_message_t& msg);
@@ -1,4 +1,5 @@
 #include "ecu_config.h"
+#include "memory_placement.h"
 
 #ifndef MSBFIRST
 #define MSBFIRST 1
@@ -11,7 +12,7 @@
 // =============================================================================
 // TRANSMISSION CONTROLLER CONFIGURATION
 // =============================================================================
-const ECUConfiguration ECU_TRANSMISSION_CONFIG = {
+constexpr ECUConfiguration ECU_TRANSMISSION_CONFIG ECU_CONST_DATA = {
     .ecu_type = ECU_TRANSMISSION,
     .ecu_name = "Backslider Transmission",
     .firmware_version = "2.0.0",
@@ -99,7 +100,8 @@ const ECUConfiguration ECU_TRANSMISSION_CONFIG = {
             .frequency = 25000000, // 25MHz - conservative for external flash
             .mode = 0,             // SPI Mode 0
             .bit_order = MSBFIRST, // MSB first
-            .enabled = true        // Enable external flash
+            .enabled = true,       // Enable external flash
+            .memory_mapped = false // On LPSPI, not the FlexSPI2 pads
         },
         
         // Future SPI devices
@@ -162,7 +164,11 @@ const ECUConfiguration ECU_TRANSMISSION_CONFIG = {
         .enable_obdii = true,        // Disable OBD-II for now
         .enable_custom_messages = true, // Disable custom messages for now
         .can_bus_number = 1,          // CAN1
-        .cache_default_max_age_ms = 1000 // 1 second cache timeout
+        .cache_default_max_age_ms = 1000, // 1 second cache timeout
+        .tx_utilisation_cap_pct = 60, // Leave 40% of the bus to other nodes
+        .enable_fd = false,           // Classic CAN on CAN1
+        .fd_data_baudrate = 2000000,
+        .fd_packed_can_id = 0x6E0
     },
     
     // Boot behavior
@@ -177,5 +183,12 @@ const ECUConfiguration ECU_TRANSMISSION_CONFIG = {
         .enable_pressure_control = true,   // Control line pressure
         .enable_temperature_monitoring = true, // Monitor fluid temperature
         .shift_debounce_ms = 50            // 50ms shift debounce
+    },
+    
+    // Module placement - everything on this ECU
+    .distribution = {
+        .node_base = ECU_BASE_PRIMARY,
+        .transmission_node = ECU_BASE_PRIMARY,
+        .forward_interval_us = 10000       // 100 Hz per forwarded value
     }
 }; 
\ No newline at end of file
@@ -68,6 +68,7 @@ struct SPIDeviceConfig {
     uint8_t mode;              // 0, 1, 2, 3
     uint8_t bit_order;         // MSBFIRST, LSBFIRST
     bool enabled;
+    bool memory_mapped;        // Flash on the FlexSPI2 pads: reads through the mapped window
 };
 
 struct SPIConfiguration {
@@ -110,12 +111,23 @@ struct ECUConfiguration {
         bool enable_temperature_monitoring;
         uint32_t shift_debounce_ms;
     } transmission;
+    
+    // Module placement across ECUs on the external CAN bus (can_router.h).
+    // Nodes are ECU_BASE_* values; every ECU carries the same placement and
+    // its own node_base.
+    struct {
+        uint32_t node_base;            // This ECU
+        uint32_t transmission_node;    // ECU that runs the transmission module
+        uint32_t forward_interval_us;  // Minimum spacing per forwarded ID
+    } distribution;
 };
 
 // =============================================================================
 // CONFIGURATION PRESETS
 // =============================================================================
-// Default configuration for Transmission Controller
+// Default configuration for Transmission Controller. Built at compile time
+// (constexpr) and kept in flash; ConfigManager copies it when no stored
+// image is usable.
 extern const ECUConfiguration ECU_TRANSMISSION_CONFIG;
 
 // Future configurations
@@ -0,0 +1,50 @@
+// ecu_time.h
+// Shared microsecond time base for message timestamps
+
+/* =============================================================================
+ * ECU TIME OVERVIEW
+ * =============================================================================
+ *
+ * Every message on the bus is stamped once, at publish, with ecu_time_us()
+ * in CANMessage::timestamp_us. The stamp then travels with the message
+ * unchanged:
+ *
+ *   publish / publishFromISR ──► queue lanes ──► subscribers
+ *                                                 ├─► serial v2 records (all 32 bits)
+ *                                                 ├─► SD log records
+ *                                                 └─► broadcast cache ──► serial / CAN
+ *
+ * so a host can subtract stamps for end-to-end latency, publish rates and
+ * jitter without guessing which module filled the field in. A coalesced
+ * message carries the stamp of its newest value.
+ *
+ * Formats with no room keep what they can: legacy serial frames carry the
+ * FlexCAN frame, whose 16-bit timestamp holds the low bits of the stamp,
+ * and CAN frames on the wire carry none.
+ *
+ * The clock is micros(): one free-running 32-bit counter for every module
+ * and interrupt. It wraps every 71.6 minutes; the difference of two stamps
+ * less than a wrap apart is exact in unsigned arithmetic.
+ *
+ * EXAMPLE:
+ *   uint32_t age_us = ecu_time_us() - msg->timestamp_us;
+ * =============================================================================
+ */
+
+#ifndef ECU_TIME_H
+#define ECU_TIME_H
+
+#include <stdint.h>
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+// Now, on the clock every message stamp is taken from
+inline uint32_t ecu_time_us(void) {
+    return micros();
+}
+
+#endif
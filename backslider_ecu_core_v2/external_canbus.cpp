@@ -5,6 +5,9 @@
 #include "obdii_handler.h"
 #include "custom_message_handler.h"
 #include "parameter_helpers.h"
+#include "memory_placement.h"
+#include "ecu_time.h"
+#include <stddef.h>
 #include <map>
 
 #ifdef ARDUINO
@@ -18,6 +21,33 @@ ExternalCanBus g_external_canbus;
 // Static pointer for message bus callback (since callbacks can't be member functions)
 static ExternalCanBus* g_canbus_instance = nullptr;
 
+// Instance the CAN receive interrupt feeds (set while the bus is up)
+static ExternalCanBus* volatile g_rx_instance = nullptr;
+
+// Classic view of a frame of up to 8 bytes
+static void fd_to_classic(const CANFD_message_t& fd, CAN_message_t* msg) {
+    *msg = CAN_message_t();
+    msg->id = fd.id;
+    msg->timestamp = fd.timestamp;
+    msg->flags.extended = fd.flags.extended;
+    msg->len = (fd.len > 8) ? 8 : fd.len;
+    memcpy(msg->buf, fd.buf, msg->len);
+}
+
+// CAN FD data lengths above 8 bytes come in fixed steps
+static uint8_t fd_padded_length(uint8_t length) {
+    static const uint8_t fd_lengths[] = {12, 16, 20, 24, 32, 48, 64};
+    if (length <= 8) {
+        return length;
+    }
+    for (uint8_t i = 0; i < sizeof(fd_lengths); i++) {
+        if (length <= fd_lengths[i]) {
+            return fd_lengths[i];
+        }
+    }
+    return CAN_FD_MAX_PAYLOAD;
+}
+
 // ============================================================================
 // CONSTRUCTOR AND INITIALIZATION
 // ============================================================================
@@ -26,20 +56,36 @@ ExternalCanBus::ExternalCanBus() :
     #ifdef ARDUINO
     can_bus(nullptr),
     #endif
+    rx_queue_head(0),
+    rx_queue_tail(0),
+    rx_timestamp_us(0),
+    rx_fd_queue_head(0),
+    rx_fd_queue_tail(0),
+    rx_bits(0),
+    rx_bits_seen(0),
+    fast_handler_count(0),
     initialized(false),
+    fd_mode(false),
     obdii_enabled(false),
     custom_messages_enabled(false),
     last_message_time(0),
     last_update_time(0),
+    acceptance_filter_count(0),
+    software_filtering(true),
+    acceptance_filters_dirty(false),
+    custom_receive_version(0),
     cache(nullptr),
     obdii_handler(nullptr),
-    custom_handler(nullptr)
+    custom_handler(nullptr),
+    link_receiver(nullptr)
 {
     // Initialize configuration with defaults
     config = DEFAULT_EXTERNAL_CANBUS_CONFIG;
+    memset(pack_buffers, 0, sizeof(pack_buffers));
     
     // Initialize statistics
     reset_statistics();
+    reset_telemetry();
 }
 
 ExternalCanBus::~ExternalCanBus() {
@@ -62,6 +108,18 @@ bool ExternalCanBus::init(const external_canbus_config_t& config) {
     
     debug_print("ExternalCanBus: Initializing...");
     
+    // FlexCAN_T4FD only drives CAN3
+    fd_mode = config.enable_fd && config.can_bus_number == 3;
+    if (config.enable_fd && !fd_mode) {
+        debug_print("ExternalCanBus: CAN FD needs CAN3 - using classic CAN");
+    }
+    memset(pack_buffers, 0, sizeof(pack_buffers));
+    
+    // All transmits go through the scheduler from here on
+    tx_scheduler.init(config.baudrate, config.tx_utilisation_cap_pct, write_tx_mailbox, this,
+                      fd_mode ? config.fd_data_baudrate : 0);
+    reset_telemetry();
+    
     // Initialize cache system
     cache = new ExternalCanBusCache();
     if (cache == nullptr || !cache->init(config.cache_default_max_age_ms)) {
@@ -78,6 +136,7 @@ bool ExternalCanBus::init(const external_canbus_config_t& config) {
             cache = nullptr;
             return false;
         }
+        obdii_handler->set_tx_scheduler(&tx_scheduler);
         obdii_enabled = true;
     }
     
@@ -92,6 +151,7 @@ bool ExternalCanBus::init(const external_canbus_config_t& config) {
             cache = nullptr;
             return false;
         }
+        custom_handler->set_tx_scheduler(&tx_scheduler);
         custom_messages_enabled = true;
     }
     
@@ -102,6 +162,10 @@ bool ExternalCanBus::init(const external_canbus_config_t& config) {
         return false;
     }
     
+    // Only let wanted frames through the RX FIFO
+    rebuild_acceptance_filters();
+    apply_acceptance_filters();
+    
     // Set up message bus integration
     setup_message_bus_integration();
     
@@ -130,6 +194,8 @@ void ExternalCanBus::shutdown() {
     
     debug_print("ExternalCanBus: Shutting down...");
     
+    tx_scheduler.shutdown();
+    
     // Shutdown subsystems
     if (obdii_handler != nullptr) {
         obdii_handler->shutdown();
@@ -150,24 +216,48 @@ void ExternalCanBus::shutdown() {
     }
     
     // Cleanup CAN bus
+    g_rx_instance = nullptr;
     #ifdef ARDUINO
     if (can_bus != nullptr) {
         switch (config.can_bus_number) {
             case 1:
+                ((FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_16>*)can_bus)->enableFIFOInterrupt(false);
                 delete (FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_16>*)can_bus;
                 break;
             case 2:
+                ((FlexCAN_T4<CAN2, RX_SIZE_256, TX_SIZE_16>*)can_bus)->enableFIFOInterrupt(false);
                 delete (FlexCAN_T4<CAN2, RX_SIZE_256, TX_SIZE_16>*)can_bus;
                 break;
             case 3:
+                if (fd_mode) {
+                    ((FlexCAN_T4FD<CAN3, RX_SIZE_256, TX_SIZE_16>*)can_bus)->enableMBInterrupts(false);
+                    delete (FlexCAN_T4FD<CAN3, RX_SIZE_256, TX_SIZE_16>*)can_bus;
+                    break;
+                }
+                ((FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16>*)can_bus)->enableFIFOInterrupt(false);
                 delete (FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16>*)can_bus;
                 break;
         }
         can_bus = nullptr;
     }
+    #else
+    if (fd_mode) {
+        mock_can.enableMBInterrupts(false);
+    } else {
+        mock_can.enableFIFOInterrupt(false);
+    }
     #endif
+    rx_queue_head = 0;
+    rx_queue_tail = 0;
+    rx_fd_queue_head = 0;
+    rx_fd_queue_tail = 0;
+    memset(pack_buffers, 0, sizeof(pack_buffers));
+    rx_bits = 0;
+    rx_bits_seen = 0;
+    fast_handler_count = 0;
     
     initialized = false;
+    fd_mode = false;
     obdii_enabled = false;
     custom_messages_enabled = false;
     
@@ -185,12 +275,29 @@ void ExternalCanBus::update() {
     
     uint32_t current_time = millis();
     
+    // Reprogram filters if the wanted IDs changed
+    update_acceptance_filters();
+    
     // Process incoming messages
     process_incoming_messages();
+    process_incoming_fd_messages();
     
-    // Process outgoing messages
+    // Continue segmented OBD-II responses
+    if (obdii_handler != nullptr) {
+        obdii_handler->update(ecu_time_us());
+    }
+    
+    // Send partly filled packed frames, then process outgoing messages
+    flush_packed_values();
     process_outgoing_messages();
     
+    // Controller error states, then the telemetry window
+    poll_bus_errors();
+    update_telemetry(ecu_time_us());
+    
+    // Requests the ECU never answered; stops at the first still in time
+    request_tracker.cleanup_timeouts();
+    
     // Update subsystems
     if (cache != nullptr) {
         cache->update();
@@ -206,6 +313,28 @@ void ExternalCanBus::update() {
 // CAN BUS HARDWARE SETUP
 // ============================================================================
 
+// FD mode: 64-byte mailboxes, MB0-9 receive (standard, then extended IDs),
+// one TX mailbox per scheduler class. Same calls on FlexCAN_T4FD and MockFlexCAN.
+template <typename Bus>
+static void configure_fd_bus(Bus* bus, uint32_t baudrate, uint32_t data_baudrate) {
+    CANFD_timings_t timings;
+    timings.clock = CLK_24MHz;
+    timings.baudrate = baudrate;
+    timings.baudrateFD = data_baudrate;
+    timings.propdelay = 190;
+    timings.bus_length = 1;
+    timings.sample = 70;
+    bus->setBaudRate(timings);
+    bus->setRegions(64);
+    for (uint8_t mb = 0; mb < CAN_TX_FIRST_MAILBOX; mb++) {
+        bus->setMB((FLEXCAN_MAILBOX)mb, RX, (mb < CAN_TX_FIRST_MAILBOX / 2) ? STD : EXT);
+    }
+    for (uint8_t mb = 0; mb < CAN_TX_PRIORITY_COUNT; mb++) {
+        bus->setMB((FLEXCAN_MAILBOX)(CAN_TX_FIRST_MAILBOX + mb), TX);
+    }
+    bus->setMBFilter(ACCEPT_ALL);
+}
+
 bool ExternalCanBus::setup_can_bus() {
     #ifdef ARDUINO
     // Initialize FlexCAN hardware
@@ -217,7 +346,11 @@ bool ExternalCanBus::setup_can_bus() {
             can_bus = new FlexCAN_T4<CAN2, RX_SIZE_256, TX_SIZE_16>();
             break;
         case 3:
-            can_bus = new FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16>();
+            if (fd_mode) {
+                can_bus = new FlexCAN_T4FD<CAN3, RX_SIZE_256, TX_SIZE_16>();
+            } else {
+                can_bus = new FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16>();
+            }
             break;
         default:
             debug_print("ExternalCanBus: Invalid CAN bus number");
@@ -229,7 +362,10 @@ bool ExternalCanBus::setup_can_bus() {
         return false;
     }
     
-    // Configure CAN bus - need to cast void* to concrete type
+    // Configure CAN bus - need to cast void* to concrete type. Frames are
+    // taken in the FIFO interrupt; events() is never called, so the library
+    // runs on_can_receive() straight from its ISR.
+    g_rx_instance = this;
     switch (config.can_bus_number) {
         case 1: {
             auto* can1 = static_cast<FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_16>*>(can_bus);
@@ -237,9 +373,9 @@ bool ExternalCanBus::setup_can_bus() {
             can1->setBaudRate(config.baudrate);
             can1->setMaxMB(16);
             can1->enableFIFO();
-            if (obdii_enabled) {
-                can1->setFIFOFilter(0, OBDII_REQUEST_ID, STD);
-            }
+            can1->setRFFN(RFFN_16);
+            can1->onReceive(on_can_receive);
+            can1->enableFIFOInterrupt();
             break;
         }
         case 2: {
@@ -248,28 +384,42 @@ bool ExternalCanBus::setup_can_bus() {
             can2->setBaudRate(config.baudrate);
             can2->setMaxMB(16);
             can2->enableFIFO();
-            if (obdii_enabled) {
-                can2->setFIFOFilter(0, OBDII_REQUEST_ID, STD);
-            }
+            can2->setRFFN(RFFN_16);
+            can2->onReceive(on_can_receive);
+            can2->enableFIFOInterrupt();
             break;
         }
         case 3: {
+            if (fd_mode) {
+                auto* can3fd = static_cast<FlexCAN_T4FD<CAN3, RX_SIZE_256, TX_SIZE_16>*>(can_bus);
+                can3fd->begin();
+                configure_fd_bus(can3fd, config.baudrate, config.fd_data_baudrate);
+                can3fd->onReceive(on_canfd_receive);
+                can3fd->enableMBInterrupts();
+                break;
+            }
             auto* can3 = static_cast<FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16>*>(can_bus);
             can3->begin();
             can3->setBaudRate(config.baudrate);
             can3->setMaxMB(16);
             can3->enableFIFO();
-            if (obdii_enabled) {
-                can3->setFIFOFilter(0, OBDII_REQUEST_ID, STD);
-            }
+            can3->setRFFN(RFFN_16);
+            can3->onReceive(on_can_receive);
+            can3->enableFIFOInterrupt();
             break;
         }
     }
     
     char debug_msg[100];
-    snprintf(debug_msg, sizeof(debug_msg), 
-            "ExternalCanBus: CAN%d initialized at %lu baud", 
-            config.can_bus_number, config.baudrate);
+    if (fd_mode) {
+        snprintf(debug_msg, sizeof(debug_msg),
+                "ExternalCanBus: CAN%d FD initialized at %lu/%lu baud",
+                config.can_bus_number, config.baudrate, config.fd_data_baudrate);
+    } else {
+        snprintf(debug_msg, sizeof(debug_msg), 
+                "ExternalCanBus: CAN%d initialized at %lu baud", 
+                config.can_bus_number, config.baudrate);
+    }
     debug_print(debug_msg);
     
     #else
@@ -278,6 +428,17 @@ bool ExternalCanBus::setup_can_bus() {
         debug_print("ExternalCanBus: Failed to initialize mock CAN");
         return false;
     }
+    g_rx_instance = this;
+    if (fd_mode) {
+        configure_fd_bus(&mock_can, config.baudrate, config.fd_data_baudrate);
+        mock_can.onReceive(on_canfd_receive);
+        mock_can.enableMBInterrupts();
+    } else {
+        mock_can.enableFIFO();
+        mock_can.setRFFN(RFFN_16);
+        mock_can.onReceive(on_can_receive);
+        mock_can.enableFIFOInterrupt();
+    }
     
     debug_print("ExternalCanBus: Mock CAN bus initialized");
     #endif
@@ -294,59 +455,148 @@ void ExternalCanBus::process_incoming_messages() {
         return;
     }
     
-    #ifdef ARDUINO
-    if (can_bus == nullptr) {
+    // Drain the frames queued when we got here; later ones wait for the
+    // next update(). A slot is only reused once tail has passed it.
+    uint32_t head = __atomic_load_n(&rx_queue_head, __ATOMIC_ACQUIRE);
+    uint32_t tail = rx_queue_tail;
+    if (tail == head) {
         return;
     }
+    last_message_time = millis();
     
-    // Read all available messages (need to cast void* to concrete type)
-    bool has_message = false;
-    switch (config.can_bus_number) {
-        case 1:
-            has_message = static_cast<FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->read(rx_msg);
-            break;
-        case 2:
-            has_message = static_cast<FlexCAN_T4<CAN2, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->read(rx_msg);
-            break;
-        case 3:
-            has_message = static_cast<FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->read(rx_msg);
-            break;
+    while (tail != head) {
+        const rx_frame_t& frame = rx_queue[tail & (EXTERNAL_CANBUS_RX_QUEUE_SIZE - 1)];
+        stats.messages_received++;
+        count_id_frames(frame.msg.id, 1);
+        
+        // The FIFO accepts everything once the filter table overflows
+        if (software_filtering && !is_wanted_message(frame.msg)) {
+            stats.messages_filtered++;
+        } else {
+            // Route message to appropriate handler
+            rx_timestamp_us = frame.timestamp_us;
+            route_incoming_message(frame.msg);
+        }
+        
+        tail++;
+        __atomic_store_n(&rx_queue_tail, tail, __ATOMIC_RELEASE);
     }
+}
+
+void ExternalCanBus::process_incoming_fd_messages() {
+    uint32_t head = __atomic_load_n(&rx_fd_queue_head, __ATOMIC_ACQUIRE);
+    uint32_t tail = rx_fd_queue_tail;
+    if (tail == head) {
+        return;
+    }
+    last_message_time = millis();
     
-    while (has_message) {
+    while (tail != head) {
+        const rx_fd_frame_t& frame = rx_fd_queue[tail & (EXTERNAL_CANBUS_FD_RX_QUEUE_SIZE - 1)];
         stats.messages_received++;
-        last_message_time = millis();
-        
-        // Route message to appropriate handler
-        route_incoming_message(rx_msg);
+        stats.fd_frames_received++;
+        count_id_frames(frame.msg.id, 1);
+        rx_timestamp_us = frame.timestamp_us;
+        route_fd_message(frame.msg);
         
-        // Check for next message
-        switch (config.can_bus_number) {
-            case 1:
-                has_message = static_cast<FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->read(rx_msg);
-                break;
-            case 2:
-                has_message = static_cast<FlexCAN_T4<CAN2, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->read(rx_msg);
-                break;
-            case 3:
-                has_message = static_cast<FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->read(rx_msg);
-                break;
+        tail++;
+        __atomic_store_n(&rx_fd_queue_tail, tail, __ATOMIC_RELEASE);
+    }
+}
+
+ECU_HOT_CODE void ExternalCanBus::on_can_receive(const CAN_message_t& msg) {
+    ExternalCanBus* bus = g_rx_instance;
+    if (bus != nullptr) {
+        bus->receive_from_isr(msg, CanTxScheduler::frame_bits(msg));
+    }
+}
+
+ECU_HOT_CODE void ExternalCanBus::on_canfd_receive(const CANFD_message_t& msg) {
+    ExternalCanBus* bus = g_rx_instance;
+    if (bus != nullptr) {
+        bus->receive_fd_from_isr(msg);
+    }
+}
+
+ECU_HOT_CODE void ExternalCanBus::receive_fd_from_isr(const CANFD_message_t& msg) {
+    uint32_t bits = tx_scheduler.frame_bits(msg);
+    
+    // Short frames share the classic ring, filters and fast handlers
+    if (msg.len <= 8) {
+        CAN_message_t classic;
+        fd_to_classic(msg, &classic);
+        receive_from_isr(classic, bits);
+        return;
+    }
+    
+    uint32_t timestamp_us = ecu_time_us();
+    rx_bits = rx_bits + bits;
+    
+    uint32_t head = rx_fd_queue_head;
+    uint32_t tail = __atomic_load_n(&rx_fd_queue_tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= EXTERNAL_CANBUS_FD_RX_QUEUE_SIZE) {
+        stats.rx_queue_overflows++;
+        return;
+    }
+    
+    rx_fd_frame_t& slot = rx_fd_queue[head & (EXTERNAL_CANBUS_FD_RX_QUEUE_SIZE - 1)];
+    slot.msg = msg;
+    slot.timestamp_us = timestamp_us;
+    __atomic_store_n(&rx_fd_queue_head, head + 1, __ATOMIC_RELEASE);
+}
+
+ECU_HOT_CODE void ExternalCanBus::receive_from_isr(const CAN_message_t& msg, uint32_t bits) {
+    uint32_t timestamp_us = ecu_time_us();
+    rx_bits = rx_bits + bits;
+    
+    uint8_t count = fast_handler_count;
+    for (uint8_t i = 0; i < count; i++) {
+        if (fast_handlers[i].can_id == msg.id) {
+            if (fast_handlers[i].handler(msg, timestamp_us)) {
+                stats.fast_path_frames++;
+                fast_handlers[i].frames++;
+                return;
+            }
+            break;
         }
     }
     
-    #else
-    // Mock implementation for testing
-    if (mock_can.read(rx_msg)) {
-        stats.messages_received++;
-        last_message_time = millis();
-        route_incoming_message(rx_msg);
+    uint32_t head = rx_queue_head;
+    uint32_t tail = __atomic_load_n(&rx_queue_tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= EXTERNAL_CANBUS_RX_QUEUE_SIZE) {
+        stats.rx_queue_overflows++;
+        return;
     }
-    #endif
+    
+    rx_frame_t& slot = rx_queue[head & (EXTERNAL_CANBUS_RX_QUEUE_SIZE - 1)];
+    slot.msg = msg;
+    slot.timestamp_us = timestamp_us;
+    __atomic_store_n(&rx_queue_head, head + 1, __ATOMIC_RELEASE);
+}
+
+uint16_t ExternalCanBus::get_rx_queue_depth() const {
+    uint32_t head = __atomic_load_n(&rx_queue_head, __ATOMIC_ACQUIRE);
+    return (uint16_t)(head - rx_queue_tail);
+}
+
+bool ExternalCanBus::has_fast_handler(uint32_t can_id) const {
+    for (uint8_t i = 0; i < fast_handler_count; i++) {
+        if (fast_handlers[i].can_id == can_id) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void ExternalCanBus::process_outgoing_messages() {
-    // Currently, outgoing messages are sent immediately in response functions
-    // This function is reserved for future buffered output implementation
+    // Frames received since the last update count towards the bus load
+    uint32_t bits = rx_bits;
+    tx_scheduler.note_rx_bits(bits - rx_bits_seen);
+    rx_bits_seen = bits;
+    
+    // Release due periodic messages and retry frames held by the cap or a
+    // busy mailbox
+    tx_scheduler.update(ecu_time_us());
 }
 
 void ExternalCanBus::route_incoming_message(const CAN_message_t& msg) {
@@ -361,6 +611,12 @@ void ExternalCanBus::route_incoming_message(const CAN_message_t& msg) {
         return;
     }
     
+    // Data from a module on another ECU
+    if (msg.flags.extended && link_receiver != nullptr && link_receiver(msg.id, msg.buf, msg.len)) {
+        stats.link_messages++;
+        return;
+    }
+    
     // Check if it's a parameter message - route to internal message bus
     if (is_parameter_message(msg)) {
         route_parameter_message(msg);
@@ -381,8 +637,42 @@ void ExternalCanBus::route_incoming_message(const CAN_message_t& msg) {
     debug_print("ExternalCanBus: Unknown message type received");
 }
 
+void ExternalCanBus::route_fd_message(const CANFD_message_t& msg) {
+    if (!is_fd_packing_enabled() || msg.id != config.fd_packed_can_id) {
+        stats.messages_filtered++;
+        debug_print("ExternalCanBus: Unhandled CAN FD frame");
+        return;
+    }
+    
+    // Each entry becomes the parameter_msg_t a classic peer would have sent
+    const can_fd_packed_msg_t* packed = (const can_fd_packed_msg_t*)msg.buf;
+    uint8_t room = (msg.len > 8) ? (uint8_t)((msg.len - 8) / sizeof(can_fd_packed_entry_t)) : 0;
+    if (packed->version != CAN_FD_PACK_VERSION || packed->count > room) {
+        handle_error("ExternalCanBus: Malformed packed FD frame");
+        return;
+    }
+    
+    for (uint8_t i = 0; i < packed->count; i++) {
+        can_fd_packed_entry_t entry;
+        memcpy(&entry, &packed->entries[i], sizeof(entry));
+        
+        parameter_msg_t param = {};
+        param.operation = packed->operation;
+        param.value = entry.value;
+        
+        CAN_message_t frame = {};
+        frame.id = entry.msg_id;
+        frame.flags.extended = (entry.msg_id > CAN_STANDARD_ID_MASK);
+        frame.len = sizeof(parameter_msg_t);
+        memcpy(frame.buf, &param, sizeof(param));
+        
+        route_parameter_message(frame);
+        stats.parameter_messages++;
+    }
+}
+
 bool ExternalCanBus::is_obdii_message(const CAN_message_t& msg) {
-    return (msg.id == OBDII_REQUEST_ID);
+    return (msg.id == OBDII_REQUEST_ID || msg.id == OBDII_PHYSICAL_REQUEST_ID);
 }
 
 bool ExternalCanBus::is_custom_message(const CAN_message_t& msg) {
@@ -411,16 +701,18 @@ void ExternalCanBus::route_parameter_message(const CAN_message_t& msg) {
     if (msg.len == sizeof(parameter_msg_t)) {
         parameter_msg_t* param = (parameter_msg_t*)internal_msg.buf;
         
-        // Only add routing for read/write requests (not responses)
-        if (param->operation == PARAM_OP_READ_REQUEST || 
-            param->operation == PARAM_OP_WRITE_REQUEST) {
+        // Only add routing for requests (not responses); a batch is tracked
+        // once, on the frame that gets the response
+        if (is_parameter_request_operation(param->operation)) {
             
             // Add routing metadata
             param->source_channel = CHANNEL_CAN_BUS;
-            param->request_id = request_tracker.get_next_request_id();
-            
-            // Track this request
-            request_tracker.add_request(CHANNEL_CAN_BUS, msg.id);
+            // Tracked requests are tagged with the ID their entry is filed under
+            if (is_tracked_parameter_operation(param->operation)) {
+                param->request_id = request_tracker.add_request(CHANNEL_CAN_BUS, msg.id);
+            } else {
+                param->request_id = request_tracker.get_next_request_id();
+            }
         }
     }
     
@@ -430,11 +722,33 @@ void ExternalCanBus::route_parameter_message(const CAN_message_t& msg) {
     debug_print("ExternalCanBus: Parameter message routed to internal message bus");
 }
 
-bool ExternalCanBus::send_can_message(const CAN_message_t& msg) {
+bool ExternalCanBus::send_can_message(const CAN_message_t& msg, can_tx_priority_t priority) {
+    CANFD_message_t fd;
+    CanTxScheduler::classic_to_fd(msg, &fd);
+    return send_can_message(fd, priority);
+}
+
+bool ExternalCanBus::send_can_message(const CANFD_message_t& msg, can_tx_priority_t priority) {
     if (!initialized) {
         return false;
     }
     
+    // Queued, and written at once when the class and the budget allow
+    if (!tx_scheduler.submit(msg, priority, ecu_time_us())) {
+        stats.errors++;
+        debug_print("ExternalCanBus: TX queue full - message dropped");
+        return false;
+    }
+    return true;
+}
+
+bool ExternalCanBus::write_mailbox(uint8_t mailbox, const CANFD_message_t& msg) {
+    FLEXCAN_MAILBOX mb = (FLEXCAN_MAILBOX)mailbox;
+    CAN_message_t classic;
+    if (!fd_mode) {
+        fd_to_classic(msg, &classic);
+    }
+    
     #ifdef ARDUINO
     if (can_bus == nullptr) {
         return false;
@@ -443,29 +757,190 @@ bool ExternalCanBus::send_can_message(const CAN_message_t& msg) {
     bool success = false;
     switch (config.can_bus_number) {
         case 1:
-            success = static_cast<FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->write(msg);
+            success = static_cast<FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->write(mb, classic) > 0;
             break;
         case 2:
-            success = static_cast<FlexCAN_T4<CAN2, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->write(msg);
+            success = static_cast<FlexCAN_T4<CAN2, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->write(mb, classic) > 0;
             break;
         case 3:
-            success = static_cast<FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->write(msg);
+            if (fd_mode) {
+                success = static_cast<FlexCAN_T4FD<CAN3, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->write(mb, msg) > 0;
+            } else {
+                success = static_cast<FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->write(mb, classic) > 0;
+            }
             break;
     }
     
     #else
-    bool success = mock_can.write(msg);
+    bool success = fd_mode ? (mock_can.write(mb, msg) > 0) : (mock_can.write(mb, classic) > 0);
     #endif
     
+    // A busy mailbox is not an error: the scheduler keeps the frame
     if (success) {
         stats.messages_sent++;
+        count_id_frames(msg.id, 1);
         // debug_print_message(msg, "Sent");
+    }
+    return success;
+}
+
+bool ExternalCanBus::write_tx_mailbox(uint8_t mailbox, const CANFD_message_t& msg, void* context) {
+    return static_cast<ExternalCanBus*>(context)->write_mailbox(mailbox, msg);
+}
+
+// ============================================================================
+// ACCEPTANCE FILTERING
+// ============================================================================
+
+// Same calls on every FlexCAN_T4 instance (and MockFlexCAN)
+template <typename Bus>
+static void program_fifo_filters(Bus* bus, const can_acceptance_filter_t* filters,
+                                 uint8_t count, bool accept_all) {
+    if (accept_all) {
+        bus->setFIFOFilter(ACCEPT_ALL);
+        return;
+    }
+    bus->setFIFOFilter(REJECT_ALL);
+    for (uint8_t i = 0; i < count; i++) {
+        bus->setFIFOUserFilter(i, filters[i].id, filters[i].mask, filters[i].extended ? EXT : STD);
+    }
+}
+
+void ExternalCanBus::update_acceptance_filters() {
+    uint32_t version = (custom_handler != nullptr) ? custom_handler->get_receive_set_version() : 0;
+    if (!acceptance_filters_dirty && version == custom_receive_version) {
+        return;
+    }
+    rebuild_acceptance_filters();
+    apply_acceptance_filters();
+}
+
+bool ExternalCanBus::add_acceptance_filter(uint32_t id, uint32_t mask, bool extended) {
+    for (uint8_t i = 0; i < acceptance_filter_count; i++) {
+        const can_acceptance_filter_t& filter = acceptance_filters[i];
+        if (filter.extended == extended && filter.mask == mask && filter.id == (id & mask)) {
+            return true;    // Already in the table
+        }
+    }
+    if (acceptance_filter_count >= EXTERNAL_CANBUS_FILTER_SLOTS) {
+        return false;
+    }
+    acceptance_filters[acceptance_filter_count].id = id & mask;
+    acceptance_filters[acceptance_filter_count].mask = mask;
+    acceptance_filters[acceptance_filter_count].extended = extended;
+    acceptance_filter_count++;
+    return true;
+}
+
+bool ExternalCanBus::add_id_acceptance_filter(uint32_t can_id) {
+    if (can_id <= CAN_STANDARD_ID_MASK) {
+        return add_acceptance_filter(can_id, CAN_STANDARD_ID_MASK, false);
+    }
+    if ((can_id & CAN_PARAMETER_FILTER_MASK) == CAN_PARAMETER_FILTER_ID) {
+        return true;    // Already inside the parameter range
+    }
+    return add_acceptance_filter(can_id, CAN_EXTENDED_ID_MASK, true);
+}
+
+void ExternalCanBus::rebuild_acceptance_filters() {
+    acceptance_filter_count = 0;
+    acceptance_filters_dirty = false;
+    bool fits = true;
+    
+    if (obdii_enabled) {
+        fits &= add_acceptance_filter(OBDII_REQUEST_ID, CAN_STANDARD_ID_MASK, false);
+        fits &= add_acceptance_filter(OBDII_PHYSICAL_REQUEST_ID, CAN_STANDARD_ID_MASK, false);
+    }
+    fits &= add_acceptance_filter(CAN_PARAMETER_FILTER_ID, CAN_PARAMETER_FILTER_MASK, true);
+    
+    if (custom_messages_enabled && custom_handler != nullptr) {
+        custom_receive_version = custom_handler->get_receive_set_version();
+        
+        uint32_t ids[EXTERNAL_CANBUS_FILTER_SLOTS];
+        uint32_t total = custom_handler->get_receive_ids(ids, EXTERNAL_CANBUS_FILTER_SLOTS);
+        if (total > EXTERNAL_CANBUS_FILTER_SLOTS) {
+            fits = false;
+        }
+        for (uint32_t i = 0; fits && i < total; i++) {
+            fits = add_id_acceptance_filter(ids[i]);
+        }
+    }
+    
+    for (uint8_t i = 0; fits && i < fast_handler_count; i++) {
+        fits = add_id_acceptance_filter(fast_handlers[i].can_id);
+    }
+    
+    // FD mode receives into mailboxes without the FIFO filter table
+    software_filtering = !fits || fd_mode;
+    if (software_filtering) {
+        acceptance_filter_count = 0;
+    }
+    
+    char debug_msg[80];
+    if (fd_mode) {
+        snprintf(debug_msg, sizeof(debug_msg), "ExternalCanBus: CAN FD - filtering in software");
+    } else if (software_filtering) {
+        snprintf(debug_msg, sizeof(debug_msg),
+                "ExternalCanBus: More than %d filters needed - filtering in software",
+                EXTERNAL_CANBUS_FILTER_SLOTS);
     } else {
-        stats.errors++;
-        debug_print("ExternalCanBus: Failed to send message");
+        snprintf(debug_msg, sizeof(debug_msg),
+                "ExternalCanBus: %d acceptance filters", acceptance_filter_count);
+    }
+    debug_print(debug_msg);
+}
+
+void ExternalCanBus::apply_acceptance_filters() {
+    if (fd_mode) {
+        return;     // Mailboxes accept all (configure_fd_bus)
     }
     
-    return success;
+    #ifdef ARDUINO
+    if (can_bus == nullptr) {
+        return;
+    }
+    
+    switch (config.can_bus_number) {
+        case 1:
+            program_fifo_filters(static_cast<FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_16>*>(can_bus),
+                                 acceptance_filters, acceptance_filter_count, software_filtering);
+            break;
+        case 2:
+            program_fifo_filters(static_cast<FlexCAN_T4<CAN2, RX_SIZE_256, TX_SIZE_16>*>(can_bus),
+                                 acceptance_filters, acceptance_filter_count, software_filtering);
+            break;
+        case 3:
+            program_fifo_filters(static_cast<FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16>*>(can_bus),
+                                 acceptance_filters, acceptance_filter_count, software_filtering);
+            break;
+    }
+    
+    #else
+    program_fifo_filters(&mock_can, acceptance_filters, acceptance_filter_count, software_filtering);
+    #endif
+}
+
+bool ExternalCanBus::is_wanted_message(const CAN_message_t& msg) const {
+    if (msg.flags.extended) {
+        if ((msg.id & CAN_PARAMETER_FILTER_MASK) == CAN_PARAMETER_FILTER_ID) {
+            return true;
+        }
+    } else if (obdii_enabled && (msg.id == OBDII_REQUEST_ID || msg.id == OBDII_PHYSICAL_REQUEST_ID)) {
+        return true;
+    }
+    if (has_fast_handler(msg.id)) {
+        return true;
+    }
+    return custom_messages_enabled && custom_handler != nullptr &&
+           custom_handler->wants_message(msg.id);
+}
+
+bool ExternalCanBus::get_acceptance_filter(uint8_t index, can_acceptance_filter_t* filter) const {
+    if (filter == nullptr || index >= acceptance_filter_count) {
+        return false;
+    }
+    *filter = acceptance_filters[index];
+    return true;
 }
 
 // ============================================================================
@@ -478,12 +953,14 @@ void ExternalCanBus::enable_obdii(bool enable) {
     }
     
     obdii_enabled = enable;
+    acceptance_filters_dirty = true;
     
     if (enable && obdii_handler == nullptr) {
         // Initialize OBD-II handler if not already done
         obdii_handler = new OBDIIHandler(cache);
         if (obdii_handler != nullptr) {
             obdii_handler->init();
+            obdii_handler->set_tx_scheduler(&tx_scheduler);
         }
     }
     
@@ -565,7 +1042,60 @@ bool ExternalCanBus::unregister_custom_handler(uint32_t can_id) {
     return custom_handler->unregister_handler(can_id);
 }
 
-bool ExternalCanBus::send_custom_message(uint32_t can_id, const uint8_t* data, uint8_t length) {
+bool ExternalCanBus::register_fast_handler(uint32_t can_id, can_fast_rx_handler_t handler) {
+    if (!initialized || handler == nullptr) {
+        return false;
+    }
+    
+    bool registered = false;
+    #ifdef ARDUINO
+    noInterrupts();
+    #endif
+    for (uint8_t i = 0; i < fast_handler_count; i++) {
+        if (fast_handlers[i].can_id == can_id) {
+            fast_handlers[i].handler = handler;
+            registered = true;
+            break;
+        }
+    }
+    if (!registered && fast_handler_count < EXTERNAL_CANBUS_MAX_FAST_HANDLERS) {
+        fast_handlers[fast_handler_count].can_id = can_id;
+        fast_handlers[fast_handler_count].handler = handler;
+        fast_handlers[fast_handler_count].frames = 0;
+        fast_handler_count++;
+        registered = true;
+    }
+    #ifdef ARDUINO
+    interrupts();
+    #endif
+    
+    acceptance_filters_dirty |= registered;
+    return registered;
+}
+
+bool ExternalCanBus::unregister_fast_handler(uint32_t can_id) {
+    bool removed = false;
+    #ifdef ARDUINO
+    noInterrupts();
+    #endif
+    for (uint8_t i = 0; i < fast_handler_count; i++) {
+        if (fast_handlers[i].can_id == can_id) {
+            fast_handlers[i] = fast_handlers[fast_handler_count - 1];
+            fast_handler_count--;
+            removed = true;
+            break;
+        }
+    }
+    #ifdef ARDUINO
+    interrupts();
+    #endif
+    
+    acceptance_filters_dirty |= removed;
+    return removed;
+}
+
+bool ExternalCanBus::send_custom_message(uint32_t can_id, const uint8_t* data, uint8_t length,
+                                         can_tx_priority_t priority) {
     if (!initialized || data == nullptr || length > 8) {
         return false;
     }
@@ -573,12 +1103,13 @@ bool ExternalCanBus::send_custom_message(uint32_t can_id, const uint8_t* data, u
     CAN_message_t msg = {};
     msg.id = can_id;
     msg.len = length;
+    msg.flags.extended = (can_id > CAN_STANDARD_ID_MASK);
     memcpy(msg.buf, data, length);
     #ifdef ARDUINO
     msg.timestamp = micros();
     #endif
     
-    return send_can_message(msg);
+    return send_can_message(msg, priority);
 }
 
 bool ExternalCanBus::send_custom_float(uint32_t can_id, float value) {
@@ -589,6 +1120,117 @@ bool ExternalCanBus::send_custom_uint32(uint32_t can_id, uint32_t value) {
     return send_custom_message(can_id, (const uint8_t*)&value, sizeof(uint32_t));
 }
 
+bool ExternalCanBus::send_fd_message(uint32_t can_id, const uint8_t* data, uint8_t length,
+                                     can_tx_priority_t priority) {
+    if (!initialized || !fd_mode || data == nullptr || length > CAN_FD_MAX_PAYLOAD) {
+        return false;
+    }
+    
+    CANFD_message_t msg;
+    msg.id = can_id;
+    msg.flags.extended = (can_id > CAN_STANDARD_ID_MASK);
+    msg.len = fd_padded_length(length);
+    msg.brs = 1;
+    msg.edl = 1;
+    memset(msg.buf, 0, sizeof(msg.buf));
+    memcpy(msg.buf, data, length);
+    
+    return send_can_message(msg, priority);
+}
+
+bool ExternalCanBus::send_packed_value(uint32_t msg_id, float value, uint8_t operation,
+                                       can_tx_priority_t priority) {
+    if (!initialized || !is_fd_packing_enabled()) {
+        return false;
+    }
+    
+    pack_buffer_t* buffer = nullptr;
+    pack_buffer_t* free_buffer = nullptr;
+    for (uint8_t i = 0; i < EXTERNAL_CANBUS_PACK_BUFFERS; i++) {
+        if (pack_buffers[i].frame.count == 0) {
+            if (free_buffer == nullptr) {
+                free_buffer = &pack_buffers[i];
+            }
+        } else if (pack_buffers[i].frame.operation == operation) {
+            buffer = &pack_buffers[i];
+            break;
+        }
+    }
+    
+    if (buffer == nullptr) {
+        if (free_buffer == nullptr) {
+            // Every buffer holds another operation: send the first one early
+            free_buffer = &pack_buffers[0];
+            flush_pack_buffer(*free_buffer);
+        }
+        buffer = free_buffer;
+        memset(&buffer->frame, 0, sizeof(buffer->frame));
+        buffer->frame.version = CAN_FD_PACK_VERSION;
+        buffer->frame.operation = operation;
+        buffer->priority = priority;
+    }
+    
+    // The frame goes at the most urgent priority of the values in it
+    if (priority < buffer->priority) {
+        buffer->priority = priority;
+    }
+    
+    can_fd_packed_entry_t entry = {msg_id, value};
+    memcpy(&buffer->frame.entries[buffer->frame.count], &entry, sizeof(entry));
+    buffer->frame.count++;
+    stats.packed_values_sent++;
+    
+    if (buffer->frame.count >= CAN_FD_PACK_MAX_ENTRIES) {
+        flush_pack_buffer(*buffer);
+    }
+    return true;
+}
+
+void ExternalCanBus::flush_packed_values() {
+    for (uint8_t i = 0; i < EXTERNAL_CANBUS_PACK_BUFFERS; i++) {
+        flush_pack_buffer(pack_buffers[i]);
+    }
+}
+
+void ExternalCanBus::flush_pack_buffer(pack_buffer_t& buffer) {
+    if (buffer.frame.count == 0) {
+        return;
+    }
+    
+    uint8_t length = (uint8_t)(offsetof(can_fd_packed_msg_t, entries) +
+                               buffer.frame.count * sizeof(can_fd_packed_entry_t));
+    if (send_fd_message(config.fd_packed_can_id, (const uint8_t*)&buffer.frame, length,
+                        buffer.priority)) {
+        stats.packed_frames_sent++;
+    }
+    buffer.frame.count = 0;
+}
+
+bool ExternalCanBus::add_periodic_message(uint32_t can_id, uint32_t period_ms, can_tx_priority_t priority,
+                                          can_tx_fill_t fill, void* context, uint32_t phase_ms) {
+    if (!initialized) {
+        return false;
+    }
+    
+    if (!tx_scheduler.add_periodic_slot(can_id, period_ms, priority, fill, context, phase_ms)) {
+        char debug_msg[90];
+        snprintf(debug_msg, sizeof(debug_msg),
+                "ExternalCanBus: Periodic 0x%03X every %lums rejected (cap %d%%)",
+                (unsigned)can_id, (unsigned long)period_ms, tx_scheduler.get_utilisation_cap());
+        debug_print(debug_msg);
+        return false;
+    }
+    return true;
+}
+
+bool ExternalCanBus::remove_periodic_message(uint32_t can_id) {
+    return tx_scheduler.remove_periodic_slot(can_id);
+}
+
+bool ExternalCanBus::set_periodic_payload(uint32_t can_id, const uint8_t* data, uint8_t length) {
+    return tx_scheduler.set_periodic_payload(can_id, data, length);
+}
+
 bool ExternalCanBus::get_custom_value(uint32_t external_key, float* value) {
     if (!initialized || cache == nullptr || value == nullptr) {
         return false;
@@ -689,6 +1331,201 @@ void ExternalCanBus::update_statistics() {
     }
 }
 
+// ============================================================================
+// BUS TELEMETRY
+// ============================================================================
+
+void ExternalCanBus::poll_bus_errors() {
+    CAN_error_t error;
+    #ifdef ARDUINO
+    if (can_bus == nullptr) {
+        return;
+    }
+    switch (config.can_bus_number) {
+        case 1:
+            while (static_cast<FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->error(error, false)) {
+                record_bus_error(error);
+            }
+            break;
+        case 2:
+            while (static_cast<FlexCAN_T4<CAN2, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->error(error, false)) {
+                record_bus_error(error);
+            }
+            break;
+        case 3:
+            if (fd_mode) {
+                while (static_cast<FlexCAN_T4FD<CAN3, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->error(error, false)) {
+                    record_bus_error(error);
+                }
+            } else {
+                while (static_cast<FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16>*>(can_bus)->error(error, false)) {
+                    record_bus_error(error);
+                }
+            }
+            break;
+    }
+    #else
+    while (mock_can.error(error, false)) {
+        record_bus_error(error);
+    }
+    #endif
+}
+
+void ExternalCanBus::record_bus_error(const CAN_error_t& error) {
+    stats.error_reports++;
+    stats.tx_error_counter = error.TX_ERR_COUNTER;
+    stats.rx_error_counter = error.RX_ERR_COUNTER;
+    
+    uint8_t fltconf = (uint8_t)((error.ESR1 >> CAN_ESR1_FLTCONF_SHIFT) & CAN_ESR1_FLTCONF_MASK);
+    uint8_t state = (fltconf >= CAN_FAULT_BUS_OFF) ? (uint8_t)CAN_FAULT_BUS_OFF : fltconf;
+    
+    // BOFFINT catches a bus-off the controller already recovered from
+    if ((state == CAN_FAULT_BUS_OFF || (error.ESR1 & CAN_ESR1_BOFFINT)) &&
+        stats.fault_state != CAN_FAULT_BUS_OFF) {
+        stats.bus_off_events++;
+        debug_print("ExternalCanBus: Controller went bus-off");
+    } else if (state == CAN_FAULT_ERROR_PASSIVE && stats.fault_state == CAN_FAULT_ERROR_ACTIVE) {
+        stats.error_passive_events++;
+    }
+    stats.fault_state = state;
+}
+
+void ExternalCanBus::count_id_frames(uint32_t can_id, uint32_t frames) {
+    // Space-Saving: an unknown ID takes over the smallest entry and inherits
+    // its count, so a real heavy hitter is never missed
+    rate_entry_t* smallest = nullptr;
+    for (uint8_t i = 0; i < rate_table_count; i++) {
+        if (rate_table[i].can_id == can_id) {
+            rate_table[i].count += frames;
+            return;
+        }
+        if (smallest == nullptr || rate_table[i].count < smallest->count) {
+            smallest = &rate_table[i];
+        }
+    }
+    if (rate_table_count < EXTERNAL_CANBUS_RATE_TABLE_SIZE) {
+        rate_table[rate_table_count].can_id = can_id;
+        rate_table[rate_table_count].count = frames;
+        rate_table_count++;
+        return;
+    }
+    smallest->can_id = can_id;
+    smallest->count += frames;
+}
+
+void ExternalCanBus::update_telemetry(uint32_t now_us) {
+    uint32_t elapsed = now_us - telemetry_window_start_us;
+    if (elapsed < EXTERNAL_CANBUS_TELEMETRY_WINDOW_US) {
+        return;
+    }
+    
+    // Frames the fast handlers consumed never reached the drain
+    for (uint8_t i = 0; i < fast_handler_count; i++) {
+        uint32_t frames = __atomic_exchange_n(&fast_handlers[i].frames, 0, __ATOMIC_RELAXED);
+        if (frames > 0) {
+            count_id_frames(fast_handlers[i].can_id, frames);
+        }
+    }
+    
+    // Top N by selection; the table is small and this runs once a window
+    uint32_t taken = 0;
+    top_id_count = 0;
+    while (top_id_count < EXTERNAL_CANBUS_TOP_IDS) {
+        int8_t best = -1;
+        for (uint8_t i = 0; i < rate_table_count; i++) {
+            if (!(taken & (1u << i)) && (best < 0 || rate_table[i].count > rate_table[best].count)) {
+                best = (int8_t)i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        taken |= 1u << best;
+        top_ids[top_id_count].can_id = rate_table[best].can_id;
+        top_ids[top_id_count].frames_per_second = (float)((double)rate_table[best].count * 1.0e6 / elapsed);
+        top_id_count++;
+    }
+    
+    // This window's share of the scheduler's TX wait histogram
+    const can_tx_stats_t& tx = tx_scheduler.get_statistics();
+    can_tx_wait_histogram_t window = {};
+    for (uint8_t bucket = 0; bucket < CAN_TX_WAIT_BUCKETS; bucket++) {
+        window.counts[bucket] = tx.tx_wait.counts[bucket] - tx_wait_seen.counts[bucket];
+    }
+    window.samples = tx.tx_wait.samples - tx_wait_seen.samples;
+    window.total_us = tx.tx_wait.total_us - tx_wait_seen.total_us;
+    window.max_us = tx.tx_wait.max_us;
+    
+    // Smallest bucket limit with at least 99% of the window's frames at or
+    // below it; the open-ended top bucket reports the maximum instead
+    tx_wait_p99_us = 0;
+    if (window.samples > 0) {
+        uint32_t target = window.samples - window.samples / 100;
+        uint32_t cumulative = 0;
+        for (uint8_t bucket = 0; bucket < CAN_TX_WAIT_BUCKETS; bucket++) {
+            cumulative += window.counts[bucket];
+            if (cumulative >= target) {
+                tx_wait_p99_us = (bucket == CAN_TX_WAIT_BUCKETS - 1) ?
+                                 window.max_us : CanTxScheduler::wait_bucket_limit_us(bucket);
+                break;
+            }
+        }
+    }
+    
+    publish_telemetry(window, tx.mailbox_busy - mailbox_busy_seen);
+    
+    tx_wait_seen = tx.tx_wait;
+    mailbox_busy_seen = tx.mailbox_busy;
+    rate_table_count = 0;
+    telemetry_window_start_us = now_us;
+}
+
+void ExternalCanBus::publish_telemetry(const can_tx_wait_histogram_t& window, uint32_t retries) {
+    const can_tx_stats_t& tx = tx_scheduler.get_statistics();
+    g_message_bus.publishFloat(MSG_EXT_CAN_BUS_LOAD, tx.bus_load_percent);
+    g_message_bus.publishFloat(MSG_EXT_CAN_PEAK_BUS_LOAD, tx.peak_bus_load_percent);
+    if (window.samples > 0) {
+        g_message_bus.publishFloat(MSG_EXT_CAN_TX_WAIT_AVG_US, (float)((double)window.total_us / window.samples));
+        g_message_bus.publishFloat(MSG_EXT_CAN_TX_WAIT_P99_US, (float)tx_wait_p99_us);
+    }
+    g_message_bus.publishFloat(MSG_EXT_CAN_TX_WAIT_MAX_US, (float)window.max_us);
+    g_message_bus.publishUint32(MSG_EXT_CAN_TX_RETRIES, retries);
+    for (uint8_t bucket = 0; bucket < CAN_TX_WAIT_BUCKETS; bucket++) {
+        g_message_bus.publishUint32(MSG_EXT_CAN_TX_WAIT_BUCKET(bucket), window.counts[bucket]);
+    }
+    
+    g_message_bus.publishUint8(MSG_EXT_CAN_TX_ERROR_COUNTER, stats.tx_error_counter);
+    g_message_bus.publishUint8(MSG_EXT_CAN_RX_ERROR_COUNTER, stats.rx_error_counter);
+    g_message_bus.publishUint8(MSG_EXT_CAN_FAULT_STATE, stats.fault_state);
+    g_message_bus.publishUint32(MSG_EXT_CAN_ERROR_PASSIVE_EVENTS, stats.error_passive_events);
+    g_message_bus.publishUint32(MSG_EXT_CAN_BUS_OFF_EVENTS, stats.bus_off_events);
+    
+    for (uint8_t rank = 0; rank < top_id_count; rank++) {
+        g_message_bus.publishUint32(MSG_EXT_CAN_TOP_ID(rank), top_ids[rank].can_id);
+        g_message_bus.publishFloat(MSG_EXT_CAN_TOP_RATE(rank), top_ids[rank].frames_per_second);
+    }
+}
+
+void ExternalCanBus::reset_telemetry() {
+    memset(rate_table, 0, sizeof(rate_table));
+    rate_table_count = 0;
+    memset(top_ids, 0, sizeof(top_ids));
+    top_id_count = 0;
+    telemetry_window_start_us = ecu_time_us();
+    tx_wait_seen = tx_scheduler.get_statistics().tx_wait;
+    mailbox_busy_seen = tx_scheduler.get_statistics().mailbox_busy;
+    tx_wait_p99_us = 0;
+}
+
+uint8_t ExternalCanBus::get_top_ids(can_id_rate_t* out, uint8_t max_count) const {
+    if (out == nullptr) {
+        return 0;
+    }
+    uint8_t count = (max_count < top_id_count) ? max_count : top_id_count;
+    memcpy(out, top_ids, count * sizeof(can_id_rate_t));
+    return count;
+}
+
 // ============================================================================
 // ERROR HANDLING AND DEBUGGING
 // ============================================================================
@@ -752,6 +1589,21 @@ bool ExternalCanBus::inject_test_message(uint32_t can_id, const uint8_t* data, u
     return true;
 }
 
+bool ExternalCanBus::inject_fd_message(const CANFD_message_t& msg) {
+    if (!initialized || !fd_mode || msg.len > CAN_FD_MAX_PAYLOAD) {
+        return false;
+    }
+    
+    if (msg.len <= 8) {
+        CAN_message_t classic;
+        fd_to_classic(msg, &classic);
+        route_incoming_message(classic);
+    } else {
+        route_fd_message(msg);
+    }
+    return true;
+}
+
 bool ExternalCanBus::inject_obdii_request(uint8_t pid) {
     uint8_t request_data[] = {0x02, 0x01, pid, 0x00, 0x00, 0x00, 0x00, 0x00};
     return inject_test_message(OBDII_REQUEST_ID, request_data, 3);
@@ -780,6 +1632,13 @@ void ExternalCanBus::setup_message_bus_integration() {
     debug_print("ExternalCanBus: Set up message bus integration (no global broadcast override)");
 }
 
+bool ExternalCanBus::has_response_room(uint8_t channel) const {
+    if (channel != CHANNEL_CAN_BUS) {
+        return true;
+    }
+    return tx_scheduler.get_queue_depth(CAN_TX_PRIORITY_HIGH) < CAN_TX_QUEUE_SIZE;
+}
+
 void ExternalCanBus::on_message_bus_message(const CANMessage* msg) {
     if (!initialized || msg == nullptr) return;
     
@@ -789,20 +1648,27 @@ void ExternalCanBus::on_message_bus_message(const CANMessage* msg) {
         
         // Only filter parameter responses (not broadcasts or errors)
         if (param->operation == PARAM_OP_READ_RESPONSE || 
-            param->operation == PARAM_OP_WRITE_ACK) {
+            param->operation == PARAM_OP_WRITE_ACK ||
+            param->operation == PARAM_OP_BATCH_COMPLETE) {
             
-            // Route response only to the requesting channel
-            if (param->source_channel == CHANNEL_CAN_BUS) {
+            // Route response only to the requesting channel; FD peers
+            // get values packed with the other responses of this update
+            if (param->source_channel == CHANNEL_CAN_BUS && is_fd_packing_enabled() &&
+                param->operation != PARAM_OP_BATCH_COMPLETE) {
+                send_packed_value(msg->id, param->value, param->operation, CAN_TX_PRIORITY_HIGH);
+                remove_pending_request(param->request_id, param->source_channel);
+            } else if (param->source_channel == CHANNEL_CAN_BUS) {
                 // Strip routing info before sending to external tool
                 CANMessage external_response = *msg;
                 strip_routing_metadata(&external_response);
                 
                 // Convert to CAN_message_t and send
-                CAN_message_t can_msg;
+                CAN_message_t can_msg = {};
                 can_msg.id = external_response.id;
                 can_msg.len = external_response.len;
+                can_msg.flags.extended = (can_msg.id > CAN_STANDARD_ID_MASK);
                 memcpy(can_msg.buf, external_response.buf, external_response.len);
-                send_can_message(can_msg);
+                send_can_message(can_msg, CAN_TX_PRIORITY_HIGH);
                 
                 // Remove from request tracker
                 remove_pending_request(param->request_id, param->source_channel);
@@ -813,9 +1679,10 @@ void ExternalCanBus::on_message_bus_message(const CANMessage* msg) {
     }
     
     // For non-parameter messages or parameter broadcasts, send normally
-    CAN_message_t can_msg;
+    CAN_message_t can_msg = {};
     can_msg.id = msg->id;
     can_msg.len = msg->len;
+    can_msg.flags.extended = (can_msg.id > CAN_STANDARD_ID_MASK);
     memcpy(can_msg.buf, msg->buf, msg->len);
     send_can_message(can_msg);
 }
@@ -1,6 +1,52 @@
 // external_canbus.h
 // External CAN bus interface for communicating with external devices
 // Provides OBD-II support and custom message handling with lazy-loading cache
+//
+// Acceptance filtering: the FlexCAN RX FIFO only accepts the frames some
+// module asked for, so the rest of a busy vehicle bus never reaches the CPU.
+// The filter table is the union of
+//   - OBD-II functional and physical requests (OBDII_REQUEST_ID,
+//     OBDII_PHYSICAL_REQUEST_ID - which also carries ISO-TP flow control),
+//     while OBD-II is enabled
+//   - parameter requests: any extended ID in the primary ECU's range
+//   - every CAN ID the custom message handler receives - registered
+//     handlers (CustomCanBusManager mappings register one each) and RX
+//     message configs. IDs up to 0x7FF are taken as standard frames.
+// It is rebuilt from update() whenever one of those changes. If the union
+// needs more than EXTERNAL_CANBUS_FILTER_SLOTS entries the FIFO accepts
+// everything and the same union is checked in software instead.
+//
+// Receive path: frames are taken in the FlexCAN FIFO interrupt (onReceive()
+// without events()), stamped with ecu_time_us() and pushed into a
+// single-producer ring that update() drains in one batch. Fast handlers run
+// in the interrupt itself for time-critical IDs; one that returns true
+// consumes the frame, otherwise it is queued like any other. In update(),
+// extended frames go to the link receiver (can_router.h) first, so data from
+// modules hosted on another ECU reaches the internal bus.
+//
+// Transmit path: every outgoing frame - custom messages, parameter responses,
+// broadcasts and periodic messages - goes through one CanTxScheduler (see
+// can_tx_scheduler.h), which spreads periodic IDs by phase, queues by priority
+// class with a TX mailbox per class, holds non-critical traffic under
+// tx_utilisation_cap_pct and measures the bus load.
+//
+// CAN FD (enable_fd, CAN3 only): the controller runs FlexCAN_T4FD with 64-byte
+// mailboxes and a bit-rate switch to fd_data_baudrate. Frames of up to 8
+// bytes take the classic path; longer ones go through a small FD ring. FD
+// mode filters in software. With fd_packed_can_id set, status broadcasts and
+// parameter responses are packed CAN_FD_PACK_MAX_ENTRIES to a frame
+// (can_fd_packed_msg_t) and packed requests from FD peers are unpacked into
+// ordinary parameter messages.
+//
+// Telemetry: every EXTERNAL_CANBUS_TELEMETRY_WINDOW_US the bus load, the TX
+// wait histogram (queue to mailbox), mailbox retries, the controller's error
+// counters and fault state, and the EXTERNAL_CANBUS_TOP_IDS busiest IDs are
+// published on the message bus (MSG_EXT_CAN_*). Per-ID rates come from a
+// Space-Saving table of EXTERNAL_CANBUS_RATE_TABLE_SIZE IDs counting frames
+// sent and frames received (fast path included); with more IDs live than
+// that a rate can be over-counted by at most the smallest entry's count.
+// Error states are polled from the controller in update(); entering error
+// passive and bus-off is counted as it is seen.
 
 #ifndef EXTERNAL_CANBUS_H
 #define EXTERNAL_CANBUS_H
@@ -8,6 +54,7 @@
 #include "msg_definitions.h"
 #include "external_canbus_cache.h"
 #include "request_tracker.h"
+#include "can_tx_scheduler.h"
 
 #ifdef ARDUINO
     #include <Arduino.h>
@@ -31,12 +78,80 @@ struct external_canbus_stats_t {
     uint32_t obdii_requests;
     uint32_t custom_messages;
     uint32_t parameter_messages;
+    uint32_t link_messages;          // Taken by the link receiver (ECU-to-ECU)
     uint32_t cache_hits;
     uint32_t cache_misses;
     uint32_t subscription_count;
+    uint32_t messages_filtered;      // Dropped by software filtering
+    uint32_t rx_queue_overflows;     // Dropped in the interrupt, ring full
+    uint32_t fast_path_frames;       // Consumed by fast handlers in the interrupt
+    uint32_t fd_frames_received;     // Longer than 8 bytes
+    uint32_t packed_frames_sent;
+    uint32_t packed_values_sent;
     uint32_t errors;
+    uint32_t error_reports;          // Error states read from the controller
+    uint32_t error_passive_events;
+    uint32_t bus_off_events;
+    uint8_t tx_error_counter;        // TEC and REC at the last report
+    uint8_t rx_error_counter;
+    uint8_t fault_state;             // can_fault_state_t
 };
 
+// Controller fault confinement state (ESR1 FLTCONF)
+typedef enum {
+    CAN_FAULT_ERROR_ACTIVE  = 0,
+    CAN_FAULT_ERROR_PASSIVE = 1,
+    CAN_FAULT_BUS_OFF       = 2
+} can_fault_state_t;
+
+#define CAN_ESR1_FLTCONF_SHIFT          4
+#define CAN_ESR1_FLTCONF_MASK           0x3
+#define CAN_ESR1_BOFFINT                (1u << 2)   // Entered bus-off since the last read
+
+// Telemetry
+#define EXTERNAL_CANBUS_TELEMETRY_WINDOW_US 1000000
+#define EXTERNAL_CANBUS_RATE_TABLE_SIZE     32      // IDs tracked for the top-N
+#define EXTERNAL_CANBUS_TOP_IDS             4
+
+// One of the busiest IDs in the last telemetry window
+struct can_id_rate_t {
+    uint32_t can_id;
+    float frames_per_second;         // Sent and received
+};
+
+// Hardware acceptance filtering
+#define EXTERNAL_CANBUS_FILTER_SLOTS    16          // RX FIFO filters (RFFN_16)
+#define CAN_STANDARD_ID_MASK            0x7FF
+#define CAN_EXTENDED_ID_MASK            0x1FFFFFFF
+#define CAN_PARAMETER_FILTER_ID         ECU_BASE_PRIMARY
+#define CAN_PARAMETER_FILTER_MASK       (ECU_BASE_MASK & CAN_EXTENDED_ID_MASK)
+
+// One RX FIFO filter: accepts frames with (id ^ filter.id) & mask == 0
+struct can_acceptance_filter_t {
+    uint32_t id;
+    uint32_t mask;
+    bool extended;
+};
+
+// Interrupt-driven receive
+#define EXTERNAL_CANBUS_RX_QUEUE_SIZE       64      // Frames between update() calls (power of two)
+#define EXTERNAL_CANBUS_MAX_FAST_HANDLERS   4
+#define EXTERNAL_CANBUS_FD_RX_QUEUE_SIZE    8       // Frames over 8 bytes (power of two)
+
+// CAN FD
+#define CAN_FD_MAX_PAYLOAD                  64
+#define CAN_FD_DEFAULT_DATA_BAUDRATE        2000000
+#define CAN_FD_DEFAULT_PACKED_ID            0x6E0
+#define EXTERNAL_CANBUS_PACK_BUFFERS        3       // Operations packed at once
+
+// Runs in the CAN interrupt with the receive stamp; return true if the
+// frame needs no further routing
+typedef bool (*can_fast_rx_handler_t)(const CAN_message_t& msg, uint32_t timestamp_us);
+
+// Frames from modules hosted on another ECU (can_router.h). Runs in loop
+// context; returns true if it took the frame.
+typedef bool (*can_link_rx_handler_t)(uint32_t can_id, const uint8_t* data, uint8_t length);
+
 // External CAN bus configuration
 struct external_canbus_config_t {
     bool enabled;                    // Master enable/disable flag
@@ -45,6 +160,10 @@ struct external_canbus_config_t {
     bool enable_custom_messages;
     uint8_t can_bus_number;  // 1 for CAN1, 2 for CAN2, etc.
     uint32_t cache_default_max_age_ms;
+    uint8_t tx_utilisation_cap_pct;  // 0 = CAN_TX_DEFAULT_UTILISATION_CAP_PCT
+    bool enable_fd;                  // CAN FD with bit-rate switch (CAN3 only)
+    uint32_t fd_data_baudrate;       // Data phase bit rate
+    uint32_t fd_packed_can_id;       // Packed parameter frames (0 = no packing)
 };
 
 class ExternalCanBus {
@@ -93,11 +212,45 @@ public:
     bool register_custom_handler(uint32_t can_id, custom_message_handler_t handler);
     bool unregister_custom_handler(uint32_t can_id);
     
-    // Send custom message
-    bool send_custom_message(uint32_t can_id, const uint8_t* data, uint8_t length);
+    // Fast path: handler runs in interrupt context for this ID, so it must be
+    // short and must not publish with anything but publishFromISR()
+    bool register_fast_handler(uint32_t can_id, can_fast_rx_handler_t handler);
+    bool unregister_fast_handler(uint32_t can_id);
+    
+    // Extended frames are offered to the link receiver ahead of parameter
+    // and custom routing. They must fall inside the accepted ID ranges - the
+    // primary ECU range is always accepted.
+    void set_link_receiver(can_link_rx_handler_t handler) { link_receiver = handler; }
+    
+    // Receive stamp (ecu_time_us) of the frame being routed, for handlers
+    uint32_t get_rx_timestamp_us() const { return rx_timestamp_us; }
+    
+    // Send custom message (queued through the TX scheduler)
+    bool send_custom_message(uint32_t can_id, const uint8_t* data, uint8_t length,
+                             can_tx_priority_t priority = CAN_TX_PRIORITY_NORMAL);
     bool send_custom_float(uint32_t can_id, float value);
     bool send_custom_uint32(uint32_t can_id, uint32_t value);
     
+    // CAN FD: up to 64 bytes, padded to the next valid FD length
+    bool send_fd_message(uint32_t can_id, const uint8_t* data, uint8_t length,
+                         can_tx_priority_t priority = CAN_TX_PRIORITY_NORMAL);
+    bool is_fd_enabled() const { return fd_mode; }
+    
+    // Packed values for FD peers: buffered per operation and sent when a
+    // frame is full or on the next update()
+    bool is_fd_packing_enabled() const { return fd_mode && config.fd_packed_can_id != 0; }
+    bool send_packed_value(uint32_t msg_id, float value, uint8_t operation,
+                           can_tx_priority_t priority = CAN_TX_PRIORITY_NORMAL);
+    void flush_packed_values();
+    
+    // Periodic messages: fill builds the frame when it is due, or pass
+    // nullptr and keep the payload current with set_periodic_payload()
+    bool add_periodic_message(uint32_t can_id, uint32_t period_ms, can_tx_priority_t priority,
+                              can_tx_fill_t fill, void* context = nullptr,
+                              uint32_t phase_ms = CAN_TX_PHASE_AUTO);
+    bool remove_periodic_message(uint32_t can_id);
+    bool set_periodic_payload(uint32_t can_id, const uint8_t* data, uint8_t length);
+    
     // Get value from custom message cache
     bool get_custom_value(uint32_t external_key, float* value);
     
@@ -130,11 +283,40 @@ public:
     uint32_t get_error_count() const { return stats.errors; }
     void clear_errors();
     
+    // Acceptance filtering (0 filters while software filtering)
+    uint8_t get_acceptance_filter_count() const { return acceptance_filter_count; }
+    bool get_acceptance_filter(uint8_t index, can_acceptance_filter_t* filter) const;
+    bool is_software_filtering() const { return software_filtering; }
+    
+    // Frames waiting for update()
+    uint16_t get_rx_queue_depth() const;
+    
+    // Transmit scheduling and bus load
+    // Room to queue a response on CHANNEL_CAN_BUS (other channels always
+    // have room here); lets streamed replies wait
+    bool has_response_room(uint8_t channel) const;
+    const can_tx_stats_t& get_tx_statistics() const { return tx_scheduler.get_statistics(); }
+    float get_bus_load_percent() const { return tx_scheduler.get_statistics().bus_load_percent; }
+    uint32_t get_critical_latency_bound_us() const { return tx_scheduler.get_critical_latency_bound_us(); }
+    void set_tx_utilisation_cap(uint8_t cap_pct) { tx_scheduler.set_utilisation_cap(cap_pct); }
+    
+    // Busiest IDs of the last telemetry window, highest rate first; returns
+    // how many were written
+    uint8_t get_top_ids(can_id_rate_t* out, uint8_t max_count) const;
+    
+    // TX wait p99 of the last telemetry window (bucket upper limit)
+    uint32_t get_tx_wait_p99_us() const { return tx_wait_p99_us; }
+    
     // Request tracking access
     void remove_pending_request(uint8_t request_id, uint8_t channel) {
         request_tracker.remove_request(request_id, channel);
     }
     
+    // Pending request slots (rounded to a power of two); drops any pending
+    void set_request_capacity(uint8_t capacity) { request_tracker.set_capacity(capacity); }
+    uint8_t get_pending_request_count() const { return request_tracker.get_pending_count(); }
+    uint32_t get_request_timeout_count() const { return request_tracker.get_timeout_count(); }
+    
     // Message bus integration
     void setup_message_bus_integration();
     void on_message_bus_message(const CANMessage* msg);
@@ -152,6 +334,7 @@ public:
     #ifndef ARDUINO
     MockFlexCAN* get_mock_can() { return &mock_can; }
     #endif
+    bool inject_fd_message(const CANFD_message_t& msg);
     #endif
     
 private:
@@ -161,14 +344,54 @@ private:
     
     #ifdef ARDUINO
     void* can_bus;  // Generic pointer to avoid template complexity in header
-    CAN_message_t rx_msg;
     CAN_message_t tx_msg;
     #else
     MockFlexCAN mock_can;
-    CAN_message_t rx_msg;
     CAN_message_t tx_msg;
     #endif
     
+    // Receive ring: the CAN interrupt owns head, update() owns tail
+    struct rx_frame_t {
+        CAN_message_t msg;
+        uint32_t timestamp_us;
+    };
+    rx_frame_t rx_queue[EXTERNAL_CANBUS_RX_QUEUE_SIZE];
+    volatile uint32_t rx_queue_head;
+    volatile uint32_t rx_queue_tail;
+    uint32_t rx_timestamp_us;
+    
+    // Frames over 8 bytes in FD mode, same ownership as rx_queue
+    struct rx_fd_frame_t {
+        CANFD_message_t msg;
+        uint32_t timestamp_us;
+    };
+    rx_fd_frame_t rx_fd_queue[EXTERNAL_CANBUS_FD_RX_QUEUE_SIZE];
+    volatile uint32_t rx_fd_queue_head;
+    volatile uint32_t rx_fd_queue_tail;
+    
+    // Packed values waiting for a frame, one buffer per operation
+    struct pack_buffer_t {
+        can_fd_packed_msg_t frame;
+        can_tx_priority_t priority;
+    };
+    pack_buffer_t pack_buffers[EXTERNAL_CANBUS_PACK_BUFFERS];
+    
+    // Received bits for the bus load: the interrupt adds, update() takes the difference
+    volatile uint32_t rx_bits;
+    uint32_t rx_bits_seen;
+    
+    // Every outgoing frame is scheduled here
+    CanTxScheduler tx_scheduler;
+    
+    // Fast handlers, read by the interrupt (changed with interrupts off)
+    struct fast_handler_entry_t {
+        uint32_t can_id;
+        can_fast_rx_handler_t handler;
+        uint32_t frames;            // Consumed in the interrupt, taken by telemetry
+    };
+    fast_handler_entry_t fast_handlers[EXTERNAL_CANBUS_MAX_FAST_HANDLERS];
+    volatile uint8_t fast_handler_count;
+    
     // =========================================================================
     // CONFIGURATION AND STATE
     // =========================================================================
@@ -177,11 +400,33 @@ private:
     external_canbus_stats_t stats;
     
     bool initialized;
+    bool fd_mode;
     bool obdii_enabled;
     bool custom_messages_enabled;
     uint32_t last_message_time;
     uint32_t last_update_time;
     
+    // Acceptance filtering
+    can_acceptance_filter_t acceptance_filters[EXTERNAL_CANBUS_FILTER_SLOTS];
+    uint8_t acceptance_filter_count;
+    bool software_filtering;
+    bool acceptance_filters_dirty;
+    uint32_t custom_receive_version;
+    
+    // Telemetry: Space-Saving per-ID counts for the current window
+    struct rate_entry_t {
+        uint32_t can_id;
+        uint32_t count;
+    };
+    rate_entry_t rate_table[EXTERNAL_CANBUS_RATE_TABLE_SIZE];
+    uint8_t rate_table_count;
+    can_id_rate_t top_ids[EXTERNAL_CANBUS_TOP_IDS];
+    uint8_t top_id_count;
+    uint32_t telemetry_window_start_us;
+    can_tx_wait_histogram_t tx_wait_seen;       // Scheduler histogram at the window start
+    uint32_t mailbox_busy_seen;
+    uint32_t tx_wait_p99_us;
+    
     // =========================================================================
     // SUBSYSTEM MODULES
     // =========================================================================
@@ -189,6 +434,7 @@ private:
     ExternalCanBusCache* cache;
     OBDIIHandler* obdii_handler;
     CustomMessageHandler* custom_handler;
+    can_link_rx_handler_t link_receiver;
     
     // Request tracking for parameter routing
     RequestTracker request_tracker;
@@ -201,7 +447,29 @@ private:
     bool setup_can_bus();
     void process_incoming_messages();
     void process_outgoing_messages();
-    bool send_can_message(const CAN_message_t& msg);
+    bool send_can_message(const CAN_message_t& msg,
+                          can_tx_priority_t priority = CAN_TX_PRIORITY_NORMAL);
+    bool send_can_message(const CANFD_message_t& msg, can_tx_priority_t priority);
+    bool write_mailbox(uint8_t mailbox, const CANFD_message_t& msg);
+    static bool write_tx_mailbox(uint8_t mailbox, const CANFD_message_t& msg, void* context);
+    
+    // Interrupt receive path
+    static void on_can_receive(const CAN_message_t& msg);
+    static void on_canfd_receive(const CANFD_message_t& msg);
+    void receive_from_isr(const CAN_message_t& msg, uint32_t bits);
+    void receive_fd_from_isr(const CANFD_message_t& msg);
+    void process_incoming_fd_messages();
+    void route_fd_message(const CANFD_message_t& msg);
+    void flush_pack_buffer(pack_buffer_t& buffer);
+    bool has_fast_handler(uint32_t can_id) const;
+    
+    // Acceptance filtering
+    void update_acceptance_filters();
+    void rebuild_acceptance_filters();
+    void apply_acceptance_filters();
+    bool add_acceptance_filter(uint32_t id, uint32_t mask, bool extended);
+    bool add_id_acceptance_filter(uint32_t can_id);
+    bool is_wanted_message(const CAN_message_t& msg) const;
     
     // Message routing
     void route_incoming_message(const CAN_message_t& msg);
@@ -216,6 +484,12 @@ private:
     
     // Diagnostics
     void update_statistics();
+    void poll_bus_errors();
+    void record_bus_error(const CAN_error_t& error);
+    void count_id_frames(uint32_t can_id, uint32_t frames);
+    void update_telemetry(uint32_t now_us);
+    void publish_telemetry(const can_tx_wait_histogram_t& window, uint32_t retries);
+    void reset_telemetry();
     void debug_print(const char* message);
     void debug_print_message(const CAN_message_t& msg, const char* prefix);
 };
@@ -236,7 +510,11 @@ static const external_canbus_config_t DEFAULT_EXTERNAL_CANBUS_CONFIG = {
     .enable_obdii = true,
     .enable_custom_messages = true,
     .can_bus_number = 1,
-    .cache_default_max_age_ms = 1000
+    .cache_default_max_age_ms = 1000,
+    .tx_utilisation_cap_pct = CAN_TX_DEFAULT_UTILISATION_CAP_PCT,
+    .enable_fd = false,
+    .fd_data_baudrate = CAN_FD_DEFAULT_DATA_BAUDRATE,
+    .fd_packed_can_id = CAN_FD_DEFAULT_PACKED_ID
 };
 
 #endif
\ No newline at end of file
@@ -2,6 +2,8 @@
 // Implementation of lazy-loading cache system for external CAN bus
 
 #include "external_canbus_cache.h"
+#include "id_hash.h"
+#include "memory_placement.h"
 
 // Static instance for callback
 ExternalCanBusCache* ExternalCanBusCache::instance = nullptr;
@@ -41,9 +43,12 @@ const uint32_t CUSTOM_CACHE_MAPPINGS_COUNT = sizeof(CUSTOM_CACHE_MAPPINGS) / siz
 // ============================================================================
 
 ExternalCanBusCache::ExternalCanBusCache() :
+    entry_count(0),
     default_max_age_ms(1000),
     initialized(false)
 {
+    clear_tables();
+    
     // Initialize statistics
     reset_statistics();
     
@@ -64,9 +69,7 @@ bool ExternalCanBusCache::init(uint32_t default_max_age_ms) {
     this->default_max_age_ms = default_max_age_ms;
     
     // Clear all data structures
-    cache_entries.clear();
-    cache_mappings.clear();
-    subscription_map.clear();
+    clear_tables();
     
     // Reset statistics
     reset_statistics();
@@ -96,9 +99,7 @@ void ExternalCanBusCache::shutdown() {
     }
     
     // Clear all data
-    cache_entries.clear();
-    cache_mappings.clear();
-    subscription_map.clear();
+    clear_tables();
     
     initialized = false;
     instance = nullptr;
@@ -157,8 +158,8 @@ bool ExternalCanBusCache::has_fresh_value(uint32_t external_key, uint32_t max_ag
         return false;
     }
     
-    auto it = cache_entries.find(external_key);
-    if (it == cache_entries.end()) {
+    const cache_entry_t* entry = find_entry(external_key);
+    if (entry == nullptr) {
         return false;
     }
     
@@ -166,7 +167,7 @@ bool ExternalCanBusCache::has_fresh_value(uint32_t external_key, uint32_t max_ag
         max_age_ms = default_max_age_ms;
     }
     
-    return is_entry_fresh(it->second, max_age_ms);
+    return is_entry_fresh(*entry, max_age_ms);
 }
 
 bool ExternalCanBusCache::refresh_value(uint32_t external_key) {
@@ -183,15 +184,17 @@ bool ExternalCanBusCache::refresh_value(uint32_t external_key) {
 }
 
 void ExternalCanBusCache::invalidate_entry(uint32_t external_key) {
-    auto it = cache_entries.find(external_key);
-    if (it != cache_entries.end()) {
-        it->second.state = CACHE_STATE_EMPTY;
-        it->second.last_update_time = 0;
+    cache_entry_t* entry = find_entry(external_key);
+    if (entry != nullptr) {
+        entry->state = CACHE_STATE_EMPTY;
+        entry->last_update_time = 0;
     }
 }
 
 void ExternalCanBusCache::clear_all() {
-    cache_entries.clear();
+    for (uint8_t i = 0; i < MAX_MAPPINGS; i++) {
+        release_entry(i);
+    }
     reset_statistics();
     debug_print("Cache: All entries cleared");
 }
@@ -200,72 +203,77 @@ void ExternalCanBusCache::clear_all() {
 // LAZY LOADING IMPLEMENTATION
 // ============================================================================
 
-cache_entry_t* ExternalCanBusCache::get_or_create_entry(uint32_t external_key) {
-    // Check if entry already exists
-    auto it = cache_entries.find(external_key);
-    if (it != cache_entries.end()) {
-        return &it->second;
-    }
-    
+ECU_HOT_CODE cache_entry_t* ExternalCanBusCache::get_or_create_entry(uint32_t external_key) {
     // Find mapping for this external key
-    cache_mapping_t* mapping = find_mapping(external_key);
-    if (mapping == nullptr) {
+    uint8_t index = find_slot(external_key);
+    if (index == NO_SLOT) {
         debug_print("Cache: No mapping found for external key");
         return nullptr;
     }
     
-    // Create new cache entry
-    cache_entry_t new_entry = {};
-    new_entry.value = 0.0f;
-    new_entry.last_update_time = 0;
-    new_entry.internal_msg_id = mapping->internal_msg_id;
-    new_entry.max_age_ms = mapping->default_max_age_ms;
-    new_entry.state = CACHE_STATE_EMPTY;
-    new_entry.is_subscribed = false;
-    new_entry.subscription_time = 0;
-    new_entry.request_count = 0;
-    new_entry.description = mapping->description;
-    
-    // Insert into cache
-    auto result = cache_entries.insert(std::make_pair(external_key, new_entry));
-    if (!result.second) {
-        debug_print("Cache: Failed to create cache entry");
-        return nullptr;
+    // Check if entry already exists
+    CacheSlot& slot = slots[index];
+    if (slot.has_entry) {
+        return &slot.entry;
     }
     
+    // Create new cache entry
+    cache_entry_t& entry = slot.entry;
+    entry = {};
+    entry.value = 0.0f;
+    entry.last_update_time = 0;
+    entry.internal_msg_id = slot.mapping.internal_msg_id;
+    entry.max_age_ms = slot.mapping.default_max_age_ms;
+    entry.state = CACHE_STATE_EMPTY;
+    entry.is_subscribed = false;
+    entry.subscription_time = 0;
+    entry.request_count = 0;
+    entry.description = slot.mapping.description;
+    slot.has_entry = true;
+    entry_count++;
+    
     stats.entries_created++;
     
     // Subscribe to internal message
-    if (!subscribe_to_internal_message(external_key, result.first->second)) {
+    if (!subscribe_to_internal_message(index)) {
         // Subscription failed, but keep the entry for retry
         handle_subscription_error(external_key);
     }
     
     debug_print("Cache: Created new cache entry");
-    return &result.first->second;
+    return &entry;
 }
 
-bool ExternalCanBusCache::subscribe_to_internal_message(uint32_t external_key, cache_entry_t& entry) {
+bool ExternalCanBusCache::subscribe_to_internal_message(uint8_t slot_index) {
+    CacheSlot& slot = slots[slot_index];
+    cache_entry_t& entry = slot.entry;
     if (entry.is_subscribed) {
         return true;  // Already subscribed
     }
     
-    // Subscribe to internal message bus
-    bool success = g_message_bus.subscribe(entry.internal_msg_id, message_handler);
+    // Subscribe to internal message bus (once per internal ID)
+    MessageSlot* message = find_message_slot(entry.internal_msg_id, true);
+    bool success = (message != nullptr);
+    if (success && !message->bus_subscribed) {
+        success = g_message_bus.subscribe(entry.internal_msg_id, message_handler);
+        message->bus_subscribed = success;
+    }
+    
     if (success) {
         entry.is_subscribed = true;
         entry.subscription_time = millis();
         entry.state = CACHE_STATE_SUBSCRIBED;
         
-        // Add to subscription map for reverse lookup
-        subscription_map[entry.internal_msg_id].push_back(external_key);
+        // Chain into the reverse lookup for this internal ID
+        slot.next_for_msg = message->head;
+        message->head = slot_index;
         
         stats.subscriptions_created++;
         
         char debug_msg[100];
         snprintf(debug_msg, sizeof(debug_msg), 
                 "Cache: Subscribed to internal message 0x%03X for external key 0x%08X", 
-                entry.internal_msg_id, external_key);
+                entry.internal_msg_id, slot.mapping.external_key);
         debug_print(debug_msg);
         
         return true;
@@ -277,6 +285,31 @@ bool ExternalCanBusCache::subscribe_to_internal_message(uint32_t external_key, c
     }
 }
 
+void ExternalCanBusCache::release_entry(uint8_t slot_index) {
+    CacheSlot& slot = slots[slot_index];
+    if (!slot.has_entry) {
+        return;
+    }
+    
+    // Unlink from the internal ID's chain
+    if (slot.entry.is_subscribed) {
+        MessageSlot* message = find_message_slot(slot.entry.internal_msg_id, false);
+        if (message != nullptr) {
+            uint8_t* link = &message->head;
+            while (*link != NO_SLOT && *link != slot_index) {
+                link = &slots[*link].next_for_msg;
+            }
+            if (*link == slot_index) {
+                *link = slot.next_for_msg;
+            }
+        }
+    }
+    
+    slot.has_entry = false;
+    slot.next_for_msg = NO_SLOT;
+    entry_count--;
+}
+
 // ============================================================================
 // MESSAGE HANDLING FROM INTERNAL BUS
 // ============================================================================
@@ -287,7 +320,7 @@ void ExternalCanBusCache::message_handler(const CANMessage* msg) {
     }
 }
 
-void ExternalCanBusCache::handle_internal_message(const CANMessage* msg) {
+ECU_HOT_CODE void ExternalCanBusCache::handle_internal_message(const CANMessage* msg) {
     if (msg == nullptr) {
         return;
     }
@@ -295,8 +328,8 @@ void ExternalCanBusCache::handle_internal_message(const CANMessage* msg) {
     stats.messages_received++;
     
     // Find all external keys that map to this internal message ID
-    auto it = subscription_map.find(msg->id);
-    if (it == subscription_map.end()) {
+    MessageSlot* message = find_message_slot(msg->id, false);
+    if (message == nullptr || message->head == NO_SLOT) {
         return;  // No external keys interested in this message
     }
     
@@ -311,18 +344,13 @@ void ExternalCanBusCache::handle_internal_message(const CANMessage* msg) {
     }
     
     // Update all cache entries that map to this internal message
-    for (uint32_t external_key : it->second) {
-        update_cache_entry(external_key, value);
+    for (uint8_t i = message->head; i != NO_SLOT; i = slots[i].next_for_msg) {
+        update_cache_entry(slots[i], value);
     }
 }
 
-void ExternalCanBusCache::update_cache_entry(uint32_t external_key, float value) {
-    auto it = cache_entries.find(external_key);
-    if (it == cache_entries.end()) {
-        return;
-    }
-    
-    cache_entry_t& entry = it->second;
+void ExternalCanBusCache::update_cache_entry(CacheSlot& slot, float value) {
+    cache_entry_t& entry = slot.entry;
     entry.value = value;
     entry.last_update_time = millis();
     entry.state = CACHE_STATE_VALID;
@@ -330,7 +358,7 @@ void ExternalCanBusCache::update_cache_entry(uint32_t external_key, float value)
     char debug_msg[100];
     snprintf(debug_msg, sizeof(debug_msg), 
             "Cache: Updated external key 0x%08X with value %.2f", 
-            external_key, value);
+            slot.mapping.external_key, value);
     debug_print(debug_msg);
 }
 
@@ -340,7 +368,31 @@ void ExternalCanBusCache::update_cache_entry(uint32_t external_key, float value)
 
 bool ExternalCanBusCache::add_mapping(const cache_mapping_t& mapping) {
     // Allow adding mappings even during initialization
-    cache_mappings[mapping.external_key] = mapping;
+    uint8_t index = find_slot(mapping.external_key);
+    if (index != NO_SLOT) {
+        // A remapped key starts over with a fresh entry
+        release_entry(index);
+    } else {
+        for (index = 0; index < MAX_MAPPINGS && slots[index].in_use; index++) {
+        }
+        if (index == MAX_MAPPINGS) {
+            debug_print("Cache: Mapping table full");
+            return false;
+        }
+        
+        // Linear probing - at most MAX_MAPPINGS keys in a table twice that size
+        uint16_t position = index_hash(mapping.external_key);
+        while (key_index[position] != NO_SLOT) {
+            position = (position + 1) & (INDEX_TABLE_SIZE - 1);
+        }
+        key_index[position] = index;
+    }
+    
+    CacheSlot& slot = slots[index];
+    slot.mapping = mapping;
+    slot.in_use = true;
+    slot.has_entry = false;
+    slot.next_for_msg = NO_SLOT;
     
     char debug_msg[100];
     snprintf(debug_msg, sizeof(debug_msg), 
@@ -368,17 +420,15 @@ bool ExternalCanBusCache::remove_mapping(uint32_t external_key) {
         return false;
     }
     
-    // Remove from mappings
-    auto mapping_it = cache_mappings.find(external_key);
-    if (mapping_it != cache_mappings.end()) {
-        cache_mappings.erase(mapping_it);
+    uint8_t index = find_slot(external_key);
+    if (index == NO_SLOT) {
+        return true;
     }
     
-    // Remove cache entry if it exists
-    auto entry_it = cache_entries.find(external_key);
-    if (entry_it != cache_entries.end()) {
-        cache_entries.erase(entry_it);
-    }
+    // Remove cache entry if it exists, then the mapping
+    release_entry(index);
+    slots[index].in_use = false;
+    rebuild_key_index();
     
     return true;
 }
@@ -419,14 +469,85 @@ bool ExternalCanBusCache::load_custom_mappings() {
 // UTILITY FUNCTIONS
 // ============================================================================
 
-cache_mapping_t* ExternalCanBusCache::find_mapping(uint32_t external_key) {
-    auto it = cache_mappings.find(external_key);
-    if (it != cache_mappings.end()) {
-        return &it->second;
+uint16_t ExternalCanBusCache::index_hash(uint32_t key) {
+    return fib_hash(key, INDEX_TABLE_BITS);
+}
+
+ECU_HOT_CODE uint8_t ExternalCanBusCache::find_slot(uint32_t external_key) const {
+    uint16_t position = index_hash(external_key);
+    for (uint16_t probe = 0; probe < INDEX_TABLE_SIZE; probe++) {
+        uint8_t index = key_index[position];
+        if (index == NO_SLOT) {
+            return NO_SLOT;
+        }
+        if (slots[index].mapping.external_key == external_key) {
+            return index;
+        }
+        position = (position + 1) & (INDEX_TABLE_SIZE - 1);
+    }
+    return NO_SLOT;
+}
+
+ECU_HOT_CODE ExternalCanBusCache::MessageSlot* ExternalCanBusCache::find_message_slot(uint32_t internal_msg_id, bool create) {
+    uint16_t position = index_hash(internal_msg_id);
+    for (uint16_t probe = 0; probe < INDEX_TABLE_SIZE; probe++) {
+        MessageSlot& message = message_index[position];
+        if (!message.in_use) {
+            if (!create) {
+                return nullptr;
+            }
+            message.internal_msg_id = internal_msg_id;
+            message.head = NO_SLOT;
+            message.in_use = true;
+            message.bus_subscribed = false;
+            return &message;
+        }
+        if (message.internal_msg_id == internal_msg_id) {
+            return &message;
+        }
+        position = (position + 1) & (INDEX_TABLE_SIZE - 1);
     }
     return nullptr;
 }
 
+void ExternalCanBusCache::rebuild_key_index() {
+    // Removal is rare; re-inserting everything avoids tombstones
+    for (uint16_t i = 0; i < INDEX_TABLE_SIZE; i++) {
+        key_index[i] = NO_SLOT;
+    }
+    for (uint8_t index = 0; index < MAX_MAPPINGS; index++) {
+        if (!slots[index].in_use) {
+            continue;
+        }
+        uint16_t position = index_hash(slots[index].mapping.external_key);
+        while (key_index[position] != NO_SLOT) {
+            position = (position + 1) & (INDEX_TABLE_SIZE - 1);
+        }
+        key_index[position] = index;
+    }
+}
+
+void ExternalCanBusCache::clear_tables() {
+    for (uint8_t i = 0; i < MAX_MAPPINGS; i++) {
+        slots[i].in_use = false;
+        slots[i].has_entry = false;
+        slots[i].next_for_msg = NO_SLOT;
+    }
+    for (uint16_t i = 0; i < INDEX_TABLE_SIZE; i++) {
+        key_index[i] = NO_SLOT;
+        message_index[i].in_use = false;
+    }
+    entry_count = 0;
+}
+
+cache_entry_t* ExternalCanBusCache::find_entry(uint32_t external_key) {
+    uint8_t index = find_slot(external_key);
+    if (index == NO_SLOT || !slots[index].has_entry) {
+        return nullptr;
+    }
+    return &slots[index].entry;
+}
+
 bool ExternalCanBusCache::is_entry_fresh(const cache_entry_t& entry, uint32_t max_age_ms) const {
     return (entry.state == CACHE_STATE_VALID && 
             get_entry_age_ms(entry) < max_age_ms);
@@ -454,7 +575,7 @@ void ExternalCanBusCache::reset_statistics() {
 }
 
 uint32_t ExternalCanBusCache::get_entry_count() const {
-    return cache_entries.size();
+    return entry_count;
 }
 
 uint32_t ExternalCanBusCache::get_subscription_count() const {
@@ -463,8 +584,8 @@ uint32_t ExternalCanBusCache::get_subscription_count() const {
 
 uint32_t ExternalCanBusCache::get_fresh_entry_count() const {
     uint32_t count = 0;
-    for (const auto& pair : cache_entries) {
-        if (is_entry_fresh(pair.second, default_max_age_ms)) {
+    for (uint8_t i = 0; i < MAX_MAPPINGS; i++) {
+        if (slots[i].has_entry && is_entry_fresh(slots[i].entry, default_max_age_ms)) {
             count++;
         }
     }
@@ -473,8 +594,8 @@ uint32_t ExternalCanBusCache::get_fresh_entry_count() const {
 
 uint32_t ExternalCanBusCache::get_stale_entry_count() const {
     uint32_t count = 0;
-    for (const auto& pair : cache_entries) {
-        if (pair.second.state == CACHE_STATE_STALE) {
+    for (uint8_t i = 0; i < MAX_MAPPINGS; i++) {
+        if (slots[i].has_entry && slots[i].entry.state == CACHE_STATE_STALE) {
             count++;
         }
     }
@@ -488,14 +609,14 @@ void ExternalCanBusCache::update() {
     
     // Check for stale entries
     check_stale_entries();
-    
-    // Cleanup unused entries (could be done periodically)
-    // cleanup_unused_entries();
 }
 
 void ExternalCanBusCache::check_stale_entries() {
-    for (auto& pair : cache_entries) {
-        cache_entry_t& entry = pair.second;
+    for (uint8_t i = 0; i < MAX_MAPPINGS; i++) {
+        if (!slots[i].has_entry) {
+            continue;
+        }
+        cache_entry_t& entry = slots[i].entry;
         if (entry.state == CACHE_STATE_VALID && 
             !is_entry_fresh(entry, entry.max_age_ms)) {
             entry.state = CACHE_STATE_STALE;
@@ -556,11 +677,7 @@ void ExternalCanBusCache::simulate_internal_message(uint32_t msg_id, float value
 }
 
 const cache_entry_t* ExternalCanBusCache::get_cache_entry_for_testing(uint32_t external_key) {
-    auto it = cache_entries.find(external_key);
-    if (it != cache_entries.end()) {
-        return &it->second;
-    }
-    return nullptr;
+    return find_entry(external_key);
 }
 
 bool ExternalCanBusCache::force_subscription_for_testing(uint32_t external_key) {
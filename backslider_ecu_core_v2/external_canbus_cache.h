@@ -1,6 +1,14 @@
 // external_canbus_cache.h
 // Lazy-loading cache system for external CAN bus
 // Automatically subscribes to internal messages when first requested
+//
+// Storage is fixed-capacity and heap-free: every mapping owns one slot
+// (mapping plus its lazily created entry), found through an open-addressing
+// index on the external key, so get_value() is one hash probe. Subscribed
+// slots are chained per internal message ID off a second table, so a bus
+// message is one probe plus a walk over only the keys that want it. Each
+// internal ID is subscribed on the message bus once, however many keys
+// map to it.
 
 #ifndef EXTERNAL_CANBUS_CACHE_H
 #define EXTERNAL_CANBUS_CACHE_H
@@ -10,12 +18,8 @@
 
 #ifdef ARDUINO
     #include <Arduino.h>
-    #include <map>
-    #include <vector>
 #else
     #include "tests/mock_arduino.h"
-    #include <map>
-    #include <vector>
 #endif
 
 // Cache entry states
@@ -69,6 +73,13 @@ struct cache_stats_t {
 
 class ExternalCanBusCache {
 public:
+    // Capacity (mappings, each with room for its cache entry)
+    static const uint8_t MAX_MAPPINGS = 64;
+    
+    // Index sizing (power of two, >= 2x MAX_MAPPINGS so probes stay short)
+    static const uint8_t INDEX_TABLE_BITS = 7;
+    static const uint16_t INDEX_TABLE_SIZE = (1u << INDEX_TABLE_BITS);
+    
     // Constructor
     ExternalCanBusCache();
     ~ExternalCanBusCache();
@@ -106,7 +117,8 @@ public:
     // CONFIGURATION
     // =========================================================================
     
-    // Add cache mapping (defines external_key -> internal_msg_id relationship)
+    // Add cache mapping (defines external_key -> internal_msg_id relationship).
+    // Replaces an existing mapping for the key; false once MAX_MAPPINGS are used.
     bool add_mapping(const cache_mapping_t& mapping);
     bool add_mapping(uint32_t external_key, uint32_t internal_msg_id, 
                      uint32_t max_age_ms, const char* description);
@@ -168,14 +180,31 @@ private:
     // INTERNAL DATA
     // =========================================================================
     
-    // Cache storage - external_key -> cache_entry
-    std::map<uint32_t, cache_entry_t> cache_entries;
-    
-    // Mapping storage - external_key -> mapping_info
-    std::map<uint32_t, cache_mapping_t> cache_mappings;
-    
-    // Reverse lookup - internal_msg_id -> list of external_keys
-    std::map<uint32_t, std::vector<uint32_t>> subscription_map;
+    static const uint8_t NO_SLOT = 0xFF;
+    
+    // One mapping and its cache entry
+    struct CacheSlot {
+        cache_mapping_t mapping;
+        cache_entry_t entry;
+        bool in_use;                // Holds a mapping
+        bool has_entry;             // Entry created by a request
+        uint8_t next_for_msg;       // Next subscribed slot with the same internal ID
+    };
+    CacheSlot slots[MAX_MAPPINGS];
+    uint8_t entry_count;
+    
+    // external_key -> slot (linear probing, NO_SLOT = empty)
+    uint8_t key_index[INDEX_TABLE_SIZE];
+    
+    // internal_msg_id -> chain of subscribed slots. IDs stay once seen (the
+    // bus subscription does too), so there are never more than MAX_MAPPINGS.
+    struct MessageSlot {
+        uint32_t internal_msg_id;
+        uint8_t head;               // First subscribed slot (NO_SLOT = none right now)
+        bool in_use;
+        bool bus_subscribed;
+    };
+    MessageSlot message_index[INDEX_TABLE_SIZE];
     
     // Configuration
     uint32_t default_max_age_ms;
@@ -190,18 +219,25 @@ private:
     
     // Lazy loading implementation
     cache_entry_t* get_or_create_entry(uint32_t external_key);
-    bool subscribe_to_internal_message(uint32_t external_key, cache_entry_t& entry);
+    bool subscribe_to_internal_message(uint8_t slot_index);
     
     // Cache maintenance
     void check_stale_entries();
-    void cleanup_unused_entries();
+    void release_entry(uint8_t slot_index);
     
     // Message handling
     void handle_internal_message(const CANMessage* msg);
-    void update_cache_entry(uint32_t external_key, float value);
+    void update_cache_entry(CacheSlot& slot, float value);
+    
+    // Index tables
+    static uint16_t index_hash(uint32_t key);
+    uint8_t find_slot(uint32_t external_key) const;
+    MessageSlot* find_message_slot(uint32_t internal_msg_id, bool create);
+    void rebuild_key_index();
+    void clear_tables();
     
     // Utility functions
-    cache_mapping_t* find_mapping(uint32_t external_key);
+    cache_entry_t* find_entry(uint32_t external_key);
     bool is_entry_fresh(const cache_entry_t& entry, uint32_t max_age_ms) const;
     uint32_t get_entry_age_ms(const cache_entry_t& entry) const;
     
@@ -1,6 +1,8 @@
 #include "external_message_broadcasting.h"
 #include "external_canbus.h"
 #include "external_serial.h"
+#include "id_hash.h"
+#include <math.h>
 
 // =============================================================================
 // STATIC MEMBER VARIABLES
@@ -12,9 +14,16 @@ bool ExternalMessageBroadcasting::broadcasting_enabled = true;
 ExternalCanBus* ExternalMessageBroadcasting::external_canbus = nullptr;
 ExternalSerial* ExternalMessageBroadcasting::external_serial = nullptr;
 
+ExternalMessageBroadcasting::broadcast_group_t ExternalMessageBroadcasting::broadcast_groups[MAX_BROADCAST_GROUPS];
+ExternalMessageBroadcasting::wheel_entry_t ExternalMessageBroadcasting::wheel_entries[MAX_BROADCAST_MESSAGES + MAX_BROADCAST_GROUPS];
+uint8_t ExternalMessageBroadcasting::wheel_slots[BROADCAST_WHEEL_SLOTS];
+uint32_t ExternalMessageBroadcasting::wheel_tick_ms = 0;
+uint8_t ExternalMessageBroadcasting::config_index[INDEX_TABLE_SIZE];
+
 uint32_t ExternalMessageBroadcasting::total_messages_broadcast = 0;
 uint32_t ExternalMessageBroadcasting::can_bus_broadcasts = 0;
 uint32_t ExternalMessageBroadcasting::serial_broadcasts = 0;
+uint32_t ExternalMessageBroadcasting::group_broadcasts = 0;
 
 // =============================================================================
 // PUBLIC METHODS
@@ -26,9 +35,16 @@ void ExternalMessageBroadcasting::init() {
         broadcast_configs[i].msg_id = 0;
         broadcast_configs[i].description = nullptr;
         broadcast_configs[i].enabled = false;
+        wheel_entries[i].scheduled = false;
+    }
+    for (uint8_t g = 0; g < MAX_BROADCAST_GROUPS; g++) {
+        broadcast_groups[g].frame_id = 0;
+        wheel_entries[MAX_BROADCAST_MESSAGES + g].scheduled = false;
     }
     
     registered_message_count = 0;
+    rebuild_indexes();
+    wheel_tick_ms = millis();
     broadcasting_enabled = true;
     external_canbus = nullptr;
     external_serial = nullptr;
@@ -36,6 +52,7 @@ void ExternalMessageBroadcasting::init() {
     total_messages_broadcast = 0;
     can_bus_broadcasts = 0;
     serial_broadcasts = 0;
+    group_broadcasts = 0;
     
     #ifdef ARDUINO
     Serial.println("ExternalMessageBroadcasting: Initialized");
@@ -60,15 +77,19 @@ bool ExternalMessageBroadcasting::register_broadcast_message(uint32_t msg_id,
     Serial.println();
     #endif
     
-    if (registered_message_count >= MAX_BROADCAST_MESSAGES) {
-        #ifdef ARDUINO
-        Serial.println("ExternalMessageBroadcasting: Maximum broadcast messages reached");
-        #endif
-        return false;
+    // A message cached only for a broadcast group starts going out on its own
+    int8_t existing = find_message_config(msg_id);
+    if (existing >= 0 && broadcast_configs[existing].group_only) {
+        broadcast_configs[existing].description = description;
+        broadcast_configs[existing].broadcast_frequency_hz = frequency_hz;
+        broadcast_configs[existing].enabled = true;
+        broadcast_configs[existing].group_only = false;
+        schedule(existing);
+        return true;
     }
     
     // Check if message is already registered
-    if (find_message_config(msg_id) >= 0) {
+    if (existing >= 0) {
         #ifdef ARDUINO
         Serial.print("ExternalMessageBroadcasting: Message 0x");
         Serial.print(msg_id, HEX);
@@ -77,39 +98,13 @@ bool ExternalMessageBroadcasting::register_broadcast_message(uint32_t msg_id,
         return false;
     }
     
-    // Add new broadcast configuration
-    broadcast_configs[registered_message_count].msg_id = msg_id;
-    broadcast_configs[registered_message_count].description = description;
-    broadcast_configs[registered_message_count].enabled = true;
-    broadcast_configs[registered_message_count].broadcast_frequency_hz = frequency_hz;
-    broadcast_configs[registered_message_count].last_broadcast_ms = 0;
-    broadcast_configs[registered_message_count].cached_value = 0.0f;
-    broadcast_configs[registered_message_count].has_cached_value = false;
-    broadcast_configs[registered_message_count].last_update_ms = 0;
-    
-    #ifdef ARDUINO
-    Serial.print("DEBUG: About to subscribe to message 0x");
-    Serial.print(msg_id, HEX);
-    Serial.println(" on message bus");
-    #endif
-    
-    // Subscribe to this message on the message bus
-    bool subscribe_result = g_message_bus.subscribe(msg_id, on_message_received);
-    
-    #ifdef ARDUINO
-    Serial.print("DEBUG: Subscribe result for message 0x");
-    Serial.print(msg_id, HEX);
-    Serial.print(": ");
-    Serial.println(subscribe_result ? "SUCCESS" : "FAILED");
-    #endif
-    
-    #ifdef ARDUINO
-    Serial.print("DEBUG: Successfully subscribed to message 0x");
-    Serial.print(msg_id, HEX);
-    Serial.println(" on message bus");
-    #endif
-    
-    registered_message_count++;
+    int8_t index = add_message_config(msg_id, description, frequency_hz, false);
+    if (index < 0) {
+        #ifdef ARDUINO
+        Serial.println("ExternalMessageBroadcasting: Maximum broadcast messages reached");
+        #endif
+        return false;
+    }
     
     #ifdef ARDUINO
     Serial.print("ExternalMessageBroadcasting: Registered message 0x");
@@ -117,7 +112,7 @@ bool ExternalMessageBroadcasting::register_broadcast_message(uint32_t msg_id,
     Serial.print(" (");
     Serial.print(description);
     Serial.print(") at index ");
-    Serial.print(registered_message_count - 1);
+    Serial.print(index);
     Serial.print(", frequency_hz=");
     Serial.print(frequency_hz);
     Serial.print(" - SUCCESS");
@@ -129,31 +124,90 @@ bool ExternalMessageBroadcasting::register_broadcast_message(uint32_t msg_id,
 
 bool ExternalMessageBroadcasting::unregister_broadcast_message(uint32_t msg_id) {
     int8_t index = find_message_config(msg_id);
-    if (index < 0) {
+    if (index < 0 || broadcast_configs[index].group_only) {
         return false;
     }
     
+    // Groups still sample it: keep the cache, stop the single broadcasts
+    if (broadcast_configs[index].group_refs > 0) {
+        unschedule(index);
+        broadcast_configs[index].group_only = true;
+        return true;
+    }
+    
+    remove_message_config(index);
+    
+    #ifdef ARDUINO
+    Serial.print("ExternalMessageBroadcasting: Unregistered message 0x");
+    Serial.println(msg_id, HEX);
+    #endif
+    
+    return true;
+}
+
+int8_t ExternalMessageBroadcasting::add_message_config(uint32_t msg_id, const char* description,
+                                                       uint32_t frequency_hz, bool group_only) {
+    if (registered_message_count >= MAX_BROADCAST_MESSAGES) {
+        return -1;
+    }
+    
+    // Add new broadcast configuration
+    uint8_t index = registered_message_count;
+    broadcast_configs[index].msg_id = msg_id;
+    broadcast_configs[index].description = description;
+    broadcast_configs[index].enabled = true;
+    broadcast_configs[index].broadcast_frequency_hz = frequency_hz;
+    broadcast_configs[index].last_broadcast_ms = 0;
+    broadcast_configs[index].cached_value = 0.0f;
+    broadcast_configs[index].has_cached_value = false;
+    broadcast_configs[index].cached_timestamp_us = 0;
+    broadcast_configs[index].last_update_ms = 0;
+    broadcast_configs[index].group_only = group_only;
+    broadcast_configs[index].group_refs = 0;
+    wheel_entries[index].scheduled = false;
+    
+    uint16_t position = index_hash(msg_id);
+    while (config_index[position] != 0) {
+        position = (position + 1) & (INDEX_TABLE_SIZE - 1);
+    }
+    config_index[position] = index + 1;
+    
+    // Subscribe to this message on the message bus
+    bool subscribe_result = g_message_bus.subscribe(msg_id, on_message_received);
+    
+    #ifdef ARDUINO
+    Serial.print("DEBUG: Subscribe result for message 0x");
+    Serial.print(msg_id, HEX);
+    Serial.print(": ");
+    Serial.println(subscribe_result ? "SUCCESS" : "FAILED");
+    #else
+    (void)subscribe_result;
+    #endif
+    
+    registered_message_count++;
+    return index;
+}
+
+void ExternalMessageBroadcasting::remove_message_config(uint8_t index) {
     // Note: MessageBus doesn't have unsubscribe method yet
     // g_message_bus.unsubscribe(msg_id, on_message_received);
     
     // Remove from configuration array (shift remaining entries)
     for (uint8_t i = index; i < registered_message_count - 1; i++) {
         broadcast_configs[i] = broadcast_configs[i + 1];
+        wheel_entries[i] = wheel_entries[i + 1];
     }
     
     // Clear last entry
     broadcast_configs[registered_message_count - 1].msg_id = 0;
     broadcast_configs[registered_message_count - 1].description = nullptr;
     broadcast_configs[registered_message_count - 1].enabled = false;
+    wheel_entries[registered_message_count - 1].scheduled = false;
     
     registered_message_count--;
     
-    #ifdef ARDUINO
-    Serial.print("ExternalMessageBroadcasting: Unregistered message 0x");
-    Serial.println(msg_id, HEX);
-    #endif
-    
-    return true;
+    // Indices moved; removal is rare, so rebuild rather than patch
+    rebuild_indexes();
 }
 
 bool ExternalMessageBroadcasting::enable_broadcast_message(uint32_t msg_id, bool enable) {
@@ -163,6 +217,11 @@ bool ExternalMessageBroadcasting::enable_broadcast_message(uint32_t msg_id, bool
     }
     
     broadcast_configs[index].enabled = enable;
+    if (enable) {
+        schedule(index);
+    } else {
+        unschedule(index);
+    }
     
     #ifdef ARDUINO
     Serial.print("ExternalMessageBroadcasting: ");
@@ -180,7 +239,9 @@ bool ExternalMessageBroadcasting::set_broadcast_frequency(uint32_t msg_id, uint3
         return false;
     }
     
+    unschedule(index);
     broadcast_configs[index].broadcast_frequency_hz = frequency_hz;
+    schedule(index);
     
     #ifdef ARDUINO
     Serial.print("ExternalMessageBroadcasting: Set frequency for message 0x");
@@ -224,10 +285,15 @@ uint32_t ExternalMessageBroadcasting::get_serial_broadcasts() {
     return serial_broadcasts;
 }
 
+uint32_t ExternalMessageBroadcasting::get_group_broadcasts() {
+    return group_broadcasts;
+}
+
 void ExternalMessageBroadcasting::reset_statistics() {
     total_messages_broadcast = 0;
     can_bus_broadcasts = 0;
     serial_broadcasts = 0;
+    group_broadcasts = 0;
 }
 
 const broadcast_message_config_t* ExternalMessageBroadcasting::get_broadcast_configs(uint8_t* count) {
@@ -247,37 +313,17 @@ void ExternalMessageBroadcasting::update() {
     }
     
     uint32_t now_ms = millis();
+    uint32_t elapsed_ms = now_ms - wheel_tick_ms;
+    if (elapsed_ms == 0) {
+        return;
+    }
     
-    // Check all registered messages for frequency-based broadcasting
-    for (uint8_t i = 0; i < registered_message_count; i++) {
-        if (!broadcast_configs[i].enabled || 
-            broadcast_configs[i].broadcast_frequency_hz == 0 ||
-            !broadcast_configs[i].has_cached_value) {
-            continue;
-        }
-        
-        // Check if it's time to broadcast based on frequency
-        uint32_t interval_ms = 1000 / broadcast_configs[i].broadcast_frequency_hz;
-        if (now_ms - broadcast_configs[i].last_broadcast_ms >= interval_ms) {
-            // Create a message from cached value and broadcast it
-            CANMessage cached_msg;
-            cached_msg.id = broadcast_configs[i].msg_id;
-            cached_msg.len = 4;
-            memcpy(cached_msg.buf, &broadcast_configs[i].cached_value, 4);
-            #ifdef ARDUINO
-            cached_msg.timestamp = (uint16_t)(micros() & 0xFFFF);  // Set timestamp for cached message
-            cached_msg.flags.extended = 1;
-            cached_msg.flags.remote = 0;
-            #else
-            cached_msg.timestamp = 0;
-            cached_msg.flags.extended = 1;
-            cached_msg.flags.remote = 0;
-            #endif
-            
-            broadcast_message(&cached_msg);
-            broadcast_configs[i].last_broadcast_ms = now_ms;
-        }
+    // Visit each slot whose tick has passed; after a long gap, every slot once
+    uint32_t ticks = (elapsed_ms < BROADCAST_WHEEL_SLOTS) ? elapsed_ms : BROADCAST_WHEEL_SLOTS;
+    for (uint32_t tick = 1; tick <= ticks; tick++) {
+        process_wheel_slot((uint16_t)((wheel_tick_ms + tick) & (BROADCAST_WHEEL_SLOTS - 1)), now_ms);
     }
+    wheel_tick_ms = now_ms;
 }
 
 // =============================================================================
@@ -345,8 +391,19 @@ void ExternalMessageBroadcasting::on_message_received(const CANMessage* msg) {
     // Update cache with new value
     broadcast_configs[index].cached_value = current_value;
     broadcast_configs[index].has_cached_value = true;
+    broadcast_configs[index].cached_timestamp_us = msg->timestamp_us;
     broadcast_configs[index].last_update_ms = millis();
     
+    // The first value puts a frequency-based message on the wheel
+    if (!wheel_entries[index].scheduled) {
+        schedule(index);
+    }
+    
+    // Group members are sent by their groups
+    if (broadcast_configs[index].group_only) {
+        return;
+    }
+    
     // For frequency-based broadcasting, just cache the value and let update() handle timing
     // For change-based broadcasting, broadcast immediately when value changes
     bool should_broadcast = false;
@@ -386,8 +443,14 @@ void ExternalMessageBroadcasting::broadcast_message(const CANMessage* msg) {
     }
     */
     
-    // Broadcast to CAN bus if available
-    if (external_canbus && external_canbus->is_initialized()) {
+    // Broadcast to CAN bus if available; FD peers get float values packed
+    if (external_canbus && external_canbus->is_initialized() &&
+        external_canbus->is_fd_packing_enabled() && msg->len == sizeof(float)) {
+        if (external_canbus->send_packed_value(msg->id, MSG_UNPACK_FLOAT(msg),
+                                               PARAM_OP_STATUS_BROADCAST)) {
+            can_bus_broadcasts++;
+        }
+    } else if (external_canbus && external_canbus->is_initialized()) {
         // Convert CANMessage to CAN_message_t and send
         CAN_message_t can_msg;
         can_msg.id = msg->id;
@@ -457,18 +520,124 @@ void ExternalMessageBroadcasting::force_broadcast_cached_values() {
     
     // Force broadcast all cached values immediately
     for (uint8_t i = 0; i < registered_message_count; i++) {
-        if (!broadcast_configs[i].enabled || !broadcast_configs[i].has_cached_value) {
+        if (!broadcast_configs[i].enabled || !broadcast_configs[i].has_cached_value ||
+            broadcast_configs[i].group_only) {
             continue;
         }
         
-        // Create a message from cached value and broadcast it
-        CANMessage cached_msg;
-        cached_msg.id = broadcast_configs[i].msg_id;
-        cached_msg.len = 4;
-        memcpy(cached_msg.buf, &broadcast_configs[i].cached_value, 4);
-        
-        broadcast_message(&cached_msg);
+        broadcast_cached_value(i);
         broadcast_configs[i].last_broadcast_ms = millis();
+        
+        // The next periodic broadcast is one interval from now
+        unschedule(i);
+        schedule(i);
+    }
+}
+
+void ExternalMessageBroadcasting::broadcast_cached_value(uint8_t index) {
+    // Create a message from cached value and broadcast it
+    CANMessage cached_msg;
+    cached_msg.id = broadcast_configs[index].msg_id;
+    cached_msg.len = 4;
+    memcpy(cached_msg.buf, &broadcast_configs[index].cached_value, 4);
+    // Re-broadcasts keep the stamp of when the value was published
+    cached_msg.timestamp_us = broadcast_configs[index].cached_timestamp_us;
+    cached_msg.timestamp = (uint16_t)cached_msg.timestamp_us;
+    cached_msg.flags.extended = 1;
+    cached_msg.flags.remote = 0;
+    
+    broadcast_message(&cached_msg);
+}
+
+// =============================================================================
+// TIMER WHEEL
+// =============================================================================
+
+void ExternalMessageBroadcasting::schedule(uint8_t index) {
+    if (wheel_entries[index].scheduled) {
+        return;
+    }
+    
+    uint32_t frequency_hz;
+    uint32_t last_broadcast_ms;
+    if (index >= MAX_BROADCAST_MESSAGES) {
+        const broadcast_group_t& group = broadcast_groups[index - MAX_BROADCAST_MESSAGES];
+        if (group.frame_id == 0) {
+            return;
+        }
+        frequency_hz = group.frequency_hz;
+        last_broadcast_ms = group.last_broadcast_ms;
+    } else {
+        const broadcast_message_config_t& config = broadcast_configs[index];
+        if (!config.enabled || config.group_only ||
+            config.broadcast_frequency_hz == 0 || !config.has_cached_value) {
+            return;
+        }
+        frequency_hz = config.broadcast_frequency_hz;
+        last_broadcast_ms = config.last_broadcast_ms;
+    }
+    
+    // Same timing as before the wheel: due one interval after the last broadcast
+    wheel_entries[index].interval_ms = 1000 / frequency_hz;
+    wheel_entries[index].due_ms = last_broadcast_ms + wheel_entries[index].interval_ms;
+    wheel_insert(index);
+}
+
+void ExternalMessageBroadcasting::wheel_insert(uint8_t index) {
+    wheel_entry_t& entry = wheel_entries[index];
+    
+    // Already due: the next update() picks it up
+    uint32_t tick = entry.due_ms;
+    if ((int32_t)(tick - wheel_tick_ms) <= 0) {
+        tick = wheel_tick_ms + 1;
+    }
+    
+    entry.slot = (uint16_t)(tick & (BROADCAST_WHEEL_SLOTS - 1));
+    entry.next = wheel_slots[entry.slot];
+    entry.scheduled = true;
+    wheel_slots[entry.slot] = index + 1;
+}
+
+void ExternalMessageBroadcasting::unschedule(uint8_t index) {
+    wheel_entry_t& entry = wheel_entries[index];
+    if (!entry.scheduled) {
+        return;
+    }
+    
+    uint8_t* link = &wheel_slots[entry.slot];
+    while (*link != 0) {
+        if (*link == index + 1) {
+            *link = entry.next;
+            break;
+        }
+        link = &wheel_entries[*link - 1].next;
+    }
+    entry.scheduled = false;
+}
+
+void ExternalMessageBroadcasting::process_wheel_slot(uint16_t slot, uint32_t now_ms) {
+    // Detach the slot so entries put back into it are not seen again
+    uint8_t link = wheel_slots[slot];
+    wheel_slots[slot] = 0;
+    
+    while (link != 0) {
+        uint8_t index = link - 1;
+        wheel_entry_t& entry = wheel_entries[index];
+        link = entry.next;
+        entry.scheduled = false;
+        
+        // Entries for a later revolution go straight back
+        if ((int32_t)(now_ms - entry.due_ms) >= 0) {
+            if (index >= MAX_BROADCAST_MESSAGES) {
+                send_group(index - MAX_BROADCAST_MESSAGES);
+                broadcast_groups[index - MAX_BROADCAST_MESSAGES].last_broadcast_ms = now_ms;
+            } else {
+                broadcast_cached_value(index);
+                broadcast_configs[index].last_broadcast_ms = now_ms;
+            }
+            entry.due_ms = now_ms + entry.interval_ms;
+        }
+        wheel_insert(index);
     }
 }
 
@@ -499,14 +668,221 @@ int8_t ExternalMessageBroadcasting::find_message_config(uint32_t msg_id) {
     #endif
     */
     
+    uint16_t position = index_hash(msg_id);
+    for (uint16_t probe = 0; probe < INDEX_TABLE_SIZE; probe++) {
+        uint8_t entry = config_index[position];
+        if (entry == 0) {
+            return -1;
+        }
+        if (broadcast_configs[entry - 1].msg_id == msg_id) {
+            return entry - 1;
+        }
+        position = (position + 1) & (INDEX_TABLE_SIZE - 1);
+    }
+    return -1;
+}
+
+uint16_t ExternalMessageBroadcasting::index_hash(uint32_t msg_id) {
+    return fib_hash(msg_id, INDEX_TABLE_BITS);
+}
+
+void ExternalMessageBroadcasting::rebuild_indexes() {
+    for (uint16_t i = 0; i < INDEX_TABLE_SIZE; i++) {
+        config_index[i] = 0;
+    }
+    for (uint16_t i = 0; i < BROADCAST_WHEEL_SLOTS; i++) {
+        wheel_slots[i] = 0;
+    }
+    
     for (uint8_t i = 0; i < registered_message_count; i++) {
-        if (broadcast_configs[i].msg_id == msg_id) {
-            return i;
+        uint16_t position = index_hash(broadcast_configs[i].msg_id);
+        while (config_index[position] != 0) {
+            position = (position + 1) & (INDEX_TABLE_SIZE - 1);
+        }
+        config_index[position] = i + 1;
+        
+        if (wheel_entries[i].scheduled) {
+            wheel_insert(i);
+        }
+    }
+    for (uint8_t g = 0; g < MAX_BROADCAST_GROUPS; g++) {
+        if (wheel_entries[MAX_BROADCAST_MESSAGES + g].scheduled) {
+            wheel_insert(MAX_BROADCAST_MESSAGES + g);
+        }
+    }
+}
+
+// =============================================================================
+// BROADCAST GROUPS
+// =============================================================================
+
+bool ExternalMessageBroadcasting::register_broadcast_group(uint32_t frame_id,
+                                                           const broadcast_group_signal_t* signals,
+                                                           uint8_t signal_count,
+                                                           uint32_t frequency_hz,
+                                                           const char* description) {
+    if (frame_id == 0 || signals == nullptr || signal_count == 0 ||
+        signal_count > BROADCAST_GROUP_MAX_SIGNALS || frequency_hz == 0 || find_group(frame_id) >= 0) {
+        return false;
+    }
+    
+    int8_t free_group = -1;
+    for (uint8_t g = 0; g < MAX_BROADCAST_GROUPS; g++) {
+        if (broadcast_groups[g].frame_id == 0) {
+            free_group = g;
+            break;
+        }
+    }
+    if (free_group < 0) {
+        return false;
+    }
+    
+    // Lay out the payload; a signal that would straddle a classic frame
+    // starts the next one. Count the configs the members still need.
+    uint8_t length = 0;
+    uint8_t new_configs = 0;
+    for (uint8_t i = 0; i < signal_count; i++) {
+        uint8_t size = (signals[i].encoding == BROADCAST_ENCODING_SCALED16) ? 2 : 4;
+        if ((length % 8) + size > 8) {
+            length = (uint8_t)((length + 7) & ~7);
+        }
+        length += size;
+        if (signals[i].encoding == BROADCAST_ENCODING_SCALED16 && signals[i].scale == 0.0f) {
+            return false;
+        }
+        if (find_message_config(signals[i].msg_id) < 0) {
+            new_configs++;
+        }
+        if (length > BROADCAST_GROUP_MAX_PAYLOAD) {
+            return false;
+        }
+    }
+    if (registered_message_count + new_configs > MAX_BROADCAST_MESSAGES) {
+        return false;
+    }
+    
+    broadcast_group_t& group = broadcast_groups[free_group];
+    group.frame_id = frame_id;
+    group.description = description;
+    memcpy(group.signals, signals, signal_count * sizeof(broadcast_group_signal_t));
+    group.signal_count = signal_count;
+    group.payload_length = length;
+    group.frequency_hz = frequency_hz;
+    group.last_broadcast_ms = millis();
+    
+    for (uint8_t i = 0; i < signal_count; i++) {
+        int8_t index = find_message_config(signals[i].msg_id);
+        if (index < 0) {
+            index = add_message_config(signals[i].msg_id, description, 0, true);
+        }
+        if (broadcast_configs[index].group_refs < 0xFF) {
+            broadcast_configs[index].group_refs++;
+        }
+    }
+    
+    schedule(MAX_BROADCAST_MESSAGES + free_group);
+    return true;
+}
+
+bool ExternalMessageBroadcasting::unregister_broadcast_group(uint32_t frame_id) {
+    int8_t g = find_group(frame_id);
+    if (g < 0) {
+        return false;
+    }
+    broadcast_group_t& group = broadcast_groups[g];
+    unschedule(MAX_BROADCAST_MESSAGES + g);
+    
+    // Members only this group needed go with it
+    for (uint8_t i = 0; i < group.signal_count; i++) {
+        int8_t index = find_message_config(group.signals[i].msg_id);
+        if (index < 0 || broadcast_configs[index].group_refs == 0) {
+            continue;
+        }
+        broadcast_configs[index].group_refs--;
+        if (broadcast_configs[index].group_refs == 0 && broadcast_configs[index].group_only) {
+            remove_message_config(index);
+        }
+    }
+    
+    group.frame_id = 0;
+    return true;
+}
+
+uint8_t ExternalMessageBroadcasting::get_group_payload_length(uint32_t frame_id) {
+    int8_t g = find_group(frame_id);
+    return (g < 0) ? 0 : broadcast_groups[g].payload_length;
+}
+
+int8_t ExternalMessageBroadcasting::find_group(uint32_t frame_id) {
+    for (uint8_t g = 0; g < MAX_BROADCAST_GROUPS; g++) {
+        if (broadcast_groups[g].frame_id == frame_id && frame_id != 0) {
+            return g;
         }
     }
     return -1;
 }
 
+void ExternalMessageBroadcasting::send_group(uint8_t group_index) {
+    const broadcast_group_t& group = broadcast_groups[group_index];
+    uint8_t payload[BROADCAST_GROUP_MAX_PAYLOAD];
+    memset(payload, 0, sizeof(payload));
+    
+    // Sample every member now, in the layout worked out at registration
+    uint8_t offset = 0;
+    for (uint8_t i = 0; i < group.signal_count; i++) {
+        const broadcast_group_signal_t& signal = group.signals[i];
+        int8_t index = find_message_config(signal.msg_id);
+        bool available = (index >= 0 && broadcast_configs[index].has_cached_value);
+        float value = available ? broadcast_configs[index].cached_value : NAN;
+        
+        if (signal.encoding == BROADCAST_ENCODING_SCALED16) {
+            if ((offset % 8) + 2 > 8) {
+                offset = (uint8_t)((offset + 7) & ~7);
+            }
+            uint16_t raw = BROADCAST_SCALED16_NOT_AVAILABLE;
+            if (available && !isnan(value)) {
+                float scaled = roundf((value - signal.offset) / signal.scale);
+                if (scaled < 0.0f) {
+                    scaled = 0.0f;
+                } else if (scaled > (float)(BROADCAST_SCALED16_NOT_AVAILABLE - 1)) {
+                    scaled = (float)(BROADCAST_SCALED16_NOT_AVAILABLE - 1);
+                }
+                raw = (uint16_t)scaled;
+            }
+            payload[offset] = (uint8_t)(raw & 0xFF);
+            payload[offset + 1] = (uint8_t)(raw >> 8);
+            offset += 2;
+        } else {
+            if ((offset % 8) + 4 > 8) {
+                offset = (uint8_t)((offset + 7) & ~7);
+            }
+            memcpy(&payload[offset], &value, sizeof(float));
+            offset += 4;
+        }
+    }
+    
+    group_broadcasts++;
+    if (!external_canbus || !external_canbus->is_initialized()) {
+        return;
+    }
+    
+    // One FD frame, or a train of classic frames on consecutive IDs
+    if (external_canbus->is_fd_enabled()) {
+        total_messages_broadcast++;
+        if (external_canbus->send_fd_message(group.frame_id, payload, group.payload_length)) {
+            can_bus_broadcasts++;
+        }
+        return;
+    }
+    for (uint8_t start = 0; start < group.payload_length; start += 8) {
+        uint8_t length = (group.payload_length - start < 8) ? (uint8_t)(group.payload_length - start) : 8;
+        total_messages_broadcast++;
+        if (external_canbus->send_custom_message(group.frame_id + start / 8, &payload[start], length)) {
+            can_bus_broadcasts++;
+        }
+    }
+}
+
 // =============================================================================
 // CONVENIENCE FUNCTIONS
 // =============================================================================
@@ -574,6 +950,22 @@ void register_vehicle_state_broadcast_messages() {
         BROADCAST_MSG_BRAKE_PEDAL, "Brake Pedal", 2);
 }
 
+void register_dashboard_broadcast_group() {
+    static const broadcast_group_signal_t signals[] = {
+        {BROADCAST_MSG_ENGINE_RPM,         BROADCAST_ENCODING_SCALED16, 1.0f,   0.0f},     // 0-65534 RPM
+        {BROADCAST_MSG_COOLANT_TEMP,       BROADCAST_ENCODING_SCALED16, 0.1f, -40.0f},     // °C
+        {BROADCAST_MSG_OIL_PRESSURE,       BROADCAST_ENCODING_SCALED16, 0.1f,   0.0f},
+        {BROADCAST_MSG_AIR_INTAKE_TEMP,    BROADCAST_ENCODING_SCALED16, 0.1f, -40.0f},     // °C
+        {BROADCAST_MSG_BATTERY_VOLTAGE,    BROADCAST_ENCODING_SCALED16, 0.001f, 0.0f},     // V
+        {BROADCAST_MSG_VEHICLE_SPEED,      BROADCAST_ENCODING_SCALED16, 0.01f,  0.0f},
+        {BROADCAST_MSG_THROTTLE_POSITION,  BROADCAST_ENCODING_SCALED16, 0.01f,  0.0f},     // %
+        {BROADCAST_MSG_BRAKE_PEDAL,        BROADCAST_ENCODING_SCALED16, 1.0f,   0.0f},
+        {BROADCAST_MSG_TRANS_CURRENT_GEAR, BROADCAST_ENCODING_SCALED16, 1.0f,   0.0f},
+    };
+    ExternalMessageBroadcasting::register_broadcast_group(
+        BROADCAST_GROUP_DASHBOARD_ID, signals, sizeof(signals) / sizeof(signals[0]), 20, "Dashboard");
+}
+
 void register_critical_broadcast_messages() {
     // Critical messages that need high-frequency broadcasting (5Hz+)
     // These are essential for safety and real-time control
@@ -24,6 +24,30 @@
 // 3. When messages are published, they're forwarded to external interfaces
 // 4. External interfaces receive only the messages they should see
 //
+// SCHEDULING:
+// - Frequency-based messages sit in a timer wheel of BROADCAST_WHEEL_SLOTS
+//   1 ms slots, linked through their config index. update() visits only the
+//   slots whose tick has passed since the last call, so a pass with nothing
+//   due costs the same however many messages are registered. An entry more
+//   than one revolution out stays in its slot until its round comes up.
+// - An entry is on the wheel only while it is enabled, has a frequency and
+//   has a cached value; its interval is worked out when it is scheduled.
+// - Message IDs map to configs through an open-addressing hash index, so
+//   each bus message costs one probe rather than a search.
+//
+// BROADCAST GROUPS:
+// - A group samples a set of message IDs together at one rate and sends
+//   them as one payload on its own frame ID: a single frame on a CAN FD
+//   bus, otherwise a train of 8-byte frames on frame_id, frame_id + 1, ...
+//   Thirty 20 Hz channels as 16-bit values are 8 frames instead of 30.
+// - Each signal is a little-endian float, or a 16-bit unsigned raw value
+//   with value = raw * scale + offset (DBC style), clamped to the range;
+//   0xFFFF means no value yet (NaN for floats). Signals never straddle two
+//   classic frames, so each frame decodes on its own.
+// - Group members are cached like any broadcast message. A member that is
+//   not also registered on its own is not sent by itself.
+// - Groups share the timer wheel with the single messages.
+//
 // =============================================================================
 
 // Forward declarations
@@ -39,9 +63,30 @@ typedef struct {
     uint32_t last_broadcast_ms;       // Last time this message was broadcast
     float cached_value;               // Cached value for frequency-based broadcasting
     bool has_cached_value;            // Whether we have a valid cached value
+    uint32_t cached_timestamp_us;     // Publish stamp of the cached value
     uint32_t last_update_ms;          // Last time the value was updated from message bus
+    bool group_only;                  // Cached for broadcast groups, not sent on its own
+    uint8_t group_refs;               // Broadcast groups sampling this message
 } broadcast_message_config_t;
 
+// Broadcast group signal encodings
+typedef enum {
+    BROADCAST_ENCODING_FLOAT32  = 0,    // 4 bytes, IEEE 754
+    BROADCAST_ENCODING_SCALED16 = 1     // 2 bytes, value = raw * scale + offset
+} broadcast_encoding_t;
+
+// One message sampled into a broadcast group
+typedef struct {
+    uint32_t msg_id;
+    broadcast_encoding_t encoding;
+    float scale;                // SCALED16 only
+    float offset;               // SCALED16 only
+} broadcast_group_signal_t;
+
+#define BROADCAST_GROUP_MAX_SIGNALS         32
+#define BROADCAST_GROUP_MAX_PAYLOAD         64      // One CAN FD frame, or 8 classic frames
+#define BROADCAST_SCALED16_NOT_AVAILABLE    0xFFFF
+
 // External interface types
 typedef enum {
     BROADCAST_TARGET_CAN_BUS = 0x01,
@@ -72,6 +117,17 @@ public:
     // Enable/disable broadcasting for all messages
     static void enable_all_broadcasts(bool enable);
     
+    // Broadcast groups: signals are copied; frequency_hz must be non-zero
+    static bool register_broadcast_group(uint32_t frame_id,
+                                         const broadcast_group_signal_t* signals,
+                                         uint8_t signal_count,
+                                         uint32_t frequency_hz,
+                                         const char* description);
+    static bool unregister_broadcast_group(uint32_t frame_id);
+    
+    // Payload bytes of a group (classic frames: 8 per frame), 0 if unknown
+    static uint8_t get_group_payload_length(uint32_t frame_id);
+    
     // Set external interface pointers (called by main application)
     static void set_external_interfaces(ExternalCanBus* canbus, ExternalSerial* serial);
     
@@ -79,6 +135,7 @@ public:
     static uint32_t get_messages_broadcast();
     static uint32_t get_can_bus_broadcasts();
     static uint32_t get_serial_broadcasts();
+    static uint32_t get_group_broadcasts();     // Group samples sent
     
     // Reset statistics
     static void reset_statistics();
@@ -97,7 +154,36 @@ public:
 
 private:
     // Maximum number of broadcast messages
-    static const uint8_t MAX_BROADCAST_MESSAGES = 50;
+    static const uint8_t MAX_BROADCAST_MESSAGES = 64;
+    static const uint8_t MAX_BROADCAST_GROUPS = 4;
+    
+    struct broadcast_group_t {
+        uint32_t frame_id;              // 0 = free
+        const char* description;
+        broadcast_group_signal_t signals[BROADCAST_GROUP_MAX_SIGNALS];
+        uint8_t signal_count;
+        uint8_t payload_length;
+        uint32_t frequency_hz;
+        uint32_t last_broadcast_ms;
+    };
+    
+    // Timer wheel: 1 ms per slot, power of two
+    static const uint16_t BROADCAST_WHEEL_SLOTS = 256;
+    
+    // msg_id -> config index + 1 (linear probing, 0 = empty)
+    static const uint8_t INDEX_TABLE_BITS = 7;
+    static const uint16_t INDEX_TABLE_SIZE = (1u << INDEX_TABLE_BITS);
+    static_assert(MAX_BROADCAST_MESSAGES * 2 <= INDEX_TABLE_SIZE, "Broadcast index must stay at most half full");
+    
+    // Wheel state per config, same index as broadcast_configs; group g is
+    // entry MAX_BROADCAST_MESSAGES + g
+    struct wheel_entry_t {
+        uint32_t due_ms;
+        uint32_t interval_ms;
+        uint16_t slot;
+        uint8_t next;               // Next entry in the slot, index + 1 (0 = end)
+        bool scheduled;
+    };
     
     // Message handler for subscribed messages
     static void on_message_received(const CANMessage* msg);
@@ -112,13 +198,36 @@ private:
     static ExternalCanBus* external_canbus;
     static ExternalSerial* external_serial;
     
+    static broadcast_group_t broadcast_groups[MAX_BROADCAST_GROUPS];
+    static wheel_entry_t wheel_entries[MAX_BROADCAST_MESSAGES + MAX_BROADCAST_GROUPS];
+    static uint8_t wheel_slots[BROADCAST_WHEEL_SLOTS];     // First entry per slot, index + 1 (0 = none)
+    static uint32_t wheel_tick_ms;                          // Last tick processed
+    static uint8_t config_index[INDEX_TABLE_SIZE];
+    
     // Statistics
     static uint32_t total_messages_broadcast;
     static uint32_t can_bus_broadcasts;
     static uint32_t serial_broadcasts;
+    static uint32_t group_broadcasts;
     
     // Find message config by ID
     static int8_t find_message_config(uint32_t msg_id);
+    static uint16_t index_hash(uint32_t msg_id);
+    static void rebuild_indexes();
+    static int8_t add_message_config(uint32_t msg_id, const char* description,
+                                     uint32_t frequency_hz, bool group_only);
+    static void remove_message_config(uint8_t index);
+    
+    // Broadcast groups
+    static int8_t find_group(uint32_t frame_id);
+    static void send_group(uint8_t group_index);
+    
+    // Timer wheel
+    static void schedule(uint8_t index);
+    static void unschedule(uint8_t index);
+    static void wheel_insert(uint8_t index);
+    static void process_wheel_slot(uint16_t slot, uint32_t now_ms);
+    static void broadcast_cached_value(uint8_t index);
 };
 
 // =============================================================================
@@ -170,4 +279,9 @@ void register_vehicle_state_broadcast_messages();
 // Register high-frequency critical messages (5Hz+)
 void register_critical_broadcast_messages();
 
+// Register the 20Hz dashboard group: engine and vehicle state as 16-bit
+// scaled values on BROADCAST_GROUP_DASHBOARD_ID onward
+#define BROADCAST_GROUP_DASHBOARD_ID          0x6F0
+void register_dashboard_broadcast_group();
+
 #endif // EXTERNAL_MESSAGE_BROADCASTING_H 
\ No newline at end of file
@@ -4,11 +4,16 @@
 #include "external_serial.h"
 #include "msg_bus.h"
 #include "parameter_helpers.h"
+#include "id_hash.h"
+#include <math.h>
 #ifdef TESTING
 // In testing mode, Stream class is defined in mock_arduino.h
 #else
 #include <Stream.h>
 #endif
+#if defined(ARDUINO) && defined(__IMXRT1062__)
+#include <DMAChannel.h>
+#endif
 
 // Global instance
 ExternalSerial g_external_serial;
@@ -16,6 +21,32 @@ ExternalSerial g_external_serial;
 // Static pointer for message bus callback (since callbacks can't be member functions)
 static ExternalSerial* g_serial_instance = nullptr;
 
+// Encoded v2 frame on its way out (bridges write one at a time)
+static uint8_t link_encode_buffer[SERIAL_LINK_MAX_ENCODED + 1];
+
+// Free filter slot; ECU base 0xF is never assigned
+#define SERIAL_FILTER_EMPTY     0xFFFFFFFF
+
+// How full the TX ring may get for each priority before its messages drop
+const uint8_t SerialBridge::TX_FILL_LIMIT_PERCENT[MSG_PRIORITY_COUNT] = {
+    100,    // MSG_PRIORITY_CRITICAL
+    100,    // MSG_PRIORITY_CONTROL
+    75,     // MSG_PRIORITY_NORMAL
+    50      // MSG_PRIORITY_BACKGROUND
+};
+
+#if defined(ARDUINO) && defined(__IMXRT1062__)
+// One TX channel per hardware port; the bridges live in DTCM, which DMA
+// reads without cache maintenance
+static DMAChannel serial1_tx_dma;
+static DMAChannel serial2_tx_dma;
+
+// The core's 64-byte RX buffers fill in 0.3 ms at 2 Mbaud; these hold a
+// few loop passes of a tuning burst until the bridge reads them in bulk
+static uint8_t serial1_rx_memory[1024];
+static uint8_t serial2_rx_memory[1024];
+#endif
+
 // =============================================================================
 // SERIAL BRIDGE IMPLEMENTATION
 // =============================================================================
@@ -23,17 +54,32 @@ static ExternalSerial* g_serial_instance = nullptr;
 SerialBridge::SerialBridge() : 
     serial_port(nullptr),
     enabled(false),
-    rx_head(0),
-    rx_tail(0),
-    bytes_received(0),
-    parsing_message(false),
+    rx_len(0),
     messages_sent(0),
     messages_received(0),
     parse_errors(0),
     buffer_overflows(0),
+    crc_errors(0),
+    frames_sent(0),
+    tx_head(0),
+    tx_tail(0),
+    tx_inflight(0),
+    tx_peak(0),
+    tx_overflows(0),
+    tx_dma(nullptr),
+    link_version(SERIAL_LINK_VERSION_LEGACY),
+    link_mtu(0),
+    link_tx_len(0),
+    link_tx_opened_us(0),
+    link_tx_seq(0),
+    link_rx_discarding(false),
     channel_id(0)
 {
-    config = {false, 115200, true, true};
+    memset(tx_drops, 0, sizeof(tx_drops));
+    filter_clear();
+    telemetry_clear();
+    telemetry_ticks = 0;
+    config = {false, 115200, true, true, 0, 0};
     memset(rx_buffer, 0, RX_BUFFER_SIZE);
     current_message = {};
 }
@@ -76,6 +122,13 @@ bool SerialBridge::init(void* port, const serial_port_config_t& port_config) {
         if (serial_port != &Serial) {
             Serial.println("SerialBridge::init() - Calling HardwareSerial::begin()...");
             static_cast<HardwareSerial*>(serial_port)->begin(config.baud_rate);
+            #if defined(__IMXRT1062__) && (defined(ARDUINO_TEENSY41) || defined(ARDUINO_TEENSY40))
+            if (serial_port == &Serial1) {
+                Serial1.addMemoryForRead(serial1_rx_memory, sizeof(serial1_rx_memory));
+            } else if (serial_port == &Serial2) {
+                Serial2.addMemoryForRead(serial2_rx_memory, sizeof(serial2_rx_memory));
+            }
+            #endif
             Serial.println("SerialBridge::init() - HardwareSerial::begin() completed");
         } else {
             Serial.println("SerialBridge::init() - Skipping begin() for USB Serial");
@@ -87,12 +140,28 @@ bool SerialBridge::init(void* port, const serial_port_config_t& port_config) {
         #endif
         
         // Reset state
-        rx_head = 0;
-        rx_tail = 0;
-        bytes_received = 0;
-        parsing_message = false;
+        rx_len = 0;
         reset_statistics();
         
+        // Anything still queued or in flight belongs to the old settings
+        #if defined(ARDUINO) && defined(__IMXRT1062__)
+        if (tx_dma != nullptr) {
+            tx_dma->disable();
+            tx_dma->clearComplete();
+        }
+        #endif
+        tx_head = 0;
+        tx_tail = 0;
+        tx_inflight = 0;
+        setup_tx_dma();
+        
+        // Every (re)start is legacy until the host says otherwise
+        link_version = SERIAL_LINK_VERSION_LEGACY;
+        link_mtu = 0;
+        link_tx_len = 0;
+        link_rx_discarding = false;
+        telemetry_clear();
+        
         #ifdef ARDUINO
         Serial.print("SerialBridge: Initialized port at ");
         Serial.print(config.baud_rate);
@@ -113,7 +182,25 @@ void SerialBridge::shutdown() {
 }
 
 void SerialBridge::update() {
-    if (!enabled || !config.rx_enabled) {
+    if (!enabled) {
+        return;
+    }
+    
+    if (telemetry_active && (uint32_t)(micros() - telemetry_last_tick_us) >= telemetry_period_us) {
+        telemetry_last_tick_us = micros();
+        send_telemetry_tick();
+    }
+    
+    // Deadline flush of the open v2 frame
+    if (link_tx_len > 0 && (uint32_t)(micros() - link_tx_opened_us) >= config.link_flush_us) {
+        flush_link_frame();
+    }
+    drain_tx_ring();
+    
+    // Requests the ECU never answered; stops at the first still in time
+    request_tracker.cleanup_timeouts();
+    
+    if (!config.rx_enabled) {
         return;
     }
     
@@ -138,8 +225,57 @@ void SerialBridge::send_message(const CANMessage& msg) {
         return;
     }
     
-    send_message_bytes(msg);
+    // Telemetry channels travel in the next tick's block instead
+    if (telemetry_active && telemetry_absorb(msg)) {
+        return;
+    }
+    
+    // Drop policy: each priority may fill the ring only so far
+    message_priority_t priority = g_message_bus.getMessagePriority(msg.id);
+    uint16_t length = message_tx_length();
+    if (!tx_admit(priority, length)) {
+        tx_drops[priority]++;
+        return;
+    }
+    
+    if (link_version == SERIAL_LINK_VERSION_FRAMED) {
+        append_link_record(msg);
+    } else {
+        send_message_bytes(msg);
+    }
     messages_sent++;
+    drain_tx_ring();
+}
+
+bool SerialBridge::has_tx_room(uint32_t msg_id) const {
+    if (!enabled || !config.tx_enabled || serial_port == nullptr) {
+        return true;    // send_message() ignores it anyway
+    }
+    return tx_admit(g_message_bus.getMessagePriority(msg_id), message_tx_length());
+}
+
+uint16_t SerialBridge::message_tx_length() const {
+    return (link_version == SERIAL_LINK_VERSION_FRAMED)
+        ? SERIAL_LINK_RECORD_HEADER + 8 + 1
+        : 2 + sizeof(CANFrame);
+}
+
+bool SerialBridge::tx_admit(message_priority_t priority, uint16_t length) const {
+    // The open v2 frame lands in the ring later; count it as already there
+    uint32_t queued = tx_head - tx_tail;
+    if (link_tx_len > 0) {
+        queued += link_tx_len + 2 + link_tx_len / 254 + 2;
+    }
+    uint32_t limit = (uint32_t)TX_RING_SIZE * TX_FILL_LIMIT_PERCENT[priority] / 100;
+    return queued + length <= limit;
+}
+
+uint32_t SerialBridge::get_tx_drops_total() const {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < MSG_PRIORITY_COUNT; i++) {
+        total += tx_drops[i];
+    }
+    return total;
 }
 
 void SerialBridge::reset_statistics() {
@@ -147,222 +283,469 @@ void SerialBridge::reset_statistics() {
     messages_received = 0;
     parse_errors = 0;
     buffer_overflows = 0;
+    crc_errors = 0;
+    frames_sent = 0;
+    memset(tx_drops, 0, sizeof(tx_drops));
+    tx_overflows = 0;
+    tx_peak = 0;
+    filtered_messages = 0;
+    rate_limited_messages = 0;
+    telemetry_ticks = 0;
 }
 
-void SerialBridge::process_incoming_bytes() {
+// Hash into the slot table; linear probing
+static_assert(SERIAL_FILTER_SLOTS == 64, "filter_slot() takes 6 hash bits");
+static inline uint8_t filter_slot(uint32_t msg_id) {
+    return (uint8_t)fib_hash(msg_id, 6);
+}
+
+SerialBridge::FilterEntry* SerialBridge::filter_find(uint32_t msg_id) {
+    uint8_t slot = filter_slot(msg_id);
+    for (uint8_t probe = 0; probe < SERIAL_FILTER_SLOTS; probe++) {
+        FilterEntry* entry = &filter_table[(slot + probe) & (SERIAL_FILTER_SLOTS - 1)];
+        if (entry->msg_id == msg_id) {
+            return entry;
+        }
+        if (entry->msg_id == SERIAL_FILTER_EMPTY) {
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+bool SerialBridge::filter_add_id(uint32_t msg_id, uint16_t max_rate_hz) {
+    if (msg_id == SERIAL_FILTER_EMPTY) {
+        return false;
+    }
+    FilterEntry* entry = filter_find(msg_id);
+    if (entry == nullptr) {
+        if (filter_ids >= SERIAL_FILTER_MAX_IDS) {
+            return false;
+        }
+        uint8_t slot = filter_slot(msg_id);
+        while (filter_table[slot].msg_id != SERIAL_FILTER_EMPTY) {
+            slot = (slot + 1) & (SERIAL_FILTER_SLOTS - 1);
+        }
+        entry = &filter_table[slot];
+        entry->msg_id = msg_id;
+        filter_ids++;
+    }
+    entry->min_interval_us = max_rate_hz ? 1000000UL / max_rate_hz : 0;
+    entry->sent = false;
+    return true;
+}
 
+bool SerialBridge::filter_add_group(uint32_t ecu_base, uint32_t subsystem) {
+    if ((ecu_base & ~ECU_BASE_MASK) != 0 || (subsystem & ~SUBSYSTEM_MASK) != 0) {
+        return false;
+    }
+    uint16_t group = (uint16_t)((ecu_base | subsystem) >> 20);
+    uint32_t bit = 1UL << (group & 31);
+    if (!(filter_group_bits[group >> 5] & bit)) {
+        filter_group_bits[group >> 5] |= bit;
+        filter_groups++;
+    }
+    return true;
+}
+
+void SerialBridge::filter_clear() {
+    for (uint8_t i = 0; i < SERIAL_FILTER_SLOTS; i++) {
+        filter_table[i].msg_id = SERIAL_FILTER_EMPTY;
+    }
+    memset(filter_group_bits, 0, sizeof(filter_group_bits));
+    filter_ids = 0;
+    filter_groups = 0;
+}
+
+bool SerialBridge::wants_message(uint32_t msg_id) {
+    if (!filter_active()) {
+        return true;
+    }
     
-    if (!serial_port) return;
+    uint16_t group = (uint16_t)(msg_id >> 20);
+    if (filter_group_bits[group >> 5] & (1UL << (group & 31))) {
+        return true;
+    }
     
-    #ifdef ARDUINO
-    // Debug: Show bytes available
-    static uint32_t last_bytes_debug = 0;
-    uint32_t now = millis();
-    Stream* stream = static_cast<Stream*>(serial_port);
-    int available = stream->available();
-    
-    // Only show debug when there are actual bytes available
-    if (available > 0) {
-        Serial.print("!!! SerialBridge: process_incoming_bytes called with ");
-        Serial.print(available);
-        Serial.print(" bytes available - instance at ");
-        Serial.print((uintptr_t)this, HEX);
-        Serial.print(", serial_port pointer: ");
-        Serial.print((uintptr_t)serial_port, HEX);
-        Serial.print(", enabled: ");
-        Serial.print(enabled ? "true" : "false");
-        Serial.print(", config.baud_rate: ");
-        Serial.println(config.baud_rate);
-        Serial.flush();
+    FilterEntry* entry = filter_find(msg_id);
+    if (entry == nullptr) {
+        filtered_messages++;
+        return false;
     }
+    if (entry->min_interval_us > 0) {
+        uint32_t now = micros();
+        if (entry->sent && (uint32_t)(now - entry->last_sent_us) < entry->min_interval_us) {
+            rate_limited_messages++;
+            return false;
+        }
+        entry->last_sent_us = now;
+        entry->sent = true;
+    }
+    return true;
+}
+
+// =============================================================================
+// TELEMETRY MODE
+// =============================================================================
+
+static_assert(SERIAL_TELEMETRY_SLOTS == 64, "telemetry_slot() takes 6 hash bits");
+static inline uint8_t telemetry_slot(uint32_t msg_id) {
+    return (uint8_t)fib_hash(msg_id, 6);
+}
+
+// Quantised values stay within ±2^30 so any delta fits an int32
+#define TELEMETRY_Q_LIMIT       1073741823.0f
+
+static uint8_t zigzag_varint(int32_t value, uint8_t* out) {
+    uint32_t zz = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    uint8_t n = 0;
+    while (zz >= 0x80) {
+        out[n++] = (uint8_t)(zz | 0x80);
+        zz >>= 7;
+    }
+    out[n++] = (uint8_t)zz;
+    return n;
+}
+
+void SerialBridge::telemetry_clear() {
+    memset(telemetry_slots, 0, sizeof(telemetry_slots));
+    telemetry_channel_count = 0;
+    telemetry_active = false;
+    telemetry_keyframe_due = false;
+    telemetry_period_us = 0;
+    telemetry_last_tick_us = 0;
+    telemetry_keyframe_interval = 0;
+    telemetry_keyframe_countdown = 0;
+    telemetry_tick = 0;
+}
+
+int16_t SerialBridge::telemetry_find(uint32_t msg_id) const {
+    uint8_t slot = telemetry_slot(msg_id);
+    for (uint8_t probe = 0; probe < SERIAL_TELEMETRY_SLOTS; probe++) {
+        uint8_t entry = telemetry_slots[(slot + probe) & (SERIAL_TELEMETRY_SLOTS - 1)];
+        if (entry == 0) {
+            return -1;
+        }
+        if (telemetry_channels[entry - 1].msg_id == msg_id) {
+            return entry - 1;
+        }
+    }
+    return -1;
+}
+
+bool SerialBridge::telemetry_absorb(const CANMessage& msg) {
+    int16_t index = telemetry_find(msg.id);
+    if (index < 0 || msg.len != sizeof(float)) {
+        return false;
+    }
+    TelemetryChannel& channel = telemetry_channels[index];
+    float value;
+    memcpy(&value, msg.buf, sizeof(value));
+    float scaled = value * channel.scale;
+    if (!(scaled > -TELEMETRY_Q_LIMIT)) scaled = -TELEMETRY_Q_LIMIT;    // Also catches NaN
+    if (scaled > TELEMETRY_Q_LIMIT) scaled = TELEMETRY_Q_LIMIT;
+    channel.value_q = (int32_t)lroundf(scaled);
+    channel.has_value = true;
+    return true;
+}
+
+void SerialBridge::handle_telemetry_config() {
+    serial_telemetry_config_msg_t request = {};
+    memcpy(&request, current_message.buf, current_message.len < sizeof(request) ? current_message.len : sizeof(request));
+    uint32_t msg_id = request.msg_id;
+    
+    serial_telemetry_ack_msg_t ack = {};
+    ack.op = request.op;
+    ack.index = request.index;
+    ack.status = TELEMETRY_STATUS_OK;
     
-    if (available > 0 && (now - last_bytes_debug >= 1000)) {  // Every 1 second when data available
-        Serial.print("SerialBridge: ");
-        Serial.print(available);
-        Serial.println(" bytes available for reading");
-        last_bytes_debug = now;
+    if (link_version != SERIAL_LINK_VERSION_FRAMED) {
+        ack.status = TELEMETRY_STATUS_NOT_FRAMED;
+    } else {
+        switch (request.op) {
+            case TELEMETRY_OP_CLEAR:
+                telemetry_clear();
+                break;
+                
+            case TELEMETRY_OP_ADD: {
+                // Indexes fill from 0 up; re-adding an index replaces its channel
+                int16_t existing = telemetry_find(msg_id);
+                if (request.index >= SERIAL_TELEMETRY_MAX_CHANNELS || request.index > telemetry_channel_count) {
+                    ack.status = TELEMETRY_STATUS_BAD_INDEX;
+                } else if (request.step_exp < -6 || request.step_exp > 6 ||
+                           (existing >= 0 && existing != request.index)) {
+                    ack.status = TELEMETRY_STATUS_INVALID;
+                } else {
+                    TelemetryChannel& channel = telemetry_channels[request.index];
+                    channel.msg_id = msg_id;
+                    channel.scale = powf(10.0f, -(float)request.step_exp);
+                    channel.value_q = 0;
+                    channel.sent_q = 0;
+                    channel.has_value = false;
+                    if (request.index == telemetry_channel_count) {
+                        telemetry_channel_count++;
+                    }
+                    // Config time only: rebuild the whole ID -> index map
+                    memset(telemetry_slots, 0, sizeof(telemetry_slots));
+                    for (uint8_t i = 0; i < telemetry_channel_count; i++) {
+                        uint8_t slot = telemetry_slot(telemetry_channels[i].msg_id);
+                        while (telemetry_slots[slot] != 0) {
+                            slot = (slot + 1) & (SERIAL_TELEMETRY_SLOTS - 1);
+                        }
+                        telemetry_slots[slot] = i + 1;
+                    }
+                    telemetry_keyframe_due = true;
+                }
+                break;
+            }
+                
+            case TELEMETRY_OP_START:
+                if (telemetry_channel_count == 0 || msg_id == 0 || msg_id > 1000) {
+                    ack.status = TELEMETRY_STATUS_INVALID;
+                    break;
+                }
+                telemetry_period_us = 1000000UL / msg_id;
+                telemetry_keyframe_interval = request.index ? request.index : 50;
+                telemetry_keyframe_countdown = 0;
+                telemetry_keyframe_due = true;
+                telemetry_last_tick_us = micros();
+                telemetry_active = true;
+                break;
+                
+            case TELEMETRY_OP_STOP:
+                telemetry_active = false;
+                break;
+                
+            case TELEMETRY_OP_KEYFRAME:
+                telemetry_keyframe_due = true;
+                break;
+                
+            default:
+                ack.status = TELEMETRY_STATUS_INVALID;
+                break;
+        }
     }
-    #endif
     
-    // Read available bytes into buffer
-    // In test environment, this will use MockSerial methods
-    // In Arduino environment, this will use real Serial methods
-    #ifdef TESTING
-    MockSerial* mock_serial = static_cast<MockSerial*>(serial_port);
-    while (mock_serial->available() && get_buffer_available_space() > 0) {
-        uint8_t byte = mock_serial->read();
-        add_byte_to_buffer(byte);
+    if (config.tx_enabled) {
+        send_link_control(MSG_SERIAL_TELEMETRY_ACK, &ack, sizeof(ack));
+    }
+}
+
+void SerialBridge::send_telemetry_tick() {
+    // Countdown holds the ticks left until the next scheduled keyframe
+    bool keyframe = telemetry_keyframe_due || --telemetry_keyframe_countdown == 0;
+    if (keyframe) {
+        telemetry_keyframe_countdown = telemetry_keyframe_interval;
     }
+    telemetry_keyframe_due = false;
+    
+    // Largest block that still fits one frame next to its record header
+    uint16_t capacity = link_mtu - 1 - 2 - SERIAL_LINK_RECORD_HEADER - 1;
+    if (capacity > 255) {
+        capacity = 255;
+    }
+    
+    uint8_t block[255];
+    block[0] = keyframe ? SERIAL_TELEMETRY_KEYFRAME : SERIAL_TELEMETRY_DELTA;
+    block[1] = telemetry_tick;
+    uint16_t length = 2;
+    for (uint8_t i = 0; i < telemetry_channel_count; i++) {
+        TelemetryChannel& channel = telemetry_channels[i];
+        if (!channel.has_value) {
+            continue;
+        }
+        int32_t value = keyframe ? channel.value_q : channel.value_q - channel.sent_q;
+        if (!keyframe && value == 0) {
+            continue;
+        }
+        uint8_t entry[6];
+        entry[0] = i;
+        uint8_t entry_length = 1 + zigzag_varint(value, &entry[1]);
+        if (length + entry_length > capacity) {
+            append_link_block(MSG_SERIAL_TELEMETRY_FRAME, block, (uint8_t)length);
+            length = 2;
+        }
+        memcpy(&block[length], entry, entry_length);
+        length += entry_length;
+        channel.sent_q = channel.value_q;
+    }
+    
+    // Nothing moved: no block at all (the host keeps its values)
+    if (length > 2 || keyframe) {
+        append_link_block(MSG_SERIAL_TELEMETRY_FRAME, block, (uint8_t)length);
+        flush_link_frame();
+    }
+    telemetry_tick++;
+    telemetry_ticks++;
+}
+
+void SerialBridge::process_incoming_bytes() {
+    if (!serial_port) return;
+    
+    #ifdef TESTING
+    MockSerial* port = static_cast<MockSerial*>(serial_port);
     #else
-    // Cast to Stream* for Arduino environment
-    while (stream->available() && get_buffer_available_space() > 0) {
-        uint8_t byte = stream->read();
-        add_byte_to_buffer(byte);
+    Stream* port = static_cast<Stream*>(serial_port);
+    #endif
+    
+    // Drain the port in chunks and parse whole frames out of each chunk;
+    // a partial frame stays at the front of rx_buffer for the next chunk
+    while (true) {
+        int available = port->available();
+        if (available <= 0) {
+            break;
+        }
+        uint16_t chunk = RX_BUFFER_SIZE - rx_len;
+        if ((uint32_t)available < chunk) {
+            chunk = (uint16_t)available;
+        }
+        rx_len += port->readBytes((char*)&rx_buffer[rx_len], chunk);
         
         #ifdef ARDUINO
-        static uint32_t last_buffer_debug = 0;
-        uint32_t buffer_now = millis();
-        if (buffer_now - last_buffer_debug >= 1000) {  // Every 1 second
-            Serial.print("SerialBridge: Added byte to buffer - buffer space: ");
-            Serial.println(get_buffer_available_space());
-            last_buffer_debug = buffer_now;
+        static uint32_t last_bytes_debug = 0;
+        uint32_t now = millis();
+        if (now - last_bytes_debug >= 1000) {  // Every 1 second when data available
+            Serial.print("SerialBridge: Read ");
+            Serial.print(chunk);
+            Serial.println(" bytes");
+            last_bytes_debug = now;
         }
         #endif
         
-        #ifdef ARDUINO
-        // Debug: Show bytes being received
-        static uint32_t last_byte_debug = 0;
-        uint32_t byte_now = millis();
-        if (byte_now - last_byte_debug >= 2000) {  // Every 2 seconds
-            Serial.print("SerialBridge: Received byte 0x");
-            Serial.print(byte, HEX);
-            Serial.print(", buffer bytes: ");
-            Serial.println(bytes_received);
-            last_byte_debug = byte_now;
+        // Keep going while a framing switch leaves bytes for the other parser
+        uint16_t consumed;
+        do {
+            consumed = parse_rx_span(rx_buffer, rx_len);
+            rx_len -= consumed;
+            memmove(rx_buffer, &rx_buffer[consumed], rx_len);
+        } while (consumed > 0 && rx_len > 0);
+        
+        if (rx_len == RX_BUFFER_SIZE) {
+            // Neither parser can hold this much partial frame - start over
+            buffer_overflows++;
+            rx_len = 0;
         }
-        #endif
     }
-    #endif
-    
-    // Process buffered data
-    uint8_t byte;
-    
-    #ifdef ARDUINO
-    uint16_t buffer_data = (rx_head - rx_tail + RX_BUFFER_SIZE) % RX_BUFFER_SIZE;
-    // Only show debug when there are actual bytes in buffer
-    if (buffer_data > 0) {
-        Serial.print("SerialBridge: About to process buffered data - buffer has ");
-        Serial.print(buffer_data);
-        Serial.println(" bytes");
+}
+
+uint16_t SerialBridge::parse_rx_span(uint8_t* data, uint16_t length) {
+    if (link_version != SERIAL_LINK_VERSION_FRAMED) {
+        return parse_legacy_span(data, length);
     }
-    #endif
     
-    while (get_byte_from_buffer(&byte)) {
-        #ifdef ARDUINO
-        Serial.println("SerialBridge: Processing byte from buffer");
-        #endif
-        #ifdef ARDUINO
-        static uint32_t last_byte_debug = 0;
-        uint32_t byte_now = millis();
-        if (byte_now - last_byte_debug >= 1000) {  // Every 1 second
-            Serial.print("SerialBridge: Processing byte from buffer - bytes_received=");
-            Serial.println(bytes_received);
-            last_byte_debug = byte_now;
+    // A restarted host says hello in the legacy format; whatever came
+    // before it is from the old session
+    int32_t hello = find_legacy_hello(data, length);
+    if (hello < 0) {
+        return parse_link_span(data, length);
+    }
+    uint16_t used = parse_link_span(data, (uint16_t)hello);
+    if ((uint16_t)(length - hello) < 2 + sizeof(CANFrame)) {
+        // Not all there yet (or just an 0xFF inside a v2 frame)
+        return used;
+    }
+    load_legacy_frame(&data[hello + 2]);
+    handle_link_hello();
+    link_rx_discarding = false;
+    return (uint16_t)(hello + 2 + sizeof(CANFrame));
+}
+
+// The wire carries only the frame; the message is stamped on arrival
+void SerialBridge::load_legacy_frame(const uint8_t* frame) {
+    CANFrame& received = current_message;
+    memcpy(&received, frame, sizeof(CANFrame));
+    current_message.timestamp_us = ecu_time_us();
+}
+
+// Whole 0xFF 0xFF frames in the span; returns the bytes used up. A frame
+// cut off at the end of the span is left for the next call.
+uint16_t SerialBridge::parse_legacy_span(const uint8_t* data, uint16_t length) {
+    const uint16_t frame_size = 2 + sizeof(CANFrame);
+    uint16_t pos = 0;
+    while (pos < length) {
+        const uint8_t* prefix = (const uint8_t*)memchr(&data[pos], 0xFF, length - pos);
+        if (prefix == nullptr) {
+            return length;      // No prefix anywhere - text or noise
         }
-        #endif
-        // Handle 0xFF 0xFF prefix for incoming messages
-        if (bytes_received == 0) {
-            // Starting a new message - look for prefix
-            if (byte == 0xFF) {
-                // First 0xFF found, wait for second
-                bytes_received = 1;
-                prefix_buffer[0] = byte;
-                continue;
-            } else {
-                // Not a prefix byte, skip this byte (could be text debug output)
-                continue;
-            }
-        } else if (bytes_received == 1) {
-            // Second byte of potential prefix
-            if (byte == 0xFF) {
-                // Prefix found! Clear message buffer and start collecting CAN message
-                memset(&current_message, 0, sizeof(CANMessage));
-                bytes_received = 2; // Start collecting CAN message data
-                #ifdef ARDUINO
-                Serial.println("SerialBridge: Found 0xFF 0xFF prefix, starting CAN message collection");
-                #endif
-                continue;
-            } else {
-                // Not a prefix, reset and try again
-                bytes_received = 0;
-                continue;
-            }
+        uint16_t start = (uint16_t)(prefix - data);
+        if (start + 1 >= length) {
+            return start;       // Lone 0xFF at the end, may be half a prefix
+        }
+        if (data[start + 1] != 0xFF) {
+            pos = start + 1;
+            continue;
+        }
+        if (length - start < frame_size) {
+            return start;
         }
         
-        // Collect CAN message data (bytes_received >= 2)
-        if (bytes_received < sizeof(CANMessage) + 2) { // +2 for prefix
-            ((uint8_t*)&current_message)[bytes_received - 2] = byte; // -2 to account for prefix
-            bytes_received++;
-            
-            #ifdef ARDUINO
-            if (bytes_received == sizeof(CANMessage)) {
-                Serial.println("SerialBridge: Reached sizeof(CANMessage) bytes");
-            }
-            #endif
-            
-            // Check if we have a complete message (prefix + CAN message)
-            #ifdef ARDUINO
-            if (bytes_received >= sizeof(CANMessage) + 2) {
-                Serial.print("SerialBridge: Complete message check - bytes_received=");
-                Serial.print(bytes_received);
-                Serial.print(", sizeof(CANMessage)=");
-                Serial.println(sizeof(CANMessage));
+        load_legacy_frame(&data[start + 2]);
+        pos = start + frame_size;
+        if (handle_link_hello()) {
+            if (link_version == SERIAL_LINK_VERSION_FRAMED) {
+                return pos;     // The rest is v2
             }
-            #endif
-            
-            if (bytes_received >= sizeof(CANMessage) + 2) {
-                #ifdef ARDUINO
-                Serial.println("!!! COMPLETE MESSAGE RECEIVED - ENTERING PROCESSING");
-                Serial.print("SerialBridge: Complete message received, size=");
-                Serial.print(sizeof(CANMessage));
-                Serial.print(", CAN ID=0x");
-                Serial.println(current_message.id, HEX);
-                
-                // Debug: Show structure field offsets and sizes
-                Serial.print("SerialBridge: Structure analysis - ");
-                Serial.print("sizeof(CANMessage)=");
-                Serial.print(sizeof(CANMessage));
-                Serial.print(", id_offset=");
-                Serial.print((size_t)&current_message.id - (size_t)&current_message);
-                Serial.print(", timestamp_offset=");
-                Serial.print((size_t)&current_message.timestamp - (size_t)&current_message);
-                Serial.print(", len_offset=");
-                Serial.print((size_t)&current_message.len - (size_t)&current_message);
-                Serial.print(", buf_offset=");
-                Serial.println((size_t)&current_message.buf - (size_t)&current_message);
-                
-                // Debug: Show raw bytes received
-                Serial.print("SerialBridge: Raw bytes: ");
-                uint8_t* raw_bytes = (uint8_t*)&current_message;
-                for (int i = 0; i < sizeof(CANMessage) && i < 12; i++) {  // Show first 12 bytes
-                    Serial.print("0x");
-                    if (raw_bytes[i] < 16) Serial.print("0");
-                    Serial.print(raw_bytes[i], HEX);
-                    Serial.print(" ");
-                }
-                Serial.println();
-                
-                // Debug: Show individual fields
-                Serial.print("SerialBridge: Fields - ID=0x");
-                Serial.print(current_message.id, HEX);
-                Serial.print(", timestamp=");
-                Serial.print(current_message.timestamp);
-                Serial.print(", len=");
-                Serial.print(current_message.len);
-                Serial.print(", flags.extended=");
-                Serial.println(current_message.flags.extended ? "true" : "false");
-                #endif
-                
-                #ifdef ARDUINO
-                Serial.println("!!! CALLING process_complete_message()");
-                #endif
-                process_complete_message();
-                // Reset for next message
-                bytes_received = 0;
-                parsing_message = false;
-                // Clear any remaining buffer data to prevent mixing with next message
-                clear_receive_buffer();
+            continue;
+        }
+        process_complete_message();
+    }
+    return length;
+}
+
+// Whole 0x00-delimited v2 frames in the span, decoded in place
+uint16_t SerialBridge::parse_link_span(uint8_t* data, uint16_t length) {
+    uint16_t pos = 0;
+    while (pos < length) {
+        const uint8_t* delimiter = (const uint8_t*)memchr(&data[pos], 0x00, length - pos);
+        if (delimiter == nullptr) {
+            if (length - pos > SERIAL_LINK_MAX_ENCODED) {
+                // Longer than any frame can be - lost a delimiter; resync on the next one
+                handle_parse_error();
+                link_rx_discarding = true;
             }
-        } else {
-            // Overflow - start over
-            handle_parse_error();
-            bytes_received = 0;
-            parsing_message = false;
+            return link_rx_discarding ? length : pos;
+        }
+        uint16_t end = (uint16_t)(delimiter - data);
+        if (!link_rx_discarding && end > pos) {
+            process_link_frame(&data[pos], end - pos);
+        }
+        link_rx_discarding = false;
+        pos = end + 1;
+        if (link_version != SERIAL_LINK_VERSION_FRAMED) {
+            break;              // A v1 hello ended the framing
+        }
+    }
+    return pos;
+}
+
+int32_t SerialBridge::find_legacy_hello(const uint8_t* data, uint16_t length) {
+    uint8_t signature[6] = {0xFF, 0xFF};
+    uint32_t id = MSG_SERIAL_LINK_HELLO;
+    memcpy(&signature[2], &id, sizeof(id));
+    
+    uint16_t pos = 0;
+    while (pos + 1 < length) {
+        const uint8_t* prefix = (const uint8_t*)memchr(&data[pos], 0xFF, length - pos - 1);
+        if (prefix == nullptr) {
+            return -1;
         }
+        uint16_t start = (uint16_t)(prefix - data);
+        uint16_t remaining = (uint16_t)(length - start);
+        uint16_t compare = (remaining < sizeof(signature)) ? remaining : (uint16_t)sizeof(signature);
+        if (memcmp(&data[start], signature, compare) == 0) {
+            return start;       // Possibly cut off at the end; the caller waits for the rest
+        }
+        pos = start + 1;
     }
+    return -1;
 }
 
 void SerialBridge::process_complete_message() {
+    if (current_message.id == MSG_SERIAL_TELEMETRY_CONFIG) {
+        handle_telemetry_config();
+        return;
+    }
+    
     // Validate message
     if (current_message.len > 8) {
         handle_parse_error();
@@ -414,16 +797,18 @@ void SerialBridge::process_complete_message() {
         Serial.println(param->request_id);
         #endif
         
-        // Only add routing for read/write requests (not responses)
-        if (param->operation == PARAM_OP_READ_REQUEST || 
-            param->operation == PARAM_OP_WRITE_REQUEST) {
+        // Only add routing for requests (not responses); a batch is tracked
+        // once, on the frame that gets the response
+        if (is_parameter_request_operation(param->operation)) {
             
             // Add routing metadata
             param->source_channel = channel_id;
-            param->request_id = request_tracker.get_next_request_id();
-            
-            // Track this request
-            request_tracker.add_request(channel_id, current_message.id);
+            // Tracked requests are tagged with the ID their entry is filed under
+            if (is_tracked_parameter_operation(param->operation)) {
+                param->request_id = request_tracker.add_request(channel_id, current_message.id);
+            } else {
+                param->request_id = request_tracker.get_next_request_id();
+            }
             
             #ifdef ARDUINO
             Serial.print("SerialBridge: Added routing metadata - channel=");
@@ -499,83 +884,332 @@ void SerialBridge::send_message_bytes(const CANMessage& msg) {
     Serial.println(msg.len);
     #endif
     
-    // Send the binary message with prefix
-    #ifdef TESTING
-    MockSerial* mock_serial = static_cast<MockSerial*>(serial_port);
-    // Send 0xFF 0xFF prefix
-    mock_serial->write(0xFF);
-    mock_serial->write(0xFF);
-    // Send the CAN message
-    mock_serial->write((const uint8_t*)&msg, sizeof(CANMessage));
-    mock_serial->flush(); // Ensure immediate transmission
-    #else
-    // Cast to Stream* for Arduino environment
-    Stream* stream = static_cast<Stream*>(serial_port);
-    // Send 0xFF 0xFF prefix
-    stream->write(0xFF);
-    stream->write(0xFF);
-    // Send the CAN message
-    stream->write((const uint8_t*)&msg, sizeof(CANMessage));
-    stream->flush(); // Ensure immediate transmission
-    #endif
+    // Prefix and frame go into the ring together or not at all. The
+    // frame's 16-bit timestamp is all of the stamp this format carries.
+    const CANFrame& wire = msg;
+    uint8_t frame[2 + sizeof(CANFrame)];
+    frame[0] = 0xFF;
+    frame[1] = 0xFF;
+    memcpy(&frame[2], &wire, sizeof(CANFrame));
+    write_bytes(frame, sizeof(frame));
 }
 
-#ifdef TESTING
-std::vector<uint8_t> SerialBridge::get_written_data_for_testing() {
-    // Cast to MockSerial to access the test data
-    MockSerial* mock_serial = static_cast<MockSerial*>(serial_port);
-    if (mock_serial) {
-        return mock_serial->get_written_data();
+// Room for one record in the open frame (opening one if needed); the
+// caller fills it in and checks whether the frame is now full
+uint8_t* SerialBridge::reserve_link_record(uint16_t record_size) {
+    // Size flush: the record and the CRC must both fit
+    if (link_tx_len > 0 && link_tx_len + record_size + 2 > link_mtu) {
+        flush_link_frame();
     }
-    return std::vector<uint8_t>();
+    if (link_tx_len == 0) {
+        link_tx_frame[0] = link_tx_seq++;
+        link_tx_len = 1;
+        link_tx_opened_us = micros();
+    }
+    uint8_t* record = &link_tx_frame[link_tx_len];
+    link_tx_len += record_size;
+    return record;
 }
-#endif
 
-void SerialBridge::add_byte_to_buffer(uint8_t byte) {
-    uint16_t next_head = (rx_head + 1) % RX_BUFFER_SIZE;
-    if (next_head != rx_tail) { // Not full
-        rx_buffer[rx_head] = byte;
-        rx_head = next_head;
-        #ifdef ARDUINO
-        Serial.print("SerialBridge: add_byte_to_buffer - Added byte 0x");
-        Serial.print(byte, HEX);
-        Serial.print(" at rx_head=");
-        Serial.println(rx_head);
-        #endif
+void SerialBridge::append_link_record(const CANMessage& msg) {
+    uint8_t len = msg.len > 8 ? 8 : msg.len;
+    uint8_t* record = reserve_link_record(SERIAL_LINK_RECORD_HEADER + len);
+    uint32_t id = msg.id;
+    record[0] = (uint8_t)id;
+    record[1] = (uint8_t)(id >> 8);
+    record[2] = (uint8_t)(id >> 16);
+    record[3] = (uint8_t)(id >> 24);
+    record[4] = len | (msg.flags.extended ? SERIAL_LINK_CTL_EXTENDED : 0) | (msg.flags.remote ? SERIAL_LINK_CTL_REMOTE : 0);
+    uint32_t timestamp = msg.timestamp_us;
+    record[5] = (uint8_t)timestamp;
+    record[6] = (uint8_t)(timestamp >> 8);
+    record[7] = (uint8_t)(timestamp >> 16);
+    record[8] = (uint8_t)(timestamp >> 24);
+    memcpy(&record[SERIAL_LINK_RECORD_HEADER], msg.buf, len);
+    
+    // No room left for even an empty record - no point waiting
+    if (link_tx_len + SERIAL_LINK_RECORD_HEADER + 2 > link_mtu) {
+        flush_link_frame();
+    }
+}
+
+void SerialBridge::append_link_block(uint32_t msg_id, const uint8_t* data, uint8_t length) {
+    uint8_t* record = reserve_link_record(SERIAL_LINK_RECORD_HEADER + 1 + length);
+    uint32_t timestamp = ecu_time_us();
+    record[0] = (uint8_t)msg_id;
+    record[1] = (uint8_t)(msg_id >> 8);
+    record[2] = (uint8_t)(msg_id >> 16);
+    record[3] = (uint8_t)(msg_id >> 24);
+    record[4] = SERIAL_LINK_CTL_BLOCK | SERIAL_LINK_CTL_EXTENDED;
+    record[5] = (uint8_t)timestamp;
+    record[6] = (uint8_t)(timestamp >> 8);
+    record[7] = (uint8_t)(timestamp >> 16);
+    record[8] = (uint8_t)(timestamp >> 24);
+    record[SERIAL_LINK_RECORD_HEADER] = length;
+    memcpy(&record[SERIAL_LINK_RECORD_HEADER + 1], data, length);
+    
+    if (link_tx_len + SERIAL_LINK_RECORD_HEADER + 2 > link_mtu) {
+        flush_link_frame();
+    }
+}
+
+// Control replies go out at once, in whichever format the link is in
+void SerialBridge::send_link_control(uint32_t msg_id, const void* payload, uint8_t length) {
+    CANMessage msg;
+    memset(&msg, 0, sizeof(CANMessage));
+    msg.id = msg_id;
+    msg.len = length;
+    msg.flags.extended = true;
+    msg.timestamp_us = ecu_time_us();
+    msg.timestamp = (uint16_t)msg.timestamp_us;
+    memcpy(msg.buf, payload, length);
+    if (link_version == SERIAL_LINK_VERSION_FRAMED) {
+        append_link_record(msg);
+        flush_link_frame();
     } else {
-        buffer_overflows++;
-        #ifdef ARDUINO
-        Serial.println("SerialBridge: add_byte_to_buffer - Buffer overflow!");
-        #endif
+        send_message_bytes(msg);
+        drain_tx_ring();
     }
 }
 
-bool SerialBridge::get_byte_from_buffer(uint8_t* byte) {
-    if (rx_head == rx_tail) {
-        return false; // Empty
+void SerialBridge::flush_link_frame() {
+    if (link_tx_len == 0 || serial_port == nullptr) {
+        return;
+    }
+    
+    uint16_t crc = serial_link_crc16(link_tx_frame, link_tx_len);
+    link_tx_frame[link_tx_len] = (uint8_t)crc;
+    link_tx_frame[link_tx_len + 1] = (uint8_t)(crc >> 8);
+    
+    size_t encoded = serial_link_cobs_encode(link_tx_frame, link_tx_len + 2, link_encode_buffer);
+    link_encode_buffer[encoded++] = 0x00;
+    
+    if (write_bytes(link_encode_buffer, encoded)) {
+        frames_sent++;
     }
-    *byte = rx_buffer[rx_tail];
-    rx_tail = (rx_tail + 1) % RX_BUFFER_SIZE;
+    link_tx_len = 0;
+    drain_tx_ring();
+}
+
+void SerialBridge::process_link_frame(uint8_t* frame, uint16_t encoded_length) {
+    size_t length = serial_link_cobs_decode(frame, encoded_length);
+    if (length < 3 || length > SERIAL_LINK_MAX_MTU) {
+        crc_errors++;
+        return;
+    }
+    
+    size_t end = length - 2;
+    uint16_t crc = (uint16_t)frame[end] | ((uint16_t)frame[end + 1] << 8);
+    if (crc != serial_link_crc16(frame, end)) {
+        crc_errors++;
+        return;
+    }
+    
+    // Sequence byte first; gaps are the host's to count
+    size_t pos = 1;
+    while (pos < end) {
+        if (end - pos < SERIAL_LINK_RECORD_HEADER) {
+            handle_parse_error();
+            return;
+        }
+        const uint8_t* record = &frame[pos];
+        if (record[4] & SERIAL_LINK_CTL_BLOCK) {
+            // ECU -> host only; step over it
+            if (end - pos < (size_t)SERIAL_LINK_RECORD_HEADER + 1 ||
+                end - pos < (size_t)SERIAL_LINK_RECORD_HEADER + 1 + record[SERIAL_LINK_RECORD_HEADER]) {
+                handle_parse_error();
+                return;
+            }
+            pos += SERIAL_LINK_RECORD_HEADER + 1 + record[SERIAL_LINK_RECORD_HEADER];
+            continue;
+        }
+        uint8_t len = record[4] & SERIAL_LINK_CTL_LEN_MASK;
+        if (len > 8 || end - pos < (size_t)SERIAL_LINK_RECORD_HEADER + len) {
+            handle_parse_error();
+            return;
+        }
+        
+        memset(&current_message, 0, sizeof(CANMessage));
+        current_message.id = (uint32_t)record[0] | ((uint32_t)record[1] << 8) |
+                             ((uint32_t)record[2] << 16) | ((uint32_t)record[3] << 24);
+        current_message.len = len;
+        current_message.timestamp_us = (uint32_t)record[5] | ((uint32_t)record[6] << 8) |
+                                       ((uint32_t)record[7] << 16) | ((uint32_t)record[8] << 24);
+        current_message.timestamp = (uint16_t)current_message.timestamp_us;
+        current_message.flags.extended = (record[4] & SERIAL_LINK_CTL_EXTENDED) != 0;
+        current_message.flags.remote = (record[4] & SERIAL_LINK_CTL_REMOTE) != 0;
+        memcpy(current_message.buf, &record[SERIAL_LINK_RECORD_HEADER], len);
+        pos += SERIAL_LINK_RECORD_HEADER + len;
+        
+        // A hello changes the framing, so it ends the frame
+        if (handle_link_hello()) {
+            return;
+        }
+        process_complete_message();
+    }
+}
+
+bool SerialBridge::handle_link_hello() {
+    if (current_message.id != MSG_SERIAL_LINK_HELLO) {
+        return false;
+    }
+    if (current_message.len < 3 || !config.tx_enabled) {
+        handle_parse_error();
+        return true;
+    }
+    
+    serial_link_msg_t request = {};
+    memcpy(&request, current_message.buf, current_message.len < sizeof(request) ? current_message.len : sizeof(request));
+    uint16_t host_mtu = request.mtu;
+    
+    serial_link_msg_t reply = {};
+    reply.version = SERIAL_LINK_VERSION_LEGACY;
+    if (request.version >= SERIAL_LINK_VERSION_FRAMED &&
+        config.link_mtu >= SERIAL_LINK_MIN_MTU && host_mtu >= SERIAL_LINK_MIN_MTU) {
+        uint16_t mtu = host_mtu < config.link_mtu ? host_mtu : config.link_mtu;
+        reply.version = SERIAL_LINK_VERSION_FRAMED;
+        reply.mtu = mtu < SERIAL_LINK_MAX_MTU ? mtu : SERIAL_LINK_MAX_MTU;
+    }
+    
+    // Queued messages and the ack go out in the format the host last asked for
+    send_link_control(MSG_SERIAL_LINK_ACK, &reply, sizeof(reply));
+    
+    link_version = reply.version;
+    link_mtu = reply.mtu;
+    link_tx_len = 0;
+    link_rx_discarding = false;
+    
+    // A new session starts with an empty channel table
+    telemetry_clear();
+    
     #ifdef ARDUINO
-    Serial.print("SerialBridge: get_byte_from_buffer - Got byte 0x");
-    Serial.print(*byte, HEX);
-    Serial.print(" from rx_tail=");
-    Serial.println(rx_tail);
+    Serial.print("SerialBridge: Link version ");
+    Serial.print(link_version);
+    Serial.print(", MTU ");
+    Serial.println(link_mtu);
     #endif
     return true;
 }
 
-void SerialBridge::clear_receive_buffer() {
-    rx_head = rx_tail; // Reset buffer pointers to clear all data
+bool SerialBridge::write_bytes(const uint8_t* data, size_t length) {
+    // Whole writes only - half a frame would desync the host
+    uint32_t queued = tx_head - tx_tail;
+    if (queued + length > TX_RING_SIZE) {
+        tx_overflows++;
+        return false;
+    }
+    
+    uint16_t start = tx_head % TX_RING_SIZE;
+    size_t first = TX_RING_SIZE - start;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(&tx_ring[start], data, first);
+    memcpy(tx_ring, data + first, length - first);
+    tx_head += length;
+    
+    if (queued + length > tx_peak) {
+        tx_peak = (uint16_t)(queued + length);
+    }
+    return true;
 }
 
-uint16_t SerialBridge::get_buffer_available_space() const {
-    if (rx_head >= rx_tail) {
-        return RX_BUFFER_SIZE - (rx_head - rx_tail) - 1;
-    } else {
-        return rx_tail - rx_head - 1;
+void SerialBridge::drain_tx_ring() {
+    if (serial_port == nullptr) {
+        return;
+    }
+    
+    #if defined(ARDUINO) && defined(__IMXRT1062__)
+    if (tx_dma != nullptr) {
+        // One contiguous span in flight at a time; its bytes stay queued
+        // until the channel reports done
+        if (tx_inflight > 0) {
+            if (!tx_dma->complete()) {
+                return;
+            }
+            tx_dma->clearComplete();
+            tx_tail += tx_inflight;
+            tx_inflight = 0;
+        }
+        uint32_t queued = tx_head - tx_tail;
+        if (queued == 0) {
+            return;
+        }
+        uint16_t start = tx_tail % TX_RING_SIZE;
+        uint16_t span = (queued < (uint32_t)(TX_RING_SIZE - start)) ? (uint16_t)queued : (uint16_t)(TX_RING_SIZE - start);
+        tx_dma->sourceBuffer(&tx_ring[start], span);
+        tx_dma->enable();
+        tx_inflight = span;
+        return;
+    }
+    #endif
+    
+    // Only what the port takes without blocking; the rest waits for the next call
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        uint32_t queued = tx_head - tx_tail;
+        if (queued == 0) {
+            return;
+        }
+        #ifdef TESTING
+        MockSerial* port = static_cast<MockSerial*>(serial_port);
+        #else
+        Stream* port = static_cast<Stream*>(serial_port);
+        #endif
+        int room = port->availableForWrite();
+        if (room <= 0) {
+            return;
+        }
+        uint16_t start = tx_tail % TX_RING_SIZE;
+        uint32_t span = TX_RING_SIZE - start;
+        if (span > queued) span = queued;
+        if (span > (uint32_t)room) span = room;
+        port->write(&tx_ring[start], span);
+        tx_tail += span;
+    }
+}
+
+void SerialBridge::setup_tx_dma() {
+    tx_dma = nullptr;
+    #if defined(ARDUINO) && defined(__IMXRT1062__) && (defined(ARDUINO_TEENSY41) || defined(ARDUINO_TEENSY40))
+    // Serial1 is LPUART6 and Serial2 is LPUART4. With TDMAE set the LPUART
+    // requests a byte whenever its FIFO has room; the core driver's TX
+    // interrupt is only armed by its own write(), which these ports no
+    // longer call.
+    DMAChannel* dma = nullptr;
+    volatile uint32_t* data = nullptr;
+    uint8_t source = 0;
+    if (serial_port == &Serial1) {
+        dma = &serial1_tx_dma;
+        data = &LPUART6_DATA;
+        source = DMAMUX_SOURCE_LPUART6_TX;
+        LPUART6_BAUD |= LPUART_BAUD_TDMAE;
+    } else if (serial_port == &Serial2) {
+        dma = &serial2_tx_dma;
+        data = &LPUART4_DATA;
+        source = DMAMUX_SOURCE_LPUART4_TX;
+        LPUART4_BAUD |= LPUART_BAUD_TDMAE;
+    }
+    if (dma == nullptr) {
+        return;     // USB
+    }
+    dma->begin();
+    dma->destination(*(volatile uint8_t*)data);
+    dma->triggerAtHardwareEvent(source);
+    dma->disableOnCompletion();
+    tx_dma = dma;
+    #endif
+}
+
+#ifdef TESTING
+std::vector<uint8_t> SerialBridge::get_written_data_for_testing() {
+    // Cast to MockSerial to access the test data
+    MockSerial* mock_serial = static_cast<MockSerial*>(serial_port);
+    if (mock_serial) {
+        return mock_serial->get_written_data();
     }
+    return std::vector<uint8_t>();
 }
+#endif
 
 void SerialBridge::handle_parse_error() {
     parse_errors++;
@@ -745,7 +1379,8 @@ void ExternalSerial::on_message_bus_message(const CANMessage* msg) {
         
         // Only filter parameter responses (not broadcasts or errors)
         if (param->operation == PARAM_OP_READ_RESPONSE || 
-            param->operation == PARAM_OP_WRITE_ACK) {
+            param->operation == PARAM_OP_WRITE_ACK ||
+            param->operation == PARAM_OP_BATCH_COMPLETE) {
             
             // Route response only to the requesting channel
             if (param->source_channel == CHANNEL_SERIAL_USB && usb_bridge.is_enabled()) {
@@ -781,18 +1416,7 @@ void ExternalSerial::on_message_bus_message(const CANMessage* msg) {
     }
     
     // For non-parameter messages or parameter broadcasts, send to all enabled ports
-    if (usb_bridge.is_enabled()) {
-
-        usb_bridge.send_message(*msg);
-    }
-    
-    if (serial1_bridge.is_enabled()) {
-        serial1_bridge.send_message(*msg);
-    }
-    
-    if (serial2_bridge.is_enabled()) {
-        serial2_bridge.send_message(*msg);
-    }
+    broadcast_to_enabled_ports(*msg);
 }
 
 uint32_t ExternalSerial::get_total_messages_sent() const {
@@ -819,6 +1443,12 @@ uint32_t ExternalSerial::get_total_buffer_overflows() const {
            serial2_bridge.get_buffer_overflows();
 }
 
+uint32_t ExternalSerial::get_total_tx_drops() const {
+    return usb_bridge.get_tx_drops_total() + 
+           serial1_bridge.get_tx_drops_total() + 
+           serial2_bridge.get_tx_drops_total();
+}
+
 void ExternalSerial::reset_all_statistics() {
     usb_bridge.reset_statistics();
     serial1_bridge.reset_statistics();
@@ -854,7 +1484,8 @@ void ExternalSerial::on_selective_message(const CANMessage* msg) {
         // Route parameter responses to requesting channel only
         if (param->operation == PARAM_OP_READ_RESPONSE || 
             param->operation == PARAM_OP_WRITE_ACK ||
-            param->operation == PARAM_OP_ERROR) {
+            param->operation == PARAM_OP_ERROR ||
+            param->operation == PARAM_OP_BATCH_COMPLETE) {
             
             route_parameter_response(msg, param);
             return; // Don't broadcast parameter responses
@@ -865,6 +1496,15 @@ void ExternalSerial::on_selective_message(const CANMessage* msg) {
     broadcast_to_enabled_ports(*msg);
 }
 
+bool ExternalSerial::has_response_room(uint8_t channel, uint32_t msg_id) const {
+    switch (channel) {
+        case CHANNEL_SERIAL_USB: return usb_bridge.has_tx_room(msg_id);
+        case CHANNEL_SERIAL_1:   return serial1_bridge.has_tx_room(msg_id);
+        case CHANNEL_SERIAL_2:   return serial2_bridge.has_tx_room(msg_id);
+        default:                 return true;
+    }
+}
+
 // NEW: Route parameter responses to the correct requesting channel
 void ExternalSerial::route_parameter_response(const CANMessage* msg, parameter_msg_t* param) {
     // Strip routing metadata before sending to external tool
@@ -905,15 +1545,15 @@ void ExternalSerial::route_parameter_response(const CANMessage* msg, parameter_m
 
 // NEW: Broadcast message to enabled ports (selective broadcasting only)
 void ExternalSerial::broadcast_to_enabled_ports(const CANMessage& msg) {
-    if (usb_bridge.is_enabled()) {
+    if (usb_bridge.is_enabled() && usb_bridge.wants_message(msg.id)) {
         usb_bridge.send_message(msg);
     }
     
-    if (serial1_bridge.is_enabled()) {
+    if (serial1_bridge.is_enabled() && serial1_bridge.wants_message(msg.id)) {
         serial1_bridge.send_message(msg);
     }
     
-    if (serial2_bridge.is_enabled()) {
+    if (serial2_bridge.is_enabled() && serial2_bridge.wants_message(msg.id)) {
         serial2_bridge.send_message(msg);
     }
 }
\ No newline at end of file
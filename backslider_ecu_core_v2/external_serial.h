@@ -23,10 +23,89 @@
 //   │ (4 bytes)   │ (1 byte)    │ (0-8 bytes) │ (4 bytes)   │
 //   └─────────────┴─────────────┴─────────────┴─────────────┘
 //
+// LINK PROTOCOL v2:
+//
+//   The format above costs 2 + sizeof(CANFrame) bytes per message, has no
+//   integrity check and resyncs only by hunting for 0xFF 0xFF. A host that
+//   sends MSG_SERIAL_LINK_HELLO (version 2, its MTU) in the legacy format
+//   gets MSG_SERIAL_LINK_ACK back in the same format; from then on both
+//   directions use v2 frames:
+//
+//   ┌──────┬──────────┬─────┬──────────┬──────────┐   COBS encoded,
+//   │ Seq  │ Record   │ ... │ Record   │ CRC-16   │   0x00 delimited
+//   │ (1)  │          │     │          │ (2, LE)  │
+//   └──────┴──────────┴─────┴──────────┴──────────┘
+//
+//   Record: CAN ID (4, LE) │ ctl (1) │ timestamp (4, LE) │ data (0-8)
+//           ctl = len | 0x10 extended | 0x20 remote
+//           timestamp = the message's publish stamp, µs (ecu_time.h)
+//
+//   Outbound messages are packed into the open frame and the frame is
+//   written when the next record would overrun the MTU or link_flush_us
+//   after its first record, whichever comes first. A corrupt frame fails
+//   its CRC and is dropped whole; the next 0x00 is always a frame boundary.
+//   An 8-byte message takes ~17 bytes instead of 26, a float ~13.
+//
+//   The ACK carries the agreed version and MTU (min of both sides). An
+//   ACK with version 1 means the port stays legacy (link_mtu = 0 turns v2
+//   off). A hello with version 1 drops back to legacy; a hello is accepted
+//   in either format at any time, so a restarted host can renegotiate.
+//
+// TRANSMIT PATH:
+//
+//   Nothing on the send path waits for the wire. Every bridge owns a
+//   TX ring; send_message() copies the bytes in and returns. The ring
+//   drains from update() and straight after each enqueue:
+//
+//   Serial1/Serial2  LPUART TX DMA straight out of the ring (Teensy 4.x);
+//                    the core's TX interrupt stays idle for these ports
+//   USB              bytes the USB stack can take without waiting
+//                    (availableForWrite), so writes fill whole packets
+//
+//   A full ring drops instead of stalling. Each message bus priority may
+//   fill the ring only so far (TX_FILL_LIMIT_PERCENT), so background and
+//   debug traffic runs out of room before critical telemetry does. Drops
+//   are counted per priority.
+//
+// TELEMETRY MODE (v2 links only):
+//
+//   Most broadcast channels move slowly, yet each one costs a full record.
+//   A host can instead register up to SERIAL_TELEMETRY_MAX_CHANNELS float
+//   channels with MSG_SERIAL_TELEMETRY_CONFIG (one ADD per channel: 1-byte
+//   index, message ID, quantisation step 10^step_exp), then START a tick
+//   rate. Broadcasts of those IDs stop going out as records; each tick
+//   sends one block record (MSG_SERIAL_TELEMETRY_FRAME, ctl has
+//   SERIAL_LINK_CTL_BLOCK, a length byte follows the timestamp):
+//
+//   ┌──────┬──────┬───────┬──────────────┬───────┬──────────────┬─────┐
+//   │ Kind │ Tick │ Index │ zigzag varint│ Index │ zigzag varint│ ... │
+//   └──────┴──────┴───────┴──────────────┴───────┴──────────────┴─────┘
+//
+//   A delta block lists only channels whose quantised value moved, with
+//   the change since the last block; a keyframe lists every channel with
+//   its absolute quantised value. Keyframes go out every N ticks, on the
+//   first tick and on TELEMETRY_OP_KEYFRAME, so a host that sees a gap
+//   in the frame sequence resyncs within N ticks (or asks). A channel
+//   that barely moves costs 2 bytes per tick instead of ~13.
+//
+// PORT FILTERS:
+//
+//   By default every port gets every broadcast. Adding a filter entry to a
+//   bridge turns it into an allow list: exact IDs (each with an optional
+//   rate cap) and whole ECU/subsystem groups. Entries are compiled when
+//   added - IDs into an open-addressed hash, groups into a 4096-bit map
+//   indexed by the top 12 ID bits - so each broadcast costs one bit test
+//   and at most a short probe per port. Parameter responses and link
+//   control bypass the filters.
+//
+//   g_external_serial.get_serial1_bridge().filter_add_group(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS);
+//   g_external_serial.get_serial2_bridge().filter_add_id(MSG_ENGINE_RPM, 50);   // ≤ 50 Hz
+//
 // MESSAGE FLOW:
 //
 // 1. INBOUND (Serial → Message Bus):
-//    - Receive binary CAN message from serial port
+//    - Read everything the port holds in chunks (readBytes) and parse
+//      every complete frame in each chunk; a partial frame waits
 //    - Validate message format and extended CAN ID
 //    - Filter for external ECU messages (ECU base > 0)
 //    - Publish to internal message bus
@@ -67,6 +146,8 @@
 #define EXTERNAL_SERIAL_H
 
 #include "msg_definitions.h"
+#include "msg_bus.h"
+#include "serial_link.h"
 #include "request_tracker.h"
 
 #ifdef ARDUINO
@@ -84,8 +165,13 @@ struct serial_port_config_t {
     uint32_t baud_rate;         // Baud rate (default: 2000000)
     bool tx_enabled;            // Allow outbound messages (default: true)
     bool rx_enabled;            // Allow inbound messages (default: true)
+    uint16_t link_mtu;          // Largest v2 frame before encoding, 0 = legacy only (default: 256)
+    uint16_t link_flush_us;     // Longest a v2 record waits for its frame (default: 2000)
 };
 
+// ID -> telemetry channel index hash (power of two)
+#define SERIAL_TELEMETRY_SLOTS          64
+
 // External serial configuration
 struct external_serial_config_t {
     serial_port_config_t usb;       // USB Serial port
@@ -95,11 +181,18 @@ struct external_serial_config_t {
 
 // Default configuration
 static const external_serial_config_t DEFAULT_EXTERNAL_SERIAL_CONFIG = {
-    .usb = {.enabled = true, .baud_rate = 2000000, .tx_enabled = true, .rx_enabled = true},
-    .serial1 = {.enabled = false, .baud_rate = 1000000, .tx_enabled = true, .rx_enabled = true},
-    .serial2 = {.enabled = false, .baud_rate = 115200, .tx_enabled = true, .rx_enabled = true}
+    .usb = {.enabled = true, .baud_rate = 2000000, .tx_enabled = true, .rx_enabled = true, .link_mtu = 256, .link_flush_us = 2000},
+    .serial1 = {.enabled = false, .baud_rate = 1000000, .tx_enabled = true, .rx_enabled = true, .link_mtu = 256, .link_flush_us = 2000},
+    .serial2 = {.enabled = false, .baud_rate = 115200, .tx_enabled = true, .rx_enabled = true, .link_mtu = 256, .link_flush_us = 2000}
 };
 
+class DMAChannel;
+
+// Outbound filter sizing
+#define SERIAL_FILTER_SLOTS         64      // Hash slots (power of two)
+#define SERIAL_FILTER_MAX_IDS       48      // Keeps the load factor at 3/4
+#define SERIAL_FILTER_GROUP_WORDS   128     // 4096 ECU/subsystem bits
+
 // Serial bridge for a single port
 class SerialBridge {
 public:
@@ -115,12 +208,30 @@ public:
     // Message handling
     void send_message(const CANMessage& msg);
     
+    // Whether send_message() would queue this ID now rather than drop it
+    bool has_tx_room(uint32_t msg_id) const;
+    
     // Status and statistics
     bool is_enabled() const { return enabled; }
     uint32_t get_messages_sent() const { return messages_sent; }
     uint32_t get_messages_received() const { return messages_received; }
     uint32_t get_parse_errors() const { return parse_errors; }
     uint32_t get_buffer_overflows() const { return buffer_overflows; }
+    uint32_t get_crc_errors() const { return crc_errors; }
+    uint32_t get_frames_sent() const { return frames_sent; }
+    uint8_t get_link_version() const { return link_version; }
+    uint16_t get_link_mtu() const { return link_mtu; }
+    uint32_t get_tx_drops(message_priority_t priority) const { return tx_drops[priority]; }
+    uint32_t get_tx_drops_total() const;
+    uint32_t get_tx_overflows() const { return tx_overflows; }
+    uint16_t get_tx_pending() const { return (uint16_t)(tx_head - tx_tail); }
+    uint16_t get_tx_peak() const { return tx_peak; }
+    
+    // Move queued bytes toward the port without waiting
+    void drain_tx_ring();
+    
+    // Write the open v2 frame now instead of at its deadline
+    void flush_link_frame();
     
     // Reset functions
     void reset_statistics();
@@ -128,6 +239,20 @@ public:
     // Test helper methods (public for testing)
     bool should_process_message(uint32_t can_id);
     
+    // Outbound filter. Empty = pass everything. max_rate_hz = 0 means no cap.
+    bool filter_add_id(uint32_t msg_id, uint16_t max_rate_hz = 0);
+    bool filter_add_group(uint32_t ecu_base, uint32_t subsystem);
+    void filter_clear();
+    bool filter_active() const { return filter_ids > 0 || filter_groups > 0; }
+    bool wants_message(uint32_t msg_id);   // Marks the send for rate-capped IDs
+    uint32_t get_filtered_messages() const { return filtered_messages; }
+    uint32_t get_rate_limited_messages() const { return rate_limited_messages; }
+    
+    // Telemetry mode status
+    bool is_telemetry_active() const { return telemetry_active; }
+    uint8_t get_telemetry_channel_count() const { return telemetry_channel_count; }
+    uint32_t get_telemetry_ticks() const { return telemetry_ticks; }
+    
     // Channel configuration
     void set_channel_id(uint8_t id) { channel_id = id; }
     uint8_t get_channel_id() const { return channel_id; }
@@ -137,6 +262,11 @@ public:
         request_tracker.remove_request(request_id, channel);
     }
     
+    // Pending request slots (rounded to a power of two); drops any pending
+    void set_request_capacity(uint8_t capacity) { request_tracker.set_capacity(capacity); }
+    uint8_t get_pending_request_count() const { return request_tracker.get_pending_count(); }
+    uint32_t get_request_timeout_count() const { return request_tracker.get_timeout_count(); }
+    
     #ifdef TESTING
     // Test-specific method to get written data
     std::vector<uint8_t> get_written_data_for_testing();
@@ -148,42 +278,109 @@ private:
     serial_port_config_t config;
     bool enabled;
     
-    // Receive buffer and parsing
-    static const uint16_t RX_BUFFER_SIZE = 512;
+    // Receive buffer: unparsed bytes, oldest first. Holds the longest v2
+    // frame with room for the next chunk behind it.
+    static const uint16_t RX_BUFFER_SIZE = 1024;
     uint8_t rx_buffer[RX_BUFFER_SIZE];
-    volatile uint16_t rx_head;
-    volatile uint16_t rx_tail;
+    uint16_t rx_len;
     
-    // Message parsing state
+    // Message being handed to the bus
     CANMessage current_message;
-    uint16_t bytes_received;
-    bool parsing_message;
-    
-    // Prefix buffer for 0xFF 0xFF detection
-    uint8_t prefix_buffer[2];
     
     // Statistics
     uint32_t messages_sent;
     uint32_t messages_received;
     uint32_t parse_errors;
     uint32_t buffer_overflows;
+    uint32_t crc_errors;
+    uint32_t frames_sent;
+    
+    // Transmit ring (free-running indices; DMA reads the in-flight span)
+    static const uint16_t TX_RING_SIZE = 2048;
+    static const uint8_t TX_FILL_LIMIT_PERCENT[MSG_PRIORITY_COUNT];
+    uint8_t tx_ring[TX_RING_SIZE];
+    uint32_t tx_head;
+    uint32_t tx_tail;
+    uint16_t tx_inflight;
+    uint16_t tx_peak;
+    uint32_t tx_drops[MSG_PRIORITY_COUNT];
+    uint32_t tx_overflows;
+    DMAChannel* tx_dma;                     // Null: drain by write()
+    
+    // Outbound filter tables
+    struct FilterEntry {
+        uint32_t msg_id;                    // SERIAL_FILTER_EMPTY when free
+        uint32_t min_interval_us;           // 0 = no rate cap
+        uint32_t last_sent_us;
+        bool sent;
+    };
+    FilterEntry filter_table[SERIAL_FILTER_SLOTS];
+    uint32_t filter_group_bits[SERIAL_FILTER_GROUP_WORDS];
+    uint8_t filter_ids;
+    uint16_t filter_groups;
+    uint32_t filtered_messages;
+    uint32_t rate_limited_messages;
+    FilterEntry* filter_find(uint32_t msg_id);
+    
+    // Telemetry mode state
+    struct TelemetryChannel {
+        uint32_t msg_id;
+        float scale;                        // 1 / step
+        int32_t value_q;                    // Latest quantised value
+        int32_t sent_q;                     // Value the host holds
+        bool has_value;
+    };
+    TelemetryChannel telemetry_channels[SERIAL_TELEMETRY_MAX_CHANNELS];
+    uint8_t telemetry_slots[SERIAL_TELEMETRY_SLOTS];     // Index + 1, 0 = free
+    uint8_t telemetry_channel_count;
+    bool telemetry_active;
+    bool telemetry_keyframe_due;
+    uint32_t telemetry_period_us;
+    uint32_t telemetry_last_tick_us;
+    uint8_t telemetry_keyframe_interval;
+    uint8_t telemetry_keyframe_countdown;
+    uint8_t telemetry_tick;
+    uint32_t telemetry_ticks;
+    int16_t telemetry_find(uint32_t msg_id) const;
+    bool telemetry_absorb(const CANMessage& msg);
+    void telemetry_clear();
+    void handle_telemetry_config();
+    void send_telemetry_tick();
+    void append_link_block(uint32_t msg_id, const uint8_t* data, uint8_t length);
+    
+    // Link protocol v2 state
+    uint8_t link_version;
+    uint16_t link_mtu;
+    uint8_t link_tx_frame[SERIAL_LINK_MAX_MTU];
+    uint16_t link_tx_len;                   // 0 = no open frame
+    uint32_t link_tx_opened_us;
+    uint8_t link_tx_seq;
+    bool link_rx_discarding;                // Overlong frame, skip to next 0x00
     
     // Request tracking for parameter routing
     RequestTracker request_tracker;
     uint8_t channel_id;
     
-    // Buffer management
-    void add_byte_to_buffer(uint8_t byte);
-    bool get_byte_from_buffer(uint8_t* byte);
-    void clear_receive_buffer();
-    uint16_t get_buffer_available_space() const;
-    
     // Message processing
     void process_incoming_bytes();
     void process_complete_message();
+    uint16_t parse_rx_span(uint8_t* data, uint16_t length);
+    uint16_t parse_legacy_span(const uint8_t* data, uint16_t length);
+    void load_legacy_frame(const uint8_t* frame);
+    uint16_t parse_link_span(uint8_t* data, uint16_t length);
+    int32_t find_legacy_hello(const uint8_t* data, uint16_t length);
+    void process_link_frame(uint8_t* frame, uint16_t encoded_length);
+    bool handle_link_hello();
     
     // Serial I/O
     void send_message_bytes(const CANMessage& msg);
+    void append_link_record(const CANMessage& msg);
+    uint8_t* reserve_link_record(uint16_t record_size);
+    void send_link_control(uint32_t msg_id, const void* payload, uint8_t length);
+    bool tx_admit(message_priority_t priority, uint16_t length) const;
+    uint16_t message_tx_length() const;
+    bool write_bytes(const uint8_t* data, size_t length);
+    void setup_tx_dma();
     
     // Error handling
     void handle_parse_error();
@@ -214,6 +411,10 @@ public:
     void route_parameter_response(const CANMessage* msg, parameter_msg_t* param);
     void broadcast_to_enabled_ports(const CANMessage& msg);
     
+    // Room to queue a response to msg_id on a serial channel (other
+    // channels always have room here); lets streamed replies wait
+    bool has_response_room(uint8_t channel, uint32_t msg_id) const;
+    
     // Legacy method (deprecated)
     void on_message_bus_message(const CANMessage* msg);
     
@@ -223,6 +424,7 @@ public:
     uint32_t get_total_messages_received() const;
     uint32_t get_total_parse_errors() const;
     uint32_t get_total_buffer_overflows() const;
+    uint32_t get_total_tx_drops() const;
     
     // Port access
     SerialBridge& get_usb_bridge() { return usb_bridge; }
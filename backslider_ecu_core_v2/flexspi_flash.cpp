@@ -0,0 +1,160 @@
+// flexspi_flash.cpp
+// FlexSPI2 LUT setup, IP command transfers and window invalidation
+
+#include "flexspi_flash.h"
+
+#if defined(ARDUINO) && defined(__IMXRT1062__)
+
+#include <Arduino.h>
+#include <string.h>
+
+#define LUT_SEQ_READ            0       // AHB reads through the window
+#define LUT_SEQ_IP              15      // Rewritten for each IP command
+
+#define CMD_READ_STATUS1        0x05
+#define CMD_READ_STATUS2        0x35
+#define CMD_WRITE_STATUS2       0x31
+#define CMD_WRITE_ENABLE        0x06
+#define CMD_READ_JEDEC_ID       0x9F
+#define CMD_FAST_READ_QUAD      0x6B
+
+#define STATUS_BUSY             0x01
+#define STATUS2_QE              0x02
+
+// Two instructions per LUT word
+#define LUT_WORD(op0, pads0, arg0, op1, pads1, arg1) \
+    (FLEXSPI_LUT_INSTRUCTION((op0), (pads0), (arg0)) | (FLEXSPI_LUT_INSTRUCTION((op1), (pads1), (arg1)) << 16))
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static void lut_write(uint8_t sequence, const uint32_t words[4]) {
+    volatile uint32_t* lut = &FLEXSPI2_LUT0 + sequence * 4;
+    FLEXSPI2_LUTKEY = FLEXSPI_LUTKEY_VALUE;
+    FLEXSPI2_LUTCR = FLEXSPI_LUTCR_UNLOCK;
+    for (uint8_t i = 0; i < 4; i++) {
+        lut[i] = words[i];
+    }
+    FLEXSPI2_LUTKEY = FLEXSPI_LUTKEY_VALUE;
+    FLEXSPI2_LUTCR = FLEXSPI_LUTCR_LOCK;
+}
+
+static void wait_busy_clear(void) {
+    uint8_t status;
+    do {
+        flexspi_flash_command(CMD_READ_STATUS1, 0, false, nullptr, &status, 1);
+    } while (status & STATUS_BUSY);
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+bool flexspi_flash_init(void) {
+    // One 16 MB device on A1; the other chip selects map nothing
+    FLEXSPI2_MCR0 |= FLEXSPI_MCR0_MDIS;
+    FLEXSPI2_FLSHA1CR0 = FLEXSPI_FLASH_SIZE / 1024;
+    FLEXSPI2_FLSHA2CR0 = 0;
+    FLEXSPI2_FLSHB1CR0 = 0;
+    FLEXSPI2_FLSHB2CR0 = 0;
+    FLEXSPI2_FLSHA1CR2 = FLEXSPI_FLSHCR2_ARDSEQID(LUT_SEQ_READ);
+    FLEXSPI2_AHBCR = FLEXSPI_AHBCR_PREFETCHEN | FLEXSPI_AHBCR_BUFFERABLEEN | FLEXSPI_AHBCR_CACHABLEEN;
+    FLEXSPI2_MCR0 &= ~FLEXSPI_MCR0_MDIS;
+
+    // Window reads: 0x6B, 24-bit address, 8 dummy cycles, data on 4 lines
+    const uint32_t read_sequence[4] = {
+        LUT_WORD(FLEXSPI_LUT_OPCODE_CMD_SDR, FLEXSPI_LUT_NUM_PADS_1, CMD_FAST_READ_QUAD,
+                 FLEXSPI_LUT_OPCODE_ADDR_SDR, FLEXSPI_LUT_NUM_PADS_1, 24),
+        LUT_WORD(FLEXSPI_LUT_OPCODE_DUMMY_SDR, FLEXSPI_LUT_NUM_PADS_4, 8,
+                 FLEXSPI_LUT_OPCODE_READ_SDR, FLEXSPI_LUT_NUM_PADS_4, 4),
+        0, 0
+    };
+    lut_write(LUT_SEQ_READ, read_sequence);
+
+    uint8_t id[3];
+    flexspi_flash_command(CMD_READ_JEDEC_ID, 0, false, nullptr, id, sizeof(id));
+    if (id[0] != 0xEF) {
+        return false;
+    }
+
+    // Quad output reads need QE (factory set on -IQ parts, not on -IM)
+    uint8_t status2;
+    flexspi_flash_command(CMD_READ_STATUS2, 0, false, nullptr, &status2, 1);
+    if (!(status2 & STATUS2_QE)) {
+        status2 |= STATUS2_QE;
+        flexspi_flash_command(CMD_WRITE_ENABLE, 0, false, nullptr, nullptr, 0);
+        flexspi_flash_command(CMD_WRITE_STATUS2, 0, false, &status2, nullptr, 1);
+        wait_busy_clear();
+    }
+
+    flexspi_flash_invalidate(0, FLEXSPI_FLASH_SIZE);
+    return true;
+}
+
+void flexspi_flash_command(uint8_t opcode, uint32_t address, bool addressed,
+                           const uint8_t* tx, uint8_t* rx, size_t length) {
+    if (rx && length > FLEXSPI_FLASH_IP_RX_MAX) {
+        length = FLEXSPI_FLASH_IP_RX_MAX;
+    }
+
+    // Build the sequence: command, optional address, optional data, stop
+    uint16_t instructions[4] = {0, 0, 0, 0};
+    uint8_t count = 0;
+    instructions[count++] = FLEXSPI_LUT_INSTRUCTION(FLEXSPI_LUT_OPCODE_CMD_SDR, FLEXSPI_LUT_NUM_PADS_1, opcode);
+    if (addressed) {
+        instructions[count++] = FLEXSPI_LUT_INSTRUCTION(FLEXSPI_LUT_OPCODE_ADDR_SDR, FLEXSPI_LUT_NUM_PADS_1, 24);
+    }
+    if (length > 0) {
+        uint8_t data_opcode = tx ? FLEXSPI_LUT_OPCODE_WRITE_SDR : FLEXSPI_LUT_OPCODE_READ_SDR;
+        instructions[count++] = FLEXSPI_LUT_INSTRUCTION(data_opcode, FLEXSPI_LUT_NUM_PADS_1, 1);
+    }
+    const uint32_t sequence[4] = {
+        (uint32_t)instructions[0] | ((uint32_t)instructions[1] << 16),
+        (uint32_t)instructions[2] | ((uint32_t)instructions[3] << 16),
+        0, 0
+    };
+    lut_write(LUT_SEQ_IP, sequence);
+
+    FLEXSPI2_IPRXFCR = FLEXSPI_IPRXFCR_CLRIPRXF;
+    FLEXSPI2_IPTXFCR = FLEXSPI_IPTXFCR_CLRIPTXF;
+    FLEXSPI2_INTR = FLEXSPI_INTR_IPCMDDONE | FLEXSPI_INTR_IPRXWA | FLEXSPI_INTR_IPTXWE;
+    FLEXSPI2_IPCR0 = address;
+    FLEXSPI2_IPCR1 = FLEXSPI_IPCR1_ISEQID(LUT_SEQ_IP) | FLEXSPI_IPCR1_IDATSZ(length);
+    FLEXSPI2_IPCMD = FLEXSPI_IPCMD_TRG;
+
+    // Transmit FIFO takes 8 bytes per watermark
+    for (size_t done = 0; tx && done < length; done += 8) {
+        while (!(FLEXSPI2_INTR & FLEXSPI_INTR_IPTXWE)) {
+        }
+        uint32_t words[2] = {0xFFFFFFFF, 0xFFFFFFFF};
+        memcpy(words, tx + done, (length - done < 8) ? length - done : 8);
+        FLEXSPI2_TFDR0 = words[0];
+        FLEXSPI2_TFDR1 = words[1];
+        FLEXSPI2_INTR = FLEXSPI_INTR_IPTXWE;
+    }
+
+    while (!(FLEXSPI2_INTR & FLEXSPI_INTR_IPCMDDONE)) {
+    }
+    FLEXSPI2_INTR = FLEXSPI_INTR_IPCMDDONE;
+
+    if (rx && length > 0) {
+        uint32_t words[2] = {FLEXSPI2_RFDR0, FLEXSPI2_RFDR1};
+        memcpy(rx, words, length);
+        FLEXSPI2_INTR = FLEXSPI_INTR_IPRXWA;
+    }
+}
+
+const uint8_t* flexspi_flash_window(void) {
+    return (const uint8_t*)FLEXSPI_FLASH_WINDOW;
+}
+
+void flexspi_flash_invalidate(uint32_t address, size_t length) {
+    // Cached lines first, then the controller's prefetch buffers
+    arm_dcache_delete((void*)(FLEXSPI_FLASH_WINDOW + address), length);
+    FLEXSPI2_MCR0 |= FLEXSPI_MCR0_SWRESET;
+    while (FLEXSPI2_MCR0 & FLEXSPI_MCR0_SWRESET) {
+    }
+}
+
+#endif
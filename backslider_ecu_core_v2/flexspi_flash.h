@@ -0,0 +1,66 @@
+// flexspi_flash.h
+// NOR flash on the Teensy 4.1 FlexSPI2 pads: IP commands and the mapped read window
+
+/* =============================================================================
+ * FLEXSPI FLASH OVERVIEW
+ * =============================================================================
+ *
+ * The pads under the Teensy 4.1 (PSRAM footprint) are wired to FlexSPI2.
+ * With a W25Q128 soldered to the first pad and no PSRAM, FlexSPI2 can
+ * serve the chip two ways at once:
+ *
+ *   AHB window   0x70000000 + address, read-only, quad output fast read
+ *                (0x6B). Reads are plain loads through the data cache:
+ *                no command bytes, no per-byte SPI transfers.
+ *   IP commands  everything else - status, write enable, program, erase,
+ *                suspend/resume - one LUT sequence rewritten per command.
+ *
+ * After a program or erase, flexspi_flash_invalidate() drops the cached
+ * window lines and FlexSPI's AHB prefetch buffers for the range, or loads
+ * would return the old bytes. While the chip is busy the window reads
+ * garbage; the caller suspends an erase or waits out a program first.
+ *
+ * The core's startup code sets up the FlexSPI2 pads and root clock while
+ * probing for PSRAM. flexspi_flash_init() takes the controller over, so
+ * EXTMEM cannot be used alongside it.
+ *
+ * Teensy 4.x only; desktop builds never call it.
+ *
+ * EXAMPLE:
+ *   if (flexspi_flash_init()) {
+ *       const uint8_t* flash = flexspi_flash_window();
+ *       memcpy(buffer, flash + address, length);
+ *   }
+ * =============================================================================
+ */
+
+#ifndef FLEXSPI_FLASH_H
+#define FLEXSPI_FLASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FLEXSPI_FLASH_WINDOW        0x70000000
+#define FLEXSPI_FLASH_SIZE          (16 * 1024 * 1024)
+#define FLEXSPI_FLASH_IP_RX_MAX     8               // Longest IP read (status, ID)
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Configure FlexSPI2 for the flash and set the quad enable bit. Returns
+// false if no Winbond chip answers.
+bool flexspi_flash_init(void);
+
+// One command: opcode, then a 24-bit address if addressed, then length
+// bytes written from tx or read into rx (rx at most FLEXSPI_FLASH_IP_RX_MAX)
+void flexspi_flash_command(uint8_t opcode, uint32_t address, bool addressed,
+                           const uint8_t* tx, uint8_t* rx, size_t length);
+
+// Base of the mapped window
+const uint8_t* flexspi_flash_window(void);
+
+// Drop stale window contents after a program or erase of the range
+void flexspi_flash_invalidate(uint32_t address, size_t length);
+
+#endif
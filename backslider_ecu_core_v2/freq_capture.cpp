@@ -0,0 +1,379 @@
+// freq_capture.cpp
+// QuadTimer period/count frequency measurement with automatic mode selection
+
+#include "freq_capture.h"
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+// Edge selections, same values as FREQ_EDGE_* in input_manager.h
+#define CAPTURE_EDGE_RISING     0
+#define CAPTURE_EDGE_FALLING    1
+#define CAPTURE_EDGE_CHANGE     2
+
+#define CAPTURE_PRESCALE_SHIFT  7       // Bus clock / 128 in PERIOD mode
+#define CAPTURE_BUS_CLOCK_HZ    150000000UL
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+// Teensy 4.1 pins with a QuadTimer input on ALT1 and no input daisy chain
+typedef struct {
+    uint8_t pin;
+    uint8_t timer;      // 0 = TMR1 ... 3 = TMR4
+    uint8_t channel;    // Channel (and counter input) within the timer
+} capture_route_t;
+
+static const capture_route_t capture_routes[] = {
+    { 6, 3, 1},     // GPIO_B0_10  QTIMER4_TIMER1
+    { 9, 3, 2},     // GPIO_B0_11  QTIMER4_TIMER2
+    {10, 0, 0},     // GPIO_B0_00  QTIMER1_TIMER0
+    {11, 0, 2},     // GPIO_B0_02  QTIMER1_TIMER2
+    {12, 0, 1},     // GPIO_B0_01  QTIMER1_TIMER1
+};
+#define CAPTURE_ROUTE_COUNT (sizeof(capture_routes) / sizeof(capture_routes[0]))
+
+// Written by the capture ISR (PERIOD mode)
+typedef struct {
+    volatile uint32_t edges;        // Periods accumulated since the last update
+    volatile uint32_t ticks;        // Sum of those periods in timer ticks
+    volatile uint32_t overflows;    // Counter wraps: upper 16 bits of the timestamp
+    volatile uint32_t last_stamp;   // Extended timestamp of the previous edge
+    volatile uint8_t have_stamp;    // 0 = next edge only starts a period
+} capture_isr_data_t;
+
+// Main thread state
+typedef struct {
+    const capture_route_t* route;
+    uint8_t edge;
+    uint8_t mode;
+    uint32_t timeout_us;
+    uint32_t last_edge_us;          // When edges were last seen
+    uint32_t window_start_us;       // COUNT mode window start
+    uint16_t window_start_count;    // Counter value at window start
+    float frequency_hz;
+} capture_channel_t;
+
+static capture_isr_data_t isr_data[FREQ_CAPTURE_MAX_CHANNELS];
+static capture_channel_t channels[FREQ_CAPTURE_MAX_CHANNELS];
+static uint8_t channel_count = 0;
+static volatile uint32_t isr_count = 0;
+static float tick_hz = (float)(CAPTURE_BUS_CLOCK_HZ >> CAPTURE_PRESCALE_SHIFT);
+
+#ifndef ARDUINO
+static uint32_t sim_stamp[FREQ_CAPTURE_MAX_CHANNELS];      // Free-running capture timestamp
+static uint16_t sim_counter[FREQ_CAPTURE_MAX_CHANNELS];    // COUNT mode counter
+#endif
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static const capture_route_t* find_route(uint8_t pin) {
+    for (uint8_t i = 0; i < CAPTURE_ROUTE_COUNT; i++) {
+        if (capture_routes[i].pin == pin) {
+            return &capture_routes[i];
+        }
+    }
+    return nullptr;
+}
+
+static int8_t find_channel(uint8_t pin) {
+    for (uint8_t i = 0; i < channel_count; i++) {
+        if (channels[i].route->pin == pin) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Fold one captured edge into the period accumulator (ISR context on hardware)
+static inline void record_edge(capture_isr_data_t* d, uint32_t stamp) {
+    if (d->have_stamp) {
+        d->ticks += stamp - d->last_stamp;
+        d->edges++;
+    }
+    d->last_stamp = stamp;
+    d->have_stamp = 1;
+}
+
+#ifdef ARDUINO
+
+static IMXRT_TMR_t* const timer_modules[4] = {
+    &IMXRT_TMR1, &IMXRT_TMR2, &IMXRT_TMR3, &IMXRT_TMR4
+};
+static const IRQ_NUMBER_t timer_irqs[4] = {
+    IRQ_QTIMER1, IRQ_QTIMER2, IRQ_QTIMER3, IRQ_QTIMER4
+};
+
+static void service_timer(uint8_t timer) {
+    IMXRT_TMR_t* tmr = timer_modules[timer];
+    for (uint8_t i = 0; i < channel_count; i++) {
+        if (channels[i].route->timer != timer || channels[i].mode != FREQ_CAPTURE_MODE_PERIOD) {
+            continue;
+        }
+        uint8_t c = channels[i].route->channel;
+        capture_isr_data_t* d = &isr_data[i];
+        uint16_t sctrl = tmr->CH[c].SCTRL;
+        uint16_t clear = 0;
+
+        if (sctrl & TMR_SCTRL_IEF) {
+            uint16_t captured = tmr->CH[c].CAPT;
+            // A pending wrap with a small capture value happened before this edge
+            if ((sctrl & TMR_SCTRL_TOF) && captured < 0x8000) {
+                d->overflows++;
+                clear |= TMR_SCTRL_TOF;
+            }
+            record_edge(d, (d->overflows << 16) | captured);
+            clear |= TMR_SCTRL_IEF;
+        }
+        if ((sctrl & TMR_SCTRL_TOF) && !(clear & TMR_SCTRL_TOF)) {
+            d->overflows++;
+            clear |= TMR_SCTRL_TOF;
+        }
+        if (clear) {
+            tmr->CH[c].SCTRL = sctrl & ~clear;     // Flags clear on writing 0
+            isr_count++;
+        }
+    }
+    asm volatile("dsb");   // Flag clears must land before the ISR returns
+}
+
+static void qtimer1_isr(void) { service_timer(0); }
+static void qtimer2_isr(void) { service_timer(1); }
+static void qtimer3_isr(void) { service_timer(2); }
+static void qtimer4_isr(void) { service_timer(3); }
+
+static void (* const timer_isrs[4])(void) = {
+    qtimer1_isr, qtimer2_isr, qtimer3_isr, qtimer4_isr
+};
+
+static uint16_t read_counter(uint8_t slot) {
+    const capture_route_t* route = channels[slot].route;
+    return timer_modules[route->timer]->CH[route->channel].CNTR;
+}
+
+// Program a channel for the selected mode. Channel interrupts are only
+// enabled in PERIOD mode.
+static void configure_channel(uint8_t slot) {
+    capture_channel_t* ch = &channels[slot];
+    IMXRT_TMR_t* tmr = timer_modules[ch->route->timer];
+    uint8_t c = ch->route->channel;
+
+    tmr->CH[c].CTRL = 0;                    // Stop while reprogramming
+    tmr->CH[c].CSCTRL = 0;
+    tmr->CH[c].LOAD = 0;
+    tmr->CH[c].COMP1 = 0xFFFF;
+    tmr->CH[c].CMPLD1 = 0xFFFF;
+    tmr->CH[c].CNTR = 0;
+
+    if (ch->mode == FREQ_CAPTURE_MODE_PERIOD) {
+        // Capture modes: 1 = rising, 2 = falling, 3 = both edges of the secondary input
+        tmr->CH[c].SCTRL = TMR_SCTRL_CAPTURE_MODE(ch->edge + 1) | TMR_SCTRL_IEFIE | TMR_SCTRL_TOFIE;
+        tmr->CH[c].CTRL = TMR_CTRL_CM(1) | TMR_CTRL_PCS(8 + CAPTURE_PRESCALE_SHIFT) | TMR_CTRL_SCS(c);
+    } else {
+        // Clocked by the pin: CM 1 counts rising edges, 2 both; IPS inverts for falling
+        tmr->CH[c].SCTRL = (ch->edge == CAPTURE_EDGE_FALLING) ? TMR_SCTRL_IPS : 0;
+        tmr->CH[c].CTRL = TMR_CTRL_CM(ch->edge == CAPTURE_EDGE_CHANGE ? 2 : 1) | TMR_CTRL_PCS(c);
+    }
+}
+
+static void start_timer_irq(uint8_t timer) {
+    attachInterruptVector(timer_irqs[timer], timer_isrs[timer]);
+    NVIC_SET_PRIORITY(timer_irqs[timer], 64);
+    NVIC_ENABLE_IRQ(timer_irqs[timer]);
+}
+
+#else
+
+static uint16_t read_counter(uint8_t slot) {
+    return sim_counter[slot];
+}
+
+static void configure_channel(uint8_t slot) {
+    sim_counter[slot] = 0;
+}
+
+#endif
+
+static void set_mode(uint8_t slot, uint8_t mode, uint32_t now_us) {
+    capture_channel_t* ch = &channels[slot];
+    capture_isr_data_t* d = &isr_data[slot];
+
+    #ifdef ARDUINO
+    noInterrupts();
+    #endif
+    ch->mode = mode;
+    d->edges = 0;
+    d->ticks = 0;
+    d->have_stamp = 0;
+    configure_channel(slot);
+    #ifdef ARDUINO
+    interrupts();
+    #endif
+
+    ch->window_start_us = now_us;
+    ch->window_start_count = 0;
+}
+
+static void update_period_channel(uint8_t slot, uint32_t now_us) {
+    capture_channel_t* ch = &channels[slot];
+    capture_isr_data_t* d = &isr_data[slot];
+
+    #ifdef ARDUINO
+    noInterrupts();
+    #endif
+    uint32_t edges = d->edges;
+    uint32_t ticks = d->ticks;
+    d->edges = 0;
+    d->ticks = 0;
+    #ifdef ARDUINO
+    interrupts();
+    #endif
+
+    if (edges > 0 && ticks > 0) {
+        ch->frequency_hz = (float)edges * tick_hz / (float)ticks;
+        ch->last_edge_us = now_us;
+    } else if (now_us - ch->last_edge_us > ch->timeout_us) {
+        ch->frequency_hz = 0.0f;
+        ch->last_edge_us = now_us;
+        // The next edge after a stop must not be measured against the last one
+        d->have_stamp = 0;
+    }
+
+    if (ch->frequency_hz > FREQ_CAPTURE_COUNT_ABOVE_HZ) {
+        set_mode(slot, FREQ_CAPTURE_MODE_COUNT, now_us);
+    }
+}
+
+static void update_count_channel(uint8_t slot, uint32_t now_us) {
+    capture_channel_t* ch = &channels[slot];
+    uint32_t elapsed_us = now_us - ch->window_start_us;
+    if (elapsed_us < FREQ_CAPTURE_COUNT_WINDOW_US) {
+        return;
+    }
+
+    uint16_t count = read_counter(slot);
+    uint16_t delta = (uint16_t)(count - ch->window_start_count);
+    ch->frequency_hz = (float)delta * 1000000.0f / (float)elapsed_us;
+    ch->window_start_count = count;
+    ch->window_start_us = now_us;
+    if (delta > 0) {
+        ch->last_edge_us = now_us;
+    }
+
+    if (ch->frequency_hz < FREQ_CAPTURE_PERIOD_BELOW_HZ) {
+        set_mode(slot, FREQ_CAPTURE_MODE_PERIOD, now_us);
+    }
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void freq_capture_init(void) {
+    #ifdef ARDUINO
+    for (uint8_t i = 0; i < channel_count; i++) {
+        const capture_route_t* route = channels[i].route;
+        timer_modules[route->timer]->CH[route->channel].SCTRL = 0;
+        timer_modules[route->timer]->CH[route->channel].CTRL = 0;
+    }
+    tick_hz = (float)F_BUS_ACTUAL / (float)(1UL << CAPTURE_PRESCALE_SHIFT);
+    #endif
+
+    channel_count = 0;
+    isr_count = 0;
+}
+
+bool freq_capture_add_pin(uint8_t pin, uint8_t edge, uint32_t timeout_us) {
+    if (find_channel(pin) >= 0) {
+        return true;
+    }
+    const capture_route_t* route = find_route(pin);
+    if (route == nullptr || channel_count >= FREQ_CAPTURE_MAX_CHANNELS) {
+        return false;
+    }
+
+    uint8_t slot = channel_count;
+    capture_channel_t* ch = &channels[slot];
+    ch->route = route;
+    ch->edge = (edge <= CAPTURE_EDGE_CHANGE) ? edge : CAPTURE_EDGE_RISING;
+    ch->timeout_us = timeout_us;
+    ch->last_edge_us = micros();
+    ch->frequency_hz = 0.0f;
+    isr_data[slot].overflows = 0;
+    #ifndef ARDUINO
+    sim_stamp[slot] = 0;
+    #endif
+
+    #ifdef ARDUINO
+    CCM_CCGR6 |= CCM_CCGR6_QTIMER1(CCM_CCGR_ON) | CCM_CCGR6_QTIMER2(CCM_CCGR_ON) |
+                 CCM_CCGR6_QTIMER3(CCM_CCGR_ON) | CCM_CCGR6_QTIMER4(CCM_CCGR_ON);
+    *(portConfigRegister(pin)) = 1;         // ALT1: QuadTimer input
+    #endif
+
+    // Visible to the ISR only once the slot is complete
+    channel_count++;
+    set_mode(slot, FREQ_CAPTURE_MODE_PERIOD, micros());
+
+    #ifdef ARDUINO
+    start_timer_irq(route->timer);
+    #endif
+    return true;
+}
+
+void freq_capture_update(void) {
+    uint32_t now_us = micros();
+    for (uint8_t i = 0; i < channel_count; i++) {
+        if (channels[i].mode == FREQ_CAPTURE_MODE_PERIOD) {
+            update_period_channel(i, now_us);
+        } else {
+            update_count_channel(i, now_us);
+        }
+    }
+}
+
+bool freq_capture_get(uint8_t pin, float* frequency_hz) {
+    int8_t slot = find_channel(pin);
+    if (slot < 0) {
+        return false;
+    }
+    *frequency_hz = channels[slot].frequency_hz;
+    return true;
+}
+
+uint8_t freq_capture_get_mode(uint8_t pin) {
+    int8_t slot = find_channel(pin);
+    return (slot < 0) ? 0xFF : channels[slot].mode;
+}
+
+uint8_t freq_capture_get_channel_count(void) {
+    return channel_count;
+}
+
+uint32_t freq_capture_get_isr_count(void) {
+    return isr_count;
+}
+
+#ifdef TESTING
+void freq_capture_inject_edges_for_testing(uint8_t pin, uint32_t edges, uint32_t period_us) {
+    int8_t slot = find_channel(pin);
+    if (slot < 0) {
+        return;
+    }
+    if (channels[slot].mode == FREQ_CAPTURE_MODE_COUNT) {
+        sim_counter[slot] = (uint16_t)(sim_counter[slot] + edges);
+        return;
+    }
+    uint32_t period_ticks = (uint32_t)((float)period_us * tick_hz / 1000000.0f + 0.5f);
+    for (uint32_t e = 0; e < edges; e++) {
+        sim_stamp[slot] += period_ticks;
+        record_edge(&isr_data[slot], sim_stamp[slot]);
+        isr_count++;
+    }
+}
+#endif
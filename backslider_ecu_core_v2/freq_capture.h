@@ -0,0 +1,86 @@
+// freq_capture.h
+// Hardware input-capture frequency measurement on i.MX RT QuadTimer channels
+
+/* =============================================================================
+ * FREQUENCY CAPTURE OVERVIEW
+ * =============================================================================
+ *
+ * Software edge counting (attachInterrupt per edge, frequency from counts per
+ * 100 ms window) resolves only 10 Hz at a time and costs one ISR per edge.
+ * On pins routed to a QuadTimer channel the timer does the work instead, in
+ * one of two modes chosen per channel by the measured frequency:
+ *
+ * - PERIOD: the channel counts the prescaled bus clock (150 MHz / 128,
+ *   ~0.85 µs per tick) and captures the count on each input edge. The
+ *   capture ISR only accumulates tick deltas and an edge count; the main
+ *   loop turns them into edges * tick_hz / ticks. Resolution is one tick per
+ *   period regardless of frequency, which is what low VSS speeds need.
+ *   Counter overflows extend the timestamp so slow signals still measure.
+ * - COUNT: the channel is clocked by the input itself and the main loop
+ *   reads the counter every FREQ_CAPTURE_COUNT_WINDOW_US. No interrupts at
+ *   all, so high RPM signals cost nothing per edge.
+ *
+ * Channels start in PERIOD mode, switch to COUNT above
+ * FREQ_CAPTURE_COUNT_ABOVE_HZ and back below FREQ_CAPTURE_PERIOD_BELOW_HZ;
+ * the gap between the two keeps a signal near the threshold from flapping.
+ *
+ * input_manager uses capture for SENSOR_FREQUENCY_COUNTER sensors with
+ * use_interrupts set when the pin has a QuadTimer input (Teensy 4.1 pins 6,
+ * 9, 10, 11, 12); other pins keep the attachInterrupt counters.
+ *
+ * Frequencies are edges per second: FREQ_EDGE_CHANGE counts both edges, as
+ * the interrupt counters do.
+ *
+ * In the current pin map only PIN_VEHICLE_SPEED (6) is a capture-capable
+ * input; 9-12 carry ignition outputs but stay in the table for other builds.
+ *
+ * Hardware note: FlexPWM capture would reach more pins, but those
+ * submodules also generate the PWM outputs, so capture uses QuadTimer only.
+ * =============================================================================
+ */
+
+#ifndef FREQ_CAPTURE_H
+#define FREQ_CAPTURE_H
+
+#include <stdint.h>
+
+#define FREQ_CAPTURE_MAX_CHANNELS       5
+#define FREQ_CAPTURE_COUNT_ABOVE_HZ     5000.0f     // PERIOD -> COUNT
+#define FREQ_CAPTURE_PERIOD_BELOW_HZ    4000.0f     // COUNT -> PERIOD
+#define FREQ_CAPTURE_COUNT_WINDOW_US    50000       // Counter read interval in COUNT mode
+
+#define FREQ_CAPTURE_MODE_PERIOD        0
+#define FREQ_CAPTURE_MODE_COUNT         1
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Stop all channels and forget their pins
+void freq_capture_init(void);
+
+// Start measuring a pin. edge is FREQ_EDGE_RISING/FALLING/CHANGE; the
+// frequency reads 0 after timeout_us without an edge.
+// Returns false if the pin has no QuadTimer input or all channels are used.
+bool freq_capture_add_pin(uint8_t pin, uint8_t edge, uint32_t timeout_us);
+
+// Fold new edges into each channel's frequency and switch modes; called
+// once per input_manager_update()
+void freq_capture_update(void);
+
+// Latest frequency for a captured pin. Returns false if the pin is not captured.
+bool freq_capture_get(uint8_t pin, float* frequency_hz);
+
+// Current mode of a captured pin (FREQ_CAPTURE_MODE_*), 0xFF if not captured
+uint8_t freq_capture_get_mode(uint8_t pin);
+
+// Diagnostics
+uint8_t freq_capture_get_channel_count(void);
+uint32_t freq_capture_get_isr_count(void);     // Capture/overflow interrupts serviced
+
+#ifdef TESTING
+// Feed edges with a fixed period into a channel, as the timer would see them
+void freq_capture_inject_edges_for_testing(uint8_t pin, uint32_t edges, uint32_t period_us);
+#endif
+
+#endif
@@ -0,0 +1,185 @@
+// ecu_replay.cpp
+// Recording index and stamp-paced playback
+
+#include "ecu_replay.h"
+#include "../sd_logger.h"
+#include <stdio.h>
+#include <string.h>
+
+EcuReplay::EcuReplay() : sd_log(false), target(nullptr), speed(1.0), next_event(0), bytes_fed(0) {
+}
+
+bool EcuReplay::load(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[65536];
+    size_t count;
+    while ((count = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + count);
+    }
+    fclose(file);
+    return load_bytes(data.data(), data.size());
+}
+
+bool EcuReplay::load_bytes(const uint8_t* data, size_t length) {
+    bytes.assign(data, data + length);
+    messages.clear();
+    events.clear();
+    target = nullptr;
+    next_event = 0;
+    bytes_fed = 0;
+
+    uint32_t magic = 0;
+    if (length >= sizeof(magic)) {
+        memcpy(&magic, data, sizeof(magic));
+    }
+    sd_log = (magic == SD_LOGGER_BLOCK_MAGIC);
+    bool indexed = sd_log ? index_sd_log() : index_capture();
+    if (sd_log) {
+        bytes.clear();      // Records live in messages now
+    }
+    return indexed && !events.empty();
+}
+
+void EcuReplay::add_event(uint32_t timestamp_us, uint64_t end) {
+    Event event;
+    event.end = end;
+    if (events.empty()) {
+        event.time_us = timestamp_us;
+    } else {
+        // Forward by the 32-bit difference; a step back plays at once
+        uint64_t previous = events.back().time_us;
+        int32_t delta = (int32_t)(timestamp_us - (uint32_t)previous);
+        event.time_us = previous + (delta > 0 ? (uint64_t)delta : 0);
+    }
+    events.push_back(event);
+}
+
+bool EcuReplay::index_sd_log() {
+    size_t pos = 0;
+    while (pos + sizeof(sd_log_block_header_t) <= bytes.size()) {
+        sd_log_block_header_t header;
+        memcpy(&header, &bytes[pos], sizeof(header));
+        if (header.magic != SD_LOGGER_BLOCK_MAGIC || header.used < sizeof(header) ||
+            pos + header.used > bytes.size()) {
+            break;          // Unused pre-allocation or a torn last block
+        }
+        size_t record = pos + sizeof(header);
+        size_t block_end = pos + header.used;
+        for (uint16_t i = 0; i < header.records && record + SD_LOGGER_RECORD_HEADER <= block_end; i++) {
+            uint8_t length = bytes[record + 8];
+            if (length > 8 || record + SD_LOGGER_RECORD_HEADER + length > block_end) {
+                break;
+            }
+            CANMessage msg;
+            memset(&msg, 0, sizeof(msg));
+            memcpy(&msg.timestamp_us, &bytes[record], 4);
+            memcpy(&msg.id, &bytes[record + 4], 4);
+            msg.len = length;
+            memcpy(msg.buf, &bytes[record + SD_LOGGER_RECORD_HEADER], length);
+            msg.timestamp = (uint16_t)msg.timestamp_us;
+            msg.flags.extended = 1;
+            add_event(msg.timestamp_us, messages.size());
+            messages.push_back(msg);
+            record += SD_LOGGER_RECORD_HEADER + length;
+        }
+        pos += (header.used + SD_LOGGER_SECTOR_SIZE - 1) / SD_LOGGER_SECTOR_SIZE * SD_LOGGER_SECTOR_SIZE;
+    }
+    return true;
+}
+
+void EcuReplay::capture_frame(uint32_t timestamp_us, uint64_t end_offset, void* context) {
+    ((EcuReplay*)context)->add_event(timestamp_us, end_offset);
+}
+
+bool EcuReplay::index_capture() {
+    // Decoded once only for frame boundaries and stamps
+    EcuStreamDecoder scanner;
+    scanner.frame_hook = capture_frame;
+    scanner.frame_hook_context = this;
+    scanner.feed(bytes.data(), bytes.size());
+    return true;
+}
+
+void EcuReplay::start(EcuStreamDecoder* new_target, double new_speed) {
+    target = new_target;
+    speed = new_speed;
+    next_event = 0;
+    bytes_fed = 0;
+}
+
+size_t EcuReplay::advance(uint64_t host_elapsed_us) {
+    if (!target || finished()) {
+        return 0;
+    }
+    uint64_t session_us = (speed > 0) ? (uint64_t)(host_elapsed_us * speed) : UINT64_MAX;
+    uint64_t first_us = events[0].time_us;
+    size_t due = next_event;
+    while (due < events.size() && events[due].time_us - first_us <= session_us) {
+        due++;
+    }
+    size_t delivered = due - next_event;
+    if (delivered == 0) {
+        return 0;
+    }
+
+    if (sd_log) {
+        for (size_t i = next_event; i < due; i++) {
+            target->deliver(messages[events[i].end]);
+        }
+    } else {
+        // One span from the capture, parsed in place by the decoder
+        uint64_t end = events[due - 1].end;
+        target->feed(&bytes[bytes_fed], end - bytes_fed);
+        bytes_fed = end;
+    }
+    next_event = due;
+    return delivered;
+}
+
+uint64_t EcuReplay::get_duration_us() const {
+    return events.empty() ? 0 : events.back().time_us - events[0].time_us;
+}
+
+uint64_t EcuReplay::get_position_us() const {
+    return next_event == 0 ? 0 : events[next_event - 1].time_us - events[0].time_us;
+}
+
+// =============================================================================
+// C API
+// =============================================================================
+
+void* ecu_replay_create(void) {
+    return new EcuReplay();
+}
+
+void ecu_replay_destroy(void* replay) {
+    delete (EcuReplay*)replay;
+}
+
+int ecu_replay_load(void* replay, const char* path) {
+    return ((EcuReplay*)replay)->load(path) ? 1 : 0;
+}
+
+void ecu_replay_start(void* replay, void* stream, double speed) {
+    ((EcuReplay*)replay)->start((EcuStreamDecoder*)stream, speed);
+}
+
+size_t ecu_replay_advance(void* replay, uint64_t host_elapsed_us) {
+    return ((EcuReplay*)replay)->advance(host_elapsed_us);
+}
+
+int ecu_replay_finished(void* replay) {
+    return ((EcuReplay*)replay)->finished() ? 1 : 0;
+}
+
+uint64_t ecu_replay_duration_us(void* replay) {
+    return ((EcuReplay*)replay)->get_duration_us();
+}
+
+uint64_t ecu_replay_position_us(void* replay) {
+    return ((EcuReplay*)replay)->get_position_us();
+}
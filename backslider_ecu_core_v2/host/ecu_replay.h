@@ -0,0 +1,104 @@
+// ecu_replay.h
+// Paced replay of recorded ECU sessions into an EcuStreamDecoder
+
+/* =============================================================================
+ * ECU REPLAY OVERVIEW
+ * =============================================================================
+ *
+ * Two kinds of recording play back through the same decoder a live port
+ * feeds, so tools cannot tell a replay from the car:
+ *
+ * - Serial captures: the raw bytes read from a bridge, legacy or v2, as
+ *   written by any logger (ecu_stream.py record()). On load the capture is
+ *   decoded once to find where each frame ends and when it was published.
+ *   Playback feeds the original bytes up to the last frame that is due, so
+ *   telemetry blocks and link negotiation replay exactly.
+ * - SD logs: LOGnnnnn.BSL files from sd_logger.h, detected by the block
+ *   magic. Each record is delivered as a message.
+ *
+ * Pacing follows the publish stamps (ecu_time.h), unwrapped to 64 bits: a
+ * frame is due once its stamp minus the first stamp is at most the host
+ * time since start() times the speed. speed = 4 plays four times faster;
+ * speed <= 0 delivers everything on the next advance(). A stamp that steps
+ * back (an ECU reset, or a lower-priority message published earlier) is
+ * played at once rather than seen as a 71-minute wrap.
+ *
+ * EXAMPLE:
+ *   EcuReplay replay;
+ *   if (replay.load("LOG00012.BSL")) {
+ *       replay.start(&decoder, 10.0);
+ *       while (!replay.finished()) {
+ *           replay.advance(host_us_since_start());
+ *           redraw(decoder);
+ *       }
+ *   }
+ * =============================================================================
+ */
+
+#ifndef ECU_REPLAY_H
+#define ECU_REPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "ecu_stream.h"
+
+class EcuReplay {
+public:
+    EcuReplay();
+
+    // SD log or serial capture; false if unreadable or nothing decodes
+    bool load(const char* path);
+    bool load_bytes(const uint8_t* data, size_t length);
+
+    // Rewind and play into target
+    void start(EcuStreamDecoder* target, double speed);
+
+    // Deliver everything due host_elapsed_us after start(); returns frames
+    // (captures) or messages (SD logs) delivered
+    size_t advance(uint64_t host_elapsed_us);
+
+    bool finished() const { return next_event >= events.size(); }
+    bool is_sd_log() const { return sd_log; }
+    size_t get_event_count() const { return events.size(); }
+    uint64_t get_duration_us() const;
+    uint64_t get_position_us() const;   // Session time of the last event delivered
+
+private:
+    struct Event {
+        uint64_t time_us;               // Unwrapped publish stamp
+        uint64_t end;                   // Capture: byte offset after the frame; SD log: message index
+    };
+
+    bool index_sd_log();
+    bool index_capture();
+    void add_event(uint32_t timestamp_us, uint64_t end);
+    static void capture_frame(uint32_t timestamp_us, uint64_t end_offset, void* context);
+
+    std::vector<uint8_t> bytes;
+    std::vector<CANMessage> messages;
+    std::vector<Event> events;
+    bool sd_log;
+
+    EcuStreamDecoder* target;
+    double speed;
+    size_t next_event;
+    uint64_t bytes_fed;
+};
+
+// =============================================================================
+// C API (ecu_stream.py)
+// =============================================================================
+
+extern "C" {
+    void* ecu_replay_create(void);
+    void ecu_replay_destroy(void* replay);
+    int ecu_replay_load(void* replay, const char* path);
+    void ecu_replay_start(void* replay, void* stream, double speed);
+    size_t ecu_replay_advance(void* replay, uint64_t host_elapsed_us);
+    int ecu_replay_finished(void* replay);
+    uint64_t ecu_replay_duration_us(void* replay);
+    uint64_t ecu_replay_position_us(void* replay);
+}
+
+#endif
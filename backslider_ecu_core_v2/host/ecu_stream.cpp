@@ -0,0 +1,415 @@
+// ecu_stream.cpp
+// Legacy and v2 frame parsing, telemetry blocks and channel buffers
+
+#include "ecu_stream.h"
+#include <string.h>
+#include <math.h>
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static uint32_t read_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Returns bytes used, 0 if the varint runs off the end or past 32 bits
+static size_t read_zigzag_varint(const uint8_t* p, size_t length, int32_t* value) {
+    uint32_t zz = 0;
+    for (size_t i = 0; i < length && i < 5; i++) {
+        zz |= (uint32_t)(p[i] & 0x7F) << (7 * i);
+        if (!(p[i] & 0x80)) {
+            *value = (int32_t)(zz >> 1) ^ -(int32_t)(zz & 1);
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+// =============================================================================
+// DECODER
+// =============================================================================
+
+EcuStreamDecoder::EcuStreamDecoder()
+    : handler(nullptr), handler_context(nullptr), frame_hook(nullptr), frame_hook_context(nullptr) {
+    reset();
+}
+
+void EcuStreamDecoder::reset() {
+    link_version = SERIAL_LINK_VERSION_LEGACY;
+    pending.clear();
+    span_offset = 0;
+    last_timestamp_us = 0;
+    have_timestamp = false;
+    have_sequence = false;
+    last_sequence = 0;
+    telemetry_clear();
+    channels.clear();
+    channel_index.clear();
+    memset(&stats, 0, sizeof(stats));
+}
+
+void EcuStreamDecoder::set_link_version(uint8_t version) {
+    // A frame started in the old format is garbage in the new one
+    pending.clear();
+    switch_link(version);
+}
+
+// The rest of the span being parsed is read in the new format
+void EcuStreamDecoder::switch_link(uint8_t version) {
+    if (version != link_version) {
+        have_sequence = false;
+    }
+    link_version = version;
+}
+
+size_t EcuStreamDecoder::feed(const uint8_t* data, size_t length) {
+    uint32_t before = stats.messages;
+    uint64_t stream_start = stats.bytes;
+    stats.bytes += length;
+    size_t pos = 0;
+
+    // Finish a split frame with just enough new bytes, then go back to
+    // parsing the caller's buffer in place
+    while (!pending.empty() && pos < length) {
+        size_t held = pending.size();
+        size_t take = length - pos;
+        size_t frame_max = (link_version == SERIAL_LINK_VERSION_FRAMED) ? SERIAL_LINK_MAX_ENCODED + 1
+                                                                         : 2 + ECU_STREAM_LEGACY_FRAME;
+        if (take > frame_max) {
+            take = frame_max;
+        }
+        pending.insert(pending.end(), data + pos, data + pos + take);
+        span_offset = stream_start + pos - held;
+        size_t used = parse_span(pending.data(), pending.size());
+        if (used >= held) {
+            pos += used - held;
+            pending.clear();
+        } else {
+            pending.erase(pending.begin(), pending.begin() + used);
+            pos += take;
+        }
+    }
+
+    if (pos < length) {
+        span_offset = stream_start + pos;
+        size_t used = parse_span(data + pos, length - pos);
+        pending.assign(data + pos + used, data + length);
+    }
+    return stats.messages - before;
+}
+
+// Everything up to the start of an incomplete frame is consumed
+size_t EcuStreamDecoder::parse_span(const uint8_t* span, size_t length) {
+    size_t pos = 0;
+    while (pos < length) {
+        if (link_version == SERIAL_LINK_VERSION_FRAMED) {
+            const uint8_t* delimiter = (const uint8_t*)memchr(span + pos, 0x00, length - pos);
+            if (!delimiter) {
+                if (length - pos > SERIAL_LINK_MAX_ENCODED) {
+                    stats.parse_errors++;       // No frame is this long: resync on the next 0x00
+                    pos = length;
+                }
+                break;
+            }
+            size_t encoded = delimiter - (span + pos);
+            if (encoded > 0) {
+                decode_link_frame(span + pos, encoded, span_offset + (delimiter - span) + 1);
+            }
+            pos += encoded + 1;
+            continue;
+        }
+
+        // Legacy: hunt for the prefix; text between frames is skipped
+        if (span[pos] != 0xFF || (pos + 1 < length && span[pos + 1] != 0xFF)) {
+            pos++;
+            continue;
+        }
+        if (length - pos < 2 + ECU_STREAM_LEGACY_FRAME) {
+            break;
+        }
+        if (decode_legacy_frame(span + pos + 2, span_offset + pos + 2 + ECU_STREAM_LEGACY_FRAME)) {
+            pos += 2 + ECU_STREAM_LEGACY_FRAME;
+        } else {
+            pos++;
+        }
+    }
+    return pos;
+}
+
+bool EcuStreamDecoder::decode_legacy_frame(const uint8_t* wire, uint64_t end_offset) {
+    uint8_t len = wire[ECU_STREAM_LEGACY_OFFSET_LEN];
+    if (len > 8) {
+        stats.parse_errors++;
+        return false;
+    }
+    CANMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.id = read_u32(&wire[ECU_STREAM_LEGACY_OFFSET_ID]);
+    msg.len = len;
+    memcpy(msg.buf, &wire[ECU_STREAM_LEGACY_OFFSET_BUF], len);
+    msg.flags.extended = wire[ECU_STREAM_LEGACY_OFFSET_EXTENDED] != 0;
+    msg.flags.remote = wire[ECU_STREAM_LEGACY_OFFSET_REMOTE] != 0;
+
+    // Nearest full stamp to the previous one with these low 16 bits
+    uint16_t stamp = wire[ECU_STREAM_LEGACY_OFFSET_TIMESTAMP] | (wire[ECU_STREAM_LEGACY_OFFSET_TIMESTAMP + 1] << 8);
+    msg.timestamp_us = have_timestamp ? last_timestamp_us + (int16_t)(stamp - (uint16_t)last_timestamp_us) : stamp;
+    msg.timestamp = stamp;
+
+    deliver(msg);
+    if (frame_hook) {
+        frame_hook(msg.timestamp_us, end_offset, frame_hook_context);
+    }
+    return true;
+}
+
+void EcuStreamDecoder::decode_link_frame(const uint8_t* encoded, size_t length, uint64_t end_offset) {
+    if (length > sizeof(frame)) {
+        stats.parse_errors++;
+        return;
+    }
+    memcpy(frame, encoded, length);
+    size_t decoded = serial_link_cobs_decode(frame, length);
+    if (decoded < 3) {
+        stats.crc_errors++;
+        return;
+    }
+    size_t end = decoded - 2;
+    uint16_t crc = frame[end] | (frame[end + 1] << 8);
+    if (crc != serial_link_crc16(frame, end)) {
+        stats.crc_errors++;
+        return;
+    }
+    stats.frames++;
+
+    uint8_t sequence = frame[0];
+    if (have_sequence && sequence != (uint8_t)(last_sequence + 1)) {
+        stats.frames_lost += (uint8_t)(sequence - last_sequence - 1);
+        telemetry_synced = false;
+    }
+    have_sequence = true;
+    last_sequence = sequence;
+
+    uint32_t timestamp_us = last_timestamp_us;
+    for (size_t pos = 1; pos < end; ) {
+        if (end - pos < SERIAL_LINK_RECORD_HEADER) {
+            stats.parse_errors++;
+            break;
+        }
+        const uint8_t* record = &frame[pos];
+        uint8_t ctl = record[4];
+        timestamp_us = read_u32(&record[5]);
+        size_t data_pos = pos + SERIAL_LINK_RECORD_HEADER;
+        size_t len = ctl & SERIAL_LINK_CTL_LEN_MASK;
+        if (ctl & SERIAL_LINK_CTL_BLOCK) {
+            len = (data_pos < end) ? frame[data_pos++] : end;
+        }
+        if (data_pos + len > end || (!(ctl & SERIAL_LINK_CTL_BLOCK) && len > 8)) {
+            stats.parse_errors++;
+            break;
+        }
+
+        if (ctl & SERIAL_LINK_CTL_BLOCK) {
+            last_timestamp_us = timestamp_us;
+            have_timestamp = true;
+            if (read_u32(record) == MSG_SERIAL_TELEMETRY_FRAME) {
+                decode_telemetry_block(timestamp_us, &frame[data_pos], len);
+            }
+        } else {
+            CANMessage msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.id = read_u32(record);
+            msg.len = (uint8_t)len;
+            memcpy(msg.buf, &frame[data_pos], len);
+            msg.flags.extended = (ctl & SERIAL_LINK_CTL_EXTENDED) != 0;
+            msg.flags.remote = (ctl & SERIAL_LINK_CTL_REMOTE) != 0;
+            msg.timestamp_us = timestamp_us;
+            msg.timestamp = (uint16_t)timestamp_us;
+            deliver(msg);
+        }
+        pos = data_pos + len;
+    }
+
+    if (frame_hook) {
+        frame_hook(timestamp_us, end_offset, frame_hook_context);
+    }
+}
+
+void EcuStreamDecoder::decode_telemetry_block(uint32_t timestamp_us, const uint8_t* block, size_t length) {
+    if (length < 2) {
+        stats.parse_errors++;
+        return;
+    }
+    stats.telemetry_blocks++;
+    bool keyframe = block[0] == SERIAL_TELEMETRY_KEYFRAME;
+    if (keyframe) {
+        telemetry_synced = true;
+    } else if (!telemetry_synced) {
+        stats.telemetry_skipped++;      // Deltas from an unknown base
+        return;
+    }
+
+    for (size_t pos = 2; pos < length; ) {
+        uint8_t index = block[pos++];
+        int32_t value;
+        size_t used = read_zigzag_varint(&block[pos], length - pos, &value);
+        if (used == 0 || index >= SERIAL_TELEMETRY_MAX_CHANNELS) {
+            stats.parse_errors++;
+            return;
+        }
+        pos += used;
+        TelemetrySlot& slot = telemetry[index];
+        if (!slot.configured) {
+            stats.parse_errors++;       // The host skipped telemetry_add() for this index
+            continue;
+        }
+        slot.value_q = keyframe ? value : slot.value_q + value;
+        append_sample(slot.msg_id, timestamp_us, (float)(slot.value_q * slot.step));
+    }
+}
+
+void EcuStreamDecoder::deliver(const CANMessage& msg) {
+    stats.messages++;
+    last_timestamp_us = msg.timestamp_us;
+    have_timestamp = true;
+
+    if (msg.id == MSG_SERIAL_LINK_ACK && msg.len >= sizeof(serial_link_msg_t)) {
+        serial_link_msg_t reply;
+        memcpy(&reply, msg.buf, sizeof(reply));
+        if (reply.version == SERIAL_LINK_VERSION_LEGACY || reply.version == SERIAL_LINK_VERSION_FRAMED) {
+            switch_link(reply.version);
+        }
+    }
+
+    if (handler) {
+        handler(&msg, handler_context);
+    }
+    if (msg.len == sizeof(float) && !msg.flags.remote) {
+        float value;
+        memcpy(&value, msg.buf, sizeof(value));
+        append_sample(msg.id, msg.timestamp_us, value);
+    }
+}
+
+void EcuStreamDecoder::append_sample(uint32_t msg_id, uint32_t timestamp_us, float value) {
+    std::unordered_map<uint32_t, uint32_t>::iterator it = channel_index.find(msg_id);
+    EcuChannel* channel;
+    if (it != channel_index.end()) {
+        channel = &channels[it->second];
+    } else {
+        if (channels.size() >= ECU_STREAM_MAX_CHANNELS) {
+            return;
+        }
+        channel_index[msg_id] = (uint32_t)channels.size();
+        channels.push_back(EcuChannel());
+        channel = &channels.back();
+        channel->msg_id = msg_id;
+    }
+    channel->timestamps_us.push_back(timestamp_us);
+    channel->values.push_back(value);
+    channel->last_timestamp_us = timestamp_us;
+    channel->last_value = value;
+    stats.samples++;
+}
+
+bool EcuStreamDecoder::telemetry_add(uint8_t index, uint32_t msg_id, int8_t step_exp) {
+    if (index >= SERIAL_TELEMETRY_MAX_CHANNELS || step_exp < -6 || step_exp > 6) {
+        return false;
+    }
+    TelemetrySlot& slot = telemetry[index];
+    slot.msg_id = msg_id;
+    slot.step = pow(10.0, step_exp);
+    slot.value_q = 0;
+    slot.configured = true;
+    telemetry_synced = false;           // The ECU sends a keyframe after every ADD
+    return true;
+}
+
+void EcuStreamDecoder::telemetry_clear() {
+    memset(telemetry, 0, sizeof(telemetry));
+    telemetry_synced = false;
+}
+
+const EcuChannel* EcuStreamDecoder::channel(uint32_t msg_id) const {
+    std::unordered_map<uint32_t, uint32_t>::const_iterator it = channel_index.find(msg_id);
+    return (it != channel_index.end()) ? &channels[it->second] : nullptr;
+}
+
+void EcuStreamDecoder::consume() {
+    for (size_t i = 0; i < channels.size(); i++) {
+        channels[i].timestamps_us.clear();
+        channels[i].values.clear();
+    }
+}
+
+void EcuStreamDecoder::set_message_handler(EcuStreamHandler new_handler, void* context) {
+    handler = new_handler;
+    handler_context = context;
+}
+
+// =============================================================================
+// C API
+// =============================================================================
+
+void* ecu_stream_create(void) {
+    return new EcuStreamDecoder();
+}
+
+void ecu_stream_destroy(void* stream) {
+    delete (EcuStreamDecoder*)stream;
+}
+
+size_t ecu_stream_feed(void* stream, const uint8_t* data, size_t length) {
+    return ((EcuStreamDecoder*)stream)->feed(data, length);
+}
+
+int ecu_stream_telemetry_add(void* stream, uint8_t index, uint32_t msg_id, int8_t step_exp) {
+    return ((EcuStreamDecoder*)stream)->telemetry_add(index, msg_id, step_exp) ? 1 : 0;
+}
+
+void ecu_stream_telemetry_clear(void* stream) {
+    ((EcuStreamDecoder*)stream)->telemetry_clear();
+}
+
+uint8_t ecu_stream_link_version(void* stream) {
+    return ((EcuStreamDecoder*)stream)->get_link_version();
+}
+
+size_t ecu_stream_channel_count(void* stream) {
+    return ((EcuStreamDecoder*)stream)->get_channel_count();
+}
+
+uint32_t ecu_stream_channel_id(void* stream, size_t index) {
+    EcuStreamDecoder* decoder = (EcuStreamDecoder*)stream;
+    return (index < decoder->get_channel_count()) ? decoder->get_channel_at(index).msg_id : 0;
+}
+
+size_t ecu_stream_samples(void* stream, uint32_t msg_id, const uint32_t** timestamps_us, const float** values) {
+    const EcuChannel* channel = ((EcuStreamDecoder*)stream)->channel(msg_id);
+    if (!channel || channel->values.empty()) {
+        *timestamps_us = nullptr;
+        *values = nullptr;
+        return 0;
+    }
+    *timestamps_us = channel->timestamps_us.data();
+    *values = channel->values.data();
+    return channel->values.size();
+}
+
+int ecu_stream_latest(void* stream, uint32_t msg_id, uint32_t* timestamp_us, float* value) {
+    const EcuChannel* channel = ((EcuStreamDecoder*)stream)->channel(msg_id);
+    if (!channel) {
+        return 0;
+    }
+    *timestamp_us = channel->last_timestamp_us;
+    *value = channel->last_value;
+    return 1;
+}
+
+void ecu_stream_consume(void* stream) {
+    ((EcuStreamDecoder*)stream)->consume();
+}
+
+void ecu_stream_get_stats(void* stream, ecu_stream_stats_t* stats) {
+    *stats = ((EcuStreamDecoder*)stream)->get_stats();
+}
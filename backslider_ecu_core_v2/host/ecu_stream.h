@@ -0,0 +1,192 @@
+// ecu_stream.h
+// Host-side decoder for ECU serial streams (desktop tools only)
+
+/* =============================================================================
+ * ECU STREAM OVERVIEW
+ * =============================================================================
+ *
+ * Dashboards and loggers on the PC read the same bytes the serial bridges
+ * write (external_serial.h). EcuStreamDecoder turns them into one typed
+ * buffer per channel:
+ *
+ *   port bytes ──feed()──► legacy frames / v2 frames ──► records
+ *                                                         ├─► float channels
+ *                                                         │   (4-byte messages)
+ *                                                         ├─► telemetry blocks
+ *                                                         │   (decoded into the
+ *                                                         │    same channels)
+ *                                                         └─► message handler
+ *
+ * feed() takes any chunking. Frames are parsed where they lie in the
+ * caller's buffer; only a frame split across two reads is copied, and a v2
+ * frame is COBS-decoded once into a scratch buffer. Samples are appended
+ * to per-channel arrays (timestamps_us[], values[]) that callers - and the
+ * Python bindings - read in place, then consume() when done.
+ *
+ * FORMATS:
+ * - Legacy: 0xFF 0xFF and the Teensy's CAN_message_t (ECU_STREAM_LEGACY_*
+ *   offsets). Only the low 16 bits of the publish stamp are on the wire;
+ *   the decoder takes the full stamp nearest the previous one, which is
+ *   exact while messages arrive less than 32 ms apart.
+ * - v2: starts when the ECU's MSG_SERIAL_LINK_ACK agrees to version 2 (an
+ *   ACK back to version 1 returns to legacy). Records carry the full 32-bit
+ *   publish stamp (ecu_time.h). Sequence gaps are counted in frames_lost.
+ * - Telemetry: the decoder cannot see what the host sent, so mirror every
+ *   TELEMETRY_OP_ADD with telemetry_add(). Delta blocks only list channels
+ *   that moved; after a sequence gap, deltas are skipped until the next
+ *   keyframe.
+ *
+ * Every 4-byte message is taken as a float channel (MSG_PACK_FLOAT); other
+ * messages only reach the handler. Channel arrays are valid until the next
+ * feed(), deliver() or consume().
+ *
+ * The C API at the bottom is what ecu_stream.py loads with ctypes.
+ *
+ * EXAMPLE:
+ *   EcuStreamDecoder decoder;
+ *   decoder.feed(bytes, count);
+ *   const EcuChannel* rpm = decoder.channel(MSG_ENGINE_RPM);
+ *   if (rpm && !rpm->values.empty()) plot(rpm->timestamps_us, rpm->values);
+ *   decoder.consume();
+ * =============================================================================
+ */
+
+#ifndef ECU_STREAM_H
+#define ECU_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <unordered_map>
+#include "../msg_definitions.h"
+#include "../serial_link.h"
+
+// Legacy frame after the 0xFF 0xFF prefix: FlexCAN_T4 CAN_message_t as the
+// Teensy lays it out in memory (not the desktop CANFrame)
+#define ECU_STREAM_LEGACY_FRAME             24
+#define ECU_STREAM_LEGACY_OFFSET_ID         0
+#define ECU_STREAM_LEGACY_OFFSET_TIMESTAMP  4       // uint16_t
+#define ECU_STREAM_LEGACY_OFFSET_EXTENDED   7       // flags.extended
+#define ECU_STREAM_LEGACY_OFFSET_REMOTE     8       // flags.remote
+#define ECU_STREAM_LEGACY_OFFSET_LEN        11
+#define ECU_STREAM_LEGACY_OFFSET_BUF        12
+
+#define ECU_STREAM_MAX_CHANNELS             1024    // Later IDs reach the handler only
+
+typedef struct {
+    uint64_t bytes;             // Everything fed
+    uint32_t messages;          // Legacy frames and v2 records decoded
+    uint32_t frames;            // v2 frames that passed their CRC
+    uint32_t crc_errors;        // v2 frames dropped whole
+    uint32_t parse_errors;      // Malformed frames, records or telemetry entries
+    uint32_t frames_lost;       // Gaps in the v2 sequence
+    uint32_t telemetry_blocks;
+    uint32_t telemetry_skipped; // Delta blocks waiting for a keyframe
+    uint32_t samples;           // Appended to channels
+} ecu_stream_stats_t;
+
+struct EcuChannel {
+    uint32_t msg_id;
+    std::vector<uint32_t> timestamps_us;    // Publish stamps, since the last consume()
+    std::vector<float> values;
+    uint32_t last_timestamp_us;             // Newest sample, kept across consume()
+    float last_value;
+};
+
+typedef void (*EcuStreamHandler)(const CANMessage* msg, void* context);
+
+class EcuStreamDecoder {
+public:
+    EcuStreamDecoder();
+
+    // Back to legacy with no channels, telemetry table or statistics
+    void reset();
+
+    // Bytes as read from the port; returns messages decoded
+    size_t feed(const uint8_t* data, size_t length);
+
+    // One already-decoded message (SD logs, tests); timestamp_us must be set
+    void deliver(const CANMessage& msg);
+
+    // Mirror of the host's MSG_SERIAL_TELEMETRY_CONFIG requests
+    bool telemetry_add(uint8_t index, uint32_t msg_id, int8_t step_exp);
+    void telemetry_clear();
+
+    uint8_t get_link_version() const { return link_version; }
+    void set_link_version(uint8_t version);
+
+    // Channels in order of first appearance
+    size_t get_channel_count() const { return channels.size(); }
+    const EcuChannel& get_channel_at(size_t index) const { return channels[index]; }
+    const EcuChannel* channel(uint32_t msg_id) const;
+
+    // Drop buffered samples; channels and last values stay
+    void consume();
+
+    // Every decoded message, before it is sorted into channels
+    void set_message_handler(EcuStreamHandler handler, void* context);
+
+    const ecu_stream_stats_t& get_stats() const { return stats; }
+
+private:
+    friend class EcuReplay;
+
+    void switch_link(uint8_t version);
+    size_t parse_span(const uint8_t* span, size_t length);
+    bool decode_legacy_frame(const uint8_t* frame, uint64_t end_offset);
+    void decode_link_frame(const uint8_t* encoded, size_t length, uint64_t end_offset);
+    void decode_telemetry_block(uint32_t timestamp_us, const uint8_t* block, size_t length);
+    void append_sample(uint32_t msg_id, uint32_t timestamp_us, float value);
+
+    uint8_t link_version;
+    std::vector<uint8_t> pending;       // Start of a frame split across feeds
+    uint64_t span_offset;               // Stream offset of the span being parsed
+    uint32_t last_timestamp_us;         // For unwrapping legacy 16-bit stamps
+    bool have_timestamp;
+    bool have_sequence;
+    uint8_t last_sequence;
+    uint8_t frame[SERIAL_LINK_MAX_ENCODED];
+
+    struct TelemetrySlot {
+        uint32_t msg_id;
+        double step;                    // 10^step_exp
+        int32_t value_q;
+        bool configured;
+    };
+    TelemetrySlot telemetry[SERIAL_TELEMETRY_MAX_CHANNELS];
+    bool telemetry_synced;              // A keyframe arrived since the last gap
+
+    std::vector<EcuChannel> channels;
+    std::unordered_map<uint32_t, uint32_t> channel_index;
+
+    EcuStreamHandler handler;
+    void* handler_context;
+
+    // Replay indexing: called after every complete frame
+    void (*frame_hook)(uint32_t timestamp_us, uint64_t end_offset, void* context);
+    void* frame_hook_context;
+
+    ecu_stream_stats_t stats;
+};
+
+// =============================================================================
+// C API (ecu_stream.py)
+// =============================================================================
+
+extern "C" {
+    void* ecu_stream_create(void);
+    void ecu_stream_destroy(void* stream);
+    size_t ecu_stream_feed(void* stream, const uint8_t* data, size_t length);
+    int ecu_stream_telemetry_add(void* stream, uint8_t index, uint32_t msg_id, int8_t step_exp);
+    void ecu_stream_telemetry_clear(void* stream);
+    uint8_t ecu_stream_link_version(void* stream);
+    size_t ecu_stream_channel_count(void* stream);
+    uint32_t ecu_stream_channel_id(void* stream, size_t index);
+    // Pointers into the channel arrays; returns the sample count (0 if unknown)
+    size_t ecu_stream_samples(void* stream, uint32_t msg_id, const uint32_t** timestamps_us, const float** values);
+    int ecu_stream_latest(void* stream, uint32_t msg_id, uint32_t* timestamp_us, float* value);
+    void ecu_stream_consume(void* stream);
+    void ecu_stream_get_stats(void* stream, ecu_stream_stats_t* stats);
+}
+
+#endif
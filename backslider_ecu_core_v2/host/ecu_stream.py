@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""
+ctypes bindings for libecu_stream.so - the C++ stream decoder and replay
+(ecu_stream.h, ecu_replay.h). Build the library with `make` in this directory.
+
+Decoding happens in C++; Python only sees the per-channel sample arrays,
+as memoryviews over the decoder's own buffers (no copies). They stay valid
+until the next feed() or consume().
+
+    stream = EcuStream()
+    while running:
+        stream.feed(port.read(port.in_waiting or 1))
+        for msg_id in stream.channel_ids():
+            stamps_us, values = stream.samples(msg_id)
+            plot(msg_id, stamps_us, values)
+        stream.consume()
+
+    replay = EcuReplay("LOG00012.BSL")
+    replay.run(stream, speed=4.0, on_tick=redraw)
+"""
+
+import ctypes
+import os
+import time
+from typing import Callable, List, Optional, Tuple
+
+LINK_VERSION_LEGACY = 1
+LINK_VERSION_FRAMED = 2
+
+_LIBRARY = os.path.join(os.path.dirname(os.path.abspath(__file__)), "libecu_stream.so")
+
+
+class StreamStats(ctypes.Structure):
+    """Mirror of ecu_stream_stats_t"""
+    _fields_ = [
+        ("bytes", ctypes.c_uint64),
+        ("messages", ctypes.c_uint32),
+        ("frames", ctypes.c_uint32),
+        ("crc_errors", ctypes.c_uint32),
+        ("parse_errors", ctypes.c_uint32),
+        ("frames_lost", ctypes.c_uint32),
+        ("telemetry_blocks", ctypes.c_uint32),
+        ("telemetry_skipped", ctypes.c_uint32),
+        ("samples", ctypes.c_uint32),
+    ]
+
+
+def _load_library() -> ctypes.CDLL:
+    lib = ctypes.CDLL(_LIBRARY)
+    handle = ctypes.c_void_p
+    lib.ecu_stream_create.restype = handle
+    lib.ecu_stream_destroy.argtypes = [handle]
+    lib.ecu_stream_feed.argtypes = [handle, ctypes.c_char_p, ctypes.c_size_t]
+    lib.ecu_stream_feed.restype = ctypes.c_size_t
+    lib.ecu_stream_telemetry_add.argtypes = [handle, ctypes.c_uint8, ctypes.c_uint32, ctypes.c_int8]
+    lib.ecu_stream_telemetry_clear.argtypes = [handle]
+    lib.ecu_stream_link_version.argtypes = [handle]
+    lib.ecu_stream_link_version.restype = ctypes.c_uint8
+    lib.ecu_stream_channel_count.argtypes = [handle]
+    lib.ecu_stream_channel_count.restype = ctypes.c_size_t
+    lib.ecu_stream_channel_id.argtypes = [handle, ctypes.c_size_t]
+    lib.ecu_stream_channel_id.restype = ctypes.c_uint32
+    lib.ecu_stream_samples.argtypes = [handle, ctypes.c_uint32,
+                                       ctypes.POINTER(ctypes.POINTER(ctypes.c_uint32)),
+                                       ctypes.POINTER(ctypes.POINTER(ctypes.c_float))]
+    lib.ecu_stream_samples.restype = ctypes.c_size_t
+    lib.ecu_stream_latest.argtypes = [handle, ctypes.c_uint32,
+                                      ctypes.POINTER(ctypes.c_uint32), ctypes.POINTER(ctypes.c_float)]
+    lib.ecu_stream_consume.argtypes = [handle]
+    lib.ecu_stream_get_stats.argtypes = [handle, ctypes.POINTER(StreamStats)]
+
+    lib.ecu_replay_create.restype = handle
+    lib.ecu_replay_destroy.argtypes = [handle]
+    lib.ecu_replay_load.argtypes = [handle, ctypes.c_char_p]
+    lib.ecu_replay_start.argtypes = [handle, handle, ctypes.c_double]
+    lib.ecu_replay_advance.argtypes = [handle, ctypes.c_uint64]
+    lib.ecu_replay_advance.restype = ctypes.c_size_t
+    lib.ecu_replay_finished.argtypes = [handle]
+    lib.ecu_replay_duration_us.argtypes = [handle]
+    lib.ecu_replay_duration_us.restype = ctypes.c_uint64
+    lib.ecu_replay_position_us.argtypes = [handle]
+    lib.ecu_replay_position_us.restype = ctypes.c_uint64
+    return lib
+
+
+_lib = _load_library()
+
+
+class EcuStream:
+    """Decoder for the bytes a serial bridge writes (legacy or link v2)"""
+
+    def __init__(self):
+        self._handle = _lib.ecu_stream_create()
+
+    def __del__(self):
+        if getattr(self, "_handle", None):
+            _lib.ecu_stream_destroy(self._handle)
+            self._handle = None
+
+    def feed(self, data: bytes) -> int:
+        """Decode bytes read from the port; returns messages decoded"""
+        return _lib.ecu_stream_feed(self._handle, bytes(data), len(data))
+
+    def telemetry_add(self, index: int, msg_id: int, step_exp: int) -> bool:
+        """Mirror a TELEMETRY_OP_ADD the host sent to the ECU"""
+        return bool(_lib.ecu_stream_telemetry_add(self._handle, index, msg_id, step_exp))
+
+    def telemetry_clear(self):
+        _lib.ecu_stream_telemetry_clear(self._handle)
+
+    @property
+    def link_version(self) -> int:
+        return _lib.ecu_stream_link_version(self._handle)
+
+    def channel_ids(self) -> List[int]:
+        return [_lib.ecu_stream_channel_id(self._handle, i)
+                for i in range(_lib.ecu_stream_channel_count(self._handle))]
+
+    def samples(self, msg_id: int) -> Tuple[memoryview, memoryview]:
+        """(publish stamps in µs, float values) since the last consume(), zero-copy"""
+        stamps = ctypes.POINTER(ctypes.c_uint32)()
+        values = ctypes.POINTER(ctypes.c_float)()
+        count = _lib.ecu_stream_samples(self._handle, msg_id, ctypes.byref(stamps), ctypes.byref(values))
+        if count == 0:
+            return memoryview(b"").cast("I"), memoryview(b"").cast("f")
+        stamp_array = (ctypes.c_uint32 * count).from_address(ctypes.addressof(stamps.contents))
+        value_array = (ctypes.c_float * count).from_address(ctypes.addressof(values.contents))
+        return memoryview(stamp_array).cast("B").cast("I"), memoryview(value_array).cast("B").cast("f")
+
+    def latest(self, msg_id: int) -> Optional[Tuple[int, float]]:
+        """Newest (stamp, value) of a channel, kept across consume()"""
+        stamp = ctypes.c_uint32()
+        value = ctypes.c_float()
+        if not _lib.ecu_stream_latest(self._handle, msg_id, ctypes.byref(stamp), ctypes.byref(value)):
+            return None
+        return stamp.value, value.value
+
+    def consume(self):
+        """Drop buffered samples; invalidates views from samples()"""
+        _lib.ecu_stream_consume(self._handle)
+
+    def stats(self) -> dict:
+        stats = StreamStats()
+        _lib.ecu_stream_get_stats(self._handle, ctypes.byref(stats))
+        return {name: getattr(stats, name) for name, _ in StreamStats._fields_}
+
+
+class EcuReplay:
+    """A serial capture or SD log (.BSL) played back into an EcuStream"""
+
+    def __init__(self, path: str):
+        self._handle = _lib.ecu_replay_create()
+        if not _lib.ecu_replay_load(self._handle, path.encode()):
+            raise ValueError(f"Nothing to replay in {path}")
+
+    def __del__(self):
+        if getattr(self, "_handle", None):
+            _lib.ecu_replay_destroy(self._handle)
+            self._handle = None
+
+    @property
+    def duration_s(self) -> float:
+        return _lib.ecu_replay_duration_us(self._handle) / 1e6
+
+    @property
+    def position_s(self) -> float:
+        return _lib.ecu_replay_position_us(self._handle) / 1e6
+
+    def start(self, stream: EcuStream, speed: float = 1.0):
+        """Rewind; speed <= 0 plays everything on the next advance()"""
+        self._stream = stream       # The C++ side keeps only a pointer
+        _lib.ecu_replay_start(self._handle, stream._handle, speed)
+
+    def advance(self, host_elapsed_s: float) -> int:
+        """Deliver everything due host_elapsed_s after start()"""
+        return _lib.ecu_replay_advance(self._handle, int(host_elapsed_s * 1e6))
+
+    @property
+    def finished(self) -> bool:
+        return bool(_lib.ecu_replay_finished(self._handle))
+
+    def run(self, stream: EcuStream, speed: float = 1.0, on_tick: Optional[Callable[[EcuStream], None]] = None,
+            tick_s: float = 0.02):
+        """Play to the end in real time / speed, calling on_tick after each batch"""
+        self.start(stream, speed)
+        started = time.monotonic()
+        while not self.finished:
+            if self.advance(time.monotonic() - started) and on_tick:
+                on_tick(stream)
+            time.sleep(tick_s)
+
+
+def record(port, path: str, duration_s: float, stream: Optional[EcuStream] = None):
+    """Write everything read from a pyserial port to a capture EcuReplay can play"""
+    deadline = time.monotonic() + duration_s
+    with open(path, "wb") as capture:
+        while time.monotonic() < deadline:
+            data = port.read(port.in_waiting or 1)
+            if data:
+                capture.write(data)
+                if stream:
+                    stream.feed(data)
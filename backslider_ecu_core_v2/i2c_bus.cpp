@@ -0,0 +1,462 @@
+// i2c_bus.cpp
+// Per-bus transaction queues driven by the LPI2C master interrupt
+
+#include "i2c_bus.h"
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include "tests/mock_arduino.h"
+    #include <string.h>
+#endif
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+typedef struct {
+    uint8_t address;
+    uint8_t write_length;
+    uint8_t read_length;
+    volatile uint8_t done;                  // 1 = finished, result is valid
+    volatile uint8_t result;                // i2c_result_t
+    uint8_t write_data[I2C_BUS_MAX_WRITE];
+    uint8_t read_data[I2C_BUS_MAX_READ];
+    i2c_bus_callback_t callback;
+    void* context;
+} i2c_transaction_t;
+
+// Queue counters run freely; slots are counter % I2C_BUS_QUEUE_DEPTH.
+// deliver <= start <= submit: delivered, started (done or running), queued.
+typedef struct {
+    i2c_transaction_t queue[I2C_BUS_QUEUE_DEPTH];
+    uint8_t submit_index;
+    volatile uint8_t start_index;
+    uint8_t deliver_index;
+    volatile uint8_t running;               // queue[start_index - 1] is on the wire
+    volatile uint8_t claimed;               // Blocking Wire user holds the bus
+    uint8_t begun;
+    uint32_t started_us;
+
+    // Progress of the running transaction (ISR side)
+    uint16_t commands[I2C_BUS_MAX_WRITE + 4];
+    uint8_t command_count;
+    uint8_t command_pos;
+    uint8_t rx_pos;
+    uint8_t result;
+
+    i2c_bus_stats_t stats;
+    #ifndef ARDUINO
+    uint32_t mock_event;                    // Pending completion on the virtual clock
+    #endif
+} i2c_bus_state_t;
+
+static i2c_bus_state_t buses[I2C_BUS_COUNT];
+
+#ifndef ARDUINO
+#define I2C_MOCK_MAX_DEVICES 8
+
+typedef struct {
+    uint8_t address;
+    i2c_mock_device_t device;
+} i2c_mock_slot_t;
+
+static i2c_mock_slot_t mock_devices[I2C_BUS_COUNT][I2C_MOCK_MAX_DEVICES];
+#endif
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static inline void lock(void) {
+    #ifdef ARDUINO
+    noInterrupts();
+    #endif
+}
+
+static inline void unlock(void) {
+    #ifdef ARDUINO
+    interrupts();
+    #endif
+}
+
+static inline i2c_transaction_t* running_transaction(i2c_bus_state_t* b) {
+    return &b->queue[(uint8_t)(b->start_index - 1) % I2C_BUS_QUEUE_DEPTH];
+}
+
+static void start_hardware(uint8_t bus, i2c_transaction_t* t);
+static void abort_hardware(uint8_t bus);
+
+static void start_next(uint8_t bus);
+
+// Called with the bus locked (or from its ISR)
+static void finish_running(uint8_t bus, i2c_result_t result) {
+    i2c_bus_state_t* b = &buses[bus];
+    i2c_transaction_t* t = running_transaction(b);
+    t->result = (uint8_t)result;
+    t->done = 1;
+    b->running = 0;
+    start_next(bus);
+}
+
+static void start_next(uint8_t bus) {
+    i2c_bus_state_t* b = &buses[bus];
+    if (b->running || b->claimed || b->start_index == b->submit_index) {
+        return;
+    }
+    #ifdef ARDUINO
+    if (!b->begun) {
+        return;
+    }
+    #endif
+    i2c_transaction_t* t = &b->queue[b->start_index % I2C_BUS_QUEUE_DEPTH];
+    b->start_index++;
+    b->running = 1;
+    b->result = I2C_RESULT_OK;
+    b->started_us = micros();
+    start_hardware(bus, t);
+}
+
+#ifdef ARDUINO
+
+static IMXRT_LPI2C_t* const lpi2c_ports[I2C_BUS_COUNT] = { &IMXRT_LPI2C1, &IMXRT_LPI2C3, &IMXRT_LPI2C4 };
+static const IRQ_NUMBER_t lpi2c_irqs[I2C_BUS_COUNT] = { IRQ_LPI2C1, IRQ_LPI2C3, IRQ_LPI2C4 };
+
+#define LPI2C_TX_FIFO_WORDS     4
+#define LPI2C_ERROR_FLAGS       (LPI2C_MSR_NDF | LPI2C_MSR_ALF | LPI2C_MSR_FEF | LPI2C_MSR_PLTF)
+
+// Keep the transmit FIFO topped up; stop asking once every command is in
+static void feed_commands(uint8_t bus) {
+    i2c_bus_state_t* b = &buses[bus];
+    IMXRT_LPI2C_t* port = lpi2c_ports[bus];
+    while (b->command_pos < b->command_count && (port->MFSR & 0x7) < LPI2C_TX_FIFO_WORDS) {
+        port->MTDR = b->commands[b->command_pos++];
+    }
+    if (b->command_pos >= b->command_count) {
+        port->MIER &= ~LPI2C_MIER_TDIE;
+    }
+}
+
+static void start_hardware(uint8_t bus, i2c_transaction_t* t) {
+    i2c_bus_state_t* b = &buses[bus];
+    IMXRT_LPI2C_t* port = lpi2c_ports[bus];
+    uint8_t n = 0;
+
+    // Write phase (also sent alone as an address probe when nothing is read)
+    if (t->write_length > 0 || t->read_length == 0) {
+        b->commands[n++] = LPI2C_MTDR_CMD_START | (uint16_t)(t->address << 1);
+        for (uint8_t i = 0; i < t->write_length; i++) {
+            b->commands[n++] = LPI2C_MTDR_CMD_TRANSMIT | t->write_data[i];
+        }
+    }
+    // Read phase after a (repeated) START
+    if (t->read_length > 0) {
+        b->commands[n++] = LPI2C_MTDR_CMD_START | (uint16_t)((t->address << 1) | 1);
+        b->commands[n++] = LPI2C_MTDR_CMD_RECEIVE | (uint16_t)(t->read_length - 1);
+    }
+    b->commands[n++] = LPI2C_MTDR_CMD_STOP;
+    b->command_count = n;
+    b->command_pos = 0;
+    b->rx_pos = 0;
+
+    port->MCR |= LPI2C_MCR_RTF | LPI2C_MCR_RRF;
+    port->MSR = LPI2C_MSR_EPF | LPI2C_MSR_SDF | LPI2C_ERROR_FLAGS;
+    port->MIER = LPI2C_MIER_TDIE | LPI2C_MIER_RDIE | LPI2C_MIER_SDIE |
+                 LPI2C_MIER_NDIE | LPI2C_MIER_ALIE | LPI2C_MIER_FEIE | LPI2C_MIER_PLTIE;
+    feed_commands(bus);
+}
+
+static void abort_hardware(uint8_t bus) {
+    IMXRT_LPI2C_t* port = lpi2c_ports[bus];
+    port->MIER = 0;
+    port->MCR |= LPI2C_MCR_RTF | LPI2C_MCR_RRF;
+    port->MTDR = LPI2C_MTDR_CMD_STOP;
+    port->MSR = LPI2C_MSR_EPF | LPI2C_MSR_SDF | LPI2C_ERROR_FLAGS;
+}
+
+static void lpi2c_isr(uint8_t bus) {
+    i2c_bus_state_t* b = &buses[bus];
+    IMXRT_LPI2C_t* port = lpi2c_ports[bus];
+    uint32_t status = port->MSR;
+
+    if (!b->running) {
+        port->MIER = 0;
+        return;
+    }
+    i2c_transaction_t* t = running_transaction(b);
+
+    if (status & LPI2C_ERROR_FLAGS) {
+        // Drop the rest of the transaction and end it with a STOP
+        port->MSR = status & LPI2C_ERROR_FLAGS;
+        port->MCR |= LPI2C_MCR_RTF | LPI2C_MCR_RRF;
+        b->command_pos = b->command_count;
+        if (b->result == I2C_RESULT_OK) {
+            b->result = (status & LPI2C_MSR_NDF) ? I2C_RESULT_NACK : I2C_RESULT_BUS_ERROR;
+        }
+        if (status & LPI2C_MSR_ALF) {
+            // Another master owns the bus: no STOP of ours will follow
+            port->MIER = 0;
+            finish_running(bus, (i2c_result_t)b->result);
+            return;
+        }
+        port->MTDR = LPI2C_MTDR_CMD_STOP;
+        port->MIER = LPI2C_MIER_SDIE;
+    }
+
+    while ((port->MFSR >> 16) & 0x7) {
+        uint8_t value = (uint8_t)port->MRDR;
+        if (b->rx_pos < t->read_length) {
+            t->read_data[b->rx_pos++] = value;
+        }
+    }
+
+    if (status & LPI2C_MSR_TDF) {
+        feed_commands(bus);
+    }
+
+    if (status & LPI2C_MSR_SDF) {
+        port->MSR = LPI2C_MSR_SDF;
+        port->MIER = 0;
+        i2c_result_t result = (i2c_result_t)b->result;
+        if (result == I2C_RESULT_OK && b->rx_pos != t->read_length) {
+            result = I2C_RESULT_BUS_ERROR;
+        }
+        finish_running(bus, result);
+    }
+}
+
+static void lpi2c1_isr(void) { lpi2c_isr(0); }
+static void lpi2c3_isr(void) { lpi2c_isr(1); }
+static void lpi2c4_isr(void) { lpi2c_isr(2); }
+
+static void (* const lpi2c_vectors[I2C_BUS_COUNT])(void) = { lpi2c1_isr, lpi2c3_isr, lpi2c4_isr };
+
+#else
+
+static i2c_mock_device_t find_mock_device(uint8_t bus, uint8_t address) {
+    for (uint8_t i = 0; i < I2C_MOCK_MAX_DEVICES; i++) {
+        if (mock_devices[bus][i].device && mock_devices[bus][i].address == address) {
+            return mock_devices[bus][i].device;
+        }
+    }
+    return nullptr;
+}
+
+// The device answers when the transaction ends, so reads see the mocked
+// state at that moment
+static void on_mock_complete(void* context) {
+    uint8_t bus = (uint8_t)(intptr_t)context;
+    i2c_bus_state_t* b = &buses[bus];
+    b->mock_event = 0;
+    i2c_transaction_t* t = running_transaction(b);
+    i2c_mock_device_t device = find_mock_device(bus, t->address);
+    bool ack = device && device(t->address, t->write_data, t->write_length, t->read_data, t->read_length);
+    finish_running(bus, ack ? I2C_RESULT_OK : I2C_RESULT_NACK);
+}
+
+static void start_hardware(uint8_t bus, i2c_transaction_t* t) {
+    if (!mock_clock_enabled) {
+        on_mock_complete((void*)(intptr_t)bus);
+        return;
+    }
+    // Address byte per phase plus data, as on the wire
+    uint32_t bytes = ((t->write_length > 0 || t->read_length == 0) ? 1u + t->write_length : 0u) +
+                     (t->read_length > 0 ? 1u + t->read_length : 0u);
+    uint32_t wire_ns = mock_clock_costs.i2c_transaction_ns + bytes * mock_clock_costs.i2c_byte_ns;
+    buses[bus].mock_event = mock_schedule_after_us((wire_ns + 999) / 1000, on_mock_complete,
+                                                   (void*)(intptr_t)bus);
+}
+
+static void abort_hardware(uint8_t bus) {
+    if (buses[bus].mock_event != 0) {
+        mock_cancel_event(buses[bus].mock_event);
+        buses[bus].mock_event = 0;
+    }
+}
+
+#endif
+
+// Run callbacks of finished transactions in submit order. The slot is
+// released before its callback runs, so callbacks may submit again.
+static void deliver_completed(uint8_t bus) {
+    i2c_bus_state_t* b = &buses[bus];
+    while (b->deliver_index != b->start_index) {
+        i2c_transaction_t* t = &b->queue[b->deliver_index % I2C_BUS_QUEUE_DEPTH];
+        if (!t->done) {
+            break;
+        }
+        i2c_result_t result = (i2c_result_t)t->result;
+        uint8_t read_data[I2C_BUS_MAX_READ];
+        uint8_t read_length = t->read_length;
+        memcpy(read_data, t->read_data, read_length);
+        i2c_bus_callback_t callback = t->callback;
+        void* context = t->context;
+        t->done = 0;
+        b->deliver_index++;
+
+        switch (result) {
+            case I2C_RESULT_OK:      b->stats.completed++; break;
+            case I2C_RESULT_TIMEOUT: b->stats.timeouts++;  break;
+            default:                 b->stats.errors++;    break;
+        }
+        if (callback) {
+            callback(result, read_data, read_length, context);
+        }
+    }
+}
+
+// Start whatever is queued; desktop transactions without the virtual
+// clock have then already finished, so their callbacks run now
+static void kick(uint8_t bus) {
+    lock();
+    start_next(bus);
+    unlock();
+    #ifndef ARDUINO
+    if (!mock_clock_enabled) {
+        deliver_completed(bus);
+    }
+    #endif
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void i2c_bus_init(void) {
+    for (uint8_t bus = 0; bus < I2C_BUS_COUNT; bus++) {
+        i2c_bus_state_t* b = &buses[bus];
+        lock();
+        if (b->running) {
+            abort_hardware(bus);
+        }
+        uint8_t begun = b->begun;
+        memset(b, 0, sizeof(*b));
+        b->begun = begun;
+        unlock();
+    }
+}
+
+void i2c_bus_begin(uint8_t bus) {
+    if (bus >= I2C_BUS_COUNT) {
+        return;
+    }
+    #ifdef ARDUINO
+    if (!buses[bus].begun) {
+        // Wire polls in master mode and leaves MIER clear, so the vector
+        // only ever sees our own transactions
+        lpi2c_ports[bus]->MIER = 0;
+        attachInterruptVector(lpi2c_irqs[bus], lpi2c_vectors[bus]);
+        NVIC_SET_PRIORITY(lpi2c_irqs[bus], 160);
+        NVIC_ENABLE_IRQ(lpi2c_irqs[bus]);
+    }
+    #endif
+    buses[bus].begun = 1;
+    kick(bus);
+}
+
+bool i2c_bus_submit(uint8_t bus, uint8_t address,
+                    const uint8_t* write_data, uint8_t write_length,
+                    uint8_t read_length, i2c_bus_callback_t callback, void* context) {
+    if (bus >= I2C_BUS_COUNT || write_length > I2C_BUS_MAX_WRITE || read_length > I2C_BUS_MAX_READ) {
+        return false;
+    }
+    i2c_bus_state_t* b = &buses[bus];
+    if ((uint8_t)(b->submit_index - b->deliver_index) >= I2C_BUS_QUEUE_DEPTH) {
+        b->stats.queue_full++;
+        return false;
+    }
+
+    i2c_transaction_t* t = &b->queue[b->submit_index % I2C_BUS_QUEUE_DEPTH];
+    t->address = address;
+    t->write_length = write_length;
+    t->read_length = read_length;
+    t->done = 0;
+    if (write_length > 0) {
+        memcpy(t->write_data, write_data, write_length);
+    }
+    t->callback = callback;
+    t->context = context;
+
+    lock();
+    b->submit_index++;
+    unlock();
+    kick(bus);
+    return true;
+}
+
+void i2c_bus_service(void) {
+    for (uint8_t bus = 0; bus < I2C_BUS_COUNT; bus++) {
+        i2c_bus_state_t* b = &buses[bus];
+        if (b->submit_index == b->deliver_index) {
+            continue;
+        }
+        lock();
+        if (b->running && (uint32_t)(micros() - b->started_us) >= I2C_BUS_TIMEOUT_US) {
+            abort_hardware(bus);
+            finish_running(bus, I2C_RESULT_TIMEOUT);
+        }
+        unlock();
+        deliver_completed(bus);
+    }
+}
+
+bool i2c_bus_claim(uint8_t bus, uint32_t timeout_us) {
+    if (bus >= I2C_BUS_COUNT) {
+        return false;
+    }
+    i2c_bus_state_t* b = &buses[bus];
+    b->claimed = 1;
+    uint32_t start_us = micros();
+    while (b->running) {
+        if ((uint32_t)(micros() - start_us) >= timeout_us) {
+            b->claimed = 0;
+            return false;
+        }
+        #ifndef ARDUINO
+        mock_advance_time_us(1);    // Let the simulated transaction finish
+        #endif
+    }
+    return true;
+}
+
+void i2c_bus_release(uint8_t bus) {
+    if (bus >= I2C_BUS_COUNT) {
+        return;
+    }
+    buses[bus].claimed = 0;
+    kick(bus);
+}
+
+uint8_t i2c_bus_pending(uint8_t bus) {
+    if (bus >= I2C_BUS_COUNT) {
+        return 0;
+    }
+    return (uint8_t)(buses[bus].submit_index - buses[bus].deliver_index);
+}
+
+const i2c_bus_stats_t* i2c_bus_get_stats(uint8_t bus) {
+    return (bus < I2C_BUS_COUNT) ? &buses[bus].stats : nullptr;
+}
+
+#ifdef TESTING
+void i2c_bus_attach_mock_device(uint8_t bus, uint8_t address, i2c_mock_device_t device) {
+    if (bus >= I2C_BUS_COUNT) {
+        return;
+    }
+    i2c_mock_slot_t* free_slot = nullptr;
+    for (uint8_t i = 0; i < I2C_MOCK_MAX_DEVICES; i++) {
+        i2c_mock_slot_t* slot = &mock_devices[bus][i];
+        if (slot->device && slot->address == address) {
+            slot->device = device;
+            return;
+        }
+        if (!slot->device && !free_slot) {
+            free_slot = slot;
+        }
+    }
+    if (free_slot) {
+        free_slot->address = address;
+        free_slot->device = device;
+    }
+}
+#endif
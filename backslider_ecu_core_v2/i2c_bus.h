@@ -0,0 +1,114 @@
+// i2c_bus.h
+// Queued, interrupt-driven I2C transactions with completion callbacks
+
+/* =============================================================================
+ * I2C BUS OVERVIEW
+ * =============================================================================
+ *
+ * Wire.endTransmission() and Wire.requestFrom() spin until the last bit is
+ * on the wire: about 25 µs per byte at 400 kHz, 100 µs or more for a typical
+ * register read. The bus layer lets drivers hand a transaction over and get
+ * on with the loop:
+ *
+ * - i2c_bus_submit() copies a transaction (register write, read, or write
+ *   then repeated-START read) into the bus's FIFO queue and returns at once.
+ * - On target the LPI2C master interrupt feeds the command/data FIFO, drains
+ *   received bytes and, on STOP, starts the next queued transaction. The CPU
+ *   only spends the few ISR entries per transaction.
+ * - i2c_bus_service() runs the completion callbacks of finished
+ *   transactions in loop context, in submit order. input_manager calls it
+ *   at the start of every update pass.
+ *
+ * Arbitration: each bus runs one transaction at a time from its queue. Code
+ * that still uses blocking Wire/Adafruit calls wraps them in
+ * i2c_bus_claim() / i2c_bus_release(); a claim waits for the running
+ * transaction and holds the queue until it is released.
+ *
+ * Buses follow the Teensy 4.1 Wire objects: 0 = Wire (LPI2C1), 1 = Wire1
+ * (LPI2C3), 2 = Wire2 (LPI2C4). The Wire object sets up pins and clock;
+ * i2c_bus_begin() then takes over its interrupt. Transactions submitted
+ * earlier wait in the queue.
+ *
+ * Desktop builds have no LPI2C: tests attach a mock device per address that
+ * answers each transaction. With the virtual clock off a transaction
+ * completes, and its callback runs, inside i2c_bus_submit(); with it on the
+ * transaction completes its wire time later and the callback runs from the
+ * next i2c_bus_service().
+ * =============================================================================
+ */
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdint.h>
+
+#define I2C_BUS_COUNT           3
+#define I2C_BUS_PRIMARY         0       // Wire
+#define I2C_BUS_QUEUE_DEPTH     8       // Transactions per bus
+#define I2C_BUS_MAX_WRITE       4       // Register pointer plus up to 3 data bytes
+#define I2C_BUS_MAX_READ        8
+#define I2C_BUS_TIMEOUT_US      2000    // A running transaction is abandoned after this
+
+typedef enum {
+    I2C_RESULT_OK,
+    I2C_RESULT_NACK,            // Address or data byte not acknowledged
+    I2C_RESULT_BUS_ERROR,       // Arbitration lost, FIFO error or stuck line
+    I2C_RESULT_TIMEOUT
+} i2c_result_t;
+
+// Completion callback, run from i2c_bus_service(). read_data holds read_length
+// bytes when result is I2C_RESULT_OK.
+typedef void (*i2c_bus_callback_t)(i2c_result_t result, const uint8_t* read_data,
+                                   uint8_t read_length, void* context);
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Drop queued transactions, claims and statistics on every bus
+void i2c_bus_init(void);
+
+// Take over the bus interrupt after the Wire object is set up, and start
+// anything already queued
+void i2c_bus_begin(uint8_t bus);
+
+// Queue a transaction: write_length bytes (may be 0), then read_length bytes
+// (may be 0) after a repeated START. The callback may be null.
+// Returns false if the bus is invalid, a length is too long or the queue is full.
+bool i2c_bus_submit(uint8_t bus, uint8_t address,
+                    const uint8_t* write_data, uint8_t write_length,
+                    uint8_t read_length, i2c_bus_callback_t callback, void* context);
+
+// Run callbacks of completed transactions and time out a stuck one
+void i2c_bus_service(void);
+
+// Borrow a bus for blocking Wire calls. Returns false if the running
+// transaction did not finish within timeout_us.
+bool i2c_bus_claim(uint8_t bus, uint32_t timeout_us);
+void i2c_bus_release(uint8_t bus);
+
+// Transactions queued or running on a bus
+uint8_t i2c_bus_pending(uint8_t bus);
+
+// Diagnostics
+typedef struct {
+    uint32_t completed;         // Callbacks run with I2C_RESULT_OK
+    uint32_t errors;            // NACK and bus errors
+    uint32_t timeouts;
+    uint32_t queue_full;        // Submits rejected
+} i2c_bus_stats_t;
+
+const i2c_bus_stats_t* i2c_bus_get_stats(uint8_t bus);
+
+#ifdef TESTING
+// Device answering transactions to one address: gets the bytes written and
+// fills read_length bytes. Returns false to NACK.
+typedef bool (*i2c_mock_device_t)(uint8_t address, const uint8_t* write_data, uint8_t write_length,
+                                  uint8_t* read_data, uint8_t read_length);
+
+// Attach (or replace) the device at an address; transactions to addresses
+// without one are NACKed
+void i2c_bus_attach_mock_device(uint8_t bus, uint8_t address, i2c_mock_device_t device);
+#endif
+
+#endif
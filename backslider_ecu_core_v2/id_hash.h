@@ -0,0 +1,17 @@
+// id_hash.h
+// Hash for the open-addressed message and parameter ID tables
+
+#ifndef ID_HASH_H
+#define ID_HASH_H
+
+#include <stdint.h>
+
+// Fibonacci hashing: multiply by 2^32 / phi and keep the top bits of the
+// product. Spreads the structured ECU/SUBSYSTEM/PARAMETER fields of an ID
+// evenly across a table of (1 << bits) slots (bits 1..16). Callers probe
+// linearly from the returned slot.
+static inline uint16_t fib_hash(uint32_t key, uint8_t bits) {
+    return (uint16_t)((key * 2654435761u) >> (32 - bits));
+}
+
+#endif
@@ -0,0 +1,346 @@
+// ignition_scheduler.cpp
+// Per-cylinder dwell/spark queues driven by the crank decoder and GPT1 compare
+
+#include "ignition_scheduler.h"
+#include "msg_definitions.h"
+#include "msg_bus.h"
+#include "memory_placement.h"
+#include <math.h>
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+#define IGNITION_MAX_DWELL_US   20000
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+typedef struct {
+    uint32_t time_us;
+    uint8_t action;             // IGNITION_EVENT_*
+} ignition_event_t;
+
+// Pending events in time order; written only from the tooth and compare
+// ISRs (same priority) or with interrupts off
+typedef struct {
+    ignition_event_t events[IGNITION_QUEUE_DEPTH];
+    uint8_t count;
+    uint8_t coil_on;
+} cylinder_queue_t;
+
+static ignition_layout_t layout;
+static cylinder_queue_t queues[IGNITION_MAX_CYLINDERS] ECU_HOT_DATA;
+
+static volatile float advance_deg = IGNITION_DEFAULT_ADVANCE_DEG;
+static volatile uint32_t dwell_us = IGNITION_DEFAULT_DWELL_US;
+static volatile bool enabled = false;
+
+static volatile uint32_t spark_count = 0;
+static volatile uint32_t late_count = 0;
+static volatile uint32_t overrun_count = 0;
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static inline void coil_write(uint8_t cylinder, uint8_t on) {
+    #ifdef ARDUINO
+    digitalWriteFast(layout.coil_pins[cylinder], on ? HIGH : LOW);
+    #else
+    digitalWrite(layout.coil_pins[cylinder], on ? HIGH : LOW);
+    #endif
+}
+
+static float wrap_angle(float angle, float cycle_deg) {
+    angle = fmodf(angle, cycle_deg);
+    return (angle < 0.0f) ? angle + cycle_deg : angle;
+}
+
+static ignition_event_t* find_event(cylinder_queue_t* q, uint8_t action) {
+    for (uint8_t i = 0; i < q->count; i++) {
+        if (q->events[i].action == action) {
+            return &q->events[i];
+        }
+    }
+    return nullptr;
+}
+
+static void sort_queue(cylinder_queue_t* q) {
+    // At most IGNITION_QUEUE_DEPTH entries: insertion sort
+    for (uint8_t i = 1; i < q->count; i++) {
+        ignition_event_t e = q->events[i];
+        uint8_t j = i;
+        while (j > 0 && (int32_t)(q->events[j - 1].time_us - e.time_us) > 0) {
+            q->events[j] = q->events[j - 1];
+            j--;
+        }
+        q->events[j] = e;
+    }
+}
+
+static void queue_push(cylinder_queue_t* q, uint32_t time_us, uint8_t action) {
+    if (q->count >= IGNITION_QUEUE_DEPTH) {
+        overrun_count++;
+        return;
+    }
+    q->events[q->count].time_us = time_us;
+    q->events[q->count].action = action;
+    q->count++;
+    sort_queue(q);
+}
+
+static void queue_pop(cylinder_queue_t* q) {
+    for (uint8_t i = 1; i < q->count; i++) {
+        q->events[i - 1] = q->events[i];
+    }
+    q->count--;
+}
+
+// Move a queued event to its new prediction unless that is a different firing
+static void refresh_event(cylinder_queue_t* q, uint8_t action, uint32_t time_us, uint32_t half_cycle_us) {
+    ignition_event_t* e = find_event(q, action);
+    if (e == nullptr) {
+        return;
+    }
+    int32_t shift = (int32_t)(time_us - e->time_us);
+    if (shift < 0) shift = -shift;
+    if ((uint32_t)shift < half_cycle_us) {
+        e->time_us = time_us;
+        sort_queue(q);
+    }
+}
+
+static void cancel_all(void) {
+    for (uint8_t c = 0; c < layout.cylinder_count; c++) {
+        queues[c].count = 0;
+        if (queues[c].coil_on) {
+            coil_write(c, 0);
+            queues[c].coil_on = 0;
+        }
+    }
+}
+
+#ifdef ARDUINO
+
+ECU_HOT_CODE static void program_compare(void) {
+    uint32_t next_us;
+    if (!ignition_scheduler_next_event_us(&next_us)) {
+        GPT1_IR = 0;
+        return;
+    }
+    int32_t delay_us = (int32_t)(next_us - micros());
+    if (delay_us < 1) {
+        delay_us = 1;
+    }
+    GPT1_OCR1 = GPT1_CNT + (uint32_t)delay_us;
+    GPT1_IR = GPT_IR_OF1IE;
+}
+
+ECU_HOT_CODE static void gpt1_isr(void) {
+    GPT1_SR = GPT_SR_OF1;
+    ignition_scheduler_service(micros());
+    asm volatile("dsb");   // Flag clear must land before the ISR returns
+}
+
+static void start_compare_timer(void) {
+    CCM_CCGR1 |= CCM_CCGR1_GPT1_BUS(CCM_CCGR_ON) | CCM_CCGR1_GPT1_SERIAL(CCM_CCGR_ON);
+    GPT1_CR = 0;
+    GPT1_PR = (F_BUS_ACTUAL / 1000000) - 1;    // 1 MHz from the bus clock
+    GPT1_SR = 0x3F;
+    GPT1_IR = 0;
+    GPT1_CR = GPT_CR_EN | GPT_CR_CLKSRC(1) | GPT_CR_FRR;
+    attachInterruptVector(IRQ_GPT1, gpt1_isr);
+    NVIC_SET_PRIORITY(IRQ_GPT1, 16);            // Same as the crank ISR
+    NVIC_ENABLE_IRQ(IRQ_GPT1);
+}
+
+#else
+
+static void program_compare(void) {
+    // Desktop builds: tests call ignition_scheduler_service() at the next event
+}
+
+static void start_compare_timer(void) {
+}
+
+#endif
+
+static void handle_timing_message(const CANMessage* msg) {
+    ignition_scheduler_set_advance(MSG_UNPACK_FLOAT(msg));
+}
+
+static void handle_dwell_message(const CANMessage* msg) {
+    float dwell_ms = MSG_UNPACK_FLOAT(msg);
+    ignition_scheduler_set_dwell_us(dwell_ms > 0.0f ? (uint32_t)(dwell_ms * 1000.0f) : 0);
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void ignition_scheduler_init(void) {
+    layout.cylinder_count = 0;
+    for (uint8_t c = 0; c < IGNITION_MAX_CYLINDERS; c++) {
+        queues[c].count = 0;
+        queues[c].coil_on = 0;
+    }
+    advance_deg = IGNITION_DEFAULT_ADVANCE_DEG;
+    dwell_us = IGNITION_DEFAULT_DWELL_US;
+    enabled = false;
+    spark_count = 0;
+    late_count = 0;
+    overrun_count = 0;
+
+    g_message_bus.subscribe(MSG_IGNITION_TIMING, handle_timing_message);
+    g_message_bus.subscribe(MSG_CONFIG_IGNITION_DWELL_TIME, handle_dwell_message);
+}
+
+bool ignition_scheduler_configure(const ignition_layout_t* new_layout) {
+    if (new_layout == nullptr || new_layout->cylinder_count == 0 ||
+        new_layout->cylinder_count > IGNITION_MAX_CYLINDERS) {
+        return false;
+    }
+
+    #ifdef ARDUINO
+    noInterrupts();
+    #endif
+    cancel_all();
+    layout = *new_layout;
+    for (uint8_t c = 0; c < layout.cylinder_count; c++) {
+        pinMode(layout.coil_pins[c], OUTPUT);
+        coil_write(c, 0);
+        queues[c].count = 0;
+        queues[c].coil_on = 0;
+    }
+    #ifdef ARDUINO
+    interrupts();
+    #endif
+    return true;
+}
+
+void ignition_scheduler_begin(void) {
+    start_compare_timer();
+    trigger_decoder_add_tooth_callback(ignition_scheduler_on_tooth);
+}
+
+void ignition_scheduler_enable(bool enable) {
+    #ifdef ARDUINO
+    noInterrupts();
+    #endif
+    enabled = enable;
+    if (!enable) {
+        cancel_all();
+        program_compare();
+    }
+    #ifdef ARDUINO
+    interrupts();
+    #endif
+}
+
+void ignition_scheduler_set_advance(float new_advance_deg) {
+    advance_deg = new_advance_deg;
+}
+
+void ignition_scheduler_set_dwell_us(uint32_t new_dwell_us) {
+    dwell_us = (new_dwell_us > IGNITION_MAX_DWELL_US) ? IGNITION_MAX_DWELL_US : new_dwell_us;
+}
+
+ECU_HOT_CODE void ignition_scheduler_on_tooth(const trigger_state_t* state) {
+    if (!enabled) {
+        return;
+    }
+    if (state->sync == TRIGGER_SYNC_NONE || state->tooth_period_us == 0) {
+        cancel_all();
+        program_compare();
+        return;
+    }
+
+    float cycle_deg = (state->sync == TRIGGER_SYNC_FULL) ? 720.0f : 360.0f;
+    uint32_t cycle_us = (uint32_t)(cycle_deg * state->us_per_degree);
+    uint32_t half_cycle_us = cycle_us / 2;
+
+    // Dwell that fits in one coil cycle
+    uint32_t dwell = dwell_us;
+    uint32_t max_dwell = (uint32_t)((float)cycle_us * IGNITION_MAX_DWELL_FRACTION);
+    bool dwell_clipped = false;
+    if (dwell > max_dwell) {
+        dwell = max_dwell;
+        dwell_clipped = true;
+    }
+
+    float advance = advance_deg;
+    for (uint8_t c = 0; c < layout.cylinder_count; c++) {
+        cylinder_queue_t* q = &queues[c];
+        float spark_angle = wrap_angle(layout.tdc_angle_deg[c] - advance, cycle_deg);
+        float delta_deg = wrap_angle(spark_angle - state->tooth_angle_deg, cycle_deg);
+        uint32_t spark_us = state->tooth_time_us + trigger_decoder_predict_delay_us(state, delta_deg);
+
+        if (q->coil_on) {
+            refresh_event(q, IGNITION_EVENT_SPARK, spark_us, half_cycle_us);
+        } else if (q->count == 0) {
+            // New firing: coil on dwell before the spark
+            if (dwell_clipped) {
+                overrun_count++;
+            }
+            queue_push(q, spark_us - dwell, IGNITION_EVENT_DWELL);
+            queue_push(q, spark_us, IGNITION_EVENT_SPARK);
+        } else {
+            refresh_event(q, IGNITION_EVENT_DWELL, spark_us - dwell, half_cycle_us);
+            refresh_event(q, IGNITION_EVENT_SPARK, spark_us, half_cycle_us);
+        }
+    }
+    program_compare();
+}
+
+ECU_HOT_CODE void ignition_scheduler_service(uint32_t now_us) {
+    for (uint8_t c = 0; c < layout.cylinder_count; c++) {
+        cylinder_queue_t* q = &queues[c];
+        while (q->count > 0 && (int32_t)(q->events[0].time_us - now_us) <= 0) {
+            ignition_event_t e = q->events[0];
+            queue_pop(q);
+            if ((int32_t)(now_us - e.time_us) > IGNITION_LATE_THRESHOLD_US) {
+                late_count++;
+            }
+            if (e.action == IGNITION_EVENT_DWELL) {
+                coil_write(c, 1);
+                q->coil_on = 1;
+            } else if (q->coil_on) {
+                coil_write(c, 0);
+                q->coil_on = 0;
+                spark_count++;
+            }
+        }
+    }
+    program_compare();
+}
+
+bool ignition_scheduler_next_event_us(uint32_t* time_us) {
+    bool found = false;
+    for (uint8_t c = 0; c < layout.cylinder_count; c++) {
+        if (queues[c].count == 0) {
+            continue;
+        }
+        uint32_t t = queues[c].events[0].time_us;
+        if (!found || (int32_t)(t - *time_us) < 0) {
+            *time_us = t;
+            found = true;
+        }
+    }
+    return found;
+}
+
+uint32_t ignition_scheduler_get_spark_count(void) {
+    return spark_count;
+}
+
+uint32_t ignition_scheduler_get_late_count(void) {
+    return late_count;
+}
+
+uint32_t ignition_scheduler_get_overrun_count(void) {
+    return overrun_count;
+}
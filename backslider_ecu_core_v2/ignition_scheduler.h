@@ -0,0 +1,101 @@
+// ignition_scheduler.h
+// Angle-to-time coil dwell and spark scheduling on a hardware compare timer
+
+/* =============================================================================
+ * IGNITION SCHEDULER OVERVIEW
+ * =============================================================================
+ *
+ * Coil events never go through the message bus. On every crank tooth (a
+ * trigger decoder callback, ISR context) the scheduler turns each
+ * cylinder's next spark angle - TDC minus the advance - and the dwell
+ * before it into absolute times from the latest tooth, and puts them in
+ * that cylinder's event queue:
+ *
+ *   dwell start = spark time - dwell_us      (coil on)
+ *   spark       = time of (TDC - advance)    (coil off)
+ *
+ * Angles become times through the decoder's crank-speed model
+ * (trigger_decoder_predict_delay_us), which follows the tooth period's
+ * trend rather than assuming the last period holds, so spark stays on
+ * angle under hard acceleration. Queued events are re-predicted on every
+ * tooth from the latest model. A re-prediction that moves an event by
+ * half a cycle or more is ignored: that is the same event seen just after
+ * its angle passed, and it fires as already programmed.
+ *
+ * One free-running 1 MHz GPT1 compare is programmed to the earliest queued
+ * event; its ISR runs every event due and reprograms the compare. The GPT1
+ * and crank interrupts share a priority so queue updates never interleave.
+ *
+ * Without full (cam) sync the cycle is 360° and each coil fires every
+ * revolution at its TDC mod 360 - wasted spark. Losing sync cancels every
+ * queued event and switches all coils off.
+ *
+ * Diagnostics:
+ * - late events: run more than IGNITION_LATE_THRESHOLD_US after their time
+ * - overruns: dwell clipped because it would not fit in the cycle, or an
+ *   event dropped because a cylinder's queue was full
+ *
+ * Configuration comes over the bus as the architecture doc describes:
+ * advance from MSG_IGNITION_TIMING (degrees BTDC) and dwell from
+ * MSG_CONFIG_IGNITION_DWELL_TIME (ms).
+ * =============================================================================
+ */
+
+#ifndef IGNITION_SCHEDULER_H
+#define IGNITION_SCHEDULER_H
+
+#include <stdint.h>
+#include "trigger_decoder.h"
+
+#define IGNITION_MAX_CYLINDERS          8
+#define IGNITION_QUEUE_DEPTH            2       // Dwell start + spark per cylinder
+#define IGNITION_LATE_THRESHOLD_US      20
+#define IGNITION_MAX_DWELL_FRACTION     0.75f   // Of the per-coil cycle time
+#define IGNITION_DEFAULT_DWELL_US       3000
+#define IGNITION_DEFAULT_ADVANCE_DEG    10.0f
+
+#define IGNITION_EVENT_DWELL            0       // Coil on
+#define IGNITION_EVENT_SPARK            1       // Coil off
+
+typedef struct {
+    uint8_t cylinder_count;
+    uint8_t coil_pins[IGNITION_MAX_CYLINDERS];
+    float tdc_angle_deg[IGNITION_MAX_CYLINDERS];    // Compression TDC of each cylinder, 0..720
+} ignition_layout_t;
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Clear all queues, leave the scheduler disabled and subscribe to the
+// advance and dwell messages
+void ignition_scheduler_init(void);
+
+// Set cylinder layout and coil pins (coils driven low). Returns false if invalid.
+bool ignition_scheduler_configure(const ignition_layout_t* layout);
+
+// Start the compare timer and register the tooth callback with the decoder
+void ignition_scheduler_begin(void);
+
+// Arm or disarm the coils. Disarming cancels queued events.
+void ignition_scheduler_enable(bool enable);
+
+// Direct setters; the bus handlers call these
+void ignition_scheduler_set_advance(float advance_deg);
+void ignition_scheduler_set_dwell_us(uint32_t dwell_us);
+
+// Tooth callback body: re-predict every cylinder's events
+void ignition_scheduler_on_tooth(const trigger_state_t* state);
+
+// Compare ISR body: run every event due at now_us and reprogram the timer
+void ignition_scheduler_service(uint32_t now_us);
+
+// Earliest queued event time. Returns false if nothing is queued.
+bool ignition_scheduler_next_event_us(uint32_t* time_us);
+
+// Diagnostics
+uint32_t ignition_scheduler_get_spark_count(void);
+uint32_t ignition_scheduler_get_late_count(void);
+uint32_t ignition_scheduler_get_overrun_count(void);
+
+#endif
@@ -0,0 +1,397 @@
+// injection_scheduler.cpp
+// Per-cylinder injector pulse queues driven by the crank decoder and GPT2 compare
+
+#include "injection_scheduler.h"
+#include "msg_definitions.h"
+#include "msg_bus.h"
+#include "memory_placement.h"
+#include <math.h>
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+typedef struct {
+    uint32_t open_us;           // Planned opening; actual opening once open
+    uint32_t close_us;
+    uint32_t eoi_us;            // Planned end of injection, used to match re-plans
+    uint32_t pw_us;
+    uint8_t is_open;
+    uint8_t delayed;            // Open moved later for the minimum off time
+} injection_pulse_t;
+
+// Pulses in time order; only the first can be open. Written only from the
+// tooth and compare ISRs (same priority) or with interrupts off.
+typedef struct {
+    injection_pulse_t pulses[INJECTION_QUEUE_DEPTH];
+    uint8_t count;
+    uint8_t have_last;
+    uint32_t last_eoi_us;       // EOI of the last pulse closed, so it is not re-planned
+} injector_queue_t;
+
+static injection_layout_t layout;
+static injector_queue_t queues[INJECTION_MAX_CYLINDERS] ECU_HOT_DATA;
+
+static volatile uint32_t pulse_width_us = 0;
+static volatile float eoi_btdc_deg = INJECTION_DEFAULT_EOI_DEG;
+static volatile bool enabled = false;
+static uint8_t active_mode = INJECTION_MODE_BATCH;
+
+static volatile uint32_t pulse_count = 0;
+static volatile uint32_t late_count = 0;
+static volatile uint32_t overlap_count = 0;
+static volatile uint32_t overrun_count = 0;
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static inline void injector_write(uint8_t cylinder, uint8_t open) {
+    #ifdef ARDUINO
+    digitalWriteFast(layout.injector_pins[cylinder], open ? HIGH : LOW);
+    #else
+    digitalWrite(layout.injector_pins[cylinder], open ? HIGH : LOW);
+    #endif
+}
+
+static float wrap_angle(float angle, float cycle_deg) {
+    angle = fmodf(angle, cycle_deg);
+    return (angle < 0.0f) ? angle + cycle_deg : angle;
+}
+
+static inline uint32_t pulse_next_time(const injection_pulse_t* p) {
+    return p->is_open ? p->close_us : p->open_us;
+}
+
+static void queue_pop(injector_queue_t* q) {
+    q->last_eoi_us = q->pulses[0].eoi_us;
+    q->have_last = 1;
+    for (uint8_t i = 1; i < q->count; i++) {
+        q->pulses[i - 1] = q->pulses[i];
+    }
+    q->count--;
+}
+
+// Two predictions within half a cycle are the same firing
+static bool same_firing(uint32_t a_us, uint32_t b_us, uint32_t half_cycle_us) {
+    int32_t shift = (int32_t)(a_us - b_us);
+    if (shift < 0) shift = -shift;
+    return (uint32_t)shift < half_cycle_us;
+}
+
+// Drop every pulse that has not opened yet
+static void drop_pending(injector_queue_t* q) {
+    q->count = (q->count > 0 && q->pulses[0].is_open) ? 1 : 0;
+}
+
+// Plan a pulse ending at eoi_us, no earlier than INJECTION_MIN_OFF_US after
+// the pulse before it. The width is kept; the end moves later instead.
+static void plan_pulse(injector_queue_t* q, uint8_t index, uint32_t eoi_us, uint32_t pw) {
+    injection_pulse_t* p = &q->pulses[index];
+    p->eoi_us = eoi_us;
+    p->pw_us = pw;
+    p->open_us = eoi_us - pw;
+    p->delayed = 0;
+    if (index > 0) {
+        uint32_t earliest = q->pulses[index - 1].close_us + INJECTION_MIN_OFF_US;
+        if ((int32_t)(p->open_us - earliest) < 0) {
+            p->open_us = earliest;
+            p->delayed = 1;
+        }
+    }
+    p->close_us = p->open_us + pw;
+}
+
+static void cancel_all(void) {
+    for (uint8_t c = 0; c < layout.cylinder_count; c++) {
+        if (queues[c].count > 0 && queues[c].pulses[0].is_open) {
+            injector_write(c, 0);
+        }
+        queues[c].count = 0;
+        queues[c].have_last = 0;
+    }
+}
+
+#ifdef ARDUINO
+
+ECU_HOT_CODE static void program_compare(void) {
+    uint32_t next_us;
+    if (!injection_scheduler_next_event_us(&next_us)) {
+        GPT2_IR = 0;
+        return;
+    }
+    int32_t delay_us = (int32_t)(next_us - micros());
+    if (delay_us < 1) {
+        delay_us = 1;
+    }
+    GPT2_OCR1 = GPT2_CNT + (uint32_t)delay_us;
+    GPT2_IR = GPT_IR_OF1IE;
+}
+
+ECU_HOT_CODE static void gpt2_isr(void) {
+    GPT2_SR = GPT_SR_OF1;
+    injection_scheduler_service(micros());
+    asm volatile("dsb");   // Flag clear must land before the ISR returns
+}
+
+static void start_compare_timer(void) {
+    CCM_CCGR0 |= CCM_CCGR0_GPT2_BUS(CCM_CCGR_ON) | CCM_CCGR0_GPT2_SERIAL(CCM_CCGR_ON);
+    GPT2_CR = 0;
+    GPT2_PR = (F_BUS_ACTUAL / 1000000) - 1;    // 1 MHz from the bus clock
+    GPT2_SR = 0x3F;
+    GPT2_IR = 0;
+    GPT2_CR = GPT_CR_EN | GPT_CR_CLKSRC(1) | GPT_CR_FRR;
+    attachInterruptVector(IRQ_GPT2, gpt2_isr);
+    NVIC_SET_PRIORITY(IRQ_GPT2, 16);            // Same as the crank and GPT1 ISRs
+    NVIC_ENABLE_IRQ(IRQ_GPT2);
+}
+
+#else
+
+static void program_compare(void) {
+    // Desktop builds: tests call injection_scheduler_service() at the next event
+}
+
+static void start_compare_timer(void) {
+}
+
+#endif
+
+static void handle_pulse_width_message(const CANMessage* msg) {
+    float pw_ms = MSG_UNPACK_FLOAT(msg);
+    injection_scheduler_set_pulse_width_us(pw_ms > 0.0f ? (uint32_t)(pw_ms * 1000.0f) : 0);
+}
+
+static void handle_timing_message(const CANMessage* msg) {
+    injection_scheduler_set_eoi_angle(MSG_UNPACK_FLOAT(msg));
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void injection_scheduler_init(void) {
+    layout.cylinder_count = 0;
+    layout.mode = INJECTION_MODE_BATCH;
+    for (uint8_t c = 0; c < INJECTION_MAX_CYLINDERS; c++) {
+        queues[c].count = 0;
+        queues[c].have_last = 0;
+    }
+    pulse_width_us = 0;
+    eoi_btdc_deg = INJECTION_DEFAULT_EOI_DEG;
+    enabled = false;
+    active_mode = INJECTION_MODE_BATCH;
+    pulse_count = 0;
+    late_count = 0;
+    overlap_count = 0;
+    overrun_count = 0;
+
+    g_message_bus.subscribe(MSG_FUEL_PULSE_WIDTH, handle_pulse_width_message);
+    g_message_bus.subscribe(MSG_FUEL_INJECTION_TIMING, handle_timing_message);
+}
+
+bool injection_scheduler_configure(const injection_layout_t* new_layout) {
+    if (new_layout == nullptr || new_layout->cylinder_count == 0 ||
+        new_layout->cylinder_count > INJECTION_MAX_CYLINDERS ||
+        new_layout->mode > INJECTION_MODE_SEQUENTIAL) {
+        return false;
+    }
+
+    #ifdef ARDUINO
+    noInterrupts();
+    #endif
+    cancel_all();
+    layout = *new_layout;
+    for (uint8_t c = 0; c < layout.cylinder_count; c++) {
+        pinMode(layout.injector_pins[c], OUTPUT);
+        injector_write(c, 0);
+        queues[c].count = 0;
+    }
+    #ifdef ARDUINO
+    interrupts();
+    #endif
+    return true;
+}
+
+void injection_scheduler_begin(void) {
+    start_compare_timer();
+    trigger_decoder_add_tooth_callback(injection_scheduler_on_tooth);
+}
+
+void injection_scheduler_enable(bool enable) {
+    #ifdef ARDUINO
+    noInterrupts();
+    #endif
+    enabled = enable;
+    if (!enable) {
+        cancel_all();
+        program_compare();
+    }
+    #ifdef ARDUINO
+    interrupts();
+    #endif
+}
+
+void injection_scheduler_set_pulse_width_us(uint32_t new_pulse_width_us) {
+    pulse_width_us = (new_pulse_width_us > INJECTION_MAX_PULSE_US) ? INJECTION_MAX_PULSE_US : new_pulse_width_us;
+}
+
+void injection_scheduler_set_eoi_angle(float new_eoi_btdc_deg) {
+    eoi_btdc_deg = new_eoi_btdc_deg;
+}
+
+void injection_scheduler_set_mode(uint8_t mode) {
+    if (mode <= INJECTION_MODE_SEQUENTIAL) {
+        layout.mode = mode;
+    }
+}
+
+uint8_t injection_scheduler_get_active_mode(void) {
+    return active_mode;
+}
+
+ECU_HOT_CODE void injection_scheduler_on_tooth(const trigger_state_t* state) {
+    if (!enabled) {
+        return;
+    }
+    if (state->sync == TRIGGER_SYNC_NONE || state->tooth_period_us == 0) {
+        cancel_all();
+        program_compare();
+        return;
+    }
+
+    uint8_t mode = layout.mode;
+    if (mode == INJECTION_MODE_SEQUENTIAL && state->sync != TRIGGER_SYNC_FULL) {
+        mode = INJECTION_MODE_SEMI_SEQUENTIAL;
+    }
+    if (mode != active_mode) {
+        // Firings planned on the old cycle do not match the new one
+        for (uint8_t c = 0; c < layout.cylinder_count; c++) {
+            drop_pending(&queues[c]);
+            queues[c].have_last = 0;
+        }
+        active_mode = mode;
+    }
+
+    // Sequential: one full pulse per 720°. Otherwise two half pulses per cycle.
+    bool sequential = (mode == INJECTION_MODE_SEQUENTIAL);
+    float cycle_deg = sequential ? 720.0f : 360.0f;
+    uint32_t cycle_us = (uint32_t)(cycle_deg * state->us_per_degree);
+    uint32_t half_cycle_us = cycle_us / 2;
+    uint32_t pw = sequential ? pulse_width_us : pulse_width_us / 2;
+    if (pw + INJECTION_MIN_OFF_US > cycle_us) {
+        pw = (cycle_us > INJECTION_MIN_OFF_US) ? cycle_us - INJECTION_MIN_OFF_US : 0;
+    }
+
+    float eoi_btdc = eoi_btdc_deg;
+    for (uint8_t c = 0; c < layout.cylinder_count; c++) {
+        injector_queue_t* q = &queues[c];
+        float tdc = (mode == INJECTION_MODE_BATCH) ? layout.tdc_angle_deg[0] : layout.tdc_angle_deg[c];
+        float eoi_angle = wrap_angle(tdc - eoi_btdc, cycle_deg);
+        float delta_deg = wrap_angle(eoi_angle - state->tooth_angle_deg, cycle_deg);
+        uint32_t eoi_us = state->tooth_time_us + trigger_decoder_predict_delay_us(state, delta_deg);
+        if ((int32_t)(eoi_us - pw - state->tooth_time_us) < 0) {
+            eoi_us += cycle_us;     // Too late to open for this one: the next firing
+        }
+
+        // An open pulse runs to its opening + the latest width, never past
+        // its close already being due
+        if (q->count > 0 && q->pulses[0].is_open) {
+            injection_pulse_t* p = &q->pulses[0];
+            p->pw_us = pw;
+            p->close_us = p->open_us + pw;
+            if ((int32_t)(p->close_us - state->tooth_time_us) < 0) {
+                p->close_us = state->tooth_time_us;
+            }
+        }
+        if (pw == 0) {
+            drop_pending(q);
+            continue;
+        }
+
+        // Re-plan the pulse for this firing, or queue it if it is new.
+        // A firing already delivered (or cut short) is never planned again.
+        bool matched = q->have_last && same_firing(eoi_us, q->last_eoi_us, half_cycle_us);
+        for (uint8_t i = 0; i < q->count && !matched; i++) {
+            if (same_firing(eoi_us, q->pulses[i].eoi_us, half_cycle_us)) {
+                if (!q->pulses[i].is_open) {
+                    plan_pulse(q, i, eoi_us, pw);
+                }
+                matched = true;
+            }
+        }
+        if (!matched) {
+            if (q->count >= INJECTION_QUEUE_DEPTH) {
+                overrun_count++;
+            } else {
+                plan_pulse(q, q->count, eoi_us, pw);
+                q->count++;
+            }
+        }
+    }
+    program_compare();
+}
+
+ECU_HOT_CODE void injection_scheduler_service(uint32_t now_us) {
+    for (uint8_t c = 0; c < layout.cylinder_count; c++) {
+        injector_queue_t* q = &queues[c];
+        while (q->count > 0 && (int32_t)(pulse_next_time(&q->pulses[0]) - now_us) <= 0) {
+            injection_pulse_t* p = &q->pulses[0];
+            if ((int32_t)(now_us - pulse_next_time(p)) > INJECTION_LATE_THRESHOLD_US) {
+                late_count++;
+            }
+            if (!p->is_open) {
+                // Full width from the actual opening
+                injector_write(c, 1);
+                p->is_open = 1;
+                p->open_us = now_us;
+                p->close_us = now_us + p->pw_us;
+                if (p->delayed) {
+                    overlap_count++;
+                }
+            } else {
+                injector_write(c, 0);
+                queue_pop(q);
+                pulse_count++;
+            }
+        }
+    }
+    program_compare();
+}
+
+bool injection_scheduler_next_event_us(uint32_t* time_us) {
+    bool found = false;
+    for (uint8_t c = 0; c < layout.cylinder_count; c++) {
+        if (queues[c].count == 0) {
+            continue;
+        }
+        uint32_t t = pulse_next_time(&queues[c].pulses[0]);
+        if (!found || (int32_t)(t - *time_us) < 0) {
+            *time_us = t;
+            found = true;
+        }
+    }
+    return found;
+}
+
+uint32_t injection_scheduler_get_pulse_count(void) {
+    return pulse_count;
+}
+
+uint32_t injection_scheduler_get_late_count(void) {
+    return late_count;
+}
+
+uint32_t injection_scheduler_get_overlap_count(void) {
+    return overlap_count;
+}
+
+uint32_t injection_scheduler_get_overrun_count(void) {
+    return overrun_count;
+}
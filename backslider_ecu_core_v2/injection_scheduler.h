@@ -0,0 +1,104 @@
+// injection_scheduler.h
+// Angle-timed injector pulses with batch, semi-sequential and sequential modes
+
+/* =============================================================================
+ * INJECTION SCHEDULER OVERVIEW
+ * =============================================================================
+ *
+ * Pulse timing follows the ignition scheduler: on every crank tooth
+ * (trigger decoder callback, ISR context) each cylinder's next end of
+ * injection (EOI) angle - its TDC minus the EOI advance - becomes an
+ * absolute time through the decoder's crank-speed model, and the pulse is
+ * queued as
+ *
+ *   open  = EOI time - pulse width
+ *   close = open + pulse width
+ *
+ * in that cylinder's pulse queue. A free-running 1 MHz GPT2 compare runs
+ * the opens and closes; the crank and GPT2 interrupts share a priority.
+ *
+ * Modes:
+ * - INJECTION_MODE_SEQUENTIAL: one pulse per 720° per cylinder at its own
+ *   EOI. Needs full (cam) sync; with crank sync only it runs semi-sequential.
+ * - INJECTION_MODE_SEMI_SEQUENTIAL: one half-width pulse per revolution at
+ *   the cylinder's TDC mod 360, so cylinder pairs 360° apart fire together.
+ * - INJECTION_MODE_BATCH: every injector opens together once per
+ *   revolution at cylinder 1's EOI with a half-width pulse.
+ *
+ * Pulse-width updates mid-cycle: a pulse not yet open is re-planned on the
+ * next tooth with the new width. An open pulse keeps its opening and moves
+ * its close to opening + new width; if that has already passed it closes on
+ * that tooth. An injector is never re-opened within the same pulse, and a
+ * new pulse never opens until INJECTION_MIN_OFF_US after the previous one
+ * closed (the open moves later and the overlap is counted).
+ *
+ * Configuration: pulse width from MSG_FUEL_PULSE_WIDTH (ms) and the EOI
+ * from MSG_FUEL_INJECTION_TIMING (degrees BTDC).
+ * =============================================================================
+ */
+
+#ifndef INJECTION_SCHEDULER_H
+#define INJECTION_SCHEDULER_H
+
+#include <stdint.h>
+#include "trigger_decoder.h"
+
+#define INJECTION_MAX_CYLINDERS         8
+#define INJECTION_QUEUE_DEPTH           2       // Open pulse + the next one
+#define INJECTION_MIN_OFF_US            200     // Injector closed time between pulses
+#define INJECTION_LATE_THRESHOLD_US     20
+#define INJECTION_MAX_PULSE_US          50000
+#define INJECTION_DEFAULT_EOI_DEG       360.0f
+
+#define INJECTION_MODE_BATCH            0
+#define INJECTION_MODE_SEMI_SEQUENTIAL  1
+#define INJECTION_MODE_SEQUENTIAL       2
+
+typedef struct {
+    uint8_t cylinder_count;
+    uint8_t injector_pins[INJECTION_MAX_CYLINDERS];
+    float tdc_angle_deg[INJECTION_MAX_CYLINDERS];   // Compression TDC of each cylinder, 0..720
+    uint8_t mode;                                   // INJECTION_MODE_*
+} injection_layout_t;
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Clear all queues, leave the scheduler disabled and subscribe to the
+// pulse width and EOI messages
+void injection_scheduler_init(void);
+
+// Set cylinder layout, injector pins (driven low) and mode. Returns false if invalid.
+bool injection_scheduler_configure(const injection_layout_t* layout);
+
+// Start the compare timer and register the tooth callback with the decoder
+void injection_scheduler_begin(void);
+
+// Arm or disarm the injectors. Disarming closes them and cancels queued pulses.
+void injection_scheduler_enable(bool enable);
+
+// Direct setters; the bus handlers call these. Take effect on the next tooth.
+void injection_scheduler_set_pulse_width_us(uint32_t pulse_width_us);
+void injection_scheduler_set_eoi_angle(float eoi_btdc_deg);
+void injection_scheduler_set_mode(uint8_t mode);
+
+// Mode currently scheduled (sequential drops to semi-sequential without full sync)
+uint8_t injection_scheduler_get_active_mode(void);
+
+// Tooth callback body: plan and re-plan every cylinder's pulses
+void injection_scheduler_on_tooth(const trigger_state_t* state);
+
+// Compare ISR body: run every open/close due at now_us and reprogram the timer
+void injection_scheduler_service(uint32_t now_us);
+
+// Earliest queued open or close. Returns false if nothing is queued.
+bool injection_scheduler_next_event_us(uint32_t* time_us);
+
+// Diagnostics
+uint32_t injection_scheduler_get_pulse_count(void);
+uint32_t injection_scheduler_get_late_count(void);
+uint32_t injection_scheduler_get_overlap_count(void);   // Opens delayed for INJECTION_MIN_OFF_US
+uint32_t injection_scheduler_get_overrun_count(void);   // Pulses dropped, queue full
+
+#endif
@@ -6,19 +6,22 @@
 
 #include "input_manager.h"
 #include "sensor_calibration.h"
+#include "adc_sampler.h"
+#include "ads1015_driver.h"
+#include "i2c_bus.h"
+#include "freq_capture.h"
 #include "msg_bus.h"
+#include "memory_placement.h"
 #include <stdbool.h>
 #include <Arduino.h>
 
 // I2C device includes (Arduino only)
 #ifdef ARDUINO
-#include <Adafruit_ADS1X15.h>
 #include <Adafruit_MCP23X17.h>
 #include "ecu_config.h"
 #include "config_manager.h"
 
 // Global access to I2C devices
-extern Adafruit_ADS1015 ads1015;
 extern Adafruit_MCP23X17 mcp;
 extern ConfigManager config_manager;
 #endif
@@ -31,19 +34,67 @@ extern ConfigManager config_manager;
 #define FREQ_EDGE_FALLING  1  
 #define FREQ_EDGE_CHANGE   2
 
+// ADS1015 at GAIN_TWOTHIRDS: +/-6.144 V full scale
+#define ADS1015_VOLTS_PER_COUNT (6.144f / 32767.0f)
+
 // =============================================================================
 // PRIVATE DATA
 // =============================================================================
 
-// Registered sensors
-static sensor_definition_t sensors[MAX_SENSORS];
-static sensor_runtime_t sensor_runtime[MAX_SENSORS];
+// Acquires one sample of a sensor and calibrates it; false = no value this pass
+typedef bool (*sensor_reader_t)(uint8_t sensor_index, float* calibrated);
+
+// Registered sensors, split by access pattern:
+// - sensor_hot: structure-of-arrays read by every scheduler pass and update.
+//   Each field is packed, so a pass over N sensors touches N consecutive
+//   entries per field. Default .bss, which is DTCM on Teensy 4.1.
+// - sensor_diag / sensors: diagnostics and the full definitions (config
+//   union, name). Used by calibration of some types, errors and status
+//   queries only, so they live in RAM2 on Teensy 4.1 and leave DTCM free.
+typedef struct {
+    uint32_t next_due_us[MAX_SENSORS];          // Scheduler key
+    uint32_t update_interval_us[MAX_SENSORS];
+    uint32_t last_update_us[MAX_SENSORS];
+    float calibrated_value[MAX_SENSORS];
+    uint32_t msg_id[MAX_SENSORS];
+    uint16_t raw_counts[MAX_SENSORS];
+    uint8_t type[MAX_SENSORS];                  // sensor_type_t
+    uint8_t pin[MAX_SENSORS];
+    uint8_t is_valid[MAX_SENSORS];
+    uint8_t first_reading[MAX_SENSORS];         // 1 = no filter state yet
+    float publish_deadband[MAX_SENSORS];
+    uint32_t publish_heartbeat_us[MAX_SENSORS];  // 0 = publish every update
+    float last_published_value[MAX_SENSORS];
+    uint32_t last_publish_us[MAX_SENSORS];
+    uint8_t has_published[MAX_SENSORS];         // 0 = next value publishes unconditionally
+    sensor_reader_t reader[MAX_SENSORS];        // Resolved from type at registration
+} sensor_hot_data_t;
+
+typedef struct {
+    float raw_voltage;
+    uint32_t update_count;
+    uint32_t max_lateness_us;
+    uint32_t missed_deadlines;
+    uint32_t suppressed_publishes;
+    uint8_t error_count;
+} sensor_diagnostics_t;
+
+// Cold arrays are not zeroed at boot - input_manager_init() clears them
+static sensor_hot_data_t sensor_hot ECU_HOT_DATA;
+static sensor_diagnostics_t sensor_diag[MAX_SENSORS] ECU_COLD_DATA;
+static sensor_definition_t sensors[MAX_SENSORS] ECU_COLD_DATA;
 static uint8_t sensor_count = 0;
 
 // Statistics
 static uint32_t total_updates = 0;
+static uint32_t total_suppressed_publishes = 0;
 static uint32_t total_errors = 0;
 
+// Deadline scheduler: binary min-heap of sensor indices ordered by
+// sensor_hot.next_due_us[], so each pass only touches sensors that are due
+static uint8_t schedule_heap[MAX_SENSORS];
+static uint8_t schedule_heap_size = 0;
+
 // =============================================================================
 // HIGH-PERFORMANCE INTERRUPT-BASED FREQUENCY COUNTERS
 // =============================================================================
@@ -91,15 +142,80 @@ typedef struct {
 
 static polling_freq_state_t polling_freq_state[MAX_SENSORS];
 
+// MCP23017 port snapshot shared by all SENSOR_I2C_GPIO sensors
+#define GPIO_SNAPSHOT_REFRESH_US 100000     // INT mode: re-read at least this often
+
+static uint16_t gpio_port_snapshot = 0xFFFF;
+static uint8_t gpio_snapshot_current = 0;   // 1 = already read this pass
+static uint8_t gpio_int_attached = 0;       // 1 = reads are triggered by the MCP23017 INT pin
+static volatile uint8_t gpio_change_pending = 1;
+static uint32_t gpio_last_read_us = 0;
+static uint32_t gpio_port_reads = 0;
+static uint8_t gpio_expander_address = 0x20;
+static volatile uint8_t gpio_read_in_flight = 0;
+
+#define GPIO_EXPANDER_I2C_BUS    I2C_BUS_PRIMARY
+#define MCP23017_REG_GPIOA       0x12        // GPIOB follows (IOCON.BANK = 0)
+
+#ifdef TESTING
+static bool mcp23017_mock_device(uint8_t address, const uint8_t* write_data, uint8_t write_length,
+                                 uint8_t* read_data, uint8_t read_length);
+#endif
+
+// Frequency sensors measured by QuadTimer input capture (see freq_capture.h)
+typedef struct {
+    uint8_t active;                // 1 = pin is captured, 0 = interrupt counter or polling
+    uint32_t last_message_us;      // Time of last message publication
+} capture_freq_state_t;
+
+static capture_freq_state_t capture_freq_state[MAX_SENSORS];
+
+// Float linear calibration folded into ADS1015 counts: value = offset +
+// counts * slope between the clamp points
+typedef struct {
+    float slope;
+    float offset;
+    float min_counts;
+    float max_counts;
+    float min_value;
+    float max_value;
+} linear_counts_t;
+
+// Per-sensor coefficients precomputed at registration so the per-sample
+// path has no divisions
+typedef struct {
+    float filter_alpha;            // EMA weight for new samples
+    q16_16_t filter_alpha_q16;     // Same weight in Q16.16
+    q16_16_t filtered_q16;         // Fixed-point filter state
+    linear_fixed_t linear;         // Counts-domain linear calibration
+    uint8_t use_fixed_point;       // 1 = counts to filtered value entirely in Q16.16
+    linear_counts_t i2c_adc;       // ADS1015 counts to value (SENSOR_I2C_ADC)
+} sensor_coefficients_t;
+
+static sensor_coefficients_t sensor_coeffs[MAX_SENSORS];
+
 // =============================================================================
 // PRIVATE FUNCTION DECLARATIONS
 // =============================================================================
 
-static void update_single_sensor(uint8_t sensor_index);
+static bool update_single_sensor(uint8_t sensor_index, float* value);
+static bool read_analog_counts(uint8_t sensor_index);
+static sensor_reader_t resolve_sensor_reader(sensor_type_t type);
+static void calibrate_linear_batch(const uint8_t* group, uint8_t count, float* values);
+static void calibrate_thermistor_batch(const uint8_t* group, uint8_t count, float* values);
+static bool finish_sensor_update(uint8_t sensor_index, float value);
 static void configure_sensor_pin(const sensor_definition_t* sensor, uint8_t sensor_index);
 static float apply_sensor_filtering(uint8_t sensor_index, float new_value);
+static q16_16_t apply_sensor_filtering_fixed(uint8_t sensor_index, q16_16_t new_value);
+static void prepare_sensor_coefficients(uint8_t sensor_index);
+static void reset_sensor_state(uint8_t sensor_index);
 static void publish_sensor_value(uint32_t msg_id, float value);
+static bool publish_due(uint8_t sensor_index, uint32_t now_us);
+static uint16_t get_gpio_snapshot(void);
 static void handle_sensor_error(uint8_t sensor_index);
+static void schedule_push(uint8_t sensor_index);
+static uint8_t schedule_pop(void);
+static inline bool due_before(uint8_t a, uint8_t b);
 static uint32_t measure_frequency_polling(uint8_t sensor_index);
 static uint32_t measure_frequency_interrupt(uint8_t sensor_index);
 
@@ -124,22 +240,31 @@ static void freq_counter_isr_7(void);
 // PUBLIC FUNCTIONS
 // =============================================================================
 
-void input_manager_init(void) {
+ECU_COLD_CODE void input_manager_init(void) {
     // Reset all data
     sensor_count = 0;
     total_updates = 0;
+    total_suppressed_publishes = 0;
+    
+    gpio_port_snapshot = 0xFFFF;
+    gpio_snapshot_current = 0;
+    gpio_change_pending = 1;
+    gpio_last_read_us = 0;
+    gpio_port_reads = 0;
+    gpio_read_in_flight = 0;
     total_errors = 0;
+    schedule_heap_size = 0;
     
     // Initialize runtime data
     for (uint8_t i = 0; i < MAX_SENSORS; i++) {
-        sensor_runtime[i].calibrated_value = 0.0f;
-        sensor_runtime[i].raw_voltage = 0.0f;
-        sensor_runtime[i].raw_counts = 0;
-        sensor_runtime[i].last_update_us = 0;
-        sensor_runtime[i].update_count = 0;
-        sensor_runtime[i].is_valid = 0;
-        sensor_runtime[i].error_count = 0;
-        sensor_runtime[i].first_reading = 1;
+        reset_sensor_state(i);
+        sensor_hot.next_due_us[i] = 0;
+        sensor_hot.update_interval_us[i] = 0;
+        sensor_hot.msg_id[i] = 0;
+        sensor_hot.type[i] = 0;
+        sensor_hot.pin[i] = 0;
+        sensor_hot.publish_deadband[i] = 0.0f;
+        sensor_hot.publish_heartbeat_us[i] = 0;
         
         // Initialize polling frequency counter state
         polling_freq_state[i].last_pin_state = 0;
@@ -147,6 +272,9 @@ void input_manager_init(void) {
         polling_freq_state[i].transition_count = 0;
         polling_freq_state[i].measurement_start_us = 0;
         polling_freq_state[i].calculated_frequency = 0;
+        
+        capture_freq_state[i].active = 0;
+        capture_freq_state[i].last_message_us = 0;
     }
     
     // Initialize interrupt-based frequency counters
@@ -175,7 +303,20 @@ void input_manager_init(void) {
     // Configure ADC for performance
     analogReadResolution(12);
     analogReadAveraging(1);  // No averaging - we'll do our own filtering
+    #endif
+    
+    // Analog pins are scanned in the background once registered
+    adc_sampler_init();
+    ads1015_driver_init();
+    #ifdef TESTING
+    i2c_bus_attach_mock_device(GPIO_EXPANDER_I2C_BUS, gpio_expander_address, mcp23017_mock_device);
+    #endif
+    
+    // Frequency inputs on QuadTimer pins are timestamped in hardware
+    freq_capture_init();
     
+    #ifdef ARDUINO
+
     Serial.println("InputManager: Initialized");
     #endif
 }
@@ -189,12 +330,42 @@ uint8_t input_manager_register_sensors(const sensor_definition_t* new_sensors, u
         
         // Configure the pin
         configure_sensor_pin(&sensors[sensor_count], sensor_count);
+        prepare_sensor_coefficients(sensor_count);
+        
+        // Hot copies of the fields the update path reads every time
+        sensor_hot.update_interval_us[sensor_count] = sensors[sensor_count].update_interval_us;
+        sensor_hot.msg_id[sensor_count] = sensors[sensor_count].msg_id;
+        sensor_hot.type[sensor_count] = (uint8_t)sensors[sensor_count].type;
+        sensor_hot.pin[sensor_count] = sensors[sensor_count].pin;
+        sensor_hot.reader[sensor_count] = resolve_sensor_reader(sensors[sensor_count].type);
+        sensor_hot.publish_deadband[sensor_count] = sensors[sensor_count].publish_deadband;
+        sensor_hot.publish_heartbeat_us[sensor_count] = sensors[sensor_count].publish_heartbeat_us;
         
         // Reset runtime data for this sensor
-        sensor_runtime[sensor_count].calibrated_value = 0.0f;
-        sensor_runtime[sensor_count].last_update_us = 0;
-        sensor_runtime[sensor_count].is_valid = 0;
-        sensor_runtime[sensor_count].first_reading = 1;
+        reset_sensor_state(sensor_count);
+        
+        // First update is due one interval after time zero, as before
+        // scheduling (last_update_us starts at 0)
+        sensor_hot.next_due_us[sensor_count] = sensors[sensor_count].update_interval_us;
+        schedule_push(sensor_count);
+        
+        // On-chip analog inputs are sampled by the ADC scan instead of analogRead()
+        if (sensors[sensor_count].type == SENSOR_ANALOG_LINEAR ||
+            sensors[sensor_count].type == SENSOR_THERMISTOR) {
+            adc_sampler_add_pin(sensors[sensor_count].pin);
+        }
+        
+        // External ADC channels join the ADS1015 round robin
+        if (sensors[sensor_count].type == SENSOR_I2C_ADC) {
+            ads1015_driver_enable_channel(sensors[sensor_count].config.i2c_adc.channel);
+        }
+        
+        // Continuous readings only need the latest value on the bus; digital
+        // inputs keep every edge so presses and switch changes are never merged
+        if (sensors[sensor_count].type != SENSOR_DIGITAL_PULLUP &&
+            sensors[sensor_count].type != SENSOR_I2C_GPIO) {
+            g_message_bus.setCoalesce(sensors[sensor_count].msg_id, true);
+        }
         
         #ifdef ARDUINO
         Serial.print("InputManager: Registered sensor '");
@@ -212,22 +383,100 @@ uint8_t input_manager_register_sensors(const sensor_definition_t* new_sensors, u
     return registered;
 }
 
-void input_manager_update(void) {
+ECU_HOT_CODE void input_manager_update(void) {
+    // Completed I2C transactions land first (ADS1015 steps, GPIO snapshot)
+    i2c_bus_service();
+    
+    // One short ADS1015 transaction queued at most; I2C ADC sensors read its cache
+    ads1015_driver_service();
+    
+    // I2C GPIO sensors due this pass share one port read
+    gpio_snapshot_current = 0;
+    
     uint32_t now_us = micros();
     
-    // Update each sensor on its own schedule
-    for (uint8_t i = 0; i < sensor_count; i++) {
-        uint32_t time_since_last = now_us - sensor_runtime[i].last_update_us;
+    // Pop every sensor that is due. They are collected first and re-queued
+    // afterwards so zero-interval sensors run once per pass, not forever.
+    uint8_t due[MAX_SENSORS];
+    uint8_t due_count = 0;
+    while (schedule_heap_size > 0 &&
+           (int32_t)(now_us - sensor_hot.next_due_us[schedule_heap[0]]) >= 0) {
+        due[due_count++] = schedule_pop();
+    }
+    
+    // Due sensors are grouped by calibration kernel: fixed-point linear
+    // sensors and thermistors only read their counts here and are calibrated
+    // a group at a time below; other types take the per-sensor path.
+    // Everything is published once, at the end of the pass.
+    uint8_t linear_group[MAX_SENSORS];
+    uint8_t thermistor_group[MAX_SENSORS];
+    uint8_t publish_list[MAX_SENSORS];
+    uint8_t linear_count = 0;
+    uint8_t thermistor_count = 0;
+    uint8_t publish_count = 0;
+    
+    for (uint8_t d = 0; d < due_count; d++) {
+        uint8_t i = due[d];
+        uint32_t interval_us = sensor_hot.update_interval_us[i];
+        sensor_diagnostics_t* diag = &sensor_diag[i];
         
-        if (time_since_last >= sensors[i].update_interval_us) {
-            update_single_sensor(i);
-            sensor_runtime[i].last_update_us = now_us;
-            total_updates++;
+        uint32_t lateness_us = now_us - sensor_hot.next_due_us[i];
+        if (lateness_us > diag->max_lateness_us) {
+            diag->max_lateness_us = lateness_us;
+        }
+        if (interval_us > 0 && lateness_us >= interval_us) {
+            diag->missed_deadlines++;
+        }
+        
+        uint8_t type = sensor_hot.type[i];
+        if (type == SENSOR_ANALOG_LINEAR && sensor_coeffs[i].use_fixed_point) {
+            if (read_analog_counts(i)) {
+                linear_group[linear_count++] = i;
+            }
+        } else if (type == SENSOR_THERMISTOR) {
+            if (read_analog_counts(i)) {
+                thermistor_group[thermistor_count++] = i;
+            }
+        } else {
+            float value;
+            if (update_single_sensor(i, &value) && finish_sensor_update(i, value)) {
+                publish_list[publish_count++] = i;
+            }
+        }
+        sensor_hot.last_update_us[i] = now_us;
+        total_updates++;
+        
+        // Next period counts from the actual update time, so a late pass
+        // does not cause a burst of catch-up reads
+        sensor_hot.next_due_us[i] = now_us + interval_us;
+        schedule_push(i);
+    }
+    
+    float values[MAX_SENSORS];
+    calibrate_linear_batch(linear_group, linear_count, values);
+    for (uint8_t k = 0; k < linear_count; k++) {
+        if (finish_sensor_update(linear_group[k], values[k])) {
+            publish_list[publish_count++] = linear_group[k];
+        }
+    }
+    
+    calibrate_thermistor_batch(thermistor_group, thermistor_count, values);
+    for (uint8_t k = 0; k < thermistor_count; k++) {
+        if (finish_sensor_update(thermistor_group[k], values[k])) {
+            publish_list[publish_count++] = thermistor_group[k];
+        }
+    }
+    
+    for (uint8_t k = 0; k < publish_count; k++) {
+        uint8_t i = publish_list[k];
+        if (publish_due(i, now_us)) {
+            publish_sensor_value(sensor_hot.msg_id[i], sensor_hot.calibrated_value[i]);
         }
     }
     
-    // Update interrupt-based frequency calculations
+    // Update interrupt-based and input-capture frequency calculations
     update_interrupt_frequency_calculations();
+    freq_capture_update();
 }
 
 // =============================================================================
@@ -241,7 +490,7 @@ uint8_t input_manager_get_sensor_count(void) {
 uint8_t input_manager_get_valid_sensor_count(void) {
     uint8_t valid_count = 0;
     for (uint8_t i = 0; i < sensor_count; i++) {
-        if (sensor_runtime[i].is_valid) {
+        if (sensor_hot.is_valid[i]) {
             valid_count++;
         }
     }
@@ -252,22 +501,59 @@ uint32_t input_manager_get_total_updates(void) {
     return total_updates;
 }
 
+uint32_t input_manager_get_gpio_port_reads(void) {
+    return gpio_port_reads;
+}
+
+uint32_t input_manager_get_total_suppressed_publishes(void) {
+    return total_suppressed_publishes;
+}
+
 uint32_t input_manager_get_total_errors(void) {
     return total_errors;
 }
 
+uint32_t input_manager_get_missed_deadlines(void) {
+    uint32_t missed = 0;
+    for (uint8_t i = 0; i < sensor_count; i++) {
+        missed += sensor_diag[i].missed_deadlines;
+    }
+    return missed;
+}
+
+uint32_t input_manager_get_time_until_next_us(void) {
+    if (schedule_heap_size == 0) {
+        return UINT32_MAX;
+    }
+    int32_t remaining = (int32_t)(sensor_hot.next_due_us[schedule_heap[0]] - micros());
+    return (remaining > 0) ? (uint32_t)remaining : 0;
+}
+
 uint8_t input_manager_get_sensor_status(uint8_t sensor_index, sensor_runtime_t* status) {
     if (sensor_index >= sensor_count || status == NULL) {
         return 0;  // Invalid index or null pointer
     }
     
-    *status = sensor_runtime[sensor_index];
+    // Assemble the public view from hot and cold storage
+    const sensor_diagnostics_t* diag = &sensor_diag[sensor_index];
+    status->calibrated_value = sensor_hot.calibrated_value[sensor_index];
+    status->raw_voltage = diag->raw_voltage;
+    status->raw_counts = sensor_hot.raw_counts[sensor_index];
+    status->last_update_us = sensor_hot.last_update_us[sensor_index];
+    status->update_count = diag->update_count;
+    status->is_valid = sensor_hot.is_valid[sensor_index];
+    status->error_count = diag->error_count;
+    status->first_reading = sensor_hot.first_reading[sensor_index];
+    status->next_due_us = sensor_hot.next_due_us[sensor_index];
+    status->max_lateness_us = diag->max_lateness_us;
+    status->missed_deadlines = diag->missed_deadlines;
+    status->suppressed_publishes = diag->suppressed_publishes;
     return 1;  // Success
 }
 
 int8_t input_manager_find_sensor_by_msg_id(uint32_t msg_id) {
     for (uint8_t i = 0; i < sensor_count; i++) {
-        if (sensors[i].msg_id == msg_id) {
+        if (sensor_hot.msg_id[i] == msg_id) {
             return i;
         }
     }
@@ -292,142 +578,244 @@ uint8_t input_manager_get_interrupt_freq_counter_count(void) {
 // PRIVATE FUNCTIONS
 // =============================================================================
 
-static void update_single_sensor(uint8_t sensor_index) {
-    const sensor_definition_t* sensor = &sensors[sensor_index];
-    sensor_runtime_t* runtime = &sensor_runtime[sensor_index];
+// Due-time comparison that survives micros() wraparound
+static inline bool due_before(uint8_t a, uint8_t b) {
+    return (int32_t)(sensor_hot.next_due_us[a] - sensor_hot.next_due_us[b]) < 0;
+}
+
+static void schedule_push(uint8_t sensor_index) {
+    uint8_t pos = schedule_heap_size++;
+    schedule_heap[pos] = sensor_index;
     
-    // Debug output for fluid temperature sensor (disabled to reduce serial clutter)
-    /*
-    #ifdef ARDUINO
-    static uint32_t last_fluid_temp_debug = 0;
-    uint32_t now = millis();
-    if (sensor->msg_id == MSG_TRANS_FLUID_TEMP && now - last_fluid_temp_debug >= 5000) {
-            // Serial.print("DEBUG: Reading fluid temp sensor on pin ");
-    // Serial.print(sensor->pin);
-    // Serial.print(" (A");
-    // Serial.print(sensor->pin - A0);
-    // Serial.println(")");
-        last_fluid_temp_debug = now;
+    // Sift up
+    while (pos > 0) {
+        uint8_t parent = (pos - 1) / 2;
+        if (!due_before(schedule_heap[pos], schedule_heap[parent])) {
+            break;
+        }
+        uint8_t tmp = schedule_heap[parent];
+        schedule_heap[parent] = schedule_heap[pos];
+        schedule_heap[pos] = tmp;
+        pos = parent;
     }
-    #endif
-    */
+}
+
+static uint8_t schedule_pop(void) {
+    uint8_t top = schedule_heap[0];
+    schedule_heap[0] = schedule_heap[--schedule_heap_size];
     
-    // Read raw sensor data
-    if (sensor->type == SENSOR_DIGITAL_PULLUP) {
-        uint8_t digital_value = digitalRead(sensor->pin);
-        
-        // Store raw reading - calibration function will handle inversion
-        runtime->raw_counts = digital_value;
-        runtime->raw_voltage = digital_value ? ADC_VOLTAGE_REF : 0.0f;
-    } else {
-        // Analog sensors
+    // Sift down
+    uint8_t pos = 0;
+    for (;;) {
+        uint8_t left = 2 * pos + 1;
+        uint8_t right = left + 1;
+        uint8_t smallest = pos;
+        if (left < schedule_heap_size && due_before(schedule_heap[left], schedule_heap[smallest])) {
+            smallest = left;
+        }
+        if (right < schedule_heap_size && due_before(schedule_heap[right], schedule_heap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            break;
+        }
+        uint8_t tmp = schedule_heap[smallest];
+        schedule_heap[smallest] = schedule_heap[pos];
+        schedule_heap[pos] = tmp;
+        pos = smallest;
+    }
+    return top;
+}
+
+// Read, validate and store the counts of an on-chip analog sensor.
+// Returns false (after error accounting when the reading is bad) if there
+// is nothing to calibrate this pass.
+static bool read_analog_counts(uint8_t sensor_index) {
+    const uint8_t pin = sensor_hot.pin[sensor_index];
+    uint16_t* raw_counts = &sensor_hot.raw_counts[sensor_index];
+    
+    // Latest background scan, or a direct read for pins the sampler does not own
+    if (!adc_sampler_get(pin, raw_counts)) {
         #ifdef ARDUINO
-        runtime->raw_counts = analogRead(sensor->pin);
-        #else
-        //runtime->raw_counts = 2048;  // Mock 12-bit reading
-        runtime->raw_counts = analogRead(sensor->pin);  // Use mock reading
+        if (adc_sampler_is_sampled(pin)) {
+            return false;  // First scan still running - analogRead() would disturb it
+        }
         #endif
-        runtime->raw_voltage = adc_counts_to_voltage(runtime->raw_counts);
+        *raw_counts = analogRead(pin);
     }
     
-    // Validate raw reading
-    if (!is_voltage_valid(runtime->raw_voltage) && sensor->type != SENSOR_DIGITAL_PULLUP) {
+    float raw_voltage = adc_counts_to_voltage(*raw_counts);
+    sensor_diag[sensor_index].raw_voltage = raw_voltage;
+    if (!is_voltage_valid(raw_voltage)) {
         handle_sensor_error(sensor_index);
-        return;
+        return false;
+    }
+    return true;
+}
+
+// Fixed-point linear kernel: one multiply-add, clamp and filter step per
+// sensor over the packed hot arrays, with no per-sensor type dispatch
+static void calibrate_linear_batch(const uint8_t* group, uint8_t count, float* values) {
+    for (uint8_t k = 0; k < count; k++) {
+        uint8_t i = group[k];
+        q16_16_t value = calibrate_linear_fixed(&sensor_coeffs[i].linear, sensor_hot.raw_counts[i]);
+        values[k] = Q16_16_TO_FLOAT(apply_sensor_filtering_fixed(i, value));
+    }
+}
+
+// Thermistor kernel: counts-domain LUT (or table) lookup and filter step
+static void calibrate_thermistor_batch(const uint8_t* group, uint8_t count, float* values) {
+    for (uint8_t k = 0; k < count; k++) {
+        uint8_t i = group[k];
+        float value = calibrate_thermistor_counts(&sensors[i].config.thermistor, sensor_hot.raw_counts[i]);
+        values[k] = apply_sensor_filtering(i, value);
+    }
+}
+
+// Validate and store a calibrated, filtered value.
+// Returns true if it should be published.
+static bool finish_sensor_update(uint8_t sensor_index, float value) {
+    if (!validate_calibrated_reading((sensor_type_t)sensor_hot.type[sensor_index], value)) {
+        handle_sensor_error(sensor_index);
+        return false;
     }
     
-    // Calibrate reading based on sensor type
-    float calibrated_value;
-    switch (sensor->type) {
-        case SENSOR_ANALOG_LINEAR:
-            calibrated_value = calibrate_linear(&sensor->config.linear, runtime->raw_voltage);
-            break;
-            
-        case SENSOR_THERMISTOR:
-            calibrated_value = calibrate_thermistor(&sensor->config.thermistor, runtime->raw_voltage);
-            break;
-            
-        case SENSOR_DIGITAL_PULLUP:
-            calibrated_value = calibrate_digital(&sensor->config.digital, runtime->raw_counts);
-            break;
-            
-        case SENSOR_FREQUENCY_COUNTER: {
-            // Choose between interrupt-based or polling measurement
-            uint32_t measured_freq;
-            if (sensor->config.frequency.use_interrupts) {
-                // For interrupt-based sensors, check if it's time to publish
-                if (!should_publish_interrupt_message(sensor_index)) {
-                    return;  // Not time to publish yet
-                }
-                measured_freq = measure_frequency_interrupt(sensor_index);
-            } else {
-                measured_freq = measure_frequency_polling(sensor_index);
-            }
-            calibrated_value = calibrate_frequency(&sensor->config.frequency, measured_freq);
-            break;
-        }
-            
-        case SENSOR_I2C_ADC: {
-            #ifdef ARDUINO
-            // Read from ADS1015 ADC
-            int16_t adc_value = read_ads1015_channel(sensor->config.i2c_adc.channel);
-            runtime->raw_counts = adc_value;
-            runtime->raw_voltage = (adc_value * 6.144f) / 32767.0f; // Convert to voltage based on ±6.144V range
-            #else
-            // Mock reading for testing
-            runtime->raw_counts = 16384; // Mid-range 16-bit reading
-            runtime->raw_voltage = 3.0f; // Mock voltage
-            #endif
-            
-            // Create linear config structure for calibration
-            linear_config_t linear_config = {
-                .min_voltage = sensor->config.i2c_adc.min_voltage,
-                .max_voltage = sensor->config.i2c_adc.max_voltage,
-                .min_value = sensor->config.i2c_adc.min_value,
-                .max_value = sensor->config.i2c_adc.max_value,
-                .pullup_ohms = 0
-            };
-            calibrated_value = calibrate_linear(&linear_config, runtime->raw_voltage);
-            break;
-        }
-            
-        case SENSOR_I2C_GPIO: {
-            // Read from MCP23017 GPIO (works in both Arduino and testing environments)
-            bool gpio_value = read_mcp23017_pin(sensor->config.i2c_gpio.pin);
-            runtime->raw_counts = gpio_value ? 1 : 0;
-            runtime->raw_voltage = gpio_value ? ADC_VOLTAGE_REF : 0.0f;
-            
-            // Create digital config structure for calibration
-            digital_config_t digital_config = {
-                .use_pullup = sensor->config.i2c_gpio.use_pullup,
-                .invert_logic = sensor->config.i2c_gpio.invert_logic
-            };
-            calibrated_value = calibrate_digital(&digital_config, runtime->raw_counts);
-            break;
+    sensor_hot.calibrated_value[sensor_index] = value;
+    sensor_hot.is_valid[sensor_index] = 1;
+    sensor_diag[sensor_index].error_count = 0;
+    sensor_diag[sensor_index].update_count++;
+    return true;
+}
+
+// Per-type readers, resolved once at registration (sensor_hot.reader).
+// Each acquires one sample and produces the calibrated, unfiltered value;
+// returns false if there is none this pass.
+static bool read_linear_sensor(uint8_t sensor_index, float* calibrated) {
+    if (!read_analog_counts(sensor_index)) {
+        return false;
+    }
+    *calibrated = calibrate_linear(&sensors[sensor_index].config.linear, sensor_diag[sensor_index].raw_voltage);
+    return true;
+}
+
+static bool read_thermistor_sensor(uint8_t sensor_index, float* calibrated) {
+    if (!read_analog_counts(sensor_index)) {
+        return false;
+    }
+    *calibrated = calibrate_thermistor_counts(&sensors[sensor_index].config.thermistor,
+                                              sensor_hot.raw_counts[sensor_index]);
+    return true;
+}
+
+static bool read_digital_sensor(uint8_t sensor_index, float* calibrated) {
+    uint8_t digital_value = digitalRead(sensor_hot.pin[sensor_index]);
+    
+    // Store raw reading - calibration function will handle inversion
+    sensor_hot.raw_counts[sensor_index] = digital_value;
+    sensor_diag[sensor_index].raw_voltage = digital_value ? ADC_VOLTAGE_REF : 0.0f;
+    *calibrated = calibrate_digital(&sensors[sensor_index].config.digital, digital_value);
+    return true;
+}
+
+static bool read_frequency_sensor(uint8_t sensor_index, float* calibrated) {
+    const frequency_config_t* config = &sensors[sensor_index].config.frequency;
+    
+    if (capture_freq_state[sensor_index].active) {
+        // Hardware capture: same publish rate limit as the interrupt counters
+        uint32_t now_us = micros();
+        uint32_t message_interval_us = 1000000UL / config->message_update_rate_hz;
+        if (now_us - capture_freq_state[sensor_index].last_message_us < message_interval_us) {
+            return false;  // Not time to publish yet
         }
-            
-        default:
-            calibrated_value = 0.0f;
-            break;
+        capture_freq_state[sensor_index].last_message_us = now_us;
+        
+        float captured_hz = 0.0f;
+        freq_capture_get(sensor_hot.pin[sensor_index], &captured_hz);
+        sensor_hot.raw_counts[sensor_index] = (uint16_t)(captured_hz > 65535.0f ? 65535.0f : captured_hz);
+        *calibrated = calibrate_frequency_hz(config, captured_hz);
+        return true;
     }
     
-    // Apply filtering
-    calibrated_value = apply_sensor_filtering(sensor_index, calibrated_value);
+    // Choose between interrupt-based or polling measurement
+    uint32_t measured_freq;
+    if (config->use_interrupts) {
+        // For interrupt-based sensors, check if it's time to publish
+        if (!should_publish_interrupt_message(sensor_index)) {
+            return false;  // Not time to publish yet
+        }
+        measured_freq = measure_frequency_interrupt(sensor_index);
+    } else {
+        measured_freq = measure_frequency_polling(sensor_index);
+    }
+    *calibrated = calibrate_frequency(config, measured_freq);
+    return true;
+}
+
+static bool read_i2c_adc_sensor(uint8_t sensor_index, float* calibrated) {
+    // Latest cached ADS1015 conversion - the bus is never waited on here
+    int16_t adc_value;
+    if (!ads1015_driver_get(sensors[sensor_index].config.i2c_adc.channel, &adc_value)) {
+        return false;  // No conversion for this channel yet
+    }
+    sensor_hot.raw_counts[sensor_index] = (uint16_t)adc_value;
+    sensor_diag[sensor_index].raw_voltage = adc_value * ADS1015_VOLTS_PER_COUNT;
     
-    // Validate calibrated reading
-    if (!validate_calibrated_reading(sensor->type, calibrated_value)) {
-        handle_sensor_error(sensor_index);
-        return;
+    // Counts-domain coefficients prepared at registration
+    // (same result as calibrate_linear() on the converted voltage)
+    const linear_counts_t* linear = &sensor_coeffs[sensor_index].i2c_adc;
+    float counts = (float)adc_value;
+    if (counts <= linear->min_counts) {
+        *calibrated = linear->min_value;
+    } else if (counts >= linear->max_counts) {
+        *calibrated = linear->max_value;
+    } else {
+        *calibrated = linear->offset + counts * linear->slope;
     }
+    return true;
+}
+
+static bool read_i2c_gpio_sensor(uint8_t sensor_index, float* calibrated) {
+    const i2c_gpio_config_t* config = &sensors[sensor_index].config.i2c_gpio;
     
-    // Update runtime data
-    runtime->calibrated_value = calibrated_value;
-    runtime->is_valid = 1;
-    runtime->error_count = 0;
-    runtime->update_count++;
+    // Pin from the shared MCP23017 port snapshot (works in both Arduino and testing environments)
+    uint8_t gpio_value = (get_gpio_snapshot() >> (config->pin & 0x0F)) & 1;
+    sensor_hot.raw_counts[sensor_index] = gpio_value;
+    sensor_diag[sensor_index].raw_voltage = gpio_value ? ADC_VOLTAGE_REF : 0.0f;
     
-    // Publish to message bus
-    publish_sensor_value(sensor->msg_id, calibrated_value);
+    // Same result as calibrate_digital() with invert_logic
+    *calibrated = (float)(config->invert_logic ? !gpio_value : gpio_value);
+    return true;
+}
+
+static bool read_unsupported_sensor(uint8_t sensor_index, float* calibrated) {
+    (void)sensor_index;
+    (void)calibrated;
+    return false;
+}
+
+// Indexed by sensor_type_t
+static const sensor_reader_t sensor_reader_table[SENSOR_TYPE_COUNT] = {
+    read_linear_sensor,         // SENSOR_ANALOG_LINEAR
+    read_thermistor_sensor,     // SENSOR_THERMISTOR
+    read_digital_sensor,        // SENSOR_DIGITAL_PULLUP
+    read_frequency_sensor,      // SENSOR_FREQUENCY_COUNTER
+    read_i2c_adc_sensor,        // SENSOR_I2C_ADC
+    read_i2c_gpio_sensor        // SENSOR_I2C_GPIO
+};
+
+static sensor_reader_t resolve_sensor_reader(sensor_type_t type) {
+    return (type < SENSOR_TYPE_COUNT) ? sensor_reader_table[type] : read_unsupported_sensor;
+}
+
+// General per-sensor path for types without a batch kernel: the resolved
+// reader, then the filter step
+static bool update_single_sensor(uint8_t sensor_index, float* value) {
+    float calibrated_value;
+    if (!sensor_hot.reader[sensor_index](sensor_index, &calibrated_value)) {
+        return false;
+    }
+    *value = apply_sensor_filtering(sensor_index, calibrated_value);
+    return true;
 }
 
 static void configure_sensor_pin(const sensor_definition_t* sensor, uint8_t sensor_index) {
@@ -447,8 +835,14 @@ static void configure_sensor_pin(const sensor_definition_t* sensor, uint8_t sens
             
         case SENSOR_FREQUENCY_COUNTER:
             pinMode(sensor->pin, INPUT);
-            // Register interrupt-based counter if requested
-            if (sensor->config.frequency.use_interrupts) {
+            // Interrupt mode: QuadTimer capture where the pin allows it,
+            // otherwise an attachInterrupt edge counter
+            if (sensor->config.frequency.use_interrupts &&
+                freq_capture_add_pin(sensor->pin, sensor->config.frequency.trigger_edge,
+                                     sensor->config.frequency.timeout_us)) {
+                capture_freq_state[sensor_index].active = 1;
+                capture_freq_state[sensor_index].last_message_us = micros();
+            } else if (sensor->config.frequency.use_interrupts) {
                 #ifdef ARDUINO
                 register_interrupt_frequency_counter(sensor_index, sensor->pin, 
                                                    sensor->config.frequency.trigger_edge);
@@ -472,20 +866,146 @@ static void configure_sensor_pin(const sensor_definition_t* sensor, uint8_t sens
     }
 }
 
-static float apply_sensor_filtering(uint8_t sensor_index, float new_value) {
-    sensor_runtime_t* runtime = &sensor_runtime[sensor_index];
+static void prepare_sensor_coefficients(uint8_t sensor_index) {
     const sensor_definition_t* sensor = &sensors[sensor_index];
+    sensor_coefficients_t* coeffs = &sensor_coeffs[sensor_index];
+    
+    // filter_strength: 0 = no filtering, 255 = maximum filtering
+    coeffs->filter_alpha = (255.0f - sensor->filter_strength) / 255.0f;
+    coeffs->filter_alpha_q16 = filter_alpha_fixed(sensor->filter_strength);
+    coeffs->filtered_q16 = 0;
+    coeffs->use_fixed_point = 0;
+    
+    if (sensor->type == SENSOR_I2C_ADC) {
+        const i2c_adc_config_t* config = &sensor->config.i2c_adc;
+        linear_counts_t* linear = &coeffs->i2c_adc;
+        float voltage_range = config->max_voltage - config->min_voltage;
+        float value_per_volt = (voltage_range != 0.0f) ? (config->max_value - config->min_value) / voltage_range : 0.0f;
+        linear->min_counts = config->min_voltage / ADS1015_VOLTS_PER_COUNT;
+        linear->max_counts = config->max_voltage / ADS1015_VOLTS_PER_COUNT;
+        linear->min_value = config->min_value;
+        linear->max_value = config->max_value;
+        linear->slope = ADS1015_VOLTS_PER_COUNT * value_per_volt;
+        linear->offset = config->min_value - config->min_voltage * value_per_volt;
+    }
+    
+    #if INPUT_MANAGER_FIXED_POINT
+    // Ranges beyond Q16.16 (about +/-32767) stay on the float path
+    if (sensor->type == SENSOR_ANALOG_LINEAR) {
+        coeffs->use_fixed_point = calibrate_linear_fixed_prepare(&sensor->config.linear, &coeffs->linear) ? 1 : 0;
+    }
+    #endif
+}
+
+static void reset_sensor_state(uint8_t sensor_index) {
+    sensor_hot.calibrated_value[sensor_index] = 0.0f;
+    sensor_hot.raw_counts[sensor_index] = 0;
+    sensor_hot.last_update_us[sensor_index] = 0;
+    sensor_hot.is_valid[sensor_index] = 0;
+    sensor_hot.first_reading[sensor_index] = 1;
+    sensor_hot.last_published_value[sensor_index] = 0.0f;
+    sensor_hot.last_publish_us[sensor_index] = 0;
+    sensor_hot.has_published[sensor_index] = 0;
     
-    if (runtime->first_reading) {
-        runtime->first_reading = 0;
+    sensor_diag[sensor_index].raw_voltage = 0.0f;
+    sensor_diag[sensor_index].update_count = 0;
+    sensor_diag[sensor_index].max_lateness_us = 0;
+    sensor_diag[sensor_index].missed_deadlines = 0;
+    sensor_diag[sensor_index].suppressed_publishes = 0;
+    sensor_diag[sensor_index].error_count = 0;
+}
+
+static float apply_sensor_filtering(uint8_t sensor_index, float new_value) {
+    if (sensor_hot.first_reading[sensor_index]) {
+        sensor_hot.first_reading[sensor_index] = 0;
         return new_value;  // No filtering on first reading
     }
     
     // Simple low-pass filter based on filter_strength
-    // filter_strength: 0 = no filtering, 255 = maximum filtering
-    float alpha = (255.0f - sensor->filter_strength) / 255.0f;
+    float alpha = sensor_coeffs[sensor_index].filter_alpha;
+    
+    return (alpha * new_value) + ((1.0f - alpha) * sensor_hot.calibrated_value[sensor_index]);
+}
+
+static q16_16_t apply_sensor_filtering_fixed(uint8_t sensor_index, q16_16_t new_value) {
+    sensor_coefficients_t* coeffs = &sensor_coeffs[sensor_index];
     
-    return (alpha * new_value) + ((1.0f - alpha) * runtime->calibrated_value);
+    if (sensor_hot.first_reading[sensor_index]) {
+        sensor_hot.first_reading[sensor_index] = 0;
+        coeffs->filtered_q16 = new_value;  // No filtering on first reading
+    } else {
+        coeffs->filtered_q16 = apply_filter_fixed(coeffs->filtered_q16, new_value, coeffs->filter_alpha_q16);
+    }
+    return coeffs->filtered_q16;
+}
+
+static void on_gpio_ports_read(i2c_result_t result, const uint8_t* read_data, uint8_t read_length, void* context) {
+    (void)context;
+    gpio_read_in_flight = 0;
+    if (result != I2C_RESULT_OK || read_length != 2) {
+        total_errors++;
+        gpio_change_pending = 1;    // Read again next pass
+        return;
+    }
+    gpio_port_snapshot = (uint16_t)(read_data[0] | ((uint16_t)read_data[1] << 8));
+    gpio_port_reads++;
+}
+
+// Both MCP23017 ports, read at most once per update pass. With the INT pin
+// attached, the previous snapshot is reused until the expander reports a
+// change or the refresh interval runs out. The read is queued; the
+// snapshot returned is the last one completed.
+static uint16_t get_gpio_snapshot(void) {
+    if (gpio_snapshot_current) {
+        return gpio_port_snapshot;
+    }
+    gpio_snapshot_current = 1;
+    
+    uint32_t now_us = micros();
+    if (gpio_read_in_flight ||
+        (gpio_int_attached && !gpio_change_pending &&
+         now_us - gpio_last_read_us < GPIO_SNAPSHOT_REFRESH_US)) {
+        return gpio_port_snapshot;
+    }
+    
+    // Clear before reading: a change during the read asserts INT again
+    gpio_change_pending = 0;
+    gpio_last_read_us = now_us;
+    gpio_read_in_flight = 1;
+    uint8_t reg = MCP23017_REG_GPIOA;
+    if (!i2c_bus_submit(GPIO_EXPANDER_I2C_BUS, gpio_expander_address, &reg, 1, 2, on_gpio_ports_read, nullptr)) {
+        gpio_read_in_flight = 0;
+        gpio_change_pending = 1;
+    }
+    return gpio_port_snapshot;
+}
+
+// Publish-on-change filter for a freshly stored value. Sensors without a
+// heartbeat publish every update; the rest publish on a change beyond the
+// deadband, when the heartbeat runs out, or first after (re)validation.
+static bool publish_due(uint8_t sensor_index, uint32_t now_us) {
+    uint32_t heartbeat_us = sensor_hot.publish_heartbeat_us[sensor_index];
+    if (heartbeat_us == 0) {
+        return true;
+    }
+    
+    float value = sensor_hot.calibrated_value[sensor_index];
+    float change = value - sensor_hot.last_published_value[sensor_index];
+    if (change < 0.0f) {
+        change = -change;
+    }
+    if (sensor_hot.has_published[sensor_index] &&
+        change <= sensor_hot.publish_deadband[sensor_index] &&
+        now_us - sensor_hot.last_publish_us[sensor_index] < heartbeat_us) {
+        sensor_diag[sensor_index].suppressed_publishes++;
+        total_suppressed_publishes++;
+        return false;
+    }
+    
+    sensor_hot.last_published_value[sensor_index] = value;
+    sensor_hot.last_publish_us[sensor_index] = now_us;
+    sensor_hot.has_published[sensor_index] = 1;
+    return true;
 }
 
 static void publish_sensor_value(uint32_t msg_id, float value) {
@@ -522,13 +1042,14 @@ static void publish_sensor_value(uint32_t msg_id, float value) {
 }
 
 static void handle_sensor_error(uint8_t sensor_index) {
-    sensor_runtime_t* runtime = &sensor_runtime[sensor_index];
+    sensor_diagnostics_t* diag = &sensor_diag[sensor_index];
     
-    runtime->error_count++;
+    diag->error_count++;
     total_errors++;
     
-    if (runtime->error_count >= MAX_CONSECUTIVE_ERRORS) {
-        runtime->is_valid = 0;  // Mark sensor as failed
+    if (diag->error_count >= MAX_CONSECUTIVE_ERRORS) {
+        sensor_hot.is_valid[sensor_index] = 0;  // Mark sensor as failed
+        sensor_hot.has_published[sensor_index] = 0;  // Republish as soon as it recovers
         
         #ifdef ARDUINO
         // Serial.print("InputManager: Sensor '");
@@ -544,7 +1065,7 @@ static uint32_t measure_frequency_polling(uint8_t sensor_index) {
     uint32_t now_us = micros();
     
     // Read current pin state
-    uint8_t current_state = digitalRead(sensor->pin);
+    uint8_t current_state = digitalRead(sensor_hot.pin[sensor_index]);
     
     // Initialize measurement period if this is the first reading
     if (freq->measurement_start_us == 0) {
@@ -1086,36 +1607,74 @@ static bool should_publish_interrupt_message(uint8_t sensor_index) {
 // I2C DEVICE HELPER FUNCTIONS
 // =============================================================================
 
-#ifdef ARDUINO
-// Function to read from ADS1015 ADC
+// Function to read from ADS1015 ADC (latest cached conversion, 0 if none yet)
 int16_t read_ads1015_channel(uint8_t channel) {
-    if (channel > 3) return 0;  // Invalid channel
-    
-    switch (channel) {
-        case 0: return ads1015.readADC_SingleEnded(0);
-        case 1: return ads1015.readADC_SingleEnded(1);
-        case 2: return ads1015.readADC_SingleEnded(2);
-        case 3: return ads1015.readADC_SingleEnded(3);
-        default: return 0;
-    }
+    int16_t value = 0;
+    ads1015_driver_get(channel, &value);
+    return value;
+}
+
+void input_manager_set_gpio_expander(uint8_t address) {
+    gpio_expander_address = address;
+    #ifdef TESTING
+    i2c_bus_attach_mock_device(GPIO_EXPANDER_I2C_BUS, address, mcp23017_mock_device);
+    #endif
 }
 
+#ifdef ARDUINO
+
+// The Adafruit calls below block on Wire; each holds the bus so queued
+// transactions never interleave with them
+
 // Function to read from MCP23017 GPIO expander
 bool read_mcp23017_pin(uint8_t pin) {
     if (pin > 15) return false;  // Invalid pin
-    return mcp.digitalRead(pin);
+    if (!i2c_bus_claim(GPIO_EXPANDER_I2C_BUS, I2C_BUS_TIMEOUT_US)) return false;
+    bool value = mcp.digitalRead(pin);
+    i2c_bus_release(GPIO_EXPANDER_I2C_BUS);
+    return value;
+}
+
+// Function to read both MCP23017 GPIO ports (one I2C transaction)
+uint16_t read_mcp23017_ports(void) {
+    if (!i2c_bus_claim(GPIO_EXPANDER_I2C_BUS, I2C_BUS_TIMEOUT_US)) return gpio_port_snapshot;
+    uint16_t ports = mcp.readGPIOAB();
+    i2c_bus_release(GPIO_EXPANDER_I2C_BUS);
+    return ports;
+}
+
+static void gpio_change_isr(void) {
+    gpio_change_pending = 1;
+}
+
+// MCP23017 INT (mirrored, active low) signals any input change
+void input_manager_attach_gpio_interrupt(uint8_t int_pin) {
+    if (!i2c_bus_claim(GPIO_EXPANDER_I2C_BUS, I2C_BUS_TIMEOUT_US)) return;
+    mcp.setupInterrupts(true, false, LOW);
+    for (uint8_t pin = 0; pin < 16; pin++) {
+        mcp.setupInterruptPin(pin, CHANGE);
+    }
+    i2c_bus_release(GPIO_EXPANDER_I2C_BUS);
+    pinMode(int_pin, INPUT_PULLUP);
+    gpio_change_pending = 1;
+    attachInterrupt(digitalPinToInterrupt(int_pin), gpio_change_isr, FALLING);
+    gpio_int_attached = 1;
 }
 
 // Function to write to MCP23017 GPIO expander
 void write_mcp23017_pin(uint8_t pin, bool value) {
     if (pin > 15) return;  // Invalid pin
+    if (!i2c_bus_claim(GPIO_EXPANDER_I2C_BUS, I2C_BUS_TIMEOUT_US)) return;
     mcp.digitalWrite(pin, value);
+    i2c_bus_release(GPIO_EXPANDER_I2C_BUS);
 }
 
 // Function to configure MCP23017 pin mode
 void configure_mcp23017_pin(uint8_t pin, uint8_t mode) {
     if (pin > 15) return;  // Invalid pin
+    if (!i2c_bus_claim(GPIO_EXPANDER_I2C_BUS, I2C_BUS_TIMEOUT_US)) return;
     mcp.pinMode(pin, mode);
+    i2c_bus_release(GPIO_EXPANDER_I2C_BUS);
 }
 
 // Function to print I2C device status
@@ -1134,16 +1693,58 @@ void print_i2c_status() {
     Serial.println("-------------------------");
 }
 #else
-// Mock implementations for testing environment
-int16_t read_ads1015_channel(uint8_t channel) {
-    return mock_ads1015_read_channel(channel);
-}
-
+// Mock implementations for testing environment; each charges the I2C
+// transactions the Adafruit driver would make to the virtual clock
 bool read_mcp23017_pin(uint8_t pin) {
+    mock_charge_i2c_transaction(2);     // Register pointer
+    mock_charge_i2c_transaction(2);     // One port byte
     return mock_mcp23017_read_pin(pin);
 }
 
+static uint16_t mock_mcp23017_ports(void) {
+    uint16_t ports = 0;
+    for (uint8_t pin = 0; pin < 16; pin++) {
+        if (mock_mcp23017_read_pin(pin)) {
+            ports |= (uint16_t)(1u << pin);
+        }
+    }
+    return ports;
+}
+
+uint16_t read_mcp23017_ports(void) {
+    mock_charge_i2c_transaction(2);
+    mock_charge_i2c_transaction(3);     // GPIOA and GPIOB
+    return mock_mcp23017_ports();
+}
+
+#ifdef TESTING
+// Register pointer write, then GPIOA/GPIOB reads from the mocked pins
+static uint8_t mcp23017_mock_pointer = MCP23017_REG_GPIOA;
+
+static bool mcp23017_mock_device(uint8_t address, const uint8_t* write_data, uint8_t write_length,
+                                 uint8_t* read_data, uint8_t read_length) {
+    (void)address;
+    if (write_length >= 1) {
+        mcp23017_mock_pointer = write_data[0];
+    }
+    if (read_length > 0 && mcp23017_mock_pointer == MCP23017_REG_GPIOA) {
+        uint16_t ports = mock_mcp23017_ports();
+        read_data[0] = (uint8_t)(ports & 0xFF);
+        if (read_length > 1) {
+            read_data[1] = (uint8_t)(ports >> 8);
+        }
+    }
+    return true;
+}
+#endif
+
+// No INT line in the mock: reads stay once per pass
+void input_manager_attach_gpio_interrupt(uint8_t int_pin) {
+    (void)int_pin;
+}
+
 void write_mcp23017_pin(uint8_t pin, bool value) {
+    mock_charge_i2c_transaction(3);     // Pointer and latch byte
     mock_mcp23017_write_pin(pin, value);
 }
 
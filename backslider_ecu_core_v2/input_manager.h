@@ -37,6 +37,11 @@ uint8_t input_manager_register_sensors(const sensor_definition_t* sensors, uint8
 // Main update function - call from main loop
 void input_manager_update(void);
 
+// Microseconds until the next sensor is due (0 = something is due now,
+// UINT32_MAX = no scheduled sensors). Lets the main loop run background work
+// or sleep until then.
+uint32_t input_manager_get_time_until_next_us(void);
+
 // =============================================================================
 // STATUS AND DIAGNOSTICS
 // =============================================================================
@@ -46,6 +51,8 @@ uint8_t input_manager_get_sensor_count(void);
 uint8_t input_manager_get_valid_sensor_count(void);
 uint32_t input_manager_get_total_updates(void);
 uint32_t input_manager_get_total_errors(void);
+uint32_t input_manager_get_total_suppressed_publishes(void);  // Updates held back by publish deadbands
+uint32_t input_manager_get_missed_deadlines(void);  // Sum over all sensors
 
 // Get individual sensor status (by index)
 uint8_t input_manager_get_sensor_status(uint8_t sensor_index, sensor_runtime_t* status);
@@ -69,7 +76,7 @@ uint8_t input_manager_get_interrupt_freq_counter_count(void);
 
 // Convert ADC counts to voltage (inline for performance)
 static inline float adc_counts_to_voltage(uint16_t counts) {
-    return (counts * ADC_VOLTAGE_REF) / ADC_RESOLUTION;
+    return counts * (ADC_VOLTAGE_REF / ADC_RESOLUTION);  // Constant folds to one multiply
 }
 
 // Validate voltage reading
@@ -86,13 +93,13 @@ static inline uint8_t is_voltage_valid(float voltage) {
     { \
         .pin = pin_name, \
         .type = SENSOR_ANALOG_LINEAR, \
-        .config.linear = { \
+        .config = { .linear = { \
             .min_voltage = min_v, \
             .max_voltage = max_v, \
             .min_value = min_val, \
             .max_value = max_val, \
             .pullup_ohms = 0 \
-        }, \
+        } }, \
         .msg_id = msg_id_name, \
         .update_interval_us = interval_us, \
         .filter_strength = 32, \
@@ -104,12 +111,31 @@ static inline uint8_t is_voltage_valid(float voltage) {
     { \
         .pin = pin_name, \
         .type = SENSOR_THERMISTOR, \
-        .config.thermistor = { \
+        .config = { .thermistor = { \
             .pullup_ohms = pullup_value, \
             .voltage_table = v_table, \
             .temp_table = t_table, \
             .table_size = size \
-        }, \
+        } }, \
+        .msg_id = msg_id_name, \
+        .update_interval_us = interval_us, \
+        .filter_strength = 128, \
+        .name = sensor_name \
+    }
+
+// Helper macro to define a thermistor sensor calibrated through a counts-domain
+// lookup table (e.g. STANDARD_THERMISTOR_COUNTS_LUT)
+#define DEFINE_THERMISTOR_LUT_SENSOR(pin_name, msg_id_name, pullup_value, v_table, t_table, size, lut, interval_us, sensor_name) \
+    { \
+        .pin = pin_name, \
+        .type = SENSOR_THERMISTOR, \
+        .config = { .thermistor = { \
+            .pullup_ohms = pullup_value, \
+            .voltage_table = v_table, \
+            .temp_table = t_table, \
+            .table_size = size, \
+            .counts_lut = lut \
+        } }, \
         .msg_id = msg_id_name, \
         .update_interval_us = interval_us, \
         .filter_strength = 128, \
@@ -130,14 +156,14 @@ static inline uint8_t is_voltage_valid(float voltage) {
     { \
         .pin = pin_name, \
         .type = SENSOR_FREQUENCY_COUNTER, \
-        .config.frequency = { \
+        .config = { .frequency = { \
             .pulses_per_unit = ppu, \
             .scaling_factor = scale, \
             .timeout_us = timeout_val, \
             .message_update_rate_hz = msg_rate, \
             .use_interrupts = 1, \
             .trigger_edge = edge_type \
-        }, \
+        } }, \
         .msg_id = msg_id_name, \
         .update_interval_us = 0, \
         .filter_strength = 16, \
@@ -149,14 +175,14 @@ static inline uint8_t is_voltage_valid(float voltage) {
     { \
         .pin = pin_name, \
         .type = SENSOR_FREQUENCY_COUNTER, \
-        .config.frequency = { \
+        .config = { .frequency = { \
             .pulses_per_unit = ppu, \
             .scaling_factor = scale, \
             .timeout_us = timeout_val, \
             .message_update_rate_hz = 10, \
             .use_interrupts = 0, \
             .trigger_edge = FREQ_EDGE_RISING \
-        }, \
+        } }, \
         .msg_id = msg_id_name, \
         .update_interval_us = interval_us, \
         .filter_strength = 32, \
@@ -455,12 +481,26 @@ static inline uint8_t is_voltage_valid(float voltage) {
 // I2C DEVICE HELPER FUNCTIONS
 // =============================================================================
 
-// Function to read from ADS1015 ADC
+// Function to read from ADS1015 ADC (latest cached conversion, see ads1015_driver.h)
 int16_t read_ads1015_channel(uint8_t channel);
 
 // Function to read from MCP23017 GPIO expander
 bool read_mcp23017_pin(uint8_t pin);
 
+// Read both MCP23017 GPIO ports in one I2C transaction (bit n = pin n)
+uint16_t read_mcp23017_ports(void);
+
+// SENSOR_I2C_GPIO sensors share one port snapshot per update pass. With the
+// MCP23017 INT output wired to int_pin, the ports are re-read only after a
+// change (plus a periodic refresh) instead of every pass.
+// The snapshot read is queued on the i2c_bus and lands in its callback, so
+// sensors see the ports as of the previous completed read (one pass old).
+void input_manager_attach_gpio_interrupt(uint8_t int_pin);
+
+// I2C address of the MCP23017 for snapshot reads (default 0x20)
+void input_manager_set_gpio_expander(uint8_t address);
+uint32_t input_manager_get_gpio_port_reads(void);   // Port snapshot transactions
+
 // Function to write to MCP23017 GPIO expander
 void write_mcp23017_pin(uint8_t pin, bool value);
 
@@ -475,18 +515,18 @@ void print_i2c_status();
 // =============================================================================
 
 // Helper macro to define an I2C ADC sensor (ADS1015)
-#define DEFINE_I2C_ADC_SENSOR(channel_num, msg_id_name, min_v, max_v, min_val, max_val, gain_setting, interval_us, sensor_name) \
+#define DEFINE_I2C_ADC_SENSOR(channel_num, msg_id_name, min_v, max_v, min_val, max_val, gain, interval_us, sensor_name) \
     { \
         .pin = 0xFF, /* Not used for I2C sensors */ \
         .type = SENSOR_I2C_ADC, \
-        .config.i2c_adc = { \
+        .config = { .i2c_adc = { \
             .channel = channel_num, \
             .min_voltage = min_v, \
             .max_voltage = max_v, \
             .min_value = min_val, \
             .max_value = max_val, \
-            .gain_setting = gain_setting \
-        }, \
+            .gain_setting = gain \
+        } }, \
         .msg_id = msg_id_name, \
         .update_interval_us = interval_us, \
         .filter_strength = 32, \
@@ -494,18 +534,18 @@ void print_i2c_status();
     }
 
 // Helper macro to define an I2C GPIO sensor (MCP23017)
-#define DEFINE_I2C_GPIO_SENSOR(pin_num, msg_id_name, use_pullup, invert_logic, interval_us, sensor_name) \
+#define DEFINE_I2C_GPIO_SENSOR(pin_num, msg_id_name, pullup, invert, interval_us, sensor_name) \
     { \
         .pin = 0xFF, /* Not used for I2C sensors */ \
         .type = SENSOR_I2C_GPIO, \
-        .config.i2c_gpio = { \
+        .config = { .i2c_gpio = { \
             .pin = pin_num, \
-            .use_pullup = use_pullup, \
-            .invert_logic = invert_logic \
-        }, \
+            .use_pullup = pullup, \
+            .invert_logic = invert \
+        } }, \
         .msg_id = msg_id_name, \
         .update_interval_us = interval_us, \
-        .filter_strength = 16, \
+        .filter_strength = 0, /* Digital: filtering would produce non-0/1 values */ \
         .name = sensor_name \
     }
 
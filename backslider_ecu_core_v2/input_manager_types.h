@@ -42,6 +42,7 @@ typedef struct {
     const float* voltage_table;  // Voltage points for lookup
     const float* temp_table;     // Corresponding temperature points
     uint8_t table_size;          // Number of points in tables
+    const float* counts_lut;     // Optional THERMISTOR_LUT_SIZE temps indexed by ADC counts (nullptr = interpolate tables)
 } thermistor_config_t;
 
 // Configuration for digital sensors
@@ -108,12 +109,20 @@ typedef struct {
     
     // Metadata
     const char* name;               // Human-readable name for debugging
+    
+    // Publish-on-change. With publish_heartbeat_us = 0 every update publishes;
+    // otherwise a value publishes when it moves by more than publish_deadband
+    // from the last published value, or when the heartbeat interval runs out.
+    float publish_deadband;         // Change (calibrated units) that forces a publish
+    uint32_t publish_heartbeat_us;  // Maximum silence between publishes, 0 = off
 } sensor_definition_t;
 
 // =============================================================================
 // SENSOR RUNTIME DATA
 // =============================================================================
 
+// Snapshot of one sensor returned by input_manager_get_sensor_status().
+// The input manager itself keeps these fields split into hot and cold arrays.
 typedef struct {
     // Current readings
     float calibrated_value;         // Final calibrated value
@@ -130,6 +139,14 @@ typedef struct {
     
     // Filtering state
     uint8_t first_reading;          // 1 = first reading (no filtering yet)
+    
+    // Scheduling
+    uint32_t next_due_us;           // Next scheduled update (micros)
+    uint32_t max_lateness_us;       // Worst delay between due time and update
+    uint32_t missed_deadlines;      // Updates that ran a full interval or more late
+    
+    // Publish-on-change
+    uint32_t suppressed_publishes;  // Updates not published (inside the deadband)
 } sensor_runtime_t;
 
 // =============================================================================
@@ -140,6 +157,17 @@ typedef struct {
 #define ADC_RESOLUTION 4095.0f      // 12-bit ADC
 #define ADC_VOLTAGE_REF 3.3f        // 3.3V reference on Teensy 4.1
 
+// Linear analog sensors calibrate and filter in Q16.16 fixed point with
+// coefficients precomputed at registration (0 = float path for all sensors)
+#ifndef INPUT_MANAGER_FIXED_POINT
+#define INPUT_MANAGER_FIXED_POINT 1
+#endif
+
+// Counts-domain thermistor lookup: entry i holds the temperature at
+// i << THERMISTOR_LUT_SHIFT counts, plus one end entry for interpolation
+#define THERMISTOR_LUT_SHIFT 4
+#define THERMISTOR_LUT_SIZE  ((4096 >> THERMISTOR_LUT_SHIFT) + 1)   // 257 entries
+
 // Error thresholds
 #define SENSOR_VOLTAGE_MIN 0.1f     // Below this = likely short circuit
 #define SENSOR_VOLTAGE_MAX 4.9f     // Above this = likely open circuit
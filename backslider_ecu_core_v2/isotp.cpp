@@ -0,0 +1,184 @@
+// isotp.cpp
+// ISO 15765-2 segmentation for responses longer than one CAN frame
+
+#include "isotp.h"
+#include <string.h>
+
+IsoTpSender::IsoTpSender() :
+    scheduler(nullptr),
+    tx_id(0),
+    priority(CAN_TX_PRIORITY_HIGH),
+    state(STATE_IDLE),
+    length(0),
+    offset(0),
+    sequence(0),
+    block_size(0),
+    block_sent(0),
+    stmin_us(0),
+    last_frame_us(0),
+    wait_start_us(0),
+    stats()
+{
+}
+
+void IsoTpSender::init(CanTxScheduler* scheduler, uint32_t tx_id, can_tx_priority_t priority) {
+    this->scheduler = scheduler;
+    this->tx_id = tx_id;
+    this->priority = priority;
+    state = STATE_IDLE;
+    stats = isotp_stats_t();
+}
+
+uint32_t IsoTpSender::stmin_to_us(uint8_t stmin) {
+    if (stmin <= 0x7F) {
+        return (uint32_t)stmin * 1000;
+    }
+    if (stmin >= 0xF1 && stmin <= 0xF9) {
+        return (uint32_t)(stmin - 0xF0) * 100;
+    }
+    return 127000;
+}
+
+bool IsoTpSender::submit(const uint8_t* data, uint8_t data_length, uint32_t now_us, CAN_message_t* copy) {
+    CAN_message_t msg = {};
+    msg.id = tx_id;
+    msg.flags.extended = (tx_id > 0x7FF);
+    msg.len = 8;
+    memset(msg.buf, ISOTP_PADDING_BYTE, sizeof(msg.buf));
+    memcpy(msg.buf, data, data_length);
+
+    if (scheduler != nullptr && !scheduler->submit(msg, priority, now_us)) {
+        return false;
+    }
+    if (copy != nullptr) {
+        *copy = msg;
+    }
+    last_frame_us = now_us;
+    return true;
+}
+
+bool IsoTpSender::send(const uint8_t* data, uint16_t data_length, uint32_t now_us,
+                       CAN_message_t* first_frame) {
+    if (data == nullptr || data_length == 0 || data_length > ISOTP_MAX_PAYLOAD) {
+        return false;
+    }
+    if (state != STATE_IDLE) {
+        abort();
+    }
+
+    if (data_length <= ISOTP_SINGLE_FRAME_MAX) {
+        uint8_t frame[8];
+        frame[0] = ISOTP_PCI_SINGLE | (uint8_t)data_length;
+        memcpy(&frame[1], data, data_length);
+        if (!submit(frame, (uint8_t)(data_length + 1), now_us, first_frame)) {
+            return false;
+        }
+        stats.single_frames++;
+        return true;
+    }
+
+    memcpy(payload, data, data_length);
+    length = data_length;
+    offset = 0;
+    stats.multi_frame_transfers++;
+    state = STATE_SEND_FIRST;
+    send_first_frame(now_us, first_frame);
+    return true;
+}
+
+bool IsoTpSender::send_first_frame(uint32_t now_us, CAN_message_t* copy) {
+    uint8_t frame[8];
+    frame[0] = ISOTP_PCI_FIRST | (uint8_t)((length >> 8) & 0x0F);
+    frame[1] = (uint8_t)(length & 0xFF);
+    memcpy(&frame[2], payload, ISOTP_FIRST_FRAME_DATA);
+    if (!submit(frame, 8, now_us, copy)) {
+        return false;
+    }
+    offset = ISOTP_FIRST_FRAME_DATA;
+    sequence = 1;
+    state = STATE_WAIT_FLOW_CONTROL;
+    wait_start_us = now_us;
+    return true;
+}
+
+bool IsoTpSender::on_flow_control(const CAN_message_t& msg, uint32_t now_us) {
+    if (msg.len < 3 || (msg.buf[0] & 0xF0) != ISOTP_PCI_FLOW_CONTROL) {
+        return false;
+    }
+    if (state != STATE_WAIT_FLOW_CONTROL) {
+        return false;
+    }
+    stats.flow_controls++;
+
+    switch (msg.buf[0] & 0x0F) {
+        case ISOTP_FS_CONTINUE:
+            block_size = msg.buf[1];
+            block_sent = 0;
+            stmin_us = stmin_to_us(msg.buf[2]);
+            state = STATE_SEND_CONSECUTIVE;
+            // The first consecutive frame may follow the FC at once
+            last_frame_us = now_us - stmin_us;
+            update(now_us);
+            return true;
+
+        case ISOTP_FS_WAIT:
+            wait_start_us = now_us;
+            return true;
+
+        default:
+            abort();
+            return true;
+    }
+}
+
+void IsoTpSender::update(uint32_t now_us) {
+    switch (state) {
+        case STATE_SEND_FIRST:
+            send_first_frame(now_us, nullptr);
+            return;
+
+        case STATE_WAIT_FLOW_CONTROL:
+            if (now_us - wait_start_us >= ISOTP_N_BS_TIMEOUT_US) {
+                stats.timeouts++;
+                abort();
+            }
+            return;
+
+        case STATE_SEND_CONSECUTIVE:
+            break;
+
+        default:
+            return;
+    }
+
+    while (state == STATE_SEND_CONSECUTIVE && now_us - last_frame_us >= stmin_us) {
+        uint8_t frame[8];
+        uint16_t remaining = length - offset;
+        uint8_t chunk = (remaining > ISOTP_CONSECUTIVE_DATA) ? ISOTP_CONSECUTIVE_DATA : (uint8_t)remaining;
+        frame[0] = ISOTP_PCI_CONSECUTIVE | (sequence & 0x0F);
+        memcpy(&frame[1], &payload[offset], chunk);
+        if (!submit(frame, (uint8_t)(chunk + 1), now_us, nullptr)) {
+            return;     // Queue full: retry on the next update
+        }
+        stats.consecutive_frames++;
+        offset += chunk;
+        sequence = (sequence + 1) & 0x0F;
+
+        if (offset >= length) {
+            stats.transfers_completed++;
+            state = STATE_IDLE;
+        } else if (block_size != 0 && ++block_sent >= block_size) {
+            state = STATE_WAIT_FLOW_CONTROL;
+            wait_start_us = now_us;
+        } else if (stmin_us > 0) {
+            return;     // Paced: next frame on a later update
+        }
+    }
+}
+
+void IsoTpSender::abort() {
+    if (state != STATE_IDLE) {
+        stats.transfers_aborted++;
+    }
+    state = STATE_IDLE;
+}
@@ -0,0 +1,135 @@
+// isotp.h
+// ISO 15765-2 (ISO-TP) segmentation for responses longer than one CAN frame
+
+/* =============================================================================
+ * ISO-TP SENDER OVERVIEW
+ * =============================================================================
+ *
+ * Payloads of up to 7 bytes go out as one single frame. Longer ones are split
+ * into a first frame and consecutive frames, paced by the receiver's flow
+ * control:
+ *
+ *   ECU                                   tester
+ *    │── FF  [1L LL d0..d5] ───────────────►│
+ *    │◄─────────────── FC [30 BS STmin] ────│
+ *    │── CF  [21 d6..d12] ─────────────────►│
+ *    │── CF  [22 ...] ─────────────────────►│  STmin apart, BS per FC
+ *
+ * - Nothing blocks: send() queues the first frame and returns; update() sends
+ *   consecutive frames as STmin allows, and on_flow_control() takes the FC
+ *   frames the caller routes here.
+ * - Frames go through the CanTxScheduler at the configured priority. A frame
+ *   refused because its queue is full is retried on the next update().
+ * - FC wait (FS=1) restarts the N_Bs timeout; overflow (FS=2) or N_Bs expiry
+ *   aborts the transfer.
+ * - Every frame is padded to 8 bytes (ISO 15765-4).
+ *
+ * Only the sending side is implemented: OBD-II requests fit a single frame.
+ * =============================================================================
+ */
+
+#ifndef ISOTP_H
+#define ISOTP_H
+
+#include <stdint.h>
+#include "can_tx_scheduler.h"
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+    #include <FlexCAN_T4.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+
+#define ISOTP_MAX_PAYLOAD           64          // Longest response we segment
+#define ISOTP_SINGLE_FRAME_MAX      7
+#define ISOTP_FIRST_FRAME_DATA      6
+#define ISOTP_CONSECUTIVE_DATA      7
+#define ISOTP_PADDING_BYTE          0xAA
+#define ISOTP_N_BS_TIMEOUT_US       1000000     // First frame / block to flow control
+
+// Protocol control information (high nibble of byte 0)
+#define ISOTP_PCI_SINGLE            0x00
+#define ISOTP_PCI_FIRST             0x10
+#define ISOTP_PCI_CONSECUTIVE       0x20
+#define ISOTP_PCI_FLOW_CONTROL      0x30
+
+// Flow status (low nibble of a flow control frame)
+#define ISOTP_FS_CONTINUE           0x00
+#define ISOTP_FS_WAIT               0x01
+#define ISOTP_FS_OVERFLOW           0x02
+
+// Sender statistics
+struct isotp_stats_t {
+    uint32_t single_frames;
+    uint32_t multi_frame_transfers;
+    uint32_t consecutive_frames;
+    uint32_t flow_controls;
+    uint32_t transfers_completed;
+    uint32_t transfers_aborted;         // Overflow, timeout or replaced
+    uint32_t timeouts;
+};
+
+// =============================================================================
+// SENDER
+// =============================================================================
+
+class IsoTpSender {
+public:
+    IsoTpSender();
+
+    void init(CanTxScheduler* scheduler, uint32_t tx_id,
+              can_tx_priority_t priority = CAN_TX_PRIORITY_HIGH);
+
+    // Start a transfer; an unfinished one is aborted. The first frame (or the
+    // single frame) is copied to first_frame when given.
+    bool send(const uint8_t* data, uint16_t length, uint32_t now_us,
+              CAN_message_t* first_frame = nullptr);
+
+    // Flow control frame from the receiver; false if none was expected
+    bool on_flow_control(const CAN_message_t& msg, uint32_t now_us);
+
+    // Send due consecutive frames and check the flow control timeout
+    void update(uint32_t now_us);
+
+    void abort();
+    bool is_busy() const { return state != STATE_IDLE; }
+    const isotp_stats_t& get_statistics() const { return stats; }
+
+    // STmin byte to microseconds (reserved values read as 127 ms)
+    static uint32_t stmin_to_us(uint8_t stmin);
+
+private:
+    enum state_t {
+        STATE_IDLE,
+        STATE_SEND_FIRST,               // First frame waiting for queue room
+        STATE_WAIT_FLOW_CONTROL,
+        STATE_SEND_CONSECUTIVE
+    };
+
+    CanTxScheduler* scheduler;
+    uint32_t tx_id;
+    can_tx_priority_t priority;
+
+    state_t state;
+    uint8_t payload[ISOTP_MAX_PAYLOAD];
+    uint16_t length;
+    uint16_t offset;                    // Next payload byte to send
+    uint8_t sequence;                   // Next consecutive frame number (4 bits)
+    uint8_t block_size;                 // 0 = no further flow control
+    uint8_t block_sent;
+    uint32_t stmin_us;
+    uint32_t last_frame_us;
+    uint32_t wait_start_us;
+
+    isotp_stats_t stats;
+
+    bool submit(const uint8_t* data, uint8_t length, uint32_t now_us, CAN_message_t* copy);
+    bool send_first_frame(uint32_t now_us, CAN_message_t* copy);
+};
+
+#endif
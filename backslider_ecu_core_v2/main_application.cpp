@@ -9,15 +9,29 @@
 #include "main_application.h"
 #include "msg_bus.h"
 #include "input_manager.h"
+#include "ads1015_driver.h"
+#include "i2c_bus.h"
+#include "trigger_decoder.h"
+#include "ignition_scheduler.h"
+#include "injection_scheduler.h"
+#include "map_tables.h"
 #include "output_manager.h"
 #include "external_serial.h"
 #include "external_canbus.h"
 #include "sensor_calibration.h"
 #include "transmission_module.h"
+#include "signal_store.h"
 #include "ecu_config.h"
 #include "parameter_registry.h"
 #include "external_message_broadcasting.h"
 #include "pin_assignments.h"
+#include "memory_placement.h"
+#include "trace_buffer.h"
+#include "task_executive.h"
+#include "memory_monitor.h"
+#include "boot_sequence.h"
+#include "can_router.h"
+#include "sd_logger.h"
 
 // TODO: Create engine_sensors.h when ready
 // TODO: Create transmission_sensors.h when ready
@@ -40,70 +54,279 @@ TwoWire* getI2CBus(uint8_t device_number) {
 }
 #endif
 
+// =============================================================================
+// MESSAGE BUS PROFILING PARAMETERS
+// =============================================================================
+
+// Selection state for the profiling parameters (subscriber index, histogram bucket)
+static uint16_t bus_profile_selected_handler = 0;
+static uint8_t bus_profile_selected_bucket = 0;
+
+static bool get_selected_handler_profile(handler_profile_t* profile) {
+    return g_message_bus.getHandlerProfile(bus_profile_selected_handler, profile);
+}
+
+static bool get_selected_latency_profile(latency_profile_t* latency) {
+    handler_profile_t profile;
+    if (!get_selected_handler_profile(&profile)) {
+        return false;
+    }
+    return g_message_bus.getLatencyProfile(profile.msg_id, latency);
+}
+
+static void register_message_bus_parameters(void) {
+    ParameterRegistry::register_parameter(MSG_BUS_PROFILE_ENABLE,
+        []() -> float { return g_message_bus.isProfilingEnabled() ? 1.0f : 0.0f; },
+        [](float value) -> bool {
+            if (value > 0.5f && !g_message_bus.isProfilingEnabled()) {
+                g_message_bus.resetProfiling();
+            }
+            g_message_bus.setProfilingEnabled(value > 0.5f);
+            return true;
+        },
+        "Bus Profiling Enable");
+    ParameterRegistry::register_parameter(MSG_BUS_PROFILE_SELECT,
+        []() -> float { return (float)bus_profile_selected_handler; },
+        [](float value) -> bool {
+            if (value < 0.0f || value >= (float)g_message_bus.getSubscriberCount()) {
+                return false;
+            }
+            bus_profile_selected_handler = (uint16_t)value;
+            return true;
+        },
+        "Bus Profile Handler Select");
+    ParameterRegistry::register_parameter(MSG_BUS_PROFILE_HANDLER_SUBSYSTEM,
+        []() -> float {
+            handler_profile_t profile;
+            return get_selected_handler_profile(&profile) ? (float)(GET_SUBSYSTEM(profile.msg_id) >> 20) : 0.0f;
+        },
+        nullptr, "Bus Profile Handler Subsystem");
+    ParameterRegistry::register_parameter(MSG_BUS_PROFILE_HANDLER_PARAMETER,
+        []() -> float {
+            handler_profile_t profile;
+            return get_selected_handler_profile(&profile) ? (float)GET_PARAMETER(profile.msg_id) : 0.0f;
+        },
+        nullptr, "Bus Profile Handler Parameter");
+    ParameterRegistry::register_parameter(MSG_BUS_PROFILE_HANDLER_CALLS,
+        []() -> float {
+            handler_profile_t profile;
+            return get_selected_handler_profile(&profile) ? (float)profile.calls : 0.0f;
+        },
+        nullptr, "Bus Profile Handler Calls");
+    ParameterRegistry::register_parameter(MSG_BUS_PROFILE_HANDLER_TOTAL_US,
+        []() -> float {
+            handler_profile_t profile;
+            return get_selected_handler_profile(&profile) ? (float)profile.total_us : 0.0f;
+        },
+        nullptr, "Bus Profile Handler Total us");
+    ParameterRegistry::register_parameter(MSG_BUS_PROFILE_HANDLER_MAX_US,
+        []() -> float {
+            handler_profile_t profile;
+            return get_selected_handler_profile(&profile) ? (float)profile.max_us : 0.0f;
+        },
+        nullptr, "Bus Profile Handler Max us");
+    ParameterRegistry::register_parameter(MSG_BUS_PROFILE_LATENCY_AVG_US,
+        []() -> float {
+            latency_profile_t latency;
+            if (!get_selected_latency_profile(&latency) || latency.samples == 0) {
+                return 0.0f;
+            }
+            return (float)latency.total_us / (float)latency.samples;
+        },
+        nullptr, "Bus Profile Latency Avg us");
+    ParameterRegistry::register_parameter(MSG_BUS_PROFILE_LATENCY_MAX_US,
+        []() -> float {
+            latency_profile_t latency;
+            return get_selected_latency_profile(&latency) ? (float)latency.max_us : 0.0f;
+        },
+        nullptr, "Bus Profile Latency Max us");
+    ParameterRegistry::register_parameter(MSG_BUS_PROFILE_LATENCY_BUCKET,
+        []() -> float { return (float)bus_profile_selected_bucket; },
+        [](float value) -> bool {
+            if (value < 0.0f || value >= (float)MSG_BUS_LATENCY_BUCKETS) {
+                return false;
+            }
+            bus_profile_selected_bucket = (uint8_t)value;
+            return true;
+        },
+        "Bus Profile Latency Bucket Select");
+    ParameterRegistry::register_parameter(MSG_BUS_PROFILE_LATENCY_COUNT,
+        []() -> float {
+            latency_profile_t latency;
+            return get_selected_latency_profile(&latency) ?
+                (float)latency.buckets[bus_profile_selected_bucket] : 0.0f;
+        },
+        nullptr, "Bus Profile Latency Bucket Count");
+    ParameterRegistry::register_parameter(MSG_BUS_PROFILE_HOTTEST_HANDLER,
+        []() -> float { return (float)g_message_bus.getHottestHandler(); },
+        nullptr, "Bus Profile Hottest Handler");
+    ParameterRegistry::register_parameter(MSG_BUS_PROFILE_BROADCAST_US,
+        []() -> float { return (float)g_message_bus.getBroadcastHandlerUs(); },
+        nullptr, "Bus Profile Broadcast Handler us");
+    ParameterRegistry::register_parameter(MSG_BUS_QUEUE_PEAK_DEPTH,
+        []() -> float { return (float)g_message_bus.getQueuePeakDepth(); },
+        nullptr, "Bus Queue Peak Depth");
+}
+
+// The cell, axis bin and commit/revert blocks of one map table; other IDs
+// in the subsystem still fail lookup
+static void register_map_table_ranges(uint32_t subsystem, const char* description) {
+    const uint32_t mask = ECU_BASE_MASK | SUBSYSTEM_MASK | 0xF0000;
+    ParameterRegistry::register_parameter_range(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, subsystem, MAP_CELL_ID(0, 0)),
+        mask | MAP_CELL_BLOCK_MASK, map_tables_read_parameter, map_tables_write_parameter, description);
+    ParameterRegistry::register_parameter_range(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, subsystem, MAP_CELL_ID(MAP_AXIS_Y_ROW, 0)),
+        mask | MAP_AXIS_BLOCK_MASK, map_tables_read_parameter, map_tables_write_parameter, description);
+    ParameterRegistry::register_parameter_range(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, subsystem, MAP_CELL_ID(MAP_CONTROL_ROW, MAP_CONTROL_COMMIT)),
+        mask | MAP_CONTROL_BLOCK_MASK, map_tables_read_parameter, map_tables_write_parameter, description);
+}
+
+static void register_map_table_parameters(void) {
+    register_map_table_ranges(SUBSYSTEM_FUEL, "Fuel Map");
+    register_map_table_ranges(SUBSYSTEM_IGNITION, "Ignition Map");
+    register_map_table_ranges(SUBSYSTEM_BOOST, "Boost Map");
+}
+
+// =============================================================================
+// MAIN LOOP TASKS
+// =============================================================================
+
+// Task bodies that need application state
+static StorageManager* task_storage_manager = nullptr;
+
+static void task_message_bus(void) {
+    // Output changes made by one drain latch together
+    output_manager_begin_update();
+    g_message_bus.process(MainApplication::MESSAGE_BUS_BUDGET_US);
+    output_manager_commit_update();
+}
+
+static void task_storage(void) {
+    task_storage_manager->update();
+}
+
+static void task_external_serial(void) {
+    g_external_serial.update();
+}
+
+static void task_external_canbus(void) {
+    can_router_update();
+    g_external_canbus.update();
+}
+
+// Router transmit hook: module data to other ECUs ahead of bulk traffic
+static bool send_to_external_canbus(uint32_t can_id, const uint8_t* data, uint8_t length) {
+    return g_external_canbus.send_custom_message(can_id, data, length, CAN_TX_PRIORITY_HIGH);
+}
+
+static void register_main_loop_tasks(StorageManager* storage, bool transmission_local) {
+    task_storage_manager = storage;
+
+    task_executive_add("inputs", input_manager_update, TASK_RATE_1KHZ, 300);
+    task_executive_add("trigger", trigger_decoder_update, TASK_RATE_1KHZ, 50);
+    task_executive_add("msg_bus", task_message_bus, TASK_RATE_1KHZ, MainApplication::MESSAGE_BUS_BUDGET_US + 50);
+
+    if (transmission_local) {
+        task_executive_add("transmission", transmission_module_update, TASK_RATE_100HZ, 200);
+    }
+    task_executive_add("storage", task_storage, TASK_RATE_100HZ, STORAGE_FLUSH_BUDGET_US + 500);  // Flusher
+
+    task_executive_add("outputs", output_manager_update, TASK_RATE_10HZ, 300);
+    if (transmission_local) {
+        task_executive_add("trans_publish", transmission_module_publish_state, TASK_RATE_10HZ, 200);
+    }
+    task_executive_add("map_persist", map_tables_update, TASK_RATE_10HZ, 20000);
+    task_executive_add("memory", memory_monitor_update, TASK_RATE_10HZ, 50);
+
+    // Deferred boot stages first; each adds its own comms task when done
+    task_executive_add("boot", boot_sequence_update, TASK_RATE_BACKGROUND, BOOT_SEQUENCE_TASK_BUDGET_US);
+    task_executive_add("param_batch", ParameterRegistry::update, TASK_RATE_BACKGROUND, 200);
+}
+
 MainApplication::MainApplication() : storage_manager(&storage_backend), config_manager(&storage_manager) {
     // Constructor initializes storage manager with backend and config manager with storage manager
 }
 
-void MainApplication::init() {
-    loop_count = 0;
-    last_loop_time_us = 0;
-    last_status_report_ms = 0;
-    loops_per_second = 0;
-    last_loop_stats_reset_ms = 0;
-    external_canbus_initialized = false;
-    
-    #ifdef ARDUINO
-    // Initialize serial communication
-    Serial.begin(115200);  // Revert to standard baud rate
-    Serial.println("=== Backslider ECU Starting ===");
-    
-    // Note: LED initialization removed to avoid pin conflicts
+// =============================================================================
+// BOOT STAGES
+// =============================================================================
+
+// Actuators driven to rest before anything slow runs: output channels, and
+// coils and injectors configured low with their schedulers disabled
+ECU_COLD_CODE bool MainApplication::stageOutputsSafe(void* context) {
+    (void)context;
+    Serial.println("Initializing output manager...");
+    uint8_t output_init_result = output_manager_init();
+    if (output_init_result) {
+        Serial.println("Output manager initialized successfully");
+    } else {
+        Serial.println("WARNING: Output manager initialization failed");
+    }
+
+    #ifdef TRIGGER_DECODER_ENABLED
+    // Coil-on-plug V8, firing order 1-8-4-3-6-5-7-2
+    ignition_scheduler_init();
+    ignition_layout_t ignition = {
+        .cylinder_count = 8,
+        .coil_pins = {PIN_IGN_1, PIN_IGN_2, PIN_IGN_3, PIN_IGN_4,
+                      PIN_IGN_5, PIN_IGN_6, PIN_IGN_7, PIN_IGN_8},
+        .tdc_angle_deg = {0.0f, 630.0f, 270.0f, 180.0f, 450.0f, 360.0f, 540.0f, 90.0f}
+    };
+    ignition_scheduler_configure(&ignition);
+
+    // Port injectors on the same TDC table, sequential once cam sync is found
+    injection_scheduler_init();
+    injection_layout_t injection = {
+        .cylinder_count = 8,
+        .injector_pins = {PIN_INJ_1, PIN_INJ_2, PIN_INJ_3, PIN_INJ_4,
+                          PIN_INJ_5, PIN_INJ_6, PIN_INJ_7, PIN_INJ_8},
+        .tdc_angle_deg = {0.0f, 630.0f, 270.0f, 180.0f, 450.0f, 360.0f, 540.0f, 90.0f},
+        .mode = INJECTION_MODE_SEQUENTIAL
+    };
+    injection_scheduler_configure(&injection);
     #endif
-    
-    // Initialize message bus (internal messaging only for now)
-    Serial.println("Initializing message bus...");
-    Serial.println("  - About to call g_message_bus.init()...");
-    g_message_bus.init();  // false = no physical CAN bus yet
-    Serial.println("  - g_message_bus.init() completed");
-    
-    // Set up parameter registry as global broadcast handler for parameter requests
-    Serial.println("Setting up parameter registry...");
-    g_message_bus.setGlobalBroadcastHandler(ParameterRegistry::handle_parameter_request);
-    Serial.println("  - Parameter registry set as global broadcast handler");
-    
-    // Initialize storage manager
+    return output_init_result != 0;
+}
+
+// Backend mount only; the diagnostics pass is deferred
+ECU_COLD_CODE bool MainApplication::stageStorage(void* context) {
+    MainApplication* app = static_cast<MainApplication*>(context);
     Serial.println("Initializing storage manager...");
-    Serial.println("  - About to call storage_manager.init()...");
-    if (storage_manager.init()) {
-        Serial.println("  - Storage manager init() returned true");
+    if (app->storage_manager.init()) {
         Serial.println("Storage manager initialized successfully");
-        
-        // Run comprehensive storage diagnostics
-        Serial.println("  - About to run storage diagnostics...");
-        storage_manager.run_storage_diagnostics();
-        Serial.println("  - Storage diagnostics completed");
-    } else {
-        Serial.println("  - Storage manager init() returned false");
-        Serial.println("WARNING: Storage manager initialization failed");
+        return true;
     }
-    
-    // Initialize configuration manager - MUST BE FIRST after storage
+    Serial.println("WARNING: Storage manager initialization failed");
+    return false;
+}
+
+ECU_COLD_CODE bool MainApplication::stageConfig(void* context) {
+    MainApplication* app = static_cast<MainApplication*>(context);
     Serial.println("Initializing configuration manager...");
-    Serial.println("  - About to call config_manager.initialize()...");
-    if (!config_manager.initialize()) {
-        Serial.println("  - Config manager initialize() returned false");
-        Serial.println("CRITICAL ERROR: Configuration manager initialization failed");
-        return;
-    }
-    Serial.println("  - Config manager initialize() returned true");
-    
-    // Get configuration for system initialization
-    Serial.println("  - About to call config_manager.getConfig()...");
-    const ECUConfiguration& config = config_manager.getConfig();
+    return app->config_manager.initialize();
+}
+
+// Fuel, ignition and boost tables into RAM before anything looks them up
+ECU_COLD_CODE bool MainApplication::stageMapTables(void* context) {
+    MainApplication* app = static_cast<MainApplication*>(context);
+    Serial.println("Loading map tables...");
+    map_tables_init();
+    uint16_t map_values_loaded = map_tables_load(&app->storage_manager);
+    Serial.print("  - Map values loaded from storage: ");
+    Serial.println(map_values_loaded);
+    register_map_table_parameters();
+    return true;
+}
+
+// Buses and the ADS1015 behind the analog sensors. The GPIO expander only
+// serves switches and is brought up in the background.
+ECU_COLD_CODE bool MainApplication::stageAnalogInputs(void* context) {
+    MainApplication* app = static_cast<MainApplication*>(context);
+    const ECUConfiguration& config = app->config_manager.getConfig();
+    bool ok = true;
+    (void)config;
     
     #ifdef ARDUINO
     // Initialize I2C buses based on configuration
-    Serial.println("  - About to initialize I2C buses...");
     if (config.i2c.number_of_interfaces > 0) {
         Serial.print("Initializing ");
         Serial.print(config.i2c.number_of_interfaces);
@@ -136,7 +359,6 @@ void MainApplication::init() {
     }
     
     // Initialize ADS1015 ADC if enabled
-    Serial.println("  - About to initialize ADS1015...");
     if (config.i2c.adc.enabled) {
         // Validate device number
         if (config.i2c.adc.device_number >= config.i2c.number_of_interfaces) {
@@ -146,6 +368,7 @@ void MainApplication::init() {
             Serial.print(config.i2c.number_of_interfaces);
             Serial.println(")");
             digitalWrite(config.pins.error_led_pin, HIGH);
+            ok = false;
         } else {
             Serial.print("Initializing ADS1015 ADC on I2C bus ");
             Serial.print(config.i2c.adc.device_number);
@@ -161,10 +384,13 @@ void MainApplication::init() {
             if (!ads1015.begin(config.i2c.adc.address)) {
                 Serial.println("ERROR: Failed to initialize ADS1015 ADC!");
                 digitalWrite(config.pins.error_led_pin, HIGH);  // Turn on error LED
+                ok = false;
             } else {
                 Serial.println("ADS1015 ADC initialized successfully");
                 // Configure ADS1015 for single-ended readings
                 ads1015.setGain(GAIN_TWOTHIRDS);  // ±6.144V range
+                // Continuous conversions from here on; sensors read the driver's cache
+                ads1015_driver_begin(config.i2c.adc.address, ADS1015_DRIVER_READY_PIN);
             }
             #else
             Serial.println("ADS1015 ADC initialization skipped (not Arduino)");
@@ -174,157 +400,274 @@ void MainApplication::init() {
         Serial.println("ADS1015 ADC disabled in configuration");
     }
     
-    // Initialize MCP23017 GPIO expander if enabled
-    Serial.println("  - About to initialize MCP23017...");
-    if (config.i2c.gpio_expander.enabled) {
-        // Validate device number
-        if (config.i2c.gpio_expander.device_number >= config.i2c.number_of_interfaces) {
-            Serial.print("ERROR: MCP23017 device_number (");
-            Serial.print(config.i2c.gpio_expander.device_number);
-            Serial.print(") exceeds available I2C interfaces (");
-            Serial.print(config.i2c.number_of_interfaces);
-            Serial.println(")");
-            digitalWrite(config.pins.error_led_pin, HIGH);
-        } else {
-            Serial.print("Initializing MCP23017 GPIO expander on I2C bus ");
-            Serial.print(config.i2c.gpio_expander.device_number);
-            Serial.print(" at address 0x");
-            Serial.print(config.i2c.gpio_expander.address, HEX);
-            Serial.print(" (freq=");
-            Serial.print(config.i2c.gpio_expander.frequency);
-            Serial.println("Hz)");
-            
-            #if defined(ARDUINO) && !defined(TESTING)
-            // Note: Adafruit libraries currently use Wire by default
-            // TODO: Implement multi-bus support for Adafruit libraries
-            if (!mcp.begin_I2C(config.i2c.gpio_expander.address)) {
-                Serial.println("ERROR: Failed to initialize MCP23017 GPIO expander!");
-                digitalWrite(config.pins.error_led_pin, HIGH);  // Turn on error LED
-            } else {
-                Serial.println("MCP23017 GPIO expander initialized successfully");
-                // Configure all pins as inputs with pullup by default
-                for (int i = 0; i < 16; i++) {
-                    mcp.pinMode(i, INPUT_PULLUP);
-                }
-            }
-            #else
-            Serial.println("MCP23017 GPIO expander initialization skipped (not Arduino)");
-            #endif
-        }
-    } else {
-        Serial.println("MCP23017 GPIO expander disabled in configuration");
+    // Setup above used blocking Wire calls; from here on the bus is
+    // interrupt-driven and the ADS1015 / snapshot traffic is queued
+    if (config.i2c.number_of_interfaces >= 1) {
+        i2c_bus_begin(I2C_BUS_PRIMARY);
     }
     
     // Initialize status LEDs with loaded configuration
-    Serial.println("  - About to initialize LEDs...");
     pinMode(config.pins.status_led_pin, OUTPUT);
     pinMode(config.pins.error_led_pin, OUTPUT);  
     pinMode(config.pins.activity_led_pin, OUTPUT);
     
     // Set initial LED states
     digitalWrite(config.pins.status_led_pin, HIGH);   // Status ON during init
-    digitalWrite(config.pins.error_led_pin, LOW);     // Error OFF
+    digitalWrite(config.pins.error_led_pin, ok ? LOW : HIGH);
     digitalWrite(config.pins.activity_led_pin, LOW);  // Activity OFF
     #endif
     
-    // Initialize input manager
     Serial.println("Initializing input manager...");
-    Serial.println("  - About to call input_manager_init()...");
     input_manager_init();
+    return ok;
+}
 
-    // Initialize output manager (must be before modules that use outputs)
-    Serial.println("Initializing output manager...");
-    Serial.println("  - About to call output_manager_init()...");
-    uint8_t output_init_result = output_manager_init();
-    if (output_init_result) {
-        Serial.println("Output manager initialized successfully");
-    } else {
-        Serial.println("WARNING: Output manager initialization failed");
-    }
+// Crank trigger decoder and the schedulers it drives (pins attached on
+// engine builds only)
+ECU_COLD_CODE bool MainApplication::stageEngine(void* context) {
+    (void)context;
+    trigger_decoder_init();
+    #ifdef TRIGGER_DECODER_ENABLED
+    trigger_decoder_begin(PIN_CRANK_PRIMARY, PIN_CAM_INTAKE);
+    ignition_scheduler_begin();
+    ignition_scheduler_enable(true);
+    injection_scheduler_begin();
+    injection_scheduler_enable(true);
+    #endif
+    return true;
+}
 
-    // Initialize external communications
-    Serial.println("Initializing external communications...");
-    
-    // Test external serial initialization step by step
-    Serial.println("  - About to call g_external_serial.init()...");
-    Serial.println("  - Config: USB=");
-    Serial.print(ECU_TRANSMISSION_CONFIG.external_serial.usb.enabled ? "enabled" : "disabled");
-    Serial.println(", Serial1=");
-    Serial.print(ECU_TRANSMISSION_CONFIG.external_serial.serial1.enabled ? "enabled" : "disabled");
-    Serial.println(", Serial2=");
-    Serial.print(ECU_TRANSMISSION_CONFIG.external_serial.serial2.enabled ? "enabled" : "disabled");
-    Serial.println();
-    
-    bool external_serial_result = g_external_serial.init(ECU_TRANSMISSION_CONFIG.external_serial);
-    
-    if (external_serial_result) {
-        Serial.println("  - External serial init() returned true");
-        Serial.println("External serial communication initialized");
-    } else {
-        Serial.println("  - External serial init() returned false");
-        Serial.println("External serial communication initialization failed");
+// Module placement (ECUConfiguration::distribution) as CAN routes: what
+// this ECU hosts for others is replicated, what another ECU hosts for it
+// is remote. Routes only; the link joins once the CAN bus is up.
+ECU_COLD_CODE bool MainApplication::stageRouting(void* context) {
+    MainApplication* app = static_cast<MainApplication*>(context);
+    const ECUConfiguration& config = app->config_manager.getConfig();
+    uint32_t node = config.distribution.node_base;
+    uint32_t transmission_node = config.distribution.transmission_node;
+    uint32_t interval_us = config.distribution.forward_interval_us;
+    
+    can_router_init();
+    can_router_set_transmit(send_to_external_canbus);
+    app->transmission_local = (transmission_node == node);
+    if (app->transmission_local && node == ECU_BASE_PRIMARY) {
+        return true;        // Everything here, nothing to route
     }
     
-    // External CAN bus for OBD-II and custom devices
-    if (ECU_TRANSMISSION_CONFIG.external_canbus.enabled) {
-        Serial.println("  - About to initialize external CAN bus...");
-        external_canbus_initialized = g_external_canbus.init(ECU_TRANSMISSION_CONFIG.external_canbus);
-        if (external_canbus_initialized) {
-            Serial.println("  - External CAN bus init() returned true");
-            Serial.println("External CAN bus initialized");
-            Serial.print("  Baudrate: ");
-            Serial.print(ECU_TRANSMISSION_CONFIG.external_canbus.baudrate);
-            Serial.println(" bps");
-            Serial.print("  OBD-II: ");
-            Serial.println(ECU_TRANSMISSION_CONFIG.external_canbus.enable_obdii ? "enabled" : "disabled");
-            Serial.print("  Custom messages: ");
-            Serial.println(ECU_TRANSMISSION_CONFIG.external_canbus.enable_custom_messages ? "enabled" : "disabled");
-        } else {
-            Serial.println("  - External CAN bus init() returned false");
-            Serial.println("WARNING: External CAN bus initialization failed");
-        }
-    } else {
-        Serial.println("  - External CAN bus disabled in configuration - skipping initialization");
-        external_canbus_initialized = false;
+    // Only the engine ECU and the transmission ECU exchange its traffic
+    bool ok = true;
+    if (app->transmission_local || node == ECU_BASE_PRIMARY) {
+        ok = can_router_place_module(&TRANSMISSION_MODULE_ROUTES, app->transmission_local, interval_us);
     }
+    Serial.print("Transmission module on node 0x");
+    Serial.print(transmission_node, HEX);
+    Serial.print(", ");
+    Serial.print(can_router_get_route_count());
+    Serial.println(" CAN routes");
+    return ok;
+}
 
-    // Initialize external message broadcasting FIRST
-    Serial.println("Initializing external message broadcasting...");
-    ExternalMessageBroadcasting::init();
-    
-    // Set up external interfaces for broadcasting
-    ExternalMessageBroadcasting::set_external_interfaces(&g_external_canbus, &g_external_serial);
-    
-    // Initialize transmission module
+ECU_COLD_CODE bool MainApplication::stageTransmission(void* context) {
+    MainApplication* app = static_cast<MainApplication*>(context);
+    if (!app->transmission_local) {
+        Serial.println("Transmission module runs on another ECU - skipping initialization");
+        return true;
+    }
     Serial.println("Initializing transmission module...");
-    Serial.println("  - About to call transmission_module_init()...");
     uint8_t trans_sensors_registered = transmission_module_init();
-    Serial.println("  - transmission_module_init() completed");
     Serial.print("Registered ");
     Serial.print(trans_sensors_registered);
     Serial.println(" transmission sensors");
     
-    // Initialize transmission sensors and controls - transmission_init() is already called above
-    // transmission_init();
-    
     // TODO: Register engine sensors when engine_sensors.h is created
+    return true;
+}
+
+// Switch inputs on the MCP23017. The bus is interrupt-driven by now, so the
+// blocking Adafruit calls borrow it between queued ADS1015 transactions.
+ECU_COLD_CODE bool MainApplication::stageGpioExpander(void* context) {
+    MainApplication* app = static_cast<MainApplication*>(context);
+    const ECUConfiguration& config = app->config_manager.getConfig();
+    if (!config.i2c.gpio_expander.enabled) {
+        Serial.println("MCP23017 GPIO expander disabled in configuration");
+        return true;
+    }
+    if (config.i2c.gpio_expander.device_number >= config.i2c.number_of_interfaces) {
+        Serial.print("ERROR: MCP23017 device_number (");
+        Serial.print(config.i2c.gpio_expander.device_number);
+        Serial.print(") exceeds available I2C interfaces (");
+        Serial.print(config.i2c.number_of_interfaces);
+        Serial.println(")");
+        digitalWrite(config.pins.error_led_pin, HIGH);
+        return false;
+    }
+    Serial.print("Initializing MCP23017 GPIO expander on I2C bus ");
+    Serial.print(config.i2c.gpio_expander.device_number);
+    Serial.print(" at address 0x");
+    Serial.println(config.i2c.gpio_expander.address, HEX);
+    
+    #if defined(ARDUINO) && !defined(TESTING)
+    // Note: Adafruit libraries currently use Wire by default
+    // TODO: Implement multi-bus support for Adafruit libraries
+    if (!i2c_bus_claim(I2C_BUS_PRIMARY, I2C_BUS_TIMEOUT_US)) {
+        Serial.println("ERROR: I2C bus busy, MCP23017 not initialized");
+        return false;
+    }
+    bool ok = mcp.begin_I2C(config.i2c.gpio_expander.address);
+    if (ok) {
+        // Configure all pins as inputs with pullup by default
+        for (int i = 0; i < 16; i++) {
+            mcp.pinMode(i, INPUT_PULLUP);
+        }
+    }
+    i2c_bus_release(I2C_BUS_PRIMARY);
+    if (!ok) {
+        Serial.println("ERROR: Failed to initialize MCP23017 GPIO expander!");
+        digitalWrite(config.pins.error_led_pin, HIGH);  // Turn on error LED
+        return false;
+    }
+    Serial.println("MCP23017 GPIO expander initialized successfully");
+    input_manager_set_gpio_expander(config.i2c.gpio_expander.address);
+    #ifdef PIN_MCP23017_INT
+    input_manager_attach_gpio_interrupt(PIN_MCP23017_INT);
+    #endif
+    #else
+    Serial.println("MCP23017 GPIO expander initialization skipped (not Arduino)");
+    #endif
+    return true;
+}
+
+ECU_COLD_CODE bool MainApplication::stageStorageDiagnostics(void* context) {
+    MainApplication* app = static_cast<MainApplication*>(context);
+    app->storage_manager.run_storage_diagnostics();
+    return true;
+}
+
+ECU_COLD_CODE bool MainApplication::stageExternalSerial(void* context) {
+    (void)context;
+    Serial.println("Initializing external serial...");
+    if (!g_external_serial.init(ECU_TRANSMISSION_CONFIG.external_serial)) {
+        Serial.println("External serial communication initialization failed");
+        return false;
+    }
+    Serial.println("External serial communication initialized");
+    task_executive_add("ext_serial", task_external_serial, TASK_RATE_BACKGROUND, 200);
+    return true;
+}
+
+// External CAN bus for OBD-II and custom devices
+ECU_COLD_CODE bool MainApplication::stageExternalCanbus(void* context) {
+    MainApplication* app = static_cast<MainApplication*>(context);
+    if (!ECU_TRANSMISSION_CONFIG.external_canbus.enabled) {
+        Serial.println("External CAN bus disabled in configuration - skipping initialization");
+        return true;
+    }
+    app->external_canbus_initialized = g_external_canbus.init(ECU_TRANSMISSION_CONFIG.external_canbus);
+    if (!app->external_canbus_initialized) {
+        Serial.println("WARNING: External CAN bus initialization failed");
+        return false;
+    }
+    Serial.print("External CAN bus initialized at ");
+    Serial.print(ECU_TRANSMISSION_CONFIG.external_canbus.baudrate);
+    Serial.println(" bps");
+    g_external_canbus.set_link_receiver(can_router_receive);
+    task_executive_add("ext_canbus", task_external_canbus, TASK_RATE_BACKGROUND, 200);
+    return true;
+}
+
+ECU_COLD_CODE bool MainApplication::stageBroadcasting(void* context) {
+    (void)context;
+    ExternalMessageBroadcasting::init();
+    ExternalMessageBroadcasting::set_external_interfaces(&g_external_canbus, &g_external_serial);
+    task_executive_add("broadcast", ExternalMessageBroadcasting::update, TASK_RATE_BACKGROUND, 200);
+    return true;
+}
+
+// On-board log of engine channels when a card is in the slot
+ECU_COLD_CODE bool MainApplication::stageSdLogger(void* context) {
+    (void)context;
+    sd_logger_init();
+    sd_logger_add_channels(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, 0), ECU_BASE_MASK | SUBSYSTEM_MASK);
+    sd_logger_add_channels(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_FUEL, 0), ECU_BASE_MASK | SUBSYSTEM_MASK);
+    sd_logger_add_channels(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_IGNITION, 0), ECU_BASE_MASK | SUBSYSTEM_MASK);
+    sd_logger_add_channels(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_TRANSMISSION, 0), ECU_BASE_MASK | SUBSYSTEM_MASK);
+    if (!sd_logger_start_sd()) {
+        Serial.println("No SD card, logging disabled");
+        return true;
+    }
+    Serial.println("SD logging started");
+    // One SD_LOGGER_WRITE_CHUNK per run, only when the card is ready
+    task_executive_add("sd_logger", sd_logger_update, TASK_RATE_BACKGROUND, 600);
+    return true;
+}
+
+ECU_COLD_CODE void MainApplication::init() {
+    loop_count = 0;
+    last_loop_time_us = 0;
+    last_status_report_ms = 0;
+    loops_per_second = 0;
+    last_loop_stats_reset_ms = 0;
+    external_canbus_initialized = false;
+    transmission_local = true;
+    
+    // Trace ring first, so every later module can record into it
+    trace_init();
     
-    Serial.println("External message broadcasting initialized - ready for module registrations");
-    // Serial.println("Registering engine sensors...");
-    // uint8_t engine_sensors_registered = engine_sensors_init();
-    // Serial.print("Registered ");
-    // Serial.print(engine_sensors_registered);
-    // Serial.println(" engine sensors");
+    // Stack painting before the deeper init calls, so their use is seen
+    memory_monitor_init();
     
-    // TODO: Register transmission sensors when ready
-    // uint8_t trans_sensors_registered = transmission_sensors_init();
+    // Empty task table: run() is safe even if init stops early
+    task_executive_init();
+    boot_sequence_init();
     
     #ifdef ARDUINO
-    // Note: LED state changes removed to avoid pin conflicts
+    // Initialize serial communication
+    Serial.begin(115200);  // Revert to standard baud rate
+    Serial.println("=== Backslider ECU Starting ===");
+    
+    // Note: LED initialization removed to avoid pin conflicts
     #endif
     
-    Serial.println("=== ECU Initialization Complete ===");
-    Serial.println("Entering main loop...");
+    // Initialize message bus (internal messaging only for now)
+    Serial.println("Initializing message bus...");
+    g_message_bus.init();  // false = no physical CAN bus yet
+    
+    // Latest values of shared signals, read by modules instead of subscribing
+    signal_store_init();
+    
+    // Route parameter-sized frames on any ID to the parameter registry; other
+    // traffic is filtered by length inside the bus without calling it
+    g_message_bus.subscribeMasked(0, 0, ParameterRegistry::handle_parameter_request, sizeof(parameter_msg_t));
+    register_message_bus_parameters();
+    
+    // Foreground: what the engine needs, safe outputs first (boot_sequence.h)
+    boot_sequence_run("outputs_safe", stageOutputsSafe, this);
+    boot_sequence_run("storage", stageStorage, this);
+    if (!boot_sequence_run("config", stageConfig, this)) {
+        Serial.println("CRITICAL ERROR: Configuration manager initialization failed");
+        return;
+    }
+    boot_sequence_run("map_tables", stageMapTables, this);
+    boot_sequence_run("analog_inputs", stageAnalogInputs, this);
+    boot_sequence_run("engine", stageEngine, this);
+    boot_sequence_run("routing", stageRouting, this);
+    boot_sequence_run("transmission", stageTransmission, this);
+    
+    // Background: finished from the main loop, one stage per boot task run
+    boot_sequence_defer("gpio_expander", stageGpioExpander, this);
+    boot_sequence_defer("ext_serial", stageExternalSerial, this);
+    boot_sequence_defer("ext_canbus", stageExternalCanbus, this);
+    boot_sequence_defer("broadcast", stageBroadcasting, this);
+    boot_sequence_defer("sd_logger", stageSdLogger, this);
+    boot_sequence_defer("storage_diag", stageStorageDiagnostics, this);
+    
+    // Module updates run from fixed-rate executive slots
+    register_main_loop_tasks(&storage_manager, transmission_local);
+    boot_sequence_ready();
+    
+    Serial.print("=== Engine ready at ");
+    Serial.print(boot_sequence_get_ready_us());
+    Serial.println(" µs, entering main loop ===");
 }
 
 void MainApplication::run() {
@@ -340,10 +683,6 @@ void MainApplication::run() {
     }
     #endif
     
-    // Update all sensors (each sensor manages its own timing)
-    input_manager_update();
-    
-    // Process message bus (route sensor data to modules)
     #ifdef ARDUINO
     static uint32_t last_process_debug = 0;
     uint32_t now = millis();
@@ -357,27 +696,11 @@ void MainApplication::run() {
         last_process_debug = now;
     }
     #endif
-    g_message_bus.process();
-
-    // Update storage manager (handle storage operations and cache management)
-    storage_manager.update();
-
-    // Update output manager (controls all physical outputs)
-    output_manager_update();
-
-    // Update transmission module
-    transmission_module_update();
     
-    // Update external communications (share data with other ECUs and devices)
-    g_external_serial.update();
-    
-    // Update external CAN bus only if initialization was successful
-    if (external_canbus_initialized) {
-        g_external_canbus.update();
-    }
-    
-    // Update external message broadcasting
-    ExternalMessageBroadcasting::update();
+    // Due slots (inputs, trigger, bus at 1 kHz; transmission, storage
+    // flusher at 100 Hz; outputs, map persist at 10 Hz), then background
+    // comms that fit
+    task_executive_run();
     
     // Calculate loop timing
     uint32_t loop_end_us = micros();
@@ -392,6 +715,14 @@ void MainApplication::run() {
         last_loop_stats_reset_ms = now_ms;
     }
     
+    // Drain trace records over USB only when this loop had slack. USB Serial
+    // is shared with the USB SerialBridge, which writes partial frames; with
+    // its TX ring empty the port is on a bridge frame boundary.
+    if (g_message_bus.getLastDeferredCount() == 0 && last_loop_time_us < TRACE_IDLE_LOOP_US &&
+        g_external_serial.get_usb_bridge().get_tx_pending() == 0) {
+        trace_drain_usb(TRACE_DRAIN_RECORDS_PER_LOOP);
+    }
+    
     // Publish heartbeat
     // Update loop count for runtime monitoring
     
@@ -400,7 +731,7 @@ void MainApplication::run() {
     #endif
 }
 
-void MainApplication::printStatusReport() {
+ECU_COLD_CODE void MainApplication::printStatusReport() {
     Serial.println("=== ECU Status Report ===");
     
     // System timing
@@ -409,6 +740,53 @@ void MainApplication::printStatusReport() {
     Serial.print("Last loop time: ");
     Serial.print(last_loop_time_us);
     Serial.println(" µs");
+    Serial.print("CPU load: ");
+    Serial.print(task_executive_get_cpu_load_percent());
+    Serial.println(" %");
+    const loop_histogram_t* loop_hist = task_executive_get_loop_histogram();
+    if (loop_hist->samples > 0) {
+        Serial.print("Loop time min/p99/max: ");
+        Serial.print(loop_hist->min_us);
+        Serial.print("/");
+        Serial.print(task_executive_get_loop_p99_us());
+        Serial.print("/");
+        Serial.print(loop_hist->max_us);
+        Serial.println(" µs");
+        for (uint8_t b = 0; b < TASK_LOOP_HISTOGRAM_BUCKETS; b++) {
+            if (loop_hist->counts[b] == 0) {
+                continue;
+            }
+            Serial.print("  <= ");
+            if (b == TASK_LOOP_HISTOGRAM_BUCKETS - 1) {
+                Serial.print("inf");
+            } else {
+                Serial.print(task_executive_get_loop_bucket_edge_us(b));
+            }
+            Serial.print(" µs: ");
+            Serial.println(loop_hist->counts[b]);
+        }
+    }
+    Serial.print("Slot misses (1kHz/100Hz/10Hz): ");
+    Serial.print(task_executive_get_slot_misses(TASK_RATE_1KHZ));
+    Serial.print("/");
+    Serial.print(task_executive_get_slot_misses(TASK_RATE_100HZ));
+    Serial.print("/");
+    Serial.println(task_executive_get_slot_misses(TASK_RATE_10HZ));
+    for (uint8_t i = 0; i < task_executive_get_task_count(); i++) {
+        const task_t* task = task_executive_get_task(i);
+        Serial.print("  Task ");
+        Serial.print(task->name);
+        Serial.print(": runs ");
+        Serial.print(task->runs);
+        Serial.print(", max ");
+        Serial.print(task->max_us);
+        Serial.print("/");
+        Serial.print(task->budget_us);
+        Serial.print(" µs, load ");
+        Serial.print(task->load_percent);
+        Serial.print(" %, overruns ");
+        Serial.println(task->overruns);
+    }
     
     // Message bus statistics
     Serial.print("Messages processed: ");
@@ -419,6 +797,14 @@ void MainApplication::printStatusReport() {
     Serial.println(g_message_bus.getMessagesPerSecond());
     Serial.print("Queue overflows: ");
     Serial.println(g_message_bus.getQueueOverflows());
+    Serial.print("Queue peak depth: ");
+    Serial.println(g_message_bus.getQueuePeakDepth());
+    Serial.print("Bus budget exhaustions: ");
+    Serial.println(g_message_bus.getBudgetExhaustions());
+    Serial.print("Trace records pending/dropped: ");
+    Serial.print(trace_get_pending());
+    Serial.print("/");
+    Serial.println(trace_get_dropped());
     
     // Input manager statistics
     Serial.print("Total sensors: ");
@@ -429,6 +815,8 @@ void MainApplication::printStatusReport() {
     Serial.println(input_manager_get_total_updates());
     Serial.print("Sensor errors: ");
     Serial.println(input_manager_get_total_errors());
+    Serial.print("Sensor missed deadlines: ");
+    Serial.println(input_manager_get_missed_deadlines());
 
     // Output manager statistics
     const output_manager_stats_t* output_stats = output_manager_get_stats();
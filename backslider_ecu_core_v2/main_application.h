@@ -12,6 +12,15 @@
 
 class MainApplication {
 public:
+    // Time slice for message delivery in each 1 kHz slot, so a burst of bus
+    // traffic cannot hold the slot past its period
+    static const uint32_t MESSAGE_BUS_BUDGET_US = 500;
+    
+    // Trace records are only drained to USB after loops that left no bus
+    // work deferred and finished within TRACE_IDLE_LOOP_US
+    static const uint32_t TRACE_IDLE_LOOP_US = 1000;
+    static const uint16_t TRACE_DRAIN_RECORDS_PER_LOOP = 32;
+    
     MainApplication();
     void init();
     void run();
@@ -35,6 +44,7 @@ private:
     uint32_t loops_per_second;
     uint32_t last_loop_stats_reset_ms;
     bool external_canbus_initialized;
+    bool transmission_local;                // Placement from ECUConfiguration::distribution
     
     // Core systems (initialized in this order)
     SPIFlashStorageBackend storage_backend;
@@ -42,6 +52,22 @@ private:
     ConfigManager config_manager;
     
     void printStatusReport();
+    
+    // Boot stages (boot_sequence.h); context is the MainApplication
+    static bool stageOutputsSafe(void* context);
+    static bool stageStorage(void* context);
+    static bool stageConfig(void* context);
+    static bool stageMapTables(void* context);
+    static bool stageAnalogInputs(void* context);
+    static bool stageEngine(void* context);
+    static bool stageRouting(void* context);
+    static bool stageTransmission(void* context);
+    static bool stageGpioExpander(void* context);
+    static bool stageExternalSerial(void* context);
+    static bool stageExternalCanbus(void* context);
+    static bool stageBroadcasting(void* context);
+    static bool stageSdLogger(void* context);
+    static bool stageStorageDiagnostics(void* context);
 };
 
 
@@ -0,0 +1,516 @@
+// map_tables.cpp
+// Hinted axis search and bilinear interpolation over contiguous RAM tables
+
+#include "map_tables.h"
+#include "msg_definitions.h"
+#include "storage_manager.h"
+#include "memory_placement.h"
+#include <string.h>
+
+// =============================================================================
+// TABLE STORAGE
+// =============================================================================
+
+// Two buffers per table: active and staged
+static float fuel_cells[2][FUEL_MAP_ROWS * FUEL_MAP_COLS] ECU_HOT_DATA;
+static float ignition_cells[2][IGNITION_MAP_ROWS * IGNITION_MAP_COLS] ECU_HOT_DATA;
+static float boost_cells[2][BOOST_MAP_ROWS * BOOST_MAP_COLS] ECU_HOT_DATA;
+
+typedef struct {
+    table_3d_t buffers[2];
+    table_3d_t* volatile active;    // Swapped by a single store on commit
+    uint32_t subsystem;
+    uint32_t blob_key;
+    uint16_t staged_count;
+    uint8_t shadow_stale;           // Shadow needs a copy of active before the next edit
+    uint8_t persist_pending;
+} ecu_table_t;
+
+static ecu_table_t tables[MAP_TABLE_COUNT] ECU_HOT_DATA;
+static StorageManager* table_storage = nullptr;
+
+static uint32_t commit_count = 0;
+static uint32_t persist_count = 0;
+
+// Blob layout: shape (x size, y size, 2 spare bytes), x bins, y bins, cells.
+// Bump the version whenever this changes.
+#define MAP_TABLE_BLOB_VERSION      1
+#define MAP_TABLE_BLOB_SEGMENTS     4
+
+// Defaults until a tune is loaded: flat cells over evenly spaced axes
+#define FUEL_DEFAULT_VE             50.0f
+#define IGNITION_DEFAULT_ADVANCE    10.0f
+#define BOOST_DEFAULT_TARGET_KPA    100.0f
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+ECU_HOT_CODE static uint8_t axis_binary_search(const table_axis_t* axis, float value) {
+    // Invariant: bins[lo] <= value < bins[hi]
+    uint8_t lo = 0;
+    uint8_t hi = axis->size - 1;
+    while (hi - lo > 1) {
+        uint8_t mid = (uint8_t)((lo + hi) >> 1);
+        if (value < axis->bins[mid]) {
+            hi = mid;
+        } else {
+            lo = mid;
+        }
+    }
+    return lo;
+}
+
+static void axis_set_linear(table_axis_t* axis, float first, float last, uint8_t size) {
+    float bins[TABLE_MAX_AXIS_SIZE];
+    float step = (last - first) / (float)(size - 1);
+    for (uint8_t i = 0; i < size; i++) {
+        bins[i] = first + step * (float)i;
+    }
+    table_axis_set(axis, bins, size);
+}
+
+static void table_fill(table_3d_t* table, float value) {
+    uint16_t count = (uint16_t)table->x.size * table->y.size;
+    for (uint16_t i = 0; i < count; i++) {
+        table->cells[i] = value;
+    }
+}
+
+static void table_copy(table_3d_t* dst, const table_3d_t* src) {
+    float* cells = dst->cells;
+    *dst = *src;
+    dst->cells = cells;
+    memcpy(cells, src->cells, (size_t)src->x.size * src->y.size * sizeof(float));
+}
+
+static inline table_3d_t* shadow_of(ecu_table_t* t) {
+    return (t->active == &t->buffers[0]) ? &t->buffers[1] : &t->buffers[0];
+}
+
+// Shadow for editing, brought up to date with the active table first
+static table_3d_t* editable_shadow(ecu_table_t* t) {
+    table_3d_t* shadow = shadow_of(t);
+    if (t->shadow_stale) {
+        table_copy(shadow, t->active);
+        t->shadow_stale = 0;
+    }
+    return shadow;
+}
+
+// What a tuning tool should see: staged edits if any, else the active table
+static const table_3d_t* staged_view(ecu_table_t* t) {
+    return t->shadow_stale ? t->active : shadow_of(t);
+}
+
+// Load into the shadow, which goes active only if the blob is intact.
+// Returns the number of values loaded, 0 if the blob is missing or bad.
+static uint16_t table_load_blob(ecu_table_t* t, StorageManager* storage) {
+    const table_3d_t* active = t->active;
+    table_3d_t* shadow = shadow_of(t);
+    uint16_t cell_count = (uint16_t)active->x.size * active->y.size;
+
+    uint8_t shape[4];
+    float x_bins[TABLE_MAX_AXIS_SIZE];
+    float y_bins[TABLE_MAX_AXIS_SIZE];
+    StorageSegment segments[MAP_TABLE_BLOB_SEGMENTS] = {
+        {shape, sizeof(shape)},
+        {x_bins, active->x.size * sizeof(float)},
+        {y_bins, active->y.size * sizeof(float)},
+        {shadow->cells, cell_count * sizeof(float)},
+    };
+    if (!storage->load_blob(t->blob_key, MAP_TABLE_BLOB_VERSION, segments, MAP_TABLE_BLOB_SEGMENTS)) {
+        return 0;
+    }
+    if (shape[0] != active->x.size || shape[1] != active->y.size) {
+        return 0;
+    }
+
+    table_axis_t x = active->x;
+    table_axis_t y = active->y;
+    if (!table_axis_set(&x, x_bins, active->x.size) || !table_axis_set(&y, y_bins, active->y.size)) {
+        return 0;
+    }
+    shadow->x = x;
+    shadow->y = y;
+    t->active = shadow;
+    return active->x.size + active->y.size + cell_count;
+}
+
+static bool table_persist_blob(const ecu_table_t* t, StorageManager* storage) {
+    const table_3d_t* table = t->active;
+    uint8_t shape[4] = {table->x.size, table->y.size, 0, 0};
+    StorageSegment segments[MAP_TABLE_BLOB_SEGMENTS] = {
+        {shape, sizeof(shape)},
+        {(void*)table->x.bins, table->x.size * sizeof(float)},
+        {(void*)table->y.bins, table->y.size * sizeof(float)},
+        {table->cells, (size_t)table->x.size * table->y.size * sizeof(float)},
+    };
+    return storage->save_blob(t->blob_key, MAP_TABLE_BLOB_VERSION, segments, MAP_TABLE_BLOB_SEGMENTS);
+}
+
+// Per-cell keys, as written before tables were persisted as blobs
+static uint16_t table_load_cells(table_3d_t* table, StorageManager* storage, uint32_t subsystem) {
+    uint16_t loaded = 0;
+    float value;
+
+    // Axes first, so an invalid stored axis leaves the default in place
+    float bins[TABLE_MAX_AXIS_SIZE];
+    uint8_t found = 0;
+    for (uint8_t i = 0; i < table->x.size; i++) {
+        bins[i] = table->x.bins[i];
+        if (storage->load_data(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, subsystem, MAP_CELL_ID(MAP_AXIS_X_ROW, i)),
+                               &bins[i], sizeof(float))) {
+            found++;
+        }
+    }
+    if (found > 0 && table_axis_set(&table->x, bins, table->x.size)) {
+        loaded += found;
+    }
+
+    found = 0;
+    for (uint8_t i = 0; i < table->y.size; i++) {
+        bins[i] = table->y.bins[i];
+        if (storage->load_data(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, subsystem, MAP_CELL_ID(MAP_AXIS_Y_ROW, i)),
+                               &bins[i], sizeof(float))) {
+            found++;
+        }
+    }
+    if (found > 0 && table_axis_set(&table->y, bins, table->y.size)) {
+        loaded += found;
+    }
+
+    // Straight from the backend: 2000+ cells would only churn the storage cache
+    for (uint8_t row = 0; row < table->y.size; row++) {
+        for (uint8_t col = 0; col < table->x.size; col++) {
+            if (storage->load_data(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, subsystem, MAP_CELL_ID(row, col)),
+                                   &value, sizeof(float))) {
+                table->cells[(uint16_t)row * table->x.size + col] = value;
+                loaded++;
+            }
+        }
+    }
+
+    return loaded;
+}
+
+// =============================================================================
+// ENGINE
+// =============================================================================
+
+bool table_axis_set(table_axis_t* axis, const float* bins, uint8_t size) {
+    if (!axis || !bins || size < 2 || size > TABLE_MAX_AXIS_SIZE) {
+        return false;
+    }
+    for (uint8_t i = 1; i < size; i++) {
+        if (!(bins[i] > bins[i - 1])) {
+            return false;
+        }
+    }
+
+    for (uint8_t i = 0; i < size; i++) {
+        axis->bins[i] = bins[i];
+    }
+    for (uint8_t i = 0; i + 1 < size; i++) {
+        axis->inv_width[i] = 1.0f / (bins[i + 1] - bins[i]);
+    }
+    axis->inv_width[size - 1] = 0.0f;
+    axis->size = size;
+    axis->hint = 0;
+    return true;
+}
+
+ECU_HOT_CODE uint8_t table_axis_find(table_axis_t* axis, float value, float* fraction) {
+    const float* bins = axis->bins;
+    uint8_t last_cell = axis->size - 2;
+
+    // Clamp to the edge cells (also catches NaN, which fails every compare)
+    if (!(value > bins[0])) {
+        axis->hint = 0;
+        *fraction = 0.0f;
+        return 0;
+    }
+    if (value >= bins[last_cell + 1]) {
+        axis->hint = last_cell;
+        *fraction = 1.0f;
+        return last_cell;
+    }
+
+    // Same cell as last time, then one either side, then search
+    uint8_t i = axis->hint;
+    if (i > last_cell) {
+        i = last_cell;
+    }
+    if (value < bins[i]) {
+        if (i > 0 && value >= bins[i - 1]) {
+            i--;
+        } else {
+            i = axis_binary_search(axis, value);
+        }
+    } else if (value >= bins[i + 1]) {
+        // value < bins[last_cell + 1] here, so i + 1 is a valid cell
+        if (i + 1 == last_cell || value < bins[i + 2]) {
+            i++;
+        } else {
+            i = axis_binary_search(axis, value);
+        }
+    }
+
+    axis->hint = i;
+    *fraction = (value - bins[i]) * axis->inv_width[i];
+    return i;
+}
+
+ECU_HOT_CODE float table_2d_lookup(table_2d_t* table, float x) {
+    float fx;
+    uint8_t i = table_axis_find(&table->x, x, &fx);
+    float v0 = table->values[i];
+    return v0 + (table->values[i + 1] - v0) * fx;
+}
+
+ECU_HOT_CODE float table_3d_lookup(table_3d_t* table, float x, float y) {
+    float fx, fy;
+    uint8_t col = table_axis_find(&table->x, x, &fx);
+    uint8_t row = table_axis_find(&table->y, y, &fy);
+
+    const float* lower = &table->cells[(uint16_t)row * table->x.size + col];
+    const float* upper = lower + table->x.size;
+    float bottom = lower[0] + (lower[1] - lower[0]) * fx;
+    float top = upper[0] + (upper[1] - upper[0]) * fx;
+    return bottom + (top - bottom) * fy;
+}
+
+float table_3d_get_cell(const table_3d_t* table, uint8_t row, uint8_t col) {
+    if (row >= table->y.size || col >= table->x.size) {
+        return 0.0f;
+    }
+    return table->cells[(uint16_t)row * table->x.size + col];
+}
+
+bool table_3d_set_cell(table_3d_t* table, uint8_t row, uint8_t col, float value) {
+    if (row >= table->y.size || col >= table->x.size) {
+        return false;
+    }
+    table->cells[(uint16_t)row * table->x.size + col] = value;
+    return true;
+}
+
+// =============================================================================
+// ECU TABLES
+// =============================================================================
+
+static void ecu_table_init(ecu_table_t* t, float* cells_a, float* cells_b, uint32_t subsystem, uint32_t blob_key) {
+    t->buffers[0].cells = cells_a;
+    t->buffers[1].cells = cells_b;
+    t->active = &t->buffers[0];
+    t->subsystem = subsystem;
+    t->blob_key = blob_key;
+    t->staged_count = 0;
+    t->shadow_stale = 1;
+    t->persist_pending = 0;
+}
+
+static bool decode_map_parameter(uint32_t param_id, ecu_table_t** table, uint8_t* row, uint8_t* col) {
+    if (GET_ECU_BASE(param_id) != ECU_BASE_PRIMARY || GET_PARAMETER(param_id) > 0xFFFF) {
+        return false;
+    }
+    uint32_t subsystem = GET_SUBSYSTEM(param_id);
+    for (uint8_t i = 0; i < MAP_TABLE_COUNT; i++) {
+        if (tables[i].subsystem == subsystem) {
+            *table = &tables[i];
+            *row = (uint8_t)(GET_PARAMETER(param_id) >> 8);
+            *col = (uint8_t)(GET_PARAMETER(param_id) & 0xFF);
+            return true;
+        }
+    }
+    return false;
+}
+
+table_3d_t* map_table_get(uint8_t table) {
+    return (table < MAP_TABLE_COUNT) ? tables[table].active : nullptr;
+}
+
+void map_tables_init(void) {
+    ecu_table_init(&tables[MAP_TABLE_FUEL], fuel_cells[0], fuel_cells[1], SUBSYSTEM_FUEL, MSG_FUEL_MAP_BLOB);
+    ecu_table_init(&tables[MAP_TABLE_IGNITION], ignition_cells[0], ignition_cells[1], SUBSYSTEM_IGNITION, MSG_IGNITION_MAP_BLOB);
+    ecu_table_init(&tables[MAP_TABLE_BOOST], boost_cells[0], boost_cells[1], SUBSYSTEM_BOOST, MSG_BOOST_MAP_BLOB);
+    table_storage = nullptr;
+    commit_count = 0;
+    persist_count = 0;
+
+    table_3d_t* fuel = tables[MAP_TABLE_FUEL].active;
+    axis_set_linear(&fuel->x, 500.0f, 8000.0f, FUEL_MAP_COLS);          // RPM
+    axis_set_linear(&fuel->y, 20.0f, 300.0f, FUEL_MAP_ROWS);            // kPa
+    table_fill(fuel, FUEL_DEFAULT_VE);
+
+    table_3d_t* ignition = tables[MAP_TABLE_IGNITION].active;
+    axis_set_linear(&ignition->x, 500.0f, 8000.0f, IGNITION_MAP_COLS);
+    axis_set_linear(&ignition->y, 20.0f, 300.0f, IGNITION_MAP_ROWS);
+    table_fill(ignition, IGNITION_DEFAULT_ADVANCE);
+
+    table_3d_t* boost = tables[MAP_TABLE_BOOST].active;
+    axis_set_linear(&boost->x, 1000.0f, 8000.0f, BOOST_MAP_COLS);       // RPM
+    axis_set_linear(&boost->y, 0.0f, 100.0f, BOOST_MAP_ROWS);           // TPS %
+    table_fill(boost, BOOST_DEFAULT_TARGET_KPA);
+}
+
+ECU_COLD_CODE uint16_t map_tables_load(StorageManager* storage) {
+    if (!storage) {
+        return 0;
+    }
+    table_storage = storage;
+
+    uint16_t loaded = 0;
+    for (uint8_t i = 0; i < MAP_TABLE_COUNT; i++) {
+        ecu_table_t* t = &tables[i];
+        uint16_t count = table_load_blob(t, storage);
+        if (count == 0) {
+            count = table_load_cells(t->active, storage, t->subsystem);
+        }
+        loaded += count;
+        t->shadow_stale = 1;
+        t->staged_count = 0;
+    }
+    return loaded;
+}
+
+bool map_table_stage_cell(uint8_t table, uint8_t row, uint8_t col, float value) {
+    if (table >= MAP_TABLE_COUNT) {
+        return false;
+    }
+    ecu_table_t* t = &tables[table];
+    if (row >= t->active->y.size || col >= t->active->x.size) {
+        return false;
+    }
+    table_3d_set_cell(editable_shadow(t), row, col, value);
+    t->staged_count++;
+    return true;
+}
+
+bool map_table_stage_axis_bin(uint8_t table, uint8_t axis_row, uint8_t index, float value) {
+    if (table >= MAP_TABLE_COUNT || (axis_row != MAP_AXIS_X_ROW && axis_row != MAP_AXIS_Y_ROW)) {
+        return false;
+    }
+    ecu_table_t* t = &tables[table];
+    table_3d_t* shadow = editable_shadow(t);
+    table_axis_t* axis = (axis_row == MAP_AXIS_X_ROW) ? &shadow->x : &shadow->y;
+    if (index >= axis->size) {
+        return false;
+    }
+    // Ordering is checked on commit, when the whole axis has been edited
+    axis->bins[index] = value;
+    t->staged_count++;
+    return true;
+}
+
+float map_table_get_staged_cell(uint8_t table, uint8_t row, uint8_t col) {
+    if (table >= MAP_TABLE_COUNT) {
+        return 0.0f;
+    }
+    return table_3d_get_cell(staged_view(&tables[table]), row, col);
+}
+
+bool map_table_commit(uint8_t table) {
+    if (table >= MAP_TABLE_COUNT) {
+        return false;
+    }
+    ecu_table_t* t = &tables[table];
+    if (t->staged_count == 0) {
+        return true;
+    }
+
+    // Rebuild spacing reciprocals for edited axes; reject unordered ones
+    table_3d_t* shadow = editable_shadow(t);
+    if (!table_axis_set(&shadow->x, shadow->x.bins, shadow->x.size) ||
+        !table_axis_set(&shadow->y, shadow->y.bins, shadow->y.size)) {
+        return false;
+    }
+
+    t->active = shadow;
+    t->shadow_stale = 1;
+    t->staged_count = 0;
+    t->persist_pending = 1;
+    commit_count++;
+    return true;
+}
+
+void map_table_revert(uint8_t table) {
+    if (table >= MAP_TABLE_COUNT) {
+        return;
+    }
+    tables[table].shadow_stale = 1;
+    tables[table].staged_count = 0;
+}
+
+void map_tables_update(void) {
+    if (!table_storage) {
+        return;
+    }
+    for (uint8_t i = 0; i < MAP_TABLE_COUNT; i++) {
+        ecu_table_t* t = &tables[i];
+        if (t->persist_pending) {
+            if (table_persist_blob(t, table_storage)) {
+                t->persist_pending = 0;
+                persist_count++;
+            }
+            return;
+        }
+    }
+}
+
+float map_tables_read_parameter(uint32_t param_id) {
+    ecu_table_t* t;
+    uint8_t row, col;
+    if (!decode_map_parameter(param_id, &t, &row, &col)) {
+        return 0.0f;
+    }
+
+    const table_3d_t* view = staged_view(t);
+    if (row == MAP_AXIS_X_ROW) {
+        return (col < view->x.size) ? view->x.bins[col] : 0.0f;
+    }
+    if (row == MAP_AXIS_Y_ROW) {
+        return (col < view->y.size) ? view->y.bins[col] : 0.0f;
+    }
+    if (row == MAP_CONTROL_ROW) {
+        // Reading the commit ID reports how many edits are staged
+        return (col == MAP_CONTROL_COMMIT) ? (float)t->staged_count : 0.0f;
+    }
+    return table_3d_get_cell(view, row, col);
+}
+
+bool map_tables_write_parameter(uint32_t param_id, float value) {
+    ecu_table_t* t;
+    uint8_t row, col;
+    if (!decode_map_parameter(param_id, &t, &row, &col)) {
+        return false;
+    }
+
+    uint8_t table = (uint8_t)(t - tables);
+    if (row == MAP_AXIS_X_ROW || row == MAP_AXIS_Y_ROW) {
+        return map_table_stage_axis_bin(table, row, col, value);
+    }
+    if (row == MAP_CONTROL_ROW) {
+        if (col == MAP_CONTROL_COMMIT) {
+            return map_table_commit(table);
+        }
+        if (col == MAP_CONTROL_REVERT) {
+            map_table_revert(table);
+            return true;
+        }
+        return false;
+    }
+    return map_table_stage_cell(table, row, col, value);
+}
+
+uint16_t map_table_get_staged_count(uint8_t table) {
+    return (table < MAP_TABLE_COUNT) ? tables[table].staged_count : 0;
+}
+
+uint32_t map_tables_get_commit_count(void) {
+    return commit_count;
+}
+
+uint32_t map_tables_get_persist_count(void) {
+    return persist_count;
+}
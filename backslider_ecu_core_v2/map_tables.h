@@ -0,0 +1,156 @@
+// map_tables.h
+// In-RAM fuel, ignition and boost tables with hinted bilinear lookup
+
+/* =============================================================================
+ * MAP TABLES OVERVIEW
+ * =============================================================================
+ *
+ * Tables live in contiguous static arrays (DTCM on Teensy 4.x - plain
+ * globals land there, unlike DMAMEM or heap) so a lookup touches no flash
+ * or storage cache:
+ *
+ *   fuel      30 x 30   VE %        rows: load (kPa)   cols: RPM
+ *   ignition  30 x 30   deg BTDC    rows: load (kPa)   cols: RPM
+ *   boost     20 x 20   kPa         rows: TPS (%)      cols: RPM
+ *
+ * Cell (row, col) is the same cell MSG_*_MAP_CELL(row, col) addresses in
+ * storage; axis breakpoints are stored under MSG_*_MAP_X_BIN(i) and
+ * MSG_*_MAP_Y_BIN(i). map_tables_load() copies everything into RAM once.
+ *
+ * Lookup:
+ * - Each axis remembers the cell it last resolved to. Consecutive lookups
+ *   almost always land in the same or a neighbouring cell, so the search
+ *   checks the hint and its neighbours before falling back to a binary
+ *   search.
+ * - Inputs outside the axis clamp to the edge cell (no extrapolation).
+ * - Bin spacing reciprocals are precomputed when an axis is set, so a
+ *   lookup is two searches, four loads and three lerps with no division.
+ *
+ * Float throughout: the Cortex-M7 FPU does a single-precision multiply-add
+ * per cycle, and table values are tuned in engineering units.
+ *
+ * Live tuning:
+ * - Each ECU table has two buffers (axes and cells). Lookups use the
+ *   active one; PARAM_OP_WRITE_REQUEST on a cell or axis ID edits the
+ *   shadow, and reads of those IDs return the staged value.
+ * - A write to MSG_*_MAP_COMMIT validates the shadow's axes and makes it
+ *   active with one pointer store, so a lookup in progress finishes on
+ *   the table it started on and never sees a half-applied tune. The new
+ *   shadow is re-synced lazily on the next edit, well after any lookup
+ *   on the old table has returned.
+ * - The commit queues one persist of the whole table as a single storage
+ *   blob, written from map_tables_update(). MSG_*_MAP_REVERT drops
+ *   staged edits.
+ *
+ * Persistence: each table is one versioned, CRC-checked storage blob
+ * (shape, x bins, y bins, cells), saved from and loaded into the table's
+ * own arrays with no staging copy. A load lands in the shadow and only
+ * goes active once the blob checks out. Per-cell keys are still read
+ * when a table has no valid blob, for tunes saved cell by cell.
+ * =============================================================================
+ */
+
+#ifndef MAP_TABLES_H
+#define MAP_TABLES_H
+
+#include <stdint.h>
+
+class StorageManager;
+
+#define TABLE_MAX_AXIS_SIZE     32
+
+#define FUEL_MAP_ROWS           30
+#define FUEL_MAP_COLS           30
+#define IGNITION_MAP_ROWS       30
+#define IGNITION_MAP_COLS       30
+#define BOOST_MAP_ROWS          20
+#define BOOST_MAP_COLS          20
+
+typedef struct {
+    float bins[TABLE_MAX_AXIS_SIZE];        // Strictly increasing
+    float inv_width[TABLE_MAX_AXIS_SIZE];   // 1 / (bins[i+1] - bins[i])
+    uint8_t size;
+    uint8_t hint;                           // Lower index of the last cell found
+} table_axis_t;
+
+// Curve: one axis to a value
+typedef struct {
+    table_axis_t x;
+    float* values;                          // x.size entries
+} table_2d_t;
+
+// Map: columns along x, rows along y, cells row-major
+typedef struct {
+    table_axis_t x;
+    table_axis_t y;
+    float* cells;                           // y.size * x.size entries
+} table_3d_t;
+
+// =============================================================================
+// ENGINE
+// =============================================================================
+
+// Set axis breakpoints (2..TABLE_MAX_AXIS_SIZE, strictly increasing).
+// Returns false and leaves the axis unchanged if invalid.
+bool table_axis_set(table_axis_t* axis, const float* bins, uint8_t size);
+
+// Resolve value to lower index and fraction 0..1 toward the next bin,
+// updating the hint. Clamps to the end cells.
+uint8_t table_axis_find(table_axis_t* axis, float value, float* fraction);
+
+// Linear interpolation along the curve
+float table_2d_lookup(table_2d_t* table, float x);
+
+// Bilinear interpolation across the map
+float table_3d_lookup(table_3d_t* table, float x, float y);
+
+// Cell access by row (y) and column (x); out-of-range reads return 0
+float table_3d_get_cell(const table_3d_t* table, uint8_t row, uint8_t col);
+bool table_3d_set_cell(table_3d_t* table, uint8_t row, uint8_t col, float value);
+
+// =============================================================================
+// ECU TABLES
+// =============================================================================
+
+#define MAP_TABLE_FUEL          0
+#define MAP_TABLE_IGNITION      1
+#define MAP_TABLE_BOOST         2
+#define MAP_TABLE_COUNT         3
+
+// Active table for lookups. Fetch once per lookup; it may change between calls.
+table_3d_t* map_table_get(uint8_t table);
+
+// Attach cell storage and set default axes and flat cell values
+void map_tables_init(void);
+
+// Copy axes and cells from storage (the bulk blob if present, else the
+// per-cell keys); anything missing keeps its default. Keeps the storage
+// manager for later persists. Returns the number of values read.
+uint16_t map_tables_load(StorageManager* storage);
+
+// Parameter range handlers for every MSG_*_MAP_* ID (cells, axis bins,
+// commit and revert); registered by the main application
+float map_tables_read_parameter(uint32_t param_id);
+bool map_tables_write_parameter(uint32_t param_id, float value);
+
+// Stage edits in the shadow copy. Returns false if out of range.
+bool map_table_stage_cell(uint8_t table, uint8_t row, uint8_t col, float value);
+bool map_table_stage_axis_bin(uint8_t table, uint8_t axis_row, uint8_t index, float value);  // MAP_AXIS_X_ROW / MAP_AXIS_Y_ROW
+float map_table_get_staged_cell(uint8_t table, uint8_t row, uint8_t col);
+
+// Swap the staged copy in and queue a persist. Returns false (and keeps
+// the staged edits) if the staged axes are not strictly increasing.
+bool map_table_commit(uint8_t table);
+
+// Drop staged edits
+void map_table_revert(uint8_t table);
+
+// Write queued persists, one table per call (call from main loop)
+void map_tables_update(void);
+
+// Diagnostics
+uint16_t map_table_get_staged_count(uint8_t table);     // Edits since last commit
+uint32_t map_tables_get_commit_count(void);
+uint32_t map_tables_get_persist_count(void);
+
+#endif
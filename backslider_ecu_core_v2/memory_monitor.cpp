@@ -0,0 +1,187 @@
+// memory_monitor.cpp
+// Linker-symbol static sizes, stack painting and heap statistics
+
+#include "memory_monitor.h"
+#include "msg_bus.h"
+#include "memory_placement.h"
+#include <string.h>
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+    #include <malloc.h>
+    // Teensy 4 linker script symbols (see startup.c)
+    extern unsigned long _stext, _etext, _sdata, _ebss, _estack;
+    extern unsigned long _heap_start, _heap_end;
+    #define OCRAM_BASE 0x20200000u
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+static memory_monitor_stats_t stats;
+
+// Painted stack: [stack_floor, high_water) still holds the fill word as far
+// as the scans have seen; the stack grows down from stack_top
+static volatile uint32_t* stack_floor = nullptr;
+static volatile uint32_t* stack_top = nullptr;
+static volatile uint32_t* high_water = nullptr;
+static volatile uint32_t* scan_pos = nullptr;
+
+static uint32_t last_publish_us = 0;
+
+#ifdef TESTING
+static uint32_t test_heap_size = 0;
+static uint32_t test_heap_arena = 0;
+static uint32_t test_heap_in_use = 0;
+static uint32_t test_heap_free_chunks = 0;
+#endif
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+// Check up to max_words from scan_pos; a pass ends at the first overwritten
+// word (the new mark) or at the previous mark
+static void scan_stack(uint32_t max_words) {
+    while (max_words-- > 0) {
+        if (scan_pos >= high_water) {
+            scan_pos = stack_floor;
+            return;
+        }
+        if (*scan_pos != MEMORY_MONITOR_PAINT_WORD) {
+            high_water = scan_pos;
+            scan_pos = stack_floor;
+            return;
+        }
+        scan_pos++;
+    }
+}
+
+static void update_stack_stats(void) {
+    if (!stack_floor) {
+        return;
+    }
+    stats.stack_size_bytes = (uint32_t)(stack_top - stack_floor) * 4;
+    stats.stack_high_water_bytes = (uint32_t)(stack_top - high_water) * 4;
+    stats.stack_free_bytes = (uint32_t)(high_water - stack_floor) * 4;
+}
+
+static void update_heap_stats(void) {
+    uint32_t size, arena, in_use, free_chunks;
+    #ifdef ARDUINO
+    struct mallinfo info = mallinfo();
+    size = (uint32_t)&_heap_end - (uint32_t)&_heap_start;
+    arena = (uint32_t)info.arena;
+    in_use = (uint32_t)info.uordblks;
+    free_chunks = (uint32_t)info.ordblks;
+    #else
+    size = test_heap_size;
+    arena = test_heap_arena;
+    in_use = test_heap_in_use;
+    free_chunks = test_heap_free_chunks;
+    #endif
+
+    uint32_t trapped = (arena > in_use) ? arena - in_use : 0;
+    uint32_t untouched = (size > arena) ? size - arena : 0;
+    stats.heap_size_bytes = size;
+    stats.heap_high_water_bytes = arena;
+    stats.heap_in_use_bytes = in_use;
+    stats.heap_free_bytes = (size > in_use) ? size - in_use : 0;
+    stats.heap_free_chunks = free_chunks;
+    stats.heap_fragmentation_percent = (trapped + untouched > 0)
+        ? (float)trapped * 100.0f / (float)(trapped + untouched) : 0.0f;
+}
+
+static void publish_stats(void) {
+    g_message_bus.publishFloat(MSG_MEM_DTCM_STATIC, (float)stats.dtcm_static_bytes);
+    g_message_bus.publishFloat(MSG_MEM_ITCM, (float)stats.itcm_bytes);
+    g_message_bus.publishFloat(MSG_MEM_OCRAM_STATIC, (float)stats.ocram_static_bytes);
+    g_message_bus.publishFloat(MSG_MEM_STACK_HIGH_WATER, (float)stats.stack_high_water_bytes);
+    g_message_bus.publishFloat(MSG_MEM_STACK_FREE, (float)stats.stack_free_bytes);
+    g_message_bus.publishFloat(MSG_MEM_HEAP_HIGH_WATER, (float)stats.heap_high_water_bytes);
+    g_message_bus.publishFloat(MSG_MEM_HEAP_IN_USE, (float)stats.heap_in_use_bytes);
+    g_message_bus.publishFloat(MSG_MEM_HEAP_FREE, (float)stats.heap_free_bytes);
+    g_message_bus.publishFloat(MSG_MEM_HEAP_FRAGMENTATION, stats.heap_fragmentation_percent);
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+ECU_COLD_CODE void memory_monitor_init(void) {
+    memset(&stats, 0, sizeof(stats));
+    stack_floor = nullptr;
+    last_publish_us = micros();
+
+    #ifdef ARDUINO
+    stats.dtcm_static_bytes = (uint32_t)&_ebss - (uint32_t)&_sdata;
+    stats.itcm_bytes = (uint32_t)&_etext - (uint32_t)&_stext;
+    stats.ocram_static_bytes = (uint32_t)&_heap_start - OCRAM_BASE;
+
+    // Everything between .bss and the live stack (less a guard for this
+    // frame and the calls it makes) gets the fill word
+    volatile uint32_t* sp = (volatile uint32_t*)__builtin_frame_address(0);
+    stack_floor = (volatile uint32_t*)(((uint32_t)&_ebss + 3) & ~3u);
+    stack_top = (volatile uint32_t*)&_estack;
+    high_water = sp - MEMORY_MONITOR_PAINT_GUARD / 4;
+    for (volatile uint32_t* p = stack_floor; p < high_water; p++) {
+        *p = MEMORY_MONITOR_PAINT_WORD;
+    }
+    scan_pos = stack_floor;
+    update_stack_stats();
+    #else
+    test_heap_size = test_heap_arena = test_heap_in_use = test_heap_free_chunks = 0;
+    #endif
+
+    update_heap_stats();
+}
+
+void memory_monitor_update(void) {
+    if (stack_floor) {
+        scan_stack(MEMORY_MONITOR_SCAN_WORDS);
+        update_stack_stats();
+    }
+
+    uint32_t now_us = micros();
+    if (now_us - last_publish_us >= MEMORY_MONITOR_PUBLISH_US) {
+        last_publish_us = now_us;
+        update_heap_stats();
+        publish_stats();
+    }
+}
+
+const memory_monitor_stats_t* memory_monitor_get_stats(void) {
+    return &stats;
+}
+
+#ifdef TESTING
+void memory_monitor_set_stack_for_testing(uint32_t* base, uint32_t words, uint32_t painted_words) {
+    stack_floor = base;
+    stack_top = base + words;
+    high_water = base + painted_words;
+    for (uint32_t i = 0; i < painted_words; i++) {
+        base[i] = MEMORY_MONITOR_PAINT_WORD;
+    }
+    scan_pos = stack_floor;
+    update_stack_stats();
+}
+
+void memory_monitor_set_heap_for_testing(uint32_t size, uint32_t arena, uint32_t in_use, uint32_t free_chunks) {
+    test_heap_size = size;
+    test_heap_arena = arena;
+    test_heap_in_use = in_use;
+    test_heap_free_chunks = free_chunks;
+    update_heap_stats();
+}
+
+void memory_monitor_scan_stack_for_testing(void) {
+    if (!stack_floor) {
+        return;
+    }
+    scan_stack(UINT32_MAX);
+    update_stack_stats();
+}
+#endif
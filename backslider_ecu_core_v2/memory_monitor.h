@@ -0,0 +1,88 @@
+// memory_monitor.h
+// Static RAM, heap and stack accounting published on the message bus
+
+/* =============================================================================
+ * MEMORY MONITOR OVERVIEW
+ * =============================================================================
+ *
+ * Fixed arrays (bus queues, serial buffers, sensor tables) fill RAM1 from
+ * the bottom and the stack grows down from the top; the storage backend
+ * and CAN cache allocate from the OCRAM heap. The monitor reports how much
+ * of each is left so queue and cache sizes can be grown with a margin:
+ *
+ * - Static: DTCM data+bss, ITCM code and DMAMEM (OCRAM) bytes from the
+ *   linker symbols. The per-module breakdown is a build step:
+ *   `make ram-report MAP=<firmware.map>` in tests/ (see ram_report.py).
+ * - Stack: memory_monitor_init() paints the unused stack area between the
+ *   end of .bss and the current stack pointer with a fill word. Each
+ *   memory_monitor_update() scans a slice of it from the bottom; the first
+ *   overwritten word is the deepest the stack (ISRs included - they share
+ *   it) has ever reached. The high-water mark only moves down, so a pass
+ *   stops at the previous mark.
+ * - Heap: mallinfo() gives the arena (OCRAM claimed from sbrk, which never
+ *   shrinks - the heap high-water mark), bytes in use and free bytes
+ *   trapped inside the arena. Fragmentation is that trapped share of all
+ *   free heap: 0 % when every free byte is above the break, so a large
+ *   allocation can still succeed.
+ *
+ * Every MEMORY_MONITOR_PUBLISH_US the monitor publishes the MSG_MEM_*
+ * messages (msg_definitions.h) as floats.
+ *
+ * Desktop builds have no linker symbols or newlib heap: tests attach a
+ * buffer as the stack and set the heap figures.
+ * =============================================================================
+ */
+
+#ifndef MEMORY_MONITOR_H
+#define MEMORY_MONITOR_H
+
+#include <stdint.h>
+
+#define MEMORY_MONITOR_PAINT_WORD       0xA5C3A5C3u
+#define MEMORY_MONITOR_PAINT_GUARD      512         // Bytes below the stack pointer left unpainted at init
+#define MEMORY_MONITOR_SCAN_WORDS       2048        // Stack words checked per update
+#define MEMORY_MONITOR_PUBLISH_US       1000000
+
+typedef struct {
+    uint32_t dtcm_static_bytes;         // .data + .bss
+    uint32_t itcm_bytes;                // Code copied to ITCM
+    uint32_t ocram_static_bytes;        // DMAMEM (.bss.dma)
+
+    uint32_t stack_size_bytes;          // End of .bss to top of stack
+    uint32_t stack_high_water_bytes;    // Deepest use seen
+    uint32_t stack_free_bytes;          // Never touched since init
+
+    uint32_t heap_size_bytes;           // OCRAM reserved for the heap
+    uint32_t heap_high_water_bytes;     // Arena claimed from sbrk
+    uint32_t heap_in_use_bytes;
+    uint32_t heap_free_bytes;           // Size less in use
+    uint32_t heap_free_chunks;          // Free blocks inside the arena
+    float heap_fragmentation_percent;
+} memory_monitor_stats_t;
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Read the linker layout and paint the free stack. Call as early as
+// possible: stack used before this is not seen.
+void memory_monitor_init(void);
+
+// Scan a slice of the stack, refresh heap figures and publish when due
+void memory_monitor_update(void);
+
+const memory_monitor_stats_t* memory_monitor_get_stats(void);
+
+#ifdef TESTING
+// Use a buffer as the stack: words [0, painted_words) are painted, the
+// stack top is the end of the buffer
+void memory_monitor_set_stack_for_testing(uint32_t* base, uint32_t words, uint32_t painted_words);
+
+// Heap figures in place of mallinfo()
+void memory_monitor_set_heap_for_testing(uint32_t size, uint32_t arena, uint32_t in_use, uint32_t free_chunks);
+
+// Finish the current stack pass regardless of MEMORY_MONITOR_SCAN_WORDS
+void memory_monitor_scan_stack_for_testing(void);
+#endif
+
+#endif
@@ -0,0 +1,69 @@
+// memory_placement.h
+// Where hot and cold code and data live on the Teensy 4.x
+
+/* =============================================================================
+ * MEMORY PLACEMENT OVERVIEW
+ * =============================================================================
+ *
+ * The i.MX RT1062 has three places code and data can sit:
+ *
+ *   ITCM   0x00000000   zero-wait instruction RAM (RAM1)
+ *   DTCM   0x20000000   zero-wait data RAM (RAM1)
+ *   OCRAM  0x20200000   RAM2 behind the 32K data cache (DMAMEM, heap)
+ *   FLASH  0x60000000   QSPI flash behind the 32K instruction cache
+ *
+ * ITCM and DTCM share the 512K of RAM1, so every cold function left in
+ * ITCM is RAM taken from hot data. Code in flash runs at cache speed when
+ * the cache is warm and stalls for tens of cycles per line when it is
+ * not - fine for init and diagnostics, not for an ISR whose latency sets
+ * spark timing.
+ *
+ * The toolchain defaults already put functions in ITCM and globals in
+ * DTCM. These macros make the intent explicit at each definition, so a
+ * later change of default (or a module moving code to flash to make room)
+ * cannot silently push the hot path out of tightly coupled memory:
+ *
+ *   ECU_HOT_CODE    ISRs, bus delivery, sensor calibration, table lookup
+ *   ECU_COLD_CODE   init, status reports, storage loads - runs from flash
+ *   ECU_HOT_DATA    state touched every tooth or every bus message (DTCM)
+ *   ECU_COLD_DATA   bulk configuration and diagnostics - OCRAM. Not
+ *                   zeroed at boot, so the owning init() must clear it.
+ *   ECU_CONST_DATA  constant tables and default images read once - left
+ *                   in flash. Teensy 4 copies plain const data to RAM1.
+ *
+ * Placement rules:
+ * - Put the macro on the definition in the .cpp, not the declaration.
+ * - ECU_HOT_DATA never means DMAMEM: OCRAM goes through the data cache.
+ * - Objects created with new/malloc land on the OCRAM heap regardless.
+ *
+ * Desktop test builds define all five as nothing.
+ *
+ * `make link-map ELF=<firmware.elf>` in tests/ lists which symbols landed
+ * in which region, with per-region totals; `make ram-report MAP=<firmware.map>`
+ * adds them up per module and shows the RAM1 left for the stack.
+ *
+ * EXAMPLE:
+ *   ECU_HOT_CODE void trigger_decoder_crank_isr(void) { ... }
+ *   static sensor_definition_t sensors[MAX_SENSORS] ECU_COLD_DATA;
+ * =============================================================================
+ */
+
+#ifndef MEMORY_PLACEMENT_H
+#define MEMORY_PLACEMENT_H
+
+#if defined(ARDUINO) && defined(__IMXRT1062__)
+    #include <Arduino.h>
+    #define ECU_HOT_CODE    FASTRUN
+    #define ECU_COLD_CODE   FLASHMEM
+    #define ECU_HOT_DATA                // DTCM is the default for globals
+    #define ECU_COLD_DATA   DMAMEM
+    #define ECU_CONST_DATA  PROGMEM
+#else
+    #define ECU_HOT_CODE
+    #define ECU_COLD_CODE
+    #define ECU_HOT_DATA
+    #define ECU_COLD_DATA
+    #define ECU_CONST_DATA
+#endif
+
+#endif
@@ -2,36 +2,64 @@
 // Unified message bus implementation using FlexCAN format - Extended CAN ID Support
 
 #include "msg_bus.h"
+#include "trace_buffer.h"
+#include "memory_placement.h"
+#include "id_hash.h"
 
 // Global message bus instance
-MessageBus g_message_bus;
+MessageBus g_message_bus ECU_HOT_DATA;
 
 // Global broadcast handler (for external serial forwarding)
 MessageHandler MessageBus::global_broadcast_handler = nullptr;
 
+// Latency histogram bucket limits (µs): <10, <50, <100, <500, <1ms, <5ms, <10ms, slower
+const uint32_t MessageBus::LATENCY_BUCKET_LIMITS_US[MSG_BUS_LATENCY_BUCKETS - 1] = {
+    10, 50, 100, 500, 1000, 5000, 10000
+};
+
 MessageBus::MessageBus() :
     subscriber_count(0),
-    queue_head(0),
-    queue_tail(0),
+    masked_subscriber_count(0),
+    wildcard_head(NO_SUBSCRIBER),
+    priority_override_count(0),
+    coalesced_id_count(0),
+    profiled_id_count(0),
+    profiling_enabled(false),
+    broadcast_handler_us(0),
+    unprofiled_deliveries(0),
+    isr_enqueue_pos(0),
+    isr_dequeue_pos(0),
+    isr_queue_overflows(0),
     messages_processed(0),
     queue_overflows(0),
     messages_published(0),
+    messages_coalesced(0),
+    budget_exhaustions(0),
+    last_deferred_count(0),
     messages_per_second(0),
     last_stats_reset_ms(0)
 {
-    // Initialize subscriber array
-    for (uint8_t i = 0; i < MAX_SUBSCRIBERS; i++) {
+    // Initialize subscriber array and dispatch table
+    for (uint16_t i = 0; i < MAX_SUBSCRIBERS; i++) {
         subscribers[i].msg_id = 0;
         subscribers[i].handler = nullptr;
+        subscribers[i].next = NO_SUBSCRIBER;
     }
+    clear_dispatch_table();
+    clear_masked_subscribers();
+    clear_coalesce_table();
+    
+    // Empty lanes and default subsystem priorities
+    reset_queue();
+    resetPriorities();
+    resetProfiling();
 }
 
 void MessageBus::init() {
     debug_print("MessageBus: Initializing with extended CAN ID support...");
     
     // Reset queue
-    queue_head = 0;
-    queue_tail = 0;
+    reset_queue();
     
     // Reset statistics
     resetStatistics();
@@ -45,8 +73,27 @@ bool MessageBus::subscribe(uint32_t msg_id, MessageHandler handler) {
         return false;
     }
     
-    subscribers[subscriber_count].msg_id = msg_id;
-    subscribers[subscriber_count].handler = handler;
+    DispatchSlot* slot = find_dispatch_slot(msg_id, true);
+    if (slot == nullptr) {
+        debug_print("MessageBus: Subscribe failed - dispatch table full");
+        return false;
+    }
+    
+    uint16_t index = subscriber_count;
+    subscribers[index].msg_id = msg_id;
+    subscribers[index].handler = handler;
+    subscribers[index].next = NO_SUBSCRIBER;
+    subscribers[index].calls = 0;
+    subscribers[index].total_us = 0;
+    subscribers[index].max_us = 0;
+    
+    // Append to this ID's handler chain (preserves subscription order)
+    if (slot->head == NO_SUBSCRIBER) {
+        slot->head = index;
+    } else {
+        subscribers[slot->tail].next = index;
+    }
+    slot->tail = index;
     subscriber_count++;
     
     char debug_msg[80];
@@ -60,7 +107,69 @@ bool MessageBus::subscribe(uint32_t msg_id, MessageHandler handler) {
     return true;
 }
 
+bool MessageBus::subscribeMasked(uint32_t id_pattern, uint32_t id_mask, MessageHandler handler,
+                                 uint8_t required_length) {
+    if (handler == nullptr) {
+        debug_print("MessageBus: Masked subscribe failed - null handler");
+        return false;
+    }
+    
+    // Re-subscribing the same handler to the same family is a no-op, so
+    // modules can safely re-run their init
+    for (uint16_t i = 0; i < masked_subscriber_count; i++) {
+        const MaskedSubscriber& existing = masked_subscribers[i];
+        if (existing.handler == handler && existing.mask == id_mask &&
+            existing.pattern == (id_pattern & id_mask) && existing.required_length == required_length) {
+            return true;
+        }
+    }
+    
+    if (masked_subscriber_count >= MAX_MASKED_SUBSCRIBERS) {
+        debug_print("MessageBus: Masked subscribe failed - too many masked subscribers");
+        return false;
+    }
+    
+    uint16_t index = masked_subscriber_count;
+    MaskedSubscriber& entry = masked_subscribers[index];
+    entry.pattern = id_pattern & id_mask;
+    entry.mask = id_mask;
+    entry.handler = handler;
+    entry.required_length = required_length;
+    entry.next = NO_SUBSCRIBER;
+    
+    // Masks that pin the whole subsystem field live in that subsystem's bucket
+    uint16_t* head = &wildcard_head;
+    if ((id_mask & SUBSYSTEM_MASK) == SUBSYSTEM_MASK) {
+        head = &subsystem_bucket_head[GET_SUBSYSTEM(id_pattern) >> 20];
+    }
+    
+    // Append to keep subscription order (subscribe is rare, chains are short)
+    if (*head == NO_SUBSCRIBER) {
+        *head = index;
+    } else {
+        uint16_t last = *head;
+        while (masked_subscribers[last].next != NO_SUBSCRIBER) {
+            last = masked_subscribers[last].next;
+        }
+        masked_subscribers[last].next = index;
+    }
+    masked_subscriber_count++;
+    
+    char debug_msg[96];
+    snprintf(debug_msg, sizeof(debug_msg), "MessageBus: Subscribed to pattern 0x%08X mask 0x%08X",
+             (unsigned int)entry.pattern, (unsigned int)id_mask);
+    debug_print(debug_msg);
+    
+    return true;
+}
+
 bool MessageBus::publish(uint32_t msg_id, const void* data, uint8_t length) {
+    // Raw payloads (parameter requests, storage responses, bridged frames)
+    // are never coalesced - only the typed value helpers are
+    return publish_message(msg_id, data, length, false);
+}
+
+ECU_HOT_CODE bool MessageBus::publish_message(uint32_t msg_id, const void* data, uint8_t length, bool allow_coalesce) {
     if (length > 8) {
         debug_print("MessageBus: Publish failed - data too long");
         return false;
@@ -76,18 +185,12 @@ bool MessageBus::publish(uint32_t msg_id, const void* data, uint8_t length) {
         create_standard_can_message(&msg, msg_id, data, length);
     }
     
-    #ifdef ARDUINO
-    // Debug: Check if this is a parameter message
     if (length == 8) {  // parameter_msg_t is 8 bytes
-        Serial.print("MessageBus: Publishing parameter message to queue - CAN ID 0x");
-        Serial.println(msg_id, HEX);
+        TRACE(TRACE_CAT_MSG_BUS, TRACE_MSG_BUS_PARAM_PUBLISH, length, msg_id, 0);
     }
-    #endif
     
-    // Add to internal queue
-    if (!enqueue_internal_message(msg)) {
-        queue_overflows++;
-        debug_print("MessageBus: Internal queue overflow");
+    // Add to internal queue (lane overflow is counted inside)
+    if (!enqueue_internal_message(msg, allow_coalesce)) {
         return false;
     }
     
@@ -97,26 +200,83 @@ bool MessageBus::publish(uint32_t msg_id, const void* data, uint8_t length) {
     return true;
 }
 
+ECU_HOT_CODE bool MessageBus::publishFromISR(uint32_t msg_id, const void* data, uint8_t length) {
+    // No debug output or shared counters here - this runs in interrupt context
+    if (length > 8) {
+        return false;
+    }
+    
+    // Claim a slot. A slot is free when its sequence equals the position
+    // being claimed; the CAS makes nested ISRs take distinct slots.
+    uint32_t pos = __atomic_load_n(&isr_enqueue_pos, __ATOMIC_RELAXED);
+    IsrSlot* slot;
+    for (;;) {
+        slot = &isr_queue[pos & (ISR_QUEUE_SIZE - 1)];
+        uint32_t seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(seq - pos);
+        
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&isr_enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+            // CAS failure reloaded pos - retry with the new position
+        } else if (diff < 0) {
+            // Consumer has not released this slot yet - ring is full
+            __atomic_fetch_add(&isr_queue_overflows, 1, __ATOMIC_RELAXED);
+            TRACE(TRACE_CAT_MSG_BUS, TRACE_MSG_BUS_ISR_OVERFLOW, 0, msg_id, 0);
+            return false;
+        } else {
+            // Another producer claimed this position first
+            pos = __atomic_load_n(&isr_enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    
+    if (is_extended_can_id(msg_id)) {
+        create_extended_can_message(&slot->message, msg_id, data, length);
+    } else {
+        create_standard_can_message(&slot->message, msg_id, data, length);
+    }
+    
+    // Release store: message contents become visible before the slot is marked filled
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
 bool MessageBus::publishFloat(uint32_t msg_id, float value) {
-    return publish(msg_id, &value, sizeof(float));
+    return publish_message(msg_id, &value, sizeof(float), true);
 }
 
 bool MessageBus::publishUint32(uint32_t msg_id, uint32_t value) {
-    return publish(msg_id, &value, sizeof(uint32_t));
+    return publish_message(msg_id, &value, sizeof(uint32_t), true);
 }
 
 bool MessageBus::publishUint16(uint32_t msg_id, uint16_t value) {
-    return publish(msg_id, &value, sizeof(uint16_t));
+    return publish_message(msg_id, &value, sizeof(uint16_t), true);
 }
 
 bool MessageBus::publishUint8(uint32_t msg_id, uint8_t value) {
-    return publish(msg_id, &value, sizeof(uint8_t));
+    return publish_message(msg_id, &value, sizeof(uint8_t), true);
 }
 
 void MessageBus::process() {
+    process(0, 0);
+}
+
+uint16_t MessageBus::process(uint32_t max_us, uint16_t max_messages) {
     // Process internal message queue
-    process_internal_queue();
+    if (process_internal_queue(max_us, max_messages)) {
+        budget_exhaustions++;
+        last_deferred_count = getQueueSize();
+    } else {
+        last_deferred_count = 0;
+    }
     
+    update_rate_statistics();
+    return last_deferred_count;
+}
+
+void MessageBus::update_rate_statistics() {
     // Update messages per second statistics
     uint32_t now_ms = millis();
     if (now_ms - last_stats_reset_ms >= 1000) {  // Every second
@@ -128,34 +288,177 @@ void MessageBus::process() {
 
 // Private methods
 
-bool MessageBus::enqueue_internal_message(const CANMessage& msg) {
-    uint16_t next_head = next_queue_index(queue_head);
+bool MessageBus::enqueue_internal_message(const CANMessage& msg, bool allow_coalesce) {
+    CANMessage* slot = claim_queue_slot(msg.id, allow_coalesce);
+    if (slot == nullptr) {
+        return false;
+    }
+    
+    *slot = msg;
+    return true;
+}
+
+ECU_HOT_CODE CANMessage* MessageBus::claim_queue_slot(uint32_t msg_id, bool allow_coalesce) {
+    // The slot is handed out already committed to the lane. That is safe
+    // because only the main loop publishes here and only process() consumes,
+    // so the caller fills it before anyone can read it.
+    uint8_t coalesce_ref = NO_COALESCE;
+    if (allow_coalesce && coalesced_id_count > 0) {
+        int16_t index = find_coalesce_entry(msg_id);
+        if (index >= 0 && coalesce_table[index].enabled) {
+            CoalesceEntry& entry = coalesce_table[index];
+            if (entry.pending) {
+                // Overwrite the queued copy in place
+                messages_coalesced++;
+                return &lanes[entry.lane].messages[entry.slot];
+            }
+            coalesce_ref = (uint8_t)index;
+        }
+    }
+    
+    // getMessagePriority() already clamps; checked again so the lane index is bounded here
+    uint8_t priority = getMessagePriority(msg_id);
+    if (priority >= MSG_PRIORITY_COUNT) {
+        priority = MSG_PRIORITY_BACKGROUND;
+    }
+    QueueLane& lane = lanes[priority];
+    uint16_t next_head = next_queue_index(lane.head);
+    
+    if (next_head == lane.tail) {
+        // Lane is full - other lanes are unaffected
+        lane.overflows++;
+        queue_overflows++;
+        TRACE(TRACE_CAT_MSG_BUS, TRACE_MSG_BUS_OVERFLOW, priority, msg_id, 0);
+        return nullptr;
+    }
+    
+    CANMessage* slot = &lane.messages[lane.head];
+    lane.coalesce_ref[lane.head] = coalesce_ref;
+    
+    if (coalesce_ref != NO_COALESCE) {
+        CoalesceEntry& entry = coalesce_table[coalesce_ref];
+        entry.pending = true;
+        entry.lane = priority;
+        entry.slot = lane.head;
+    }
+    
+    lane.head = next_head;
+    
+    uint16_t depth = getLaneSize((message_priority_t)priority);
+    if (depth > lane.peak_depth) {
+        lane.peak_depth = depth;
+    }
+    
+    return slot;
+}
+
+ECU_HOT_CODE bool MessageBus::dequeue_isr_message(CANMessage* msg) {
+    IsrSlot& slot = isr_queue[isr_dequeue_pos & (ISR_QUEUE_SIZE - 1)];
+    uint32_t seq = __atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE);
     
-    if (next_head == queue_tail) {
-        // Queue is full
+    if (seq != isr_dequeue_pos + 1) {
+        // Empty, or the producer holding this slot has not finished writing
         return false;
     }
     
-    internal_queue[queue_head] = msg;
-    queue_head = next_head;
+    *msg = slot.message;
     
+    // Hand the slot back to producers for the next lap of the ring
+    __atomic_store_n(&slot.sequence, isr_dequeue_pos + ISR_QUEUE_SIZE, __ATOMIC_RELEASE);
+    isr_dequeue_pos++;
     return true;
 }
 
-void MessageBus::process_internal_queue() {
-    while (queue_tail != queue_head) {
-        const CANMessage& msg = internal_queue[queue_tail];
+uint16_t MessageBus::get_isr_queue_size() const {
+    uint32_t claimed = __atomic_load_n(&isr_enqueue_pos, __ATOMIC_RELAXED);
+    return (uint16_t)(claimed - isr_dequeue_pos);
+}
+
+ECU_HOT_CODE bool MessageBus::process_internal_queue(uint32_t max_us, uint16_t max_messages) {
+    // Always take the next message from the most urgent non-empty lane, so
+    // critical messages published by handlers jump ahead of queued bulk traffic.
+    // Interrupt-published messages come before every lane.
+    uint32_t start_us = (max_us > 0) ? micros() : 0;
+    uint16_t delivered = 0;
+    
+    for (;; delivered++) {
+        // Budget check happens before taking the next message; at least one
+        // message is always delivered so the queue keeps moving
+        if (delivered > 0) {
+            bool count_spent = (max_messages > 0 && delivered >= max_messages);
+            bool time_spent = (max_us > 0 && (micros() - start_us) >= max_us);
+            if (count_spent || time_spent) {
+                return getQueueSize() > 0;
+            }
+        }
+        
+        CANMessage isr_msg;
+        if (dequeue_isr_message(&isr_msg)) {
+            if (profiling_enabled) {
+                record_latency(isr_msg.id, ecu_time_us() - isr_msg.timestamp_us);
+            }
+            deliver_to_subscribers(isr_msg);
+            messages_published++;
+            messages_processed++;
+            continue;
+        }
+        
+        QueueLane* lane = nullptr;
+        for (uint8_t p = 0; p < MSG_PRIORITY_COUNT; p++) {
+            if (lanes[p].tail != lanes[p].head) {
+                lane = &lanes[p];
+                break;
+            }
+        }
+        if (lane == nullptr) {
+            return false;
+        }
+        
+        const CANMessage& msg = lane->messages[lane->tail];
+        
+        // Release the coalesce slot before delivery, so a handler that
+        // republishes the same ID queues a fresh copy instead of
+        // overwriting the message being delivered
+        uint8_t coalesce_ref = lane->coalesce_ref[lane->tail];
+        if (coalesce_ref != NO_COALESCE) {
+            coalesce_table[coalesce_ref].pending = false;
+        }
+        
+        if (profiling_enabled) {
+            record_latency(msg.id, ecu_time_us() - msg.timestamp_us);
+        }
         
         // Deliver to all subscribers
         deliver_to_subscribers(msg);
         
         // Move to next message
-        queue_tail = next_queue_index(queue_tail);
+        lane->tail = next_queue_index(lane->tail);
         messages_processed++;
     }
 }
 
-void MessageBus::deliver_to_subscribers(const CANMessage& msg) {
+void MessageBus::reset_queue() {
+    // Must not race with publishFromISR() - only called before interrupts publish
+    for (uint8_t p = 0; p < MSG_PRIORITY_COUNT; p++) {
+        lanes[p].head = 0;
+        lanes[p].tail = 0;
+        lanes[p].overflows = 0;
+        lanes[p].peak_depth = 0;
+    }
+    
+    for (uint16_t i = 0; i < ISR_QUEUE_SIZE; i++) {
+        isr_queue[i].sequence = i;
+    }
+    isr_enqueue_pos = 0;
+    isr_dequeue_pos = 0;
+    isr_queue_overflows = 0;
+    
+    for (uint16_t i = 0; i < COALESCE_TABLE_SIZE; i++) {
+        coalesce_table[i].pending = false;
+    }
+}
+
+ECU_HOT_CODE void MessageBus::deliver_to_subscribers(const CANMessage& msg) {
     // Temporarily disabled to avoid serial corruption
     /*
     #ifdef ARDUINO
@@ -171,44 +474,465 @@ void MessageBus::deliver_to_subscribers(const CANMessage& msg) {
     
     // Call global broadcast handler first (for external serial forwarding)
     if (global_broadcast_handler != nullptr) {
-        #ifdef ARDUINO
-        // Debug: Check if this is a parameter message
         if (msg.len == 8) {  // parameter_msg_t is 8 bytes
-            Serial.print("MessageBus: Calling global broadcast handler for parameter message - CAN ID 0x");
-            Serial.println(msg.id, HEX);
+            TRACE(TRACE_CAT_MSG_BUS, TRACE_MSG_BUS_PARAM_BROADCAST, 0, msg.id, 0);
         }
-        #endif
-        global_broadcast_handler(&msg);
+        if (profiling_enabled) {
+            uint32_t start_us = micros();
+            global_broadcast_handler(&msg);
+            broadcast_handler_us += micros() - start_us;
+        } else {
+            global_broadcast_handler(&msg);
+        }
+    }
+    
+    // Masked subscribers: wildcard chain, then this subsystem's bucket only
+    if (wildcard_head != NO_SUBSCRIBER) {
+        deliver_to_masked_chain(wildcard_head, msg);
+    }
+    uint16_t bucket_head = subsystem_bucket_head[GET_SUBSYSTEM(msg.id) >> 20];
+    if (bucket_head != NO_SUBSCRIBER) {
+        deliver_to_masked_chain(bucket_head, msg);
+    }
+    
+    // Deliver to specific subscribers (one lookup, then only matching handlers)
+    const DispatchSlot* slot = find_dispatch_slot(msg.id, false);
+    if (slot == nullptr) {
+        return;
     }
     
-    // Deliver to specific subscribers
-    for (uint8_t i = 0; i < subscriber_count; i++) {
-        if (subscribers[i].msg_id == msg.id && subscribers[i].handler != nullptr) {
-            subscribers[i].handler(&msg);
+    for (uint16_t i = slot->head; i != NO_SUBSCRIBER; i = subscribers[i].next) {
+        Subscriber& subscriber = subscribers[i];
+        if (subscriber.handler == nullptr) {
+            continue;
+        }
+        
+        if (profiling_enabled) {
+            uint32_t start_us = micros();
+            subscriber.handler(&msg);
+            uint32_t elapsed_us = micros() - start_us;
+            subscriber.calls++;
+            subscriber.total_us += elapsed_us;
+            if (elapsed_us > subscriber.max_us) {
+                subscriber.max_us = elapsed_us;
+            }
+        } else {
+            subscriber.handler(&msg);
+        }
+    }
+}
+
+ECU_HOT_CODE void MessageBus::deliver_to_masked_chain(uint16_t head, const CANMessage& msg) {
+    for (uint16_t i = head; i != NO_SUBSCRIBER; i = masked_subscribers[i].next) {
+        const MaskedSubscriber& entry = masked_subscribers[i];
+        if ((msg.id & entry.mask) != entry.pattern) {
+            continue;
+        }
+        if (entry.required_length != 0 && msg.len != entry.required_length) {
+            continue;
+        }
+        
+        if (profiling_enabled) {
+            uint32_t start_us = micros();
+            entry.handler(&msg);
+            broadcast_handler_us += micros() - start_us;
+        } else {
+            entry.handler(&msg);
         }
     }
 }
 
+void MessageBus::clear_masked_subscribers() {
+    for (uint16_t i = 0; i < MAX_MASKED_SUBSCRIBERS; i++) {
+        masked_subscribers[i].pattern = 0;
+        masked_subscribers[i].mask = 0;
+        masked_subscribers[i].handler = nullptr;
+        masked_subscribers[i].required_length = 0;
+        masked_subscribers[i].next = NO_SUBSCRIBER;
+    }
+    for (uint16_t i = 0; i < SUBSYSTEM_BUCKETS; i++) {
+        subsystem_bucket_head[i] = NO_SUBSCRIBER;
+    }
+    wildcard_head = NO_SUBSCRIBER;
+    masked_subscriber_count = 0;
+}
+
+uint16_t MessageBus::dispatch_hash(uint32_t msg_id) {
+    return fib_hash(msg_id, DISPATCH_TABLE_BITS);
+}
+
+ECU_HOT_CODE MessageBus::DispatchSlot* MessageBus::find_dispatch_slot(uint32_t msg_id, bool create) {
+    uint16_t index = dispatch_hash(msg_id);
+    
+    // Linear probing - the table never holds more than MAX_SUBSCRIBERS IDs,
+    // so an empty slot is always reachable
+    for (uint16_t probe = 0; probe < DISPATCH_TABLE_SIZE; probe++) {
+        DispatchSlot& slot = dispatch_table[index];
+        
+        if (slot.head == NO_SUBSCRIBER) {
+            if (!create) {
+                return nullptr;
+            }
+            slot.msg_id = msg_id;
+            return &slot;
+        }
+        
+        if (slot.msg_id == msg_id) {
+            return &slot;
+        }
+        
+        index = (index + 1) & (DISPATCH_TABLE_SIZE - 1);
+    }
+    
+    return nullptr;
+}
+
+void MessageBus::clear_dispatch_table() {
+    for (uint16_t i = 0; i < DISPATCH_TABLE_SIZE; i++) {
+        dispatch_table[i].msg_id = 0;
+        dispatch_table[i].head = NO_SUBSCRIBER;
+        dispatch_table[i].tail = NO_SUBSCRIBER;
+    }
+}
+
 uint16_t MessageBus::next_queue_index(uint16_t index) const {
     return (index + 1) % INTERNAL_QUEUE_SIZE;
 }
 
 uint16_t MessageBus::getQueueSize() const {
-    if (queue_head >= queue_tail) {
-        return queue_head - queue_tail;
-    } else {
-        return INTERNAL_QUEUE_SIZE - queue_tail + queue_head;
+    uint16_t total = get_isr_queue_size();
+    for (uint8_t p = 0; p < MSG_PRIORITY_COUNT; p++) {
+        total += getLaneSize((message_priority_t)p);
     }
+    return total;
 }
 
 bool MessageBus::isQueueFull() const {
-    return next_queue_index(queue_head) == queue_tail;
+    for (uint8_t p = 0; p < MSG_PRIORITY_COUNT; p++) {
+        if (next_queue_index(lanes[p].head) == lanes[p].tail) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint16_t MessageBus::getLaneSize(message_priority_t priority) const {
+    if (priority >= MSG_PRIORITY_COUNT) {
+        return 0;
+    }
+    const QueueLane& lane = lanes[priority];
+    if (lane.head >= lane.tail) {
+        return lane.head - lane.tail;
+    } else {
+        return INTERNAL_QUEUE_SIZE - lane.tail + lane.head;
+    }
+}
+
+uint32_t MessageBus::getLaneOverflows(message_priority_t priority) const {
+    if (priority >= MSG_PRIORITY_COUNT) {
+        return 0;
+    }
+    return lanes[priority].overflows;
+}
+
+bool MessageBus::setSubsystemPriority(uint32_t subsystem, message_priority_t priority) {
+    if (priority >= MSG_PRIORITY_COUNT) {
+        return false;
+    }
+    subsystem_priority[GET_SUBSYSTEM(subsystem) >> 20] = (uint8_t)priority;
+    return true;
+}
+
+bool MessageBus::setMessagePriority(uint32_t msg_id, message_priority_t priority) {
+    if (priority >= MSG_PRIORITY_COUNT) {
+        return false;
+    }
+    
+    // Update an existing override in place
+    for (uint8_t i = 0; i < priority_override_count; i++) {
+        if (priority_overrides[i].msg_id == msg_id) {
+            priority_overrides[i].priority = (uint8_t)priority;
+            return true;
+        }
+    }
+    
+    if (priority_override_count >= MAX_PRIORITY_OVERRIDES) {
+        debug_print("MessageBus: Priority override failed - too many overrides");
+        return false;
+    }
+    
+    priority_overrides[priority_override_count].msg_id = msg_id;
+    priority_overrides[priority_override_count].priority = (uint8_t)priority;
+    priority_override_count++;
+    return true;
+}
+
+message_priority_t MessageBus::getMessagePriority(uint32_t msg_id) const {
+    uint8_t priority;
+    
+    // Per-ID overrides win (the list is short, usually empty)
+    for (uint8_t i = 0; i < priority_override_count; i++) {
+        if (priority_overrides[i].msg_id == msg_id) {
+            priority = priority_overrides[i].priority;
+            return (message_priority_t)(priority < MSG_PRIORITY_COUNT ? priority : MSG_PRIORITY_BACKGROUND);
+        }
+    }
+    
+    if (is_extended_can_id(msg_id)) {
+        priority = subsystem_priority[GET_SUBSYSTEM(msg_id) >> 20];
+        return (message_priority_t)(priority < MSG_PRIORITY_COUNT ? priority : MSG_PRIORITY_BACKGROUND);
+    }
+    
+    // Standard 11-bit IDs follow the documented range convention
+    switch (msg_id >> 8) {
+        case 0:  return MSG_PRIORITY_CRITICAL;
+        case 1:  return MSG_PRIORITY_CONTROL;
+        case 2:  return MSG_PRIORITY_BACKGROUND;
+        default: return MSG_PRIORITY_NORMAL;
+    }
+}
+
+bool MessageBus::setCoalesce(uint32_t msg_id, bool enabled) {
+    int16_t index = find_coalesce_entry(msg_id);
+    if (index < 0) {
+        if (!enabled) {
+            return true;  // Never coalesced - nothing to disable
+        }
+        index = add_coalesce_entry(msg_id);
+        if (index < 0) {
+            debug_print("MessageBus: Coalesce failed - too many coalesced IDs");
+            return false;
+        }
+    }
+    
+    coalesce_table[index].enabled = enabled;
+    return true;
+}
+
+bool MessageBus::isCoalesced(uint32_t msg_id) const {
+    int16_t index = find_coalesce_entry(msg_id);
+    return index >= 0 && coalesce_table[index].enabled;
+}
+
+uint16_t MessageBus::coalesce_hash(uint32_t msg_id) {
+    return fib_hash(msg_id, COALESCE_TABLE_BITS);
+}
+
+int16_t MessageBus::find_coalesce_entry(uint32_t msg_id) const {
+    uint16_t index = coalesce_hash(msg_id);
+    
+    // Linear probing - the table is kept at most half full
+    for (uint16_t probe = 0; probe < COALESCE_TABLE_SIZE; probe++) {
+        const CoalesceEntry& entry = coalesce_table[index];
+        if (!entry.in_use) {
+            return -1;
+        }
+        if (entry.msg_id == msg_id) {
+            return (int16_t)index;
+        }
+        index = (index + 1) & (COALESCE_TABLE_SIZE - 1);
+    }
+    
+    return -1;
+}
+
+int16_t MessageBus::add_coalesce_entry(uint32_t msg_id) {
+    if (coalesced_id_count >= MAX_COALESCED_IDS) {
+        return -1;
+    }
+    
+    uint16_t index = coalesce_hash(msg_id);
+    while (coalesce_table[index].in_use) {
+        index = (index + 1) & (COALESCE_TABLE_SIZE - 1);
+    }
+    
+    CoalesceEntry& entry = coalesce_table[index];
+    entry.msg_id = msg_id;
+    entry.in_use = true;
+    entry.enabled = false;
+    entry.pending = false;
+    coalesced_id_count++;
+    return (int16_t)index;
+}
+
+void MessageBus::clear_coalesce_table() {
+    for (uint16_t i = 0; i < COALESCE_TABLE_SIZE; i++) {
+        coalesce_table[i].msg_id = 0;
+        coalesce_table[i].in_use = false;
+        coalesce_table[i].enabled = false;
+        coalesce_table[i].pending = false;
+        coalesce_table[i].lane = 0;
+        coalesce_table[i].slot = 0;
+    }
+    coalesced_id_count = 0;
+}
+
+void MessageBus::setProfilingEnabled(bool enabled) {
+    // Every message carries its publish stamp, so queued ones count too
+    profiling_enabled = enabled;
+}
+
+void MessageBus::resetProfiling() {
+    for (uint16_t i = 0; i < MAX_SUBSCRIBERS; i++) {
+        subscribers[i].calls = 0;
+        subscribers[i].total_us = 0;
+        subscribers[i].max_us = 0;
+    }
+    
+    for (uint16_t i = 0; i < LATENCY_TABLE_SIZE; i++) {
+        latency_table[i].in_use = false;
+    }
+    profiled_id_count = 0;
+    
+    for (uint8_t p = 0; p < MSG_PRIORITY_COUNT; p++) {
+        lanes[p].peak_depth = 0;
+    }
+    
+    broadcast_handler_us = 0;
+    unprofiled_deliveries = 0;
+}
+
+bool MessageBus::getHandlerProfile(uint16_t subscriber_index, handler_profile_t* profile) const {
+    if (subscriber_index >= subscriber_count || profile == nullptr) {
+        return false;
+    }
+    
+    const Subscriber& subscriber = subscribers[subscriber_index];
+    profile->msg_id = subscriber.msg_id;
+    profile->calls = subscriber.calls;
+    profile->total_us = subscriber.total_us;
+    profile->max_us = subscriber.max_us;
+    return true;
+}
+
+bool MessageBus::getLatencyProfile(uint32_t msg_id, latency_profile_t* profile) const {
+    if (profile == nullptr) {
+        return false;
+    }
+    
+    uint16_t index = fib_hash(msg_id, LATENCY_TABLE_BITS);
+    for (uint16_t probe = 0; probe < LATENCY_TABLE_SIZE; probe++) {
+        const LatencyEntry& entry = latency_table[index];
+        if (!entry.in_use) {
+            return false;
+        }
+        if (entry.profile.msg_id == msg_id) {
+            *profile = entry.profile;
+            return true;
+        }
+        index = (index + 1) & (LATENCY_TABLE_SIZE - 1);
+    }
+    
+    return false;
+}
+
+int16_t MessageBus::getHottestHandler() const {
+    int16_t hottest = -1;
+    uint32_t hottest_us = 0;
+    
+    for (uint16_t i = 0; i < subscriber_count; i++) {
+        if (subscribers[i].calls > 0 && (hottest < 0 || subscribers[i].total_us > hottest_us)) {
+            hottest = (int16_t)i;
+            hottest_us = subscribers[i].total_us;
+        }
+    }
+    
+    return hottest;
+}
+
+uint16_t MessageBus::getLanePeakDepth(message_priority_t priority) const {
+    if (priority >= MSG_PRIORITY_COUNT) {
+        return 0;
+    }
+    return lanes[priority].peak_depth;
+}
+
+uint16_t MessageBus::getQueuePeakDepth() const {
+    uint16_t peak = 0;
+    for (uint8_t p = 0; p < MSG_PRIORITY_COUNT; p++) {
+        if (lanes[p].peak_depth > peak) {
+            peak = lanes[p].peak_depth;
+        }
+    }
+    return peak;
+}
+
+void MessageBus::record_latency(uint32_t msg_id, uint32_t latency_us) {
+    uint16_t index = fib_hash(msg_id, LATENCY_TABLE_BITS);
+    
+    // Find or claim this ID's entry (linear probing, table kept half full)
+    LatencyEntry* entry = nullptr;
+    for (uint16_t probe = 0; probe < LATENCY_TABLE_SIZE; probe++) {
+        LatencyEntry& candidate = latency_table[index];
+        if (!candidate.in_use) {
+            if (profiled_id_count >= MAX_PROFILED_IDS) {
+                break;
+            }
+            candidate.in_use = true;
+            memset(&candidate.profile, 0, sizeof(candidate.profile));
+            candidate.profile.msg_id = msg_id;
+            profiled_id_count++;
+            entry = &candidate;
+            break;
+        }
+        if (candidate.profile.msg_id == msg_id) {
+            entry = &candidate;
+            break;
+        }
+        index = (index + 1) & (LATENCY_TABLE_SIZE - 1);
+    }
+    
+    if (entry == nullptr) {
+        unprofiled_deliveries++;
+        return;
+    }
+    
+    latency_profile_t& profile = entry->profile;
+    profile.samples++;
+    profile.total_us += latency_us;
+    if (latency_us > profile.max_us) {
+        profile.max_us = latency_us;
+    }
+    
+    uint8_t bucket = 0;
+    while (bucket < MSG_BUS_LATENCY_BUCKETS - 1 && latency_us >= LATENCY_BUCKET_LIMITS_US[bucket]) {
+        bucket++;
+    }
+    profile.buckets[bucket]++;
+}
+
+void MessageBus::resetPriorities() {
+    for (uint16_t i = 0; i < 256; i++) {
+        subsystem_priority[i] = MSG_PRIORITY_NORMAL;
+    }
+    
+    subsystem_priority[SUBSYSTEM_FUEL >> 20] = MSG_PRIORITY_CRITICAL;
+    subsystem_priority[SUBSYSTEM_IGNITION >> 20] = MSG_PRIORITY_CRITICAL;
+    subsystem_priority[SUBSYSTEM_SENSORS >> 20] = MSG_PRIORITY_CRITICAL;
+    subsystem_priority[SUBSYSTEM_TRANSMISSION >> 20] = MSG_PRIORITY_CRITICAL;
+    
+    subsystem_priority[SUBSYSTEM_COOLING >> 20] = MSG_PRIORITY_CONTROL;
+    subsystem_priority[SUBSYSTEM_EXHAUST >> 20] = MSG_PRIORITY_CONTROL;
+    subsystem_priority[SUBSYSTEM_BOOST >> 20] = MSG_PRIORITY_CONTROL;
+    subsystem_priority[SUBSYSTEM_SYSTEM >> 20] = MSG_PRIORITY_CONTROL;
+    
+    subsystem_priority[SUBSYSTEM_STORAGE >> 20] = MSG_PRIORITY_BACKGROUND;
+    subsystem_priority[SUBSYSTEM_DEBUG >> 20] = MSG_PRIORITY_BACKGROUND;
+    
+    priority_override_count = 0;
 }
 
 void MessageBus::resetStatistics() {
     messages_processed = 0;
     queue_overflows = 0;
+    for (uint8_t p = 0; p < MSG_PRIORITY_COUNT; p++) {
+        lanes[p].overflows = 0;
+    }
+    isr_queue_overflows = 0;
     messages_published = 0;
+    messages_coalesced = 0;
+    budget_exhaustions = 0;
+    last_deferred_count = 0;
     messages_per_second = 0;
     last_stats_reset_ms = millis();
 }
@@ -216,10 +940,13 @@ void MessageBus::resetStatistics() {
 void MessageBus::resetSubscribers() {
     subscriber_count = 0;
     // Clear all subscriber entries
-    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+    for (uint16_t i = 0; i < MAX_SUBSCRIBERS; i++) {
         subscribers[i].msg_id = 0;
         subscribers[i].handler = nullptr;
+        subscribers[i].next = NO_SUBSCRIBER;
     }
+    clear_dispatch_table();
+    clear_masked_subscribers();
 }
 
 void MessageBus::setGlobalBroadcastHandler(MessageHandler handler) {
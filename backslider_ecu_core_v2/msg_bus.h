@@ -39,10 +39,22 @@
 //    - Reads incoming CAN messages → adds to internal queue
 //    - Processes internal queue → delivers to subscribers
 //    - Subscribers receive messages regardless of source
+//    - bus.process(max_us) bounds the time spent; leftover messages
+//      (always the least urgent) wait for the next call
 //
 // 3. SUBSCRIBER BEHAVIOR:
 //    - Modules subscribe: bus.subscribe(MSG_ENGINE_RPM, handler)
 //    - Handler called for EVERY message with that ID
+//    - Delivery is a single hashed lookup on the message ID, then only
+//      the handlers for that ID are called (cost independent of how
+//      many other IDs have subscribers)
+//    - Masked subscriptions match a family of IDs:
+//        bus.subscribeMasked(SUBSYSTEM_TRANSMISSION, SUBSYSTEM_MASK, handler)
+//      Masks covering the whole SUBSYSTEM_MASK are bucketed by subsystem,
+//      so unrelated subsystems never reach the handler. An optional
+//      payload length filter (e.g. sizeof(parameter_msg_t)) skips
+//      non-matching frames without a call. Masked handlers run before
+//      exact ones, in the place of the legacy global broadcast handler.
 //    - No distinction between local vs CAN-sourced messages
 //    - Same handler processes both sources transparently
 //
@@ -59,6 +71,31 @@
 //   - 0x200-0x2FF: Low priority (status/diagnostics)
 //   - 0x300-0x3FF: System messages
 //
+// • PRIORITY LANES: The internal queue is split into one FIFO per priority
+//   class. process() always drains the most urgent non-empty lane first, so
+//   a flood of storage or tuning traffic cannot delay RPM or shift messages.
+//   - Extended IDs are classed by GET_SUBSYSTEM(), standard IDs by range
+//   - setSubsystemPriority() / setMessagePriority() override the defaults
+//   - Each lane counts its own overflows (getLaneOverflows())
+//
+// • INTERRUPT CONTEXT: publish() is main-loop only. ISRs must use
+//   publishFromISR(), which writes into a separate lock-free ring:
+//   - Multi-producer (nested ISRs may publish), single consumer (process())
+//   - Each slot carries a sequence number; producers claim a slot with a
+//     compare-and-swap and publish it with a release store, the consumer
+//     reads it with an acquire load (DMB on the Cortex-M7)
+//   - No interrupt masking, no blocking, bounded work per call
+//   - ISR messages are delivered ahead of every priority lane
+//
+// • COALESCED IDs: setCoalesce(id, true) marks a periodic "latest value"
+//   message. At most one copy of that ID waits in its lane; publishing
+//   again while it is pending overwrites the queued value in place (same
+//   queue position, new payload and timestamp). Queue depth is then bounded
+//   by the number of distinct IDs, not by publish rate. Only the typed
+//   helpers (publishFloat() etc.) coalesce; raw publish() payloads such as
+//   parameter requests on the same ID are always queued individually.
+//   Only use this for state values - never for events or edges.
+//
 // • TRANSPARENT COMMUNICATION: Modules don't know message source
 //   - Local module publishing RPM looks identical to
 //   - Remote ECU sending RPM over physical CAN
@@ -107,6 +144,8 @@
 #define MSG_BUS_H
 
 #include "msg_definitions.h"
+#include <string.h>
+#include <type_traits>
 
 #ifdef ARDUINO
     #include <Arduino.h>
@@ -120,11 +159,57 @@
     #endif
 #endif
 
+// Internal queue priority classes (lower value = drained first)
+typedef enum {
+    MSG_PRIORITY_CRITICAL = 0,    // Engine timing, fuel, sensors, shift control
+    MSG_PRIORITY_CONTROL,         // Boost, cooling, exhaust and system control
+    MSG_PRIORITY_NORMAL,          // Configuration, parameters, external comms
+    MSG_PRIORITY_BACKGROUND,      // Storage and debug traffic
+    MSG_PRIORITY_COUNT            // Number of priority lanes
+} message_priority_t;
+
+// Profiling results (see MessageBus::setProfilingEnabled())
+typedef struct {
+    uint32_t msg_id;            // Message ID the handler is subscribed to
+    uint32_t calls;             // Handler invocations while profiling
+    uint32_t total_us;          // Cumulative time spent in the handler
+    uint32_t max_us;            // Longest single invocation
+} handler_profile_t;
+
+#define MSG_BUS_LATENCY_BUCKETS 8
+
+typedef struct {
+    uint32_t msg_id;
+    uint32_t samples;           // Messages delivered while profiling
+    uint32_t total_us;          // Sum of publish-to-deliver latency
+    uint32_t max_us;            // Worst publish-to-deliver latency
+    uint32_t buckets[MSG_BUS_LATENCY_BUCKETS];  // Counts per latency bucket
+} latency_profile_t;
+
 class MessageBus {
 public:
     // Configuration constants
-    static const uint8_t MAX_SUBSCRIBERS = 32;  // Increased for comprehensive ECU module support
-    static const uint16_t INTERNAL_QUEUE_SIZE = 128;
+    static const uint16_t MAX_SUBSCRIBERS = 128;  // Total handlers across all message IDs
+    static const uint16_t MAX_MASKED_SUBSCRIBERS = 32;  // Handlers on masked ID families
+    static const uint16_t SUBSYSTEM_BUCKETS = 256;  // One bucket per 8-bit subsystem
+    static const uint16_t INTERNAL_QUEUE_SIZE = 128;  // Capacity of each priority lane
+    static const uint8_t MAX_PRIORITY_OVERRIDES = 16;  // Per-ID priority overrides
+    static const uint16_t ISR_QUEUE_SIZE = 32;  // Interrupt publish ring (power of two)
+    static const uint8_t COALESCE_TABLE_BITS = 6;  // Coalesced-ID table (64 entries)
+    static const uint16_t COALESCE_TABLE_SIZE = (1u << COALESCE_TABLE_BITS);
+    static const uint16_t MAX_COALESCED_IDS = COALESCE_TABLE_SIZE / 2;
+    static const uint8_t LATENCY_TABLE_BITS = 6;  // Profiled-ID table (64 entries)
+    static const uint16_t LATENCY_TABLE_SIZE = (1u << LATENCY_TABLE_BITS);
+    static const uint16_t MAX_PROFILED_IDS = LATENCY_TABLE_SIZE / 2;
+    
+    // Upper bound (exclusive) of each latency bucket in microseconds; the
+    // last bucket collects everything slower
+    static const uint32_t LATENCY_BUCKET_LIMITS_US[MSG_BUS_LATENCY_BUCKETS - 1];
+    
+    // Dispatch table sizing (power of two, kept at >= 2x MAX_SUBSCRIBERS so
+    // open-addressing probes stay short even when every handler has its own ID)
+    static const uint8_t DISPATCH_TABLE_BITS = 8;
+    static const uint16_t DISPATCH_TABLE_SIZE = (1u << DISPATCH_TABLE_BITS);
     
     // Constructor
     MessageBus();
@@ -135,29 +220,119 @@ public:
     // Subscribe to a message ID
     bool subscribe(uint32_t msg_id, MessageHandler handler);
     
+    // Subscribe to every ID where (id & id_mask) == (id_pattern & id_mask),
+    // optionally only for frames of required_length bytes (0 = any length)
+    bool subscribeMasked(uint32_t id_pattern, uint32_t id_mask, MessageHandler handler,
+                         uint8_t required_length = 0);
+    
     // Publish a message to internal queue
     bool publish(uint32_t msg_id, const void* data, uint8_t length);
     
+    // Publish from interrupt context (lock-free, safe against nested ISRs).
+    // Returns false without blocking if the ISR ring is full.
+    bool publishFromISR(uint32_t msg_id, const void* data, uint8_t length);
+    
     // Process all pending messages (call from main loop)
     void process();
     
+    // Process pending messages within a budget (0 = no limit for either).
+    // Stops once max_us has elapsed or max_messages have been delivered, but
+    // always delivers at least one pending message. Most urgent lanes go
+    // first, so deferred work is always the least urgent. Returns the number
+    // of messages left queued for the next call.
+    uint16_t process(uint32_t max_us, uint16_t max_messages = 0);
+    
     // Helper methods for common data types
     bool publishFloat(uint32_t msg_id, float value);
     bool publishUint32(uint32_t msg_id, uint32_t value);
     bool publishUint16(uint32_t msg_id, uint16_t value);
     bool publishUint8(uint32_t msg_id, uint8_t value);
     
+    // Typed publish/subscribe - ID and payload type are fixed at compile time
+    //
+    //   g_message_bus.publish<float, MSG_ENGINE_RPM>(rpm);
+    //   g_message_bus.subscribe<float, MSG_ENGINE_RPM, handle_rpm>();
+    //   static void handle_rpm(const float& rpm) { ... }
+    //
+    // Payload size and ID class are checked with static_assert, the frame
+    // header is constant, and the value is written straight into the queue
+    // slot. Typed handlers only see frames whose length matches sizeof(T),
+    // so raw parameter requests on the same ID never reach them.
+    template<typename T, uint32_t ID>
+    bool publish(const T& value) {
+        static_assert(sizeof(T) <= 8, "Typed payload must fit in one CAN frame");
+        static_assert(std::is_trivially_copyable<T>::value, "Typed payload must be trivially copyable");
+        static_assert((ID & 0xFFFF0000u) != 0 || ID <= 0x7FFu, "ID is neither extended nor a valid 11-bit ID");
+        
+        CANMessage* slot = claim_queue_slot(ID, true);
+        if (slot == nullptr) {
+            return false;  // Overflow is counted and traced by claim_queue_slot()
+        }
+        
+        slot->id = ID;
+        slot->len = sizeof(T);
+        memcpy(slot->buf, &value, sizeof(T));
+        slot->timestamp_us = ecu_time_us();
+        slot->timestamp = (uint16_t)slot->timestamp_us;
+        slot->flags.extended = 1;
+        slot->flags.remote = 0;
+        
+        messages_published++;
+        return true;
+    }
+    
+    template<typename T, uint32_t ID, void (*Handler)(const T&)>
+    bool subscribe() {
+        static_assert(sizeof(T) <= 8, "Typed payload must fit in one CAN frame");
+        static_assert(std::is_trivially_copyable<T>::value, "Typed payload must be trivially copyable");
+        static_assert((ID & 0xFFFF0000u) != 0 || ID <= 0x7FFu, "ID is neither extended nor a valid 11-bit ID");
+        return subscribe(ID, &typed_handler_trampoline<T, Handler>);
+    }
+    
     // Statistics and diagnostics
     uint32_t getMessagesProcessed() const { return messages_processed; }
     uint32_t getQueueOverflows() const { return queue_overflows; }
     uint32_t getMessagesPublished() const { return messages_published; }
     uint32_t getMessagesPerSecond() const { return messages_per_second; }
+    uint32_t getIsrQueueOverflows() const { return isr_queue_overflows; }
+    uint32_t getBudgetExhaustions() const { return budget_exhaustions; }   // Budgeted calls that deferred work
+    uint16_t getLastDeferredCount() const { return last_deferred_count; }  // Messages left by the last process()
 
     uint16_t getSubscriberCount() const { return subscriber_count; }
+    uint16_t getMaskedSubscriberCount() const { return masked_subscriber_count; }
     
-    // Queue status
+    // Queue status (totals across all priority lanes)
     uint16_t getQueueSize() const;
-    bool isQueueFull() const;
+    bool isQueueFull() const;     // True if any lane is full
+    
+    // Priority lanes
+    bool setSubsystemPriority(uint32_t subsystem, message_priority_t priority);
+    bool setMessagePriority(uint32_t msg_id, message_priority_t priority);
+    message_priority_t getMessagePriority(uint32_t msg_id) const;
+    void resetPriorities();
+    
+    // Profiling (off by default). While enabled, publish-to-deliver latency
+    // (from each message's timestamp_us; a coalesced message counts from
+    // its newest value) is histogrammed per ID, and each handler's
+    // cumulative micros() cost is recorded.
+    // Lane depth watermarks are always tracked.
+    void setProfilingEnabled(bool enabled);
+    bool isProfilingEnabled() const { return profiling_enabled; }
+    void resetProfiling();
+    bool getHandlerProfile(uint16_t subscriber_index, handler_profile_t* profile) const;
+    bool getLatencyProfile(uint32_t msg_id, latency_profile_t* profile) const;
+    int16_t getHottestHandler() const;      // Subscriber index with most total time, -1 if none
+    uint32_t getBroadcastHandlerUs() const { return broadcast_handler_us; }  // Global + masked handlers
+    uint16_t getLanePeakDepth(message_priority_t priority) const;
+    uint16_t getQueuePeakDepth() const;     // Deepest lane watermark
+    uint32_t getUnprofiledDeliveries() const { return unprofiled_deliveries; }
+    
+    // Latest-value coalescing (main-loop publish() only)
+    bool setCoalesce(uint32_t msg_id, bool enabled);
+    bool isCoalesced(uint32_t msg_id) const;
+    uint32_t getMessagesCoalesced() const { return messages_coalesced; }
+    uint16_t getLaneSize(message_priority_t priority) const;
+    uint32_t getLaneOverflows(message_priority_t priority) const;
     
     // Reset statistics
     void resetStatistics();
@@ -165,38 +340,155 @@ public:
     // Reset subscribers (for testing)
     void resetSubscribers();
     
-    // Global broadcast callback (called for every message)
+    // Global broadcast callback (called for every message). Superseded by
+    // subscribeMasked(); kept for existing callers.
     static MessageHandler global_broadcast_handler;
     static void setGlobalBroadcastHandler(MessageHandler handler);
     static void clearGlobalBroadcastHandler();
 
 private:
+    // Unpacks a frame into T for a typed handler (one per handler instantiation)
+    template<typename T, void (*Handler)(const T&)>
+    static void typed_handler_trampoline(const CANMessage* msg) {
+        if (msg->len != sizeof(T)) {
+            return;
+        }
+        T value;
+        memcpy(&value, msg->buf, sizeof(T));
+        Handler(value);
+    }
+    
     // Subscriber management
+    //
+    // Subscribers are stored append-only and chained per message ID. The
+    // dispatch table maps each subscribed ID to the head/tail of its chain,
+    // so delivery is one hash lookup plus a walk over only the matching
+    // handlers. Handlers are called in the order they subscribed, and
+    // subscribing from inside a handler never moves existing entries.
+    static const uint16_t NO_SUBSCRIBER = 0xFFFF;
+    
     struct Subscriber {
         uint32_t msg_id;
         MessageHandler handler;
+        uint16_t next;          // Next subscriber for the same ID (NO_SUBSCRIBER = end)
+        uint32_t calls;         // Profiling: invocations
+        uint32_t total_us;      // Profiling: cumulative handler time
+        uint32_t max_us;        // Profiling: longest invocation
     };
     Subscriber subscribers[MAX_SUBSCRIBERS];
-    uint8_t subscriber_count;
+    uint16_t subscriber_count;
     
-    // Internal message queue (circular buffer using FlexCAN format)
-    CANMessage internal_queue[INTERNAL_QUEUE_SIZE];
-    volatile uint16_t queue_head;
-    volatile uint16_t queue_tail;
+    struct DispatchSlot {
+        uint32_t msg_id;
+        uint16_t head;          // First subscriber for this ID (NO_SUBSCRIBER = empty slot)
+        uint16_t tail;          // Last subscriber for this ID (for O(1) append)
+    };
+    DispatchSlot dispatch_table[DISPATCH_TABLE_SIZE];
+    
+    // Masked subscribers, chained either into their subsystem's bucket or,
+    // when the mask does not pin the subsystem, into the wildcard chain
+    struct MaskedSubscriber {
+        uint32_t pattern;       // Pre-masked ID pattern
+        uint32_t mask;
+        MessageHandler handler;
+        uint8_t required_length;  // 0 = any length
+        uint16_t next;
+    };
+    MaskedSubscriber masked_subscribers[MAX_MASKED_SUBSCRIBERS];
+    uint16_t masked_subscriber_count;
+    uint16_t subsystem_bucket_head[SUBSYSTEM_BUCKETS];
+    uint16_t wildcard_head;
+    
+    // Internal message queue - one circular buffer per priority lane
+    static const uint8_t NO_COALESCE = 0xFF;
+    
+    struct QueueLane {
+        CANMessage messages[INTERNAL_QUEUE_SIZE];
+        uint8_t coalesce_ref[INTERNAL_QUEUE_SIZE];  // Coalesce table index, NO_COALESCE if none
+        volatile uint16_t head;
+        volatile uint16_t tail;
+        uint32_t overflows;
+        uint16_t peak_depth;                        // High-water mark
+    };
+    QueueLane lanes[MSG_PRIORITY_COUNT];
+    
+    // Priority classification (subsystem defaults plus per-ID overrides)
+    uint8_t subsystem_priority[256];    // Indexed by GET_SUBSYSTEM(id) >> 20
+    struct PriorityOverride {
+        uint32_t msg_id;
+        uint8_t priority;
+    };
+    PriorityOverride priority_overrides[MAX_PRIORITY_OVERRIDES];
+    uint8_t priority_override_count;
+    
+    // Coalesced IDs (open addressing, entries are never removed - disabling
+    // only clears the enabled flag)
+    struct CoalesceEntry {
+        uint32_t msg_id;
+        bool in_use;
+        bool enabled;
+        bool pending;           // A copy is currently queued
+        uint8_t lane;           // Lane holding the pending copy
+        uint16_t slot;          // Queue index of the pending copy
+    };
+    CoalesceEntry coalesce_table[COALESCE_TABLE_SIZE];
+    uint16_t coalesced_id_count;
+    
+    // Profiling state
+    struct LatencyEntry {
+        bool in_use;
+        latency_profile_t profile;
+    };
+    LatencyEntry latency_table[LATENCY_TABLE_SIZE];
+    uint16_t profiled_id_count;
+    bool profiling_enabled;
+    uint32_t broadcast_handler_us;
+    uint32_t unprofiled_deliveries;     // Latency samples dropped (ID table full)
+    
+    // Interrupt publish ring (bounded MPSC queue with per-slot sequence numbers)
+    struct IsrSlot {
+        volatile uint32_t sequence;     // == position when free, position + 1 when filled
+        CANMessage message;
+    };
+    IsrSlot isr_queue[ISR_QUEUE_SIZE];
+    volatile uint32_t isr_enqueue_pos;  // Claimed by producers with CAS
+    uint32_t isr_dequeue_pos;           // Owned by process()
+    volatile uint32_t isr_queue_overflows;
     
     // Statistics
     uint32_t messages_processed;
-    uint32_t queue_overflows;
+    uint32_t queue_overflows;         // Total across all lanes
     uint32_t messages_published;
+    uint32_t messages_coalesced;
+    uint32_t budget_exhaustions;
+    uint16_t last_deferred_count;
     uint32_t messages_per_second;
     uint32_t last_stats_reset_ms;
     
     // Internal methods
-    bool enqueue_internal_message(const CANMessage& msg);
-    void process_internal_queue();
+    bool publish_message(uint32_t msg_id, const void* data, uint8_t length, bool allow_coalesce);
+    bool enqueue_internal_message(const CANMessage& msg, bool allow_coalesce);
+    CANMessage* claim_queue_slot(uint32_t msg_id, bool allow_coalesce);
+    bool process_internal_queue(uint32_t max_us, uint16_t max_messages);
+    void update_rate_statistics();
+    void reset_queue();
+    bool dequeue_isr_message(CANMessage* msg);
+    uint16_t get_isr_queue_size() const;
     void deliver_to_subscribers(const CANMessage& msg);
+    void deliver_to_masked_chain(uint16_t head, const CANMessage& msg);
+    void clear_masked_subscribers();
     uint16_t next_queue_index(uint16_t index) const;
     
+    // Dispatch table helpers
+    static uint16_t dispatch_hash(uint32_t msg_id);
+    DispatchSlot* find_dispatch_slot(uint32_t msg_id, bool create);
+    void clear_dispatch_table();
+    static uint16_t coalesce_hash(uint32_t msg_id);
+    int16_t find_coalesce_entry(uint32_t msg_id) const;
+    int16_t add_coalesce_entry(uint32_t msg_id);
+    void clear_coalesce_table();
+    void record_latency(uint32_t msg_id, uint32_t latency_us);
+    
     // Debugging
     void debug_print(const char* message);
     void debug_print_message(const CANMessage& msg, const char* prefix);
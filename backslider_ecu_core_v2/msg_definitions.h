@@ -6,14 +6,15 @@
 
 #include <stdint.h>
 #include <string.h>  // for memcpy
+#include "ecu_time.h"
 
-// Use FlexCAN message format on Arduino, mock for desktop testing
+// Use FlexCAN frame format on Arduino, mock for desktop testing
 #ifdef ARDUINO
     #include <FlexCAN_T4.h>
     // Use FlexCAN_T4 extended message structure
-    typedef CAN_message_t CANMessage;
+    typedef CAN_message_t CANFrame;
 #else
-    // Mock CAN message structure for desktop testing - extended CAN support
+    // Mock CAN frame structure for desktop testing - extended CAN support
     typedef struct {
         uint32_t id;          // Message ID (29-bit extended)
         uint8_t len;          // Data length (0-8 bytes)
@@ -24,9 +25,15 @@
             uint8_t remote : 1;    // Remote frame flag
             uint8_t reserved : 6;  // Reserved bits
         } flags;
-    } CANMessage;
+    } CANFrame;
 #endif
 
+// Bus message: the frame plus its publish time on the shared clock
+// (ecu_time.h). Legacy serial frames carry only the CANFrame part.
+struct CANMessage : CANFrame {
+    uint32_t timestamp_us;      // ecu_time_us() at publish
+};
+
 // =============================================================================
 // EXTENDED CAN ID ARCHITECTURE
 // =============================================================================
@@ -90,6 +97,7 @@
 #define MSG_CRANK_POSITION      MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, SENSOR_ID(0x09))
 #define MSG_TIMING_TRIGGER      MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, SENSOR_ID(0x0A))
 #define MSG_BRAKE_PEDAL         MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, SENSOR_ID(0x0B))
+#define MSG_CRANK_PREDICTION_ERROR MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, SENSOR_ID(0x0C))  // Mean |error| of tooth-time predictions, crank degrees
 
 // =============================================================================
 // CONTROL MESSAGE DEFINITIONS
@@ -99,6 +107,7 @@
 #define MSG_IGNITION_TIMING     MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_IGNITION, CONTROL_ID(0x01))
 #define MSG_FUEL_PULSE_WIDTH    MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_FUEL, CONTROL_ID(0x01))
 #define MSG_IDLE_TARGET_RPM     MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_FUEL, CONTROL_ID(0x02))
+#define MSG_FUEL_INJECTION_TIMING MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_FUEL, CONTROL_ID(0x03))  // End of injection, degrees BTDC
 #define MSG_BOOST_TARGET        MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_BOOST, CONTROL_ID(0x01))
 
 // Engine output controls
@@ -181,6 +190,80 @@
 #define MSG_ENGINE_STATUS       MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x03)
 #define MSG_ERROR_CODES         MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x04)
 
+// Message bus profiling (parameter protocol). SELECT picks a subscriber by
+// index; the HANDLER_* and LATENCY_* reads describe that subscriber and its ID.
+#define MSG_BUS_PROFILE_ENABLE              MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x10)
+#define MSG_BUS_PROFILE_SELECT              MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x11)
+#define MSG_BUS_PROFILE_HANDLER_SUBSYSTEM   MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x12)
+#define MSG_BUS_PROFILE_HANDLER_PARAMETER   MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x13)
+#define MSG_BUS_PROFILE_HANDLER_CALLS       MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x14)
+#define MSG_BUS_PROFILE_HANDLER_TOTAL_US    MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x15)
+#define MSG_BUS_PROFILE_HANDLER_MAX_US      MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x16)
+#define MSG_BUS_PROFILE_LATENCY_AVG_US      MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x17)
+#define MSG_BUS_PROFILE_LATENCY_MAX_US      MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x18)
+#define MSG_BUS_PROFILE_LATENCY_BUCKET      MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x19)
+#define MSG_BUS_PROFILE_LATENCY_COUNT       MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x1A)
+#define MSG_BUS_PROFILE_HOTTEST_HANDLER     MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x1B)
+#define MSG_BUS_PROFILE_BROADCAST_US        MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x1C)
+#define MSG_BUS_QUEUE_PEAK_DEPTH            MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x1D)
+
+// Main loop timing, published by the task executive once per accounting
+// window. Loop times are of passes that ran at least one task.
+#define MSG_LOOP_TIME_MIN_US                MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x20)
+#define MSG_LOOP_TIME_MAX_US                MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x21)
+#define MSG_LOOP_TIME_P99_US                MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x22)
+#define MSG_CPU_LOAD                        MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x23)  // Busy / wall time, %
+#define MSG_TASK_LOAD(index)                MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x30 + (index))  // % of wall time, per task
+
+// Memory accounting, published by memory_monitor once a second. Bytes
+// unless noted; static sizes are fixed at link time.
+#define MSG_MEM_DTCM_STATIC                 MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x40)  // .data + .bss
+#define MSG_MEM_ITCM                        MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x41)
+#define MSG_MEM_OCRAM_STATIC                MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x42)  // DMAMEM
+#define MSG_MEM_STACK_HIGH_WATER            MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x43)
+#define MSG_MEM_STACK_FREE                  MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x44)  // Never touched
+#define MSG_MEM_HEAP_HIGH_WATER             MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x45)  // Arena claimed from sbrk
+#define MSG_MEM_HEAP_IN_USE                 MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x46)
+#define MSG_MEM_HEAP_FREE                   MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x47)
+#define MSG_MEM_HEAP_FRAGMENTATION          MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x48)  // % of free heap trapped in the arena
+
+// Boot timing, published once by boot_sequence when the last deferred
+// stage has run. Times in µs from reset; stage indexes in boot order.
+#define MSG_BOOT_READY_US                   MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x60)  // Control loop started
+#define MSG_BOOT_COMPLETE_US                MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x61)  // Deferred stages done
+#define MSG_BOOT_FAILED_STAGES              MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x62)
+#define MSG_BOOT_STAGE_US(index)            MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x70 + (index))  // Duration, per stage
+
+// Batched parameter access (parameter_batch_msg_t, PARAM_OP_BATCH_*)
+#define MSG_PARAM_BATCH                     MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SYSTEM, 0x50)
+
+// Serial link negotiation (external_serial.h). Both use serial_link_msg_t.
+#define MSG_SERIAL_LINK_HELLO               MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x01)  // Host -> ECU
+#define MSG_SERIAL_LINK_ACK                 MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x02)  // ECU -> host
+
+// Compact telemetry on a v2 serial link (external_serial.h)
+#define MSG_SERIAL_TELEMETRY_CONFIG         MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x03)  // Host -> ECU, serial_telemetry_config_msg_t
+#define MSG_SERIAL_TELEMETRY_ACK            MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x04)  // ECU -> host, serial_telemetry_ack_msg_t
+#define MSG_SERIAL_TELEMETRY_FRAME          MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x05)  // ECU -> host, block record
+
+// External CAN bus telemetry (external_canbus.h), published once per
+// telemetry window. Wait figures are queue to TX mailbox; bucket counts and
+// top-ID rates cover the last window, error counts since reset.
+#define MSG_EXT_CAN_BUS_LOAD                MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x10)  // %, last load window
+#define MSG_EXT_CAN_PEAK_BUS_LOAD           MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x11)  // %
+#define MSG_EXT_CAN_TX_WAIT_AVG_US          MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x12)
+#define MSG_EXT_CAN_TX_WAIT_P99_US          MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x13)  // Bucket upper limit
+#define MSG_EXT_CAN_TX_WAIT_MAX_US          MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x14)  // Since reset
+#define MSG_EXT_CAN_TX_RETRIES              MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x15)  // uint32, mailbox busy
+#define MSG_EXT_CAN_TX_WAIT_BUCKET(index)   MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x18 + (index))  // uint32
+#define MSG_EXT_CAN_TX_ERROR_COUNTER        MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x20)  // uint8, TEC
+#define MSG_EXT_CAN_RX_ERROR_COUNTER        MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x21)  // uint8, REC
+#define MSG_EXT_CAN_FAULT_STATE             MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x22)  // uint8, can_fault_state_t
+#define MSG_EXT_CAN_ERROR_PASSIVE_EVENTS    MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x23)  // uint32
+#define MSG_EXT_CAN_BUS_OFF_EVENTS          MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x24)  // uint32
+#define MSG_EXT_CAN_TOP_ID(rank)            MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x28 + (rank))  // uint32 CAN ID
+#define MSG_EXT_CAN_TOP_RATE(rank)          MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x2C + (rank))  // Frames/s, RX + TX
+
 // =============================================================================
 // MAP CELL DIRECT ADDRESSING
 // =============================================================================
@@ -197,6 +280,38 @@
 #define MSG_BOOST_MAP_CELL(row, col) \
     MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_BOOST, MAP_CELL_ID(row, col))
 
+// Map axis breakpoints - rows above any map's cells (X = columns, Y = rows)
+#define MAP_AXIS_X_ROW          0xFF
+#define MAP_AXIS_Y_ROW          0xFE
+#define MSG_FUEL_MAP_X_BIN(i)       MSG_FUEL_MAP_CELL(MAP_AXIS_X_ROW, i)
+#define MSG_FUEL_MAP_Y_BIN(i)       MSG_FUEL_MAP_CELL(MAP_AXIS_Y_ROW, i)
+#define MSG_IGNITION_MAP_X_BIN(i)   MSG_IGNITION_MAP_CELL(MAP_AXIS_X_ROW, i)
+#define MSG_IGNITION_MAP_Y_BIN(i)   MSG_IGNITION_MAP_CELL(MAP_AXIS_Y_ROW, i)
+#define MSG_BOOST_MAP_X_BIN(i)      MSG_BOOST_MAP_CELL(MAP_AXIS_X_ROW, i)
+#define MSG_BOOST_MAP_Y_BIN(i)      MSG_BOOST_MAP_CELL(MAP_AXIS_Y_ROW, i)
+
+// Staged tuning control - write to swap in or drop staged edits; the blob
+// key holds the whole persisted table
+#define MAP_CONTROL_ROW         0xFD
+#define MAP_CONTROL_COMMIT      0x00
+#define MAP_CONTROL_REVERT      0x01
+#define MAP_CONTROL_BLOB        0x10
+#define MSG_FUEL_MAP_COMMIT         MSG_FUEL_MAP_CELL(MAP_CONTROL_ROW, MAP_CONTROL_COMMIT)
+#define MSG_FUEL_MAP_REVERT         MSG_FUEL_MAP_CELL(MAP_CONTROL_ROW, MAP_CONTROL_REVERT)
+#define MSG_FUEL_MAP_BLOB           MSG_FUEL_MAP_CELL(MAP_CONTROL_ROW, MAP_CONTROL_BLOB)
+#define MSG_IGNITION_MAP_COMMIT     MSG_IGNITION_MAP_CELL(MAP_CONTROL_ROW, MAP_CONTROL_COMMIT)
+#define MSG_IGNITION_MAP_REVERT     MSG_IGNITION_MAP_CELL(MAP_CONTROL_ROW, MAP_CONTROL_REVERT)
+#define MSG_IGNITION_MAP_BLOB       MSG_IGNITION_MAP_CELL(MAP_CONTROL_ROW, MAP_CONTROL_BLOB)
+#define MSG_BOOST_MAP_COMMIT        MSG_BOOST_MAP_CELL(MAP_CONTROL_ROW, MAP_CONTROL_COMMIT)
+#define MSG_BOOST_MAP_REVERT        MSG_BOOST_MAP_CELL(MAP_CONTROL_ROW, MAP_CONTROL_REVERT)
+#define MSG_BOOST_MAP_BLOB          MSG_BOOST_MAP_CELL(MAP_CONTROL_ROW, MAP_CONTROL_BLOB)
+
+// Parameter ID blocks a map answers on (masks over the low 16 bits): cells
+// in rows and columns 0x00-0x1F, X and Y bins 0x00-0x1F, commit and revert
+#define MAP_CELL_BLOCK_MASK         0xE0E0
+#define MAP_AXIS_BLOCK_MASK         0xFEE0
+#define MAP_CONTROL_BLOCK_MASK      0xFFFE
+
 // =============================================================================
 // CONFIGURATION PARAMETERS
 // =============================================================================
@@ -246,6 +361,7 @@
 #define MSG_STORAGE_EXPORT_START    MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_STORAGE, 0x21)
 #define MSG_STORAGE_EXPORT_KEY      MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_STORAGE, 0x22)
 #define MSG_STORAGE_EXPORT_COMPLETE MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_STORAGE, 0x23)
+#define MSG_STORAGE_EXPORT_CREDIT   MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_STORAGE, 0x24)
 
 // =============================================================================
 // STORAGE MESSAGE STRUCTURES
@@ -293,20 +409,22 @@ typedef struct {
     uint16_t free_space_kb;     // Free storage space (KB)
 } storage_stats_msg_t;
 
-// Storage export request message
+// Storage export request message (see storage_manager.h for the protocol)
 typedef struct {
     uint8_t export_type;        // 0=all, 1=fuel_map, 2=ignition_map, 3=settings
     uint8_t ecu_filter;         // ECU base filter (0=all, 1=primary, etc.)
     uint8_t subsystem_filter;   // Subsystem filter (0=all, 1=fuel, 2=ignition, etc.)
-    uint8_t reserved[5];        // Padding to 8 bytes
-} storage_export_request_msg_t;
+    uint8_t window;             // Initial credits: key frames the host can take
+    uint32_t resume_after_key;  // Export keys above this one (0=from the start)
+} __attribute__((packed)) storage_export_request_msg_t;
 
 // Storage export start message
 typedef struct {
-    uint16_t total_keys;        // Total number of keys to export
+    uint16_t total_keys;        // Keys left to export from the resume point
     uint8_t success;            // 1=ready, 0=error
-    uint8_t reserved[5];        // Padding to 8 bytes
-} storage_export_start_msg_t;
+    uint8_t reserved;
+    uint32_t resume_after_key;  // Echo of the request
+} __attribute__((packed)) storage_export_start_msg_t;
 
 // Storage export key-value message
 typedef struct {
@@ -314,12 +432,20 @@ typedef struct {
     float value;                // Value
 } storage_export_key_msg_t;
 
+// Storage export credit message (host to ECU)
+typedef struct {
+    uint16_t credits;           // Further key frames the host can take
+    uint8_t abort;              // 1=stop the export now
+    uint8_t reserved[5];        // Padding to 8 bytes
+} __attribute__((packed)) storage_export_credit_msg_t;
+
 // Storage export complete message
 typedef struct {
     uint16_t keys_sent;         // Actual number of keys sent
-    uint8_t success;            // 1=complete, 0=error
-    uint8_t reserved[5];        // Padding to 8 bytes
-} storage_export_complete_msg_t;
+    uint8_t success;            // 1=complete, 0=aborted or timed out
+    uint8_t reserved;
+    uint32_t last_key;          // Last key sent: resume_after_key to carry on
+} __attribute__((packed)) storage_export_complete_msg_t;
 
 // =============================================================================
 // PARAMETER MESSAGE STRUCTURES (FOR DIRECT CAN ID ACCESS)
@@ -333,6 +459,17 @@ typedef struct {
 #define PARAM_OP_WRITE_ACK          0x04    // ECU→External: Write acknowledgment
 #define PARAM_OP_ERROR              0x05    // ECU→External: Operation error
 
+// Batched operations. Control frames go on MSG_PARAM_BATCH; LIST_ADD and
+// WRITE_STAGE go on the parameter's own ID like a single read or write.
+#define PARAM_OP_BATCH_READ_RANGE   0x06    // External→ECU: read count IDs from param_id up
+#define PARAM_OP_BATCH_LIST_ADD     0x07    // External→ECU: add this ID to the channel's read list
+#define PARAM_OP_BATCH_READ_LIST    0x08    // External→ECU: read every listed ID, then clear the list
+#define PARAM_OP_BATCH_WRITE_STAGE  0x09    // External→ECU: stage value for the next commit
+#define PARAM_OP_BATCH_WRITE_COMMIT 0x0A    // External→ECU: apply all staged writes, or none
+#define PARAM_OP_BATCH_ABORT        0x0B    // External→ECU: drop the list, staged writes and any stream
+#define PARAM_OP_BATCH_COMPLETE     0x0C    // ECU→External: batch finished (parameter_batch_msg_t)
+#define PARAM_OP_BATCH_SNAPSHOT     0x0D    // External→ECU: read every registered parameter
+
 // Parameter operation message (for direct CAN ID access)
 typedef struct {
     uint8_t operation;          // Operation type (see PARAM_OP_* flags)
@@ -342,6 +479,71 @@ typedef struct {
     uint8_t reserved[1];        // Future use (1 byte)
 } __attribute__((packed)) parameter_msg_t;
 
+// Batch control frame. Same size and routing bytes as parameter_msg_t, so
+// the external channels tag and track it like any parameter request - one
+// tracked request per batch. Read responses stream back as READ_RESPONSE on
+// each parameter's own ID, then one BATCH_COMPLETE on MSG_PARAM_BATCH.
+typedef struct {
+    uint8_t operation;          // PARAM_OP_BATCH_*
+    uint32_t param_id;          // READ_RANGE: first ID; COMPLETE: entries read or written (0 otherwise)
+    uint8_t source_channel;     // Routing, as in parameter_msg_t
+    uint8_t request_id;
+    uint8_t count;              // READ_RANGE: IDs to read; COMPLETE: failures (saturating)
+} __attribute__((packed)) parameter_batch_msg_t;
+
+// CAN FD packed parameter frame: up to CAN_FD_PACK_MAX_ENTRIES values of one
+// operation in a single 64-byte frame, for FD peers. Each entry stands for a
+// parameter_msg_t sent on its own msg_id.
+#define CAN_FD_PACK_VERSION         1
+#define CAN_FD_PACK_MAX_ENTRIES     7
+
+typedef struct {
+    uint32_t msg_id;            // Parameter message ID
+    float value;
+} __attribute__((packed)) can_fd_packed_entry_t;
+
+typedef struct {
+    uint8_t version;            // CAN_FD_PACK_VERSION
+    uint8_t count;              // Entries in use
+    uint8_t operation;          // PARAM_OP_* shared by all entries
+    uint8_t reserved[5];
+    can_fd_packed_entry_t entries[CAN_FD_PACK_MAX_ENTRIES];
+} __attribute__((packed)) can_fd_packed_msg_t;
+
+// Serial link hello/ack
+typedef struct {
+    uint8_t version;            // SERIAL_LINK_VERSION_* requested or agreed
+    uint16_t mtu;               // Largest frame before encoding
+    uint8_t reserved[5];
+} __attribute__((packed)) serial_link_msg_t;
+
+// Serial telemetry channel table and stream control
+#define TELEMETRY_OP_CLEAR          0x00    // Stop and empty the table
+#define TELEMETRY_OP_ADD            0x01    // index <- msg_id, step 10^step_exp
+#define TELEMETRY_OP_START          0x02    // msg_id = tick rate (Hz), index = ticks per keyframe
+#define TELEMETRY_OP_STOP           0x03
+#define TELEMETRY_OP_KEYFRAME       0x04    // Next tick is a keyframe (host lost a frame)
+
+#define TELEMETRY_STATUS_OK         0x00
+#define TELEMETRY_STATUS_BAD_INDEX  0x01
+#define TELEMETRY_STATUS_INVALID    0x02
+#define TELEMETRY_STATUS_NOT_FRAMED 0x03    // Needs link protocol v2
+
+typedef struct {
+    uint8_t op;                 // TELEMETRY_OP_*
+    uint8_t index;              // Channel index (ADD) or keyframe interval (START)
+    uint32_t msg_id;            // Channel message ID (ADD) or tick rate in Hz (START)
+    int8_t step_exp;            // Quantisation step = 10^step_exp (ADD)
+    uint8_t reserved;
+} __attribute__((packed)) serial_telemetry_config_msg_t;
+
+typedef struct {
+    uint8_t op;                 // Echo of the request
+    uint8_t index;
+    uint8_t status;             // TELEMETRY_STATUS_*
+    uint8_t reserved[5];
+} __attribute__((packed)) serial_telemetry_ack_msg_t;
+
 // =============================================================================
 // CHANNEL IDENTIFIERS FOR REQUEST-RESPONSE ROUTING
 // =============================================================================
@@ -476,29 +678,11 @@ inline void create_extended_can_message(CANMessage* msg, uint32_t extended_id,
     if (data && length > 0) {
         memcpy(msg->buf, data, length);
     }
-    #ifdef ARDUINO
-    // FlexCAN timestamp is 16-bit, so we need to truncate micros() to 16 bits
-    msg->timestamp = (uint16_t)(micros() & 0xFFFF);
-    msg->flags.extended = 1;
-    msg->flags.remote = 0;
-    
-    // Debug output for timestamp (disabled to reduce serial clutter)
-    /*
-    static uint32_t last_timestamp_debug = 0;
-    uint32_t now = millis();
-    if (now - last_timestamp_debug >= 5000) {
-        Serial.print("DEBUG: create_extended_can_message - timestamp set to: ");
-        Serial.print(msg->timestamp);
-        Serial.print(" (micros truncated to 16-bit)");
-        Serial.println();
-        last_timestamp_debug = now;
-    }
-    */
-    #else
-    msg->timestamp = 0;
+    // FlexCAN timestamp is 16-bit: it keeps the low bits of the full stamp
+    msg->timestamp_us = ecu_time_us();
+    msg->timestamp = (uint16_t)msg->timestamp_us;
     msg->flags.extended = 1;
     msg->flags.remote = 0;
-    #endif
 }
 
 // Backwards compatibility - all messages are extended now
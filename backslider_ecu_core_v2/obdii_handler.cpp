@@ -2,6 +2,11 @@
 // Implementation of OBD-II protocol handler
 
 #include "obdii_handler.h"
+#include "ecu_time.h"
+
+// Mode 09 defaults until set_vin() / set_ecu_name()
+#define OBDII_DEFAULT_VIN       "00000000000000000"
+#define OBDII_DEFAULT_ECU_NAME  "ECM-BacksliderECU"
 
 // ============================================================================
 // CONSTRUCTOR AND INITIALIZATION
@@ -14,7 +19,8 @@ OBDIIHandler::OBDIIHandler(ExternalCanBusCache* cache) :
     supported_modes(DEFAULT_SUPPORTED_MODES),
     supported_pids_01_20(DEFAULT_SUPPORTED_PIDS_01_20),
     supported_pids_21_40(DEFAULT_SUPPORTED_PIDS_21_40),
-    supported_pids_41_60(DEFAULT_SUPPORTED_PIDS_41_60)
+    supported_pids_41_60(DEFAULT_SUPPORTED_PIDS_41_60),
+    tx_scheduler(nullptr)
 {
     // Initialize statistics
     reset_statistics();
@@ -26,6 +32,9 @@ OBDIIHandler::OBDIIHandler(ExternalCanBusCache* cache) :
     
     // Initialize last request
     memset(&last_request, 0, sizeof(last_request));
+    
+    set_vin(OBDII_DEFAULT_VIN);
+    set_ecu_name(OBDII_DEFAULT_ECU_NAME);
 }
 
 OBDIIHandler::~OBDIIHandler() {
@@ -62,10 +71,22 @@ void OBDIIHandler::shutdown() {
         custom_pid_handlers[i] = nullptr;
     }
     
+    isotp.abort();
     initialized = false;
     debug_print("OBDIIHandler: Shutdown complete");
 }
 
+void OBDIIHandler::set_tx_scheduler(CanTxScheduler* scheduler) {
+    tx_scheduler = scheduler;
+    isotp.init(scheduler, OBDII_ECU_RESPONSE_ID, CAN_TX_PRIORITY_HIGH);
+}
+
+void OBDIIHandler::update(uint32_t now_us) {
+    if (initialized) {
+        isotp.update(now_us);
+    }
+}
+
 // ============================================================================
 // REQUEST PROCESSING
 // ============================================================================
@@ -79,6 +100,11 @@ bool OBDIIHandler::process_request(const CAN_message_t& msg) {
         return false;
     }
     
+    // Flow control for a segmented response in progress
+    if ((msg.buf[0] & 0xF0) == ISOTP_PCI_FLOW_CONTROL) {
+        return isotp.on_flow_control(msg, ecu_time_us());
+    }
+    
     stats.requests_received++;
     last_request_time = millis();
     
@@ -101,19 +127,17 @@ bool OBDIIHandler::process_request(const CAN_message_t& msg) {
         return false;
     }
     
-    // Generate and send response
+    // Generate and send response; a functional Mode 01 request with no PID
+    // answered is handled by staying silent
     CAN_message_t response_msg;
     if (generate_response(request, response_msg)) {
         stats.responses_sent++;
-        return true;
-    } else {
-        stats.negative_responses++;
-        return false;
     }
+    return true;
 }
 
 bool OBDIIHandler::is_obdii_request(const CAN_message_t& msg) {
-    return (msg.id == OBDII_REQUEST_ID && msg.len >= 2);
+    return ((msg.id == OBDII_REQUEST_ID || msg.id == OBDII_PHYSICAL_REQUEST_ID) && msg.len >= 2);
 }
 
 bool OBDIIHandler::parse_request_message(const CAN_message_t& msg, obdii_request_t& request) {
@@ -121,9 +145,10 @@ bool OBDIIHandler::parse_request_message(const CAN_message_t& msg, obdii_request
         return false;
     }
     
-    // OBD-II request format: [length] [mode] [pid] [additional_data...]
+    // OBD-II request format: [length] [mode] [pid] [additional_data...],
+    // always an ISO-TP single frame
     uint8_t length = msg.buf[0];
-    if (length < 1 || length > 7) {
+    if (length < 1 || length > 7 || length >= msg.len) {
         return false;
     }
     
@@ -150,8 +175,8 @@ bool OBDIIHandler::validate_request(const obdii_request_t& request) {
     // Mode-specific validation
     switch (request.mode) {
         case OBDII_MODE_CURRENT_DATA:
-            // Mode 01 should have a PID
-            return true;  // PID validation happens in handler
+            // Mode 01: one to six PIDs, validated by the handler
+            return request.data_len < OBDII_MAX_PIDS_PER_REQUEST;
             
         case OBDII_MODE_DIAGNOSTIC_CODES:
         case OBDII_MODE_CLEAR_CODES:
@@ -159,8 +184,8 @@ bool OBDIIHandler::validate_request(const obdii_request_t& request) {
             return true;
             
         case OBDII_MODE_VEHICLE_INFO:
-            // Mode 09 should have a PID
-            return true;
+            // Mode 09 takes exactly one PID
+            return request.data_len == 0;
             
         default:
             return false;
@@ -172,78 +197,143 @@ bool OBDIIHandler::validate_request(const obdii_request_t& request) {
 // ============================================================================
 
 bool OBDIIHandler::generate_response(const obdii_request_t& request, CAN_message_t& response_msg) {
-    obdii_response_t response = {};
-    response.mode = request.mode + OBDII_POSITIVE_RESPONSE;
-    response.pid = request.pid;
-    response.is_valid = false;
+    if (request.mode != OBDII_MODE_CURRENT_DATA &&
+        request.mode != OBDII_MODE_DIAGNOSTIC_CODES &&
+        request.mode != OBDII_MODE_CLEAR_CODES &&
+        request.mode != OBDII_MODE_VEHICLE_INFO) {
+        return send_negative_response(request, OBDII_NRC_SERVICE_NOT_SUPPORTED, response_msg);
+    }
+    
+    uint8_t payload[OBDII_MAX_RESPONSE_BYTES];
+    uint8_t length = build_response_payload(request, payload);
+    if (length > 0) {
+        return transmit_payload(payload, length, response_msg);
+    }
+    
+    // Functional Mode 01 requests are answered only by ECUs that support
+    // one of the PIDs; anything else gets a negative response
+    if (request.mode == OBDII_MODE_CURRENT_DATA && request.source_id == OBDII_REQUEST_ID) {
+        return false;
+    }
+    return send_negative_response(request, OBDII_NRC_SUBFUNC_NOT_SUPPORTED, response_msg);
+}
+
+uint8_t OBDIIHandler::build_response_payload(const obdii_request_t& request, uint8_t* payload) {
+    uint8_t length = 0;
+    payload[length++] = request.mode + OBDII_POSITIVE_RESPONSE;
     
-    // Route to appropriate handler based on mode
     switch (request.mode) {
-        case OBDII_MODE_CURRENT_DATA:
+        case OBDII_MODE_CURRENT_DATA: {
             stats.mode01_requests++;
-            response.is_valid = handle_mode01_request(request, response);
-            break;
-            
-        case OBDII_MODE_DIAGNOSTIC_CODES:
-            response.is_valid = handle_mode03_request(request, response);
-            break;
+            if (request.data_len > 0) {
+                stats.multi_pid_requests++;
+            }
             
+            // [41] then [pid][data] for each PID answered, in request order
+            uint8_t pid_count = request.data_len + 1;
+            for (uint8_t i = 0; i < pid_count; i++) {
+                uint8_t pid = (i == 0) ? request.pid : request.data[i - 1];
+                obdii_response_t response = {};
+                response.mode = payload[0];
+                response.pid = pid;
+                if (!handle_mode01_pid(pid, response) || response.data_len > sizeof(response.data)) {
+                    continue;
+                }
+                payload[length++] = pid;
+                memcpy(&payload[length], response.data, response.data_len);
+                length += response.data_len;
+            }
+            return (length > 1) ? length : 0;
+        }
+        
+        case OBDII_MODE_DIAGNOSTIC_CODES: {
+            obdii_response_t response = {};
+            if (!handle_mode03_request(request, response)) {
+                return 0;
+            }
+            memcpy(&payload[length], response.data, response.data_len);
+            return length + response.data_len;
+        }
+        
+        case OBDII_MODE_CLEAR_CODES:
+            // Nothing stored, so nothing to clear
+            return length;
+        
         case OBDII_MODE_VEHICLE_INFO:
-            response.is_valid = handle_mode09_request(request, response);
-            break;
-            
+            switch (request.pid) {
+                case OBDII_PID_09_SUPPORTED: {
+                    obdii_response_t response = {};
+                    handle_mode09_request(request, response);
+                    payload[length++] = request.pid;
+                    memcpy(&payload[length], response.data, response.data_len);
+                    return length + response.data_len;
+                }
+                case OBDII_PID_09_VIN:
+                    return build_mode09_text(request.pid, vin, OBDII_VIN_LENGTH, payload);
+                case OBDII_PID_09_ECU_NAME:
+                    return build_mode09_text(request.pid, ecu_name, OBDII_ECU_NAME_LENGTH, payload);
+                default:
+                    stats.unsupported_requests++;
+                    return 0;
+            }
+        
         default:
-            // Unsupported mode
-            return send_negative_response(request, OBDII_NRC_SERVICE_NOT_SUPPORTED, response_msg);
+            return 0;
+    }
+}
+
+uint8_t OBDIIHandler::build_mode09_text(uint8_t pid, const char* text, uint8_t text_len, uint8_t* payload) {
+    uint8_t length = 0;
+    payload[length++] = OBDII_MODE_VEHICLE_INFO + OBDII_POSITIVE_RESPONSE;
+    payload[length++] = pid;
+    payload[length++] = 0x01;  // Number of data items
+    memcpy(&payload[length], text, text_len);
+    return length + text_len;
+}
+
+bool OBDIIHandler::transmit_payload(const uint8_t* payload, uint8_t length, CAN_message_t& first_frame) {
+    if (length > ISOTP_SINGLE_FRAME_MAX) {
+        stats.segmented_responses++;
     }
     
-    // Convert response to CAN message
-    if (response.is_valid) {
-        return response_to_can_message(response, response_msg);
-    } else {
-        return send_negative_response(request, OBDII_NRC_SUBFUNC_NOT_SUPPORTED, response_msg);
+    // Without a scheduler the frame is only built (isotp has none either)
+    if (!isotp.send(payload, length, ecu_time_us(), &first_frame)) {
+        debug_print("OBDIIHandler: Response not queued");
+        return false;
     }
+    return true;
 }
 
 bool OBDIIHandler::send_negative_response(const obdii_request_t& request, uint8_t nrc, CAN_message_t& response_msg) {
-    response_msg.id = OBDII_ECU_RESPONSE_ID;
-    response_msg.len = 3;
-    response_msg.buf[0] = 0x03;  // Length
-    response_msg.buf[1] = OBDII_NEGATIVE_RESPONSE;
-    response_msg.buf[2] = request.mode;
-    response_msg.buf[3] = nrc;
-    
-    #ifdef ARDUINO
-    response_msg.timestamp = micros();
-    #endif
+    uint8_t payload[3] = {OBDII_NEGATIVE_RESPONSE, request.mode, nrc};
     
     stats.negative_responses++;
     debug_print("OBDIIHandler: Sent negative response");
     
-    return true;
+    return isotp.send(payload, sizeof(payload), ecu_time_us(), &response_msg);
 }
 
 // ============================================================================
 // MODE 01 (CURRENT DATA) HANDLERS
 // ============================================================================
 
-bool OBDIIHandler::handle_mode01_request(const obdii_request_t& request, obdii_response_t& response) {
+bool OBDIIHandler::handle_mode01_pid(uint8_t pid, obdii_response_t& response) {
     // Check for supported PIDs request
-    if (request.pid == OBDII_PID_SUPPORTED_01_20 || 
-        request.pid == OBDII_PID_SUPPORTED_21_40 || 
-        request.pid == OBDII_PID_SUPPORTED_41_60) {
+    if (pid == OBDII_PID_SUPPORTED_01_20 || 
+        pid == OBDII_PID_SUPPORTED_21_40 || 
+        pid == OBDII_PID_SUPPORTED_41_60) {
         stats.supported_pid_requests++;
-        return generate_supported_pids_response(request.pid, response);
+        return generate_supported_pids_response(pid, response);
     }
     
-    // Check if PID is supported
-    if (!is_pid_supported(request.pid)) {
+    // Check if PID is supported (custom PIDs register themselves)
+    if (!is_pid_supported(pid) && custom_pid_handlers[pid] == nullptr) {
         stats.unsupported_requests++;
         return false;
     }
     
     // Route to specific PID handler
-    switch (request.pid) {
+    switch (pid) {
         case OBDII_PID_ENGINE_RPM:
             return handle_pid_engine_rpm(response);
             
@@ -267,8 +357,8 @@ bool OBDIIHandler::handle_mode01_request(const obdii_request_t& request, obdii_r
             
         default:
             // Check for custom PID handler
-            if (custom_pid_handlers[request.pid] != nullptr) {
-                return custom_pid_handlers[request.pid](request.pid, response.data, &response.data_len);
+            if (custom_pid_handlers[pid] != nullptr) {
+                return custom_pid_handlers[pid](pid, response.data, &response.data_len);
             }
             
             stats.unsupported_requests++;
@@ -279,13 +369,20 @@ bool OBDIIHandler::handle_mode01_request(const obdii_request_t& request, obdii_r
 bool OBDIIHandler::generate_supported_pids_response(uint8_t pid_range, obdii_response_t& response) {
     uint32_t supported_pids = 0;
     
+    // The last bit of a range says whether the next range has any PIDs
     switch (pid_range) {
         case OBDII_PID_SUPPORTED_01_20:
             supported_pids = supported_pids_01_20;
+            if (supported_pids_21_40 != 0 || supported_pids_41_60 != 0) {
+                supported_pids |= 1;
+            }
             break;
             
         case OBDII_PID_SUPPORTED_21_40:
             supported_pids = supported_pids_21_40;
+            if (supported_pids_41_60 != 0) {
+                supported_pids |= 1;
+            }
             break;
             
         case OBDII_PID_SUPPORTED_41_60:
@@ -429,17 +526,17 @@ bool OBDIIHandler::handle_mode03_request(const obdii_request_t& request, obdii_r
 }
 
 bool OBDIIHandler::handle_mode09_request(const obdii_request_t& request, obdii_response_t& response) {
-    // Mode 09: Vehicle information
-    switch (request.pid) {
-        case 0x02:  // VIN
-            // Return placeholder VIN
-            memcpy(response.data, "ECU1", 4);
-            response.data_len = 4;
-            return true;
-            
-        default:
-            return false;
+    // Mode 09: Vehicle information. Only the supported-PIDs bitmap fits in
+    // an obdii_response_t; VIN and ECU name are built by build_mode09_text()
+    if (request.pid != OBDII_PID_09_SUPPORTED) {
+        return false;
     }
+    response.data[0] = (OBDII_MODE09_SUPPORTED_PIDS >> 24) & 0xFF;
+    response.data[1] = (OBDII_MODE09_SUPPORTED_PIDS >> 16) & 0xFF;
+    response.data[2] = (OBDII_MODE09_SUPPORTED_PIDS >> 8) & 0xFF;
+    response.data[3] = OBDII_MODE09_SUPPORTED_PIDS & 0xFF;
+    response.data_len = 4;
+    return true;
 }
 
 // ============================================================================
@@ -465,8 +562,16 @@ void OBDIIHandler::unregister_custom_pid(uint8_t pid) {
     custom_pid_handlers[pid] = nullptr;
 }
 
+// PID n of a range is bit 32 - n: 0x01 is bit 31, 0x20 bit 0
+static uint32_t pid_support_bit(uint8_t pid) {
+    return 1UL << (31 - ((pid - 1) & 0x1F));
+}
+
 void OBDIIHandler::enable_standard_pid(uint8_t pid, bool enable) {
-    uint32_t pid_bit = 1UL << (31 - (pid & 0x1F));
+    if (pid == 0) {
+        return;     // Always supported
+    }
+    uint32_t pid_bit = pid_support_bit(pid);
     
     if (pid <= 0x20) {
         if (enable) {
@@ -490,7 +595,10 @@ void OBDIIHandler::enable_standard_pid(uint8_t pid, bool enable) {
 }
 
 bool OBDIIHandler::is_pid_supported(uint8_t pid) {
-    uint32_t pid_bit = 1UL << (31 - (pid & 0x1F));
+    if (pid == 0) {
+        return true;
+    }
+    uint32_t pid_bit = pid_support_bit(pid);
     
     if (pid <= 0x20) {
         return (supported_pids_01_20 & pid_bit) != 0;
@@ -503,6 +611,22 @@ bool OBDIIHandler::is_pid_supported(uint8_t pid) {
     return false;
 }
 
+void OBDIIHandler::set_vin(const char* text) {
+    memset(vin, ' ', sizeof(vin));
+    if (text != nullptr) {
+        size_t len = strlen(text);
+        memcpy(vin, text, (len < sizeof(vin)) ? len : sizeof(vin));
+    }
+}
+
+void OBDIIHandler::set_ecu_name(const char* text) {
+    memset(ecu_name, 0, sizeof(ecu_name));
+    if (text != nullptr) {
+        size_t len = strlen(text);
+        memcpy(ecu_name, text, (len < sizeof(ecu_name)) ? len : sizeof(ecu_name));
+    }
+}
+
 void OBDIIHandler::enable_mode(uint8_t mode, bool enable) {
     uint32_t mode_bit = 1UL << mode;
     
@@ -522,30 +646,6 @@ bool OBDIIHandler::is_mode_supported(uint8_t mode) {
 // UTILITY FUNCTIONS
 // ============================================================================
 
-bool OBDIIHandler::response_to_can_message(const obdii_response_t& response, CAN_message_t& msg) {
-    msg.id = OBDII_ECU_RESPONSE_ID;
-    msg.len = response.data_len + 2;  // +2 for length and mode
-    
-    if (msg.len > 8) {
-        debug_print("OBDIIHandler: Response too long for CAN message");
-        return false;
-    }
-    
-    msg.buf[0] = msg.len - 1;  // Length (excluding length byte itself)
-    msg.buf[1] = response.mode;
-    
-    if (response.data_len > 0) {
-        msg.buf[2] = response.pid;
-        memcpy(&msg.buf[3], response.data, response.data_len);
-    }
-    
-    #ifdef ARDUINO
-    msg.timestamp = micros();
-    #endif
-    
-    return true;
-}
-
 uint16_t OBDIIHandler::float_to_obdii_rpm(float rpm) {
     // OBD-II RPM: ((A*256)+B)/4
     // So RPM * 4 = (A*256)+B
@@ -1,12 +1,22 @@
 // obdii_handler.h
 // OBD-II protocol handler for external CAN bus
 // Supports standard OBD-II modes and PIDs with cache integration
+//
+// Mode 01 requests may carry up to OBDII_MAX_PIDS_PER_REQUEST PIDs; the
+// response lists every PID answered, in request order, and a functional
+// request with none answered gets no response (ISO 15765-4). Values come
+// straight from ExternalCanBusCache, so a PID with no fresh value is left out
+// rather than waited for. Responses longer than one frame (multi-PID, Mode 09
+// VIN and ECU name) are segmented by an IsoTpSender; the tester's flow
+// control arrives on the physical request ID.
 
 #ifndef OBDII_HANDLER_H
 #define OBDII_HANDLER_H
 
 #include "msg_definitions.h"
 #include "external_canbus_cache.h"
+#include "can_tx_scheduler.h"
+#include "isotp.h"
 
 #ifdef ARDUINO
     #include <Arduino.h>
@@ -16,12 +26,17 @@
 
 // OBD-II Constants
 #define OBDII_REQUEST_ID            0x7DF    // Standard OBD-II request ID
+#define OBDII_PHYSICAL_REQUEST_ID   0x7E0    // Requests and flow control addressed to us
 #define OBDII_RESPONSE_ID_BASE      0x7E8    // Response ID base (7E8-7EF)
 #define OBDII_ECU_RESPONSE_ID       0x7E8    // Our ECU response ID
 
 #define OBDII_MAX_DATA_BYTES        7        // Maximum data bytes in OBD-II message
 #define OBDII_POSITIVE_RESPONSE     0x40     // Positive response offset
 #define OBDII_NEGATIVE_RESPONSE     0x7F     // Negative response service ID
+#define OBDII_MAX_PIDS_PER_REQUEST  6        // Mode 01 PIDs in one request
+#define OBDII_MAX_RESPONSE_BYTES    ISOTP_MAX_PAYLOAD
+#define OBDII_VIN_LENGTH            17
+#define OBDII_ECU_NAME_LENGTH       20
 
 // OBD-II Service/Mode definitions
 #define OBDII_MODE_CURRENT_DATA     0x01     // Show current data
@@ -72,6 +87,8 @@ struct obdii_stats_t {
     uint32_t cache_misses;         // Requests where cache had no data
     uint32_t negative_responses;   // Negative responses sent
     uint32_t malformed_requests;   // Malformed request messages
+    uint32_t multi_pid_requests;   // Mode 01 requests with more than one PID
+    uint32_t segmented_responses;  // Sent through ISO-TP first/consecutive frames
 };
 
 // Custom PID handler function type
@@ -93,6 +110,13 @@ public:
     // Shutdown handler
     void shutdown();
     
+    // Responses are sent through the scheduler; without one they are only
+    // built (generate_response())
+    void set_tx_scheduler(CanTxScheduler* scheduler);
+    
+    // Continue segmented responses - call from the main loop
+    void update(uint32_t now_us);
+    
     // =========================================================================
     // REQUEST PROCESSING
     // =========================================================================
@@ -127,6 +151,10 @@ public:
     void enable_standard_pid(uint8_t pid, bool enable);
     bool is_pid_supported(uint8_t pid);
     
+    // Mode 09 identification (padded / truncated to the OBD-II lengths)
+    void set_vin(const char* vin);
+    void set_ecu_name(const char* name);
+    
     // =========================================================================
     // MODE SUPPORT
     // =========================================================================
@@ -146,6 +174,7 @@ public:
     // Status
     bool is_initialized() const { return initialized; }
     uint32_t get_last_request_time() const { return last_request_time; }
+    const isotp_stats_t& get_isotp_statistics() const { return isotp.get_statistics(); }
     
     // =========================================================================
     // TESTING INTERFACE
@@ -184,6 +213,14 @@ private:
     // Custom PID handlers
     custom_pid_handler_t custom_pid_handlers[256];
     
+    // Mode 09 identification
+    char vin[OBDII_VIN_LENGTH];
+    char ecu_name[OBDII_ECU_NAME_LENGTH];
+    
+    // Response transport
+    CanTxScheduler* tx_scheduler;
+    IsoTpSender isotp;
+    
     // =========================================================================
     // PRIVATE METHODS - REQUEST PARSING
     // =========================================================================
@@ -198,8 +235,8 @@ private:
     // PRIVATE METHODS - RESPONSE GENERATION
     // =========================================================================
     
-    // Handle Mode 01 (current data) requests
-    bool handle_mode01_request(const obdii_request_t& request, obdii_response_t& response);
+    // One Mode 01 (current data) PID into response (false: not answered)
+    bool handle_mode01_pid(uint8_t pid, obdii_response_t& response);
     
     // Handle Mode 03 (diagnostic codes) requests
     bool handle_mode03_request(const obdii_request_t& request, obdii_response_t& response);
@@ -210,6 +247,15 @@ private:
     // Generate supported PIDs response
     bool generate_supported_pids_response(uint8_t pid_range, obdii_response_t& response);
     
+    // Positive response payload [mode+0x40][...] for the request; 0 if none
+    uint8_t build_response_payload(const obdii_request_t& request, uint8_t* payload);
+    
+    // Mode 09 identification payload [49][pid][items][text]
+    uint8_t build_mode09_text(uint8_t pid, const char* text, uint8_t text_len, uint8_t* payload);
+    
+    // Send a payload as a single frame or ISO-TP transfer
+    bool transmit_payload(const uint8_t* payload, uint8_t length, CAN_message_t& first_frame);
+    
     // =========================================================================
     // PRIVATE METHODS - STANDARD PID HANDLERS
     // =========================================================================
@@ -227,12 +273,6 @@ private:
     // PRIVATE METHODS - UTILITY
     // =========================================================================
     
-    // Convert response structure to CAN message
-    bool response_to_can_message(const obdii_response_t& response, CAN_message_t& msg);
-    
-    // Pack response data into CAN message
-    void pack_response_data(const obdii_response_t& response, CAN_message_t& msg);
-    
     // Data conversion utilities
     uint16_t float_to_obdii_rpm(float rpm);
     uint8_t float_to_obdii_speed(float speed_mph);
@@ -285,11 +325,18 @@ private:
 #define OBDII_PID_RELATIVE_THROTTLE     0x45    // Relative throttle position
 
 // Default supported PIDs bitfields
-#define DEFAULT_SUPPORTED_PIDS_01_20    0x1E100000  // PIDs 0x04, 0x05, 0x0B, 0x0C, 0x0D, 0x0F, 0x11
-#define DEFAULT_SUPPORTED_PIDS_21_40    0x80000000  // PID 0x20 (supported PIDs 21-40)
+// Bit 31 is the first PID of the range, bit 0 the last (SAE J1979)
+#define DEFAULT_SUPPORTED_PIDS_01_20    0x183A8000  // PIDs 0x04, 0x05, 0x0B, 0x0C, 0x0D, 0x0F, 0x11
+#define DEFAULT_SUPPORTED_PIDS_21_40    0x00000000  // No PIDs 0x21-0x40 by default
 #define DEFAULT_SUPPORTED_PIDS_41_60    0x00000000  // No additional PIDs supported by default
 
+// Mode 09 PIDs (Vehicle Information)
+#define OBDII_PID_09_SUPPORTED          0x00    // Supported PIDs 01-20
+#define OBDII_PID_09_VIN                0x02    // Vehicle identification number
+#define OBDII_PID_09_ECU_NAME           0x0A    // ECU name
+#define OBDII_MODE09_SUPPORTED_PIDS     0x40400000  // PIDs 0x02, 0x0A
+
 // Default supported modes bitfield
-#define DEFAULT_SUPPORTED_MODES         0x0000000F  // Modes 01, 03, 04, 09
+#define DEFAULT_SUPPORTED_MODES         0x0000021A  // Modes 01, 03, 04, 09 (bit n = mode n)
 
 #endif
\ No newline at end of file
@@ -4,7 +4,12 @@
 #include "output_manager.h"
 #include "msg_bus.h"
 #include "pin_assignments.h"
+#include "trace_buffer.h"
+#include "id_hash.h"
+#include "pwm_driver.h"
+#include "shift_chain.h"
 #include <Arduino.h>
+#include <math.h>
 
 // =============================================================================
 // PRIVATE DATA
@@ -15,6 +20,39 @@ static output_definition_t registered_outputs[OUTPUT_MANAGER_MAX_OUTPUTS];
 static uint8_t output_count = 0;
 static uint8_t outputs_enabled = 1;
 
+// msg_id -> registered_outputs index + 1 (linear probing, 0 = empty), filled
+// in at registration so control messages find their output in one probe
+#define OUTPUT_INDEX_TABLE_BITS 9
+#define OUTPUT_INDEX_TABLE_SIZE (1u << OUTPUT_INDEX_TABLE_BITS)
+static_assert(OUTPUT_MANAGER_MAX_OUTPUTS * 2 <= OUTPUT_INDEX_TABLE_SIZE, "Output index must stay at most half full");
+static uint16_t output_index[OUTPUT_INDEX_TABLE_SIZE];
+
+// Last raw value written to each output's hardware (PWM counts or pin
+// level). Writes that would not change it are skipped, so a PWM channel is
+// only reprogrammed when its duty actually changes
+#define OUTPUT_RAW_UNWRITTEN 0xFFFFFFFFu
+static uint32_t written_raw[OUTPUT_MANAGER_MAX_OUTPUTS];
+
+// PWM outputs: driver channel (-1 = analogWrite) and counts for 100% duty,
+// both fixed at registration
+static int8_t pwm_channels[OUTPUT_MANAGER_MAX_OUTPUTS];
+static uint32_t pwm_max_counts[OUTPUT_MANAGER_MAX_OUTPUTS];
+
+// PWM outputs handed to the ramp engine (-1 = written from the message path)
+static int8_t ramp_channels[OUTPUT_MANAGER_MAX_OUTPUTS];
+
+// SPI outputs, for checking chain readbacks, and the transfer count at the
+// last check
+static uint8_t spi_output_list[OUTPUT_MANAGER_MAX_OUTPUTS];
+static uint8_t spi_output_count = 0;
+static uint32_t spi_readback_transfers = 0;
+
+// Inside output_manager_begin_update(): chains flush at the commit
+static uint8_t update_bracket_open = 0;
+
+// Next output the integrity check reads back
+static uint16_t integrity_cursor = 0;
+
 // Statistics
 static output_manager_stats_t stats;
 
@@ -30,6 +68,9 @@ static void handle_pwm_output_message(const CANMessage* msg);
 static void handle_digital_output_message(const CANMessage* msg);
 static void handle_analog_output_message(const CANMessage* msg);
 static void configure_output_pin(output_definition_t* output);
+static void configure_pwm_channel(output_definition_t* output);
+static void configure_spi_output(output_definition_t* output);
+static void check_spi_readback(void);
 static void update_pwm_output(output_definition_t* output, float value);
 static void update_digital_output(output_definition_t* output, float value);
 static void update_analog_output(output_definition_t* output, float value);
@@ -39,6 +80,10 @@ static float clamp_value(float value, float min_val, float max_val);
 static uint8_t check_rate_limit(output_definition_t* output);
 static void record_fault(uint8_t output_index, output_fault_t fault_type, float value);
 static uint16_t find_output_by_msg_id(uint32_t msg_id);
+static uint16_t output_index_hash(uint32_t msg_id);
+static void index_output(uint16_t index);
+static void write_output_hardware(output_definition_t* output, uint32_t raw);
+static void check_output_integrity(void);
 
 // =============================================================================
 // PUBLIC FUNCTIONS
@@ -53,6 +98,14 @@ uint8_t output_manager_init(void) {
     output_count = 0;
     outputs_enabled = 1;
     fault_count = 0;
+    memset(output_index, 0, sizeof(output_index));
+    integrity_cursor = 0;
+    output_ramp_init();     // Stops the ramp timer before its channels go
+    pwm_driver_init();
+    shift_chain_init();
+    spi_output_count = 0;
+    spi_readback_transfers = 0;
+    update_bracket_open = 0;
     
     // Clear statistics
     stats.total_outputs = 0;
@@ -66,6 +119,8 @@ uint8_t output_manager_init(void) {
     stats.range_violations = 0;
     stats.fault_count = 0;
     stats.last_update_time_ms = 0;
+    stats.hardware_writes = 0;
+    stats.integrity_repairs = 0;
     
     #ifdef ARDUINO
     Serial.println("Output manager initialized");
@@ -92,11 +147,13 @@ uint8_t output_manager_register_outputs(const output_definition_t* outputs, uint
         registered_outputs[output_count].current_value = registered_outputs[output_count].config.pwm.default_duty_cycle;
         registered_outputs[output_count].last_update_time_ms = 0;
         registered_outputs[output_count].fault_detected = 0;
+        written_raw[output_count] = OUTPUT_RAW_UNWRITTEN;
+        pwm_channels[output_count] = -1;
+        ramp_channels[output_count] = -1;
         
-            // Configure the hardware pin
-    configure_output_pin(&registered_outputs[output_count]);
-    
-
+        // Configure the hardware pin
+        configure_output_pin(&registered_outputs[output_count]);
+        index_output(output_count);
         
         // Subscribe to the output's control message
         g_message_bus.subscribe(registered_outputs[output_count].msg_id, handle_pwm_output_message);
@@ -145,55 +202,10 @@ void output_manager_update(void) {
     
     stats.last_update_time_ms = millis();
     
-    // Periodic refresh of all outputs to maintain state
-    // This ensures outputs stay in the correct state even if messages are lost
-    static uint32_t last_refresh_time = 0;
-    uint32_t now = millis();
-    
-    // Refresh outputs every 100ms (10Hz) to maintain state
-    if (now - last_refresh_time >= 100) {
-        // Debug output removed to reduce serial clutter
-        for (uint8_t i = 0; i < output_count; i++) {
-            output_definition_t* output = &registered_outputs[i];
-            
-            // Skip rate limiting for periodic refresh to ensure state is maintained
-            switch (output->type) {
-                case OUTPUT_PWM: {
-                    // Re-apply current PWM value to maintain state
-                    #ifdef ARDUINO
-                    uint32_t max_value = (1 << output->config.pwm.resolution_bits) - 1;
-                    uint32_t pwm_value = (uint32_t)(output->current_value * max_value);
-                    analogWrite(output->pin, pwm_value);
-                    #endif
-                    break;
-                }
-                case OUTPUT_DIGITAL: {
-                    // Re-apply current digital state
-                    #ifdef ARDUINO
-                    bool digital_state = (output->current_value > 0.5f);
-                    if (!output->config.digital.active_high) {
-                        digital_state = !digital_state;
-                    }
-                    digitalWrite(output->pin, digital_state);
-                    #endif
-                    break;
-                }
-                case OUTPUT_ANALOG:
-                case OUTPUT_SPI:
-                case OUTPUT_VIRTUAL:
-                    // These don't need periodic refresh
-                    break;
-                case OUTPUT_TYPE_COUNT:
-                    break;
-            }
-        }
-        
-        last_refresh_time = now;
-        stats.total_updates += output_count; // Count refresh updates
-    }
-    
-    // Process any pending message bus messages
-    // (Message handling is done automatically via subscribers)
+    // Hardware is written when a value changes, not rewritten here; this
+    // slot only reads back a few outputs to catch state that drifted
+    check_output_integrity();
+    check_spi_readback();
 }
 
 void output_manager_safe_state(void) {
@@ -204,6 +216,12 @@ void output_manager_safe_state(void) {
         
         switch (output->type) {
             case OUTPUT_PWM:
+                if (ramp_channels[i] >= 0) {
+                    // No ramp into the safe state
+                    output->current_value = output->config.pwm.default_duty_cycle;
+                    output_ramp_set_now(ramp_channels[i], output->current_value);
+                    break;
+                }
                 update_pwm_output(output, output->config.pwm.default_duty_cycle);
                 break;
             case OUTPUT_DIGITAL:
@@ -235,6 +253,44 @@ void output_manager_enable(uint8_t enable) {
     // Debug output removed to reduce serial clutter
 }
 
+bool output_manager_set_ramp(uint8_t output_index, const output_ramp_config_t* config) {
+    if (output_index >= output_count || registered_outputs[output_index].type != OUTPUT_PWM ||
+        ramp_channels[output_index] >= 0) {
+        return false;
+    }
+    
+    const output_definition_t* output = &registered_outputs[output_index];
+    ramp_channels[output_index] = output_ramp_attach(pwm_channels[output_index], config,
+                                                     output->current_value,
+                                                     output->config.pwm.min_duty_cycle,
+                                                     output->config.pwm.max_duty_cycle,
+                                                     output->config.pwm.invert_output);
+    return ramp_channels[output_index] >= 0;
+}
+
+bool output_manager_play_profile(uint8_t output_index, const output_ramp_point_t* points, uint8_t count) {
+    if (output_index >= output_count || ramp_channels[output_index] < 0) {
+        return false;
+    }
+    return output_ramp_play_profile(ramp_channels[output_index], points, count);
+}
+
+int16_t output_manager_find_output_by_msg_id(uint32_t msg_id) {
+    uint16_t index = find_output_by_msg_id(msg_id);
+    return (index < output_count) ? (int16_t)index : -1;
+}
+
+void output_manager_begin_update(void) {
+    update_bracket_open = 1;
+    pwm_driver_begin_update();
+}
+
+void output_manager_commit_update(void) {
+    update_bracket_open = 0;
+    pwm_driver_commit_update();
+    shift_chain_flush();
+}
+
 float output_manager_get_value(uint8_t output_index) {
     if (output_index >= output_count) {
         return 0.0f;
@@ -281,6 +337,8 @@ void output_manager_reset_stats(void) {
     stats.rate_limited_updates = 0;
     stats.range_violations = 0;
     stats.fault_count = 0;
+    stats.hardware_writes = 0;
+    stats.integrity_repairs = 0;
 }
 
 uint8_t output_manager_get_fault_count(void) {
@@ -323,14 +381,9 @@ static void handle_pwm_output_message(const CANMessage* msg) {
     
     float value = MSG_UNPACK_FLOAT(msg);
     
-    #ifdef ARDUINO
-    // Debug for pressure solenoid messages
-    if (msg->id == 0x10500113) {  // MSG_TRANS_PRESSURE_SOL
-        Serial.print("OUTPUT MANAGER RECEIVED PRESSURE: ");
-        Serial.print(value * 100.0f);
-        Serial.println("%");
-    }
-    #endif
+    uint32_t value_bits;
+    memcpy(&value_bits, &value, sizeof(value_bits));
+    TRACE(TRACE_CAT_OUTPUT, TRACE_OUTPUT_PWM_UPDATE, output_index, msg->id, value_bits);
     
     output_definition_t* output = &registered_outputs[output_index];
     
@@ -370,19 +423,7 @@ static void configure_output_pin(output_definition_t* output) {
     switch (output->type) {
         case OUTPUT_PWM:
             pinMode(output->pin, OUTPUT);
-            analogWriteFrequency(output->pin, output->config.pwm.frequency_hz);
-            analogWriteResolution(output->config.pwm.resolution_bits);
-            
-            #ifdef ARDUINO
-            // Debug pin configuration
-            if (output->pin == 22) {
-                Serial.print("CONFIGURED PIN 22: OUTPUT, freq=");
-                Serial.print(output->config.pwm.frequency_hz);
-                Serial.print("Hz, resolution=");
-                Serial.print(output->config.pwm.resolution_bits);
-                Serial.println(" bits");
-            }
-            #endif
+            configure_pwm_channel(output);
             break;
         case OUTPUT_DIGITAL:
             pinMode(output->pin, OUTPUT);
@@ -396,8 +437,8 @@ static void configure_output_pin(output_definition_t* output) {
             }
             break;
         case OUTPUT_SPI:
-            // SPI outputs don't need individual pin configuration
-            // SPI bus will be configured when first SPI output is registered
+            // The pin is the chain's chip select; the chain owns it
+            configure_spi_output(output);
             break;
         case OUTPUT_VIRTUAL:
             // Virtual outputs have no physical pin
@@ -410,11 +451,16 @@ static void configure_output_pin(output_definition_t* output) {
     // Mock pin configuration for testing
     switch (output->type) {
         case OUTPUT_PWM:
+            pinMode(output->pin, OUTPUT);  // Call mock pinMode
+            configure_pwm_channel(output);
+            break;
         case OUTPUT_DIGITAL:
         case OUTPUT_ANALOG:
             pinMode(output->pin, OUTPUT);  // Call mock pinMode
             break;
         case OUTPUT_SPI:
+            configure_spi_output(output);
+            break;
         case OUTPUT_VIRTUAL:
             // No pin configuration needed
             break;
@@ -424,6 +470,31 @@ static void configure_output_pin(output_definition_t* output) {
     #endif
 }
 
+static void configure_pwm_channel(output_definition_t* output) {
+    uint16_t index = (uint16_t)(output - registered_outputs);
+    
+    // Timer-backed pins get register writes; others stay on analogWrite()
+    pwm_channels[index] = pwm_driver_attach(output->pin, output->config.pwm.frequency_hz);
+    if (pwm_channels[index] >= 0) {
+        pwm_max_counts[index] = pwm_driver_get_period(pwm_channels[index]);
+        return;
+    }
+    
+    analogWriteFrequency(output->pin, output->config.pwm.frequency_hz);
+    analogWriteResolution(output->config.pwm.resolution_bits);
+    pwm_max_counts[index] = (1u << output->config.pwm.resolution_bits) - 1;
+}
+
+static void configure_spi_output(output_definition_t* output) {
+    // Chains are as long as their highest output needs
+    uint8_t length = (uint8_t)((output->config.spi.bit_position >> 3) + 1);
+    if (!shift_chain_configure(output->config.spi.spi_device_id, output->pin, length,
+                               output->config.spi.spi_speed_hz)) {
+        return;
+    }
+    spi_output_list[spi_output_count++] = (uint8_t)(output - registered_outputs);
+}
+
 static void update_pwm_output(output_definition_t* output, float value) {
     // Clamp value to safe range
     float clamped_value = clamp_value(value, output->config.pwm.min_duty_cycle, output->config.pwm.max_duty_cycle);
@@ -432,6 +503,16 @@ static void update_pwm_output(output_definition_t* output, float value) {
         record_fault(output - registered_outputs, OUTPUT_FAULT_RANGE_VIOLATION, value);
     }
     
+    // Ramped outputs only take a new target; the engine moves the hardware
+    int8_t ramp = ramp_channels[output - registered_outputs];
+    if (ramp >= 0) {
+        output->current_value = clamped_value;
+        output->last_update_time_ms = millis();
+        stats.total_updates++;
+        output_ramp_set_target(ramp, clamped_value);
+        return;
+    }
+    
     // Only update if value has actually changed (with small tolerance for floating point)
     float value_change = fabs(clamped_value - output->current_value);
     
@@ -474,47 +555,15 @@ static void update_pwm_output(output_definition_t* output, float value) {
     output->last_update_time_ms = millis();
     stats.total_updates++;
     
-    #ifdef ARDUINO
-    // Debug for pressure solenoid
-    if (output->pin == 22) {
-        Serial.print("PIN 22: About to calculate PWM, clamped_value=");
-        Serial.print(clamped_value * 100.0f);
-        Serial.println("%");
-    }
-    
-    // Convert duty cycle to PWM value
-    uint32_t max_value = (1 << output->config.pwm.resolution_bits) - 1;
+    // Convert duty cycle to PWM counts
+    uint32_t max_value = pwm_max_counts[output - registered_outputs];
     uint32_t pwm_value = (uint32_t)(clamped_value * max_value);
     
     if (output->config.pwm.invert_output) {
         pwm_value = max_value - pwm_value;
     }
     
-    // Simple debug for pin 22 (pressure solenoid)
-    if (output->pin == 22) {
-        Serial.print("PIN 22 PWM: ");
-        Serial.print(pwm_value);
-        Serial.print("/");
-        Serial.print(max_value);
-        Serial.print(" (");
-        Serial.print((float)pwm_value / max_value * 100.0f);
-        Serial.println("%)");
-        Serial.print("CALLING analogWrite(");
-        Serial.print(output->pin);
-        Serial.print(", ");
-        Serial.print(pwm_value);
-        Serial.println(")");
-    }
-    
-    analogWrite(output->pin, pwm_value);
-    
-    #ifdef ARDUINO
-    // Debug after analogWrite
-    if (output->pin == 22) {
-        Serial.println("analogWrite() CALLED for pin 22");
-    }
-    #endif
-    #endif
+    write_output_hardware(output, pwm_value);
 }
 
 static void update_digital_output(output_definition_t* output, float value) {
@@ -540,18 +589,7 @@ static void update_digital_output(output_definition_t* output, float value) {
     output->last_update_time_ms = millis();
     stats.total_updates++;
     
-    #ifdef ARDUINO
-    // Simple debug for pin 22 (pressure solenoid)
-    if (output->pin == 22) {
-        Serial.print("PIN 22 SET TO: ");
-        Serial.println(digital_state ? "HIGH" : "LOW");
-    }
-    
-    digitalWrite(output->pin, digital_state);
-    #else
-    std::cout << "DEBUG: digitalWrite(" << (int)output->pin << ", " << (int)digital_state << ")" << std::endl;
-    digitalWrite(output->pin, digital_state);  // Call mock digitalWrite
-    #endif
+    write_output_hardware(output, digital_state);
 }
 
 static void update_analog_output(output_definition_t* output, float value) {
@@ -572,16 +610,14 @@ static void update_analog_output(output_definition_t* output, float value) {
     output->last_update_time_ms = millis();
     stats.total_updates++;
     
-    #ifdef ARDUINO
     if (output->config.analog.use_pwm_filter) {
         // Use PWM with external filter to approximate analog output
         uint32_t max_value = (1 << output->config.analog.resolution_bits) - 1;
         float voltage_ratio = clamped_voltage / output->config.analog.max_voltage;
         uint32_t pwm_value = (uint32_t)(voltage_ratio * max_value);
-        analogWrite(output->pin, pwm_value);
+        write_output_hardware(output, pwm_value);
     }
     // Note: True DAC output would require different handling on Teensy 4.1
-    #endif
 }
 
 static float clamp_value(float value, float min_val, float max_val) {
@@ -619,7 +655,8 @@ static void record_fault(uint8_t output_index, output_fault_t fault_type, float
     fault_records[fault_count].output_index = output_index;
     fault_records[fault_count].fault_time_ms = millis();
     fault_records[fault_count].fault_value = value;
-    fault_records[fault_count].description = "Range violation";
+    fault_records[fault_count].description =
+        (fault_type == OUTPUT_FAULT_RANGE_VIOLATION) ? "Range violation" : "Driver fault";
     
     fault_count++;
     stats.fault_count++;
@@ -646,20 +683,30 @@ static void update_spi_output(output_definition_t* output, float value) {
     output->last_update_time_ms = millis();
     stats.total_updates++;
     
-    #ifdef ARDUINO
-    // TODO: Implement SPI output control
-    // This would involve:
-    // 1. Reading current state of SPI device
-    // 2. Setting/clearing the appropriate bit
-    // 3. Writing new state back to SPI device
-    // For now, just log the intended change
-    Serial.print("SPI Output: Device ");
-    Serial.print(output->config.spi.spi_device_id);
-    Serial.print(", Bit ");
-    Serial.print(output->config.spi.bit_position);
-    Serial.print(" = ");
-    Serial.println(digital_state);
-    #endif
+    // Shadow image only; the chain goes out whole at the commit
+    shift_chain_set_bit(output->config.spi.spi_device_id, output->config.spi.bit_position, digital_state);
+    if (!update_bracket_open) {
+        shift_chain_flush();
+    }
+}
+
+static void check_spi_readback(void) {
+    // Only when a transfer has brought a new status frame
+    uint32_t transfers = shift_chain_get_transfer_count();
+    if (transfers == spi_readback_transfers) {
+        return;
+    }
+    spi_readback_transfers = transfers;
+    
+    for (uint8_t i = 0; i < spi_output_count; i++) {
+        output_definition_t* output = &registered_outputs[spi_output_list[i]];
+        if (!output->config.spi.fault_readback || output->fault_detected) {
+            continue;
+        }
+        if (shift_chain_get_readback_bit(output->config.spi.spi_device_id, output->config.spi.bit_position)) {
+            record_fault(spi_output_list[i], OUTPUT_FAULT_OVERCURRENT, output->current_value);
+        }
+    }
 }
 
 static void update_virtual_output(output_definition_t* output, float value) {
@@ -697,34 +744,78 @@ static void update_virtual_output(output_definition_t* output, float value) {
     #endif
 }
 
-static uint16_t find_output_by_msg_id(uint32_t msg_id) {
-    for (uint8_t i = 0; i < output_count; i++) {
-        if (registered_outputs[i].msg_id == msg_id) {
-            return i;
-        }
+static void write_output_hardware(output_definition_t* output, uint32_t raw) {
+    uint16_t index = (uint16_t)(output - registered_outputs);
+    if (written_raw[index] == raw) {
+        return;  // Hardware already holds this value
     }
     
-    #ifdef ARDUINO
-    // Debug for pressure solenoid
-    if (msg_id == 0x10500113) {  // MSG_TRANS_PRESSURE_SOL
-        Serial.print("PRESSURE SOLENOID NOT FOUND! Output count: ");
-        Serial.print(output_count);
-        Serial.print(", Looking for msg_id: 0x");
-        Serial.println(msg_id, HEX);
+    if (output->type == OUTPUT_DIGITAL) {
+        digitalWrite(output->pin, raw ? HIGH : LOW);
+    } else if (output->type == OUTPUT_PWM && pwm_channels[index] >= 0) {
+        pwm_driver_write(pwm_channels[index], raw);
+    } else {
+        analogWrite(output->pin, raw);
+    }
+    written_raw[index] = raw;
+    stats.hardware_writes++;
+}
+
+static void check_output_integrity(void) {
+    // Digital pins read back their output latch. PWM duty cannot be read
+    // back through analogWrite(), so PWM channels rely on write-on-change
+    uint16_t checked = 0;
+    for (uint16_t scanned = 0; scanned < output_count && checked < OUTPUT_MANAGER_INTEGRITY_CHECKS; scanned++) {
+        if (integrity_cursor >= output_count) {
+            integrity_cursor = 0;
+        }
+        output_definition_t* output = &registered_outputs[integrity_cursor];
+        uint32_t raw = written_raw[integrity_cursor];
+        integrity_cursor++;
         
-        // Show all registered outputs
-        for (uint8_t i = 0; i < output_count; i++) {
-            Serial.print("  Output ");
-            Serial.print(i);
-            Serial.print(": msg_id=0x");
-            Serial.print(registered_outputs[i].msg_id, HEX);
-            Serial.print(", pin=");
-            Serial.print(registered_outputs[i].pin);
-            Serial.print(", name=");
-            Serial.println(registered_outputs[i].name);
+        if (output->type != OUTPUT_DIGITAL || raw == OUTPUT_RAW_UNWRITTEN) {
+            continue;
+        }
+        checked++;
+        
+        if ((uint32_t)(digitalRead(output->pin) != LOW) != raw) {
+            written_raw[output - registered_outputs] = OUTPUT_RAW_UNWRITTEN;
+            write_output_hardware(output, raw);
+            stats.integrity_repairs++;
         }
     }
-    #endif
+}
+
+static uint16_t output_index_hash(uint32_t msg_id) {
+    return fib_hash(msg_id, OUTPUT_INDEX_TABLE_BITS);
+}
+
+static void index_output(uint16_t index) {
+    uint32_t msg_id = registered_outputs[index].msg_id;
+    uint16_t slot = output_index_hash(msg_id);
+    
+    // The first output registered on an ID keeps it, as with the old scan
+    while (output_index[slot] != 0) {
+        if (registered_outputs[output_index[slot] - 1].msg_id == msg_id) {
+            return;
+        }
+        slot = (slot + 1) & (OUTPUT_INDEX_TABLE_SIZE - 1);
+    }
+    output_index[slot] = index + 1;
+}
+
+static uint16_t find_output_by_msg_id(uint32_t msg_id) {
+    uint16_t slot = output_index_hash(msg_id);
+    
+    while (output_index[slot] != 0) {
+        uint16_t index = output_index[slot] - 1;
+        if (registered_outputs[index].msg_id == msg_id) {
+            return index;
+        }
+        slot = (slot + 1) & (OUTPUT_INDEX_TABLE_SIZE - 1);
+    }
+    
+    TRACE(TRACE_CAT_OUTPUT, TRACE_OUTPUT_NOT_FOUND, output_count, msg_id, 0);
     
     return OUTPUT_MANAGER_MAX_OUTPUTS; // Not found
 } 
\ No newline at end of file
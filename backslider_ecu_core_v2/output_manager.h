@@ -68,7 +68,7 @@
  *    - Diagnostic outputs
  * 
  * 5. SPI OUTPUTS:
- *    SPI outputs allow expansion beyond Teensy pins:
+ *    SPI outputs allow expansion beyond Teensy pins (see shift_chain.h):
  *    - Shift registers (74HC595, etc.)
  *    - SPI relay boards
  *    - Multiplexed output boards
@@ -76,11 +76,25 @@
  * 
  * IMPORTANT NOTES:
  * - All output control is asynchronous via messages
- * - Hardware updates occur during output_manager_update() calls
+ * - Hardware is written only when an output's value changes; rewriting an
+ *   unchanged PWM channel would restart its period and add jitter
+ * - PWM pins backed by a FlexPWM/QuadTimer channel are written through
+ *   pwm_driver (one compare register write), the rest through analogWrite()
+ * - Ramped PWM outputs (output_manager_set_ramp) skip rate limiting: the
+ *   message only sets a target and a timer ISR slews toward it
+ * - SPI outputs on the same spi_device_id form a chain (shift registers or
+ *   smart low-side drivers) behind the chip select in their pin field. A
+ *   change only edits the chain's shadow image; each chain goes out as one
+ *   DMA transfer at output_manager_commit_update(), and per-output fault
+ *   bits clocked back in that transfer are recorded (see shift_chain.h)
+ * - output_manager_update() reads back a few digital outputs per call and
+ *   repairs any that drifted, so its cost does not grow with the output count
  * - Rate limiting prevents bus flooding and ensures system stability
  * - Complete module decoupling - no module needs to know hardware details
  * - Fault monitoring provides diagnostics for troubleshooting
  * - Statistics tracking enables performance analysis
+ * - Control messages find their output through a msg_id hash index built
+ *   at registration, so the lookup cost does not grow with the output count
  * 
  * INTEGRATION:
  * Call output_manager_update() from your main loop to process all pending
@@ -94,6 +108,7 @@
 #define OUTPUT_MANAGER_H
 
 #include "output_manager_types.h"
+#include "output_ramp.h"
 #include "msg_definitions.h"
 
 #ifdef __cplusplus
@@ -106,6 +121,7 @@ extern "C" {
 
 #define OUTPUT_MANAGER_MAX_OUTPUTS 256
 #define OUTPUT_MANAGER_MAX_FAULTS 64
+#define OUTPUT_MANAGER_INTEGRITY_CHECKS 4     // Digital outputs read back per update
 
 // =============================================================================
 // PUBLIC FUNCTION DECLARATIONS
@@ -117,7 +133,7 @@ uint8_t output_manager_init(void);
 // Register output definitions with the manager
 uint8_t output_manager_register_outputs(const output_definition_t* outputs, uint8_t count);
 
-// Process all pending output updates (call from main loop)
+// Read back a few outputs and repair any that drifted (10 Hz executive task)
 void output_manager_update(void);
 
 // Set all outputs to safe default states
@@ -126,6 +142,24 @@ void output_manager_safe_state(void);
 // Enable/disable output processing
 void output_manager_enable(uint8_t enable);
 
+// Hand a timer-backed PWM output to the ramp engine: messages then set its
+// target and a 1 kHz timer slews, ramps and dithers the hardware (see
+// output_ramp.h). Returns false for other outputs or if the engine is full.
+bool output_manager_set_ramp(uint8_t output_index, const output_ramp_config_t* config);
+
+// Play a duty-versus-time table on an output given a ramp (see
+// output_ramp.h); the table must stay valid while it plays. Returns false
+// if the output has no ramp.
+bool output_manager_play_profile(uint8_t output_index, const output_ramp_point_t* points, uint8_t count);
+
+// Find output by message ID; -1 if none
+int16_t output_manager_find_output_by_msg_id(uint32_t msg_id);
+
+// Bracket a group of output changes (one message bus drain) so the PWM
+// channels among them switch on the same cycle; see pwm_driver.h
+void output_manager_begin_update(void);
+void output_manager_commit_update(void);
+
 // Get current output value by index
 float output_manager_get_value(uint8_t output_index);
 
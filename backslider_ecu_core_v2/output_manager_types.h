@@ -51,11 +51,12 @@ typedef struct {
 
 // SPI output configuration (for shift registers, SPI relay boards, etc.)
 typedef struct {
-    uint8_t spi_device_id;    // Which SPI device (0-3)
+    uint8_t spi_device_id;    // Which SPI device (0-3); the output's pin is its chip select
     uint8_t bit_position;     // Bit position within SPI device (0-15, 0-31, etc.)
     uint8_t active_high;      // 1=active high, 0=active low
     uint8_t default_state;    // Default/safe state (0 or 1)
     uint32_t spi_speed_hz;    // SPI clock speed
+    uint8_t fault_readback;   // 1=device returns a fault bit per output in the same frame
 } spi_config_t;
 
 // Virtual output configuration (for logging, CAN transmission, internal logic)
@@ -108,6 +109,8 @@ typedef struct {
     uint32_t range_violations;      // Values clamped due to range limits
     uint32_t fault_count;           // Total faults detected
     uint32_t last_update_time_ms;   // Time of last output update
+    uint32_t hardware_writes;       // analogWrite/digitalWrite calls issued
+    uint32_t integrity_repairs;     // Outputs rewritten after a failed read-back
 } output_manager_stats_t;
 
 // =============================================================================
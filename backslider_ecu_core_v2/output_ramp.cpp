@@ -0,0 +1,281 @@
+// output_ramp.cpp
+// Timer-driven slew/ramp/dither for PWM outputs
+
+#include "output_ramp.h"
+#include "pwm_driver.h"
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+typedef struct {
+    int8_t pwm_channel;
+    uint8_t profile;
+    uint8_t invert;
+    uint8_t dither_high;            // Current half of the dither cycle
+    float step_limit;               // Max change per tick (0 = none)
+    float alpha;                    // EXPONENTIAL fraction of the error per tick
+    float dither_amplitude;
+    uint16_t dither_half_ticks;     // 0 = no dither
+    uint16_t dither_ticks;
+    float min_duty;
+    float max_duty;
+    float period;                   // Counts for 100% duty
+    uint32_t last_counts;
+    const output_ramp_point_t* volatile points;     // Profile playing (nullptr = none)
+    uint8_t point_count;
+    uint8_t segment;                // Current profile segment (points[segment..segment+1])
+    uint32_t profile_ticks;         // Ticks since the profile started
+    volatile float target;
+    volatile float value;
+} ramp_channel_t;
+
+static ramp_channel_t ramps[OUTPUT_RAMP_MAX_CHANNELS];
+static volatile uint8_t ramp_count = 0;
+static volatile uint32_t tick_count = 0;
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static float clamp_duty(const ramp_channel_t* r, float duty) {
+    if (duty < r->min_duty) return r->min_duty;
+    if (duty > r->max_duty) return r->max_duty;
+    return duty;
+}
+
+static void write_duty(ramp_channel_t* r, float duty) {
+    uint32_t counts = (uint32_t)(clamp_duty(r, duty) * r->period);
+    if (r->invert) {
+        counts = (uint32_t)r->period - counts;
+    }
+    if (counts != r->last_counts) {
+        pwm_driver_write_immediate(r->pwm_channel, counts);
+        r->last_counts = counts;
+    }
+}
+
+// Duty of the playing profile at this tick; ends playback after the last point
+static float advance_profile(ramp_channel_t* r) {
+    const output_ramp_point_t* p = r->points;
+    uint32_t elapsed_ms = r->profile_ticks * OUTPUT_RAMP_TICK_US / 1000;
+    r->profile_ticks++;
+
+    while (r->segment + 1 < r->point_count && elapsed_ms >= p[r->segment + 1].time_ms) {
+        r->segment++;
+    }
+    if (r->segment + 1 >= r->point_count) {
+        r->points = nullptr;
+        return p[r->point_count - 1].duty;
+    }
+    const output_ramp_point_t* a = &p[r->segment];
+    const output_ramp_point_t* b = &p[r->segment + 1];
+    if (elapsed_ms <= a->time_ms) {
+        return a->duty;
+    }
+    float fraction = (float)(elapsed_ms - a->time_ms) / (float)(b->time_ms - a->time_ms);
+    return a->duty + (b->duty - a->duty) * fraction;
+}
+
+static void advance_channel(ramp_channel_t* r) {
+    float value = r->value;
+    float error = r->target - value;
+
+    if (r->points != nullptr) {
+        value = clamp_duty(r, advance_profile(r));
+        r->value = value;
+    } else if (error != 0.0f) {
+        float step = (r->profile == OUTPUT_RAMP_EXPONENTIAL) ? error * r->alpha : error;
+        if (r->step_limit > 0.0f) {
+            if (step > r->step_limit) step = r->step_limit;
+            if (step < -r->step_limit) step = -r->step_limit;
+        }
+        // The lag never quite arrives; finish once below a count's worth
+        float remaining = error - step;
+        if (remaining * r->period < 0.5f && remaining * r->period > -0.5f) {
+            step = error;
+        }
+        value += step;
+        r->value = value;
+    }
+
+    if (r->dither_half_ticks != 0) {
+        if (++r->dither_ticks >= r->dither_half_ticks) {
+            r->dither_ticks = 0;
+            r->dither_high ^= 1;
+        }
+        value += r->dither_high ? r->dither_amplitude : -r->dither_amplitude;
+    }
+    write_duty(r, value);
+}
+
+// One engine tick (timer ISR context on hardware)
+static void ramp_tick(void) {
+    for (uint8_t i = 0; i < ramp_count; i++) {
+        advance_channel(&ramps[i]);
+    }
+    tick_count++;
+}
+
+#ifdef ARDUINO
+
+static IntervalTimer ramp_timer;
+static bool ramp_timer_running = false;
+
+static void start_ramp_timer(void) {
+    if (ramp_timer_running) {
+        return;
+    }
+    // Above the ADC scan (128): solenoid timing matters more than sample phase
+    ramp_timer.priority(96);
+    ramp_timer_running = ramp_timer.begin(ramp_tick, OUTPUT_RAMP_TICK_US);
+}
+
+static void stop_ramp_timer(void) {
+    if (!ramp_timer_running) {
+        return;
+    }
+    ramp_timer.end();
+    ramp_timer_running = false;
+}
+
+#endif
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void output_ramp_init(void) {
+    #ifdef ARDUINO
+    stop_ramp_timer();
+    #endif
+    ramp_count = 0;
+    tick_count = 0;
+}
+
+int8_t output_ramp_attach(int8_t pwm_channel, const output_ramp_config_t* config,
+                          float initial_duty, float min_duty, float max_duty, uint8_t invert) {
+    uint32_t period = pwm_driver_get_period(pwm_channel);
+    if (config == nullptr || period == 0 || ramp_count >= OUTPUT_RAMP_MAX_CHANNELS) {
+        return -1;
+    }
+    for (uint8_t i = 0; i < ramp_count; i++) {
+        if (ramps[i].pwm_channel == pwm_channel) {
+            return -1;      // Already owned by another ramp
+        }
+    }
+
+    const float tick_s = OUTPUT_RAMP_TICK_US / 1000000.0f;
+    ramp_channel_t* r = &ramps[ramp_count];
+    r->pwm_channel = pwm_channel;
+    r->profile = config->profile;
+    r->invert = invert;
+    r->step_limit = config->slew_per_s * tick_s;
+    r->alpha = (config->time_constant_ms > 0.0f)
+        ? (OUTPUT_RAMP_TICK_US / 1000.0f) / (config->time_constant_ms + OUTPUT_RAMP_TICK_US / 1000.0f)
+        : 1.0f;
+    r->dither_amplitude = config->dither_amplitude;
+    r->dither_half_ticks = 0;
+    if (config->dither_amplitude > 0.0f && config->dither_period_ms > 0) {
+        uint32_t half_ticks = (uint32_t)config->dither_period_ms * 1000u / OUTPUT_RAMP_TICK_US / 2;
+        r->dither_half_ticks = (uint16_t)(half_ticks > 0 ? half_ticks : 1);
+    }
+    r->dither_ticks = 0;
+    r->dither_high = 1;
+    r->min_duty = min_duty;
+    r->max_duty = max_duty;
+    r->period = (float)period;
+    r->last_counts = 0xFFFFFFFFu;
+    r->points = nullptr;
+    r->value = clamp_duty(r, initial_duty);
+    r->target = r->value;
+    write_duty(r, r->value);
+
+    // Visible to the ISR only once complete
+    uint8_t handle = ramp_count;
+    ramp_count++;
+
+    #ifdef ARDUINO
+    start_ramp_timer();
+    #endif
+    return handle;
+}
+
+void output_ramp_set_target(int8_t ramp, float duty) {
+    if (ramp < 0 || ramp >= ramp_count) {
+        return;
+    }
+    ramps[ramp].target = clamp_duty(&ramps[ramp], duty);
+}
+
+void output_ramp_set_now(int8_t ramp, float duty) {
+    if (ramp < 0 || ramp >= ramp_count) {
+        return;
+    }
+    ramp_channel_t* r = &ramps[ramp];
+    #ifdef ARDUINO
+    noInterrupts();
+    #endif
+    r->points = nullptr;
+    r->target = clamp_duty(r, duty);
+    r->value = r->target;
+    r->dither_ticks = 0;
+    write_duty(r, r->value);
+    #ifdef ARDUINO
+    interrupts();
+    #endif
+}
+
+bool output_ramp_play_profile(int8_t ramp, const output_ramp_point_t* points, uint8_t count) {
+    if (ramp < 0 || ramp >= ramp_count || points == nullptr || count == 0) {
+        return false;
+    }
+    ramp_channel_t* r = &ramps[ramp];
+    #ifdef ARDUINO
+    noInterrupts();
+    #endif
+    r->point_count = count;
+    r->segment = 0;
+    r->profile_ticks = 0;
+    r->points = points;
+    #ifdef ARDUINO
+    interrupts();
+    #endif
+    return true;
+}
+
+bool output_ramp_is_playing(int8_t ramp) {
+    if (ramp < 0 || ramp >= ramp_count) {
+        return false;
+    }
+    return ramps[ramp].points != nullptr;
+}
+
+float output_ramp_get_value(int8_t ramp) {
+    if (ramp < 0 || ramp >= ramp_count) {
+        return 0.0f;
+    }
+    return ramps[ramp].value;
+}
+
+uint8_t output_ramp_get_channel_count(void) {
+    return ramp_count;
+}
+
+uint32_t output_ramp_get_tick_count(void) {
+    return tick_count;
+}
+
+#ifdef TESTING
+void output_ramp_run_ticks_for_testing(uint32_t ticks) {
+    for (uint32_t t = 0; t < ticks; t++) {
+        ramp_tick();
+    }
+}
+#endif
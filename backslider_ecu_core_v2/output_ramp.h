@@ -0,0 +1,101 @@
+// output_ramp.h
+// Fixed-rate slew, ramp and dither engine for PWM outputs
+
+/* =============================================================================
+ * OUTPUT RAMP OVERVIEW
+ * =============================================================================
+ *
+ * check_rate_limit() drops commands that arrive too soon, so a ramp only
+ * moves when the next message comes in and the main loop gets to it. For
+ * outputs attached here the bus only sets a target; a timer ISR running
+ * every OUTPUT_RAMP_TICK_US moves each channel toward its target and writes
+ * the PWM compare register itself:
+ *
+ * - LINEAR: at most slew_per_s duty per second.
+ * - EXPONENTIAL: first-order lag with time_constant_ms, still capped by
+ *   slew_per_s when that is set. Approaches the target without overshoot,
+ *   which suits pressure regulation solenoids.
+ * - Dither: a square wave of +/- dither_amplitude with dither_period_ms
+ *   added on top of the ramped value, to keep a valve spool from sticking.
+ *
+ * - Profiles: a duty-versus-time table (e.g. line pressure through a
+ *   shift) played back at the tick rate, linearly interpolated between
+ *   points. The target is ignored while it plays; afterwards the channel
+ *   holds the last point and ramps from there to the current target.
+ *   Tables are read in the ISR, so they must stay valid for the playback
+ *   (static const tables).
+ *
+ * A channel's hardware write is skipped when its counts do not change.
+ * Channels are written with pwm_driver_write_immediate(), so they belong to
+ * the engine once attached: nothing else may write them.
+ *
+ * Only pwm_driver channels can be attached; outputs on analogWrite() pins
+ * keep the message-path behaviour.
+ * =============================================================================
+ */
+
+#ifndef OUTPUT_RAMP_H
+#define OUTPUT_RAMP_H
+
+#include <stdint.h>
+
+#define OUTPUT_RAMP_MAX_CHANNELS    8
+#define OUTPUT_RAMP_TICK_US         1000    // 1 kHz
+
+typedef enum {
+    OUTPUT_RAMP_LINEAR = 0,
+    OUTPUT_RAMP_EXPONENTIAL
+} output_ramp_profile_t;
+
+typedef struct {
+    uint16_t time_ms;           // From the start of playback, ascending
+    float duty;
+} output_ramp_point_t;
+
+typedef struct {
+    uint8_t profile;            // output_ramp_profile_t
+    float slew_per_s;           // Max duty change per second (0 = no limit)
+    float time_constant_ms;     // EXPONENTIAL lag
+    float dither_amplitude;     // Duty added/subtracted by the dither (0 = off)
+    uint16_t dither_period_ms;  // Full dither cycle (0 = off)
+} output_ramp_config_t;
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Stop the timer and forget all channels
+void output_ramp_init(void);
+
+// Take over a pwm_driver channel, starting at initial_duty. Duty (ramped
+// value plus dither) is kept within [min_duty, max_duty]; invert flips the
+// counts written. Returns the ramp handle, or -1.
+int8_t output_ramp_attach(int8_t pwm_channel, const output_ramp_config_t* config,
+                          float initial_duty, float min_duty, float max_duty, uint8_t invert);
+
+// Duty the channel ramps toward
+void output_ramp_set_target(int8_t ramp, float duty);
+
+// Jump straight to a duty with no ramp (safe state)
+void output_ramp_set_now(int8_t ramp, float duty);
+
+// Play a duty-versus-time table from now. Replaces a table still playing;
+// returns false for an invalid handle or an empty table
+bool output_ramp_play_profile(int8_t ramp, const output_ramp_point_t* points, uint8_t count);
+
+// True while a table is playing on the channel
+bool output_ramp_is_playing(int8_t ramp);
+
+// Ramped duty the channel is at (without dither)
+float output_ramp_get_value(int8_t ramp);
+
+// Diagnostics
+uint8_t output_ramp_get_channel_count(void);
+uint32_t output_ramp_get_tick_count(void);
+
+#ifdef TESTING
+// Run engine ticks synchronously, as the timer would
+void output_ramp_run_ticks_for_testing(uint32_t ticks);
+#endif
+
+#endif
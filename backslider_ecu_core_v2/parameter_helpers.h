@@ -48,6 +48,21 @@ inline bool is_valid_parameter_operation(uint8_t operation) {
     return (operation >= PARAM_OP_STATUS_BROADCAST && operation <= PARAM_OP_ERROR);
 }
 
+// Requests the external channels tag with their channel and a request ID
+inline bool is_parameter_request_operation(uint8_t operation) {
+    return operation == PARAM_OP_READ_REQUEST || operation == PARAM_OP_WRITE_REQUEST ||
+           (operation >= PARAM_OP_BATCH_READ_RANGE && operation <= PARAM_OP_BATCH_ABORT) ||
+           operation == PARAM_OP_BATCH_SNAPSHOT;
+}
+
+// Requests that get a response, and so a RequestTracker entry. Staging
+// frames and aborts are answered only on error.
+inline bool is_tracked_parameter_operation(uint8_t operation) {
+    return operation == PARAM_OP_READ_REQUEST || operation == PARAM_OP_WRITE_REQUEST ||
+           operation == PARAM_OP_BATCH_READ_RANGE || operation == PARAM_OP_BATCH_READ_LIST ||
+           operation == PARAM_OP_BATCH_WRITE_COMMIT || operation == PARAM_OP_BATCH_SNAPSHOT;
+}
+
 // Helper function to validate parameter message length
 inline bool is_valid_parameter_message(const CANMessage* msg) {
     return (msg != nullptr && msg->len == sizeof(parameter_msg_t));
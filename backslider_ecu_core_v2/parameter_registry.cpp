@@ -3,17 +3,25 @@
 
 #include "parameter_registry.h"
 #include "parameter_helpers.h"
+#include "trace_buffer.h"
+#include "id_hash.h"
 
 // =============================================================================
 // STATIC MEMBER INITIALIZATION
 // =============================================================================
 
 ParameterHandler ParameterRegistry::registered_parameters[MAX_PARAMETERS];
-uint8_t ParameterRegistry::parameter_count = 0;
+uint16_t ParameterRegistry::parameter_count = 0;
+uint16_t ParameterRegistry::parameter_index[INDEX_TABLE_SIZE];
+ParameterRangeHandler ParameterRegistry::registered_ranges[MAX_PARAMETER_RANGES];
+uint8_t ParameterRegistry::range_count = 0;
 uint32_t ParameterRegistry::requests_processed = 0;
 uint32_t ParameterRegistry::read_requests = 0;
 uint32_t ParameterRegistry::write_requests = 0;
 uint32_t ParameterRegistry::errors_generated = 0;
+uint32_t ParameterRegistry::batch_requests = 0;
+uint32_t ParameterRegistry::batch_flow_stalls = 0;
+ParameterRegistry::BatchState ParameterRegistry::batches[BATCH_CHANNELS];
 
 // =============================================================================
 // REGISTRATION METHODS
@@ -23,22 +31,27 @@ bool ParameterRegistry::register_parameter(uint32_t param_id,
                                          parameter_read_handler_t read_handler,
                                          parameter_write_handler_t write_handler, 
                                          const char* description) {
+    // Check if parameter already registered
+    ParameterHandler* existing = find_handler(param_id);
+    if (existing) {
+        // Update existing entry
+        existing->read_handler = read_handler;
+        existing->write_handler = write_handler;
+        existing->description = description;
+        return true;
+    }
+    
     if (parameter_count >= MAX_PARAMETERS) {
         return false; // Registry full
     }
     
-    // Check if parameter already registered
-    for (uint8_t i = 0; i < parameter_count; i++) {
-        if (registered_parameters[i].param_id == param_id) {
-            // Update existing entry
-            registered_parameters[i].read_handler = read_handler;
-            registered_parameters[i].write_handler = write_handler;
-            registered_parameters[i].description = description;
-            return true;
-        }
+    // Add new entry; the index is at most half full, so a free slot exists
+    uint16_t position = index_hash(param_id);
+    while (parameter_index[position] != 0) {
+        position = (position + 1) & (INDEX_TABLE_SIZE - 1);
     }
+    parameter_index[position] = parameter_count + 1;
     
-    // Add new entry
     registered_parameters[parameter_count].param_id = param_id;
     registered_parameters[parameter_count].read_handler = read_handler;
     registered_parameters[parameter_count].write_handler = write_handler;
@@ -48,14 +61,61 @@ bool ParameterRegistry::register_parameter(uint32_t param_id,
     return true;
 }
 
+bool ParameterRegistry::register_parameter_range(uint32_t base_id, uint32_t id_mask,
+                                               parameter_range_read_handler_t read_handler,
+                                               parameter_range_write_handler_t write_handler,
+                                               const char* description) {
+    // Update an existing range with the same pattern
+    for (uint8_t i = 0; i < range_count; i++) {
+        if (registered_ranges[i].base_id == base_id && registered_ranges[i].id_mask == id_mask) {
+            registered_ranges[i].read_handler = read_handler;
+            registered_ranges[i].write_handler = write_handler;
+            registered_ranges[i].description = description;
+            return true;
+        }
+    }
+    
+    if (range_count >= MAX_PARAMETER_RANGES) {
+        return false; // Registry full
+    }
+    
+    registered_ranges[range_count].base_id = base_id & id_mask;
+    registered_ranges[range_count].id_mask = id_mask;
+    registered_ranges[range_count].read_handler = read_handler;
+    registered_ranges[range_count].write_handler = write_handler;
+    registered_ranges[range_count].description = description;
+    range_count++;
+    
+    return true;
+}
+
 // =============================================================================
 // LOOKUP METHODS
 // =============================================================================
 
+uint16_t ParameterRegistry::index_hash(uint32_t param_id) {
+    return fib_hash(param_id, INDEX_TABLE_BITS);
+}
+
 ParameterHandler* ParameterRegistry::find_handler(uint32_t param_id) {
-    for (uint8_t i = 0; i < parameter_count; i++) {
-        if (registered_parameters[i].param_id == param_id) {
-            return &registered_parameters[i];
+    uint16_t position = index_hash(param_id);
+    for (uint16_t probe = 0; probe < INDEX_TABLE_SIZE; probe++) {
+        uint16_t entry = parameter_index[position];
+        if (entry == 0) {
+            return nullptr;
+        }
+        if (registered_parameters[entry - 1].param_id == param_id) {
+            return &registered_parameters[entry - 1];
+        }
+        position = (position + 1) & (INDEX_TABLE_SIZE - 1);
+    }
+    return nullptr;
+}
+
+ParameterRangeHandler* ParameterRegistry::find_range_handler(uint32_t param_id) {
+    for (uint8_t i = 0; i < range_count; i++) {
+        if ((param_id & registered_ranges[i].id_mask) == registered_ranges[i].base_id) {
+            return &registered_ranges[i];
         }
     }
     return nullptr;
@@ -74,50 +134,29 @@ void ParameterRegistry::handle_parameter_request(const CANMessage* msg) {
         return;
     }
     
-    #ifdef ARDUINO
-    Serial.print("ParameterRegistry: handle_parameter_request called for CAN ID 0x");
-    Serial.println(msg->id, HEX);
-    #endif
-    
     parameter_msg_t* param = get_parameter_msg(msg);
+    TRACE(TRACE_CAT_PARAMETER, TRACE_PARAM_REQUEST, param->operation, msg->id,
+          ((uint32_t)param->source_channel << 8) | param->request_id);
     
-    #ifdef ARDUINO
-    Serial.print("ParameterRegistry: Parameter message - operation=");
-    Serial.print(param->operation);
-    Serial.print(", value=");
-    Serial.print(param->value);
-    Serial.print(", channel=");
-    Serial.print(param->source_channel);
-    Serial.print(", request_id=");
-    Serial.println(param->request_id);
-    #endif
+    if ((param->operation >= PARAM_OP_BATCH_READ_RANGE && param->operation <= PARAM_OP_BATCH_ABORT) ||
+        param->operation == PARAM_OP_BATCH_SNAPSHOT) {
+        handle_batch_request(msg);
+        return;
+    }
     
     // Only process read/write requests, not responses
     if (param->operation != PARAM_OP_READ_REQUEST && param->operation != PARAM_OP_WRITE_REQUEST) {
-        #ifdef ARDUINO
-        Serial.println("ParameterRegistry: Not a read/write request, ignoring");
-        #endif
         return;
     }
     
     requests_processed++;
     
-    // Find handler for this parameter
+    // Find handler for this parameter, then a range covering it
     ParameterHandler* handler = find_handler(msg->id);
+    ParameterRangeHandler* range = handler ? nullptr : find_range_handler(msg->id);
     
-    #ifdef ARDUINO
-    if (handler) {
-        Serial.print("ParameterRegistry: Found handler for parameter 0x");
-        Serial.print(msg->id, HEX);
-        Serial.print(" - ");
-        Serial.println(handler->description);
-    } else {
-        Serial.print("ParameterRegistry: No handler found for parameter 0x");
-        Serial.println(msg->id, HEX);
-    }
-    #endif
-    
-    if (!handler) {
+    if (!handler && !range) {
+        TRACE(TRACE_CAT_PARAMETER, TRACE_PARAM_NOT_FOUND, param->operation, msg->id, 0);
         send_parameter_error_routed(msg->id, param->operation, 
                                   PARAM_ERROR_INVALID_OPERATION, param->value,
                                   param->source_channel, param->request_id);
@@ -128,25 +167,12 @@ void ParameterRegistry::handle_parameter_request(const CANMessage* msg) {
     switch (param->operation) {
         case PARAM_OP_READ_REQUEST:
             read_requests++;
-            #ifdef ARDUINO
-            Serial.println("ParameterRegistry: Processing READ_REQUEST");
-            #endif
-            if (handler->read_handler) {
-                float value = handler->read_handler();
-                #ifdef ARDUINO
-                Serial.print("ParameterRegistry: Read handler returned value: ");
-                Serial.println(value);
-                #endif
+            if (handler ? handler->read_handler != nullptr : range->read_handler != nullptr) {
+                float value = handler ? handler->read_handler() : range->read_handler(msg->id);
                 send_parameter_response_routed(msg->id, PARAM_OP_READ_RESPONSE, 
                                              value, param->source_channel, 
                                              param->request_id);
-                #ifdef ARDUINO
-                Serial.println("ParameterRegistry: READ_RESPONSE sent");
-                #endif
             } else {
-                #ifdef ARDUINO
-                Serial.println("ParameterRegistry: No read handler available");
-                #endif
                 send_parameter_error_routed(msg->id, param->operation, 
                                           PARAM_ERROR_READ_ONLY, param->value,
                                           param->source_channel, param->request_id);
@@ -156,8 +182,9 @@ void ParameterRegistry::handle_parameter_request(const CANMessage* msg) {
             
         case PARAM_OP_WRITE_REQUEST:
             write_requests++;
-            if (handler->write_handler) {
-                bool success = handler->write_handler(param->value);
+            if (handler ? handler->write_handler != nullptr : range->write_handler != nullptr) {
+                bool success = handler ? handler->write_handler(param->value)
+                                       : range->write_handler(msg->id, param->value);
                 if (success) {
                     send_parameter_response_routed(msg->id, PARAM_OP_WRITE_ACK, 
                                                  param->value, param->source_channel, 
@@ -186,6 +213,292 @@ void ParameterRegistry::handle_parameter_request(const CANMessage* msg) {
     }
 }
 
+// =============================================================================
+// HANDLER CALLS
+// =============================================================================
+
+uint8_t ParameterRegistry::read_value(uint32_t param_id, float* value) {
+    ParameterHandler* handler = find_handler(param_id);
+    if (handler != nullptr) {
+        if (handler->read_handler == nullptr) {
+            return PARAM_ERROR_INVALID_OPERATION;
+        }
+        *value = handler->read_handler();
+        return PARAM_ERROR_SUCCESS;
+    }
+    ParameterRangeHandler* range = find_range_handler(param_id);
+    if (range == nullptr || range->read_handler == nullptr) {
+        return PARAM_ERROR_INVALID_OPERATION;
+    }
+    *value = range->read_handler(param_id);
+    return PARAM_ERROR_SUCCESS;
+}
+
+uint8_t ParameterRegistry::write_value(uint32_t param_id, float value) {
+    ParameterHandler* handler = find_handler(param_id);
+    ParameterRangeHandler* range = handler ? nullptr : find_range_handler(param_id);
+    if (!handler && !range) {
+        return PARAM_ERROR_INVALID_OPERATION;
+    }
+    if (handler ? handler->write_handler == nullptr : range->write_handler == nullptr) {
+        return PARAM_ERROR_READ_ONLY;
+    }
+    bool success = handler ? handler->write_handler(value) : range->write_handler(param_id, value);
+    return success ? PARAM_ERROR_SUCCESS : PARAM_ERROR_WRITE_FAILED;
+}
+
+bool ParameterRegistry::has_write_handler(uint32_t param_id) {
+    ParameterHandler* handler = find_handler(param_id);
+    if (handler != nullptr) {
+        return handler->write_handler != nullptr;
+    }
+    ParameterRangeHandler* range = find_range_handler(param_id);
+    return range != nullptr && range->write_handler != nullptr;
+}
+
+// =============================================================================
+// BATCHED REQUESTS
+// =============================================================================
+
+void ParameterRegistry::handle_batch_request(const CANMessage* msg) {
+    const parameter_batch_msg_t* request = (const parameter_batch_msg_t*)msg->buf;
+    const parameter_msg_t* param = get_parameter_msg(msg);
+    uint8_t channel = request->source_channel;
+    if (channel >= BATCH_CHANNELS) {
+        send_parameter_error_routed(msg->id, request->operation, PARAM_ERROR_INVALID_OPERATION,
+                                    0.0f, channel, request->request_id);
+        errors_generated++;
+        return;
+    }
+    BatchState& batch = batches[channel];
+    requests_processed++;
+    
+    switch (request->operation) {
+        case PARAM_OP_BATCH_LIST_ADD:
+            // The list is being read out; it cannot change under the stream
+            if ((batch.streaming && batch.source == BATCH_SOURCE_LIST) || batch.list_count >= MAX_BATCH_ENTRIES) {
+                send_parameter_error_routed(msg->id, request->operation, PARAM_ERROR_SYSTEM_BUSY,
+                                            0.0f, channel, request->request_id);
+                errors_generated++;
+                return;
+            }
+            batch.list_ids[batch.list_count++] = msg->id;
+            return;
+            
+        case PARAM_OP_BATCH_WRITE_STAGE: {
+            if (!has_write_handler(msg->id)) {
+                send_parameter_error_routed(msg->id, request->operation, PARAM_ERROR_READ_ONLY,
+                                            param->value, channel, request->request_id);
+                errors_generated++;
+                return;
+            }
+            // Staging an ID again replaces its value
+            for (uint8_t i = 0; i < batch.write_count; i++) {
+                if (batch.write_ids[i] == msg->id) {
+                    batch.write_values[i] = param->value;
+                    return;
+                }
+            }
+            if (batch.write_count >= MAX_BATCH_ENTRIES) {
+                send_parameter_error_routed(msg->id, request->operation, PARAM_ERROR_SYSTEM_BUSY,
+                                            param->value, channel, request->request_id);
+                errors_generated++;
+                return;
+            }
+            batch.write_ids[batch.write_count] = msg->id;
+            batch.write_values[batch.write_count] = param->value;
+            batch.write_count++;
+            return;
+        }
+            
+        case PARAM_OP_BATCH_READ_RANGE:
+        case PARAM_OP_BATCH_READ_LIST:
+        case PARAM_OP_BATCH_SNAPSHOT:
+            batch_requests++;
+            if (batch.streaming) {
+                send_parameter_error_routed(msg->id, request->operation, PARAM_ERROR_SYSTEM_BUSY,
+                                            0.0f, channel, request->request_id);
+                errors_generated++;
+                return;
+            }
+            batch.streaming = true;
+            batch.first_id = request->param_id;
+            if (request->operation == PARAM_OP_BATCH_READ_LIST) {
+                batch.source = BATCH_SOURCE_LIST;
+                batch.total = batch.list_count;
+            } else if (request->operation == PARAM_OP_BATCH_SNAPSHOT) {
+                // Parameters registered during the stream are not included
+                batch.source = BATCH_SOURCE_REGISTRY;
+                batch.total = parameter_count;
+            } else {
+                batch.source = BATCH_SOURCE_RANGE;
+                batch.total = request->count;
+            }
+            batch.next = 0;
+            batch.answered = 0;
+            batch.failures = 0;
+            batch.request_id = request->request_id;
+            return;
+            
+        case PARAM_OP_BATCH_WRITE_COMMIT:
+            batch_requests++;
+            commit_batch_writes(batch, channel, request->request_id);
+            return;
+            
+        case PARAM_OP_BATCH_ABORT:
+            batch.list_count = 0;
+            batch.write_count = 0;
+            batch.streaming = false;
+            return;
+            
+        default:
+            return;
+    }
+}
+
+void ParameterRegistry::commit_batch_writes(BatchState& batch, uint8_t channel, uint8_t request_id) {
+    uint8_t count = batch.write_count;
+    batch.write_count = 0;
+    
+    // Every handler must still be there before anything is written
+    uint8_t missing = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (!has_write_handler(batch.write_ids[i])) {
+            send_parameter_error_routed(batch.write_ids[i], PARAM_OP_BATCH_WRITE_COMMIT,
+                                        PARAM_ERROR_READ_ONLY, batch.write_values[i],
+                                        channel, request_id);
+            errors_generated++;
+            missing++;
+        }
+    }
+    if (missing > 0) {
+        send_batch_complete(0, missing, channel, request_id);
+        return;
+    }
+    
+    // Old values first, so a refused write can be undone
+    float previous[MAX_BATCH_ENTRIES];
+    bool restorable[MAX_BATCH_ENTRIES];
+    for (uint8_t i = 0; i < count; i++) {
+        restorable[i] = (read_value(batch.write_ids[i], &previous[i]) == PARAM_ERROR_SUCCESS);
+    }
+    
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t error = write_value(batch.write_ids[i], batch.write_values[i]);
+        if (error == PARAM_ERROR_SUCCESS) {
+            continue;
+        }
+        
+        for (uint8_t j = i; j-- > 0; ) {
+            if (restorable[j]) {
+                write_value(batch.write_ids[j], previous[j]);
+            }
+        }
+        send_parameter_error_routed(batch.write_ids[i], PARAM_OP_BATCH_WRITE_COMMIT, error,
+                                    batch.write_values[i], channel, request_id);
+        errors_generated++;
+        send_batch_complete(0, 1, channel, request_id);
+        return;
+    }
+    
+    write_requests += count;
+    send_batch_complete(count, 0, channel, request_id);
+}
+
+void ParameterRegistry::stream_batch(BatchState& batch, uint8_t channel) {
+    uint8_t sent = 0;
+    while (batch.next < batch.total && sent < BATCH_RESPONSES_PER_UPDATE) {
+        uint32_t param_id;
+        switch (batch.source) {
+            case BATCH_SOURCE_LIST:     param_id = batch.list_ids[batch.next]; break;
+            case BATCH_SOURCE_REGISTRY: param_id = registered_parameters[batch.next].param_id; break;
+            default:                    param_id = batch.first_id + batch.next; break;
+        }
+        
+        // Wait for the link rather than have it drop the response
+        if (!has_response_room(channel, param_id)) {
+            batch_flow_stalls++;
+            return;
+        }
+        batch.next++;
+        
+        float value = 0.0f;
+        if (read_value(param_id, &value) == PARAM_ERROR_SUCCESS) {
+            send_parameter_response_routed(param_id, PARAM_OP_READ_RESPONSE, value,
+                                           channel, batch.request_id);
+            batch.answered++;
+            read_requests++;
+            sent++;
+            continue;
+        }
+        
+        // Holes in a range and write-only parameters are expected; a listed
+        // ID was asked for by name
+        if (batch.source == BATCH_SOURCE_LIST) {
+            send_parameter_error_routed(param_id, PARAM_OP_BATCH_READ_LIST, PARAM_ERROR_INVALID_OPERATION,
+                                        0.0f, channel, batch.request_id);
+            errors_generated++;
+            sent++;
+        }
+        if (batch.failures < 0xFF) {
+            batch.failures++;
+        }
+    }
+    
+    if (batch.next >= batch.total) {
+        batch.streaming = false;
+        if (batch.source == BATCH_SOURCE_LIST) {
+            batch.list_count = 0;
+        }
+        send_batch_complete(batch.answered, batch.failures, channel, batch.request_id);
+    }
+}
+
+bool ParameterRegistry::has_response_room(uint8_t channel, uint32_t param_id) {
+    extern ExternalSerial g_external_serial;
+    extern ExternalCanBus g_external_canbus;
+    
+    if (g_external_serial.is_initialized() && !g_external_serial.has_response_room(channel, param_id)) {
+        return false;
+    }
+    if (g_external_canbus.is_initialized() && !g_external_canbus.has_response_room(channel)) {
+        return false;
+    }
+    return true;
+}
+
+void ParameterRegistry::send_batch_complete(uint32_t entries, uint8_t failures,
+                                            uint8_t source_channel, uint8_t request_id) {
+    parameter_batch_msg_t complete = {
+        .operation = PARAM_OP_BATCH_COMPLETE,
+        .param_id = entries,
+        .source_channel = source_channel,
+        .request_id = request_id,
+        .count = failures
+    };
+    send_parameter_frame_routed(MSG_PARAM_BATCH, &complete);
+}
+
+void ParameterRegistry::update() {
+    for (uint8_t channel = 0; channel < BATCH_CHANNELS; channel++) {
+        if (batches[channel].streaming) {
+            stream_batch(batches[channel], channel);
+        }
+    }
+}
+
+bool ParameterRegistry::is_batch_streaming(uint8_t channel) {
+    return channel < BATCH_CHANNELS && batches[channel].streaming;
+}
+
+void ParameterRegistry::reset_batches() {
+    for (uint8_t channel = 0; channel < BATCH_CHANNELS; channel++) {
+        batches[channel].list_count = 0;
+        batches[channel].write_count = 0;
+        batches[channel].streaming = false;
+    }
+}
+
 // =============================================================================
 // STATISTICS
 // =============================================================================
@@ -195,4 +508,6 @@ void ParameterRegistry::reset_statistics() {
     read_requests = 0;
     write_requests = 0;
     errors_generated = 0;
+    batch_requests = 0;
+    batch_flow_stalls = 0;
 } 
\ No newline at end of file
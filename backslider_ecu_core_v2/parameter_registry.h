@@ -1,6 +1,32 @@
 // parameter_registry.h
 // Central parameter registry for request-response channel routing
 // Provides unified parameter management and routing
+//
+// Batched access (PARAM_OP_BATCH_*): each channel has a read list and a set
+// of staged writes, built up with LIST_ADD / WRITE_STAGE frames on the
+// parameters' own IDs. A READ_RANGE or READ_LIST starts a stream of
+// READ_RESPONSE frames, BATCH_RESPONSES_PER_UPDATE per update(), closed by a
+// BATCH_COMPLETE on MSG_PARAM_BATCH - all under one request ID. Range IDs
+// with no readable handler are skipped and counted as failures; listed ones
+// get an error frame. WRITE_COMMIT applies the staged writes in one call, so
+// no other module sees part of them: every ID must have a write handler or
+// nothing is written, and if a handler refuses its value the writes already
+// made are undone through their read handlers.
+//
+// A SNAPSHOT streams every single-ID parameter the same way, so a tool that
+// connects gets all current values without knowing any IDs; range handlers
+// (map cells) are read with READ_RANGE. Streams are flow controlled: before
+// each response the requesting channel is asked for room (serial TX ring,
+// CAN TX queue), and a stream that finds none resumes on the next update()
+// instead of having its responses dropped. Packing is left to the link -
+// v2 serial frames carry many records, and FD peers get packed frames.
+//
+// Lookup: single-ID handlers are found through an open-addressing hash index
+// (Fibonacci hashing, linear probing) built as modules register, so a request
+// costs the same however many tunables exist. Handlers are registered at
+// runtime from each module's init(), so the table cannot be generated at
+// compile time; it is sized at twice MAX_PARAMETERS to keep probes short.
+// The few range handlers are still matched in order.
 
 #ifndef PARAMETER_REGISTRY_H
 #define PARAMETER_REGISTRY_H
@@ -29,6 +55,19 @@ struct ParameterHandler {
     const char* description;
 };
 
+// Handlers for a block of IDs (map cells and the like) receive the ID
+typedef float (*parameter_range_read_handler_t)(uint32_t param_id);
+typedef bool (*parameter_range_write_handler_t)(uint32_t param_id, float value);
+
+// Range handler: matches any ID where (id & id_mask) == base_id
+struct ParameterRangeHandler {
+    uint32_t base_id;
+    uint32_t id_mask;
+    parameter_range_read_handler_t read_handler;
+    parameter_range_write_handler_t write_handler;
+    const char* description;
+};
+
 // =============================================================================
 // PARAMETER REGISTRY CLASS
 // =============================================================================
@@ -36,7 +75,11 @@ struct ParameterHandler {
 class ParameterRegistry {
 public:
     // Configuration constants
-    static const uint8_t MAX_PARAMETERS = 64;
+    static const uint16_t MAX_PARAMETERS = 256;
+    static const uint8_t MAX_PARAMETER_RANGES = 16;
+    static const uint8_t MAX_BATCH_ENTRIES = 64;            // Listed reads or staged writes per channel
+    static const uint8_t BATCH_CHANNELS = CHANNEL_CAN_BUS + 1;  // 0 = internal requests
+    static const uint8_t BATCH_RESPONSES_PER_UPDATE = 8;
     
     // Registration methods
     static bool register_parameter(uint32_t param_id, 
@@ -44,26 +87,79 @@ public:
                                  parameter_write_handler_t write_handler, 
                                  const char* description);
     
+    // Register a handler for a block of IDs. Single-ID registrations
+    // take precedence over a range covering the same ID.
+    static bool register_parameter_range(uint32_t base_id, uint32_t id_mask,
+                                       parameter_range_read_handler_t read_handler,
+                                       parameter_range_write_handler_t write_handler,
+                                       const char* description);
+    
     // Lookup methods
     static ParameterHandler* find_handler(uint32_t param_id);
+    static ParameterRangeHandler* find_range_handler(uint32_t param_id);
     
     // Request handling
     static void handle_parameter_request(const CANMessage* msg);
     
+    // Stream batch read responses; call from the main loop
+    static void update();
+    static bool is_batch_streaming(uint8_t channel);
+    static void reset_batches();
+    
     // Statistics
-    static uint8_t get_registered_count() { return parameter_count; }
+    static uint16_t get_registered_count() { return parameter_count; }
+    static uint32_t get_batch_request_count() { return batch_requests; }
+    static uint32_t get_batch_flow_stalls() { return batch_flow_stalls; }
     static void reset_statistics();
     
 private:
     // Registry storage
     static ParameterHandler registered_parameters[MAX_PARAMETERS];
-    static uint8_t parameter_count;
+    static uint16_t parameter_count;
+    
+    // param_id -> registered_parameters index + 1 (linear probing, 0 = empty,
+    // so the zero-initialised table is valid before the first registration)
+    static const uint8_t INDEX_TABLE_BITS = 9;
+    static const uint16_t INDEX_TABLE_SIZE = (1u << INDEX_TABLE_BITS);
+    static_assert(MAX_PARAMETERS * 2 <= INDEX_TABLE_SIZE, "Parameter index must stay at most half full");
+    static uint16_t parameter_index[INDEX_TABLE_SIZE];
+    
+    static ParameterRangeHandler registered_ranges[MAX_PARAMETER_RANGES];
+    static uint8_t range_count;
+    
+    // Per-channel batch state
+    enum {
+        BATCH_SOURCE_RANGE,
+        BATCH_SOURCE_LIST,
+        BATCH_SOURCE_REGISTRY       // Snapshot of registered_parameters
+    };
+    
+    struct BatchState {
+        uint32_t list_ids[MAX_BATCH_ENTRIES];
+        uint8_t list_count;
+        uint32_t write_ids[MAX_BATCH_ENTRIES];
+        float write_values[MAX_BATCH_ENTRIES];
+        uint8_t write_count;
+        
+        // Read stream in progress
+        bool streaming;
+        uint8_t source;             // BATCH_SOURCE_*
+        uint32_t first_id;          // Range reads
+        uint16_t total;
+        uint16_t next;
+        uint32_t answered;
+        uint8_t failures;
+        uint8_t request_id;
+    };
+    static BatchState batches[BATCH_CHANNELS];
     
     // Statistics
     static uint32_t requests_processed;
     static uint32_t read_requests;
     static uint32_t write_requests;
     static uint32_t errors_generated;
+    static uint32_t batch_requests;
+    static uint32_t batch_flow_stalls;      // Stream updates cut short for channel room
     
     // Helper methods
     static void send_parameter_response(uint32_t param_id, uint8_t operation, 
@@ -72,26 +168,33 @@ private:
     static void send_parameter_error(uint32_t param_id, uint8_t failed_operation,
                                    uint8_t error_code, float attempted_value,
                                    uint8_t source_channel, uint8_t request_id);
+    
+    static uint16_t index_hash(uint32_t param_id);
+    
+    // Handler lookup and calls shared by single and batched requests;
+    // return PARAM_ERROR_SUCCESS or the error to report
+    static uint8_t read_value(uint32_t param_id, float* value);
+    static uint8_t write_value(uint32_t param_id, float value);
+    static bool has_write_handler(uint32_t param_id);
+    
+    // Batched requests
+    static void handle_batch_request(const CANMessage* msg);
+    static void commit_batch_writes(BatchState& batch, uint8_t channel, uint8_t request_id);
+    static void stream_batch(BatchState& batch, uint8_t channel);
+    static bool has_response_room(uint8_t channel, uint32_t param_id);
+    static void send_batch_complete(uint32_t entries, uint8_t failures,
+                                    uint8_t source_channel, uint8_t request_id);
 };
 
 // =============================================================================
 // HELPER FUNCTIONS
 // =============================================================================
 
-// Helper function to send parameter response with routing info
-inline void send_parameter_response_routed(uint32_t param_id, uint8_t operation, 
-                                          float value, uint8_t source_channel, 
-                                          uint8_t request_id) {
-    parameter_msg_t response = {
-        .operation = operation,
-        .value = value,
-        .source_channel = source_channel,
-        .request_id = request_id,
-        .reserved = {0}
-    };
-    
+// Helper function to publish a parameter-sized response frame and hand it
+// straight to the external interfaces for routing
+inline void send_parameter_frame_routed(uint32_t param_id, const void* frame) {
     // Publish to message bus
-    g_message_bus.publish(param_id, &response, sizeof(response));
+    g_message_bus.publish(param_id, frame, sizeof(parameter_msg_t));
     
     // Also send directly to external interfaces for immediate response
     extern ExternalSerial g_external_serial;
@@ -101,7 +204,7 @@ inline void send_parameter_response_routed(uint32_t param_id, uint8_t operation,
     CANMessage can_response;
     can_response.id = param_id;
     can_response.len = sizeof(parameter_msg_t);
-    memcpy(can_response.buf, &response, sizeof(parameter_msg_t));
+    memcpy(can_response.buf, frame, sizeof(parameter_msg_t));
     
     // Send to external serial if initialized
     if (g_external_serial.is_initialized()) {
@@ -114,6 +217,20 @@ inline void send_parameter_response_routed(uint32_t param_id, uint8_t operation,
     }
 }
 
+// Helper function to send parameter response with routing info
+inline void send_parameter_response_routed(uint32_t param_id, uint8_t operation, 
+                                          float value, uint8_t source_channel, 
+                                          uint8_t request_id) {
+    parameter_msg_t response = {
+        .operation = operation,
+        .value = value,
+        .source_channel = source_channel,
+        .request_id = request_id,
+        .reserved = {0}
+    };
+    send_parameter_frame_routed(param_id, &response);
+}
+
 // Helper function to send parameter error with routing info
 inline void send_parameter_error_routed(uint32_t param_id, uint8_t failed_operation,
                                        uint8_t error_code, float attempted_value,
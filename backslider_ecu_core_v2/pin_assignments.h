@@ -58,6 +58,10 @@
 #define PIN_CAM_INTAKE         20    // Intake camshaft position
 #define PIN_CAM_EXHAUST        21    // Exhaust camshaft position
 
+// Define on engine builds to decode the crank wheel on PIN_CRANK_PRIMARY
+// with cam sync from PIN_CAM_INTAKE (see trigger_decoder.h):
+// #define TRIGGER_DECODER_ENABLED
+
 // Vehicle speed sensor
 #define PIN_VEHICLE_SPEED      6     // Vehicle Speed Sensor (Hall effect)
 
@@ -85,6 +89,10 @@
 // Note: Removed PIN_TRANS_SPORT and PIN_TRANS_MANUAL to make room for
 // PIN_TRANS_SECOND and PIN_TRANS_FIRST for proper 6-position gear selector
 
+// MCP23017 INTA output (mirrored, active low). Define when wired so the
+// I2C GPIO switches are only re-read after a change:
+// #define PIN_MCP23017_INT     <pin>
+
 // =============================================================================
 // ENGINE CONTROL OUTPUTS (PWM/Digital)
 // =============================================================================
@@ -0,0 +1,303 @@
+// pwm_driver.cpp
+// FlexPWM/QuadTimer compare register writes with synchronised latching
+
+#include "pwm_driver.h"
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+#define PWM_TIMER_FLEXPWM   0
+#define PWM_TIMER_QTIMER    1
+
+#define PWM_OUTPUT_A        0
+#define PWM_OUTPUT_B        1
+
+#define PWM_MODULE_COUNT    4
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+// Teensy 4.1 pins and the timer output behind them (as in the core's PWM table)
+typedef struct {
+    uint8_t pin;
+    uint8_t timer;      // PWM_TIMER_*
+    uint8_t module;     // FLEXPWM1..4 / QTIMER1..4 as 0..3
+    uint8_t sub;        // FlexPWM submodule or QuadTimer channel
+    uint8_t output;     // PWM_OUTPUT_* (FlexPWM only)
+} pwm_route_t;
+
+static const pwm_route_t pwm_routes[] = {
+    { 2, PWM_TIMER_FLEXPWM, 3, 2, PWM_OUTPUT_A},
+    { 3, PWM_TIMER_FLEXPWM, 3, 2, PWM_OUTPUT_B},
+    { 4, PWM_TIMER_FLEXPWM, 1, 0, PWM_OUTPUT_A},
+    { 5, PWM_TIMER_FLEXPWM, 1, 1, PWM_OUTPUT_A},
+    { 6, PWM_TIMER_FLEXPWM, 1, 2, PWM_OUTPUT_A},
+    { 7, PWM_TIMER_FLEXPWM, 0, 3, PWM_OUTPUT_B},
+    { 8, PWM_TIMER_FLEXPWM, 0, 3, PWM_OUTPUT_A},
+    { 9, PWM_TIMER_FLEXPWM, 1, 2, PWM_OUTPUT_B},
+    {10, PWM_TIMER_QTIMER,  0, 0, 0},
+    {11, PWM_TIMER_QTIMER,  0, 2, 0},
+    {12, PWM_TIMER_QTIMER,  0, 1, 0},
+    {13, PWM_TIMER_QTIMER,  1, 0, 0},
+    {14, PWM_TIMER_QTIMER,  2, 2, 0},
+    {15, PWM_TIMER_QTIMER,  2, 3, 0},
+    {18, PWM_TIMER_QTIMER,  2, 1, 0},
+    {19, PWM_TIMER_QTIMER,  2, 0, 0},
+    {22, PWM_TIMER_FLEXPWM, 3, 0, PWM_OUTPUT_A},
+    {23, PWM_TIMER_FLEXPWM, 3, 1, PWM_OUTPUT_A},
+    {28, PWM_TIMER_FLEXPWM, 2, 1, PWM_OUTPUT_B},
+    {29, PWM_TIMER_FLEXPWM, 2, 1, PWM_OUTPUT_A},
+    {33, PWM_TIMER_FLEXPWM, 1, 0, PWM_OUTPUT_B},
+    {36, PWM_TIMER_FLEXPWM, 1, 3, PWM_OUTPUT_A},
+    {37, PWM_TIMER_FLEXPWM, 1, 3, PWM_OUTPUT_B},
+    {42, PWM_TIMER_FLEXPWM, 0, 1, PWM_OUTPUT_B},
+    {43, PWM_TIMER_FLEXPWM, 0, 1, PWM_OUTPUT_A},
+    {44, PWM_TIMER_FLEXPWM, 0, 0, PWM_OUTPUT_B},
+    {45, PWM_TIMER_FLEXPWM, 0, 0, PWM_OUTPUT_A},
+    {46, PWM_TIMER_FLEXPWM, 0, 2, PWM_OUTPUT_B},
+    {47, PWM_TIMER_FLEXPWM, 0, 2, PWM_OUTPUT_A},
+};
+#define PWM_ROUTE_COUNT (sizeof(pwm_routes) / sizeof(pwm_routes[0]))
+
+typedef struct {
+    const pwm_route_t* route;
+    uint32_t period;            // Counts for 100% duty
+    uint32_t counts;            // Last written high time
+    uint8_t pending;            // Written inside an update bracket, not latched yet
+} pwm_channel_t;
+
+static pwm_channel_t channels[PWM_DRIVER_MAX_CHANNELS];
+static uint8_t channel_count = 0;
+static uint8_t deferring = 0;
+static uint8_t pending_ldok[PWM_MODULE_COUNT];     // FlexPWM submodule mask per module
+static uint32_t latch_count = 0;
+
+#ifndef ARDUINO
+static uint32_t sim_output[PWM_DRIVER_MAX_CHANNELS];   // Counts the timer generates
+#endif
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static const pwm_route_t* find_route(uint8_t pin) {
+    for (uint8_t i = 0; i < PWM_ROUTE_COUNT; i++) {
+        if (pwm_routes[i].pin == pin) {
+            return &pwm_routes[i];
+        }
+    }
+    return nullptr;
+}
+
+#ifdef ARDUINO
+
+static IMXRT_FLEXPWM_t* const flexpwm_modules[PWM_MODULE_COUNT] = {
+    &IMXRT_FLEXPWM1, &IMXRT_FLEXPWM2, &IMXRT_FLEXPWM3, &IMXRT_FLEXPWM4
+};
+static IMXRT_TMR_t* const qtimer_modules[PWM_MODULE_COUNT] = {
+    &IMXRT_TMR1, &IMXRT_TMR2, &IMXRT_TMR3, &IMXRT_TMR4
+};
+
+// Period as the core programmed it for the requested frequency
+static uint32_t read_period(const pwm_route_t* route, uint32_t frequency_hz) {
+    (void)frequency_hz;
+    if (route->timer == PWM_TIMER_FLEXPWM) {
+        return (uint32_t)flexpwm_modules[route->module]->SM[route->sub].VAL1 + 1;
+    }
+    IMXRT_TMR_t* tmr = qtimer_modules[route->module];
+    uint32_t modulo = 65537 - tmr->CH[route->sub].LOAD + tmr->CH[route->sub].CMPLD1;
+    return modulo - 1;
+}
+
+// Compare register write; the FlexPWM value takes effect when LDOK is set
+static void write_compare(pwm_channel_t* ch) {
+    const pwm_route_t* route = ch->route;
+    if (route->timer == PWM_TIMER_FLEXPWM) {
+        IMXRT_FLEXPWM_t* pwm = flexpwm_modules[route->module];
+        uint16_t mask = 1 << route->sub;
+        pwm->MCTRL |= FLEXPWM_MCTRL_CLDOK(mask);   // Buffers only accept writes with LDOK clear
+        if (route->output == PWM_OUTPUT_A) {
+            pwm->SM[route->sub].VAL3 = ch->counts;
+        } else {
+            pwm->SM[route->sub].VAL5 = ch->counts;
+        }
+        return;
+    }
+    // QuadTimer: high time in CMPLD1, low time through LOAD
+    IMXRT_TMR_t* tmr = qtimer_modules[route->module];
+    uint32_t low = ch->period + 1 - ch->counts;
+    tmr->CH[route->sub].LOAD = 65537 - low;
+    tmr->CH[route->sub].CMPLD1 = ch->counts;
+}
+
+static void set_ldok(uint8_t module, uint8_t mask) {
+    flexpwm_modules[module]->MCTRL |= FLEXPWM_MCTRL_LDOK(mask);
+}
+
+#else
+
+// Period a FlexPWM/QuadTimer channel gets from the core's prescaler choice
+static uint32_t read_period(const pwm_route_t* route, uint32_t frequency_hz) {
+    (void)route;
+    uint32_t counts = 150000000UL / frequency_hz;
+    while (counts > 65535) {
+        counts >>= 1;
+    }
+    return counts;
+}
+
+static void write_compare(pwm_channel_t* ch) {
+    (void)ch;
+}
+
+static void set_ldok(uint8_t module, uint8_t mask) {
+    (void)module;
+    (void)mask;
+}
+
+#endif
+
+// Make a channel's written counts the ones the timer generates
+static void latch_channel(pwm_channel_t* ch) {
+    const pwm_route_t* route = ch->route;
+    if (route->timer == PWM_TIMER_FLEXPWM) {
+        set_ldok(route->module, 1 << route->sub);
+    } else {
+        write_compare(ch);
+    }
+    #ifndef ARDUINO
+    sim_output[ch - channels] = ch->counts;
+    #endif
+    latch_count++;
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void pwm_driver_init(void) {
+    channel_count = 0;
+    deferring = 0;
+    latch_count = 0;
+    for (uint8_t m = 0; m < PWM_MODULE_COUNT; m++) {
+        pending_ldok[m] = 0;
+    }
+}
+
+int8_t pwm_driver_attach(uint8_t pin, uint32_t frequency_hz) {
+    const pwm_route_t* route = find_route(pin);
+    if (route == nullptr || channel_count >= PWM_DRIVER_MAX_CHANNELS || frequency_hz == 0) {
+        return -1;
+    }
+    for (uint8_t i = 0; i < channel_count; i++) {
+        if (channels[i].route == route) {
+            return i;
+        }
+    }
+
+    #ifdef ARDUINO
+    // The core selects the prescaler and muxes the pin to the timer
+    analogWriteFrequency(pin, frequency_hz);
+    analogWrite(pin, 0);
+    #endif
+
+    uint8_t slot = channel_count;
+    pwm_channel_t* ch = &channels[slot];
+    ch->route = route;
+    ch->period = read_period(route, frequency_hz);
+    ch->counts = 0;
+    ch->pending = 0;
+    #ifndef ARDUINO
+    sim_output[slot] = 0;
+    #endif
+
+    channel_count++;
+    return slot;
+}
+
+uint32_t pwm_driver_get_period(int8_t channel) {
+    if (channel < 0 || channel >= channel_count) {
+        return 0;
+    }
+    return channels[channel].period;
+}
+
+static void write_channel(int8_t channel, uint32_t counts, uint8_t defer) {
+    if (channel < 0 || channel >= channel_count) {
+        return;
+    }
+    pwm_channel_t* ch = &channels[channel];
+    ch->counts = (counts > ch->period) ? ch->period : counts;
+
+    if (ch->route->timer == PWM_TIMER_FLEXPWM) {
+        write_compare(ch);
+    }
+    if (!defer) {
+        latch_channel(ch);
+    } else {
+        ch->pending = 1;
+    }
+}
+
+void pwm_driver_write(int8_t channel, uint32_t counts) {
+    write_channel(channel, counts, deferring);
+}
+
+void pwm_driver_write_immediate(int8_t channel, uint32_t counts) {
+    write_channel(channel, counts, 0);
+}
+
+void pwm_driver_begin_update(void) {
+    deferring = 1;
+}
+
+void pwm_driver_commit_update(void) {
+    deferring = 0;
+
+    // Collect FlexPWM submodules per module; QuadTimer writes go out now
+    for (uint8_t i = 0; i < channel_count; i++) {
+        pwm_channel_t* ch = &channels[i];
+        if (!ch->pending) {
+            continue;
+        }
+        ch->pending = 0;
+        if (ch->route->timer == PWM_TIMER_FLEXPWM) {
+            pending_ldok[ch->route->module] |= 1 << ch->route->sub;
+            #ifndef ARDUINO
+            sim_output[i] = ch->counts;
+            #endif
+        } else {
+            latch_channel(ch);
+        }
+    }
+
+    // One MCTRL write per module latches its submodules on the same cycle
+    for (uint8_t m = 0; m < PWM_MODULE_COUNT; m++) {
+        if (pending_ldok[m] != 0) {
+            set_ldok(m, pending_ldok[m]);
+            pending_ldok[m] = 0;
+            latch_count++;
+        }
+    }
+}
+
+uint8_t pwm_driver_get_channel_count(void) {
+    return channel_count;
+}
+
+uint32_t pwm_driver_get_latch_count(void) {
+    return latch_count;
+}
+
+#ifdef TESTING
+uint32_t pwm_driver_get_output_counts_for_testing(int8_t channel) {
+    if (channel < 0 || channel >= channel_count) {
+        return 0;
+    }
+    return sim_output[channel];
+}
+#endif
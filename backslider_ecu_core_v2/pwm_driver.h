@@ -0,0 +1,81 @@
+// pwm_driver.h
+// Direct-register PWM outputs on i.MX RT FlexPWM and QuadTimer channels
+
+/* =============================================================================
+ * PWM DRIVER OVERVIEW
+ * =============================================================================
+ *
+ * analogWrite() recomputes the channel's counts from the global write
+ * resolution on every call, and each call latches its submodule on its own,
+ * so two solenoids changed together can run one PWM period apart. For pins
+ * this driver knows the timer behind, it takes the channel over after the
+ * core has set it up:
+ *
+ * - pwm_driver_attach() lets analogWriteFrequency()/analogWrite() pick the
+ *   prescaler and pin mux, then reads the period back from the timer. The
+ *   caller converts a duty to counts once with that period; a duty update is
+ *   then one compare register write plus the latch.
+ * - FlexPWM compare registers are double buffered and only take effect when
+ *   the submodule's LDOK bit is set. Between pwm_driver_begin_update() and
+ *   pwm_driver_commit_update() writes leave LDOK alone, and the commit sets
+ *   every written submodule's LDOK in one MCTRL write per module, so all of
+ *   them switch on the same PWM cycle boundary.
+ * - QuadTimer channels have no LDOK; their LOAD/CMPLD1 pair is reloaded at
+ *   the next compare. Deferred QuadTimer writes are held and written back to
+ *   back at the commit.
+ *
+ * Outside an update bracket every write latches immediately.
+ *
+ * Only the A/B outputs of FlexPWM submodules and QuadTimer outputs are
+ * handled; other PWM pins (FlexPWM X outputs, pins without a table entry)
+ * return -1 from pwm_driver_attach() and stay on analogWrite().
+ *
+ * In the current pin map the transmission pressure solenoid (22) is
+ * FlexPWM4 submodule 0 A, and the lockup (18) and overrun (19) solenoids
+ * are QuadTimer3 channels 1 and 0.
+ * =============================================================================
+ */
+
+#ifndef PWM_DRIVER_H
+#define PWM_DRIVER_H
+
+#include <stdint.h>
+
+#define PWM_DRIVER_MAX_CHANNELS 16
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Forget all attached channels
+void pwm_driver_init(void);
+
+// Set a pin up for PWM at frequency_hz and take it over. Returns the
+// channel handle, or -1 if the pin has no supported timer (or the table is
+// full). The output starts at 0% duty.
+int8_t pwm_driver_attach(uint8_t pin, uint32_t frequency_hz);
+
+// Counts for 100% duty on a channel; 0 for an invalid handle
+uint32_t pwm_driver_get_period(int8_t channel);
+
+// Set a channel's high time in counts (clamped to the period)
+void pwm_driver_write(int8_t channel, uint32_t counts);
+
+// Write and latch now, ignoring any update bracket. For a timer ISR that
+// owns the channel (output_ramp); nothing else may write that channel
+void pwm_driver_write_immediate(int8_t channel, uint32_t counts);
+
+// Hold latches until the commit so the writes in between switch together
+void pwm_driver_begin_update(void);
+void pwm_driver_commit_update(void);
+
+// Diagnostics
+uint8_t pwm_driver_get_channel_count(void);
+uint32_t pwm_driver_get_latch_count(void);     // LDOK sets and QuadTimer reloads issued
+
+#ifdef TESTING
+// Counts the simulated timer is generating (written and latched)
+uint32_t pwm_driver_get_output_counts_for_testing(int8_t channel);
+#endif
+
+#endif
@@ -9,70 +9,101 @@
     #include "tests/mock_arduino.h"
 #endif
 
+static_assert(RequestTracker::REQUEST_ID_SPACE % RequestTracker::MAX_CAPACITY == 0,
+              "Request IDs must wrap on a slot boundary");
+
 // =============================================================================
 // CONSTRUCTOR
 // =============================================================================
 
-RequestTracker::RequestTracker() : 
+RequestTracker::RequestTracker(uint8_t capacity) : 
+    capacity(MAX_PENDING),
     pending_count(0),
-    request_id_counter(0),
+    next_sequence(0),
+    oldest_sequence(0),
     timeout_count(0),
+    eviction_count(0),
     total_requests(0)
 {
-    // Initialize all pending requests as inactive
-    for (uint8_t i = 0; i < MAX_PENDING; i++) {
+    set_capacity(capacity);
+}
+
+void RequestTracker::set_capacity(uint8_t requested) {
+    // Round up to a power of two within the table
+    uint8_t slots = 1;
+    while (slots < requested && slots < MAX_CAPACITY) {
+        slots <<= 1;
+    }
+    capacity = slots;
+    clear();
+}
+
+void RequestTracker::clear() {
+    for (uint8_t i = 0; i < MAX_CAPACITY; i++) {
         pending[i].active = false;
     }
+    pending_count = 0;
+    oldest_sequence = next_sequence;
 }
 
 // =============================================================================
 // REQUEST MANAGEMENT
 // =============================================================================
 
-void RequestTracker::add_request(uint8_t channel, uint32_t param_id) {
-    if (pending_count >= MAX_PENDING) {
-        // Remove oldest request to make room
-        remove_request_by_index(0);
-    }
+uint8_t RequestTracker::add_request(uint8_t channel, uint32_t param_id) {
+    uint32_t sequence = next_sequence;
+    uint8_t request_id = get_next_request_id();
+    PendingRequest& slot = pending[slot_of(request_id)];
     
-    // Find first inactive slot
-    uint8_t slot = 0;
-    for (uint8_t i = 0; i < MAX_PENDING; i++) {
-        if (!pending[i].active) {
-            slot = i;
-            break;
-        }
+    // The slot's last request is the oldest one; make room by dropping it
+    if (slot.active) {
+        slot.active = false;
+        pending_count--;
+        eviction_count++;
     }
     
     // Add new request
-    pending[slot].request_id = get_next_request_id();
-    pending[slot].source_channel = channel;
-    pending[slot].param_id = param_id;
-    pending[slot].timestamp = millis();
-    pending[slot].active = true;
+    slot.request_id = request_id;
+    slot.source_channel = channel;
+    slot.param_id = param_id;
+    slot.timestamp = millis();
+    slot.sequence = sequence;
+    slot.active = true;
     
     pending_count++;
     total_requests++;
+    return request_id;
 }
 
 void RequestTracker::remove_request(uint8_t request_id, uint8_t channel) {
-    uint8_t index = find_request_index(request_id, channel);
-    if (index < MAX_PENDING) {
-        remove_request_by_index(index);
+    PendingRequest* request = const_cast<PendingRequest*>(find_request(request_id, channel));
+    if (request != nullptr) {
+        request->active = false;
+        pending_count--;
     }
 }
 
 void RequestTracker::cleanup_timeouts(uint32_t timeout_ms) {
     uint32_t current_time = millis();
     
-    for (uint8_t i = 0; i < MAX_PENDING; i++) {
-        if (pending[i].active) {
-            if ((current_time - pending[i].timestamp) > timeout_ms) {
-                // Request has timed out
-                remove_request_by_index(i);
-                timeout_count++;
+    // Anything older than one lap of the ring was overwritten or removed
+    if (next_sequence - oldest_sequence > capacity) {
+        oldest_sequence = next_sequence - capacity;
+    }
+    
+    // Oldest first; the first request still in time ends the walk
+    while (oldest_sequence != next_sequence && pending_count > 0) {
+        PendingRequest& request = pending[oldest_sequence & (capacity - 1)];
+        if (request.active && request.sequence == oldest_sequence) {
+            if ((current_time - request.timestamp) <= timeout_ms) {
+                return;
             }
+            // Request has timed out
+            request.active = false;
+            pending_count--;
+            timeout_count++;
         }
+        oldest_sequence++;
     }
 }
 
@@ -81,11 +112,8 @@ void RequestTracker::cleanup_timeouts(uint32_t timeout_ms) {
 // =============================================================================
 
 uint8_t RequestTracker::get_next_request_id() {
-    request_id_counter++;
-    if (request_id_counter == 0) {
-        request_id_counter = 1; // Skip 0 to avoid confusion
-    }
-    return request_id_counter;
+    // IDs 1..REQUEST_ID_SPACE; 0 is never used to avoid confusion
+    return (uint8_t)(next_sequence++ % REQUEST_ID_SPACE + 1);
 }
 
 // =============================================================================
@@ -93,14 +121,13 @@ uint8_t RequestTracker::get_next_request_id() {
 // =============================================================================
 
 bool RequestTracker::is_pending_request(uint8_t request_id, uint8_t channel) const {
-    uint8_t index = find_request_index(request_id, channel);
-    return (index < MAX_PENDING);
+    return find_request(request_id, channel) != nullptr;
 }
 
 uint32_t RequestTracker::get_pending_param_id(uint8_t request_id, uint8_t channel) const {
-    uint8_t index = find_request_index(request_id, channel);
-    if (index < MAX_PENDING) {
-        return pending[index].param_id;
+    const PendingRequest* request = find_request(request_id, channel);
+    if (request != nullptr) {
+        return request->param_id;
     }
     return 0; // Invalid parameter ID
 }
@@ -111,6 +138,7 @@ uint32_t RequestTracker::get_pending_param_id(uint8_t request_id, uint8_t channe
 
 void RequestTracker::reset_statistics() {
     timeout_count = 0;
+    eviction_count = 0;
     total_requests = 0;
 }
 
@@ -118,31 +146,13 @@ void RequestTracker::reset_statistics() {
 // PRIVATE HELPER METHODS
 // =============================================================================
 
-void RequestTracker::remove_request_by_index(uint8_t index) {
-    if (index >= MAX_PENDING || !pending[index].active) {
-        return;
+const PendingRequest* RequestTracker::find_request(uint8_t request_id, uint8_t channel) const {
+    if (request_id == 0 || request_id > REQUEST_ID_SPACE) {
+        return nullptr;
     }
-    
-    // Mark as inactive
-    pending[index].active = false;
-    pending_count--;
-    
-    // Compact the array by moving active requests to the front
-    for (uint8_t i = index; i < MAX_PENDING - 1; i++) {
-        if (pending[i + 1].active) {
-            pending[i] = pending[i + 1];
-            pending[i + 1].active = false;
-        }
+    const PendingRequest& request = pending[slot_of(request_id)];
+    if (request.active && request.request_id == request_id && request.source_channel == channel) {
+        return &request;
     }
+    return nullptr;
 }
-
-uint8_t RequestTracker::find_request_index(uint8_t request_id, uint8_t channel) const {
-    for (uint8_t i = 0; i < MAX_PENDING; i++) {
-        if (pending[i].active && 
-            pending[i].request_id == request_id && 
-            pending[i].source_channel == channel) {
-            return i;
-        }
-    }
-    return MAX_PENDING; // Not found
-} 
\ No newline at end of file
@@ -1,6 +1,18 @@
 // request_tracker.h
 // Request tracking system for external communication channels
 // Tracks pending parameter requests to enable proper response routing
+//
+// Each channel's router owns a tracker and hands out its request IDs in
+// sequence, so the slot of a request follows from its ID: the table is a
+// ring of `capacity` slots (a power of two) and request N lives in slot
+// (N - 1) % capacity. Lookup and removal go straight to that slot. IDs run
+// 1..REQUEST_ID_SPACE, a multiple of every capacity, so the mapping holds
+// across the wrap.
+//
+// Because IDs are issued in time order, the ring is also sorted by age: a
+// new request lands on the slot of the one issued `capacity` requests ago
+// (evicting it if it is still pending), and cleanup_timeouts() walks from
+// the oldest and stops at the first request still within its time.
 
 #ifndef REQUEST_TRACKER_H
 #define REQUEST_TRACKER_H
@@ -18,6 +30,7 @@ struct PendingRequest {
     uint8_t source_channel;
     uint32_t param_id;
     uint32_t timestamp;
+    uint32_t sequence;          // Issue order, tells a live slot from a reused one
     bool active;
 };
 
@@ -28,18 +41,24 @@ struct PendingRequest {
 class RequestTracker {
 public:
     // Configuration constants
-    static const uint8_t MAX_PENDING = 16;
+    static const uint8_t MAX_PENDING = 16;          // Default capacity
+    static const uint8_t MAX_CAPACITY = 64;
+    static const uint8_t REQUEST_ID_SPACE = 192;    // Multiple of MAX_CAPACITY
     static const uint32_t DEFAULT_TIMEOUT_MS = 5000; // 5 second timeout
     
-    // Constructor
-    RequestTracker();
+    // Constructor; capacity is rounded up to a power of two
+    RequestTracker(uint8_t capacity = MAX_PENDING);
     
-    // Request management
-    void add_request(uint8_t channel, uint32_t param_id);
+    // Slots for this channel; drops anything pending
+    void set_capacity(uint8_t capacity);
+    uint8_t get_capacity() const { return capacity; }
+    
+    // Request management; add_request() returns the request ID it assigned
+    uint8_t add_request(uint8_t channel, uint32_t param_id);
     void remove_request(uint8_t request_id, uint8_t channel);
     void cleanup_timeouts(uint32_t timeout_ms = DEFAULT_TIMEOUT_MS);
     
-    // Request ID generation
+    // Request ID generation, for requests that are not tracked
     uint8_t get_next_request_id();
     
     // Lookup methods
@@ -49,21 +68,26 @@ public:
     // Statistics
     uint8_t get_pending_count() const { return pending_count; }
     uint32_t get_timeout_count() const { return timeout_count; }
+    uint32_t get_eviction_count() const { return eviction_count; }
     void reset_statistics();
     
 private:
     // Request storage
-    PendingRequest pending[MAX_PENDING];
+    PendingRequest pending[MAX_CAPACITY];
+    uint8_t capacity;
     uint8_t pending_count;
-    uint8_t request_id_counter;
+    uint32_t next_sequence;         // Sequence of the next request ID
+    uint32_t oldest_sequence;       // Timeout walk starts here
     
     // Statistics
     uint32_t timeout_count;
+    uint32_t eviction_count;
     uint32_t total_requests;
     
     // Helper methods
-    void remove_request_by_index(uint8_t index);
-    uint8_t find_request_index(uint8_t request_id, uint8_t channel) const;
+    uint8_t slot_of(uint8_t request_id) const { return (uint8_t)((request_id - 1) & (capacity - 1)); }
+    const PendingRequest* find_request(uint8_t request_id, uint8_t channel) const;
+    void clear();
 };
 
-#endif // REQUEST_TRACKER_H 
\ No newline at end of file
+#endif // REQUEST_TRACKER_H 
@@ -0,0 +1,321 @@
+// sd_logger.cpp
+// Double-buffered log blocks, background sector writes and the SDIO sink
+
+#include "sd_logger.h"
+#include "msg_bus.h"
+#include "memory_placement.h"
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+#if defined(ARDUINO) && defined(__IMXRT1062__)
+    #include <SdFat.h>
+#endif
+
+static_assert(SD_LOGGER_BLOCK_SIZE % SD_LOGGER_SECTOR_SIZE == 0, "Blocks are whole sectors");
+static_assert(SD_LOGGER_WRITE_CHUNK % SD_LOGGER_SECTOR_SIZE == 0, "Chunks are whole sectors");
+static_assert(SD_LOGGER_BLOCK_SIZE <= 65535, "sd_log_block_header_t.used is 16 bits");
+static_assert(sizeof(sd_log_block_header_t) == 32, "Header layout is part of the file format");
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+// OCRAM: 64 KB is too much to take out of DTCM, and only memcpy touches it
+static uint8_t blocks[2][SD_LOGGER_BLOCK_SIZE] ECU_COLD_DATA __attribute__((aligned(32)));
+
+static bool block_sealed[2];            // Waiting for (or being written to) the card
+static uint8_t fill_block;              // Block the hot path appends to
+static bool fill_open;                  // False once it is sealed, until the next record
+static uint16_t fill_used;
+static uint16_t fill_records;
+static uint32_t fill_first_us;
+static uint8_t write_block;             // Oldest sealed block
+static uint32_t write_offset;
+static uint32_t write_length;
+static uint32_t block_sequence;
+
+static const sd_logger_sink_t* active_sink = nullptr;
+static bool logging = false;
+
+static struct {
+    uint32_t pattern;
+    uint32_t mask;
+} filters[SD_LOGGER_MAX_FILTERS];
+static uint8_t filter_count = 0;
+
+static sd_logger_stats_t stats;
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static void open_block(uint8_t index) {
+    fill_block = index;
+    fill_open = true;
+    fill_used = sizeof(sd_log_block_header_t);
+    fill_records = 0;
+}
+
+static void seal_fill_block(void) {
+    uint8_t* block = blocks[fill_block];
+    sd_log_block_header_t header = {};
+    header.magic = SD_LOGGER_BLOCK_MAGIC;
+    header.sequence = block_sequence++;
+    header.first_us = fill_first_us;
+    header.dropped = stats.dropped;
+    header.used = fill_used;
+    header.records = fill_records;
+    memcpy(block, &header, sizeof(header));
+
+    // Zero the tail of the last sector so stale bytes never look like records
+    uint32_t length = (fill_used + SD_LOGGER_SECTOR_SIZE - 1) & ~(uint32_t)(SD_LOGGER_SECTOR_SIZE - 1);
+    memset(block + fill_used, 0, length - fill_used);
+
+    block_sealed[fill_block] = true;
+    fill_open = false;
+    if (!block_sealed[fill_block ^ 1]) {
+        write_block = fill_block;
+        write_length = length;
+        write_offset = 0;
+    }
+}
+
+// The writer moved on: the other block (if sealed) is next
+static void start_next_write(void) {
+    block_sealed[write_block] = false;
+    write_block ^= 1;
+    write_offset = 0;
+    if (block_sealed[write_block]) {
+        const sd_log_block_header_t* header = (const sd_log_block_header_t*)blocks[write_block];
+        write_length = (header->used + SD_LOGGER_SECTOR_SIZE - 1) & ~(uint32_t)(SD_LOGGER_SECTOR_SIZE - 1);
+    }
+}
+
+// =============================================================================
+// SD CARD SINK (Teensy 4.1 built-in SDIO slot)
+// =============================================================================
+
+#if defined(ARDUINO) && defined(__IMXRT1062__)
+
+static SdFs sd_card;
+static FsFile sd_file;
+static uint64_t sd_file_written = 0;
+
+static bool sd_sink_write(const uint8_t* data, size_t length) {
+    // Sector-aligned buffer at a sector-aligned file position: SdFat
+    // hands it straight to the card as a multi-sector write
+    if (sd_file.write(data, length) != length) {
+        return false;
+    }
+    sd_file_written += length;
+    return true;
+}
+
+static bool sd_sink_busy(void) {
+    return sd_card.card()->isBusy();
+}
+
+static void sd_sink_close(void) {
+    // Give back the unused part of the pre-allocation
+    sd_file.truncate(sd_file_written);
+    sd_file.close();
+}
+
+static const sd_logger_sink_t sd_sink = {sd_sink_write, sd_sink_busy, sd_sink_close};
+
+#endif
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+ECU_COLD_CODE void sd_logger_init(void) {
+    logging = false;
+    active_sink = nullptr;
+    block_sealed[0] = block_sealed[1] = false;
+    open_block(0);
+    write_block = 0;
+    write_offset = 0;
+    write_length = 0;
+    block_sequence = 0;
+    filter_count = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+ECU_COLD_CODE bool sd_logger_add_channels(uint32_t id_pattern, uint32_t id_mask) {
+    for (uint8_t i = 0; i < filter_count; i++) {
+        if (filters[i].pattern == (id_pattern & id_mask) && filters[i].mask == id_mask) {
+            return true;    // Already subscribed; a second handler would log twice
+        }
+    }
+    if (filter_count >= SD_LOGGER_MAX_FILTERS ||
+        !g_message_bus.subscribeMasked(id_pattern, id_mask, sd_logger_log_message)) {
+        return false;
+    }
+    filters[filter_count].pattern = id_pattern & id_mask;
+    filters[filter_count].mask = id_mask;
+    filter_count++;
+    return true;
+}
+
+ECU_COLD_CODE bool sd_logger_start(const sd_logger_sink_t* sink) {
+    if (logging || active_sink || !sink || !sink->write) {
+        return false;
+    }
+    active_sink = sink;
+    block_sealed[0] = block_sealed[1] = false;
+    open_block(0);
+    write_block = 0;
+    write_offset = 0;
+    block_sequence = 0;
+    logging = true;
+    return true;
+}
+
+ECU_COLD_CODE bool sd_logger_start_sd(void) {
+#if defined(ARDUINO) && defined(__IMXRT1062__)
+    if (logging || active_sink) {
+        return false;
+    }
+    if (!sd_card.begin(SdioConfig(FIFO_SDIO))) {
+        return false;
+    }
+    char name[16];
+    for (uint16_t n = 1; n < 10000; n++) {
+        snprintf(name, sizeof(name), "LOG%05u.BSL", n);
+        if (!sd_card.exists(name)) {
+            break;
+        }
+    }
+    if (!sd_file.open(&sd_card, name, O_WRONLY | O_CREAT | O_TRUNC)) {
+        return false;
+    }
+    // Contiguous clusters up front: no FAT updates between data writes
+    if (!sd_file.preAllocate(SD_LOGGER_PREALLOCATE)) {
+        sd_file.close();
+        return false;
+    }
+    sd_file_written = 0;
+    return sd_logger_start(&sd_sink);
+#else
+    return false;
+#endif
+}
+
+void sd_logger_stop(void) {
+    if (!logging) {
+        return;
+    }
+    logging = false;
+    if (fill_open && fill_records > 0) {
+        seal_fill_block();
+    }
+}
+
+ECU_HOT_CODE void sd_logger_log_message(const CANMessage* msg) {
+    if (!logging) {
+        return;
+    }
+    uint8_t length = msg->len > 8 ? 8 : msg->len;
+    uint32_t stamp_us = msg->timestamp_us;
+
+    if (!fill_open) {
+        // Both blocks waiting on the card: drop rather than wait
+        if (block_sealed[fill_block ^ 1]) {
+            stats.dropped++;
+            return;
+        }
+        open_block(fill_block ^ 1);
+    }
+
+    uint8_t* record = &blocks[fill_block][fill_used];
+    if (fill_records == 0) {
+        fill_first_us = stamp_us;
+    }
+    uint32_t id = msg->id;
+    memcpy(&record[0], &stamp_us, 4);
+    memcpy(&record[4], &id, 4);
+    record[8] = length;
+    memcpy(&record[SD_LOGGER_RECORD_HEADER], msg->buf, length);
+    fill_used += SD_LOGGER_RECORD_HEADER + length;
+    fill_records++;
+    stats.records++;
+
+    if (fill_used + SD_LOGGER_RECORD_MAX > SD_LOGGER_BLOCK_SIZE) {
+        seal_fill_block();
+    }
+}
+
+void sd_logger_update(void) {
+    if (!active_sink) {
+        return;
+    }
+
+    // Quiet log: seal the partial block so it reaches the card
+    if (logging && fill_open && fill_records > 0 && !block_sealed[fill_block ^ 1] &&
+        (uint32_t)(micros() - fill_first_us) >= SD_LOGGER_SEAL_US) {
+        seal_fill_block();
+    }
+
+    if (!block_sealed[write_block]) {
+        if (!logging) {
+            // Stopped and drained
+            if (active_sink->close) {
+                active_sink->close();
+            }
+            active_sink = nullptr;
+        }
+        return;
+    }
+
+    if (active_sink->busy && active_sink->busy()) {
+        stats.busy_deferrals++;
+        return;
+    }
+
+    uint32_t chunk = write_length - write_offset;
+    if (chunk > SD_LOGGER_WRITE_CHUNK) {
+        chunk = SD_LOGGER_WRITE_CHUNK;
+    }
+    uint32_t start_us = micros();
+    bool ok = active_sink->write(&blocks[write_block][write_offset], chunk);
+    uint32_t elapsed_us = micros() - start_us;
+    if (elapsed_us > stats.max_write_us) {
+        stats.max_write_us = elapsed_us;
+    }
+    if (!ok) {
+        // A card that failed once is not trusted with later blocks
+        stats.write_errors++;
+        logging = false;
+        block_sealed[0] = block_sealed[1] = false;
+        open_block(0);
+        write_block = 0;
+        if (active_sink->close) {
+            active_sink->close();
+        }
+        active_sink = nullptr;
+        return;
+    }
+    write_offset += chunk;
+    stats.bytes_written += chunk;
+    if (write_offset >= write_length) {
+        stats.blocks_written++;
+        start_next_write();
+    }
+}
+
+bool sd_logger_is_logging(void) {
+    return logging;
+}
+
+bool sd_logger_is_idle(void) {
+    return !logging && !active_sink;
+}
+
+const sd_logger_stats_t* sd_logger_get_stats(void) {
+    return &stats;
+}
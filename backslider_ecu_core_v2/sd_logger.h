@@ -0,0 +1,143 @@
+// sd_logger.h
+// On-board binary datalogger for the Teensy 4.1 SD slot
+
+/* =============================================================================
+ * SD LOGGER OVERVIEW
+ * =============================================================================
+ *
+ * Logging over serial is capped by the link and lost when the cable is.
+ * The SD logger records bus traffic on the ECU itself:
+ *
+ *   message bus ──masked subscription──► sd_logger_log_message()
+ *                                             │ memcpy into the fill block
+ *                                             ▼
+ *                      ┌──────────────┐  ┌──────────────┐
+ *                      │   block 0    │  │   block 1    │   SD_LOGGER_BLOCK_SIZE each
+ *                      └──────────────┘  └──────────────┘
+ *                                             │ sealed blocks, oldest first
+ *                                             ▼
+ *                 sd_logger_update() ──SD_LOGGER_WRITE_CHUNK──► SDIO card
+ *
+ * HOT PATH: a logged message costs one bounds check and a memcpy of at
+ * most SD_LOGGER_RECORD_MAX bytes into the fill block. When the block is
+ * full it is sealed and the other block becomes the fill block. If the
+ * other block is still waiting for the card, records are dropped and
+ * counted - the logger never waits.
+ *
+ * WRITER: sd_logger_update() runs as a background task. Each call writes
+ * at most one SD_LOGGER_WRITE_CHUNK of the oldest sealed block, and only
+ * when the card reports it is not busy programming, so a slow card stalls
+ * the log (and eventually drops records), never the loop. A partly filled
+ * block is sealed after SD_LOGGER_SEAL_US so a power cut loses at most
+ * that much data; only its used sectors are written.
+ *
+ * Both sides run from the main loop (bus delivery and a background task),
+ * so the blocks need no locking. Do not log from an ISR.
+ *
+ * FILE FORMAT (little-endian): a sequence of blocks, each a whole number
+ * of 512-byte sectors:
+ *
+ *   ┌────────────────────────┬────────┬────────┬─────┬─────────────────┐
+ *   │ sd_log_block_header_t  │ record │ record │ ... │ zero pad to 512 │
+ *   └────────────────────────┴────────┴────────┴─────┴─────────────────┘
+ *   record = [timestamp_us u32][msg_id u32][length u8][length data bytes]
+ *
+ * timestamp_us is the message's publish stamp (ecu_time.h), not the time
+ * it was logged, so bus queueing does not skew the log.
+ *
+ * header.used counts the header and records; the next block starts at
+ * used rounded up to 512. Sequence numbers run on across blocks, and
+ * header.dropped is the running total of records lost before that block,
+ * so gaps are visible to the reader.
+ *
+ * On Teensy 4.1 sd_logger_start_sd() opens the built-in SDIO slot, creates
+ * the next free LOGnnnnn.BSL and pre-allocates it so writes never wait on
+ * the FAT. Desktop builds pass their own sink to sd_logger_start().
+ *
+ * EXAMPLE:
+ *   sd_logger_init();
+ *   sd_logger_add_channels(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, 0),
+ *                          ECU_BASE_MASK | SUBSYSTEM_MASK);
+ *   if (sd_logger_start_sd()) {
+ *       task_executive_add("sd_logger", sd_logger_update, TASK_RATE_BACKGROUND, 500);
+ *   }
+ * =============================================================================
+ */
+
+#ifndef SD_LOGGER_H
+#define SD_LOGGER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "msg_definitions.h"
+
+#define SD_LOGGER_SECTOR_SIZE       512
+#define SD_LOGGER_BLOCK_SIZE        32768       // Per buffer; ~50 ms at 48 channels x 1 kHz
+#define SD_LOGGER_WRITE_CHUNK       4096        // Longest single card write per update()
+#define SD_LOGGER_SEAL_US           1000000     // Oldest record a partial block may hold
+#define SD_LOGGER_MAX_FILTERS       8
+#define SD_LOGGER_BLOCK_MAGIC       0x474C5342  // "BSLG"
+#define SD_LOGGER_RECORD_HEADER     9
+#define SD_LOGGER_RECORD_MAX        (SD_LOGGER_RECORD_HEADER + 8)
+#define SD_LOGGER_PREALLOCATE       (1024ULL * 1024 * 1024)    // Bytes reserved per file
+
+typedef struct {
+    uint32_t magic;             // SD_LOGGER_BLOCK_MAGIC
+    uint32_t sequence;          // Block number within the file
+    uint32_t first_us;          // Publish stamp of the block's first record
+    uint32_t dropped;           // Records dropped before this block (running total)
+    uint16_t used;              // Header plus record bytes
+    uint16_t records;
+    uint8_t reserved[12];
+} __attribute__((packed)) sd_log_block_header_t;
+
+// Where sealed blocks go. write() is given whole sectors and returns false
+// on a card error; busy() (optional) says the card is still programming;
+// close() (optional) runs once the last block is written after a stop.
+typedef struct {
+    bool (*write)(const uint8_t* data, size_t length);
+    bool (*busy)(void);
+    void (*close)(void);
+} sd_logger_sink_t;
+
+typedef struct {
+    uint32_t records;           // Records accepted
+    uint32_t dropped;           // Records lost to a full pair of blocks
+    uint32_t blocks_written;
+    uint32_t bytes_written;
+    uint32_t busy_deferrals;    // update() calls that found the card busy
+    uint32_t write_errors;      // Logging stops at the first one
+    uint32_t max_write_us;      // Longest single sink write
+} sd_logger_stats_t;
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Stop logging and clear blocks, filters and counters
+void sd_logger_init(void);
+
+// Log every bus message where (id & id_mask) == (id_pattern & id_mask).
+// Returns false when SD_LOGGER_MAX_FILTERS are in use or the bus is full.
+bool sd_logger_add_channels(uint32_t id_pattern, uint32_t id_mask);
+
+// Start a log into sink; false if already logging
+bool sd_logger_start(const sd_logger_sink_t* sink);
+
+// Start a log on the built-in SD card; false without a card (or on desktop)
+bool sd_logger_start_sd(void);
+
+// Seal what is buffered; update() writes it out and closes the sink
+void sd_logger_stop(void);
+
+// Hot path: append one record (the bus handler; callable directly)
+void sd_logger_log_message(const CANMessage* msg);
+
+// Background writer: at most one chunk per call
+void sd_logger_update(void);
+
+bool sd_logger_is_logging(void);
+bool sd_logger_is_idle(void);           // Stopped and nothing left to write
+const sd_logger_stats_t* sd_logger_get_stats(void);
+
+#endif
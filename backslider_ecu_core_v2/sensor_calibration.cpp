@@ -5,6 +5,7 @@
 // Easy to modify calibration without affecting core sensor logic.
 
 #include "sensor_calibration.h"
+#include "memory_placement.h"
 #include <math.h>
 
 #if defined(ARDUINO) && !defined(TESTING)
@@ -17,46 +18,97 @@
 
 // Standard automotive thermistor calibration (Bosch-style)
 // Assumes 2.2kΩ pullup resistor to 5V supply
-const float STANDARD_THERMISTOR_VOLTAGE_TABLE[] = {
+constexpr float STANDARD_THERMISTOR_VOLTAGE_TABLE[] = {
     0.25f, 0.5f, 1.0f, 1.5f, 2.0f, 2.5f, 3.0f, 3.5f, 4.0f, 4.5f
 };
 
-const float STANDARD_THERMISTOR_TEMP_TABLE[] = {
+constexpr float STANDARD_THERMISTOR_TEMP_TABLE[] = {
     120.0f, 100.0f, 80.0f, 60.0f, 40.0f, 20.0f, 0.0f, -20.0f, -40.0f, -60.0f
 };
 
-const uint8_t STANDARD_THERMISTOR_TABLE_SIZE = 
+constexpr uint8_t STANDARD_THERMISTOR_TABLE_SIZE = 
     sizeof(STANDARD_THERMISTOR_VOLTAGE_TABLE) / sizeof(float);
 
 // GM-style coolant temperature sensor
-const float GM_CTS_VOLTAGE_TABLE[] = {
+constexpr float GM_CTS_VOLTAGE_TABLE[] = {
     0.3f, 0.6f, 1.2f, 1.8f, 2.4f, 3.0f, 3.6f, 4.2f, 4.7f
 };
 
-const float GM_CTS_TEMP_TABLE[] = {
+constexpr float GM_CTS_TEMP_TABLE[] = {
     130.0f, 110.0f, 85.0f, 60.0f, 35.0f, 15.0f, -5.0f, -25.0f, -40.0f
 };
 
-const uint8_t GM_CTS_TABLE_SIZE = 
+constexpr uint8_t GM_CTS_TABLE_SIZE = 
     sizeof(GM_CTS_VOLTAGE_TABLE) / sizeof(float);
 
 // Generic IAT sensor (similar characteristics to CTS)
-const float GENERIC_IAT_VOLTAGE_TABLE[] = {
+constexpr float GENERIC_IAT_VOLTAGE_TABLE[] = {
     0.25f, 0.5f, 1.0f, 1.5f, 2.0f, 2.5f, 3.0f, 3.5f, 4.0f, 4.5f
 };
 
-const float GENERIC_IAT_TEMP_TABLE[] = {
+constexpr float GENERIC_IAT_TEMP_TABLE[] = {
     120.0f, 100.0f, 80.0f, 60.0f, 40.0f, 20.0f, 0.0f, -20.0f, -40.0f, -60.0f
 };
 
-const uint8_t GENERIC_IAT_TABLE_SIZE = 
+constexpr uint8_t GENERIC_IAT_TABLE_SIZE = 
     sizeof(GENERIC_IAT_VOLTAGE_TABLE) / sizeof(float);
 
+// =============================================================================
+// COUNTS-DOMAIN LOOKUP TABLES
+// =============================================================================
+
+// The standard tables are resampled at uniform count steps by the compiler,
+// so they cost flash only. Other tables can be resampled at boot with
+// generate_thermistor_counts_lut().
+namespace {
+
+// Interpolation usable in constant expressions (ascending voltage tables)
+constexpr float lut_segment(const float* volts, const float* temps, uint8_t size, float v, uint8_t i) {
+    return (i >= size - 1) ? temps[size - 1]
+         : (v <= volts[i + 1]) ? temps[i] + (v - volts[i]) * (temps[i + 1] - temps[i]) / (volts[i + 1] - volts[i])
+         : lut_segment(volts, temps, size, v, i + 1);
+}
+
+constexpr float lut_value_at(const float* volts, const float* temps, uint8_t size, float v) {
+    return (v <= volts[0]) ? temps[0] : lut_segment(volts, temps, size, v, 0);
+}
+
+constexpr float lut_entry(const float* volts, const float* temps, uint8_t size, unsigned index) {
+    return lut_value_at(volts, temps, size, (index << THERMISTOR_LUT_SHIFT) * ADC_VOLTAGE_REF / ADC_RESOLUTION);
+}
+
+template<unsigned... I> struct lut_indices {};
+template<unsigned N, unsigned... I> struct make_lut_indices : make_lut_indices<N - 1, N - 1, I...> {};
+template<unsigned... I> struct make_lut_indices<0, I...> { typedef lut_indices<I...> type; };
+
+template<const float* VOLTS, const float* TEMPS, uint8_t SIZE,
+         typename INDICES = typename make_lut_indices<THERMISTOR_LUT_SIZE>::type>
+struct counts_lut;
+
+template<const float* VOLTS, const float* TEMPS, uint8_t SIZE, unsigned... I>
+struct counts_lut<VOLTS, TEMPS, SIZE, lut_indices<I...> > {
+    static constexpr float values[THERMISTOR_LUT_SIZE] = { lut_entry(VOLTS, TEMPS, SIZE, I)... };
+};
+
+template<const float* VOLTS, const float* TEMPS, uint8_t SIZE, unsigned... I>
+constexpr float counts_lut<VOLTS, TEMPS, SIZE, lut_indices<I...> >::values[THERMISTOR_LUT_SIZE];
+
+} // namespace
+
+const float* const STANDARD_THERMISTOR_COUNTS_LUT = counts_lut<
+    STANDARD_THERMISTOR_VOLTAGE_TABLE, STANDARD_THERMISTOR_TEMP_TABLE, STANDARD_THERMISTOR_TABLE_SIZE>::values;
+
+const float* const GM_CTS_COUNTS_LUT = counts_lut<
+    GM_CTS_VOLTAGE_TABLE, GM_CTS_TEMP_TABLE, GM_CTS_TABLE_SIZE>::values;
+
+const float* const GENERIC_IAT_COUNTS_LUT = counts_lut<
+    GENERIC_IAT_VOLTAGE_TABLE, GENERIC_IAT_TEMP_TABLE, GENERIC_IAT_TABLE_SIZE>::values;
+
 // =============================================================================
 // CALIBRATION FUNCTIONS
 // =============================================================================
 
-float calibrate_linear(const linear_config_t* config, float voltage) {
+ECU_HOT_CODE float calibrate_linear(const linear_config_t* config, float voltage) {
     if (config == nullptr) return 0.0f;
     
     // Handle out-of-range inputs
@@ -75,7 +127,7 @@ float calibrate_linear(const linear_config_t* config, float voltage) {
     return config->min_value + (ratio * value_range);
 }
 
-float calibrate_thermistor(const thermistor_config_t* config, float voltage) {
+ECU_HOT_CODE float calibrate_thermistor(const thermistor_config_t* config, float voltage) {
     if (config == nullptr || config->voltage_table == nullptr || config->temp_table == nullptr) {
         return 20.0f;  // Default room temperature
     }
@@ -103,7 +155,22 @@ float calibrate_thermistor(const thermistor_config_t* config, float voltage) {
                            config->table_size, voltage);
 }
 
-float calibrate_digital(const digital_config_t* config, uint8_t digital_value) {
+ECU_HOT_CODE float calibrate_thermistor_counts(const thermistor_config_t* config, uint16_t counts) {
+    if (config == nullptr || config->counts_lut == nullptr) {
+        return calibrate_thermistor(config, (counts * ADC_VOLTAGE_REF) / ADC_RESOLUTION);
+    }
+
+    if (counts > (uint16_t)ADC_RESOLUTION) {
+        counts = (uint16_t)ADC_RESOLUTION;
+    }
+    const float* lut = config->counts_lut;
+    uint16_t index = counts >> THERMISTOR_LUT_SHIFT;
+    uint16_t fraction = counts & ((1u << THERMISTOR_LUT_SHIFT) - 1);
+    float lower = lut[index];
+    return lower + (lut[index + 1] - lower) * (fraction * (1.0f / (1u << THERMISTOR_LUT_SHIFT)));
+}
+
+ECU_HOT_CODE float calibrate_digital(const digital_config_t* config, uint8_t digital_value) {
     if (config == nullptr) return 0.0f;
     
     // Convert to 0 or 1 (normalize any non-zero value to 1)
@@ -117,16 +184,59 @@ float calibrate_digital(const digital_config_t* config, uint8_t digital_value) {
     return static_cast<float>(normalized_value);
 }
 
-float calibrate_frequency(const frequency_config_t* config, uint32_t frequency_hz) {
+ECU_HOT_CODE float calibrate_frequency(const frequency_config_t* config, uint32_t frequency_hz) {
+    return calibrate_frequency_hz(config, static_cast<float>(frequency_hz));
+}
+
+ECU_HOT_CODE float calibrate_frequency_hz(const frequency_config_t* config, float frequency_hz) {
     if (config == nullptr) return 0.0f;
     
     // Convert frequency to meaningful units (RPM, speed, etc.)
     // For RPM: RPM = (frequency_hz * 60 seconds/minute) / pulses_per_revolution
     // For other sensors: adjust based on scaling_factor
-    float base_value = (static_cast<float>(frequency_hz) * 60.0f) / config->pulses_per_unit;
+    float base_value = (frequency_hz * 60.0f) / config->pulses_per_unit;
     return base_value * config->scaling_factor;
 }
 
+// =============================================================================
+// FIXED-POINT CALIBRATION
+// =============================================================================
+
+static bool to_fixed(double value, uint8_t fraction_bits, int32_t* out) {
+    double scaled = value * (double)(1UL << fraction_bits);
+    if (scaled >= 2147483647.0 || scaled <= -2147483648.0) {
+        return false;
+    }
+    *out = (int32_t)(scaled >= 0 ? scaled + 0.5 : scaled - 0.5);
+    return true;
+}
+
+bool calibrate_linear_fixed_prepare(const linear_config_t* config, linear_fixed_t* fixed) {
+    if (config == nullptr || fixed == nullptr || config->max_voltage <= config->min_voltage) {
+        return false;
+    }
+    
+    // value(counts) = min_value + (counts * volts_per_count - min_voltage) * value_per_volt
+    double volts_per_count = (double)ADC_VOLTAGE_REF / ADC_RESOLUTION;
+    double value_per_volt = ((double)config->max_value - config->min_value) /
+                            ((double)config->max_voltage - config->min_voltage);
+    double slope = volts_per_count * value_per_volt;
+    double offset = config->min_value - config->min_voltage * value_per_volt;
+    
+    // Clamping the output is equivalent to clamping the voltage (monotonic map)
+    double low = config->min_value < config->max_value ? config->min_value : config->max_value;
+    double high = config->min_value < config->max_value ? config->max_value : config->min_value;
+    
+    return to_fixed(slope, 24, &fixed->slope_q24) &&
+           to_fixed(offset, 16, &fixed->offset) &&
+           to_fixed(low, 16, &fixed->min_value) &&
+           to_fixed(high, 16, &fixed->max_value);
+}
+
+q16_16_t filter_alpha_fixed(uint8_t filter_strength) {
+    return (q16_16_t)((((uint32_t)(255 - filter_strength) << 16) + 127) / 255);
+}
+
 // =============================================================================
 // UTILITY FUNCTIONS
 // =============================================================================
@@ -197,6 +307,7 @@ float calculate_thermistor_resistance(float voltage, uint16_t pullup_ohms, float
 uint8_t validate_calibrated_reading(sensor_type_t type, float value) {
     switch (type) {
         case SENSOR_ANALOG_LINEAR:
+        case SENSOR_I2C_ADC:
             // Generic validation - could be made more specific per sensor
             return (value >= -1000.0f && value <= 10000.0f) ? 1 : 0;
             
@@ -29,6 +29,12 @@ extern const float GENERIC_IAT_VOLTAGE_TABLE[];
 extern const float GENERIC_IAT_TEMP_TABLE[];
 extern const uint8_t GENERIC_IAT_TABLE_SIZE;
 
+// The tables above resampled into THERMISTOR_LUT_SIZE counts-indexed entries
+// (built at compile time) for thermistor_config_t.counts_lut
+extern const float* const STANDARD_THERMISTOR_COUNTS_LUT;
+extern const float* const GM_CTS_COUNTS_LUT;
+extern const float* const GENERIC_IAT_COUNTS_LUT;
+
 // =============================================================================
 // CALIBRATION FUNCTIONS
 // =============================================================================
@@ -39,12 +45,58 @@ float calibrate_linear(const linear_config_t* config, float voltage);
 // Thermistor calibration with lookup table interpolation
 float calibrate_thermistor(const thermistor_config_t* config, float voltage);
 
+// Thermistor calibration from raw ADC counts: one shift, index and lerp
+// through config->counts_lut, or calibrate_thermistor() when it has none
+float calibrate_thermistor_counts(const thermistor_config_t* config, uint16_t counts);
+
 // Digital sensor calibration (mostly just validation)
 float calibrate_digital(const digital_config_t* config, uint8_t digital_value);
 
 // Frequency sensor calibration
 float calibrate_frequency(const frequency_config_t* config, uint32_t frequency_hz);
 
+// Frequency sensor calibration from a fractional frequency (input capture)
+float calibrate_frequency_hz(const frequency_config_t* config, float frequency_hz);
+
+// =============================================================================
+// FIXED-POINT CALIBRATION (Q16.16)
+// =============================================================================
+
+// Signed 16.16 fixed point: value = raw / 65536, range about +/-32767
+typedef int32_t q16_16_t;
+
+#define Q16_16_ONE            65536
+#define Q16_16_TO_FLOAT(q)    ((float)(q) * (1.0f / 65536.0f))
+
+// Linear calibration rewritten in the ADC counts domain
+typedef struct {
+    q16_16_t offset;        // Value at 0 counts
+    int32_t slope_q24;      // Value per ADC count, Q8.24 (extra bits keep full-scale error < 0.001)
+    q16_16_t min_value;     // Output clamp, lower
+    q16_16_t max_value;     // Output clamp, upper
+} linear_fixed_t;
+
+// Precompute counts-domain coefficients for a linear config (registration
+// time - uses divisions). Returns false if the range does not fit Q16.16.
+bool calibrate_linear_fixed_prepare(const linear_config_t* config, linear_fixed_t* fixed);
+
+// EMA weight for new samples, (255 - filter_strength) / 255 in Q16.16
+q16_16_t filter_alpha_fixed(uint8_t filter_strength);
+
+// Same result as calibrate_linear() on adc_counts_to_voltage(counts):
+// one multiply-add and a clamp
+static inline q16_16_t calibrate_linear_fixed(const linear_fixed_t* fixed, uint16_t counts) {
+    int64_t value = (int64_t)fixed->offset + (((int64_t)counts * fixed->slope_q24) >> 8);
+    if (value < fixed->min_value) return fixed->min_value;
+    if (value > fixed->max_value) return fixed->max_value;
+    return (q16_16_t)value;
+}
+
+// One low-pass step: previous + alpha * (sample - previous)
+static inline q16_16_t apply_filter_fixed(q16_16_t previous, q16_16_t sample, q16_16_t alpha) {
+    return previous + (q16_16_t)((((int64_t)sample - previous) * alpha) >> 16);
+}
+
 // =============================================================================
 // UTILITY FUNCTIONS
 // =============================================================================
@@ -0,0 +1,59 @@
+// serial_link.cpp
+// CRC-16 and COBS for link protocol v2 frames
+
+#include "serial_link.h"
+
+uint16_t serial_link_crc16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t serial_link_cobs_encode(const uint8_t* in, size_t length, uint8_t* out) {
+    size_t code_pos = 0;
+    size_t out_pos = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < length; i++) {
+        if (in[i] == 0) {
+            out[code_pos] = code;
+            code_pos = out_pos++;
+            code = 1;
+            continue;
+        }
+        out[out_pos++] = in[i];
+        if (++code == 0xFF) {
+            out[code_pos] = code;
+            code_pos = out_pos++;
+            code = 1;
+        }
+    }
+    out[code_pos] = code;
+    return out_pos;
+}
+
+size_t serial_link_cobs_decode(uint8_t* buffer, size_t length) {
+    // Output never overtakes input, so decoding in place is safe
+    size_t in_pos = 0;
+    size_t out_pos = 0;
+    while (in_pos < length) {
+        uint8_t code = buffer[in_pos++];
+        if (code == 0) {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            if (in_pos >= length || buffer[in_pos] == 0) {
+                return 0;
+            }
+            buffer[out_pos++] = buffer[in_pos++];
+        }
+        if (code < 0xFF && in_pos < length) {
+            buffer[out_pos++] = 0;
+        }
+    }
+    return out_pos;
+}
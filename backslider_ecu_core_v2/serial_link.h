@@ -0,0 +1,35 @@
+// serial_link.h
+// Link protocol v2 wire format and framing helpers
+//
+// The frame and record layout is described in external_serial.h. Nothing
+// here touches a port or the message bus, so host-side tools (host/) link
+// the same CRC and COBS code the bridges use.
+
+#ifndef SERIAL_LINK_H
+#define SERIAL_LINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Link protocol v2 framing
+#define SERIAL_LINK_VERSION_LEGACY  1
+#define SERIAL_LINK_VERSION_FRAMED  2
+#define SERIAL_LINK_MIN_MTU         32
+#define SERIAL_LINK_MAX_MTU         512
+#define SERIAL_LINK_MAX_ENCODED     (SERIAL_LINK_MAX_MTU + SERIAL_LINK_MAX_MTU / 254 + 2)
+#define SERIAL_LINK_RECORD_HEADER   9       // ID, ctl, timestamp
+#define SERIAL_LINK_CTL_LEN_MASK    0x0F
+#define SERIAL_LINK_CTL_EXTENDED    0x10
+#define SERIAL_LINK_CTL_REMOTE      0x20
+#define SERIAL_LINK_CTL_BLOCK       0x40    // Length byte after the timestamp, up to 255 data bytes
+
+// Telemetry mode
+#define SERIAL_TELEMETRY_MAX_CHANNELS   32
+#define SERIAL_TELEMETRY_DELTA          0x00    // Block kinds
+#define SERIAL_TELEMETRY_KEYFRAME       0x01
+
+uint16_t serial_link_crc16(const uint8_t* data, size_t length);        // CRC-16/CCITT-FALSE
+size_t serial_link_cobs_encode(const uint8_t* in, size_t length, uint8_t* out);  // No delimiter
+size_t serial_link_cobs_decode(uint8_t* buffer, size_t length);       // In place, 0 if malformed
+
+#endif
@@ -0,0 +1,232 @@
+// shift_chain.cpp
+// Shadow images for SPI output chains, sent one DMA transfer per chain
+
+#include "shift_chain.h"
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+    #include <SPI.h>
+    #include <EventResponder.h>
+#else
+    #include "tests/mock_arduino.h"
+    #include <string.h>
+#endif
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+typedef struct {
+    uint8_t configured;
+    uint8_t cs_pin;
+    uint8_t length;                         // Bytes in the chain
+    uint32_t speed_hz;
+    uint8_t image[SHIFT_CHAIN_MAX_BYTES];   // Shadow, in send order
+    uint8_t tx[SHIFT_CHAIN_MAX_BYTES];      // Copy being sent (DMA source)
+    uint8_t rx[SHIFT_CHAIN_MAX_BYTES];      // Frame being received (DMA destination)
+    uint8_t readback[SHIFT_CHAIN_MAX_BYTES];
+    volatile uint8_t dirty;
+} shift_chain_t;
+
+static shift_chain_t chains[SHIFT_CHAIN_MAX_CHAINS];
+static volatile int8_t active_chain = -1;      // Transfer in progress
+static volatile uint32_t transfer_count = 0;
+static volatile uint8_t bus_claimed = 0;     // Blocking SPI user holds the bus
+
+#ifdef ARDUINO
+static EventResponder transfer_event;
+#else
+static uint8_t sim_readback[SHIFT_CHAIN_MAX_CHAINS][SHIFT_CHAIN_MAX_BYTES];
+#endif
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+// Byte and mask of an output bit: bit 0 is in the last byte sent
+static inline uint8_t byte_of(const shift_chain_t* c, uint8_t bit) {
+    return (uint8_t)(c->length - 1 - (bit >> 3));
+}
+
+static void start_next_transfer(void);
+
+// Transfer finished: release the chip select and keep the status frame
+static void finish_transfer(void) {
+    shift_chain_t* c = &chains[active_chain];
+    #ifdef ARDUINO
+    digitalWriteFast(c->cs_pin, HIGH);
+    SPI.endTransaction();
+    #endif
+    memcpy(c->readback, c->rx, c->length);
+    transfer_count++;
+    active_chain = -1;
+    start_next_transfer();
+}
+
+#ifdef ARDUINO
+static void on_transfer_complete(EventResponderRef event) {
+    (void)event;
+    finish_transfer();
+}
+#else
+static void on_sim_transfer_complete(void* context) {
+    (void)context;
+    finish_transfer();
+}
+#endif
+
+// Send the first dirty chain; no-op while a transfer is running
+static void start_next_transfer(void) {
+    if (active_chain >= 0 || bus_claimed) {
+        return;
+    }
+    for (uint8_t i = 0; i < SHIFT_CHAIN_MAX_CHAINS; i++) {
+        shift_chain_t* c = &chains[i];
+        if (!c->configured || !c->dirty) {
+            continue;
+        }
+        c->dirty = 0;
+        memcpy(c->tx, c->image, c->length);
+        active_chain = i;
+
+        #ifdef ARDUINO
+        SPI.beginTransaction(SPISettings(c->speed_hz, MSBFIRST, SPI_MODE0));
+        digitalWriteFast(c->cs_pin, LOW);
+        SPI.transfer(c->tx, c->rx, c->length, transfer_event);
+        #else
+        memcpy(c->rx, sim_readback[i], c->length);
+        if (mock_clock_enabled) {
+            // DMA runs beside the CPU: complete after the wire time
+            uint32_t wire_us = (mock_spi_transfer_ns(c->length, c->speed_hz) + 999) / 1000;
+            mock_schedule_after_us(wire_us, on_sim_transfer_complete, nullptr);
+        } else {
+            finish_transfer();
+        }
+        #endif
+        return;
+    }
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void shift_chain_init(void) {
+    memset(chains, 0, sizeof(chains));
+    active_chain = -1;
+    transfer_count = 0;
+    bus_claimed = 0;
+    #ifdef ARDUINO
+    transfer_event.attachImmediate(on_transfer_complete);
+    #else
+    memset(sim_readback, 0, sizeof(sim_readback));
+    #endif
+}
+
+bool shift_chain_configure(uint8_t chain, uint8_t cs_pin, uint8_t length_bytes, uint32_t speed_hz) {
+    if (chain >= SHIFT_CHAIN_MAX_CHAINS || length_bytes == 0 || length_bytes > SHIFT_CHAIN_MAX_BYTES) {
+        return false;
+    }
+    shift_chain_t* c = &chains[chain];
+    if (c->configured && length_bytes <= c->length) {
+        return true;
+    }
+
+    // Lengthening keeps the existing bits: they move to the end of the image
+    uint8_t grow = c->configured ? (uint8_t)(length_bytes - c->length) : length_bytes;
+    memmove(&c->image[grow], c->image, c->configured ? c->length : 0);
+    memset(c->image, 0, grow);
+
+    if (!c->configured) {
+        #ifdef ARDUINO
+        pinMode(cs_pin, OUTPUT);
+        digitalWriteFast(cs_pin, HIGH);
+        SPI.begin();
+        #endif
+        c->cs_pin = cs_pin;
+        c->speed_hz = speed_hz;
+        c->configured = 1;
+    }
+    c->length = length_bytes;
+    c->dirty = 1;
+    return true;
+}
+
+void shift_chain_set_bit(uint8_t chain, uint8_t bit, uint8_t state) {
+    if (chain >= SHIFT_CHAIN_MAX_CHAINS || !chains[chain].configured ||
+        (bit >> 3) >= chains[chain].length) {
+        return;
+    }
+    shift_chain_t* c = &chains[chain];
+    uint8_t mask = (uint8_t)(1 << (bit & 7));
+    uint8_t* b = &c->image[byte_of(c, bit)];
+    uint8_t updated = state ? (uint8_t)(*b | mask) : (uint8_t)(*b & ~mask);
+    if (updated != *b) {
+        *b = updated;
+        c->dirty = 1;
+    }
+}
+
+void shift_chain_flush(void) {
+    #ifdef ARDUINO
+    noInterrupts();
+    #endif
+    start_next_transfer();
+    #ifdef ARDUINO
+    interrupts();
+    #endif
+}
+
+bool shift_chain_claim_bus(uint32_t timeout_us) {
+    bus_claimed = 1;
+    uint32_t start_us = micros();
+    while (active_chain >= 0) {
+        if ((uint32_t)(micros() - start_us) >= timeout_us) {
+            bus_claimed = 0;
+            return false;
+        }
+        #ifndef ARDUINO
+        mock_advance_time_us(1);    // Let the simulated DMA finish
+        #endif
+    }
+    return true;
+}
+
+void shift_chain_release_bus(void) {
+    bus_claimed = 0;
+    shift_chain_flush();
+}
+
+uint8_t shift_chain_get_readback_bit(uint8_t chain, uint8_t bit) {
+    if (chain >= SHIFT_CHAIN_MAX_CHAINS || !chains[chain].configured ||
+        (bit >> 3) >= chains[chain].length) {
+        return 0;
+    }
+    const shift_chain_t* c = &chains[chain];
+    return (c->readback[byte_of(c, bit)] >> (bit & 7)) & 1;
+}
+
+bool shift_chain_is_busy(void) {
+    return active_chain >= 0;
+}
+
+uint32_t shift_chain_get_transfer_count(void) {
+    return transfer_count;
+}
+
+#ifdef TESTING
+void shift_chain_set_readback_for_testing(uint8_t chain, const uint8_t* image, uint8_t length) {
+    if (chain < SHIFT_CHAIN_MAX_CHAINS && length <= SHIFT_CHAIN_MAX_BYTES) {
+        memcpy(sim_readback[chain], image, length);
+    }
+}
+
+uint8_t shift_chain_get_sent_for_testing(uint8_t chain, uint8_t* image, uint8_t max_length) {
+    if (chain >= SHIFT_CHAIN_MAX_CHAINS) {
+        return 0;
+    }
+    uint8_t length = chains[chain].length < max_length ? chains[chain].length : max_length;
+    memcpy(image, chains[chain].tx, length);
+    return length;
+}
+#endif
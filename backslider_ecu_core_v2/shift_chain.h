@@ -0,0 +1,79 @@
+// shift_chain.h
+// SPI shift-register / smart low-side driver chains flushed by DMA
+
+/* =============================================================================
+ * SHIFT CHAIN OVERVIEW
+ * =============================================================================
+ *
+ * A chain is a string of daisy-chained SPI output devices behind one chip
+ * select: 74HC595-style shift registers, or smart low-side drivers that
+ * shift a status frame back out while the command shifts in. Each chain
+ * keeps a shadow image of its output bits. Setting a bit only changes the
+ * shadow; shift_chain_flush() sends every changed chain as one DMA transfer
+ * (whole image, chip select held low for the frame), so a control tick
+ * costs one transaction per chain however many of its outputs changed.
+ *
+ * The bytes clocked in during the same transfer are kept as the chain's
+ * readback image, so drivers that report per-output faults are read with
+ * no extra transaction.
+ *
+ * Bit numbering: bit 0 is the first output of the device nearest the MCU.
+ * The last byte shifted ends up in that device, so the image is sent
+ * farthest device first.
+ *
+ * Chains are flushed one after another: the completion of one transfer
+ * starts the next dirty chain. A flush while a transfer is still running
+ * is picked up when it completes.
+ *
+ * Chains share the SPI bus with blocking users (the W25Q128 on LPSPI).
+ * Those wrap each command in shift_chain_claim_bus() / shift_chain_release_bus():
+ * the claim waits for the DMA transfer in flight, and flushes made while the
+ * bus is held go out on release.
+ * =============================================================================
+ */
+
+#ifndef SHIFT_CHAIN_H
+#define SHIFT_CHAIN_H
+
+#include <stdint.h>
+
+#define SHIFT_CHAIN_MAX_CHAINS  4       // spi_device_id 0-3
+#define SHIFT_CHAIN_MAX_BYTES   8       // Up to 64 outputs per chip select
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Forget all chains
+void shift_chain_init(void);
+
+// Set up (or lengthen) a chain. Outputs start low. Returns false for an
+// invalid chain or length.
+bool shift_chain_configure(uint8_t chain, uint8_t cs_pin, uint8_t length_bytes, uint32_t speed_hz);
+
+// Change one output bit in the shadow image; marks the chain dirty if it changed
+void shift_chain_set_bit(uint8_t chain, uint8_t bit, uint8_t state);
+
+// Start transfers for all dirty chains
+void shift_chain_flush(void);
+
+// Hold the SPI bus for blocking transfers. Returns false if the running
+// chain transfer did not finish within timeout_us.
+bool shift_chain_claim_bus(uint32_t timeout_us);
+void shift_chain_release_bus(void);
+
+// Bit from the frame clocked in by the last completed transfer
+uint8_t shift_chain_get_readback_bit(uint8_t chain, uint8_t bit);
+
+// Diagnostics
+bool shift_chain_is_busy(void);
+uint32_t shift_chain_get_transfer_count(void);  // Completed transfers (changes when readback is new)
+
+#ifdef TESTING
+// Frame the simulated devices return on the next transfer of a chain
+void shift_chain_set_readback_for_testing(uint8_t chain, const uint8_t* image, uint8_t length);
+// Last image sent on a chain (farthest device first); returns its length
+uint8_t shift_chain_get_sent_for_testing(uint8_t chain, uint8_t* image, uint8_t max_length);
+#endif
+
+#endif
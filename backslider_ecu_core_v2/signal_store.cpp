@@ -0,0 +1,125 @@
+// signal_store.cpp
+// Latest-value slots for shared signals
+
+#include "signal_store.h"
+#include "msg_bus.h"
+#include "memory_placement.h"
+#include <string.h>
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+// Orders the copy writes/reads around the sequence counter
+#if defined(__arm__)
+    #define SIGNAL_MEMORY_BARRIER() asm volatile("dmb" ::: "memory")
+#else
+    #define SIGNAL_MEMORY_BARRIER() asm volatile("" ::: "memory")
+#endif
+
+#define SIGNAL_SLOT_BYTES   32      // Cortex-M7 data cache line
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+typedef struct alignas(SIGNAL_SLOT_BYTES) {
+    volatile uint32_t sequence;     // Low bit: copy readers use
+    signal_sample_t copies[2];
+} signal_slot_t;
+
+static_assert(sizeof(signal_slot_t) == SIGNAL_SLOT_BYTES, "Signal slot must be one cache line");
+
+static signal_slot_t slots[SIGNAL_COUNT] ECU_HOT_DATA;
+
+static const uint32_t signal_msg_ids[SIGNAL_COUNT] = {
+    #define SIGNAL_STORE_MSG_ID(handle, msg_id, max_age_ms) msg_id,
+    SIGNAL_STORE_SIGNALS(SIGNAL_STORE_MSG_ID)
+    #undef SIGNAL_STORE_MSG_ID
+};
+
+static const uint32_t signal_max_age_ms[SIGNAL_COUNT] = {
+    #define SIGNAL_STORE_MAX_AGE(handle, msg_id, max_age_ms) max_age_ms,
+    SIGNAL_STORE_SIGNALS(SIGNAL_STORE_MAX_AGE)
+    #undef SIGNAL_STORE_MAX_AGE
+};
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+// One bus handler per signal, the handle fixed at compile time
+template<signal_handle_t Handle>
+static void store_from_bus(const float& value) {
+    signal_store_set(Handle, value);
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void signal_store_init(void) {
+    memset(slots, 0, sizeof(slots));
+
+    #define SIGNAL_STORE_SUBSCRIBE(handle, msg_id, max_age_ms) \
+        g_message_bus.subscribe<float, msg_id, store_from_bus<handle>>();
+    SIGNAL_STORE_SIGNALS(SIGNAL_STORE_SUBSCRIBE)
+    #undef SIGNAL_STORE_SUBSCRIBE
+}
+
+ECU_HOT_CODE void signal_store_set(signal_handle_t handle, float value) {
+    if ((unsigned)handle >= SIGNAL_COUNT) {
+        return;
+    }
+    signal_slot_t* slot = &slots[handle];
+    signal_sample_t sample = {value, millis(), 1};
+
+    // Readers move to copies[1] while copies[0] is written, then back
+    slot->sequence++;
+    SIGNAL_MEMORY_BARRIER();
+    slot->copies[0] = sample;
+    SIGNAL_MEMORY_BARRIER();
+    slot->sequence++;
+    SIGNAL_MEMORY_BARRIER();
+    slot->copies[1] = sample;
+}
+
+ECU_HOT_CODE bool signal_store_read(signal_handle_t handle, signal_sample_t* sample) {
+    if ((unsigned)handle >= SIGNAL_COUNT) {
+        return false;
+    }
+    const signal_slot_t* slot = &slots[handle];
+    uint32_t sequence;
+    do {
+        sequence = slot->sequence;
+        SIGNAL_MEMORY_BARRIER();
+        *sample = slot->copies[sequence & 1];
+        SIGNAL_MEMORY_BARRIER();
+    } while (sequence != slot->sequence);
+    return sample->valid != 0;
+}
+
+ECU_HOT_CODE bool signal_store_get(signal_handle_t handle, float* value) {
+    signal_sample_t sample;
+    if (!signal_store_read(handle, &sample)) {
+        return false;
+    }
+    uint32_t max_age_ms = signal_max_age_ms[handle];
+    if (max_age_ms != 0 && millis() - sample.timestamp_ms >= max_age_ms) {
+        return false;
+    }
+    *value = sample.value;
+    return true;
+}
+
+float signal_store_get_or(signal_handle_t handle, float fallback) {
+    float value = fallback;
+    signal_store_get(handle, &value);
+    return value;
+}
+
+uint32_t signal_store_get_msg_id(signal_handle_t handle) {
+    return ((unsigned)handle < SIGNAL_COUNT) ? signal_msg_ids[handle] : 0;
+}
@@ -0,0 +1,84 @@
+// signal_store.h
+// Latest value of shared signals, fed by the message bus
+
+/* =============================================================================
+ * SIGNAL STORE OVERVIEW
+ * =============================================================================
+ *
+ * Signals several modules need (throttle, speed, brake, ...) used to be
+ * cached by each consumer with its own subscription and timeout. The store
+ * subscribes to each signal's message once and keeps its latest value,
+ * timestamp and validity in a slot indexed by a compile-time handle, so a
+ * read is one slot access - no subscription, no lookup, no copy to keep.
+ *
+ * Signals are listed in SIGNAL_STORE_SIGNALS below: handle, message ID
+ * (float payload) and the age after which the value counts as stale
+ * (0 = never).
+ *
+ * Slots are one 32-byte data cache line each. A slot holds two copies of
+ * the sample and a sequence counter whose low bit says which copy readers
+ * use; the writer updates the other copy first, flips, then brings the
+ * first one up to date. A reader that interrupts the writer therefore
+ * always finds a complete copy and never spins, so reads are safe from any
+ * ISR. A reader interrupted by the writer retries once the write is done.
+ *
+ * Each signal must have one writer context: the bus handlers (main loop),
+ * or signal_store_set() from a single ISR.
+ * =============================================================================
+ */
+
+#ifndef SIGNAL_STORE_H
+#define SIGNAL_STORE_H
+
+#include <stdint.h>
+#include "msg_definitions.h"
+
+// handle, message ID, max age (ms)
+#define SIGNAL_STORE_SIGNALS(X) \
+    X(SIGNAL_ENGINE_RPM,            MSG_ENGINE_RPM,             500)  \
+    X(SIGNAL_VEHICLE_SPEED,         MSG_VEHICLE_SPEED,          500)  \
+    X(SIGNAL_COOLANT_TEMP,          MSG_COOLANT_TEMP,           2000) \
+    X(SIGNAL_THROTTLE_POSITION,     MSG_THROTTLE_POSITION,      500)  \
+    X(SIGNAL_MANIFOLD_PRESSURE,     MSG_MANIFOLD_PRESSURE,      500)  \
+    X(SIGNAL_BATTERY_VOLTAGE,       MSG_BATTERY_VOLTAGE,        2000) \
+    X(SIGNAL_BRAKE_PEDAL,           MSG_BRAKE_PEDAL,            500)  \
+    X(SIGNAL_TRANS_FLUID_TEMP,      MSG_TRANS_FLUID_TEMP,       2000)
+
+typedef enum {
+    #define SIGNAL_STORE_HANDLE(handle, msg_id, max_age_ms) handle,
+    SIGNAL_STORE_SIGNALS(SIGNAL_STORE_HANDLE)
+    #undef SIGNAL_STORE_HANDLE
+    SIGNAL_COUNT
+} signal_handle_t;
+
+typedef struct {
+    float value;
+    uint32_t timestamp_ms;      // millis() when written
+    uint8_t valid;              // Written at least once since init
+} signal_sample_t;
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Clear every slot and subscribe to the signals' messages. Call after the
+// message bus is initialized.
+void signal_store_init(void);
+
+// Write a signal (what the bus handlers do)
+void signal_store_set(signal_handle_t handle, float value);
+
+// Latest sample, fresh or not; false if never written
+bool signal_store_read(signal_handle_t handle, signal_sample_t* sample);
+
+// Current value if written and younger than its max age; false otherwise
+// (value left untouched)
+bool signal_store_get(signal_handle_t handle, float* value);
+
+// Current value, or fallback when missing or stale
+float signal_store_get_or(signal_handle_t handle, float fallback);
+
+// Message a signal is fed from
+uint32_t signal_store_get_msg_id(signal_handle_t handle);
+
+#endif
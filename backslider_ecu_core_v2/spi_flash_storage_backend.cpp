@@ -123,6 +123,32 @@ bool SPIFlashStorageBackend::hasData(uint32_t storage_key) {
     return (it != mock_files.end() && it->second.exists());
 }
 
+uint8_t SPIFlashStorageBackend::readMany(StorageItem* items, uint8_t count) {
+    uint8_t order[UINT8_MAX];
+    sortByKey(items, count, order);
+    
+    uint8_t done = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        StorageItem& item = items[order[i]];
+        item.ok = readData(item.storage_key, item.data, item.size);
+        done += item.ok;
+    }
+    return done;
+}
+
+uint8_t SPIFlashStorageBackend::writeMany(StorageItem* items, uint8_t count) {
+    uint8_t order[UINT8_MAX];
+    sortByKey(items, count, order);
+    
+    uint8_t done = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        StorageItem& item = items[order[i]];
+        item.ok = writeData(item.storage_key, item.data, item.size);
+        done += item.ok;
+    }
+    return done;
+}
+
 // =============================================================================
 // Storage Management
 // =============================================================================
@@ -303,6 +329,16 @@ SPIFlashStorageBackend::MockFile* SPIFlashStorageBackend::openFile(const std::st
     return file;
 }
 
+void SPIFlashStorageBackend::sortByKey(const StorageItem* items, uint8_t count, uint8_t* order) {
+    // Stable, so a key repeated in a write batch keeps its last value
+    for (uint8_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order, order + count, [items](uint8_t a, uint8_t b) {
+        return items[a].storage_key < items[b].storage_key;
+    });
+}
+
 void SPIFlashStorageBackend::printExtendedCanId(uint32_t storage_key) {
     uint8_t ecu_base = (storage_key >> 28) & 0x0F;
     uint8_t subsystem = (storage_key >> 20) & 0xFF;
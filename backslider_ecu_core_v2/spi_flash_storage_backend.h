@@ -30,6 +30,11 @@ public:
     bool deleteData(uint32_t storage_key) override;
     bool hasData(uint32_t storage_key) override;
     
+    // Batches visit keys in order, so each keys/ECU/SUBSYSTEM directory
+    // is walked once
+    uint8_t readMany(StorageItem* items, uint8_t count) override;
+    uint8_t writeMany(StorageItem* items, uint8_t count) override;
+    
     // Storage management
     uint32_t getTotalSpace() override;
     uint32_t getFreeSpace() override;
@@ -127,6 +132,7 @@ private:
     std::string getFilePath(uint32_t storage_key);
     bool ensureDirectoryExists(const std::string& path);
     MockFile* openFile(const std::string& path, const char* mode);
+    void sortByKey(const StorageItem* items, uint8_t count, uint8_t* order);
     
     // Debug helpers
     void printExtendedCanId(uint32_t storage_key);
@@ -7,6 +7,23 @@
 #include <stdint.h>
 #include <string.h>
 #include <cstdio>
+#include <vector>
+
+// One piece of a blob. A blob is stored as its segments back to back, so a
+// structure split across several arrays saves and loads without staging.
+struct StorageSegment {
+    void* data;
+    size_t size;
+};
+
+// One key of a batched access. readMany() and writeMany() set ok for each
+// item; a failed item does not stop the rest of the batch.
+struct StorageItem {
+    uint32_t storage_key;
+    void* data;
+    size_t size;
+    bool ok;
+};
 
 // =============================================================================
 // Abstract Storage Backend Interface
@@ -26,6 +43,19 @@ public:
     virtual bool deleteData(uint32_t storage_key) = 0;
     virtual bool hasData(uint32_t storage_key) = 0;
     
+    // Blob access: one record gathered from / scattered into the segments.
+    // The defaults stage through the heap; backends that can read and write
+    // a record piecewise override them.
+    virtual bool writeBlob(uint32_t storage_key, const StorageSegment* segments, uint8_t count);
+    virtual bool readBlob(uint32_t storage_key, const StorageSegment* segments, uint8_t count);
+    
+    // Batched access: returns how many items succeeded. Writes land in item
+    // order, so a key repeated in one batch keeps its last value; the batch
+    // is not atomic. The defaults loop over readData() / writeData();
+    // backends that can share work between keys override them.
+    virtual uint8_t readMany(StorageItem* items, uint8_t count);
+    virtual uint8_t writeMany(StorageItem* items, uint8_t count);
+    
     // Storage management
     virtual uint32_t getTotalSpace() = 0;
     virtual uint32_t getFreeSpace() = 0;
@@ -35,10 +65,24 @@ public:
     virtual void sync() = 0;
     virtual void flush() = 0;
     
+    // Advance background I/O without blocking; call from the storage task.
+    // Backends whose operations complete synchronously leave it empty.
+    virtual void poll() {}
+    
     // Optional iteration support
     virtual uint32_t getStoredKeyCount() = 0;
     virtual bool getStoredKey(uint32_t index, uint32_t* storage_key) = 0;
     
+    // Ordered listing: counts the keys above after_key with
+    // (key & mask) == match, and fills keys with the smallest max of them in
+    // ascending order. Walking a range a chunk at a time needs no state
+    // between calls. The default goes through getStoredKey().
+    virtual uint32_t listKeys(uint32_t after_key, uint32_t mask, uint32_t match, uint32_t* keys, uint32_t max);
+    
+    // Offer one key to an ascending list of at most max, keeping the
+    // smallest; duplicates are dropped. For listKeys() and its callers.
+    static void insertListedKey(uint32_t key, uint32_t* keys, uint32_t* filled, uint32_t max);
+    
     // Debug/information
     virtual void printDebugInfo() = 0;
     
@@ -51,6 +95,81 @@ protected:
 // Inline Helper Implementation
 // =============================================================================
 
+inline bool StorageBackend::writeBlob(uint32_t storage_key, const StorageSegment* segments, uint8_t count) {
+    std::vector<uint8_t> buffer;
+    for (uint8_t i = 0; i < count; i++) {
+        const uint8_t* bytes = (const uint8_t*)segments[i].data;
+        buffer.insert(buffer.end(), bytes, bytes + segments[i].size);
+    }
+    return !buffer.empty() && writeData(storage_key, buffer.data(), buffer.size());
+}
+
+inline bool StorageBackend::readBlob(uint32_t storage_key, const StorageSegment* segments, uint8_t count) {
+    size_t total = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        total += segments[i].size;
+    }
+    std::vector<uint8_t> buffer(total);
+    if (total == 0 || !readData(storage_key, buffer.data(), total)) {
+        return false;
+    }
+    size_t offset = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        memcpy(segments[i].data, &buffer[offset], segments[i].size);
+        offset += segments[i].size;
+    }
+    return true;
+}
+
+inline uint8_t StorageBackend::readMany(StorageItem* items, uint8_t count) {
+    uint8_t done = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        items[i].ok = readData(items[i].storage_key, items[i].data, items[i].size);
+        done += items[i].ok;
+    }
+    return done;
+}
+
+inline uint8_t StorageBackend::writeMany(StorageItem* items, uint8_t count) {
+    uint8_t done = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        items[i].ok = writeData(items[i].storage_key, items[i].data, items[i].size);
+        done += items[i].ok;
+    }
+    return done;
+}
+
+inline uint32_t StorageBackend::listKeys(uint32_t after_key, uint32_t mask, uint32_t match,
+                                         uint32_t* keys, uint32_t max) {
+    uint32_t count = 0;
+    uint32_t filled = 0;
+    uint32_t stored = getStoredKeyCount();
+    for (uint32_t i = 0; i < stored; i++) {
+        uint32_t key;
+        if (getStoredKey(i, &key) && key > after_key && (key & mask) == match) {
+            count++;
+            insertListedKey(key, keys, &filled, max);
+        }
+    }
+    return count;
+}
+
+inline void StorageBackend::insertListedKey(uint32_t key, uint32_t* keys, uint32_t* filled, uint32_t max) {
+    uint32_t pos = *filled;
+    while (pos > 0 && keys[pos - 1] > key) {
+        pos--;
+    }
+    if (pos >= max || (pos > 0 && keys[pos - 1] == key)) {
+        return;
+    }
+    uint32_t end = (*filled < max) ? *filled : max - 1;
+    memmove(&keys[pos + 1], &keys[pos], (end - pos) * sizeof(uint32_t));
+    keys[pos] = key;
+    if (*filled < max) {
+        (*filled)++;
+    }
+}
+
 inline void StorageBackend::storage_key_to_filename(uint32_t storage_key, char* filename, size_t filename_size) {
     // Convert extended CAN ID to hierarchical filename
     // Format: keys/ECU_BASE/SUBSYSTEM/PARAMETER.bin
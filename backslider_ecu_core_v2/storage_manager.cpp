@@ -24,17 +24,24 @@ extern uint32_t mock_millis_time;
 // =============================================================================
 
 StorageManager::StorageManager(StorageBackend* storage_backend) 
-    : backend(storage_backend), cache_index(0), cache_hits(0), cache_misses(0), 
-      disk_writes(0), disk_reads(0) {
+    : backend(storage_backend), cache_count(0), clock_hand(0), cache_hits(0), cache_misses(0),
+      cache_evictions(0), coalesced_saves(0), disk_writes(0), disk_reads(0) {
     
     // Initialize cache
     for (int i = 0; i < CACHE_SIZE; i++) {
         cache[i].storage_key = 0;
         cache[i].value = 0.0f;
-        cache[i].timestamp = 0;
-        cache[i].dirty = false;
-        cache[i].access_count = 0;
+        cache[i].dirty_since_ms = 0;
     }
+    for (int i = 0; i < STORAGE_CACHE_INDEX_SLOTS; i++) {
+        cache_slots[i] = -1;
+    }
+    for (int i = 0; i < STORAGE_CACHE_BITMAP_WORDS; i++) {
+        cache_referenced[i] = 0;
+        cache_dirty[i] = 0;
+    }
+    
+    memset(&export_state, 0, sizeof(export_state));
 }
 
 bool StorageManager::init() {
@@ -48,17 +55,33 @@ bool StorageManager::init() {
     g_message_bus.subscribe(MSG_STORAGE_LOAD, storage_load_float_handler);
     g_message_bus.subscribe(MSG_STORAGE_COMMIT, storage_commit_cache_handler);
     g_message_bus.subscribe(MSG_STORAGE_STATS, storage_stats_handler);
+    g_message_bus.subscribe(MSG_STORAGE_EXPORT_REQUEST, storage_export_request_handler);
+    g_message_bus.subscribe(MSG_STORAGE_EXPORT_CREDIT, storage_export_credit_handler);
     
     return true;
 }
 
 void StorageManager::update() {
-    static uint32_t last_commit = 0;
+    uint32_t start_us = micros();
+    uint32_t now_ms = millis();
+    
+    // Complete finished flash operations and start queued ones
+    backend->poll();
+    
+    do {
+        int entry = find_oldest_dirty(now_ms);
+        if (entry < 0) {
+            break;
+        }
+        if (!write_back(entry)) {
+            // Requeue behind the others rather than retrying it every call
+            cache[entry].dirty_since_ms = now_ms;
+            break;
+        }
+    } while (micros() - start_us < STORAGE_FLUSH_BUDGET_US);
     
-    // Periodic commit of dirty cache entries (every 10 seconds)
-    if (millis() - last_commit >= 10000) {
-        commit_dirty_entries();
-        last_commit = millis();
+    if (export_state.active) {
+        export_step(now_ms);
     }
 }
 
@@ -73,19 +96,8 @@ void StorageManager::handle_save_float_message(const CANMessage* msg) {
     
     storage_save_float_msg_t* save_msg = MSG_UNPACK_STORAGE_SAVE_FLOAT(msg);
     
-    bool success = false;
-    
-    // Save to cache
-    if (save_to_cache(save_msg->storage_key, save_msg->value)) {
-        success = true;
-        
-        // Always write to backend immediately (no priority field anymore)
-        if (backend->writeData(save_msg->storage_key, &save_msg->value, sizeof(float))) {
-            disk_writes++;
-        } else {
-            success = false;
-        }
-    }
+    // Written back by the flusher
+    bool success = save_to_cache(save_msg->storage_key, save_msg->value);
     
     // Send response
     send_save_response(save_msg->storage_key, success);
@@ -125,110 +137,275 @@ void StorageManager::handle_load_float_message(const CANMessage* msg) {
 }
 
 void StorageManager::handle_commit_cache_message(const CANMessage* msg) {
-    commit_dirty_entries();
+    force_commit_cache();
 }
 
 void StorageManager::handle_stats_request_message(const CANMessage* msg) {
     send_stats_response();
 }
 
+void StorageManager::handle_export_request_message(const CANMessage* msg) {
+    if (msg->len != sizeof(storage_export_request_msg_t)) {
+        return;  // Invalid message size
+    }
+    
+    storage_export_request_msg_t request;
+    memcpy(&request, msg->buf, sizeof(request));
+    
+    // The map and settings exports are subsystem filters
+    uint8_t subsystem = request.subsystem_filter;
+    if (request.export_type == 1) subsystem = SUBSYSTEM_FUEL >> 20;
+    if (request.export_type == 2) subsystem = SUBSYSTEM_IGNITION >> 20;
+    if (request.export_type == 3) subsystem = SUBSYSTEM_CONFIG >> 20;
+    
+    // A new request replaces one in progress
+    memset(&export_state, 0, sizeof(export_state));
+    if (request.ecu_filter) {
+        export_state.mask |= ECU_BASE_MASK;
+        export_state.match |= (uint32_t)request.ecu_filter << 28;
+    }
+    if (subsystem) {
+        export_state.mask |= SUBSYSTEM_MASK;
+        export_state.match |= (uint32_t)subsystem << 20;
+    }
+    export_state.cursor = request.resume_after_key;
+    export_state.credits = request.window;
+    export_state.last_credit_ms = millis();
+    export_state.active = true;
+    
+    // The first chunk comes with the count
+    uint32_t total = list_export_keys(export_state.keys, STORAGE_EXPORT_CHUNK);
+    export_state.key_count = (total < STORAGE_EXPORT_CHUNK) ? total : STORAGE_EXPORT_CHUNK;
+    
+    storage_export_start_msg_t start;
+    start.total_keys = (total > 0xFFFF) ? 0xFFFF : total;
+    start.success = 1;
+    start.reserved = 0;
+    start.resume_after_key = request.resume_after_key;
+    g_message_bus.publish(MSG_STORAGE_EXPORT_START, &start, sizeof(start));
+}
+
+void StorageManager::handle_export_credit_message(const CANMessage* msg) {
+    if (msg->len != sizeof(storage_export_credit_msg_t) || !export_state.active || export_state.finishing) {
+        return;
+    }
+    
+    storage_export_credit_msg_t credit;
+    memcpy(&credit, msg->buf, sizeof(credit));
+    if (credit.abort) {
+        finish_export(false);
+        return;
+    }
+    
+    uint32_t credits = (uint32_t)export_state.credits + credit.credits;
+    export_state.credits = (credits > 0xFFFF) ? 0xFFFF : credits;
+    export_state.last_credit_ms = millis();
+}
+
 // =============================================================================
 // Cache Management
 // =============================================================================
 
+static_assert((STORAGE_CACHE_SIZE & (STORAGE_CACHE_SIZE - 1)) == 0, "STORAGE_CACHE_SIZE must be a power of two");
+
+static inline bool bit_test(const uint32_t* bits, int i) {
+    return (bits[i >> 5] >> (i & 31)) & 1;
+}
+
+static inline void bit_set(uint32_t* bits, int i) {
+    bits[i >> 5] |= 1u << (i & 31);
+}
+
+static inline void bit_clear(uint32_t* bits, int i) {
+    bits[i >> 5] &= ~(1u << (i & 31));
+}
+
+// Home slot in the index. CAN IDs differ mostly in a few fields, so mix
+// every bit into the low ones before masking.
+static inline uint16_t cache_home_slot(uint32_t storage_key) {
+    uint32_t h = storage_key;
+    h ^= h >> 16;
+    h *= 0x45D9F3B;
+    h ^= h >> 16;
+    return h & (STORAGE_CACHE_INDEX_SLOTS - 1);
+}
+
 bool StorageManager::save_to_cache(uint32_t storage_key, float value) {
     if (storage_key == 0) return false;
     
-    // Check if key already exists in cache
-    int existing_index = find_cache_entry(storage_key);
-    if (existing_index >= 0) {
-        // Update existing entry
-        cache[existing_index].value = value;
-        cache[existing_index].timestamp = millis();
-        cache[existing_index].dirty = true;
-        cache[existing_index].access_count++;
-        return true;
+    int entry = find_cache_entry(storage_key);
+    if (entry < 0) {
+        entry = add_to_cache(storage_key, value);
+        if (entry < 0) {
+            return false;
+        }
     }
     
-    // Add new entry
-    add_to_cache(storage_key, value);
-    cache[cache_index].dirty = true;
-    
+    cache[entry].value = value;
+    bit_set(cache_referenced, entry);
+    if (bit_test(cache_dirty, entry)) {
+        coalesced_saves++;      // Keeps its place in the flush order
+    } else {
+        bit_set(cache_dirty, entry);
+        cache[entry].dirty_since_ms = millis();
+    }
     return true;
 }
 
 bool StorageManager::load_from_cache(uint32_t storage_key, float* value) {
     if (storage_key == 0 || !value) return false;
     
-    int index = find_cache_entry(storage_key);
-    if (index >= 0) {
-        *value = cache[index].value;
-        cache[index].timestamp = millis();
-        cache[index].access_count++;
+    int entry = find_cache_entry(storage_key);
+    if (entry >= 0) {
+        *value = cache[entry].value;
+        bit_set(cache_referenced, entry);
         return true;
     }
     
     return false;
 }
 
-void StorageManager::add_to_cache(uint32_t storage_key, float value) {
-    if (storage_key == 0) return;
-    
-    // Find oldest entry to replace
-    int oldest_index = find_oldest_cache_entry();
-    
-    // Clear the entry
-    cache[oldest_index].storage_key = 0;
-    cache[oldest_index].value = 0.0f;
-    cache[oldest_index].timestamp = millis();
-    cache[oldest_index].dirty = false;
-    cache[oldest_index].access_count = 1;
+int StorageManager::add_to_cache(uint32_t storage_key, float value) {
+    if (storage_key == 0) return -1;
     
-    // Add new data
-    cache[oldest_index].storage_key = storage_key;
-    cache[oldest_index].value = value;
+    // Free entries are only at the end; once full, reuse a victim
+    int entry;
+    if (cache_count < CACHE_SIZE) {
+        entry = cache_count++;
+    } else {
+        entry = select_victim();
+        if (entry < 0) {
+            return -1;
+        }
+        index_remove(cache[entry].storage_key);
+        cache_evictions++;
+    }
     
-    cache_index = oldest_index;
+    // New entries start unreferenced: a value read once goes before one
+    // read again
+    cache[entry].storage_key = storage_key;
+    cache[entry].value = value;
+    bit_clear(cache_referenced, entry);
+    bit_clear(cache_dirty, entry);
+    index_insert(entry);
+    return entry;
 }
 
 int StorageManager::find_cache_entry(uint32_t storage_key) {
     if (storage_key == 0) return -1;
     
-    for (int i = 0; i < CACHE_SIZE; i++) {
-        if (cache[i].storage_key != 0 && cache[i].storage_key == storage_key) {
-            return i;
+    uint16_t slot = cache_home_slot(storage_key);
+    while (cache_slots[slot] >= 0) {
+        if (cache[cache_slots[slot]].storage_key == storage_key) {
+            return cache_slots[slot];
         }
+        slot = (slot + 1) & (STORAGE_CACHE_INDEX_SLOTS - 1);
     }
     
     return -1;
 }
 
-int StorageManager::find_oldest_cache_entry() {
-    int oldest = 0;
-    uint32_t oldest_time = cache[0].timestamp;
-    
-    for (int i = 1; i < CACHE_SIZE; i++) {
-        if (cache[i].storage_key == 0) {
-            // Empty slot - use this
-            return i;
-        }
+int StorageManager::select_victim() {
+    // Two sweeps clear every reference bit and pass over dirty entries,
+    // which would cost a blocking write. Only if no clean entry turned up
+    // does the third sweep write one back.
+    for (int step = 0; step < 3 * CACHE_SIZE; step++) {
+        int entry = clock_hand;
+        clock_hand = (clock_hand + 1) & (CACHE_SIZE - 1);
         
-        if (cache[i].timestamp < oldest_time) {
-            oldest = i;
-            oldest_time = cache[i].timestamp;
+        if (bit_test(cache_referenced, entry)) {
+            bit_clear(cache_referenced, entry);
+            continue;
         }
+        if (bit_test(cache_dirty, entry) && (step < 2 * CACHE_SIZE || !write_back(entry))) {
+            continue;
+        }
+        return entry;
     }
     
+    return -1;
+}
+
+void StorageManager::index_insert(int entry) {
+    // The index has twice as many slots as entries, so a free one exists
+    uint16_t slot = cache_home_slot(cache[entry].storage_key);
+    while (cache_slots[slot] >= 0) {
+        slot = (slot + 1) & (STORAGE_CACHE_INDEX_SLOTS - 1);
+    }
+    cache_slots[slot] = entry;
+}
+
+void StorageManager::index_remove(uint32_t storage_key) {
+    const uint16_t mask = STORAGE_CACHE_INDEX_SLOTS - 1;
+    uint16_t gap = cache_home_slot(storage_key);
+    while (cache_slots[gap] >= 0 && cache[cache_slots[gap]].storage_key != storage_key) {
+        gap = (gap + 1) & mask;
+    }
+    if (cache_slots[gap] < 0) {
+        return;
+    }
+    
+    // Backward shift instead of tombstones: pull later members of the
+    // probe run into the gap when the gap lies between their home and
+    // where they sit
+    uint16_t next = (gap + 1) & mask;
+    while (cache_slots[next] >= 0) {
+        uint16_t home = cache_home_slot(cache[cache_slots[next]].storage_key);
+        if (((next - home) & mask) >= ((next - gap) & mask)) {
+            cache_slots[gap] = cache_slots[next];
+            gap = next;
+        }
+        next = (next + 1) & mask;
+    }
+    cache_slots[gap] = -1;
+}
+
+int StorageManager::find_oldest_dirty(uint32_t now_ms) {
+    int oldest = -1;
+    uint32_t oldest_age = 0;
+    for (int word = 0; word < STORAGE_CACHE_BITMAP_WORDS; word++) {
+        uint32_t dirty = cache_dirty[word];
+        while (dirty) {
+            int entry = word * 32 + __builtin_ctz(dirty);
+            dirty &= dirty - 1;
+            uint32_t age = now_ms - cache[entry].dirty_since_ms;
+            if (age >= STORAGE_FLUSH_DELAY_MS && (oldest < 0 || age > oldest_age)) {
+                oldest = entry;
+                oldest_age = age;
+            }
+        }
+    }
     return oldest;
 }
 
+bool StorageManager::write_back(int entry) {
+    if (!backend->writeData(cache[entry].storage_key, &cache[entry].value, sizeof(float))) {
+        return false;
+    }
+    bit_clear(cache_dirty, entry);
+    disk_writes++;
+    return true;
+}
+
+bool StorageManager::is_cached(uint32_t storage_key) {
+    return find_cache_entry(storage_key) >= 0;
+}
+
+uint16_t StorageManager::get_dirty_count() {
+    uint16_t count = 0;
+    for (int word = 0; word < STORAGE_CACHE_BITMAP_WORDS; word++) {
+        count += __builtin_popcount(cache_dirty[word]);
+    }
+    return count;
+}
+
 void StorageManager::commit_dirty_entries() {
-    for (int i = 0; i < CACHE_SIZE; i++) {
-        if (cache[i].dirty && cache[i].storage_key != 0) {
-            if (backend->writeData(cache[i].storage_key, &cache[i].value, sizeof(float))) {
-                cache[i].dirty = false;
-                disk_writes++;
-            }
+    for (int word = 0; word < STORAGE_CACHE_BITMAP_WORDS; word++) {
+        uint32_t dirty = cache_dirty[word];
+        while (dirty) {
+            int bit = __builtin_ctz(dirty);
+            dirty &= dirty - 1;
+            write_back(word * 32 + bit);
         }
     }
 }
@@ -274,19 +451,103 @@ void StorageManager::send_stats_response() {
     stats.disk_writes = disk_writes;
     stats.disk_reads = disk_reads;
     
-    // Count current cache entries
-    uint16_t cache_count = 0;
-    for (int i = 0; i < CACHE_SIZE; i++) {
-        if (cache[i].storage_key != 0) {
-            cache_count++;
-        }
-    }
     stats.cache_size = cache_count;
     stats.free_space_kb = backend->getFreeSpace() / 1024;
     
     g_message_bus.publish(MSG_STORAGE_STATS, &stats, sizeof(stats));
 }
 
+// =============================================================================
+// Export Methods
+// =============================================================================
+
+uint32_t StorageManager::list_export_keys(uint32_t* keys, uint32_t max) {
+    // Backend keys, plus cached ones the flusher has not written yet
+    uint32_t count = backend->listKeys(export_state.cursor, export_state.mask, export_state.match, keys, max);
+    uint32_t filled = (count < max) ? count : max;
+    for (uint16_t i = 0; i < cache_count; i++) {
+        uint32_t key = cache[i].storage_key;
+        if (key > export_state.cursor && (key & export_state.mask) == export_state.match &&
+            !backend->hasData(key)) {
+            count++;
+            StorageBackend::insertListedKey(key, keys, &filled, max);
+        }
+    }
+    return count;
+}
+
+bool StorageManager::read_export_value(uint32_t storage_key, float* value) {
+    // The cached value is the newest; reading it leaves the CLOCK state alone
+    int entry = find_cache_entry(storage_key);
+    if (entry >= 0) {
+        *value = cache[entry].value;
+        return true;
+    }
+    return backend->readData(storage_key, value, sizeof(float));
+}
+
+void StorageManager::export_step(uint32_t now_ms) {
+    if (export_state.finishing) {
+        finish_export(export_state.success);
+        return;
+    }
+    
+    uint8_t frames = 0;
+    while (frames < STORAGE_EXPORT_FRAMES_PER_UPDATE) {
+        // Next chunk once this one is sent; none left is the end
+        if (export_state.key_pos >= export_state.key_count) {
+            uint32_t listed = list_export_keys(export_state.keys, STORAGE_EXPORT_CHUNK);
+            export_state.key_count = (listed < STORAGE_EXPORT_CHUNK) ? listed : STORAGE_EXPORT_CHUNK;
+            export_state.key_pos = 0;
+            if (export_state.key_count == 0) {
+                finish_export(true);
+                return;
+            }
+        }
+        
+        if (export_state.credits == 0) {
+            if (now_ms - export_state.last_credit_ms >= STORAGE_EXPORT_IDLE_MS) {
+                finish_export(false);
+            }
+            return;
+        }
+        
+        storage_export_key_msg_t frame;
+        frame.storage_key = export_state.keys[export_state.key_pos];
+        if (!read_export_value(frame.storage_key, &frame.value)) {
+            // Not a float value (or gone since it was listed): skip it
+            export_state.cursor = frame.storage_key;
+            export_state.key_pos++;
+            continue;
+        }
+        if (!g_message_bus.publish(MSG_STORAGE_EXPORT_KEY, &frame, sizeof(frame))) {
+            return;     // Queue full: same key next call
+        }
+        
+        export_state.cursor = frame.storage_key;
+        export_state.key_pos++;
+        export_state.keys_sent++;
+        export_state.credits--;
+        frames++;
+    }
+}
+
+void StorageManager::finish_export(bool success) {
+    storage_export_complete_msg_t complete;
+    complete.keys_sent = export_state.keys_sent;
+    complete.success = success ? 1 : 0;
+    complete.reserved = 0;
+    complete.last_key = export_state.cursor;
+    
+    // Retried from update() until the bus takes it
+    export_state.finishing = true;
+    export_state.success = success;
+    if (g_message_bus.publish(MSG_STORAGE_EXPORT_COMPLETE, &complete, sizeof(complete))) {
+        export_state.active = false;
+        export_state.finishing = false;
+    }
+}
+
 // =============================================================================
 // Direct Access Methods (Updated to use Extended CAN IDs)
 // =============================================================================
@@ -298,18 +559,8 @@ bool StorageManager::save_float(const char* key, float value) {
     // For now, we'll use a simple hash mapping - in the future this could be more sophisticated
     uint32_t storage_key = convert_string_to_extended_can_id(key);
     
-    // Save to cache
-    if (!save_to_cache(storage_key, value)) {
-        return false;
-    }
-    
-    // Write to backend immediately
-    if (backend->writeData(storage_key, &value, sizeof(float))) {
-        disk_writes++;
-        return true;
-    }
-    
-    return false;
+    // Written back by the flusher
+    return save_to_cache(storage_key, value);
 }
 
 bool StorageManager::load_float(const char* key, float* value, float default_value) {
@@ -377,18 +628,8 @@ bool StorageManager::load_data(const char* key, void* data, size_t size) {
 bool StorageManager::save_float(uint32_t storage_key, float value) {
     if (storage_key == 0) return false;
     
-    // Save to cache
-    if (!save_to_cache(storage_key, value)) {
-        return false;
-    }
-    
-    // Write to backend immediately
-    if (backend->writeData(storage_key, &value, sizeof(float))) {
-        disk_writes++;
-        return true;
-    }
-    
-    return false;
+    // Written back by the flusher
+    return save_to_cache(storage_key, value);
 }
 
 bool StorageManager::load_float(uint32_t storage_key, float* value, float default_value) {
@@ -440,6 +681,104 @@ bool StorageManager::load_data(uint32_t storage_key, void* data, size_t size) {
     return false;
 }
 
+// =============================================================================
+// Blob Methods
+// =============================================================================
+
+static uint32_t blob_crc32(uint32_t crc, const void* data, size_t length) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= bytes[i];
+        for (int j = 0; j < 8; j++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+bool StorageManager::save_blob(uint32_t storage_key, uint16_t version, const StorageSegment* segments, uint8_t count) {
+    if (storage_key == 0 || !segments || count == 0 || count >= STORAGE_BLOB_MAX_SEGMENTS) return false;
+    
+    StorageBlobHeader header;
+    header.magic = STORAGE_BLOB_MAGIC;
+    header.version = version;
+    header.reserved = 0;
+    header.payload_size = 0;
+    header.payload_crc = 0;
+    
+    // Header first, then the caller's segments
+    StorageSegment record[STORAGE_BLOB_MAX_SEGMENTS];
+    record[0].data = &header;
+    record[0].size = sizeof(header);
+    for (uint8_t i = 0; i < count; i++) {
+        record[i + 1] = segments[i];
+        header.payload_size += segments[i].size;
+        header.payload_crc = blob_crc32(header.payload_crc, segments[i].data, segments[i].size);
+    }
+    
+    if (backend->writeBlob(storage_key, record, count + 1)) {
+        disk_writes++;
+        return true;
+    }
+    
+    return false;
+}
+
+bool StorageManager::load_blob(uint32_t storage_key, uint16_t version, const StorageSegment* segments, uint8_t count) {
+    if (storage_key == 0 || !segments || count == 0 || count >= STORAGE_BLOB_MAX_SEGMENTS) return false;
+    
+    StorageBlobHeader header;
+    StorageSegment record[STORAGE_BLOB_MAX_SEGMENTS];
+    record[0].data = &header;
+    record[0].size = sizeof(header);
+    uint32_t payload_size = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        record[i + 1] = segments[i];
+        payload_size += segments[i].size;
+    }
+    
+    // One backend read for the whole table
+    if (!backend->readBlob(storage_key, record, count + 1)) {
+        return false;
+    }
+    disk_reads++;
+    
+    if (header.magic != STORAGE_BLOB_MAGIC || header.version != version || header.payload_size != payload_size) {
+        return false;
+    }
+    
+    uint32_t crc = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        crc = blob_crc32(crc, segments[i].data, segments[i].size);
+    }
+    return crc == header.payload_crc;
+}
+
+// =============================================================================
+// Batched Methods
+// =============================================================================
+
+uint8_t StorageManager::save_many(StorageItem* items, uint8_t count) {
+    if (!items || count == 0) return 0;
+    
+    uint8_t saved = backend->writeMany(items, count);
+    if (saved > 0) {
+        disk_writes++;
+    }
+    return saved;
+}
+
+uint8_t StorageManager::load_many(StorageItem* items, uint8_t count) {
+    if (!items || count == 0) return 0;
+    
+    uint8_t loaded = backend->readMany(items, count);
+    if (loaded > 0) {
+        disk_reads++;
+    }
+    return loaded;
+}
+
 // =============================================================================
 // Extended CAN ID Conversion
 // =============================================================================
@@ -469,19 +808,20 @@ void StorageManager::print_cache_info() {
     Serial.print("Cache Misses: "); Serial.println(cache_misses);
     Serial.print("Disk Writes: "); Serial.println(disk_writes);
     Serial.print("Disk Reads: "); Serial.println(disk_reads);
+    Serial.print("Evictions: "); Serial.println(cache_evictions);
+    Serial.print("Entries: "); Serial.print(cache_count);
+    Serial.print(" / "); Serial.println(CACHE_SIZE);
     
     Serial.println("\nCached Keys:");
-    for (int i = 0; i < CACHE_SIZE; i++) {
-        if (cache[i].storage_key != 0) {
-            Serial.print("  Key: 0x"); Serial.print(cache[i].storage_key, HEX);
-            Serial.print(" = "); Serial.print(cache[i].value);
-            Serial.print(" (access: "); Serial.print(cache[i].access_count);
-            Serial.print(", dirty: "); Serial.print(cache[i].dirty ? "Y" : "N");
-            Serial.print(") [ECU=0x"); Serial.print(GET_ECU_BASE(cache[i].storage_key) >> 28, HEX);
-            Serial.print(" SUB=0x"); Serial.print(GET_SUBSYSTEM(cache[i].storage_key) >> 20, HEX);
-            Serial.print(" PARAM=0x"); Serial.print(GET_PARAMETER(cache[i].storage_key), HEX);
-            Serial.println("]");
-        }
+    for (int i = 0; i < cache_count; i++) {
+        Serial.print("  Key: 0x"); Serial.print(cache[i].storage_key, HEX);
+        Serial.print(" = "); Serial.print(cache[i].value);
+        Serial.print(" (referenced: "); Serial.print(bit_test(cache_referenced, i) ? "Y" : "N");
+        Serial.print(", dirty: "); Serial.print(bit_test(cache_dirty, i) ? "Y" : "N");
+        Serial.print(") [ECU=0x"); Serial.print(GET_ECU_BASE(cache[i].storage_key) >> 28, HEX);
+        Serial.print(" SUB=0x"); Serial.print(GET_SUBSYSTEM(cache[i].storage_key) >> 20, HEX);
+        Serial.print(" PARAM=0x"); Serial.print(GET_PARAMETER(cache[i].storage_key), HEX);
+        Serial.println("]");
     }
     Serial.println("=================================");
 }
@@ -503,6 +843,7 @@ bool StorageManager::verify_integrity() {
 
 void StorageManager::force_commit_cache() {
     commit_dirty_entries();
+    backend->flush();
 }
 
 void StorageManager::run_storage_diagnostics() {
@@ -703,4 +1044,16 @@ void storage_stats_handler(const CANMessage* msg) {
     if (g_storage_manager_instance) {
         g_storage_manager_instance->handle_stats_request_message(msg);
     }
-} 
\ No newline at end of file
+} 
+
+void storage_export_request_handler(const CANMessage* msg) {
+    if (g_storage_manager_instance) {
+        g_storage_manager_instance->handle_export_request_message(msg);
+    }
+}
+
+void storage_export_credit_handler(const CANMessage* msg) {
+    if (g_storage_manager_instance) {
+        g_storage_manager_instance->handle_export_credit_message(msg);
+    }
+}
\ No newline at end of file
@@ -12,21 +12,101 @@
 #include <Arduino.h>
 #endif
 
+// =============================================================================
+// Value Cache
+// =============================================================================
+
+// Float values (tuning parameters, single cells) are cached in a table of
+// STORAGE_CACHE_SIZE entries found through an open-addressing hash index
+// (linear probing, kept at most half full), so a lookup is O(1) however
+// many parameters are hot.
+//
+// Eviction is CLOCK: a hand sweeps the entries, clearing each one's
+// reference bit and taking the first entry found already clear, so values
+// touched since the last sweep get a second chance. Reference and dirty
+// flags are bitmaps, so finding dirty entries skips clean words 32 entries
+// at a time. Eviction passes over dirty entries while clean ones remain.
+//
+// Flushing: saves only update the cache. update() is the background
+// flusher - it writes the oldest dirty entries back until
+// STORAGE_FLUSH_BUDGET_US is spent (at least one per call, so a slow
+// backend still makes progress). An entry is held for
+// STORAGE_FLUSH_DELAY_MS after it first goes dirty, so a value saved over
+// and over while being tuned is written once. force_commit_cache() (and
+// MSG_STORAGE_COMMIT) writes everything now - call it before shutdown.
+// update() also polls the backend, so queued flash programs and erases
+// complete across loop passes instead of inside the write that queued them.
+
+#ifndef STORAGE_CACHE_SIZE
+#define STORAGE_CACHE_SIZE          256             // Power of two
+#endif
+#define STORAGE_CACHE_INDEX_SLOTS   (2 * STORAGE_CACHE_SIZE)
+#define STORAGE_CACHE_BITMAP_WORDS  ((STORAGE_CACHE_SIZE + 31) / 32)
+
+#define STORAGE_FLUSH_DELAY_MS      500             // Coalescing window for repeated saves
+#define STORAGE_FLUSH_BUDGET_US     1000            // Flush time per update() call
+
+// =============================================================================
+// Blobs
+// =============================================================================
+
+// A blob is one record holding a whole structure (a map table), saved and
+// loaded in one backend access instead of one key per value. The payload
+// is a list of segments, so it loads straight into the owner's arrays.
+// Each blob carries a header: a version the owner bumps when its layout
+// changes, the payload size, and a CRC32 of the payload.
+
+#define STORAGE_BLOB_MAGIC          0x424C4F42      // "BLOB"
+#define STORAGE_BLOB_MAX_SEGMENTS   8
+
+struct __attribute__((packed)) StorageBlobHeader {
+    uint32_t magic;             // STORAGE_BLOB_MAGIC
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t payload_size;
+    uint32_t payload_crc;
+};
+
+// =============================================================================
+// Export
+// =============================================================================
+
+// MSG_STORAGE_EXPORT_REQUEST streams the float values of a key range (ECU
+// base and/or subsystem) to the host in ascending key order. update() sends
+// a few frames per call, so a full backup runs alongside normal traffic
+// instead of flooding the bus queue:
+//
+//   host -> REQUEST   filters, window, resume_after_key
+//   ECU  -> START     keys left to send
+//   ECU  -> KEY       key, value - one per credit
+//   host -> CREDIT    more credits as it drains frames (or abort)
+//   ECU  -> COMPLETE  keys sent, success, last key sent
+//
+// Flow control is by credit: the request's window is the first grant and
+// each KEY frame spends one. A frame the bus refuses is sent again on the
+// next call. Because keys go out in order, the last key the host received
+// is a resume point - a new request with resume_after_key set to it
+// carries on from there. An export left without credit for
+// STORAGE_EXPORT_IDLE_MS is abandoned (COMPLETE with success = 0). Keys
+// whose value is not a 4-byte float are skipped.
+
+#define STORAGE_EXPORT_CHUNK        16              // Keys listed per backend scan
+#define STORAGE_EXPORT_FRAMES_PER_UPDATE 8
+#define STORAGE_EXPORT_IDLE_MS      5000
+
 // =============================================================================
 // StorageManager Class
 // =============================================================================
 
 class StorageManager {
 public:
-    static const int CACHE_SIZE = 20;  // Number of cache entries
+    static const int CACHE_SIZE = STORAGE_CACHE_SIZE;  // Number of cache entries
     
-    // Cache entry structure
+    // Cache entry structure; reference and dirty flags live in bitmaps
     struct CacheEntry {
         uint32_t storage_key;       // Extended CAN ID used as storage key
         float value;                // Cached value
-        uint32_t timestamp;         // Last access time
-        bool dirty;                 // Needs write to backend
-        uint32_t access_count;      // Access frequency counter
+        uint32_t dirty_since_ms;    // When the unwritten value was first saved
     };
     
     // Constructor
@@ -35,7 +115,9 @@ public:
     // Initialization
     bool init();
     
-    // Main update loop (call from main loop)
+    // Background flusher (call from a periodic task): writes back the
+    // oldest dirty entries within STORAGE_FLUSH_BUDGET_US, then advances
+    // any export
     void update();
     
     // Message handlers
@@ -43,12 +125,15 @@ public:
     void handle_load_float_message(const CANMessage* msg);
     void handle_commit_cache_message(const CANMessage* msg);
     void handle_stats_request_message(const CANMessage* msg);
+    void handle_export_request_message(const CANMessage* msg);
+    void handle_export_credit_message(const CANMessage* msg);
     
     // Direct access methods (for backwards compatibility)
     bool save_float(const char* key, float value);
     bool load_float(const char* key, float* value, float default_value = 0.0f);
     bool save_data(const char* key, const void* data, size_t size);
     bool load_data(const char* key, void* data, size_t size);
+    uint32_t convert_string_to_extended_can_id(const char* key);     // The ID a string key maps to
     
     // Extended CAN ID methods
     bool save_float(uint32_t storage_key, float value);
@@ -56,11 +141,22 @@ public:
     bool save_data(uint32_t storage_key, const void* data, size_t size);
     bool load_data(uint32_t storage_key, void* data, size_t size);
     
+    // Blob methods. load_blob() fails on a missing blob, a version or size
+    // mismatch or a bad CRC; the segments may then hold partial data.
+    bool save_blob(uint32_t storage_key, uint16_t version, const StorageSegment* segments, uint8_t count);
+    bool load_blob(uint32_t storage_key, uint16_t version, const StorageSegment* segments, uint8_t count);
+    
+    // Batched methods: one backend call for a set of keys, typically a
+    // module's whole configuration. Return how many items succeeded; each
+    // item's ok says which.
+    uint8_t save_many(StorageItem* items, uint8_t count);
+    uint8_t load_many(StorageItem* items, uint8_t count);
+    
     // Debug and maintenance methods
     void print_cache_info();
     void print_storage_info();
     bool verify_integrity();
-    void force_commit_cache();
+    void force_commit_cache();      // Flush now: every dirty entry, then the backend
     
     // Storage diagnostics
     void run_storage_diagnostics();
@@ -70,6 +166,12 @@ public:
     uint32_t get_cache_misses() const { return cache_misses; }
     uint32_t get_disk_writes() const { return disk_writes; }
     uint32_t get_disk_reads() const { return disk_reads; }
+    uint32_t get_cache_evictions() const { return cache_evictions; }
+    uint16_t get_cache_entry_count() const { return cache_count; }
+    uint32_t get_coalesced_saves() const { return coalesced_saves; }
+    uint16_t get_dirty_count();
+    bool is_cached(uint32_t storage_key);
+    bool is_exporting() const { return export_state.active; }
     
 private:
     // Backend storage
@@ -77,30 +179,59 @@ private:
     
     // Cache management
     CacheEntry cache[CACHE_SIZE];
-    int cache_index;  // Current cache index for round-robin
+    int16_t cache_slots[STORAGE_CACHE_INDEX_SLOTS];     // Entry index per hash slot, -1 if empty
+    uint32_t cache_referenced[STORAGE_CACHE_BITMAP_WORDS];
+    uint32_t cache_dirty[STORAGE_CACHE_BITMAP_WORDS];
+    uint16_t cache_count;
+    uint16_t clock_hand;
     
     // Statistics
     uint32_t cache_hits;
     uint32_t cache_misses;
+    uint32_t cache_evictions;
+    uint32_t coalesced_saves;       // Saves to an entry not yet written back
     uint32_t disk_writes;
     uint32_t disk_reads;
     
+    // Export in progress
+    struct ExportState {
+        bool active;
+        bool finishing;             // COMPLETE still to be published
+        bool success;
+        uint32_t mask;              // Keys with (key & mask) == match
+        uint32_t match;
+        uint32_t cursor;            // Last key sent (or the resume point)
+        uint32_t keys[STORAGE_EXPORT_CHUNK];    // Next keys above cursor
+        uint8_t key_count;
+        uint8_t key_pos;
+        uint16_t credits;
+        uint16_t keys_sent;
+        uint32_t last_credit_ms;
+    } export_state;
+    
     // Cache management methods
     bool save_to_cache(uint32_t storage_key, float value);
     bool load_from_cache(uint32_t storage_key, float* value);
-    void add_to_cache(uint32_t storage_key, float value);
+    int add_to_cache(uint32_t storage_key, float value);
     int find_cache_entry(uint32_t storage_key);
-    int find_oldest_cache_entry();
+    int select_victim();
+    void index_insert(int entry);
+    void index_remove(uint32_t storage_key);
+    int find_oldest_dirty(uint32_t now_ms);
+    bool write_back(int entry);
     void commit_dirty_entries();
     
+    // Export methods
+    uint32_t list_export_keys(uint32_t* keys, uint32_t max);
+    bool read_export_value(uint32_t storage_key, float* value);
+    void export_step(uint32_t now_ms);
+    void finish_export(bool success);
+    
     // Response helpers
     void send_save_response(uint32_t storage_key, bool success);
     void send_load_response(uint32_t storage_key, float value, bool success);
     void send_error_response(uint32_t storage_key, uint8_t error_code);
     void send_stats_response();
-    
-    // String to CAN ID conversion
-    uint32_t convert_string_to_extended_can_id(const char* key);
 };
 
 // =============================================================================
@@ -117,6 +248,8 @@ void storage_save_float_handler(const CANMessage* msg);
 void storage_load_float_handler(const CANMessage* msg);
 void storage_commit_cache_handler(const CANMessage* msg);
 void storage_stats_handler(const CANMessage* msg);
+void storage_export_request_handler(const CANMessage* msg);
+void storage_export_credit_handler(const CANMessage* msg);
 
 // =============================================================================
 // Convenience Macros
@@ -136,7 +269,8 @@ void storage_stats_handler(const CANMessage* msg);
     g_message_bus.publish(MSG_STORAGE_LOAD, &msg, sizeof(msg)); \
 } while(0)
 
-// Common storage operations for map cells
+// Per-cell map storage. Tables persist as blobs (see map_tables.h); these
+// keys remain for tools and tunes that address single cells.
 #define STORAGE_SAVE_FUEL_MAP_CELL(row, col, value) \
     STORAGE_SAVE_FLOAT(MSG_FUEL_MAP_CELL(row, col), value)
 
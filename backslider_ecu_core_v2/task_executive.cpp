@@ -0,0 +1,290 @@
+// task_executive.cpp
+// Slot releases, task timing and idle accounting for the main loop
+
+#include "task_executive.h"
+#include "msg_definitions.h"
+#include "msg_bus.h"
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+static const uint32_t slot_period_us[TASK_RATE_BACKGROUND] = {1000, 10000, 100000};
+static const uint32_t loop_bucket_edges_us[TASK_LOOP_HISTOGRAM_BUCKETS] = TASK_LOOP_HISTOGRAM_EDGES_US;
+
+static task_t tasks[TASK_EXECUTIVE_MAX_TASKS];
+static uint8_t task_count = 0;
+
+static uint32_t next_release_us[TASK_RATE_BACKGROUND];
+static uint32_t slot_misses[TASK_RATE_BACKGROUND];
+static uint32_t total_overruns = 0;
+
+// Idle accounting
+static uint32_t window_start_us = 0;
+static uint32_t window_busy_us = 0;
+static float idle_percent = 100.0f;
+
+static loop_histogram_t loop_histogram;
+
+#ifdef TESTING
+static uint32_t (*duration_clock_us)(void) = nullptr;
+#endif
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+// Clock for run and pass durations (micros() outside the replay harness)
+static inline uint32_t duration_now_us(void) {
+#ifdef TESTING
+    if (duration_clock_us) {
+        return duration_clock_us();
+    }
+#endif
+    return micros();
+}
+
+static void run_task(task_t* task) {
+    uint32_t release_us = micros();
+    uint32_t start_us = duration_now_us();
+    task->function();
+    uint32_t elapsed_us = duration_now_us() - start_us;
+
+    task->last_start_us = release_us;
+    task->last_us = elapsed_us;
+    if (elapsed_us > task->max_us) {
+        task->max_us = elapsed_us;
+    }
+    task->window_us += elapsed_us;
+    task->runs++;
+    if (elapsed_us > task->budget_us) {
+        task->overruns++;
+        total_overruns++;
+    }
+    window_busy_us += elapsed_us;
+}
+
+static void run_slot(uint8_t rate) {
+    for (uint8_t i = 0; i < task_count; i++) {
+        if (tasks[i].rate == rate) {
+            run_task(&tasks[i]);
+        }
+    }
+}
+
+static void record_loop_time(uint32_t loop_us) {
+    uint8_t bucket = 0;
+    while (loop_us > loop_bucket_edges_us[bucket]) {
+        bucket++;       // Last edge is UINT32_MAX, so this stops
+    }
+    loop_histogram.counts[bucket]++;
+    loop_histogram.samples++;
+    if (loop_us < loop_histogram.min_us) {
+        loop_histogram.min_us = loop_us;
+    }
+    if (loop_us > loop_histogram.max_us) {
+        loop_histogram.max_us = loop_us;
+    }
+}
+
+static void publish_window_stats(void) {
+    g_message_bus.publishFloat(MSG_CPU_LOAD, task_executive_get_cpu_load_percent());
+    if (loop_histogram.samples > 0) {
+        g_message_bus.publishFloat(MSG_LOOP_TIME_MIN_US, (float)loop_histogram.min_us);
+        g_message_bus.publishFloat(MSG_LOOP_TIME_MAX_US, (float)loop_histogram.max_us);
+        g_message_bus.publishFloat(MSG_LOOP_TIME_P99_US, (float)task_executive_get_loop_p99_us());
+    }
+    for (uint8_t i = 0; i < task_count; i++) {
+        g_message_bus.publishFloat(MSG_TASK_LOAD(i), tasks[i].load_percent);
+    }
+}
+
+// Time left before the earliest periodic release (negative if one is due)
+static int32_t slack_us(uint32_t now_us) {
+    int32_t slack = (int32_t)(next_release_us[0] - now_us);
+    for (uint8_t rate = 1; rate < TASK_RATE_BACKGROUND; rate++) {
+        int32_t until = (int32_t)(next_release_us[rate] - now_us);
+        if (until < slack) {
+            slack = until;
+        }
+    }
+    return slack;
+}
+
+// Returns true if any background task ran
+static bool run_background(void) {
+    bool ran = false;
+    for (uint8_t i = 0; i < task_count; i++) {
+        task_t* task = &tasks[i];
+        if (task->rate != TASK_RATE_BACKGROUND) {
+            continue;
+        }
+        uint32_t now_us = micros();
+        bool starved = (now_us - task->last_start_us) >= TASK_BACKGROUND_MAX_WAIT_US;
+        if (!starved && slack_us(now_us) < (int32_t)task->budget_us) {
+            task->deferrals++;
+            continue;
+        }
+        run_task(task);
+        ran = true;
+    }
+    return ran;
+}
+
+static void update_idle_window(uint32_t now_us) {
+    uint32_t elapsed_us = now_us - window_start_us;
+    if (elapsed_us < TASK_EXECUTIVE_WINDOW_US) {
+        return;
+    }
+    uint32_t busy_us = (window_busy_us < elapsed_us) ? window_busy_us : elapsed_us;
+    idle_percent = 100.0f * (float)(elapsed_us - busy_us) / (float)elapsed_us;
+    for (uint8_t i = 0; i < task_count; i++) {
+        tasks[i].load_percent = 100.0f * (float)tasks[i].window_us / (float)elapsed_us;
+        tasks[i].window_us = 0;
+    }
+    window_start_us = now_us;
+    window_busy_us = 0;
+    publish_window_stats();
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void task_executive_init(void) {
+    task_count = 0;
+    total_overruns = 0;
+    uint32_t now_us = micros();
+    for (uint8_t rate = 0; rate < TASK_RATE_BACKGROUND; rate++) {
+        next_release_us[rate] = now_us;
+        slot_misses[rate] = 0;
+    }
+    window_start_us = now_us;
+    window_busy_us = 0;
+    idle_percent = 100.0f;
+    task_executive_reset_loop_stats();
+}
+
+int8_t task_executive_add(const char* name, task_function_t function, uint8_t rate, uint32_t budget_us) {
+    if (function == nullptr || rate >= TASK_RATE_COUNT || task_count >= TASK_EXECUTIVE_MAX_TASKS) {
+        return -1;
+    }
+    task_t* task = &tasks[task_count];
+    task->name = name;
+    task->function = function;
+    task->rate = rate;
+    task->budget_us = budget_us;
+    task->runs = 0;
+    task->overruns = 0;
+    task->deferrals = 0;
+    task->last_us = 0;
+    task->max_us = 0;
+    task->last_start_us = micros();
+    task->window_us = 0;
+    task->load_percent = 0.0f;
+    return (int8_t)task_count++;
+}
+
+void task_executive_run(void) {
+    uint32_t pass_start_us = duration_now_us();
+    bool worked = false;
+
+    for (uint8_t rate = 0; rate < TASK_RATE_BACKGROUND; rate++) {
+        if ((int32_t)(micros() - next_release_us[rate]) < 0) {
+            continue;
+        }
+        run_slot(rate);
+        worked = true;
+        next_release_us[rate] += slot_period_us[rate];
+
+        uint32_t now_us = micros();
+        if ((int32_t)(now_us - next_release_us[rate]) >= 0) {
+            // A whole period behind: drop the missed releases
+            slot_misses[rate]++;
+            next_release_us[rate] = now_us + slot_period_us[rate];
+        }
+    }
+
+    if (run_background()) {
+        worked = true;
+    }
+
+    if (worked) {
+        record_loop_time(duration_now_us() - pass_start_us);
+    }
+    update_idle_window(micros());
+}
+
+uint32_t task_executive_get_period_us(uint8_t rate) {
+    return (rate < TASK_RATE_BACKGROUND) ? slot_period_us[rate] : 0;
+}
+
+uint8_t task_executive_get_task_count(void) {
+    return task_count;
+}
+
+const task_t* task_executive_get_task(uint8_t index) {
+    return (index < task_count) ? &tasks[index] : nullptr;
+}
+
+uint32_t task_executive_get_slot_misses(uint8_t rate) {
+    return (rate < TASK_RATE_BACKGROUND) ? slot_misses[rate] : 0;
+}
+
+uint32_t task_executive_get_total_overruns(void) {
+    return total_overruns;
+}
+
+float task_executive_get_idle_percent(void) {
+    return idle_percent;
+}
+
+float task_executive_get_cpu_load_percent(void) {
+    return 100.0f - idle_percent;
+}
+
+const loop_histogram_t* task_executive_get_loop_histogram(void) {
+    return &loop_histogram;
+}
+
+uint32_t task_executive_get_loop_bucket_edge_us(uint8_t bucket) {
+    return (bucket < TASK_LOOP_HISTOGRAM_BUCKETS) ? loop_bucket_edges_us[bucket] : 0;
+}
+
+uint32_t task_executive_get_loop_p99_us(void) {
+    if (loop_histogram.samples == 0) {
+        return 0;
+    }
+    // Smallest bucket edge with at least 99% of samples at or below it
+    uint32_t target = loop_histogram.samples - loop_histogram.samples / 100;
+    uint32_t cumulative = 0;
+    for (uint8_t bucket = 0; bucket < TASK_LOOP_HISTOGRAM_BUCKETS; bucket++) {
+        cumulative += loop_histogram.counts[bucket];
+        if (cumulative >= target) {
+            // The open-ended top bucket reports the exact maximum instead
+            return (bucket == TASK_LOOP_HISTOGRAM_BUCKETS - 1) ? loop_histogram.max_us : loop_bucket_edges_us[bucket];
+        }
+    }
+    return loop_histogram.max_us;
+}
+
+void task_executive_reset_loop_stats(void) {
+    for (uint8_t bucket = 0; bucket < TASK_LOOP_HISTOGRAM_BUCKETS; bucket++) {
+        loop_histogram.counts[bucket] = 0;
+    }
+    loop_histogram.samples = 0;
+    loop_histogram.min_us = UINT32_MAX;
+    loop_histogram.max_us = 0;
+}
+
+#ifdef TESTING
+void task_executive_set_duration_clock_for_testing(uint32_t (*clock_us)(void)) {
+    duration_clock_us = clock_us;
+}
+#endif
@@ -0,0 +1,133 @@
+// task_executive.h
+// Fixed-rate cooperative task slots for the main loop
+
+/* =============================================================================
+ * TASK EXECUTIVE OVERVIEW
+ * =============================================================================
+ *
+ * Module updates register as tasks in one of four slots instead of each
+ * being called on every loop and re-checking millis() for itself:
+ *
+ *   TASK_RATE_1KHZ        every 1 ms     timing-adjacent work, bus delivery
+ *   TASK_RATE_100HZ       every 10 ms    control logic
+ *   TASK_RATE_10HZ        every 100 ms   output refresh, slow publishing
+ *   TASK_RATE_BACKGROUND  every pass     communications, housekeeping
+ *
+ * task_executive_run() is one main-loop pass. Each periodic slot that is
+ * due runs its tasks in registration order, fastest slot first, and its
+ * next release moves on by exactly one period so the rate does not drift.
+ * A slot that falls a whole period behind skips the missed releases
+ * (counted as slot misses) rather than running back to back to catch up.
+ *
+ * Budgets: every task has a time budget. Nothing is preempted - this is a
+ * cooperative executive - but a periodic task that runs past its budget
+ * counts an overrun, and a background task only starts if its budget fits
+ * before the next periodic release. A background task kept waiting for
+ * TASK_BACKGROUND_MAX_WAIT_US runs anyway, so none starves.
+ *
+ * Load accounting, over TASK_EXECUTIVE_WINDOW_US windows:
+ * - CPU load is time spent in tasks over wall time; the rest is idle (the
+ *   loop spinning with no slot due).
+ * - Each task's share of wall time is its load_percent, so a spike can be
+ *   pinned on the module that caused it.
+ *
+ * Loop-time histogram: every pass that ran at least one task is timed
+ * into TASK_LOOP_HISTOGRAM_BUCKETS fixed buckets (edges in
+ * TASK_LOOP_HISTOGRAM_EDGES_US), with exact min and max. Empty passes are
+ * left out - thousands of 1 µs spins would bury the passes that matter.
+ * p99 is reported as the upper edge of the bucket holding the 99th
+ * percentile. The histogram accumulates until
+ * task_executive_reset_loop_stats(), so a run on track keeps its worst
+ * case.
+ *
+ * At the end of each window the executive publishes MSG_CPU_LOAD,
+ * MSG_LOOP_TIME_MIN_US/MAX_US/P99_US and MSG_TASK_LOAD(index) per task.
+ *
+ * EXAMPLE:
+ *   task_executive_add("outputs", output_manager_update, TASK_RATE_10HZ, 500);
+ *   for (;;) task_executive_run();
+ * =============================================================================
+ */
+
+#ifndef TASK_EXECUTIVE_H
+#define TASK_EXECUTIVE_H
+
+#include <stdint.h>
+
+#define TASK_RATE_1KHZ                  0
+#define TASK_RATE_100HZ                 1
+#define TASK_RATE_10HZ                  2
+#define TASK_RATE_BACKGROUND            3
+#define TASK_RATE_COUNT                 4
+
+#define TASK_EXECUTIVE_MAX_TASKS        16
+#define TASK_EXECUTIVE_WINDOW_US        1000000     // Load accounting and publish window
+#define TASK_BACKGROUND_MAX_WAIT_US     100000      // Longest a background task is held off
+
+#define TASK_LOOP_HISTOGRAM_BUCKETS     16
+#define TASK_LOOP_HISTOGRAM_EDGES_US    {10, 20, 50, 100, 200, 300, 500, 750, \
+                                         1000, 1500, 2000, 3000, 5000, 10000, 20000, UINT32_MAX}
+
+typedef void (*task_function_t)(void);
+
+typedef struct {
+    const char* name;
+    task_function_t function;
+    uint8_t rate;                   // TASK_RATE_*
+    uint32_t budget_us;
+    uint32_t runs;
+    uint32_t overruns;              // Runs longer than budget_us
+    uint32_t deferrals;             // Background only: passes held off for lack of slack
+    uint32_t last_us;               // Duration of the latest run
+    uint32_t max_us;
+    uint32_t last_start_us;
+    uint32_t window_us;             // Time spent in the current window
+    float load_percent;             // Share of wall time over the last window
+} task_t;
+
+typedef struct {
+    uint32_t counts[TASK_LOOP_HISTOGRAM_BUCKETS];
+    uint32_t samples;
+    uint32_t min_us;
+    uint32_t max_us;
+} loop_histogram_t;
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Drop all tasks and counters; slot releases start from now
+void task_executive_init(void);
+
+// Register a task. Returns its index, or -1 if the table is full or the
+// arguments are invalid.
+int8_t task_executive_add(const char* name, task_function_t function, uint8_t rate, uint32_t budget_us);
+
+// One main-loop pass: due periodic slots, then background tasks that fit
+void task_executive_run(void);
+
+// Period of a slot in µs (0 for background)
+uint32_t task_executive_get_period_us(uint8_t rate);
+
+// Diagnostics
+uint8_t task_executive_get_task_count(void);
+const task_t* task_executive_get_task(uint8_t index);
+uint32_t task_executive_get_slot_misses(uint8_t rate);
+uint32_t task_executive_get_total_overruns(void);
+float task_executive_get_idle_percent(void);        // Over the last complete window
+float task_executive_get_cpu_load_percent(void);    // 100 - idle
+
+// Loop-time histogram of working passes
+const loop_histogram_t* task_executive_get_loop_histogram(void);
+uint32_t task_executive_get_loop_bucket_edge_us(uint8_t bucket);    // Upper edge
+uint32_t task_executive_get_loop_p99_us(void);      // 0 before any sample
+void task_executive_reset_loop_stats(void);
+
+#ifdef TESTING
+// Time task runs and loop passes with another clock while releases still
+// follow micros() - the replay harness passes host time so a recording
+// can play faster than real time. nullptr goes back to micros().
+void task_executive_set_duration_clock_for_testing(uint32_t (*clock_us)(void));
+#endif
+
+#endif
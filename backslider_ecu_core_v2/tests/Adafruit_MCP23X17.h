@@ -0,0 +1,4 @@
+// Adafruit_MCP23X17.h - Mock for desktop testing
+// main_application.cpp includes it unconditionally; the mocks live in mock_arduino.h
+
+#include "mock_arduino.h"
@@ -0,0 +1,4 @@
+// Wire.h - Mock for desktop testing
+// main_application.cpp includes it unconditionally; the mocks live in mock_arduino.h
+
+#include "mock_arduino.h"
@@ -0,0 +1,168 @@
+// tests/bench.h
+// Timing loop, JSON output and baseline check shared by the module benchmarks
+//
+// A benchmark file defines its cases in a function and hands it to
+// bench_main():
+//
+//   static void run_benchmarks() {
+//       bench_run("lookup_hit", BATCH, [] { refill(); }, [] { for (...) lookup(); });
+//   }
+//   int main(int argc, char** argv) { return bench_main(argc, argv, "parameter_registry", run_benchmarks); }
+//
+// bench_run() calls setup (untimed - refill queues, drain the bus) and then
+// body (timed, BATCH operations) --rounds times, and keeps the best
+// average of BENCH_REPEATS repeats to reject scheduler noise.
+//
+// Output matches message_bus/bench_message_bus: JSON to stdout or
+// --output FILE, and --baseline FILE --tolerance PCT exits non-zero if any
+// case is slower than the baseline by more than PCT. bench_compare.py
+// merges the files of several suites and compares them in one go.
+//
+// Absolute numbers depend on the host; compare only runs from the same
+// machine.
+
+#ifndef TESTS_BENCH_H
+#define TESTS_BENCH_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+
+#define BENCH_DEFAULT_ROUNDS    2000    // Timed batches per case
+#define BENCH_REPEATS           5       // Best-of repeats
+
+struct BenchResult {
+    std::string name;
+    double ns_per_op;
+    uint32_t ops;
+};
+
+static std::vector<BenchResult> bench_results;
+static int bench_rounds = BENCH_DEFAULT_ROUNDS;
+
+// Sink so the compiler cannot discard the work under test
+static volatile uint32_t bench_sink = 0;
+
+template <typename Setup, typename Body>
+static void bench_run(const char* name, uint32_t ops_per_round, Setup setup, Body body) {
+    double best = 1e30;
+    for (int repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+        double total_ns = 0;
+        for (int round = 0; round < bench_rounds; round++) {
+            setup();
+            auto start = std::chrono::steady_clock::now();
+            body();
+            auto end = std::chrono::steady_clock::now();
+            total_ns += std::chrono::duration<double, std::nano>(end - start).count();
+        }
+        double per_op = total_ns / ((double)bench_rounds * ops_per_round);
+        if (per_op < best) best = per_op;
+    }
+    BenchResult result = {name, best, (uint32_t)bench_rounds * ops_per_round};
+    bench_results.push_back(result);
+    std::cerr << "  " << name << ": " << best << " ns/op" << std::endl;
+}
+
+static std::string bench_results_json(const char* suite) {
+    std::ostringstream out;
+    out << "{\n  \"suite\": \"" << suite << "\",\n  \"rounds\": " << bench_rounds << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < bench_results.size(); i++) {
+        out << "    {\"name\": \"" << bench_results[i].name << "\", \"ns_per_op\": " << bench_results[i].ns_per_op
+            << ", \"ops\": " << bench_results[i].ops << "}" << (i + 1 < bench_results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+// Minimal reader for the format written above: finds each "name" and the
+// "ns_per_op" that follows it
+static bool bench_load_baseline(const char* path, std::vector<BenchResult>& baseline) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+
+    size_t pos = 0;
+    while ((pos = text.find("\"name\": \"", pos)) != std::string::npos) {
+        pos += 9;
+        size_t end = text.find('"', pos);
+        size_t value = text.find("\"ns_per_op\": ", end);
+        if (end == std::string::npos || value == std::string::npos) break;
+        BenchResult r;
+        r.name = text.substr(pos, end - pos);
+        r.ns_per_op = atof(text.c_str() + value + 13);
+        r.ops = 0;
+        baseline.push_back(r);
+        pos = value;
+    }
+    return !baseline.empty();
+}
+
+static int bench_compare_to_baseline(const std::vector<BenchResult>& baseline, double tolerance_pct) {
+    int regressions = 0;
+    for (size_t i = 0; i < bench_results.size(); i++) {
+        for (size_t j = 0; j < baseline.size(); j++) {
+            if (baseline[j].name != bench_results[i].name || baseline[j].ns_per_op <= 0) continue;
+            double change = (bench_results[i].ns_per_op - baseline[j].ns_per_op) * 100.0 / baseline[j].ns_per_op;
+            bool regressed = change > tolerance_pct;
+            std::cerr << (regressed ? "REGRESSION " : "ok         ") << bench_results[i].name
+                      << ": " << baseline[j].ns_per_op << " -> " << bench_results[i].ns_per_op
+                      << " ns/op (" << (change >= 0 ? "+" : "") << change << "%)" << std::endl;
+            if (regressed) regressions++;
+        }
+    }
+    return regressions;
+}
+
+static int bench_main(int argc, char** argv, const char* suite, void (*run_benchmarks)(void)) {
+    const char* output_path = NULL;
+    const char* baseline_path = NULL;
+    double tolerance_pct = 20.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance_pct = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            bench_rounds = atoi(argv[++i]);
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--output FILE] [--baseline FILE] [--tolerance PCT] [--rounds N]" << std::endl;
+            return 2;
+        }
+    }
+    if (bench_rounds <= 0) bench_rounds = BENCH_DEFAULT_ROUNDS;
+
+    std::cerr << "=== " << suite << " benchmarks ===" << std::endl;
+    run_benchmarks();
+
+    std::string json = bench_results_json(suite);
+    if (output_path) {
+        std::ofstream out(output_path);
+        out << json;
+    } else {
+        std::cout << json;
+    }
+
+    if (baseline_path) {
+        std::vector<BenchResult> baseline;
+        if (!bench_load_baseline(baseline_path, baseline)) {
+            std::cerr << "Cannot read baseline " << baseline_path << std::endl;
+            return 2;
+        }
+        return bench_compare_to_baseline(baseline, tolerance_pct) > 0 ? 1 : 0;
+    }
+    return 0;
+}
+
+#endif
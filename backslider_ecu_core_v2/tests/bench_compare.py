@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""
+Merge the JSON written by the module benchmarks (tests/bench.h and
+message_bus/bench_message_bus) into one file and optionally check it
+against a saved baseline.
+
+    python3 bench_compare.py --output bench_results.json \\
+        message_bus/bench_results.json input_manager/bench_results.json ...
+    python3 bench_compare.py --output bench_results.json \\
+        --baseline bench_baseline.json --tolerance 20 <suite files>
+
+Merged case names are "suite/name". A baseline may be an earlier merged
+file or a single suite's file. Exits 1 if any case is slower than its
+baseline by more than the tolerance, 2 if an input cannot be read.
+"""
+
+import argparse
+import json
+import sys
+from typing import Dict
+
+
+def load_cases(path: str) -> Dict[str, float]:
+    """Case name -> ns/op; single-suite files get their suite prefix."""
+    with open(path) as f:
+        data = json.load(f)
+    suite = data.get("suite")
+    cases = {}
+    for result in data.get("results", []):
+        name = result["name"]
+        if suite and "/" not in name:
+            name = suite + "/" + name
+        cases[name] = float(result["ns_per_op"])
+    return cases
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("inputs", nargs="+", help="per-suite benchmark JSON files")
+    parser.add_argument("--output", help="write the merged results here")
+    parser.add_argument("--baseline", help="earlier results to compare against")
+    parser.add_argument("--tolerance", type=float, default=20.0, help="allowed slowdown in percent (default 20)")
+    args = parser.parse_args()
+
+    merged = {}
+    try:
+        for path in args.inputs:
+            merged.update(load_cases(path))
+        baseline = load_cases(args.baseline) if args.baseline else {}
+    except (OSError, ValueError, KeyError) as error:
+        print("Cannot read benchmark results: %s" % error, file=sys.stderr)
+        return 2
+
+    if args.output:
+        results = [{"name": name, "ns_per_op": ns} for name, ns in sorted(merged.items())]
+        with open(args.output, "w") as f:
+            json.dump({"suite": "all", "results": results}, f, indent=2)
+            f.write("\n")
+
+    regressions = 0
+    for name, ns in sorted(merged.items()):
+        before = baseline.get(name)
+        if before is None or before <= 0:
+            print("%-60s %10.2f ns/op" % (name, ns))
+            continue
+        change = (ns - before) * 100.0 / before
+        regressed = change > args.tolerance
+        regressions += regressed
+        print("%-60s %10.2f ns/op  (%+.1f%% vs %.2f)%s"
+              % (name, ns, change, before, "  REGRESSION" if regressed else ""))
+
+    if baseline:
+        missing = sorted(set(baseline) - set(merged))
+        for name in missing:
+            print("%-60s not run (in baseline)" % name)
+        print("%d regression(s) beyond %.0f%%" % (regressions, args.tolerance))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
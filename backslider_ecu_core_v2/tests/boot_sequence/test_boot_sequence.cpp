@@ -0,0 +1,227 @@
+// tests/boot_sequence/test_boot_sequence.cpp
+// Test suite for boot stage timing, deferred stages and the boot report
+
+#include <iostream>
+#include <cassert>
+#include <map>
+#include <string>
+#include <vector>
+
+// Include enhanced mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../task_executive.h"
+#include "../../boot_sequence.h"
+
+// Simple test framework
+int tests_run = 0;
+int tests_passed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        std::cout << "  Running test: " #name "... "; \
+        tests_run++; \
+        test_##name(); \
+        tests_passed++; \
+        std::cout << "PASSED" << std::endl; \
+    } \
+    void test_##name()
+
+static std::vector<std::string> ran;
+static std::map<uint32_t, float> received;
+
+// Stage context: how long the stage takes and whether it succeeds
+typedef struct {
+    const char* name;
+    uint32_t duration_us;
+    bool ok;
+} fake_stage_t;
+
+static bool fake_stage(void* context) {
+    fake_stage_t* stage = static_cast<fake_stage_t*>(context);
+    ran.push_back(stage->name);
+    mock_advance_time_us(stage->duration_us);
+    return stage->ok;
+}
+
+static void task_noop(void) {
+}
+
+// A deferred stage that starts a periodic job when it is done
+static bool stage_adds_task(void* context) {
+    (void)context;
+    ran.push_back("adds_task");
+    return task_executive_add("late", task_noop, TASK_RATE_BACKGROUND, 10) >= 0;
+}
+
+static void record_message(const CANMessage* msg) {
+    received[msg->id] = MSG_UNPACK_FLOAT(msg);
+}
+
+static void setup(void) {
+    mock_reset_all();
+    g_message_bus.init();
+    task_executive_init();
+    boot_sequence_init();
+    ran.clear();
+    received.clear();
+}
+
+// Test that foreground stages run at once, in order, timed
+TEST(foreground_stages_timed) {
+    setup();
+    fake_stage_t outputs = {"outputs", 200, true};
+    fake_stage_t storage = {"storage", 5000, true};
+    assert(boot_sequence_run("outputs", fake_stage, &outputs));
+    assert(boot_sequence_run("storage", fake_stage, &storage));
+
+    assert(ran.size() == 2);
+    assert(ran[0] == "outputs" && ran[1] == "storage");
+    assert(boot_sequence_get_stage_count() == 2);
+    const boot_stage_t* stage = boot_sequence_get_stage(1);
+    assert(stage->done && stage->ok && !stage->deferred);
+    assert(stage->start_us == 200);
+    assert(stage->duration_us == 5000);
+    assert(boot_sequence_get_stage(2) == nullptr);
+
+    boot_sequence_ready();
+    assert(boot_sequence_get_ready_us() == 5200);
+}
+
+// Test that deferred stages wait for ready and then run one per update
+TEST(deferred_stages_one_per_update) {
+    setup();
+    fake_stage_t serial = {"serial", 300, true};
+    fake_stage_t canbus = {"canbus", 700, true};
+    assert(boot_sequence_defer("serial", fake_stage, &serial));
+    assert(boot_sequence_defer("canbus", fake_stage, &canbus));
+    assert(ran.empty());
+
+    boot_sequence_update();         // Not ready yet
+    assert(ran.empty());
+
+    boot_sequence_ready();
+    boot_sequence_update();
+    assert(ran.size() == 1 && ran[0] == "serial");
+    assert(!boot_sequence_is_complete());
+    boot_sequence_update();
+    assert(ran.size() == 2 && ran[1] == "canbus");
+    assert(boot_sequence_get_stage(1)->duration_us == 700);
+
+    boot_sequence_update();
+    assert(boot_sequence_is_complete());
+    assert(boot_sequence_get_complete_us() == 1000);
+
+    boot_sequence_update();         // Nothing left
+    assert(ran.size() == 2);
+}
+
+// Test that a failed stage is recorded and the boot carries on
+TEST(failed_stage_recorded) {
+    setup();
+    fake_stage_t config = {"config", 100, false};
+    fake_stage_t sd = {"sd", 100, false};
+    fake_stage_t diag = {"diag", 100, true};
+    assert(!boot_sequence_run("config", fake_stage, &config));
+    boot_sequence_defer("sd", fake_stage, &sd);
+    boot_sequence_defer("diag", fake_stage, &diag);
+    boot_sequence_ready();
+    for (int i = 0; i < 3; i++) {
+        boot_sequence_update();
+    }
+    assert(boot_sequence_is_complete());
+    assert(ran.size() == 3);
+    assert(boot_sequence_get_failed_count() == 2);
+    assert(!boot_sequence_get_stage(0)->ok);
+    assert(boot_sequence_get_stage(2)->ok);
+}
+
+// Test that the report is published once, with one duration per stage
+TEST(report_published_on_completion) {
+    setup();
+    g_message_bus.subscribe(MSG_BOOT_READY_US, record_message);
+    g_message_bus.subscribe(MSG_BOOT_COMPLETE_US, record_message);
+    g_message_bus.subscribe(MSG_BOOT_FAILED_STAGES, record_message);
+    g_message_bus.subscribe(MSG_BOOT_STAGE_US(0), record_message);
+    g_message_bus.subscribe(MSG_BOOT_STAGE_US(1), record_message);
+
+    fake_stage_t outputs = {"outputs", 400, true};
+    fake_stage_t logger = {"logger", 2500, false};
+    boot_sequence_run("outputs", fake_stage, &outputs);
+    boot_sequence_defer("logger", fake_stage, &logger);
+    boot_sequence_ready();
+
+    boot_sequence_update();
+    g_message_bus.process();
+    assert(received.empty());
+
+    boot_sequence_update();
+    g_message_bus.process();
+    assert(received.size() == 5);
+    assert(received[MSG_BOOT_READY_US] == 400.0f);
+    assert(received[MSG_BOOT_COMPLETE_US] == 2900.0f);
+    assert(received[MSG_BOOT_FAILED_STAGES] == 1.0f);
+    assert(received[MSG_BOOT_STAGE_US(0)] == 400.0f);
+    assert(received[MSG_BOOT_STAGE_US(1)] == 2500.0f);
+
+    received.clear();
+    boot_sequence_update();
+    g_message_bus.process();
+    assert(received.empty());
+}
+
+// Test that the stage table is bounded
+TEST(stage_table_full) {
+    setup();
+    fake_stage_t stage = {"stage", 0, true};
+    for (int i = 0; i < BOOT_SEQUENCE_MAX_STAGES; i++) {
+        assert(boot_sequence_defer("stage", fake_stage, &stage));
+    }
+    assert(!boot_sequence_defer("one_more", fake_stage, &stage));
+    assert(!boot_sequence_run("one_more", fake_stage, &stage));
+    assert(!boot_sequence_defer("null", nullptr, nullptr));
+}
+
+// Test deferred stages run from the executive's background slot and can
+// register tasks of their own
+TEST(runs_from_task_executive) {
+    setup();
+    boot_sequence_defer("adds_task", stage_adds_task, nullptr);
+    task_executive_add("boot", boot_sequence_update, TASK_RATE_BACKGROUND, BOOT_SEQUENCE_TASK_BUDGET_US);
+    boot_sequence_ready();
+
+    for (int i = 0; i < 5 && !boot_sequence_is_complete(); i++) {
+        mock_advance_time_us(100);
+        task_executive_run();
+    }
+    assert(boot_sequence_is_complete());
+    assert(ran.size() == 1);
+    assert(task_executive_get_task_count() == 2);
+    assert(task_executive_get_task(1)->runs > 0);
+}
+
+// Main test runner
+int main() {
+    std::cout << "=== Boot Sequence Tests ===" << std::endl;
+
+    run_test_foreground_stages_timed();
+    run_test_deferred_stages_one_per_update();
+    run_test_failed_stage_recorded();
+    run_test_report_published_on_completion();
+    run_test_stage_table_full();
+    run_test_runs_from_task_executive();
+
+    std::cout << std::endl;
+    std::cout << "Boot Sequence Tests - Run: " << tests_run << ", Passed: " << tests_passed << std::endl;
+
+    if (tests_passed == tests_run) {
+        std::cout << "✅ ALL BOOT SEQUENCE TESTS PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME TESTS FAILED!" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,266 @@
+// tests/can_router/test_can_router.cpp
+// Test suite for routing messages between the internal bus and other ECUs
+
+#include <iostream>
+#include <cassert>
+#include <vector>
+
+// Include enhanced mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../can_router.h"
+#include "../../transmission_module.h"
+
+// Simple test framework
+int tests_run = 0;
+int tests_passed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        std::cout << "  Running test: " #name "... "; \
+        tests_run++; \
+        test_##name(); \
+        tests_passed++; \
+        std::cout << "PASSED" << std::endl; \
+    } \
+    void test_##name()
+
+typedef struct {
+    uint32_t id;
+    float value;
+} sent_frame_t;
+
+static std::vector<sent_frame_t> sent;
+static std::vector<sent_frame_t> delivered;
+static bool transmit_ok = true;
+
+static bool fake_transmit(uint32_t can_id, const uint8_t* data, uint8_t length) {
+    if (!transmit_ok) {
+        return false;
+    }
+    float value = 0.0f;
+    if (length == sizeof(float)) {
+        memcpy(&value, data, sizeof(float));
+    }
+    sent.push_back({can_id, value});
+    return true;
+}
+
+static void record_message(const CANMessage* msg) {
+    delivered.push_back({msg->id, MSG_UNPACK_FLOAT(msg)});
+}
+
+static bool receive_float(uint32_t can_id, float value) {
+    return can_router_receive(can_id, (const uint8_t*)&value, sizeof(value));
+}
+
+#define TRANSMISSION_FAMILY  MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_TRANSMISSION, 0)
+#define FAMILY_MASK          (ECU_BASE_MASK | SUBSYSTEM_MASK)
+
+static void setup(void) {
+    mock_reset_all();
+    g_message_bus.init();
+    g_message_bus.resetSubscribers();
+    can_router_init();
+    can_router_set_transmit(fake_transmit);
+    sent.clear();
+    delivered.clear();
+    transmit_ok = true;
+}
+
+// Test route lookup: first match wins, unlisted IDs stay local
+TEST(route_modes) {
+    setup();
+    assert(can_router_add_route(MSG_VEHICLE_SPEED, 0xFFFFFFFF, CAN_ROUTE_LOCAL, 0));
+    assert(can_router_add_route(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, 0),
+                                FAMILY_MASK, CAN_ROUTE_REPLICATED, 0));
+    assert(can_router_add_route(TRANSMISSION_FAMILY, FAMILY_MASK, CAN_ROUTE_REMOTE, 0));
+
+    assert(can_router_get_mode(MSG_VEHICLE_SPEED) == CAN_ROUTE_LOCAL);
+    assert(can_router_get_mode(MSG_THROTTLE_POSITION) == CAN_ROUTE_REPLICATED);
+    assert(can_router_get_mode(MSG_TRANS_CURRENT_GEAR) == CAN_ROUTE_REMOTE);
+    assert(can_router_get_mode(MSG_BOOT_READY_US) == CAN_ROUTE_LOCAL);
+    assert(can_router_get_route_count() == 3);
+
+    // The exempted ID is delivered locally but not forwarded
+    g_message_bus.publishFloat(MSG_VEHICLE_SPEED, 50.0f);
+    g_message_bus.publishFloat(MSG_THROTTLE_POSITION, 20.0f);
+    g_message_bus.process();
+    assert(sent.size() == 1);
+    assert(sent[0].id == MSG_THROTTLE_POSITION && sent[0].value == 20.0f);
+}
+
+// Test replicated IDs are rate limited per ID and the latest value follows
+TEST(replicated_rate_limited) {
+    setup();
+    g_message_bus.subscribe(MSG_VEHICLE_SPEED, record_message);
+    can_router_add_route(MSG_VEHICLE_SPEED, 0xFFFFFFFF, CAN_ROUTE_REPLICATED, 10000);
+    can_router_add_route(MSG_THROTTLE_POSITION, 0xFFFFFFFF, CAN_ROUTE_REPLICATED, 10000);
+
+    g_message_bus.publishFloat(MSG_VEHICLE_SPEED, 10.0f);
+    g_message_bus.process();
+    assert(sent.size() == 1);
+
+    // Inside the interval: held, the newer value replaces the older one
+    mock_advance_time_us(2000);
+    g_message_bus.publishFloat(MSG_VEHICLE_SPEED, 11.0f);
+    g_message_bus.process();
+    mock_advance_time_us(2000);
+    g_message_bus.publishFloat(MSG_VEHICLE_SPEED, 12.0f);
+    g_message_bus.publishFloat(MSG_THROTTLE_POSITION, 30.0f);   // Own interval
+    g_message_bus.process();
+    assert(sent.size() == 2 && sent[1].id == MSG_THROTTLE_POSITION);
+    assert(delivered.size() == 3);                              // Local delivery is not limited
+    assert(can_router_get_pending() == 1);
+
+    can_router_update();
+    assert(sent.size() == 2);
+
+    mock_advance_time_us(6000);
+    can_router_update();
+    assert(sent.size() == 3);
+    assert(sent[2].id == MSG_VEHICLE_SPEED && sent[2].value == 12.0f);
+    assert(can_router_get_pending() == 0);
+
+    const can_router_stats_t* stats = can_router_get_stats();
+    assert(stats->forwarded == 3);
+    assert(stats->held == 1 && stats->superseded == 1);
+    assert(can_router_get_route(0)->frames == 2);
+}
+
+// Test frames from a remote module are published on the internal bus
+TEST(remote_frames_published) {
+    setup();
+    g_message_bus.subscribe(MSG_TRANS_CURRENT_GEAR, record_message);
+    can_router_add_route(TRANSMISSION_FAMILY, FAMILY_MASK, CAN_ROUTE_REMOTE, 0);
+
+    assert(receive_float(MSG_TRANS_CURRENT_GEAR, 3.0f));
+    assert(!receive_float(MSG_ENGINE_RPM, 2000.0f));             // Not ours
+    g_message_bus.process();
+    assert(delivered.size() == 1);
+    assert(delivered[0].id == MSG_TRANS_CURRENT_GEAR && delivered[0].value == 3.0f);
+    assert(can_router_get_stats()->received == 1);
+
+    // A remote ID published locally is never sent back
+    assert(sent.empty());
+}
+
+// Test parameter-sized frames are left to the parameter protocol
+TEST(parameter_frames_not_routed) {
+    setup();
+    can_router_add_route(TRANSMISSION_FAMILY, FAMILY_MASK, CAN_ROUTE_REMOTE, 0);
+    can_router_add_route(MSG_VEHICLE_SPEED, 0xFFFFFFFF, CAN_ROUTE_REPLICATED, 0);
+
+    parameter_msg_t param = {};
+    assert(!can_router_receive(MSG_TRANS_CURRENT_GEAR, (const uint8_t*)&param, sizeof(param)));
+    g_message_bus.publish(MSG_VEHICLE_SPEED, &param, sizeof(param));
+    g_message_bus.process();
+    assert(sent.empty());
+    assert(can_router_get_stats()->received == 0);
+}
+
+// Test a refused frame is held and retried from the update
+TEST(transmit_failure_retried) {
+    setup();
+    can_router_add_route(MSG_VEHICLE_SPEED, 0xFFFFFFFF, CAN_ROUTE_REPLICATED, 10000);
+
+    transmit_ok = false;
+    g_message_bus.publishFloat(MSG_VEHICLE_SPEED, 42.0f);
+    g_message_bus.process();
+    assert(sent.empty());
+    assert(can_router_get_pending() == 1);
+    assert(can_router_get_stats()->transmit_failures == 1);
+
+    can_router_update();
+    assert(can_router_get_stats()->transmit_failures == 2);
+
+    transmit_ok = true;
+    can_router_update();                // Never sent, so no interval to wait for
+    assert(sent.size() == 1 && sent[0].value == 42.0f);
+    assert(can_router_get_pending() == 0);
+}
+
+// Test IDs beyond the tracking table are still forwarded
+TEST(untracked_ids_forwarded) {
+    setup();
+    can_router_add_route(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, 0),
+                         FAMILY_MASK, CAN_ROUTE_REPLICATED, 10000);
+    uint32_t count = CAN_ROUTER_ID_SLOTS + 4;
+    for (uint32_t i = 0; i < count; i++) {
+        g_message_bus.publishFloat(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, 0x1000 + i), 1.0f);
+        g_message_bus.process();
+    }
+    assert(sent.size() == count);
+    assert(can_router_get_stats()->untracked == 4);
+}
+
+// Test the transmission module split across two ECUs: vehicle speed and
+// the module's own IDs flow from the transmission ECU, throttle and brake
+// from the engine ECU
+TEST(transmission_split_placement) {
+    // Transmission ECU: hosts the module
+    setup();
+    assert(can_router_place_module(&TRANSMISSION_MODULE_ROUTES, true, 10000));
+    assert(can_router_get_mode(MSG_VEHICLE_SPEED) == CAN_ROUTE_REPLICATED);
+    assert(can_router_get_mode(MSG_TRANS_CURRENT_GEAR) == CAN_ROUTE_REPLICATED);
+    assert(can_router_get_mode(MSG_THROTTLE_POSITION) == CAN_ROUTE_REMOTE);
+    assert(can_router_get_mode(MSG_BRAKE_PEDAL) == CAN_ROUTE_REMOTE);
+    assert(can_router_get_mode(MSG_ENGINE_RPM) == CAN_ROUTE_LOCAL);
+
+    g_message_bus.subscribe(MSG_THROTTLE_POSITION, record_message);
+    g_message_bus.publishFloat(MSG_VEHICLE_SPEED, 88.0f);
+    g_message_bus.publishFloat(MSG_TRANS_CURRENT_GEAR, 4.0f);
+    assert(receive_float(MSG_THROTTLE_POSITION, 35.0f));
+    assert(!receive_float(MSG_VEHICLE_SPEED, 1.0f));            // Produced here
+    g_message_bus.process();
+    assert(sent.size() == 2);
+    assert(sent[0].id == MSG_VEHICLE_SPEED && sent[0].value == 88.0f);
+    assert(sent[1].id == MSG_TRANS_CURRENT_GEAR);
+    assert(delivered.size() == 1 && delivered[0].value == 35.0f);
+
+    // Engine ECU: the module runs elsewhere
+    setup();
+    assert(can_router_place_module(&TRANSMISSION_MODULE_ROUTES, false, 10000));
+    assert(can_router_get_mode(MSG_VEHICLE_SPEED) == CAN_ROUTE_REMOTE);
+    assert(can_router_get_mode(MSG_TRANS_CURRENT_GEAR) == CAN_ROUTE_REMOTE);
+    assert(can_router_get_mode(MSG_THROTTLE_POSITION) == CAN_ROUTE_REPLICATED);
+    assert(can_router_get_mode(MSG_BRAKE_PEDAL) == CAN_ROUTE_REPLICATED);
+
+    g_message_bus.subscribe(MSG_VEHICLE_SPEED, record_message);
+    g_message_bus.publishFloat(MSG_THROTTLE_POSITION, 35.0f);
+    g_message_bus.publishFloat(MSG_BRAKE_PEDAL, 1.0f);
+    assert(receive_float(MSG_VEHICLE_SPEED, 88.0f));
+    assert(!receive_float(MSG_THROTTLE_POSITION, 1.0f));        // Produced here
+    g_message_bus.process();
+    assert(sent.size() == 2);
+    assert(sent[0].id == MSG_THROTTLE_POSITION && sent[1].id == MSG_BRAKE_PEDAL);
+    assert(delivered.size() == 1);
+    assert(delivered[0].id == MSG_VEHICLE_SPEED && delivered[0].value == 88.0f);
+}
+
+// Main test runner
+int main() {
+    std::cout << "=== CAN Router Tests ===" << std::endl;
+
+    run_test_route_modes();
+    run_test_replicated_rate_limited();
+    run_test_remote_frames_published();
+    run_test_parameter_frames_not_routed();
+    run_test_transmit_failure_retried();
+    run_test_untracked_ids_forwarded();
+    run_test_transmission_split_placement();
+
+    std::cout << std::endl;
+    std::cout << "CAN Router Tests - Run: " << tests_run << ", Passed: " << tests_passed << std::endl;
+
+    if (tests_passed == tests_run) {
+        std::cout << "✅ ALL CAN ROUTER TESTS PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME TESTS FAILED!" << std::endl;
+        return 1;
+    }
+}
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cstddef>
 #include <cassert>
 #include <cstring>
 #include "../mock_arduino.h"
@@ -315,6 +316,135 @@ bool test_spi_configuration() {
            qspi_config.frequency == 25000000 && qspi_config.enabled;
 }
 
+// Test boot reads the configuration as one versioned image
+bool test_config_image_single_read() {
+    print_test_header("Configuration Image");
+    
+    SPIFlashStorageBackend storage_backend;
+    StorageManager storage_manager(&storage_backend);
+    g_message_bus.init();
+    storage_manager.init();
+    
+    ConfigManager config_manager(&storage_manager);
+    config_manager.initialize();
+    bool first_boot_defaults = config_manager.getConfigSource() == CONFIG_SOURCE_DEFAULTS;
+    print_test_result("First boot uses defaults", first_boot_defaults);
+    config_manager.updateSerialNumber(0x12345678);
+    
+    uint32_t reads_before = storage_manager.get_disk_reads();
+    ConfigManager config_manager2(&storage_manager);
+    config_manager2.initialize();
+    uint32_t reads = storage_manager.get_disk_reads() - reads_before;
+    
+    bool from_image = config_manager2.getConfigSource() == CONFIG_SOURCE_IMAGE;
+    bool one_read = reads == 1;
+    bool serial_loaded = config_manager2.getSerialNumber() == 0x12345678;
+    print_test_result("Second boot loads the image", from_image);
+    print_test_result("Image loaded in one read", one_read);
+    print_test_result("Image holds the update", serial_loaded);
+    
+    return first_boot_defaults && from_image && one_read && serial_loaded;
+}
+
+// Test per-key (version 0) configurations are migrated to the image
+bool test_config_migration() {
+    print_test_header("Configuration Migration");
+    
+    SPIFlashStorageBackend storage_backend;
+    StorageManager storage_manager(&storage_backend);
+    g_message_bus.init();
+    storage_manager.init();
+    
+    // What an older firmware left behind
+    uint8_t legacy_type = ECU_TRANSMISSION;
+    char legacy_name[32] = "Legacy Transmission";
+    storage_manager.save_data("cfg_ecu_type", &legacy_type, sizeof(legacy_type));
+    storage_manager.save_data("cfg_ecu_name", legacy_name, sizeof(legacy_name));
+    
+    ConfigManager config_manager(&storage_manager);
+    config_manager.initialize();
+    bool migrated = config_manager.getConfigSource() == CONFIG_SOURCE_MIGRATED;
+    bool name_kept = strcmp(config_manager.getECUName(), "Legacy Transmission") == 0;
+    bool defaults_filled = config_manager.getSerialNumber() == 0x54524E53;
+    print_test_result("Legacy keys migrated", migrated);
+    print_test_result("Legacy name kept", name_kept);
+    print_test_result("Missing keys take defaults", defaults_filled);
+    
+    ConfigManager config_manager2(&storage_manager);
+    config_manager2.initialize();
+    bool image_written = config_manager2.getConfigSource() == CONFIG_SOURCE_IMAGE;
+    print_test_result("Migration wrote the image", image_written);
+    
+    return migrated && name_kept && defaults_filled && image_written;
+}
+
+// Test an image of another layout version is not used
+bool test_config_image_version_mismatch() {
+    print_test_header("Configuration Image Version");
+    
+    SPIFlashStorageBackend storage_backend;
+    StorageManager storage_manager(&storage_backend);
+    g_message_bus.init();
+    storage_manager.init();
+    
+    ECUConfiguration other = ECU_TRANSMISSION_CONFIG;
+    strcpy(other.ecu_name, "Future Layout");
+    StorageSegment image = {&other, sizeof(other)};
+    storage_manager.save_blob(storage_manager.convert_string_to_extended_can_id("cfg_image"),
+                              99, &image, 1);
+    
+    ConfigManager config_manager(&storage_manager);
+    bool init_ok = config_manager.initialize();
+    bool defaults = config_manager.getConfigSource() == CONFIG_SOURCE_DEFAULTS;
+    bool name_default = strcmp(config_manager.getECUName(), "Backslider Transmission") == 0;
+    print_test_result("Init succeeds", init_ok);
+    print_test_result("Other version falls back to defaults", defaults);
+    print_test_result("Default name loaded", name_default);
+    
+    return init_ok && defaults && name_default;
+}
+
+// Test that a version 1 image (no distribution block) is migrated and the
+// placement defaults to every module on this ECU
+bool test_config_image_v1_migration() {
+    print_test_header("Configuration Image v1 Migration");
+    
+    SPIFlashStorageBackend storage_backend;
+    StorageManager storage_manager(&storage_backend);
+    g_message_bus.init();
+    storage_manager.init();
+    
+    ECUConfiguration old = ECU_TRANSMISSION_CONFIG;
+    strcpy(old.ecu_name, "V1 Image");
+    StorageSegment image = {&old, offsetof(ECUConfiguration, distribution)};
+    storage_manager.save_blob(storage_manager.convert_string_to_extended_can_id("cfg_image"),
+                              1, &image, 1);
+    
+    ConfigManager config_manager(&storage_manager);
+    bool init_ok = config_manager.initialize();
+    bool migrated = config_manager.getConfigSource() == CONFIG_SOURCE_MIGRATED;
+    bool name_kept = strcmp(config_manager.getECUName(), "V1 Image") == 0;
+    bool placement_local = config_manager.getNodeBase() == ECU_BASE_PRIMARY &&
+                           config_manager.isTransmissionLocal();
+    print_test_result("Init succeeds", init_ok);
+    print_test_result("Source is migrated", migrated);
+    print_test_result("v1 fields kept", name_kept);
+    print_test_result("Placement defaults to local", placement_local);
+    
+    // Placement updates are validated and saved in the current image
+    bool bad_rejected = !config_manager.updateModulePlacement(ECU_BASE_PRIMARY, 0x12345);
+    bool moved = config_manager.updateModulePlacement(ECU_BASE_PRIMARY, ECU_BASE_SECONDARY);
+    ConfigManager reloaded(&storage_manager);
+    reloaded.initialize();
+    bool saved = reloaded.getConfigSource() == CONFIG_SOURCE_IMAGE &&
+                 reloaded.getTransmissionNode() == ECU_BASE_SECONDARY &&
+                 !reloaded.isTransmissionLocal();
+    print_test_result("Invalid node rejected", bad_rejected);
+    print_test_result("Placement saved in current image", moved && saved);
+    
+    return init_ok && migrated && name_kept && placement_local && bad_rejected && moved && saved;
+}
+
 // Main test runner
 int main() {
     std::cout << "Starting Configuration Manager Tests..." << std::endl;
@@ -331,6 +461,10 @@ int main() {
     total_tests++; if (test_factory_reset()) tests_passed++;
     total_tests++; if (test_transmission_settings()) tests_passed++;
     total_tests++; if (test_spi_configuration()) tests_passed++;
+    total_tests++; if (test_config_image_single_read()) tests_passed++;
+    total_tests++; if (test_config_migration()) tests_passed++;
+    total_tests++; if (test_config_image_version_mismatch()) tests_passed++;
+    total_tests++; if (test_config_image_v1_migration()) tests_passed++;
     
     // Print summary
     std::cout << "\n=== Test Summary ===" << std::endl;
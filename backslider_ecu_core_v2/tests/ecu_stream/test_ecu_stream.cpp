@@ -0,0 +1,364 @@
+// tests/ecu_stream/test_ecu_stream.cpp
+// Test suite for the host-side stream decoder and replay library
+
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <cmath>
+#include <vector>
+
+// Include enhanced mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../external_serial.h"
+#include "../../sd_logger.h"
+#include "../../host/ecu_stream.h"
+#include "../../host/ecu_replay.h"
+
+// Simple test framework
+int tests_run = 0;
+int tests_passed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        std::cout << "  Running test: " #name "... "; \
+        tests_run++; \
+        test_##name(); \
+        tests_passed++; \
+        std::cout << "PASSED" << std::endl; \
+    } \
+    void test_##name()
+
+// A legacy frame as a Teensy writes it (CAN_message_t layout, 16-bit stamp)
+static void push_teensy_frame(std::vector<uint8_t>& out, uint32_t id, uint32_t stamp_us,
+                              const void* data, uint8_t len) {
+    uint8_t wire[ECU_STREAM_LEGACY_FRAME] = {};
+    memcpy(&wire[ECU_STREAM_LEGACY_OFFSET_ID], &id, 4);
+    uint16_t stamp = (uint16_t)stamp_us;
+    memcpy(&wire[ECU_STREAM_LEGACY_OFFSET_TIMESTAMP], &stamp, 2);
+    wire[ECU_STREAM_LEGACY_OFFSET_EXTENDED] = 1;
+    wire[ECU_STREAM_LEGACY_OFFSET_LEN] = len;
+    memcpy(&wire[ECU_STREAM_LEGACY_OFFSET_BUF], data, len);
+    out.push_back(0xFF);
+    out.push_back(0xFF);
+    out.insert(out.end(), wire, wire + sizeof(wire));
+}
+
+// Host -> ECU v2 frame, as in test_external_serial
+static std::vector<uint8_t> build_link_frame(uint8_t seq, const std::vector<CANMessage>& messages) {
+    std::vector<uint8_t> raw;
+    raw.push_back(seq);
+    for (const CANMessage& msg : messages) {
+        for (int i = 0; i < 4; i++) raw.push_back((uint8_t)(msg.id >> (8 * i)));
+        raw.push_back(msg.len | SERIAL_LINK_CTL_EXTENDED);
+        for (int i = 0; i < 4; i++) raw.push_back((uint8_t)(msg.timestamp_us >> (8 * i)));
+        raw.insert(raw.end(), msg.buf, msg.buf + msg.len);
+    }
+    uint16_t crc = serial_link_crc16(raw.data(), raw.size());
+    raw.push_back((uint8_t)crc);
+    raw.push_back((uint8_t)(crc >> 8));
+    std::vector<uint8_t> encoded(raw.size() + raw.size() / 254 + 2);
+    encoded.resize(serial_link_cobs_encode(raw.data(), raw.size(), encoded.data()));
+    encoded.push_back(0x00);
+    return encoded;
+}
+
+static CANMessage make_message(uint32_t id, const void* data, uint8_t len) {
+    CANMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.id = id;
+    msg.len = len;
+    memcpy(msg.buf, data, len);
+    msg.flags.extended = 1;
+    msg.timestamp_us = micros();
+    msg.timestamp = (uint16_t)msg.timestamp_us;
+    return msg;
+}
+
+static CANMessage make_telemetry_config(uint8_t op, uint8_t index, uint32_t msg_id, int8_t step_exp) {
+    serial_telemetry_config_msg_t request = {};
+    request.op = op;
+    request.index = index;
+    request.msg_id = msg_id;
+    request.step_exp = step_exp;
+    return make_message(MSG_SERIAL_TELEMETRY_CONFIG, &request, sizeof(request));
+}
+
+// Bridge on Serial, negotiated to v2 with a 256-byte MTU; the decoder has
+// seen the Teensy-format ACK
+static void negotiate(SerialBridge& bridge, EcuStreamDecoder& decoder) {
+    Serial.reset();
+    g_message_bus.init();
+    assert(bridge.init(&Serial, DEFAULT_EXTERNAL_SERIAL_CONFIG.usb));
+    serial_link_msg_t hello = {};
+    hello.version = SERIAL_LINK_VERSION_FRAMED;
+    hello.mtu = 256;
+    CANMessage msg = make_message(MSG_SERIAL_LINK_HELLO, &hello, sizeof(hello));
+    Serial.add_byte_to_read(0xFF);
+    Serial.add_byte_to_read(0xFF);
+    Serial.add_data_to_read((const uint8_t*)&msg, sizeof(CANFrame));
+    bridge.update();
+    assert(bridge.get_link_version() == SERIAL_LINK_VERSION_FRAMED);
+    Serial.clear_written_data();
+
+    std::vector<uint8_t> ack;
+    push_teensy_frame(ack, MSG_SERIAL_LINK_ACK, micros(), &hello, sizeof(hello));
+    decoder.feed(ack.data(), ack.size());
+    assert(decoder.get_link_version() == SERIAL_LINK_VERSION_FRAMED);
+}
+
+static std::vector<uint8_t> take_written(SerialBridge& bridge) {
+    std::vector<uint8_t> written = bridge.get_written_data_for_testing();
+    Serial.clear_written_data();
+    return written;
+}
+
+static void count_message(const CANMessage* msg, void* context) {
+    (void)msg;
+    (*(uint32_t*)context)++;
+}
+
+// Test legacy frames split at every boundary, with text between them and
+// 16-bit stamps wrapping
+TEST(legacy_frames_any_chunking) {
+    std::vector<uint8_t> stream;
+    const char* banner = "ECU boot\r\n";
+    stream.insert(stream.end(), banner, banner + strlen(banner));
+    for (uint32_t i = 0; i < 50; i++) {
+        float rpm = 800.0f + i * 25.0f;
+        push_teensy_frame(stream, MSG_ENGINE_RPM, 60000 + i * 10000, &rpm, sizeof(rpm));
+        if (i % 10 == 0) {
+            uint8_t response[8] = {PARAM_OP_READ_RESPONSE, 0, 0, 0, 0, 0, 0, 0};
+            push_teensy_frame(stream, MSG_COOLANT_TEMP, 60000 + i * 10000, response, sizeof(response));
+        }
+    }
+
+    EcuStreamDecoder decoder;
+    uint32_t handled = 0;
+    decoder.set_message_handler(count_message, &handled);
+    size_t pos = 0;
+    for (size_t chunk = 1; pos < stream.size(); chunk = chunk % 7 + 1) {
+        size_t length = std::min(chunk, stream.size() - pos);
+        decoder.feed(&stream[pos], length);
+        pos += length;
+    }
+
+    const ecu_stream_stats_t& stats = decoder.get_stats();
+    assert(stats.messages == 55);
+    assert(handled == 55);
+    assert(stats.bytes == stream.size());
+    assert(decoder.get_channel_count() == 1);       // 8-byte responses are not float channels
+    const EcuChannel* rpm = decoder.channel(MSG_ENGINE_RPM);
+    assert(rpm && rpm->values.size() == 50);
+    for (uint32_t i = 0; i < 50; i++) {
+        assert(rpm->values[i] == 800.0f + i * 25.0f);
+        assert(rpm->timestamps_us[i] == 60000 + i * 10000);     // Unwrapped past 65535
+    }
+
+    decoder.consume();
+    assert(decoder.channel(MSG_ENGINE_RPM)->values.empty());
+    assert(decoder.channel(MSG_ENGINE_RPM)->last_value == 800.0f + 49 * 25.0f);
+}
+
+// Test v2 records from the real bridge carry the full 32-bit publish stamp
+TEST(link_records_from_bridge) {
+    mock_reset_all();
+    mock_set_micros(4000000000u);
+    SerialBridge bridge;
+    EcuStreamDecoder decoder;
+    negotiate(bridge, decoder);
+
+    for (uint32_t i = 0; i < 40; i++) {
+        float map = 30.0f + i;
+        bridge.send_message(make_message(MSG_MANIFOLD_PRESSURE, &map, sizeof(map)));
+        mock_advance_time_us(1000);
+    }
+    bridge.flush_link_frame();
+    std::vector<uint8_t> written = take_written(bridge);
+    for (size_t pos = 0; pos < written.size(); pos += 5) {
+        decoder.feed(&written[pos], std::min<size_t>(5, written.size() - pos));
+    }
+
+    const ecu_stream_stats_t& stats = decoder.get_stats();
+    assert(stats.frames == bridge.get_frames_sent());
+    assert(stats.crc_errors == 0 && stats.frames_lost == 0);
+    const EcuChannel* map = decoder.channel(MSG_MANIFOLD_PRESSURE);
+    assert(map && map->values.size() == 40);
+    for (uint32_t i = 0; i < 40; i++) {
+        assert(map->values[i] == 30.0f + i);
+        assert(map->timestamps_us[i] == 4000000000u + i * 1000);
+    }
+
+    // A corrupt frame is dropped whole and counted
+    float map_value = 99.0f;
+    bridge.send_message(make_message(MSG_MANIFOLD_PRESSURE, &map_value, sizeof(map_value)));
+    bridge.flush_link_frame();
+    written = take_written(bridge);
+    written[3] ^= 0x01;
+    decoder.feed(written.data(), written.size());
+    assert(decoder.get_stats().crc_errors == 1);
+    assert(decoder.channel(MSG_MANIFOLD_PRESSURE)->values.size() == 40);
+}
+
+// Test telemetry blocks decode to the quantised values, and a lost frame
+// holds deltas back until the next keyframe
+TEST(telemetry_blocks_and_gaps) {
+    mock_reset_all();
+    mock_set_micros(1000);
+    SerialBridge bridge;
+    EcuStreamDecoder decoder;
+    negotiate(bridge, decoder);
+
+    std::vector<uint8_t> setup = build_link_frame(0, {
+        make_telemetry_config(TELEMETRY_OP_ADD, 0, MSG_ENGINE_RPM, 0),
+        make_telemetry_config(TELEMETRY_OP_ADD, 1, MSG_COOLANT_TEMP, -1),
+        make_telemetry_config(TELEMETRY_OP_START, 4, 100, 0),
+    });
+    Serial.add_data_to_read(setup.data(), setup.size());
+    bridge.update();
+    assert(bridge.is_telemetry_active());
+    assert(decoder.telemetry_add(0, MSG_ENGINE_RPM, 0));
+    assert(decoder.telemetry_add(1, MSG_COOLANT_TEMP, -1));
+    assert(!decoder.telemetry_add(SERIAL_TELEMETRY_MAX_CHANNELS, MSG_ENGINE_RPM, 0));
+    std::vector<uint8_t> acks = take_written(bridge);
+    decoder.feed(acks.data(), acks.size());
+
+    // Ticks 1 and 5 are keyframes; tick 2's frame never arrives
+    std::vector<uint32_t> tick_us;
+    for (uint32_t tick = 1; tick <= 6; tick++) {
+        float rpm = 3000.0f + tick * 10.4f;
+        float coolant = 85.0f + tick * 0.1f;
+        bridge.send_message(make_message(MSG_ENGINE_RPM, &rpm, sizeof(rpm)));
+        bridge.send_message(make_message(MSG_COOLANT_TEMP, &coolant, sizeof(coolant)));
+        mock_advance_time_us(10000);
+        bridge.update();
+        tick_us.push_back(micros());
+        std::vector<uint8_t> frame = take_written(bridge);
+        if (tick != 2) {
+            decoder.feed(frame.data(), frame.size());
+        }
+    }
+    assert(bridge.get_telemetry_ticks() == 6);
+
+    const ecu_stream_stats_t& stats = decoder.get_stats();
+    assert(stats.frames_lost == 1);
+    assert(stats.telemetry_blocks == 5);
+    assert(stats.telemetry_skipped == 2);       // Ticks 3 and 4
+    const EcuChannel* rpm = decoder.channel(MSG_ENGINE_RPM);
+    const EcuChannel* coolant = decoder.channel(MSG_COOLANT_TEMP);
+    assert(rpm && coolant);
+    uint32_t expected_ticks[] = {1, 5, 6};
+    assert(rpm->values.size() == 3);
+    for (size_t i = 0; i < 3; i++) {
+        uint32_t tick = expected_ticks[i];
+        assert(rpm->values[i] == roundf(3000.0f + tick * 10.4f));
+        assert(fabsf(coolant->values[i] - (85.0f + tick * 0.1f)) < 0.051f);
+        assert(rpm->timestamps_us[i] == tick_us[tick - 1]);
+    }
+}
+
+// SD logger sink that keeps the file in memory
+static std::vector<uint8_t> sd_file;
+static bool sd_write(const uint8_t* data, size_t length) {
+    sd_file.insert(sd_file.end(), data, data + length);
+    return true;
+}
+static const sd_logger_sink_t sd_sink = {sd_write, nullptr, nullptr};
+
+// Test an SD log replays at 2x by its publish stamps
+TEST(replay_sd_log_at_speed) {
+    mock_reset_all();
+    mock_set_micros(5000);
+    g_message_bus.init();
+    sd_logger_init();
+    sd_file.clear();
+    assert(sd_logger_start(&sd_sink));
+    for (uint32_t i = 0; i < 100; i++) {
+        float tps = (float)i;
+        CANMessage msg = make_message(MSG_THROTTLE_POSITION, &tps, sizeof(tps));
+        sd_logger_log_message(&msg);
+        mock_advance_time_us(10000);
+    }
+    sd_logger_stop();
+    for (int i = 0; i < 100 && !sd_logger_is_idle(); i++) {
+        sd_logger_update();
+    }
+
+    EcuReplay replay;
+    assert(replay.load_bytes(sd_file.data(), sd_file.size()));
+    assert(replay.is_sd_log());
+    assert(replay.get_event_count() == 100);
+    assert(replay.get_duration_us() == 990000);
+
+    EcuStreamDecoder decoder;
+    replay.start(&decoder, 2.0);
+    assert(replay.advance(0) == 1);
+    assert(replay.advance(250000) == 50);       // 500 ms of session in 250 ms
+    assert(replay.get_position_us() == 500000);
+    assert(replay.advance(250000) == 0);
+    assert(replay.advance(600000) == 49);
+    assert(replay.finished());
+
+    const EcuChannel* tps = decoder.channel(MSG_THROTTLE_POSITION);
+    assert(tps && tps->values.size() == 100);
+    assert(tps->values[99] == 99.0f);
+    assert(tps->timestamps_us[99] - tps->timestamps_us[0] == 990000);
+}
+
+// Test a raw capture replays frame by frame through the decoder
+TEST(replay_capture_file) {
+    std::vector<uint8_t> capture;
+    for (uint32_t i = 0; i < 30; i++) {
+        float speed = i * 2.0f;
+        push_teensy_frame(capture, MSG_VEHICLE_SPEED, 1000 + i * 20000, &speed, sizeof(speed));
+    }
+    const char* path = "ecu_stream/test_capture.bin";
+    FILE* file = fopen(path, "wb");
+    assert(file);
+    fwrite(capture.data(), 1, capture.size(), file);
+    fclose(file);
+
+    EcuReplay replay;
+    assert(!replay.load("ecu_stream/does_not_exist.bin"));
+    assert(replay.load(path));
+    remove(path);
+    assert(!replay.is_sd_log());
+    assert(replay.get_event_count() == 30);
+    assert(replay.get_duration_us() == 29 * 20000);
+
+    EcuStreamDecoder decoder;
+    replay.start(&decoder, 10.0);
+    assert(replay.advance(10000) == 6);         // 100 ms of session
+    assert(decoder.channel(MSG_VEHICLE_SPEED)->values.size() == 6);
+    assert(decoder.get_stats().bytes == 6 * (2 + ECU_STREAM_LEGACY_FRAME));
+
+    replay.start(&decoder, 0);                  // As fast as possible, from the top
+    decoder.consume();
+    assert(replay.advance(0) == 30);
+    assert(replay.finished());
+    assert(decoder.channel(MSG_VEHICLE_SPEED)->values.size() == 30);
+}
+
+int main() {
+    std::cout << "=== ECU Stream Tests ===" << std::endl;
+
+    run_test_legacy_frames_any_chunking();
+    run_test_link_records_from_bridge();
+    run_test_telemetry_blocks_and_gaps();
+    run_test_replay_sd_log_at_speed();
+    run_test_replay_capture_file();
+
+    std::cout << std::endl;
+    std::cout << "ECU Stream Tests - Run: " << tests_run << ", Passed: " << tests_passed << std::endl;
+
+    if (tests_passed == tests_run) {
+        std::cout << "✅ ALL ECU STREAM TESTS PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME ECU STREAM TESTS FAILED!" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,106 @@
+// tests/external_canbus/bench_external_canbus.cpp
+// Desktop microbenchmarks for external CAN receive paths
+//
+//   - ExternalCanBus routing a received frame to its custom handler
+//   - ExternalCanBus routing a parameter frame onto the message bus
+//   - CustomCanBusManager extracting, scaling and publishing a mapped signal
+//
+// Usage: make bench, or ./external_canbus/bench_external_canbus --output FILE
+// (see tests/bench.h for --baseline, --tolerance and --rounds)
+
+// Include mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../storage_manager.h"
+#include "../../spi_flash_storage_backend.h"
+#include "../../external_canbus.h"
+#include "../../custom_canbus_manager.h"
+#include "../bench.h"
+
+// Global instances the modules declare extern
+static SPIFlashStorageBackend global_storage_backend;
+StorageManager g_storage_manager(&global_storage_backend);
+
+static const int FRAMES_PER_ROUND = 100;        // Bus publishes fit one lane
+static const uint32_t HANDLER_COUNT = 16;
+static const uint32_t MAPPING_COUNT = 32;
+
+static uint32_t handled = 0;
+
+static void count_frame(uint32_t can_id, const uint8_t* data, uint8_t length) {
+    handled += length;
+}
+
+static void bench_routing(void) {
+    external_canbus_config_t config = DEFAULT_EXTERNAL_CANBUS_CONFIG;
+    config.enabled = true;
+    config.enable_obdii = false;
+    if (!g_external_canbus.init(config)) {
+        std::cerr << "  external CAN bus init failed" << std::endl;
+    }
+    for (uint32_t i = 0; i < HANDLER_COUNT; i++) {
+        g_external_canbus.register_custom_handler(0x300 + i, count_frame);
+    }
+
+    bench_run("route_custom_frame", FRAMES_PER_ROUND, [] {}, [] {
+        uint8_t data[6] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66};    // Not parameter-sized
+        for (int i = 0; i < FRAMES_PER_ROUND; i++) {
+            g_external_canbus.inject_test_message(0x300 + i % HANDLER_COUNT, data, sizeof(data));
+        }
+    });
+    if (handled == 0) {
+        std::cerr << "  route_custom_frame reached no handler" << std::endl;
+    }
+
+    bench_run("route_parameter_frame", FRAMES_PER_ROUND,
+        [] { g_message_bus.process(); },
+        [] {
+            parameter_msg_t param = {};
+            param.operation = PARAM_OP_STATUS_BROADCAST;
+            param.value = 1.0f;
+            for (int i = 0; i < FRAMES_PER_ROUND; i++) {
+                g_external_canbus.inject_test_message(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_FUEL, i),
+                                                      (const uint8_t*)&param, sizeof(param));
+            }
+        });
+    bench_sink = bench_sink + handled;
+}
+
+static void bench_extraction(void) {
+    g_custom_canbus_manager.init();
+    for (uint32_t i = 0; i < MAPPING_COUNT; i++) {
+        can_mapping_t mapping = create_can_mapping(0x500 + i, MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, 0x80 + i),
+                                                   (uint8_t)(i % 4) * 2, 2, (i & 1) != 0, 0.1f, -1000.0f, 10000.0f);
+        if (!g_custom_canbus_manager.add_mapping(mapping)) {
+            std::cerr << "  mapping " << i << " rejected" << std::endl;
+        }
+    }
+
+    static uint32_t next = 0;
+    bench_run("extract_mapped_signal", FRAMES_PER_ROUND,
+        [] { g_message_bus.process(); },
+        [] {
+            uint8_t data[8] = {0xEE, 0x02, 0x10, 0x27, 0x34, 0x12, 0x00, 0x01};
+            for (int i = 0; i < FRAMES_PER_ROUND; i++) {
+                data[7] = (uint8_t)next;
+                g_custom_canbus_manager.simulate_can_message(0x500 + next++ % MAPPING_COUNT, data, sizeof(data));
+            }
+        });
+    bench_sink = bench_sink + g_custom_canbus_manager.get_statistics().messages_processed;
+}
+
+static void run_benchmarks(void) {
+    mock_reset_all();
+    global_storage_backend.begin();
+    g_storage_manager.init();
+    g_message_bus.init();
+
+    bench_routing();
+    bench_extraction();
+}
+
+int main(int argc, char** argv) {
+    return bench_main(argc, argv, "external_canbus", run_benchmarks);
+}
@@ -27,8 +27,7 @@ extern uint8_t mock_pin_modes[56];
 
 // Global instances for testing
 static SPIFlashStorageBackend global_storage_backend;
-static StorageManager global_storage_manager(&global_storage_backend);
-StorageManager& g_storage_manager = global_storage_manager;
+StorageManager g_storage_manager(&global_storage_backend);    // The modules declare it extern StorageManager
 
 // Simple test framework
 int tests_run = 0;
@@ -57,6 +56,19 @@ static void capture_message(const CANMessage* msg) {
     published_value = MSG_UNPACK_FLOAT(msg);
 }
 
+// Every message published, for frames that carry several signals
+static int captured_count = 0;
+static uint32_t captured_ids[8];
+static float captured_values[8];
+
+static void capture_all(const CANMessage* msg) {
+    if (captured_count < 8) {
+        captured_ids[captured_count] = msg->id;
+        captured_values[captured_count] = MSG_UNPACK_FLOAT(msg);
+    }
+    captured_count++;
+}
+
 // Test setup function
 void test_setup() {
     // Reset mock Arduino state
@@ -76,6 +88,7 @@ void test_setup() {
     message_published = false;
     published_msg_id = 0;
     published_value = 0.0f;
+    captured_count = 0;
     
     // Initialize storage backend
     global_storage_backend.begin();
@@ -173,19 +186,29 @@ TEST(custom_canbus_manager_mapping_management) {
     assert(manager.add_mapping(mapping2) == true);
     assert(manager.get_mapping_count() == 2);
     
-    // Test duplicate CAN ID rejection
+    // Test duplicate (CAN ID, internal message) rejection
     can_mapping_t duplicate_mapping = create_can_mapping(
         0x360,                      // Same CAN ID as mapping1
-        MSG_MANIFOLD_PRESSURE,      // Different internal message
-        0, 2, false, 0.1f, 0.0f, 100.0f
+        MSG_THROTTLE_POSITION,      // Same internal message
+        2, 2, false, 0.1f, 0.0f, 100.0f
     );
     
     assert(manager.add_mapping(duplicate_mapping) == false);
     assert(manager.get_mapping_count() == 2);
     
+    // A second signal from the same frame is accepted
+    can_mapping_t second_signal = create_can_mapping(
+        0x360,                      // Same CAN ID as mapping1
+        MSG_MANIFOLD_PRESSURE,      // Different internal message
+        2, 2, false, 0.1f, 0.0f, 100.0f
+    );
+    
+    assert(manager.add_mapping(second_signal) == true);
+    assert(manager.get_mapping_count() == 3);
+    
     // Test removing mapping
     assert(manager.remove_mapping(0) == true);
-    assert(manager.get_mapping_count() == 1);
+    assert(manager.get_mapping_count() == 2);
     
     // Test clear all mappings
     manager.clear_all_mappings();
@@ -631,6 +654,314 @@ TEST(custom_canbus_manager_multiple_mappings_integration) {
     manager.shutdown();
 }
 
+TEST(custom_canbus_manager_multiple_signals_per_frame) {
+    test_setup();
+    
+    CustomCanBusManager manager;
+    assert(manager.init() == true);
+    
+    // Three signals packed into one frame, plus one on another ID
+    assert(manager.add_mapping(create_can_mapping(
+        0x5F0, MSG_ENGINE_RPM, 0, 2, true, 1.0f, 0.0f, 10000.0f)) == true);
+    assert(manager.add_mapping(create_can_mapping(
+        0x5F2, MSG_THROTTLE_POSITION, 0, 2, false, 0.1f, 0.0f, 100.0f)) == true);
+    assert(manager.add_mapping(create_can_mapping(
+        0x5F0, MSG_COOLANT_TEMP, 2, 1, false, 1.0f, -40.0f, 150.0f)) == true);
+    assert(manager.add_mapping(create_can_mapping(
+        0x5F0, MSG_MANIFOLD_PRESSURE, 4, 2, false, 0.1f, 0.0f, 50.0f)) == true);
+    
+    g_message_bus.subscribe(MSG_ENGINE_RPM, capture_all);
+    g_message_bus.subscribe(MSG_COOLANT_TEMP, capture_all);
+    g_message_bus.subscribe(MSG_MANIFOLD_PRESSURE, capture_all);
+    g_message_bus.subscribe(MSG_THROTTLE_POSITION, capture_all);
+    
+    // RPM 3000 (BE), coolant 90, MAP 101.3 is out of range (max 50)
+    uint8_t frame[8] = {0x0B, 0xB8, 0x5A, 0x00, 0xF5, 0x03, 0x00, 0x00};
+    manager.simulate_can_message(0x5F0, frame, 8);
+    g_message_bus.process();
+    
+    // Signals publish in configuration order
+    assert(captured_count == 2);
+    assert(captured_ids[0] == MSG_ENGINE_RPM && captured_values[0] == 3000.0f);
+    assert(captured_ids[1] == MSG_COOLANT_TEMP && captured_values[1] == 90.0f);
+    
+    const custom_canbus_stats_t& stats = manager.get_statistics();
+    assert(stats.messages_processed == 1);
+    assert(stats.messages_translated == 2);
+    assert(stats.validation_errors == 1);
+    
+    // A short frame still yields the signals it does carry
+    captured_count = 0;
+    manager.simulate_can_message(0x5F0, frame, 3);
+    g_message_bus.process();
+    assert(captured_count == 2);
+    assert(stats.extraction_errors == 1);
+    
+    // Disabling one signal leaves the others on the frame
+    assert(manager.enable_mapping(0, false) == true);
+    captured_count = 0;
+    manager.simulate_can_message(0x5F0, frame, 8);
+    g_message_bus.process();
+    assert(captured_count == 1);
+    assert(captured_ids[0] == MSG_COOLANT_TEMP);
+    
+    // Removing the rest of the frame's signals makes the ID unknown
+    assert(manager.remove_mapping(3) == true);
+    assert(manager.remove_mapping(2) == true);
+    assert(manager.remove_mapping(0) == true);
+    uint32_t unknown_before = stats.unknown_messages;
+    manager.simulate_can_message(0x5F0, frame, 8);
+    assert(stats.unknown_messages == unknown_before + 1);
+    
+    // The other ID was untouched
+    captured_count = 0;
+    uint8_t throttle[8] = {0x20, 0x03, 0, 0, 0, 0, 0, 0};
+    manager.simulate_can_message(0x5F2, throttle, 8);
+    g_message_bus.process();
+    assert(captured_count == 1);
+    assert(captured_values[0] == 80.0f);
+    
+    manager.shutdown();
+}
+
+TEST(custom_canbus_manager_signed_and_offset_binary) {
+    test_setup();
+    
+    CustomCanBusManager manager;
+    assert(manager.init() == true);
+    
+    can_mapping_t signed_8 = create_can_mapping(0x610, MSG_COOLANT_TEMP, 0, 1, false, 1.0f, -128.0f, 127.0f);
+    signed_8.extraction.flags |= CAN_EXTRACT_FLAG_SIGNED;
+    can_mapping_t signed_16 = create_can_mapping(0x610, MSG_ENGINE_RPM, 1, 2, true, 0.5f, -20000.0f, 20000.0f);
+    signed_16.extraction.flags |= CAN_EXTRACT_FLAG_SIGNED;
+    can_mapping_t offset_16 = create_can_mapping(0x610, MSG_MANIFOLD_PRESSURE, 3, 2, false, 0.1f, -3300.0f, 3300.0f);
+    offset_16.extraction.flags |= CAN_EXTRACT_FLAG_OFFSET_BINARY;
+    assert(manager.add_mapping(signed_8) == true);
+    assert(manager.add_mapping(signed_16) == true);
+    assert(manager.add_mapping(offset_16) == true);
+    
+    g_message_bus.subscribe(MSG_COOLANT_TEMP, capture_all);
+    g_message_bus.subscribe(MSG_ENGINE_RPM, capture_all);
+    g_message_bus.subscribe(MSG_MANIFOLD_PRESSURE, capture_all);
+    
+    // -40, 0xFF38 = -200 (* 0.5 = -100), 0x7FF6 - 0x8000 = -10 (* 0.1 = -1)
+    uint8_t frame[8] = {0xD8, 0xFF, 0x38, 0xF6, 0x7F, 0x00, 0x00, 0x00};
+    manager.simulate_can_message(0x610, frame, 8);
+    g_message_bus.process();
+    
+    assert(captured_count == 3);
+    assert(captured_values[0] == -40.0f);
+    assert(captured_values[1] == -100.0f);
+    assert(captured_values[2] > -1.001f && captured_values[2] < -0.999f);
+    
+    manager.shutdown();
+}
+
+TEST(custom_canbus_manager_mapping_capacity) {
+    test_setup();
+    
+    CustomCanBusManager manager;
+    assert(manager.init() == true);
+    assert(CustomCanBusManager::MAX_MAPPINGS > 16);
+    
+    // Fill the table, two signals per frame
+    for (uint8_t i = 0; i < CustomCanBusManager::MAX_MAPPINGS; i++) {
+        uint32_t can_id = 0x100 + (i / 2);
+        uint32_t msg_id = MSG_ENGINE_RPM + i;
+        assert(manager.add_mapping(create_can_mapping(can_id, msg_id, (i % 2) * 2, 2, false,
+                                                      1.0f, 0.0f, 65535.0f)) == true);
+    }
+    assert(manager.get_mapping_count() == CustomCanBusManager::MAX_MAPPINGS);
+    assert(manager.add_mapping(create_can_mapping(0x7FF, MSG_ENGINE_RPM, 0, 2, false,
+                                                  1.0f, 0.0f, 65535.0f)) == false);
+    
+    // Every frame still finds both of its signals
+    uint8_t frame[8] = {0x01, 0x00, 0x02, 0x00, 0, 0, 0, 0};
+    for (uint8_t i = 0; i < CustomCanBusManager::MAX_MAPPINGS / 2; i++) {
+        manager.simulate_can_message(0x100 + i, frame, 8);
+    }
+    const custom_canbus_stats_t& stats = manager.get_statistics();
+    assert(stats.messages_translated == CustomCanBusManager::MAX_MAPPINGS);
+    assert(stats.unknown_messages == 0);
+    
+    manager.shutdown();
+}
+
+TEST(custom_canbus_manager_bit_level_signals) {
+    test_setup();
+    
+    CustomCanBusManager manager;
+    assert(manager.init() == true);
+    
+    // Intel 12 bits from bit 4, Motorola 16 bits from bit 23 (bytes 2-3),
+    // Motorola signed 10 bits from bit 37 (across bytes 4-5), one flag bit
+    assert(manager.add_mapping(create_can_signal(
+        0x4B0, MSG_VEHICLE_SPEED, 4, 12, false, false, 0.5f, -10.0f, -100.0f, 3000.0f)) == true);
+    assert(manager.add_mapping(create_can_signal(
+        0x4B0, MSG_ENGINE_RPM, 23, 16, true, false, 1.0f, 0.0f, 0.0f, 10000.0f)) == true);
+    assert(manager.add_mapping(create_can_signal(
+        0x4B0, MSG_COOLANT_TEMP, 37, 10, true, true, 1.0f, 0.0f, -512.0f, 511.0f)) == true);
+    assert(manager.add_mapping(create_can_signal(
+        0x4B0, MSG_BRAKE_PEDAL, 48, 1, false, false, 1.0f, 0.0f, 0.0f, 1.0f)) == true);
+    
+    g_message_bus.subscribe(MSG_VEHICLE_SPEED, capture_all);
+    g_message_bus.subscribe(MSG_ENGINE_RPM, capture_all);
+    g_message_bus.subscribe(MSG_COOLANT_TEMP, capture_all);
+    g_message_bus.subscribe(MSG_BRAKE_PEDAL, capture_all);
+    
+    // 0x123 = 291 (* 0.5 - 10 = 135.5), 0x01F4 = 500, 0x3FD = -3, 1
+    uint8_t frame[8] = {0x30, 0x12, 0x01, 0xF4, 0x3F, 0xD0, 0x01, 0x00};
+    manager.simulate_can_message(0x4B0, frame, 8);
+    g_message_bus.process();
+    
+    assert(captured_count == 4);
+    assert(captured_values[0] == 135.5f);
+    assert(captured_values[1] == 500.0f);
+    assert(captured_values[2] == -3.0f);
+    assert(captured_values[3] == 1.0f);
+    
+    // The flag bit sits in byte 6, so a 6-byte frame drops only that signal
+    captured_count = 0;
+    manager.simulate_can_message(0x4B0, frame, 6);
+    g_message_bus.process();
+    assert(captured_count == 3);
+    assert(manager.get_statistics().extraction_errors == 1);
+    
+    // Signals must fit the 64-bit frame and 32-bit raw values
+    assert(manager.add_mapping(create_can_signal(
+        0x4B1, MSG_VEHICLE_SPEED, 60, 8, false, false, 1.0f, 0.0f, 0.0f, 255.0f)) == false);
+    assert(manager.add_mapping(create_can_signal(
+        0x4B1, MSG_VEHICLE_SPEED, 56, 2, true, false, 1.0f, 0.0f, 0.0f, 3.0f)) == false);
+    assert(manager.add_mapping(create_can_signal(
+        0x4B1, MSG_VEHICLE_SPEED, 0, 33, false, false, 1.0f, 0.0f, 0.0f, 1.0f)) == false);
+    
+    // A full 32-bit unsigned field keeps its top bit
+    assert(manager.add_mapping(create_can_signal(
+        0x4B1, MSG_VEHICLE_SPEED, 0, 32, false, false, 1.0f, 0.0f, 0.0f, 5e9f)) == true);
+    captured_count = 0;
+    uint8_t wide[8] = {0x00, 0x00, 0x00, 0x80, 0, 0, 0, 0};
+    manager.simulate_can_message(0x4B1, wide, 8);
+    g_message_bus.process();
+    assert(captured_count == 1);
+    assert(captured_values[0] == 2147483648.0f);
+    
+    manager.shutdown();
+}
+
+TEST(custom_canbus_manager_dbc_import) {
+    test_setup();
+    
+    CustomCanBusManager manager;
+    assert(manager.init() == true);
+    
+    // 2364539904 = 0x8CF00400: extended ID 0x0CF00400
+    const char* dbc =
+        "VERSION \"\"\r\n"
+        "\r\n"
+        "BU_: ABS ECU\r\n"
+        "\r\n"
+        "BO_ 1200 WHEEL_SPEEDS: 8 ABS\r\n"
+        " SG_ WHEEL_SPEED_FL : 0|16@1+ (0.01,0) [0|655.35] \"km/h\" Vector__XXX\r\n"
+        " SG_ WHEEL_SPEED_FR : 16|16@1+ (0.01,0) [0|655.35] \"km/h\" Vector__XXX\r\n"
+        " SG_ WHEEL_SPEED_RL : 32|16@1+ (0.01,0) [0|0] \"km/h\" Vector__XXX\r\n"
+        " SG_ UNUSED : 48|16@1+ (1,0) [0|0] \"\" Vector__XXX\r\n"
+        "\r\n"
+        "BO_ 2364539904 ENGINE_DATA: 8 ECU\r\n"
+        " SG_ MODE M : 0|2@1+ (1,0) [0|3] \"\" Vector__XXX\r\n"
+        " SG_ TORQUE m1 : 8|8@1+ (1,0) [0|255] \"\" Vector__XXX\r\n"
+        " SG_ COOLANT : 16|8@1- (1,40) [-88|167] \"degC\" Vector__XXX\r\n"
+        " SG_ ENGINE_SPEED : 31|16@0+ (0.125,0) [0|8031.875] \"rpm\" Vector__XXX\r\n"
+        "\r\n"
+        "CM_ SG_ 1200 WHEEL_SPEED_FL \"Front left\";\r\n";
+    
+    const can_dbc_binding_t bindings[] = {
+        {"WHEEL_SPEED_FL", 0, MSG_VEHICLE_SPEED},
+        {"WHEEL_SPEED_FR", 0, MSG_THROTTLE_POSITION},
+        {"WHEEL_SPEED_RL", 0, MSG_MANIFOLD_PRESSURE},
+        {"MODE", 0x0CF00400, MSG_BRAKE_PEDAL},
+        {"TORQUE", 0, MSG_OIL_PRESSURE},            // Multiplexed: skipped
+        {"COOLANT", 0x123, MSG_COOLANT_TEMP},       // Other message: skipped
+        {"ENGINE_SPEED", 0, MSG_ENGINE_RPM},
+    };
+    
+    assert(manager.import_dbc(dbc, bindings, 7) == 5);
+    assert(manager.get_mapping_count() == 5);
+    
+    can_mapping_t imported;
+    assert(manager.get_mapping(4, &imported) == true);
+    assert(imported.basic.external_can_id == 0x0CF00400);
+    assert(imported.basic.internal_msg_id == MSG_ENGINE_RPM);
+    assert(imported.extraction.start_bit == 31);
+    assert(imported.extraction.bit_length == 16);
+    assert(imported.extraction.flags & CAN_EXTRACT_FLAG_BIG_ENDIAN);
+    assert(imported.extraction.scale_factor == 0.125f);
+    
+    g_message_bus.subscribe(MSG_VEHICLE_SPEED, capture_all);
+    g_message_bus.subscribe(MSG_THROTTLE_POSITION, capture_all);
+    g_message_bus.subscribe(MSG_MANIFOLD_PRESSURE, capture_all);
+    g_message_bus.subscribe(MSG_BRAKE_PEDAL, capture_all);
+    g_message_bus.subscribe(MSG_ENGINE_RPM, capture_all);
+    
+    // 100.00, 200.00 and 655.35 km/h; [0|0] leaves the last unbounded
+    uint8_t wheels[8] = {0x10, 0x27, 0x20, 0x4E, 0xFF, 0xFF, 0x00, 0x00};
+    manager.simulate_can_message(1200, wheels, 8);
+    g_message_bus.process();
+    assert(captured_count == 3);
+    assert(captured_values[0] > 99.99f && captured_values[0] < 100.01f);
+    assert(captured_values[1] > 199.99f && captured_values[1] < 200.01f);
+    assert(captured_values[2] > 655.34f && captured_values[2] < 655.36f);
+    
+    // Mode 2, 24000 * 0.125 = 3000 rpm
+    captured_count = 0;
+    uint8_t engine[8] = {0x02, 0x00, 0x00, 0x5D, 0xC0, 0x00, 0x00, 0x00};
+    manager.simulate_can_message(0x0CF00400, engine, 8);
+    g_message_bus.process();
+    assert(captured_count == 2);
+    assert(captured_ids[0] == MSG_BRAKE_PEDAL && captured_values[0] == 2.0f);
+    assert(captured_ids[1] == MSG_ENGINE_RPM && captured_values[1] == 3000.0f);
+    
+    // Nothing bound, nothing added
+    assert(manager.import_dbc(dbc, bindings, 0) == 0);
+    assert(manager.import_dbc(nullptr, bindings, 7) == 0);
+    
+    manager.shutdown();
+}
+
+TEST(custom_canbus_manager_loads_byte_aligned_records) {
+    test_setup();
+    
+    // A mapping saved before extraction records grew to 16 bytes
+    can_mapping_t legacy = create_can_mapping(0x360, MSG_THROTTLE_POSITION, 0, 2, false, 0.1f, 0.0f, 100.0f);
+    uint8_t count = 1;
+    assert(g_storage_manager.save_data(CONFIG_EXTERNAL_CANBUS_COUNT, &count, sizeof(count)));
+    assert(g_storage_manager.save_data(CONFIG_EXTERNAL_CANBUS_MAPPING(0), &legacy.basic, sizeof(legacy.basic)));
+    assert(g_storage_manager.save_data(CONFIG_EXTERNAL_CANBUS_EXTRACTION(0), &legacy.extraction,
+                                       CAN_EXTRACTION_PARAMS_V1_SIZE));
+    assert(g_storage_manager.save_data(CONFIG_EXTERNAL_CANBUS_VALIDATION(0), &legacy.validation,
+                                       sizeof(legacy.validation)));
+    g_storage_manager.force_commit_cache();
+    
+    CustomCanBusManager manager;
+    assert(manager.load_configuration() == true);
+    assert(manager.init() == true);
+    assert(manager.get_mapping_count() == 1);
+    
+    can_mapping_t loaded;
+    assert(manager.get_mapping(0, &loaded) == true);
+    assert(loaded.extraction.byte_length == 2);
+    assert(loaded.extraction.bit_length == 0);
+    assert(loaded.extraction.offset == 0.0f);
+    
+    g_message_bus.subscribe(MSG_THROTTLE_POSITION, capture_message);
+    uint8_t data[8] = {0x20, 0x03, 0, 0, 0, 0, 0, 0};
+    manager.simulate_can_message(0x360, data, 8);
+    g_message_bus.process();
+    assert(message_published == true);
+    assert(published_value == 80.0f);
+    
+    manager.shutdown();
+}
+
 // =============================================================================
 // HELPER FUNCTION TESTS
 // =============================================================================
@@ -687,6 +1018,12 @@ int main() {
     run_test_custom_canbus_manager_extraction_errors();
     run_test_custom_canbus_manager_configuration_persistence();
     run_test_custom_canbus_manager_multiple_mappings_integration();
+    run_test_custom_canbus_manager_multiple_signals_per_frame();
+    run_test_custom_canbus_manager_signed_and_offset_binary();
+    run_test_custom_canbus_manager_mapping_capacity();
+    run_test_custom_canbus_manager_bit_level_signals();
+    run_test_custom_canbus_manager_dbc_import();
+    run_test_custom_canbus_manager_loads_byte_aligned_records();
     run_test_custom_canbus_manager_helper_functions();
     
     // Print results
@@ -350,6 +350,86 @@ TEST(cache_automatic_mapping_loading) {
     cache.shutdown();
 }
 
+// Test keys sharing an internal message subscribe once and all update
+TEST(cache_shared_internal_message) {
+    test_setup();
+    g_message_bus.init();
+    
+    ExternalCanBusCache cache;
+    cache.init(1000);
+    mock_millis_time = 100;
+    
+    // Dashboard and datalogger both map to engine RPM
+    float value;
+    cache.get_value(CUSTOM_DASHBOARD_RPM, &value);
+    cache.get_value(CUSTOM_DATALOGGER_RPM, &value);
+    cache.get_value(OBDII_PID_ENGINE_RPM, &value);
+    assert(cache.get_entry_count() == 3);
+    assert(cache.get_subscription_count() == 3);
+    assert(g_message_bus.getSubscriberCount() == 1);
+    
+    cache.simulate_internal_message(MSG_ENGINE_RPM, 4100.0f);
+    mock_millis_time += 5;
+    assert(cache.get_value(CUSTOM_DASHBOARD_RPM, &value) && value == 4100.0f);
+    assert(cache.get_value(CUSTOM_DATALOGGER_RPM, &value) && value == 4100.0f);
+    assert(cache.get_value(OBDII_PID_ENGINE_RPM, &value) && value == 4100.0f);
+    
+    // A removed key leaves the chain; the others keep updating
+    assert(cache.remove_mapping(CUSTOM_DATALOGGER_RPM));
+    assert(cache.get_entry_count() == 2);
+    assert(!cache.get_value(CUSTOM_DATALOGGER_RPM, &value));
+    cache.simulate_internal_message(MSG_ENGINE_RPM, 4200.0f);
+    assert(cache.get_value(CUSTOM_DASHBOARD_RPM, &value) && value == 4200.0f);
+    assert(cache.get_value(OBDII_PID_ENGINE_RPM, &value) && value == 4200.0f);
+    
+    // Clearing drops entries but not mappings or the bus subscription
+    cache.clear_all();
+    assert(cache.get_entry_count() == 0);
+    cache.get_value(CUSTOM_DASHBOARD_RPM, &value);
+    assert(cache.get_entry_count() == 1);
+    assert(g_message_bus.getSubscriberCount() == 1);
+    cache.simulate_internal_message(MSG_ENGINE_RPM, 4300.0f);
+    assert(cache.get_value(CUSTOM_DASHBOARD_RPM, &value) && value == 4300.0f);
+    
+    cache.shutdown();
+}
+
+// Test the fixed mapping capacity and key reuse
+TEST(cache_mapping_capacity) {
+    test_setup();
+    g_message_bus.init();
+    
+    ExternalCanBusCache cache;
+    cache.init(1000);
+    mock_millis_time = 100;
+    uint32_t preloaded = OBDII_CACHE_MAPPINGS_COUNT + CUSTOM_CACHE_MAPPINGS_COUNT;
+    
+    // Fill the table
+    for (uint32_t i = preloaded; i < ExternalCanBusCache::MAX_MAPPINGS; i++) {
+        assert(cache.add_mapping(0x50000 + i, MSG_VEHICLE_SPEED, 100, "Fill"));
+    }
+    assert(!cache.add_mapping(0x60000, MSG_VEHICLE_SPEED, 100, "Overflow"));
+    
+    // Remapping an existing key needs no new slot
+    assert(cache.add_mapping(0x50000 + preloaded, MSG_COOLANT_TEMP, 100, "Remap"));
+    float value;
+    cache.get_value(0x50000 + preloaded, &value);
+    cache.simulate_internal_message(MSG_COOLANT_TEMP, 91.0f);
+    mock_millis_time += 1;
+    assert(cache.get_value(0x50000 + preloaded, &value) && value == 91.0f);
+    
+    // Every key is still found after a removal rebuilds the index
+    assert(cache.remove_mapping(OBDII_PID_ENGINE_RPM));
+    assert(cache.add_mapping(0x60000, MSG_VEHICLE_SPEED, 100, "Reused slot"));
+    for (uint32_t i = preloaded + 1; i < ExternalCanBusCache::MAX_MAPPINGS; i++) {
+        cache.get_value(0x50000 + i, &value);
+    }
+    cache.get_value(0x60000, &value);
+    assert(cache.get_entry_count() == ExternalCanBusCache::MAX_MAPPINGS - preloaded + 1);
+    
+    cache.shutdown();
+}
+
 // Main test runner
 int main() {
     std::cout << "=== External CAN Bus Cache Focused Tests ===" << std::endl;
@@ -367,6 +447,8 @@ int main() {
     run_test_cache_lazy_loading();
     run_test_cache_automatic_mapping_loading();
     run_test_debug_mapping_loading_issue();
+    run_test_cache_shared_internal_message();
+    run_test_cache_mapping_capacity();
     
     // Print results
     std::cout << std::endl;
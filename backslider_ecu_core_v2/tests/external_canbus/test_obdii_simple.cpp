@@ -12,6 +12,8 @@
 #include "../../msg_definitions.h"
 #include "../../external_canbus_cache.h"
 #include "../../obdii_handler.h"
+#include "../../can_tx_scheduler.h"
+#include "../../isotp.h"
 #include "../../storage_manager.h"
 #include "../../spi_flash_storage_backend.h"
 
@@ -47,6 +49,28 @@ CAN_message_t create_obdii_request(uint8_t mode, uint8_t pid) {
     return msg;
 }
 
+// Frames the handler puts on the bus through its scheduler
+static std::vector<CAN_message_t> sent_frames;
+
+static bool capture_frame(uint8_t mailbox, const CANFD_message_t& msg, void* context) {
+    (void)mailbox;
+    (void)context;
+    CAN_message_t frame = {};
+    frame.id = msg.id;
+    frame.len = msg.len;
+    memcpy(frame.buf, msg.buf, msg.len);
+    sent_frames.push_back(frame);
+    return true;
+}
+
+static CAN_message_t create_frame(uint32_t id, const uint8_t* data, uint8_t len) {
+    CAN_message_t msg = {};
+    msg.id = id;
+    msg.len = len;
+    memcpy(msg.buf, data, len);
+    return msg;
+}
+
 // Test setup function
 void setup_test_environment() {
     mock_reset_all();
@@ -264,6 +288,139 @@ TEST(obdii_statistics_tracking) {
     assert(updated_stats.responses_sent == initial_responses + 1);
 }
 
+TEST(obdii_multi_pid_request) {
+    setup_test_environment();
+    sent_frames.clear();
+    
+    ExternalCanBusCache cache;
+    cache.init(1000);
+    CanTxScheduler scheduler;
+    scheduler.init(500000, 100, capture_frame, nullptr);
+    
+    OBDIIHandler handler(&cache);
+    handler.init();
+    handler.set_tx_scheduler(&scheduler);
+    
+    float dummy;
+    cache.get_value(OBDII_PID_ENGINE_RPM, &dummy);
+    cache.get_value(OBDII_PID_COOLANT_TEMP, &dummy);
+    cache.simulate_internal_message(MSG_ENGINE_RPM, 3000.0f);
+    cache.simulate_internal_message(MSG_COOLANT_TEMP, 90.0f);
+    
+    // RPM, an unsupported PID and coolant: the unsupported one is left out
+    uint8_t request[] = {0x04, 0x01, 0x0C, 0x1F, 0x05, 0x00, 0x00, 0x00};
+    assert(handler.process_request(create_frame(OBDII_REQUEST_ID, request, 8)));
+    assert(handler.get_statistics().multi_pid_requests == 1);
+    assert(sent_frames.size() == 1);
+    const CAN_message_t& sf = sent_frames[0];
+    assert(sf.id == OBDII_ECU_RESPONSE_ID && sf.len == 8);
+    assert(sf.buf[0] == 0x06);                          // Single frame, 6 bytes
+    assert(sf.buf[1] == 0x41 && sf.buf[2] == 0x0C);
+    assert(((sf.buf[3] << 8) | sf.buf[4]) == 12000);    // 3000 rpm x 4
+    assert(sf.buf[5] == 0x05 && sf.buf[6] == 130);      // 90 C + 40
+    assert(sf.buf[7] == ISOTP_PADDING_BYTE);
+    
+    // Six PIDs need a first frame and a consecutive frame after flow control
+    sent_frames.clear();
+    uint8_t six[] = {0x07, 0x01, 0x0C, 0x05, 0x0C, 0x05, 0x0C, 0x05};
+    assert(handler.process_request(create_frame(OBDII_REQUEST_ID, six, 8)));
+    assert(sent_frames.size() == 1);
+    assert(sent_frames[0].buf[0] == 0x10 && sent_frames[0].buf[1] == 16);
+    assert(sent_frames[0].buf[2] == 0x41 && sent_frames[0].buf[3] == 0x0C);
+    
+    // STmin 5 ms: the first consecutive frame at once, the next one paced
+    uint8_t flow_control[] = {0x30, 0x00, 0x05, 0, 0, 0, 0, 0};
+    assert(handler.process_request(create_frame(OBDII_PHYSICAL_REQUEST_ID, flow_control, 8)));
+    assert(sent_frames.size() == 2);
+    mock_advance_time_us(1000);
+    handler.update(micros());
+    assert(sent_frames.size() == 2);
+    mock_advance_time_us(4000);
+    handler.update(micros());
+    assert(sent_frames.size() == 3);
+    assert(sent_frames[1].buf[0] == 0x21 && sent_frames[2].buf[0] == 0x22);
+    assert(handler.get_isotp_statistics().transfers_completed == 1);
+    assert(handler.get_statistics().segmented_responses == 1);
+    
+    // Supported PIDs bitmap follows SAE J1979 bit order
+    sent_frames.clear();
+    uint8_t supported[] = {0x02, 0x01, 0x00, 0, 0, 0, 0, 0};
+    assert(handler.process_request(create_frame(OBDII_REQUEST_ID, supported, 8)));
+    assert(sent_frames.size() == 1);
+    assert(sent_frames[0].buf[3] == 0x18 && sent_frames[0].buf[4] == 0x3A);
+    assert(sent_frames[0].buf[5] == 0x80 && sent_frames[0].buf[6] == 0x00);
+}
+
+TEST(obdii_no_supported_pids) {
+    setup_test_environment();
+    sent_frames.clear();
+    
+    ExternalCanBusCache cache;
+    cache.init(1000);
+    CanTxScheduler scheduler;
+    scheduler.init(500000, 100, capture_frame, nullptr);
+    
+    OBDIIHandler handler(&cache);
+    handler.init();
+    handler.set_tx_scheduler(&scheduler);
+    
+    // Functional request: other ECUs may answer, so stay silent
+    uint8_t request[] = {0x02, 0x01, 0x1F, 0, 0, 0, 0, 0};
+    assert(handler.process_request(create_frame(OBDII_REQUEST_ID, request, 8)));
+    assert(sent_frames.empty());
+    
+    // Physical request: negative response
+    assert(handler.process_request(create_frame(OBDII_PHYSICAL_REQUEST_ID, request, 8)));
+    assert(sent_frames.size() == 1);
+    assert(sent_frames[0].buf[0] == 0x03 && sent_frames[0].buf[1] == OBDII_NEGATIVE_RESPONSE);
+    assert(sent_frames[0].buf[2] == 0x01 && sent_frames[0].buf[3] == OBDII_NRC_SUBFUNC_NOT_SUPPORTED);
+}
+
+TEST(obdii_vin_isotp_flow_control) {
+    setup_test_environment();
+    sent_frames.clear();
+    
+    ExternalCanBusCache cache;
+    cache.init(1000);
+    CanTxScheduler scheduler;
+    scheduler.init(500000, 100, capture_frame, nullptr);
+    
+    OBDIIHandler handler(&cache);
+    handler.init();
+    handler.set_tx_scheduler(&scheduler);
+    handler.set_vin("1BKSLDR0123456789");
+    
+    // 49 02 01 + 17 characters: first frame and two consecutive frames
+    uint8_t request[] = {0x02, 0x09, 0x02, 0, 0, 0, 0, 0};
+    assert(handler.process_request(create_frame(OBDII_REQUEST_ID, request, 8)));
+    assert(sent_frames.size() == 1);
+    assert(sent_frames[0].buf[0] == 0x10 && sent_frames[0].buf[1] == 20);
+    assert(sent_frames[0].buf[2] == 0x49 && sent_frames[0].buf[3] == 0x02);
+    assert(sent_frames[0].buf[4] == 0x01 && sent_frames[0].buf[5] == '1');
+    
+    // Block size 1: one consecutive frame per flow control
+    uint8_t flow_control[] = {0x30, 0x01, 0x00, 0, 0, 0, 0, 0};
+    assert(handler.process_request(create_frame(OBDII_PHYSICAL_REQUEST_ID, flow_control, 8)));
+    assert(sent_frames.size() == 2);
+    assert(sent_frames[1].buf[0] == 0x21 && sent_frames[1].buf[1] == 'S');
+    mock_advance_time_us(10000);
+    handler.update(micros());
+    assert(sent_frames.size() == 2);                    // Waiting for the next FC
+    
+    assert(handler.process_request(create_frame(OBDII_PHYSICAL_REQUEST_ID, flow_control, 8)));
+    assert(sent_frames.size() == 3);
+    assert(sent_frames[2].buf[0] == 0x22 && sent_frames[2].buf[7] == '9');
+    assert(handler.get_isotp_statistics().transfers_completed == 1);
+    
+    // No flow control within N_Bs: the transfer is dropped
+    assert(handler.process_request(create_frame(OBDII_REQUEST_ID, request, 8)));
+    mock_advance_time_us(ISOTP_N_BS_TIMEOUT_US);
+    handler.update(micros());
+    assert(handler.get_isotp_statistics().timeouts == 1);
+    assert(handler.get_isotp_statistics().transfers_aborted == 1);
+    assert(!handler.process_request(create_frame(OBDII_PHYSICAL_REQUEST_ID, flow_control, 8)));
+}
+
 // ============================================================================
 // TEST RUNNER
 // ============================================================================
@@ -280,6 +437,9 @@ void run_all_tests() {
     run_test_obdii_unsupported_pid_handling();
     run_test_obdii_cache_miss_handling();
     run_test_obdii_statistics_tracking();
+    run_test_obdii_multi_pid_request();
+    run_test_obdii_no_supported_pids();
+    run_test_obdii_vin_isotp_flow_control();
     
     std::cout << "\n==================================" << std::endl;
     std::cout << "Simplified OBD-II Tests Complete: " << tests_passed << "/" << tests_run << " passed" << std::endl;
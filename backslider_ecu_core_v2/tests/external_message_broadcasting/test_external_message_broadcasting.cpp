@@ -302,6 +302,129 @@ static bool test_frequency_based_broadcasting() {
     return true;
 }
 
+static bool test_timer_wheel_scheduling() {
+    std::cout << "  Running test: timer_wheel_scheduling... ";
+    
+    mock_millis_time = 1000;
+    ExternalMessageBroadcasting::init();
+    ExternalMessageBroadcasting::register_broadcast_message(TEST_MSG_1, "Fast", 20);       // 50 ms
+    ExternalMessageBroadcasting::register_broadcast_message(TEST_MSG_2, "Slow", 1);        // 1000 ms, past one wheel revolution
+    ExternalMessageBroadcasting::register_broadcast_message(TEST_MSG_3, "On change", 0);
+    
+    // Nothing is scheduled until a value is cached
+    ExternalMessageBroadcasting::update();
+    assert(ExternalMessageBroadcasting::get_messages_broadcast() == 0);
+    
+    g_message_bus.publishFloat(TEST_MSG_1, 1.0f);
+    g_message_bus.publishFloat(TEST_MSG_2, 2.0f);
+    g_message_bus.process();
+    
+    // Step 1 ms at a time for two seconds: both due at once, then on period
+    for (uint32_t i = 0; i < 2000; i++) {
+        mock_millis_time++;
+        ExternalMessageBroadcasting::update();
+    }
+    assert(ExternalMessageBroadcasting::get_messages_broadcast() == 40 + 2);
+    
+    // A long gap sends each overdue message once
+    ExternalMessageBroadcasting::reset_statistics();
+    mock_millis_time += 5000;
+    ExternalMessageBroadcasting::update();
+    assert(ExternalMessageBroadcasting::get_messages_broadcast() == 2);
+    
+    // Disabled messages leave the wheel; a new frequency applies from the last send
+    ExternalMessageBroadcasting::reset_statistics();
+    ExternalMessageBroadcasting::enable_broadcast_message(TEST_MSG_2, false);
+    ExternalMessageBroadcasting::set_broadcast_frequency(TEST_MSG_1, 10);                // 100 ms
+    for (uint32_t i = 0; i < 1000; i++) {
+        mock_millis_time++;
+        ExternalMessageBroadcasting::update();
+    }
+    assert(ExternalMessageBroadcasting::get_messages_broadcast() == 10);
+    
+    // Removing an entry in front keeps the others on schedule
+    ExternalMessageBroadcasting::reset_statistics();
+    ExternalMessageBroadcasting::unregister_broadcast_message(TEST_MSG_3);
+    ExternalMessageBroadcasting::unregister_broadcast_message(TEST_MSG_2);
+    assert(ExternalMessageBroadcasting::is_message_registered(TEST_MSG_1));
+    assert(!ExternalMessageBroadcasting::is_message_registered(TEST_MSG_2));
+    for (uint32_t i = 0; i < 500; i++) {
+        mock_millis_time++;
+        ExternalMessageBroadcasting::update();
+    }
+    assert(ExternalMessageBroadcasting::get_messages_broadcast() == 5);
+    
+    std::cout << "PASSED" << std::endl;
+    return true;
+}
+
+static bool test_broadcast_groups() {
+    std::cout << "  Running test: broadcast_groups... ";
+    
+    ExternalMessageBroadcasting::init();
+    ExternalMessageBroadcasting::set_external_interfaces(&real_canbus, &real_serial);
+    MockFlexCAN* can = real_canbus.get_mock_can();
+    
+    // The float after two 16-bit values would straddle frames: it starts the second
+    const broadcast_group_signal_t signals[] = {
+        {TEST_MSG_1, BROADCAST_ENCODING_FLOAT32,  0.0f,   0.0f},
+        {TEST_MSG_2, BROADCAST_ENCODING_SCALED16, 0.1f, -40.0f},
+        {TEST_MSG_3, BROADCAST_ENCODING_SCALED16, 1.0f,   0.0f},
+        {0x4000,     BROADCAST_ENCODING_FLOAT32,  0.0f,   0.0f},
+    };
+    assert(ExternalMessageBroadcasting::register_broadcast_group(0x6F0, signals, 4, 20, "Test group"));
+    assert(!ExternalMessageBroadcasting::register_broadcast_group(0x6F0, signals, 4, 20, "Duplicate"));
+    assert(ExternalMessageBroadcasting::get_group_payload_length(0x6F0) == 12);
+    
+    // Members are cached but not sent on their own
+    can->clear_tx_frames();
+    g_message_bus.publishFloat(TEST_MSG_1, 1.5f);
+    g_message_bus.publishFloat(TEST_MSG_2, 25.0f);
+    g_message_bus.publishFloat(0x4000, -2.0f);
+    g_message_bus.process();
+    assert(can->get_tx_frames().empty());
+    
+    // One sample is two classic frames on consecutive IDs
+    mock_millis_time += 50;
+    ExternalMessageBroadcasting::update();
+    assert(ExternalMessageBroadcasting::get_group_broadcasts() == 1);
+    assert(can->get_tx_frames().size() == 2);
+    const CAN_message_t& first = can->get_tx_frames()[0];
+    const CAN_message_t& second = can->get_tx_frames()[1];
+    assert(first.id == 0x6F0 && first.len == 8);
+    assert(second.id == 0x6F1 && second.len == 4);
+    float value;
+    memcpy(&value, &first.buf[0], 4);
+    assert(value == 1.5f);
+    assert((first.buf[4] | (first.buf[5] << 8)) == 650);                                 // (25 + 40) / 0.1
+    assert((first.buf[6] | (first.buf[7] << 8)) == BROADCAST_SCALED16_NOT_AVAILABLE);   // Never published
+    memcpy(&value, &second.buf[0], 4);
+    assert(value == -2.0f);
+    
+    // Registering a member on its own sends it alone too
+    assert(ExternalMessageBroadcasting::register_broadcast_message(TEST_MSG_1, "Alone", 0));
+    can->clear_tx_frames();
+    g_message_bus.publishFloat(TEST_MSG_1, 3.0f);
+    g_message_bus.process();
+    assert(can->get_tx_frames().size() == 1 && can->get_tx_frames()[0].id == TEST_MSG_1);
+    
+    // Dropping the group drops the members nothing else needs
+    assert(ExternalMessageBroadcasting::unregister_broadcast_group(0x6F0));
+    assert(ExternalMessageBroadcasting::is_message_registered(TEST_MSG_1));
+    assert(!ExternalMessageBroadcasting::is_message_registered(TEST_MSG_2));
+    can->clear_tx_frames();
+    mock_millis_time += 100;
+    ExternalMessageBroadcasting::update();
+    assert(can->get_tx_frames().empty());
+    
+    // Dashboard: nine 16-bit channels in three frames
+    register_dashboard_broadcast_group();
+    assert(ExternalMessageBroadcasting::get_group_payload_length(BROADCAST_GROUP_DASHBOARD_ID) == 18);
+    
+    std::cout << "PASSED" << std::endl;
+    return true;
+}
+
 // Main test runner
 int main() {
     std::cout << "=== External Message Broadcasting Tests ===" << std::endl;
@@ -321,6 +444,8 @@ int main() {
     all_passed &= test_statistics();
     all_passed &= test_configuration_access();
     all_passed &= test_frequency_based_broadcasting();
+    all_passed &= test_timer_wheel_scheduling();
+    all_passed &= test_broadcast_groups();
     
     std::cout << std::endl;
     std::cout << "=== Test Results ===" << std::endl;
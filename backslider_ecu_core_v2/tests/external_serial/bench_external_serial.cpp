@@ -0,0 +1,165 @@
+// tests/external_serial/bench_external_serial.cpp
+// Desktop microbenchmarks for the serial bridge frame paths
+//
+//   - update() parsing legacy 0xFF 0xFF frames and v2 COBS/CRC frames
+//   - send_message() emitting legacy frames and packing v2 frames
+//
+// Parse cases include the mock Serial read() per byte, which a real UART
+// FIFO does not cost; compare them against earlier runs, not against the
+// emit cases.
+//
+// Usage: make bench, or ./external_serial/bench_external_serial --output FILE
+// (see tests/bench.h for --baseline, --tolerance and --rounds)
+
+// Include mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../external_serial.h"
+#include "../../serial_link.h"
+#include "../bench.h"
+
+static const int FRAMES_PER_ROUND = 100;        // Received publishes fit one bus lane
+static const uint16_t LINK_MTU = 128;
+static const int RECORDS_PER_FRAME = 9;         // 13-byte float records in a 128-byte frame
+
+static SerialBridge legacy_bridge;
+static SerialBridge framed_bridge;
+
+static std::vector<uint8_t> legacy_stream;
+static std::vector<uint8_t> framed_stream;
+static CANMessage outbound[FRAMES_PER_ROUND];
+
+static CANMessage make_message(uint32_t id, float value) {
+    CANMessage msg = {};
+    msg.id = id;
+    msg.len = sizeof(float);
+    msg.flags.extended = 1;
+    memcpy(msg.buf, &value, sizeof(float));
+    msg.timestamp_us = micros();
+    msg.timestamp = (uint16_t)msg.timestamp_us;
+    return msg;
+}
+
+static void append_legacy(std::vector<uint8_t>& out, const CANMessage& msg) {
+    out.push_back(0xFF);
+    out.push_back(0xFF);
+    out.insert(out.end(), (const uint8_t*)&msg, (const uint8_t*)&msg + sizeof(CANFrame));
+}
+
+// Same layout as build_link_frame() in test_external_serial.cpp
+static void append_framed(std::vector<uint8_t>& out, uint8_t seq, const CANMessage* messages, int count) {
+    std::vector<uint8_t> raw;
+    raw.push_back(seq);
+    for (int m = 0; m < count; m++) {
+        const CANMessage& msg = messages[m];
+        for (int i = 0; i < 4; i++) raw.push_back((uint8_t)(msg.id >> (8 * i)));
+        raw.push_back(msg.len | SERIAL_LINK_CTL_EXTENDED);
+        for (int i = 0; i < 4; i++) raw.push_back((uint8_t)(msg.timestamp_us >> (8 * i)));
+        raw.insert(raw.end(), msg.buf, msg.buf + msg.len);
+    }
+    uint16_t crc = serial_link_crc16(raw.data(), raw.size());
+    raw.push_back((uint8_t)crc);
+    raw.push_back((uint8_t)(crc >> 8));
+
+    std::vector<uint8_t> encoded(raw.size() + raw.size() / 254 + 2);
+    encoded.resize(serial_link_cobs_encode(raw.data(), raw.size(), encoded.data()));
+    encoded.push_back(0x00);
+    out.insert(out.end(), encoded.begin(), encoded.end());
+}
+
+static void setup_bridges(void) {
+    mock_reset_all();
+    Serial.reset();
+    Serial1.reset();
+    g_message_bus.init();
+    mock_set_micros(1000);
+
+    serial_port_config_t config = DEFAULT_EXTERNAL_SERIAL_CONFIG.usb;
+    legacy_bridge.init(&Serial, config);
+    framed_bridge.init(&Serial1, config);
+
+    serial_link_msg_t hello = {};
+    hello.version = SERIAL_LINK_VERSION_FRAMED;
+    hello.mtu = LINK_MTU;
+    CANMessage hello_msg = make_message(MSG_SERIAL_LINK_HELLO, 0.0f);
+    hello_msg.len = sizeof(hello);
+    memcpy(hello_msg.buf, &hello, sizeof(hello));
+    std::vector<uint8_t> hello_bytes;
+    append_legacy(hello_bytes, hello_msg);
+    Serial1.add_data_to_read(hello_bytes.data(), hello_bytes.size());
+    framed_bridge.update();
+    if (framed_bridge.get_link_version() != SERIAL_LINK_VERSION_FRAMED) {
+        std::cerr << "  v2 link negotiation failed" << std::endl;
+    }
+
+    for (int i = 0; i < FRAMES_PER_ROUND; i++) {
+        outbound[i] = make_message(0x10300000 + i, i * 1.5f);
+        append_legacy(legacy_stream, outbound[i]);
+    }
+    uint8_t seq = 0;
+    for (int i = 0; i < FRAMES_PER_ROUND; i += RECORDS_PER_FRAME) {
+        int count = (FRAMES_PER_ROUND - i < RECORDS_PER_FRAME) ? FRAMES_PER_ROUND - i : RECORDS_PER_FRAME;
+        append_framed(framed_stream, seq++, &outbound[i], count);
+    }
+}
+
+// Feed a whole round of bytes, then parse until the port is empty
+static void parse_all(SerialBridge& bridge, MockSerial& port) {
+    for (int guard = 0; port.available() > 0 && guard < 1000; guard++) {
+        bridge.update();
+    }
+}
+
+static void run_benchmarks(void) {
+    setup_bridges();
+
+    uint32_t received_before = legacy_bridge.get_messages_received();
+    bench_run("parse_legacy_frame", FRAMES_PER_ROUND,
+        [] {
+            g_message_bus.process();
+            Serial.clear_written_data();
+            Serial.clear_read_data();
+            Serial.add_data_to_read(legacy_stream.data(), legacy_stream.size());
+        },
+        [] { parse_all(legacy_bridge, Serial); });
+    if (legacy_bridge.get_messages_received() == received_before) {
+        std::cerr << "  parse_legacy_frame received nothing" << std::endl;
+    }
+
+    received_before = framed_bridge.get_messages_received();
+    bench_run("parse_v2_record", FRAMES_PER_ROUND,
+        [] {
+            g_message_bus.process();
+            Serial1.clear_written_data();
+            Serial1.clear_read_data();
+            Serial1.add_data_to_read(framed_stream.data(), framed_stream.size());
+        },
+        [] { parse_all(framed_bridge, Serial1); });
+    if (framed_bridge.get_messages_received() == received_before) {
+        std::cerr << "  parse_v2_record received nothing" << std::endl;
+    }
+
+    bench_run("emit_legacy_frame", FRAMES_PER_ROUND,
+        [] { Serial.clear_written_data(); },
+        [] {
+            for (int i = 0; i < FRAMES_PER_ROUND; i++) {
+                legacy_bridge.send_message(outbound[i]);
+            }
+        });
+
+    bench_run("emit_v2_record", FRAMES_PER_ROUND,
+        [] { Serial1.clear_written_data(); },
+        [] {
+            for (int i = 0; i < FRAMES_PER_ROUND; i++) {
+                framed_bridge.send_message(outbound[i]);
+            }
+            framed_bridge.flush_link_frame();
+        });
+    bench_sink = bench_sink + legacy_bridge.get_messages_sent() + framed_bridge.get_messages_sent();
+}
+
+int main(int argc, char** argv) {
+    return bench_main(argc, argv, "external_serial", run_benchmarks);
+}
@@ -5,6 +5,7 @@
 #include <cstring>
 #include <cstdio>
 #include <vector>
+#include <map>
 #include <string>
 #include "../mock_arduino.h"
 #include "../../external_serial.h"
@@ -38,7 +39,8 @@ CANMessage create_test_message(uint32_t id, uint8_t len, const uint8_t* data) {
     msg.id = id;
     msg.len = len;
     memcpy(msg.buf, data, len);
-    msg.timestamp = millis();
+    msg.timestamp_us = micros();
+    msg.timestamp = (uint16_t)msg.timestamp_us;
     return msg;
 }
 
@@ -57,7 +59,8 @@ CANMessage create_parameter_message(uint32_t id, uint8_t operation, float value,
     param_data[7] = 0;  // reserved
     
     memcpy(msg.buf, param_data, 8);
-    msg.timestamp = millis();
+    msg.timestamp_us = micros();
+    msg.timestamp = (uint16_t)msg.timestamp_us;
     return msg;
 }
 
@@ -85,7 +88,7 @@ void test_binary_prefix_handling() {
     assert(written_data[1] == 0xFF);
     
     // Verify CAN message follows prefix
-    assert(written_data.size() == 2 + sizeof(CANMessage));
+    assert(written_data.size() == 2 + sizeof(CANFrame));
     
     printf("✓ Binary prefix handling tests passed\n");
 }
@@ -112,7 +115,7 @@ void test_incoming_prefix_parsing() {
     
     // Add CAN message bytes
     const uint8_t* msg_bytes = (const uint8_t*)&msg;
-    for (size_t i = 0; i < sizeof(CANMessage); i++) {
+    for (size_t i = 0; i < sizeof(CANFrame); i++) {
         Serial.add_byte_to_read(msg_bytes[i]);
     }
     
@@ -149,7 +152,7 @@ void test_mixed_stream_handling() {
     Serial.add_byte_to_read(0xFF);
     Serial.add_byte_to_read(0xFF);
     const uint8_t* msg_bytes = (const uint8_t*)&msg;
-    for (size_t i = 0; i < sizeof(CANMessage); i++) {
+    for (size_t i = 0; i < sizeof(CANFrame); i++) {
         Serial.add_byte_to_read(msg_bytes[i]);
     }
     
@@ -197,7 +200,7 @@ void test_parameter_message_processing() {
     Serial.add_byte_to_read(0xFF);
     Serial.add_byte_to_read(0xFF);
     const uint8_t* msg_bytes = (const uint8_t*)&request;
-    for (size_t i = 0; i < sizeof(CANMessage); i++) {
+    for (size_t i = 0; i < sizeof(CANFrame); i++) {
         Serial.add_byte_to_read(msg_bytes[i]);
     }
     
@@ -264,7 +267,7 @@ void test_buffer_management() {
     Serial.add_byte_to_read(0xFF);
     Serial.add_byte_to_read(0xFF);
     const uint8_t* msg_bytes = (const uint8_t*)&msg;
-    for (size_t i = 0; i < sizeof(CANMessage); i++) {
+    for (size_t i = 0; i < sizeof(CANFrame); i++) {
         Serial.add_byte_to_read(msg_bytes[i]);
     }
     
@@ -320,7 +323,7 @@ void test_message_sending_with_prefix() {
     
     // Verify binary data was written to serial with prefix
     std::vector<uint8_t> written_data = bridge.get_written_data_for_testing();
-    assert(written_data.size() == 2 + sizeof(CANMessage));  // prefix + CAN message
+    assert(written_data.size() == 2 + sizeof(CANFrame));  // prefix + CAN message
     
     // Verify prefix
     assert(written_data[0] == 0xFF);
@@ -328,7 +331,7 @@ void test_message_sending_with_prefix() {
     
     // Verify the CAN message data
     CANMessage received_msg;
-    memcpy(&received_msg, &written_data[2], sizeof(CANMessage));
+    memcpy(&received_msg, &written_data[2], sizeof(CANFrame));
     assert(received_msg.id == msg.id);
     assert(received_msg.len == msg.len);
     assert(memcmp(received_msg.buf, msg.buf, msg.len) == 0);
@@ -492,6 +495,652 @@ void test_tx_rx_enable_disable() {
     printf("✓ TX/RX enable/disable tests passed\n");
 }
 
+// Host side of the v2 link: records -> one encoded, delimited frame
+std::vector<uint8_t> build_link_frame(uint8_t seq, const std::vector<CANMessage>& messages) {
+    std::vector<uint8_t> raw;
+    raw.push_back(seq);
+    for (const CANMessage& msg : messages) {
+        for (int i = 0; i < 4; i++) raw.push_back((uint8_t)(msg.id >> (8 * i)));
+        raw.push_back(msg.len | (msg.flags.extended ? SERIAL_LINK_CTL_EXTENDED : 0));
+        for (int i = 0; i < 4; i++) raw.push_back((uint8_t)(msg.timestamp_us >> (8 * i)));
+        raw.insert(raw.end(), msg.buf, msg.buf + msg.len);
+    }
+    uint16_t crc = serial_link_crc16(raw.data(), raw.size());
+    raw.push_back((uint8_t)crc);
+    raw.push_back((uint8_t)(crc >> 8));
+    
+    std::vector<uint8_t> encoded(raw.size() + raw.size() / 254 + 2);
+    encoded.resize(serial_link_cobs_encode(raw.data(), raw.size(), encoded.data()));
+    encoded.push_back(0x00);
+    return encoded;
+}
+
+CANMessage create_link_hello(uint8_t version, uint16_t mtu) {
+    serial_link_msg_t hello = {};
+    hello.version = version;
+    hello.mtu = mtu;
+    CANMessage msg = create_test_message(MSG_SERIAL_LINK_HELLO, sizeof(hello), (const uint8_t*)&hello);
+    msg.flags.extended = true;
+    return msg;
+}
+
+void feed_legacy(MockSerial& port, const CANMessage& msg) {
+    port.add_byte_to_read(0xFF);
+    port.add_byte_to_read(0xFF);
+    port.add_data_to_read((const uint8_t*)&msg, sizeof(CANFrame));
+}
+
+// Test the v2 framing helpers against known values
+void test_link_framing_helpers() {
+    printf("Testing link framing helpers...\n");
+    
+    // CRC-16/CCITT-FALSE check value
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    assert(serial_link_crc16(check, sizeof(check)) == 0x29B1);
+    
+    // Zeros vanish from the encoding and come back on decode
+    const uint8_t with_zeros[] = {0x00, 0x11, 0x00, 0x00, 0x22, 0x33, 0x00};
+    uint8_t encoded[16];
+    size_t encoded_len = serial_link_cobs_encode(with_zeros, sizeof(with_zeros), encoded);
+    assert(encoded_len == sizeof(with_zeros) + 1);
+    for (size_t i = 0; i < encoded_len; i++) {
+        assert(encoded[i] != 0x00);
+    }
+    assert(serial_link_cobs_decode(encoded, encoded_len) == sizeof(with_zeros));
+    assert(memcmp(encoded, with_zeros, sizeof(with_zeros)) == 0);
+    
+    // Runs longer than 254 non-zero bytes take an extra code byte
+    uint8_t run[300];
+    for (size_t i = 0; i < sizeof(run); i++) run[i] = (uint8_t)(i % 255 + 1);
+    uint8_t run_encoded[310];
+    size_t run_len = serial_link_cobs_encode(run, sizeof(run), run_encoded);
+    assert(run_len == sizeof(run) + 2);
+    assert(serial_link_cobs_decode(run_encoded, run_len) == sizeof(run));
+    assert(memcmp(run_encoded, run, sizeof(run)) == 0);
+    
+    // A code byte pointing past the end is malformed
+    uint8_t truncated[] = {0x05, 0x11, 0x22};
+    assert(serial_link_cobs_decode(truncated, sizeof(truncated)) == 0);
+    
+    printf("✓ Link framing helpers tests passed\n");
+}
+
+// Test the hello/ack switch and size/deadline batching of outbound messages
+void test_link_negotiation_and_batching() {
+    printf("Testing link negotiation and batching...\n");
+    
+    setup_test_message_bus();
+    reset_mock_serials();
+    mock_set_micros(1000);
+    
+    SerialBridge bridge;
+    serial_port_config_t config = DEFAULT_EXTERNAL_SERIAL_CONFIG.usb;
+    assert(bridge.init(&Serial, config));
+    assert(bridge.get_link_version() == SERIAL_LINK_VERSION_LEGACY);
+    
+    // Legacy hello asking for a smaller MTU than ours
+    feed_legacy(Serial, create_link_hello(SERIAL_LINK_VERSION_FRAMED, 128));
+    bridge.update();
+    assert(bridge.get_link_version() == SERIAL_LINK_VERSION_FRAMED);
+    assert(bridge.get_link_mtu() == 128);
+    assert(bridge.get_messages_received() == 0);
+    
+    // The ack goes out in the legacy format
+    std::vector<uint8_t> written = bridge.get_written_data_for_testing();
+    assert(written.size() == 2 + sizeof(CANFrame));
+    CANMessage ack;
+    memcpy(&ack, &written[2], sizeof(CANFrame));
+    assert(ack.id == MSG_SERIAL_LINK_ACK);
+    serial_link_msg_t reply;
+    memcpy(&reply, ack.buf, sizeof(reply));
+    assert(reply.version == SERIAL_LINK_VERSION_FRAMED);
+    assert(reply.mtu == 128);
+    Serial.clear_written_data();
+    
+    // 9 float messages (13 bytes each) fill a 128-byte frame; the rest wait
+    uint32_t first_stamp_us = micros();
+    for (uint8_t i = 0; i < 20; i++) {
+        float value = i * 1.5f;
+        CANMessage msg = create_test_message(0x10300000 + i, 4, (const uint8_t*)&value);
+        msg.timestamp_us = first_stamp_us + i * 3;     // As if published 3 us apart
+        bridge.send_message(msg);
+    }
+    assert(bridge.get_messages_sent() == 20);
+    assert(bridge.get_frames_sent() == 2);
+    
+    // Deadline flush picks up the remainder
+    mock_advance_time_us(config.link_flush_us - 1);
+    bridge.update();
+    assert(bridge.get_frames_sent() == 2);
+    mock_advance_time_us(1);
+    bridge.update();
+    assert(bridge.get_frames_sent() == 3);
+    
+    // Host view: three CRC-valid frames carrying all 20 messages in order,
+    // each with its full 32-bit publish stamp
+    written = bridge.get_written_data_for_testing();
+    size_t records = 0;
+    size_t frames = 0;
+    std::vector<uint8_t> frame;
+    for (uint8_t byte : written) {
+        if (byte != 0x00) {
+            frame.push_back(byte);
+            continue;
+        }
+        size_t length = serial_link_cobs_decode(frame.data(), frame.size());
+        assert(length >= 3 && length <= 128);
+        uint16_t crc = frame[length - 2] | (frame[length - 1] << 8);
+        assert(crc == serial_link_crc16(frame.data(), length - 2));
+        assert(frame[0] == frames);     // Sequence
+        for (size_t pos = 1; pos < length - 2; ) {
+            uint32_t id = frame[pos] | (frame[pos + 1] << 8) | (frame[pos + 2] << 16) | ((uint32_t)frame[pos + 3] << 24);
+            uint8_t len = frame[pos + 4] & SERIAL_LINK_CTL_LEN_MASK;
+            assert(id == 0x10300000 + records);
+            uint32_t stamp_us = frame[pos + 5] | (frame[pos + 6] << 8) | (frame[pos + 7] << 16) | ((uint32_t)frame[pos + 8] << 24);
+            assert(stamp_us == first_stamp_us + records * 3);
+            float value;
+            memcpy(&value, &frame[pos + SERIAL_LINK_RECORD_HEADER], 4);
+            assert(value == records * 1.5f);
+            pos += SERIAL_LINK_RECORD_HEADER + len;
+            records++;
+        }
+        frames++;
+        frame.clear();
+    }
+    assert(frames == 3);
+    assert(records == 20);
+    
+    // Under two thirds of the bytes of 20 legacy frames, stamps included
+    assert(written.size() * 3 <= 20 * (2 + sizeof(CANFrame)) * 2);
+    
+    printf("✓ Link negotiation and batching tests passed\n");
+}
+
+// Test inbound v2 frames, CRC rejection and resync on the next delimiter
+void test_link_receive_and_resync() {
+    printf("Testing link receive and resync...\n");
+    
+    setup_test_message_bus();
+    reset_mock_serials();
+    
+    SerialBridge bridge;
+    assert(bridge.init(&Serial, DEFAULT_EXTERNAL_SERIAL_CONFIG.usb));
+    feed_legacy(Serial, create_link_hello(SERIAL_LINK_VERSION_FRAMED, 256));
+    bridge.update();
+    assert(bridge.get_link_version() == SERIAL_LINK_VERSION_FRAMED);
+    
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+    std::vector<CANMessage> batch = {
+        create_test_message(0x10500001, 4, data),
+        create_test_message(0x10500002, 2, data),
+        create_test_message(0x00000123, 4, data),   // Internal ID, filtered
+    };
+    std::vector<uint8_t> good = build_link_frame(0, batch);
+    Serial.add_data_to_read(good.data(), good.size());
+    bridge.update();
+    assert(bridge.get_messages_received() == 2);
+    assert(bridge.get_crc_errors() == 0);
+    
+    // Corrupt one byte: the whole frame is dropped, the next one is fine
+    std::vector<uint8_t> bad = build_link_frame(1, batch);
+    bad[3] ^= 0x40;
+    Serial.add_data_to_read(bad.data(), bad.size());
+    std::vector<uint8_t> next = build_link_frame(2, batch);
+    Serial.add_data_to_read(next.data(), next.size());
+    bridge.update();
+    assert(bridge.get_crc_errors() == 1);
+    assert(bridge.get_messages_received() == 4);
+    
+    // Line noise without a delimiter longer than any frame: resync on 0x00
+    for (int i = 0; i < SERIAL_LINK_MAX_ENCODED + 10; i++) {
+        Serial.add_byte_to_read(0x5A);
+    }
+    bridge.update();
+    Serial.add_byte_to_read(0x00);
+    bridge.update();
+    uint32_t errors = bridge.get_parse_errors();
+    assert(errors >= 1);
+    Serial.add_data_to_read(good.data(), good.size());
+    bridge.update();
+    assert(bridge.get_messages_received() == 6);
+    
+    printf("✓ Link receive and resync tests passed\n");
+}
+
+// Test a v1 hello drops back to legacy and link_mtu = 0 refuses v2
+void test_link_fallback() {
+    printf("Testing link fallback...\n");
+    
+    setup_test_message_bus();
+    reset_mock_serials();
+    
+    SerialBridge bridge;
+    assert(bridge.init(&Serial, DEFAULT_EXTERNAL_SERIAL_CONFIG.usb));
+    feed_legacy(Serial, create_link_hello(SERIAL_LINK_VERSION_FRAMED, 256));
+    bridge.update();
+    Serial.clear_written_data();
+    
+    // v1 hello inside a v2 frame: acked as a v2 frame, then legacy
+    std::vector<uint8_t> hello = build_link_frame(0, {create_link_hello(SERIAL_LINK_VERSION_LEGACY, 0)});
+    Serial.add_data_to_read(hello.data(), hello.size());
+    bridge.update();
+    assert(bridge.get_link_version() == SERIAL_LINK_VERSION_LEGACY);
+    assert(bridge.get_frames_sent() == 1);
+    std::vector<uint8_t> written = bridge.get_written_data_for_testing();
+    assert(written.back() == 0x00);
+    Serial.clear_written_data();
+    
+    uint8_t data[] = {0x01, 0x02};
+    bridge.send_message(create_test_message(0x123, 2, data));
+    written = bridge.get_written_data_for_testing();
+    assert(written.size() == 2 + sizeof(CANFrame));
+    assert(written[0] == 0xFF && written[1] == 0xFF);
+    
+    // A port with v2 turned off answers version 1 and stays legacy
+    reset_mock_serials();
+    serial_port_config_t legacy_only = {true, 115200, true, true};
+    assert(bridge.init(&Serial, legacy_only));
+    feed_legacy(Serial, create_link_hello(SERIAL_LINK_VERSION_FRAMED, 256));
+    bridge.update();
+    assert(bridge.get_link_version() == SERIAL_LINK_VERSION_LEGACY);
+    written = bridge.get_written_data_for_testing();
+    CANMessage ack;
+    memcpy(&ack, &written[2], sizeof(CANFrame));
+    assert(ack.id == MSG_SERIAL_LINK_ACK && ack.buf[0] == SERIAL_LINK_VERSION_LEGACY);
+    
+    printf("✓ Link fallback tests passed\n");
+}
+
+// Test a port that cannot take bytes never blocks: the ring fills by priority, then drains
+void test_tx_ring_drop_policy() {
+    printf("Testing TX ring drop policy...\n");
+    
+    setup_test_message_bus();
+    reset_mock_serials();
+    
+    SerialBridge bridge;
+    serial_port_config_t config = {true, 115200, true, true};
+    assert(bridge.init(&Serial, config));
+    Serial.set_write_limit(0);
+    assert(bridge.has_tx_room(MSG_DEBUG_MESSAGE));
+    
+    // Debug traffic (background) may use half the ring
+    const uint16_t frame = 2 + sizeof(CANFrame);
+    const uint16_t background_fit = 1024 / frame;
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+    for (uint16_t i = 0; i < background_fit + 5; i++) {
+        bridge.send_message(create_test_message(MSG_DEBUG_MESSAGE, 4, data));
+    }
+    assert(bridge.get_messages_sent() == background_fit);
+    assert(bridge.get_tx_drops(MSG_PRIORITY_BACKGROUND) == 5);
+    assert(bridge.get_tx_pending() == background_fit * frame);
+    assert(!bridge.has_tx_room(MSG_DEBUG_MESSAGE));
+    assert(bridge.has_tx_room(MSG_ENGINE_RPM));
+    
+    // Sensor traffic (critical) still has the other half
+    const uint16_t total_fit = 2048 / frame;
+    for (uint16_t i = 0; i < total_fit; i++) {
+        bridge.send_message(create_test_message(MSG_ENGINE_RPM, 4, data));
+    }
+    assert(bridge.get_messages_sent() == total_fit);
+    assert(bridge.get_tx_drops(MSG_PRIORITY_CRITICAL) == background_fit);
+    assert(bridge.get_tx_drops_total() == background_fit + 5);
+    assert(bridge.get_written_data_for_testing().empty());
+    assert(bridge.get_tx_peak() == total_fit * frame);
+    
+    // The port frees 100 bytes: exactly that much goes out per update
+    Serial.set_write_limit(100);
+    bridge.update();
+    assert(bridge.get_written_data_for_testing().size() == 100);
+    assert(bridge.get_tx_pending() == total_fit * frame - 100);
+    
+    // Room again: the rest follows in order, across the ring wrap
+    Serial.set_write_limit(-1);
+    bridge.update();
+    std::vector<uint8_t> written = bridge.get_written_data_for_testing();
+    assert(written.size() == total_fit * frame);
+    assert(bridge.get_tx_pending() == 0);
+    for (uint16_t i = 0; i < total_fit; i++) {
+        assert(written[i * frame] == 0xFF && written[i * frame + 1] == 0xFF);
+        CANMessage msg;
+        memcpy(&msg, &written[i * frame + 2], sizeof(CANFrame));
+        assert(msg.id == (i < background_fit ? MSG_DEBUG_MESSAGE : MSG_ENGINE_RPM));
+    }
+    
+    // Wrapped writes still land whole
+    for (uint16_t i = 0; i < 10; i++) {
+        bridge.send_message(create_test_message(MSG_ENGINE_RPM, 4, data));
+    }
+    assert(bridge.get_written_data_for_testing().size() == (total_fit + 10) * frame);
+    assert(bridge.get_tx_overflows() == 0);
+    
+    printf("✓ TX ring drop policy tests passed\n");
+}
+
+// Test bursts: many frames per update, frames split across reads, and a
+// legacy hello from a restarted host while the link is framed
+void test_bulk_receive() {
+    printf("Testing bulk receive...\n");
+    
+    setup_test_message_bus();
+    reset_mock_serials();
+    
+    SerialBridge bridge;
+    assert(bridge.init(&Serial, DEFAULT_EXTERNAL_SERIAL_CONFIG.usb));
+    
+    // 30 legacy frames with text between them, all in one update
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+    for (int i = 0; i < 30; i++) {
+        feed_legacy(Serial, create_test_message(0x10500001 + i, 4, data));
+        Serial.add_data_to_read((const uint8_t*)"ok\n", 3);
+    }
+    bridge.update();
+    assert(bridge.get_messages_received() == 30);
+    g_message_bus.process();
+    
+    // A frame split across two updates, cut inside the prefix
+    CANMessage split = create_test_message(0x10500001, 4, data);
+    Serial.add_byte_to_read(0xFF);
+    bridge.update();
+    Serial.add_byte_to_read(0xFF);
+    Serial.add_data_to_read((const uint8_t*)&split, 10);
+    bridge.update();
+    assert(bridge.get_messages_received() == 30);
+    Serial.add_data_to_read((const uint8_t*)&split + 10, sizeof(CANFrame) - 10);
+    bridge.update();
+    assert(bridge.get_messages_received() == 31);
+    
+    // Hello and the first v2 frames back to back in the same read
+    feed_legacy(Serial, create_link_hello(SERIAL_LINK_VERSION_FRAMED, 256));
+    std::vector<CANMessage> batch;
+    for (int i = 0; i < 12; i++) {
+        batch.push_back(create_test_message(0x10500001 + i, 4, data));
+    }
+    for (uint8_t seq = 0; seq < 5; seq++) {
+        std::vector<uint8_t> frame = build_link_frame(seq, batch);
+        Serial.add_data_to_read(frame.data(), frame.size());
+    }
+    bridge.update();
+    assert(bridge.get_link_version() == SERIAL_LINK_VERSION_FRAMED);
+    assert(bridge.get_messages_received() == 31 + 60);
+    assert(bridge.get_crc_errors() == 0);
+    g_message_bus.process();
+    
+    // v2 frame split mid-way
+    std::vector<uint8_t> frame = build_link_frame(5, batch);
+    Serial.add_data_to_read(frame.data(), 20);
+    bridge.update();
+    assert(bridge.get_messages_received() == 91);
+    Serial.add_data_to_read(frame.data() + 20, frame.size() - 20);
+    bridge.update();
+    assert(bridge.get_messages_received() == 103);
+    g_message_bus.process();
+    
+    // Restarted host: half a v2 frame, then a legacy hello asking for v1
+    Serial.add_data_to_read(frame.data(), 30);
+    feed_legacy(Serial, create_link_hello(SERIAL_LINK_VERSION_LEGACY, 0));
+    feed_legacy(Serial, create_test_message(0x10500001, 4, data));
+    bridge.update();
+    assert(bridge.get_link_version() == SERIAL_LINK_VERSION_LEGACY);
+    assert(bridge.get_messages_received() == 104);
+    
+    printf("✓ Bulk receive tests passed\n");
+}
+
+// Test per-port filters: groups, exact IDs, rate caps, and unfiltered ports
+void test_port_filters() {
+    printf("Testing per-port filters...\n");
+    
+    setup_test_message_bus();
+    reset_mock_serials();
+    mock_set_micros(1000000);
+    
+    ExternalSerial ext_serial;
+    external_serial_config_t config = DEFAULT_EXTERNAL_SERIAL_CONFIG;
+    config.serial1.enabled = true;
+    config.serial2.enabled = true;
+    assert(ext_serial.init(config));
+    SerialBridge& usb = ext_serial.get_usb_bridge();
+    SerialBridge& dash = ext_serial.get_serial1_bridge();
+    SerialBridge& logger = ext_serial.get_serial2_bridge();
+    
+    // Dashboard: all primary sensors. Logger: RPM capped at 10 Hz, plus coolant
+    assert(dash.filter_add_group(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS));
+    assert(!dash.filter_add_group(ECU_BASE_PRIMARY, 0x00000123));    // Not a subsystem
+    assert(logger.filter_add_id(MSG_ENGINE_RPM, 10));
+    assert(logger.filter_add_id(MSG_COOLANT_TEMP));
+    assert(!usb.filter_active() && dash.filter_active());
+    
+    float value = 1.0f;
+    CANMessage rpm = create_test_message(MSG_ENGINE_RPM, 4, (const uint8_t*)&value);
+    CANMessage coolant = create_test_message(MSG_COOLANT_TEMP, 4, (const uint8_t*)&value);
+    CANMessage fuel = create_test_message(MSG_FUEL_PULSE_WIDTH, 4, (const uint8_t*)&value);
+    
+    // RPM every 20 ms for 200 ms: the cap lets through one per 100 ms
+    for (int i = 0; i < 10; i++) {
+        ext_serial.broadcast_to_enabled_ports(rpm);
+        mock_advance_time_us(20000);
+    }
+    ext_serial.broadcast_to_enabled_ports(coolant);
+    ext_serial.broadcast_to_enabled_ports(fuel);
+    
+    assert(usb.get_messages_sent() == 12);
+    assert(dash.get_messages_sent() == 11);         // Sensors only
+    assert(dash.get_filtered_messages() == 1);
+    assert(logger.get_messages_sent() == 2 + 1);    // RPM at 0 and 100 ms, coolant
+    assert(logger.get_rate_limited_messages() == 8);
+    assert(logger.get_filtered_messages() == 1);
+    
+    // Re-adding an ID updates its cap; clearing opens the port again
+    assert(logger.filter_add_id(MSG_ENGINE_RPM, 0));
+    ext_serial.broadcast_to_enabled_ports(rpm);
+    ext_serial.broadcast_to_enabled_ports(rpm);
+    assert(logger.get_messages_sent() == 5);
+    logger.filter_clear();
+    ext_serial.broadcast_to_enabled_ports(fuel);
+    assert(logger.get_messages_sent() == 6);
+    
+    // The table takes SERIAL_FILTER_MAX_IDS and no more
+    for (uint32_t i = 0; i < SERIAL_FILTER_MAX_IDS; i++) {
+        assert(logger.filter_add_id(MSG_FUEL_MAP_CELL(1, i)));
+    }
+    assert(!logger.filter_add_id(MSG_FUEL_MAP_CELL(2, 0)));
+    assert(logger.wants_message(MSG_FUEL_MAP_CELL(1, SERIAL_FILTER_MAX_IDS - 1)));
+    assert(!logger.wants_message(MSG_FUEL_MAP_CELL(2, 0)));
+    
+    printf("✓ Per-port filter tests passed\n");
+}
+
+// Host-side decode of every v2 frame written so far: (id, ctl, payload) per record
+struct LinkRecord {
+    uint32_t id;
+    uint8_t ctl;
+    std::vector<uint8_t> data;
+};
+
+std::vector<LinkRecord> decode_link_records(const std::vector<uint8_t>& written) {
+    std::vector<LinkRecord> records;
+    std::vector<uint8_t> frame;
+    for (uint8_t byte : written) {
+        if (byte != 0x00) {
+            frame.push_back(byte);
+            continue;
+        }
+        size_t length = serial_link_cobs_decode(frame.data(), frame.size());
+        assert(length >= 3);
+        uint16_t crc = frame[length - 2] | (frame[length - 1] << 8);
+        assert(crc == serial_link_crc16(frame.data(), length - 2));
+        for (size_t pos = 1; pos < length - 2; ) {
+            LinkRecord record;
+            record.id = frame[pos] | (frame[pos + 1] << 8) | (frame[pos + 2] << 16) | ((uint32_t)frame[pos + 3] << 24);
+            record.ctl = frame[pos + 4];
+            size_t data_pos = pos + SERIAL_LINK_RECORD_HEADER;
+            size_t len = record.ctl & SERIAL_LINK_CTL_LEN_MASK;
+            if (record.ctl & SERIAL_LINK_CTL_BLOCK) {
+                len = frame[data_pos++];
+            }
+            record.data.assign(&frame[data_pos], &frame[data_pos] + len);
+            records.push_back(record);
+            pos = data_pos + len;
+        }
+        frame.clear();
+    }
+    return records;
+}
+
+CANMessage create_telemetry_config(uint8_t op, uint8_t index, uint32_t msg_id, int8_t step_exp) {
+    serial_telemetry_config_msg_t request = {};
+    request.op = op;
+    request.index = index;
+    request.msg_id = msg_id;
+    request.step_exp = step_exp;
+    CANMessage msg = create_test_message(MSG_SERIAL_TELEMETRY_CONFIG, sizeof(request), (const uint8_t*)&request);
+    msg.flags.extended = true;
+    return msg;
+}
+
+// Decode one telemetry block into index -> value (absolute or delta)
+std::map<uint8_t, int32_t> decode_telemetry_block(const std::vector<uint8_t>& block) {
+    std::map<uint8_t, int32_t> values;
+    for (size_t pos = 2; pos < block.size(); ) {
+        uint8_t index = block[pos++];
+        uint32_t zz = 0;
+        for (uint8_t shift = 0; ; shift += 7) {
+            uint8_t byte = block[pos++];
+            zz |= (uint32_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+        }
+        values[index] = (int32_t)(zz >> 1) ^ -(int32_t)(zz & 1);
+    }
+    return values;
+}
+
+// Test channel registration, keyframes, deltas and the legacy refusal
+void test_telemetry_mode() {
+    printf("Testing telemetry mode...\n");
+    
+    setup_test_message_bus();
+    reset_mock_serials();
+    mock_set_micros(1000);
+    
+    SerialBridge bridge;
+    serial_port_config_t config = DEFAULT_EXTERNAL_SERIAL_CONFIG.usb;
+    assert(bridge.init(&Serial, config));
+    
+    // Legacy link: refused
+    feed_legacy(Serial, create_telemetry_config(TELEMETRY_OP_ADD, 0, MSG_ENGINE_RPM, 0));
+    bridge.update();
+    std::vector<uint8_t> written = bridge.get_written_data_for_testing();
+    assert(written.size() == 2 + sizeof(CANFrame));
+    CANMessage reply;
+    memcpy(&reply, &written[2], sizeof(CANFrame));
+    assert(reply.id == MSG_SERIAL_TELEMETRY_ACK);
+    assert(reply.buf[2] == TELEMETRY_STATUS_NOT_FRAMED);
+    assert(bridge.get_telemetry_channel_count() == 0);
+    
+    feed_legacy(Serial, create_link_hello(SERIAL_LINK_VERSION_FRAMED, 256));
+    bridge.update();
+    Serial.clear_written_data();
+    
+    // RPM in whole rpm, coolant in 0.1 °C, TPS in 0.01 %; index 5 skips ahead
+    std::vector<uint8_t> setup = build_link_frame(0, {
+        create_telemetry_config(TELEMETRY_OP_ADD, 0, MSG_ENGINE_RPM, 0),
+        create_telemetry_config(TELEMETRY_OP_ADD, 1, MSG_COOLANT_TEMP, -1),
+        create_telemetry_config(TELEMETRY_OP_ADD, 2, MSG_THROTTLE_POSITION, -2),
+        create_telemetry_config(TELEMETRY_OP_ADD, 5, MSG_MANIFOLD_PRESSURE, 0),
+        create_telemetry_config(TELEMETRY_OP_ADD, 3, MSG_ENGINE_RPM, 0),
+        create_telemetry_config(TELEMETRY_OP_START, 4, 100, 0),
+    });
+    Serial.add_data_to_read(setup.data(), setup.size());
+    bridge.update();
+    assert(bridge.get_telemetry_channel_count() == 3);
+    assert(bridge.is_telemetry_active());
+    std::vector<LinkRecord> records = decode_link_records(bridge.get_written_data_for_testing());
+    const uint8_t expected_status[] = {
+        TELEMETRY_STATUS_OK, TELEMETRY_STATUS_OK, TELEMETRY_STATUS_OK,
+        TELEMETRY_STATUS_BAD_INDEX, TELEMETRY_STATUS_INVALID, TELEMETRY_STATUS_OK
+    };
+    assert(records.size() == 6);
+    for (size_t i = 0; i < records.size(); i++) {
+        assert(records[i].id == MSG_SERIAL_TELEMETRY_ACK);
+        assert(records[i].data[2] == expected_status[i]);
+    }
+    Serial.clear_written_data();
+    
+    // Channel broadcasts are absorbed; anything else still goes as a record
+    auto send_float = [&](uint32_t id, float value) {
+        bridge.send_message(create_test_message(id, 4, (const uint8_t*)&value));
+    };
+    send_float(MSG_ENGINE_RPM, 3000.4f);
+    send_float(MSG_COOLANT_TEMP, 85.26f);
+    send_float(MSG_THROTTLE_POSITION, 12.5f);
+    send_float(MSG_MANIFOLD_PRESSURE, 95.0f);
+    assert(bridge.get_messages_sent() == 1);
+    
+    // First tick (10 ms) is a keyframe with absolute values
+    mock_advance_time_us(10000);
+    bridge.update();
+    assert(bridge.get_telemetry_ticks() == 1);
+    records = decode_link_records(bridge.get_written_data_for_testing());
+    assert(records.size() == 2);
+    assert(records[0].id == MSG_MANIFOLD_PRESSURE);
+    assert(records[1].id == MSG_SERIAL_TELEMETRY_FRAME);
+    assert(records[1].ctl & SERIAL_LINK_CTL_BLOCK);
+    assert(records[1].data[0] == SERIAL_TELEMETRY_KEYFRAME);
+    assert(records[1].data[1] == 0);
+    std::map<uint8_t, int32_t> values = decode_telemetry_block(records[1].data);
+    assert(values.size() == 3);
+    assert(values[0] == 3000 && values[1] == 853 && values[2] == 1250);
+    Serial.clear_written_data();
+    
+    // Only coolant moves: a delta block with one small entry
+    send_float(MSG_ENGINE_RPM, 3000.2f);
+    send_float(MSG_COOLANT_TEMP, 85.1f);
+    mock_advance_time_us(10000);
+    bridge.update();
+    records = decode_link_records(bridge.get_written_data_for_testing());
+    assert(records.size() == 1);
+    assert(records[0].data[0] == SERIAL_TELEMETRY_DELTA);
+    assert(records[0].data[1] == 1);
+    values = decode_telemetry_block(records[0].data);
+    assert(values.size() == 1 && values[1] == -2);
+    assert(records[0].data.size() == 4);    // vs 3 plain records of 11 bytes
+    Serial.clear_written_data();
+    
+    // Nothing moved: no block at all
+    for (int i = 0; i < 2; i++) {
+        mock_advance_time_us(10000);
+        bridge.update();
+    }
+    assert(bridge.get_written_data_for_testing().empty());
+    
+    // Fifth tick is a keyframe again (START asked for one every 4 ticks)
+    mock_advance_time_us(10000);
+    bridge.update();
+    records = decode_link_records(bridge.get_written_data_for_testing());
+    assert(records.size() == 1);
+    assert(records[0].data[0] == SERIAL_TELEMETRY_KEYFRAME);
+    values = decode_telemetry_block(records[0].data);
+    assert(values[1] == 851);
+    Serial.clear_written_data();
+    
+    // STOP: channel IDs go back to plain records
+    std::vector<uint8_t> stop = build_link_frame(1, {create_telemetry_config(TELEMETRY_OP_STOP, 0, 0, 0)});
+    Serial.add_data_to_read(stop.data(), stop.size());
+    bridge.update();
+    assert(!bridge.is_telemetry_active());
+    uint32_t sent = bridge.get_messages_sent();
+    send_float(MSG_ENGINE_RPM, 3100.0f);
+    assert(bridge.get_messages_sent() == sent + 1);
+    
+    // A new hello starts with an empty table
+    feed_legacy(Serial, create_link_hello(SERIAL_LINK_VERSION_FRAMED, 256));
+    bridge.update();
+    assert(bridge.get_telemetry_channel_count() == 0);
+    
+    printf("✓ Telemetry mode tests passed\n");
+}
+
 // Run all tests
 int main() {
     printf("Running External Serial Tests (0xFF 0xFF Prefix)...\n");
@@ -510,6 +1159,14 @@ int main() {
     test_message_bus_integration_with_prefix();
     test_statistics();
     test_tx_rx_enable_disable();
+    test_link_framing_helpers();
+    test_link_negotiation_and_batching();
+    test_link_receive_and_resync();
+    test_link_fallback();
+    test_tx_ring_drop_policy();
+    test_bulk_receive();
+    test_port_filters();
+    test_telemetry_mode();
     
     printf("\n==================================================\n");
     printf("All External Serial Tests Passed! ✓\n");
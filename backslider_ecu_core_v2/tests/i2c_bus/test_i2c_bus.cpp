@@ -0,0 +1,267 @@
+// tests/i2c_bus/test_i2c_bus.cpp
+// Test suite for the queued I2C transaction layer and its ADS1015 user
+
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+// Include enhanced mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../i2c_bus.h"
+#include "../../ads1015_driver.h"
+
+// Simple test framework
+int tests_run = 0;
+int tests_passed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        std::cout << "  Running test: " #name "... "; \
+        tests_run++; \
+        test_##name(); \
+        tests_passed++; \
+        std::cout << "PASSED" << std::endl; \
+    } \
+    void test_##name()
+
+// Register file device at 0x50: first written byte is the pointer, the rest
+// are stored from there; reads return consecutive registers
+static const uint8_t DEVICE = 0x50;
+static uint8_t registers[16];
+static uint8_t pointer = 0;
+
+static bool register_device(uint8_t address, const uint8_t* write_data, uint8_t write_length,
+                            uint8_t* read_data, uint8_t read_length) {
+    (void)address;
+    if (write_length >= 1) {
+        pointer = write_data[0] & 0x0F;
+    }
+    for (uint8_t i = 1; i < write_length; i++) {
+        registers[(pointer + i - 1) & 0x0F] = write_data[i];
+    }
+    for (uint8_t i = 0; i < read_length; i++) {
+        read_data[i] = registers[(pointer + i) & 0x0F];
+    }
+    return true;
+}
+
+struct completion_t {
+    i2c_result_t result;
+    std::vector<uint8_t> data;
+    intptr_t tag;
+    uint32_t at_us;
+};
+
+static std::vector<completion_t> completions;
+
+static void record_completion(i2c_result_t result, const uint8_t* read_data, uint8_t read_length, void* context) {
+    completion_t c;
+    c.result = result;
+    c.data.assign(read_data, read_data + read_length);
+    c.tag = (intptr_t)context;
+    c.at_us = micros();
+    completions.push_back(c);
+}
+
+static void setup(void) {
+    mock_reset_all();
+    i2c_bus_init();
+    i2c_bus_attach_mock_device(I2C_BUS_PRIMARY, DEVICE, register_device);
+    for (uint8_t i = 0; i < sizeof(registers); i++) {
+        registers[i] = (uint8_t)(0xA0 + i);
+    }
+    completions.clear();
+}
+
+// Costs that make the arithmetic easy to check
+static mock_cost_model_t round_costs(void) {
+    mock_cost_model_t costs = MOCK_DEFAULT_COSTS;
+    costs.i2c_byte_ns = 1000;
+    costs.i2c_transaction_ns = 2000;
+    costs.clock_read_ns = 0;
+    return costs;
+}
+
+// Test that without the virtual clock a transaction finishes inside submit
+TEST(completes_at_once_without_clock) {
+    setup();
+    uint8_t write[3] = {0x02, 0x11, 0x22};
+    assert(i2c_bus_submit(I2C_BUS_PRIMARY, DEVICE, write, 3, 0, record_completion, (void*)1));
+    assert(completions.size() == 1);
+    assert(registers[2] == 0x11 && registers[3] == 0x22);
+
+    uint8_t reg = 0x02;
+    assert(i2c_bus_submit(I2C_BUS_PRIMARY, DEVICE, &reg, 1, 3, record_completion, (void*)2));
+    assert(completions.size() == 2);
+    assert(completions[1].result == I2C_RESULT_OK);
+    assert((completions[1].data == std::vector<uint8_t>{0x11, 0x22, 0xA4}));
+    assert(i2c_bus_pending(I2C_BUS_PRIMARY) == 0);
+    assert(i2c_bus_get_stats(I2C_BUS_PRIMARY)->completed == 2);
+}
+
+// Test NACKs and rejected submits
+TEST(nack_and_invalid_submits) {
+    setup();
+    uint8_t reg = 0;
+    assert(i2c_bus_submit(I2C_BUS_PRIMARY, 0x51, &reg, 1, 1, record_completion, nullptr));
+    assert(completions.size() == 1 && completions[0].result == I2C_RESULT_NACK);
+    assert(i2c_bus_get_stats(I2C_BUS_PRIMARY)->errors == 1);
+
+    uint8_t long_write[I2C_BUS_MAX_WRITE + 1] = {0};
+    assert(!i2c_bus_submit(I2C_BUS_PRIMARY, DEVICE, long_write, sizeof(long_write), 0, nullptr, nullptr));
+    assert(!i2c_bus_submit(I2C_BUS_PRIMARY, DEVICE, &reg, 1, I2C_BUS_MAX_READ + 1, nullptr, nullptr));
+    assert(!i2c_bus_submit(I2C_BUS_COUNT, DEVICE, &reg, 1, 1, nullptr, nullptr));
+    assert(i2c_bus_get_stats(I2C_BUS_COUNT) == nullptr);
+}
+
+// Test that with the clock on transactions run back to back in submit order
+// and callbacks wait for i2c_bus_service()
+TEST(queued_transactions_finish_after_wire_time) {
+    setup();
+    mock_cost_model_t costs = round_costs();
+    mock_virtual_clock_enable(&costs);
+
+    uint8_t reg = 0x04;
+    for (intptr_t tag = 1; tag <= 3; tag++) {
+        // Address + pointer, address + 2 bytes: 5 bytes, 7 us each
+        assert(i2c_bus_submit(I2C_BUS_PRIMARY, DEVICE, &reg, 1, 2, record_completion, (void*)tag));
+    }
+    assert(micros() == 0);                  // Submitting costs no wire time
+    assert(i2c_bus_pending(I2C_BUS_PRIMARY) == 3);
+
+    mock_advance_time_us(6);
+    i2c_bus_service();
+    assert(completions.empty());
+
+    mock_advance_time_us(1);
+    i2c_bus_service();
+    assert(completions.size() == 1 && completions[0].tag == 1);
+    assert((completions[0].data == std::vector<uint8_t>{0xA4, 0xA5}));
+
+    mock_advance_time_us(14);
+    i2c_bus_service();
+    assert(completions.size() == 3);
+    assert(completions[1].tag == 2 && completions[2].tag == 3);
+    assert(i2c_bus_pending(I2C_BUS_PRIMARY) == 0);
+}
+
+// Test that the queue refuses work beyond its depth and frees slots on delivery
+TEST(queue_full) {
+    setup();
+    mock_cost_model_t costs = round_costs();
+    mock_virtual_clock_enable(&costs);
+
+    uint8_t reg = 0;
+    for (int i = 0; i < I2C_BUS_QUEUE_DEPTH; i++) {
+        assert(i2c_bus_submit(I2C_BUS_PRIMARY, DEVICE, &reg, 1, 0, nullptr, nullptr));
+    }
+    assert(!i2c_bus_submit(I2C_BUS_PRIMARY, DEVICE, &reg, 1, 0, nullptr, nullptr));
+    assert(i2c_bus_get_stats(I2C_BUS_PRIMARY)->queue_full == 1);
+
+    // Finished but undelivered transactions still hold their slots
+    mock_advance_time_us(100);
+    assert(!i2c_bus_submit(I2C_BUS_PRIMARY, DEVICE, &reg, 1, 0, nullptr, nullptr));
+    i2c_bus_service();
+    assert(i2c_bus_submit(I2C_BUS_PRIMARY, DEVICE, &reg, 1, 0, nullptr, nullptr));
+}
+
+// Test that a claim waits for the running transaction and holds the queue
+TEST(claim_holds_the_bus) {
+    setup();
+    mock_cost_model_t costs = round_costs();
+    mock_virtual_clock_enable(&costs);
+
+    uint8_t write[2] = {0x00, 0x55};        // Address + 2 bytes: 5 us
+    assert(i2c_bus_submit(I2C_BUS_PRIMARY, DEVICE, write, 2, 0, record_completion, (void*)1));
+    assert(i2c_bus_claim(I2C_BUS_PRIMARY, 1000));
+    assert(micros() >= 5);
+    assert(registers[0] == 0x55);
+
+    // Queued while claimed: does not start
+    write[1] = 0x66;
+    assert(i2c_bus_submit(I2C_BUS_PRIMARY, DEVICE, write, 2, 0, record_completion, (void*)2));
+    mock_advance_time_us(100);
+    i2c_bus_service();
+    assert(completions.size() == 1);
+    assert(registers[0] == 0x55);
+
+    i2c_bus_release(I2C_BUS_PRIMARY);
+    mock_advance_time_us(5);
+    i2c_bus_service();
+    assert(completions.size() == 2 && completions[1].tag == 2);
+    assert(registers[0] == 0x66);
+}
+
+// Test that a transaction that never finishes is abandoned
+TEST(stuck_transaction_times_out) {
+    setup();
+    mock_cost_model_t costs = round_costs();
+    mock_virtual_clock_enable(&costs);
+
+    uint8_t reg = 0;
+    assert(i2c_bus_submit(I2C_BUS_PRIMARY, DEVICE, &reg, 1, 1, record_completion, (void*)1));
+    assert(i2c_bus_submit(I2C_BUS_PRIMARY, DEVICE, &reg, 1, 1, record_completion, (void*)2));
+    mock_set_micros(I2C_BUS_TIMEOUT_US);    // Time passes without the completion firing
+    i2c_bus_service();
+    assert(completions.size() == 1);
+    assert(completions[0].result == I2C_RESULT_TIMEOUT);
+    assert(i2c_bus_get_stats(I2C_BUS_PRIMARY)->timeouts == 1);
+
+    // The next one was started in its place
+    mock_advance_time_us(10);
+    i2c_bus_service();
+    assert(completions.size() == 2 && completions[1].result == I2C_RESULT_OK);
+}
+
+// Test the ADS1015 driver over the queued bus: service() only queues, so
+// a conversion cycle costs the loop almost nothing
+TEST(ads1015_steps_complete_in_callbacks) {
+    setup();
+    mock_cost_model_t costs = round_costs();
+    mock_virtual_clock_enable(&costs);
+    ads1015_driver_init();
+    ads1015_driver_begin(0x48, ADS1015_DRIVER_NO_READY_PIN);
+    assert(ads1015_driver_enable_channel(1));
+    mock_set_ads1015_reading(1, 12345);
+
+    int16_t value = 0;
+    uint32_t loop_us = 0;
+    for (int pass = 0; pass < 100 && !ads1015_driver_get(1, &value); pass++) {
+        uint32_t start_us = micros();
+        i2c_bus_service();
+        ads1015_driver_service();
+        loop_us += micros() - start_us;
+        mock_advance_time_us(20);
+    }
+    assert(ads1015_driver_get(1, &value) && value == (12345 & 0xFFF0));
+    assert(ads1015_driver_get_error_count() == 0);
+    assert(loop_us == 0);                   // Wire time is never charged to the loop
+    assert(i2c_bus_get_stats(I2C_BUS_PRIMARY)->completed == 3);     // Config, pointer, read
+}
+
+// Main test runner
+int main() {
+    std::cout << "=== I2C Bus Tests ===" << std::endl;
+
+    run_test_completes_at_once_without_clock();
+    run_test_nack_and_invalid_submits();
+    run_test_queued_transactions_finish_after_wire_time();
+    run_test_queue_full();
+    run_test_claim_holds_the_bus();
+    run_test_stuck_transaction_times_out();
+    run_test_ads1015_steps_complete_in_callbacks();
+
+    std::cout << std::endl;
+    std::cout << "I2C Bus Tests - Run: " << tests_run << ", Passed: " << tests_passed << std::endl;
+
+    if (tests_passed == tests_run) {
+        std::cout << "✅ ALL I2C BUS TESTS PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME TESTS FAILED!" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,177 @@
+// tests/ignition_scheduler/test_ignition_scheduler.cpp
+// Test suite for the angle-to-time ignition scheduler
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+// Include enhanced mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../trigger_decoder.h"
+#include "../../ignition_scheduler.h"
+
+// Simple test framework
+int tests_run = 0;
+int tests_passed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        std::cout << "  Running test: " #name "... "; \
+        tests_run++; \
+        test_##name(); \
+        tests_passed++; \
+        std::cout << "PASSED" << std::endl; \
+    } \
+    void test_##name()
+
+#define COIL_PIN 36
+
+static uint32_t sim_time_us = 0;
+static std::vector<uint32_t> coil_on_times;
+static std::vector<uint32_t> coil_off_times;
+
+// Run every event due up to time_us as the compare timer would, logging coil edges
+static void run_compare_until(uint32_t time_us) {
+    uint32_t next_us;
+    while (ignition_scheduler_next_event_us(&next_us) && (int32_t)(next_us - time_us) <= 0) {
+        int before = digitalRead(COIL_PIN);
+        mock_set_micros(next_us);
+        ignition_scheduler_service(next_us);
+        int after = digitalRead(COIL_PIN);
+        if (before == LOW && after == HIGH) coil_on_times.push_back(next_us);
+        if (before == HIGH && after == LOW) coil_off_times.push_back(next_us);
+    }
+}
+
+// One 36-1 revolution at a fixed tooth period; returns the time of position 0
+static uint32_t run_revolution(uint32_t period_us) {
+    uint32_t tooth0_us = 0;
+    for (uint8_t i = 0; i < 35; i++) {
+        sim_time_us += (i == 0) ? period_us * 2 : period_us;
+        run_compare_until(sim_time_us);
+        mock_set_micros(sim_time_us);
+        trigger_decoder_crank_edge(sim_time_us);
+        if (i == 0) tooth0_us = sim_time_us;
+    }
+    return tooth0_us;
+}
+
+// Decoder with a 36-1 wheel and a single cylinder at TDC 0, coil on COIL_PIN
+static void setup_engine(uint32_t dwell_us, float advance_deg) {
+    mock_reset_all();
+    g_message_bus.init();
+    g_message_bus.resetSubscribers();
+    trigger_decoder_init();
+    trigger_wheel_config_t wheel = {};
+    wheel.tooth_count = 36;
+    wheel.missing_teeth = 1;
+    wheel.stall_timeout_us = 100000;
+    assert(trigger_decoder_configure(&wheel));
+    trigger_decoder_begin(2, TRIGGER_NO_PIN);
+
+    ignition_scheduler_init();
+    ignition_layout_t ign = {};
+    ign.cylinder_count = 1;
+    ign.coil_pins[0] = COIL_PIN;
+    ign.tdc_angle_deg[0] = 0.0f;
+    assert(ignition_scheduler_configure(&ign));
+    ignition_scheduler_begin();
+    ignition_scheduler_set_dwell_us(dwell_us);
+    ignition_scheduler_set_advance(advance_deg);
+    ignition_scheduler_enable(true);
+
+    sim_time_us = 1000;
+    coil_on_times.clear();
+    coil_off_times.clear();
+}
+
+// Test dwell and spark land on the predicted times, including inside the gap
+TEST(dwell_and_spark_timing) {
+    setup_engine(2000, 10.0f);
+
+    // 500 µs per tooth = 50 µs per degree
+    run_revolution(500);
+    run_revolution(500);
+    coil_on_times.clear();
+    coil_off_times.clear();
+    uint32_t t0 = run_revolution(500);
+    run_revolution(500);
+
+    // Spark at 350° (in the missing-tooth gap), dwell from 310°. The first
+    // logged spark closes the dwell started before the log was cleared.
+    assert(coil_off_times.size() >= 2 && coil_on_times.size() >= 1);
+    assert(coil_off_times[0] == t0 - 10 * 50);
+    assert(coil_off_times[1] == t0 + 350 * 50);
+    assert(coil_on_times[0] == t0 + 350 * 50 - 2000);
+    assert(ignition_scheduler_get_late_count() == 0);
+    assert(ignition_scheduler_get_overrun_count() == 0);
+    assert(ignition_scheduler_get_spark_count() == 2);   // Revolutions 2 and 3; 1 had no sync
+}
+
+// Test advance changes from the bus move the spark; events follow a new RPM
+TEST(bus_advance_and_rpm_change) {
+    setup_engine(2000, 10.0f);
+    run_revolution(500);
+    run_revolution(500);
+
+    float advance = 30.0f;
+    g_message_bus.publish(MSG_IGNITION_TIMING, (uint8_t*)&advance, sizeof(advance));
+    g_message_bus.process();
+
+    // Faster engine: 400 µs per tooth = 40 µs per degree, spark at 330°
+    run_revolution(400);
+    coil_on_times.clear();
+    coil_off_times.clear();
+    uint32_t t0 = run_revolution(400);
+    run_revolution(400);
+    assert(coil_off_times.size() >= 2 && coil_on_times.size() >= 1);
+    assert(coil_off_times[1] == t0 + 330 * 40);
+    assert(coil_on_times[0] == t0 + 330 * 40 - 2000);
+}
+
+// Test over-long dwell is clipped and counted; a stall switches the coil off
+TEST(overrun_and_stall) {
+    setup_engine(18000, 10.0f);     // Longer than the 18 ms revolution
+    run_revolution(500);
+    run_revolution(500);
+    run_revolution(500);
+    assert(ignition_scheduler_get_overrun_count() > 0);
+
+    // Stop in the middle of a dwell: the stall drops sync and the coil
+    assert(digitalRead(COIL_PIN) == HIGH);
+    mock_set_micros(sim_time_us + 200000);
+    trigger_decoder_update();
+    assert(digitalRead(COIL_PIN) == LOW);
+    uint32_t next_us;
+    assert(!ignition_scheduler_next_event_us(&next_us));
+
+    // Disabled scheduler queues nothing
+    ignition_scheduler_enable(false);
+    run_revolution(500);
+    run_revolution(500);
+    assert(!ignition_scheduler_next_event_us(&next_us));
+}
+
+int main() {
+    std::cout << "=== Ignition Scheduler Tests ===" << std::endl;
+
+    run_test_dwell_and_spark_timing();
+    run_test_bus_advance_and_rpm_change();
+    run_test_overrun_and_stall();
+
+    std::cout << std::endl;
+    std::cout << "Ignition Scheduler Tests - Run: " << tests_run << ", Passed: " << tests_passed << std::endl;
+
+    if (tests_passed == tests_run) {
+        std::cout << "✅ ALL IGNITION SCHEDULER TESTS PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME IGNITION SCHEDULER TESTS FAILED!" << std::endl;
+        return 1;
+    }
+}
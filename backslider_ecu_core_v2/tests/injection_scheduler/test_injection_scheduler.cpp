@@ -0,0 +1,241 @@
+// tests/injection_scheduler/test_injection_scheduler.cpp
+// Test suite for the angle-timed injection scheduler
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+// Include enhanced mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../trigger_decoder.h"
+#include "../../injection_scheduler.h"
+
+// Simple test framework
+int tests_run = 0;
+int tests_passed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        std::cout << "  Running test: " #name "... "; \
+        tests_run++; \
+        test_##name(); \
+        tests_passed++; \
+        std::cout << "PASSED" << std::endl; \
+    } \
+    void test_##name()
+
+#define INJ_PIN_1 28
+#define INJ_PIN_2 29
+
+static uint32_t sim_time_us = 0;
+static std::vector<uint32_t> open_times[2];
+static std::vector<uint32_t> close_times[2];
+
+// Pulse width sent over the bus after a given tooth of the next revolution
+static int pw_change_tooth = -1;
+static float pw_change_ms = 0.0f;
+
+static bool has_time(const std::vector<uint32_t>& times, uint32_t t) {
+    for (size_t i = 0; i < times.size(); i++) {
+        if (times[i] == t) return true;
+    }
+    return false;
+}
+
+static void send_pulse_width(float pw_ms) {
+    g_message_bus.publish(MSG_FUEL_PULSE_WIDTH, (uint8_t*)&pw_ms, sizeof(pw_ms));
+    g_message_bus.process();
+}
+
+// Run every event due up to time_us as the compare timer would, logging injector edges
+static void run_compare_until(uint32_t time_us) {
+    const uint8_t pins[2] = {INJ_PIN_1, INJ_PIN_2};
+    uint32_t next_us;
+    while (injection_scheduler_next_event_us(&next_us) && (int32_t)(next_us - time_us) <= 0) {
+        int before[2] = {digitalRead(pins[0]), digitalRead(pins[1])};
+        mock_set_micros(next_us);
+        injection_scheduler_service(next_us);
+        for (int c = 0; c < 2; c++) {
+            int after = digitalRead(pins[c]);
+            if (before[c] == LOW && after == HIGH) open_times[c].push_back(next_us);
+            if (before[c] == HIGH && after == LOW) close_times[c].push_back(next_us);
+        }
+    }
+}
+
+// One 36-1 revolution at 500 µs per tooth (50 µs per degree); returns the
+// time of position 0. cam adds a cam edge after the last tooth.
+static uint32_t run_revolution(bool cam) {
+    uint32_t tooth0_us = 0;
+    for (uint8_t i = 0; i < 35; i++) {
+        sim_time_us += (i == 0) ? 1000 : 500;
+        run_compare_until(sim_time_us);
+        mock_set_micros(sim_time_us);
+        trigger_decoder_crank_edge(sim_time_us);
+        if (i == 0) tooth0_us = sim_time_us;
+        if (i == pw_change_tooth) {
+            send_pulse_width(pw_change_ms);
+            pw_change_tooth = -1;
+        }
+    }
+    if (cam) {
+        trigger_decoder_cam_edge(sim_time_us);
+    }
+    return tooth0_us;
+}
+
+static void clear_logs(void) {
+    for (int c = 0; c < 2; c++) {
+        open_times[c].clear();
+        close_times[c].clear();
+    }
+}
+
+// Two cylinders on a 36-1 wheel, EOI 60° BTDC, 4 ms pulse width
+static void setup_engine(uint8_t mode, bool cam_sync, float tdc_2) {
+    mock_reset_all();
+    g_message_bus.init();
+    g_message_bus.resetSubscribers();
+    trigger_decoder_init();
+    trigger_wheel_config_t wheel = {};
+    wheel.tooth_count = 36;
+    wheel.missing_teeth = 1;
+    wheel.use_cam_sync = cam_sync ? 1 : 0;
+    wheel.stall_timeout_us = 100000;
+    assert(trigger_decoder_configure(&wheel));
+    trigger_decoder_begin(2, cam_sync ? 3 : TRIGGER_NO_PIN);
+
+    injection_scheduler_init();
+    injection_layout_t inj = {};
+    inj.cylinder_count = 2;
+    inj.injector_pins[0] = INJ_PIN_1;
+    inj.injector_pins[1] = INJ_PIN_2;
+    inj.tdc_angle_deg[0] = 0.0f;
+    inj.tdc_angle_deg[1] = tdc_2;
+    inj.mode = mode;
+    assert(injection_scheduler_configure(&inj));
+    injection_scheduler_begin();
+    injection_scheduler_set_eoi_angle(60.0f);
+    send_pulse_width(4.0f);
+    injection_scheduler_enable(true);
+
+    sim_time_us = 1000;
+    pw_change_tooth = -1;
+    clear_logs();
+}
+
+// Test sequential pulses end at each cylinder's own EOI once per 720°
+TEST(sequential_timing) {
+    setup_engine(INJECTION_MODE_SEQUENTIAL, true, 360.0f);
+    run_revolution(false);
+    run_revolution(true);       // Next gap starts the cycle
+    run_revolution(false);
+    run_revolution(true);
+    clear_logs();
+
+    uint32_t t0 = run_revolution(false);
+    run_revolution(true);
+    run_revolution(false);
+    assert(injection_scheduler_get_active_mode() == INJECTION_MODE_SEQUENTIAL);
+
+    // Cylinder 2: EOI at 300°, full 4 ms width. Cylinder 1: EOI at 660°.
+    assert(has_time(open_times[1], t0 + 300 * 50 - 4000));
+    assert(has_time(close_times[1], t0 + 300 * 50));
+    assert(has_time(open_times[0], t0 + 660 * 50 - 4000));
+    assert(has_time(close_times[0], t0 + 660 * 50));
+    assert(open_times[0].size() == 1);     // Once per 720°
+    assert(injection_scheduler_get_late_count() == 0);
+    assert(injection_scheduler_get_overlap_count() == 0);
+    assert(injection_scheduler_get_overrun_count() == 0);
+}
+
+// Test semi-sequential (including the no-cam fallback) and batch timing
+TEST(semi_sequential_and_batch) {
+    // Sequential requested without a cam: half pulses once per revolution
+    setup_engine(INJECTION_MODE_SEQUENTIAL, false, 180.0f);
+    run_revolution(false);
+    run_revolution(false);
+    clear_logs();
+    uint32_t t0 = run_revolution(false);
+    run_revolution(false);
+    assert(injection_scheduler_get_active_mode() == INJECTION_MODE_SEMI_SEQUENTIAL);
+    assert(has_time(open_times[0], t0 + 300 * 50 - 2000));
+    assert(has_time(close_times[0], t0 + 300 * 50));
+    assert(has_time(open_times[1], t0 + 120 * 50 - 2000));
+    assert(has_time(close_times[1], t0 + 120 * 50));
+
+    // Batch: both injectors on cylinder 1's EOI
+    injection_scheduler_set_mode(INJECTION_MODE_BATCH);
+    run_revolution(false);
+    clear_logs();
+    t0 = run_revolution(false);
+    run_revolution(false);
+    assert(injection_scheduler_get_active_mode() == INJECTION_MODE_BATCH);
+    for (int c = 0; c < 2; c++) {
+        assert(has_time(open_times[c], t0 + 300 * 50 - 2000));
+        assert(has_time(close_times[c], t0 + 300 * 50));
+    }
+    assert(injection_scheduler_get_late_count() == 0);
+}
+
+// Test a pulse-width change while the injector is open moves only its close
+TEST(pulse_width_change_mid_pulse) {
+    setup_engine(INJECTION_MODE_SEMI_SEQUENTIAL, false, 180.0f);
+    run_revolution(false);
+    run_revolution(false);
+
+    // Longer: open at tooth 26, 6 ms (3 ms half pulse) sent at tooth 27
+    clear_logs();
+    pw_change_tooth = 27;
+    pw_change_ms = 6.0f;
+    uint32_t t0 = run_revolution(false);
+    uint32_t t1 = run_revolution(false);
+    assert(open_times[0].size() == 2);
+    assert(open_times[0][0] == t0 + 13000);
+    assert(close_times[0][0] == t0 + 13000 + 3000);
+    assert(open_times[0][1] == t1 + 15000 - 3000);
+
+    // Shorter than the time already open: closes on the next tooth, no re-open
+    run_revolution(false);
+    clear_logs();
+    pw_change_tooth = 27;
+    pw_change_ms = 1.0f;
+    t0 = run_revolution(false);
+    run_revolution(false);
+    assert(open_times[0].size() == 2);
+    assert(open_times[0][0] == t0 + 15000 - 3000);
+    assert(close_times[0][0] == t0 + 14000);
+    assert(open_times[0][1] > t0 + 18000);
+    assert(injection_scheduler_get_overlap_count() == 0);
+
+    // Losing sync closes the injectors and empties the queues
+    assert(digitalRead(INJ_PIN_1) == LOW);
+    mock_set_micros(sim_time_us + 200000);
+    trigger_decoder_update();
+    uint32_t next_us;
+    assert(!injection_scheduler_next_event_us(&next_us));
+}
+
+int main() {
+    std::cout << "=== Injection Scheduler Tests ===" << std::endl;
+
+    run_test_sequential_timing();
+    run_test_semi_sequential_and_batch();
+    run_test_pulse_width_change_mid_pulse();
+
+    std::cout << std::endl;
+    std::cout << "Injection Scheduler Tests - Run: " << tests_run << ", Passed: " << tests_passed << std::endl;
+
+    if (tests_passed == tests_run) {
+        std::cout << "✅ ALL INJECTION SCHEDULER TESTS PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME INJECTION SCHEDULER TESTS FAILED!" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,135 @@
+// tests/input_manager/bench_input_manager.cpp
+// Desktop microbenchmarks for the input manager and sensor calibration
+//
+//   - input_manager_update() with all 32 sensor slots due every pass
+//     (16 linear, 8 thermistor, 8 digital)
+//   - calibrate_thermistor() table interpolation and the counts LUT path
+//   - interpolate_table() on its own
+//
+// Usage: make bench, or ./input_manager/bench_input_manager --output FILE
+// (see tests/bench.h for --baseline, --tolerance and --rounds)
+
+// Include mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../input_manager.h"
+#include "../../sensor_calibration.h"
+#include "../bench.h"
+
+static const int UPDATES_PER_ROUND = 2;         // 64 publishes, within one bus lane
+static const int CALIBRATIONS_PER_ROUND = 100;
+
+static const uint8_t ANALOG_PINS[] = {14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 38, 39, 40, 41};
+static const uint8_t ANALOG_PIN_COUNT = sizeof(ANALOG_PINS) / sizeof(ANALOG_PINS[0]);
+
+static sensor_definition_t sensors[MAX_SENSORS];
+
+static void build_sensors(void) {
+    memset(sensors, 0, sizeof(sensors));
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        sensor_definition_t* s = &sensors[i];
+        s->msg_id = MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, SENSOR_ID(0x40 + i));
+        s->update_interval_us = 0;          // Due every pass
+        s->filter_strength = 64;
+        s->name = "bench";
+        if (i < 16) {
+            s->pin = ANALOG_PINS[i % ANALOG_PIN_COUNT];
+            s->type = SENSOR_ANALOG_LINEAR;
+            s->config.linear.min_voltage = 0.5f;
+            s->config.linear.max_voltage = 4.5f;
+            s->config.linear.min_value = 0.0f;
+            s->config.linear.max_value = 100.0f;
+        } else if (i < 24) {
+            s->pin = ANALOG_PINS[i % ANALOG_PIN_COUNT];
+            s->type = SENSOR_THERMISTOR;
+            s->config.thermistor.pullup_ohms = 2490;
+            s->config.thermistor.voltage_table = STANDARD_THERMISTOR_VOLTAGE_TABLE;
+            s->config.thermistor.temp_table = STANDARD_THERMISTOR_TEMP_TABLE;
+            s->config.thermistor.table_size = STANDARD_THERMISTOR_TABLE_SIZE;
+            s->config.thermistor.counts_lut = STANDARD_THERMISTOR_COUNTS_LUT;
+        } else {
+            s->pin = (uint8_t)(2 + (i - 24));
+            s->type = SENSOR_DIGITAL_PULLUP;
+            s->config.digital.use_pullup = 1;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Benchmarks
+// ---------------------------------------------------------------------------
+
+static void bench_input_update(void) {
+    mock_reset_all();
+    g_message_bus.init();
+    input_manager_init();
+    build_sensors();
+    for (uint8_t p = 0; p < ANALOG_PIN_COUNT; p++) {
+        mock_set_analog_voltage(ANALOG_PINS[p], 0.5f + 0.2f * p);
+    }
+    if (input_manager_register_sensors(sensors, MAX_SENSORS) != MAX_SENSORS) {
+        std::cerr << "  only " << (int)input_manager_get_sensor_count() << " sensors registered" << std::endl;
+    }
+
+    bench_run("input_update_32_sensors", UPDATES_PER_ROUND,
+        [] { g_message_bus.process(); mock_advance_time_us(1000); },
+        [] {
+            for (int i = 0; i < UPDATES_PER_ROUND; i++) {
+                input_manager_update();
+            }
+        });
+    bench_sink = bench_sink + input_manager_get_total_updates();
+}
+
+static void bench_calibration(void) {
+    static thermistor_config_t table_config;
+    table_config.pullup_ohms = 2490;
+    table_config.voltage_table = STANDARD_THERMISTOR_VOLTAGE_TABLE;
+    table_config.temp_table = STANDARD_THERMISTOR_TEMP_TABLE;
+    table_config.table_size = STANDARD_THERMISTOR_TABLE_SIZE;
+    table_config.counts_lut = nullptr;
+    static thermistor_config_t lut_config = table_config;
+    lut_config.counts_lut = STANDARD_THERMISTOR_COUNTS_LUT;
+
+    // Voltages spread over the table so every segment is searched
+    static float voltages[CALIBRATIONS_PER_ROUND];
+    static uint16_t counts[CALIBRATIONS_PER_ROUND];
+    for (int i = 0; i < CALIBRATIONS_PER_ROUND; i++) {
+        voltages[i] = 0.1f + 3.1f * i / CALIBRATIONS_PER_ROUND;
+        counts[i] = (uint16_t)(voltages[i] / 3.3f * 4095.0f);
+    }
+
+    bench_run("calibrate_thermistor_table", CALIBRATIONS_PER_ROUND, [] {}, [] {
+        float sum = 0;
+        for (int i = 0; i < CALIBRATIONS_PER_ROUND; i++) {
+            sum += calibrate_thermistor(&table_config, voltages[i]);
+        }
+        bench_sink = bench_sink + (uint32_t)sum;
+    });
+    bench_run("calibrate_thermistor_counts_lut", CALIBRATIONS_PER_ROUND, [] {}, [] {
+        float sum = 0;
+        for (int i = 0; i < CALIBRATIONS_PER_ROUND; i++) {
+            sum += calibrate_thermistor_counts(&lut_config, counts[i]);
+        }
+        bench_sink = bench_sink + (uint32_t)sum;
+    });
+    bench_run("interpolate_table", CALIBRATIONS_PER_ROUND, [] {}, [] {
+        float sum = 0;
+        for (int i = 0; i < CALIBRATIONS_PER_ROUND; i++) {
+            sum += interpolate_table(STANDARD_THERMISTOR_VOLTAGE_TABLE, STANDARD_THERMISTOR_TEMP_TABLE,
+                                     STANDARD_THERMISTOR_TABLE_SIZE, voltages[i]);
+        }
+        bench_sink = bench_sink + (uint32_t)sum;
+    });
+}
+
+static void run_benchmarks(void) {
+    bench_input_update();
+    bench_calibration();
+}
+
+int main(int argc, char** argv) {
+    return bench_main(argc, argv, "input_manager", run_benchmarks);
+}
@@ -0,0 +1,141 @@
+// tests/input_manager/test_freq_capture.cpp
+// Test suite for QuadTimer input-capture frequency measurement
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+// Include enhanced mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../input_manager.h"
+#include "../../freq_capture.h"
+
+// Simple test framework
+int tests_run = 0;
+int tests_passed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        std::cout << "  Running test: " #name "... "; \
+        tests_run++; \
+        test_##name(); \
+        tests_passed++; \
+        std::cout << "PASSED" << std::endl; \
+    } \
+    void test_##name()
+
+static float received_speed = -1.0f;
+static void speed_handler(const CANMessage* msg) {
+    received_speed = MSG_UNPACK_FLOAT(msg);
+}
+
+// Test only QuadTimer pins are captured and periods resolve below 1 Hz steps
+TEST(period_mode_resolution) {
+    mock_reset_all();
+    freq_capture_init();
+
+    assert(!freq_capture_add_pin(2, FREQ_EDGE_RISING, 1000000));  // No QuadTimer input
+    assert(freq_capture_add_pin(6, FREQ_EDGE_RISING, 1000000));
+    assert(freq_capture_add_pin(6, FREQ_EDGE_RISING, 1000000));   // Duplicate is a no-op
+    assert(freq_capture_get_channel_count() == 1);
+    assert(freq_capture_get_mode(6) == FREQ_CAPTURE_MODE_PERIOD);
+
+    float hz = -1.0f;
+    assert(!freq_capture_get(2, &hz));
+    assert(freq_capture_get(6, &hz) && hz == 0.0f);
+
+    // 7.5 Hz (133333 µs period): a window counter would report 0 or 10 Hz
+    freq_capture_inject_edges_for_testing(6, 4, 133333);
+    freq_capture_update();
+    assert(freq_capture_get(6, &hz));
+    assert(fabsf(hz - 7.5f) < 0.01f);
+
+    // No edges: value holds until the timeout, then drops to zero
+    mock_advance_time_ms(900);
+    freq_capture_update();
+    assert(freq_capture_get(6, &hz) && fabsf(hz - 7.5f) < 0.01f);
+    mock_advance_time_ms(200);
+    freq_capture_update();
+    assert(freq_capture_get(6, &hz) && hz == 0.0f);
+}
+
+// Test automatic PERIOD <-> COUNT switching with hysteresis
+TEST(automatic_mode_switching) {
+    mock_reset_all();
+    freq_capture_init();
+    assert(freq_capture_add_pin(6, FREQ_EDGE_RISING, 1000000));
+
+    // 10 kHz: above the COUNT threshold
+    freq_capture_inject_edges_for_testing(6, 50, 100);
+    freq_capture_update();
+    float hz = 0.0f;
+    assert(freq_capture_get(6, &hz) && fabsf(hz - 10000.0f) < 50.0f);
+    assert(freq_capture_get_mode(6) == FREQ_CAPTURE_MODE_COUNT);
+    uint32_t isr_after_switch = freq_capture_get_isr_count();
+
+    // COUNT mode: 225 edges in a 50 ms window = 4500 Hz, inside the hysteresis band
+    mock_advance_time_us(FREQ_CAPTURE_COUNT_WINDOW_US);
+    freq_capture_inject_edges_for_testing(6, 225, 222);
+    freq_capture_update();
+    assert(freq_capture_get(6, &hz) && fabsf(hz - 4500.0f) < 1.0f);
+    assert(freq_capture_get_mode(6) == FREQ_CAPTURE_MODE_COUNT);
+    assert(freq_capture_get_isr_count() == isr_after_switch);  // No per-edge interrupts
+
+    // 3000 Hz: below the PERIOD threshold
+    mock_advance_time_us(FREQ_CAPTURE_COUNT_WINDOW_US);
+    freq_capture_inject_edges_for_testing(6, 150, 333);
+    freq_capture_update();
+    assert(freq_capture_get(6, &hz) && fabsf(hz - 3000.0f) < 1.0f);
+    assert(freq_capture_get_mode(6) == FREQ_CAPTURE_MODE_PERIOD);
+}
+
+// Test interrupt frequency sensors on capture pins are measured by the timer
+TEST(input_manager_uses_capture) {
+    mock_reset_all();
+    g_message_bus.init();
+    g_message_bus.resetSubscribers();
+    g_message_bus.subscribe(MSG_VEHICLE_SPEED, speed_handler);
+    input_manager_init();
+
+    sensor_definition_t test_sensors[] = {
+        VEHICLE_SPEED_SENSOR(6, MSG_VEHICLE_SPEED),
+        DEFINE_INTERRUPT_FREQUENCY_SENSOR(2, MSG_ENGINE_RPM, FREQ_EDGE_RISING, 8000, 10, 60, 1.0f, 1000000, "Engine RPM")
+    };
+    assert(input_manager_register_sensors(test_sensors, 2) == 2);
+    assert(freq_capture_get_channel_count() == 1);   // Pin 2 keeps the edge counter
+    assert(freq_capture_get_mode(6) == FREQ_CAPTURE_MODE_PERIOD);
+
+    // 37.5 Hz, then past the 2 Hz message interval
+    freq_capture_inject_edges_for_testing(6, 10, 26667);
+    input_manager_update();
+    mock_advance_time_ms(600);
+    received_speed = -1.0f;
+    input_manager_update();
+    g_message_bus.process();
+
+    // (37.5 * 60) / 4 * 0.01 = 5.625
+    assert(fabsf(received_speed - 5.625f) < 0.01f);
+}
+
+int main() {
+    std::cout << "=== Frequency Capture Tests ===" << std::endl;
+
+    run_test_period_mode_resolution();
+    run_test_automatic_mode_switching();
+    run_test_input_manager_uses_capture();
+
+    std::cout << std::endl;
+    std::cout << "Frequency Capture Tests - Run: " << tests_run << ", Passed: " << tests_passed << std::endl;
+
+    if (tests_passed == tests_run) {
+        std::cout << "✅ ALL FREQUENCY CAPTURE TESTS PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME FREQUENCY CAPTURE TESTS FAILED!" << std::endl;
+        return 1;
+    }
+}
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <cmath>
 
 // Include enhanced mock Arduino before any ECU code
 #include "../mock_arduino.h"
@@ -316,7 +317,161 @@ TEST(table_interpolation) {
     assert(result == 30.0f);  // Should clamp to last value
 }
 
+// Test deadline scheduler: only due sensors update, in due-time order
+TEST(deadline_scheduler_only_due_sensors) {
+    test_setup();
+    g_message_bus.init();
+    input_manager_init();
+    mock_set_micros(0);
+    
+    sensor_definition_t test_sensors[] = {
+        DEFINE_LINEAR_SENSOR(A0, MSG_THROTTLE_POSITION, 0.5f, 4.5f, 0.0f, 100.0f, 10000, "Fast"),
+        DEFINE_LINEAR_SENSOR(A1, MSG_MANIFOLD_PRESSURE, 0.5f, 4.5f, 0.0f, 100.0f, 50000, "Slow")
+    };
+    assert(input_manager_register_sensors(test_sensors, 2) == 2);
+    
+    // Nothing is due before the first interval
+    input_manager_update();
+    assert(input_manager_get_total_updates() == 0);
+    assert(input_manager_get_time_until_next_us() == 10000);
+    
+    mock_set_micros(10000);
+    assert(input_manager_get_time_until_next_us() == 0);
+    input_manager_update();
+    assert(input_manager_get_total_updates() == 1);
+    assert(input_manager_get_time_until_next_us() == 10000);
+    
+    // Run for 100ms in 1ms steps: fast updates every 10ms, slow every 50ms
+    for (uint32_t t = 11000; t <= 110000; t += 1000) {
+        mock_set_micros(t);
+        input_manager_update();
+    }
+    sensor_runtime_t fast, slow;
+    assert(input_manager_get_sensor_status(0, &fast));
+    assert(input_manager_get_sensor_status(1, &slow));
+    assert(fast.update_count == 11);
+    assert(slow.update_count == 2);
+    assert(input_manager_get_missed_deadlines() == 0);
+}
+
+// Test lateness and missed deadline accounting
+TEST(deadline_scheduler_missed_deadlines) {
+    test_setup();
+    g_message_bus.init();
+    input_manager_init();
+    mock_set_micros(0);
+    
+    sensor_definition_t test_sensor[] = {
+        DEFINE_LINEAR_SENSOR(A0, MSG_THROTTLE_POSITION, 0.5f, 4.5f, 0.0f, 100.0f, 10000, "Test TPS")
+    };
+    assert(input_manager_register_sensors(test_sensor, 1) == 1);
+    
+    // Slightly late: counted as lateness, not a miss
+    mock_set_micros(12000);
+    input_manager_update();
+    sensor_runtime_t status;
+    assert(input_manager_get_sensor_status(0, &status));
+    assert(status.max_lateness_us == 2000);
+    assert(status.missed_deadlines == 0);
+    assert(status.next_due_us == 22000);
+    
+    // A whole interval late: one missed deadline, one update (no catch-up burst)
+    mock_set_micros(35000);
+    input_manager_update();
+    assert(input_manager_get_sensor_status(0, &status));
+    assert(status.max_lateness_us == 13000);
+    assert(status.missed_deadlines == 1);
+    assert(input_manager_get_missed_deadlines() == 1);
+    assert(input_manager_get_total_updates() == 2);
+    
+    // No scheduled sensors
+    input_manager_init();
+    assert(input_manager_get_time_until_next_us() == UINT32_MAX);
+}
+
 // Main test runner
+// Test one pass calibrates each type group and publishes every due sensor once
+TEST(batched_update_publishes_each_sensor_once) {
+    test_setup();
+    g_message_bus.init();
+    input_manager_init();
+    mock_set_micros(0);
+    
+    sensor_definition_t test_sensors[] = {
+        DEFINE_LINEAR_SENSOR(A0, MSG_THROTTLE_POSITION, 0.5f, 4.5f, 0.0f, 100.0f, 0, "TPS"),
+        DEFINE_THERMISTOR_LUT_SENSOR(A2, MSG_COOLANT_TEMP, 2200, STANDARD_THERMISTOR_VOLTAGE_TABLE,
+                                     STANDARD_THERMISTOR_TEMP_TABLE, STANDARD_THERMISTOR_TABLE_SIZE,
+                                     STANDARD_THERMISTOR_COUNTS_LUT, 0, "CTS"),
+        DEFINE_LINEAR_SENSOR(A1, MSG_MANIFOLD_PRESSURE, 0.5f, 4.5f, 20.0f, 300.0f, 0, "MAP")
+    };
+    assert(input_manager_register_sensors(test_sensors, 3) == 3);
+    
+    uint32_t published_before = g_message_bus.getMessagesPublished();
+    input_manager_update();
+    assert(input_manager_get_total_updates() == 3);
+    assert(g_message_bus.getMessagesPublished() - published_before == 3);
+    
+    // Values match the scalar calibration functions
+    sensor_runtime_t status;
+    assert(input_manager_get_sensor_status(0, &status) && status.is_valid);
+    assert(fabsf(status.calibrated_value - calibrate_linear(&test_sensors[0].config.linear,
+                                                             adc_counts_to_voltage(status.raw_counts))) < 0.01f);
+    assert(input_manager_get_sensor_status(1, &status) && status.is_valid);
+    assert(fabsf(status.calibrated_value - calibrate_thermistor(&test_sensors[1].config.thermistor,
+                                                                 adc_counts_to_voltage(status.raw_counts))) < 0.1f);
+    assert(input_manager_get_sensor_status(2, &status) && status.is_valid);
+    assert(fabsf(status.calibrated_value - calibrate_linear(&test_sensors[2].config.linear,
+                                                             adc_counts_to_voltage(status.raw_counts))) < 0.01f);
+}
+
+// Test a deadband sensor only publishes on real changes or its heartbeat
+TEST(publish_deadband_and_heartbeat) {
+    test_setup();
+    g_message_bus.init();
+    input_manager_init();
+    mock_set_micros(0);
+    
+    sensor_definition_t test_sensors[] = {
+        DEFINE_LINEAR_SENSOR(A0, MSG_THROTTLE_POSITION, 0.5f, 4.5f, 0.0f, 100.0f, 0, "TPS")
+    };
+    test_sensors[0].filter_strength = 0;
+    test_sensors[0].publish_deadband = 1.0f;        // 1% throttle
+    test_sensors[0].publish_heartbeat_us = 100000;  // At least every 100 ms
+    assert(input_manager_register_sensors(test_sensors, 1) == 1);
+    
+    // First valid value always publishes
+    mock_set_analog_reading(A0, 2048);
+    uint32_t published = g_message_bus.getMessagesPublished();
+    input_manager_update();
+    assert(g_message_bus.getMessagesPublished() - published == 1);
+    
+    // Same value and a sub-deadband change (~0.2%) are held back
+    mock_advance_time_us(10000);
+    input_manager_update();
+    mock_set_analog_reading(A0, 2058);
+    mock_advance_time_us(10000);
+    input_manager_update();
+    assert(g_message_bus.getMessagesPublished() - published == 1);
+    sensor_runtime_t status;
+    assert(input_manager_get_sensor_status(0, &status));
+    assert(status.suppressed_publishes == 2);
+    assert(input_manager_get_total_suppressed_publishes() == 2);
+    
+    // A change beyond the deadband (~4%) publishes immediately
+    mock_set_analog_reading(A0, 2248);
+    mock_advance_time_us(10000);
+    input_manager_update();
+    assert(g_message_bus.getMessagesPublished() - published == 2);
+    
+    // A steady value still publishes once the heartbeat runs out
+    mock_advance_time_us(50000);
+    input_manager_update();
+    assert(g_message_bus.getMessagesPublished() - published == 2);
+    mock_advance_time_us(50000);
+    input_manager_update();
+    assert(g_message_bus.getMessagesPublished() - published == 3);
+}
+
 int main() {
     std::cout << "=== Input Manager Tests ===" << std::endl;
     
@@ -332,6 +487,10 @@ int main() {
     run_test_sensor_status_retrieval();
     run_test_utility_functions();
     run_test_table_interpolation();
+    run_test_deadline_scheduler_only_due_sensors();
+    run_test_deadline_scheduler_missed_deadlines();
+    run_test_batched_update_publishes_each_sensor_once();
+    run_test_publish_deadband_and_heartbeat();
     
     // Print results
     std::cout << std::endl;
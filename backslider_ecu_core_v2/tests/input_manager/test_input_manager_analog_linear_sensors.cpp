@@ -591,6 +591,72 @@ TEST(different_filter_strengths) {
     assert(float_equals(status1.calibrated_value, 50.0f, 5.0f));
 }
 
+// Test Q16.16 calibration tracks the float path across the ADC range
+TEST(fixed_point_linear_calibration) {
+    linear_config_t configs[] = {
+        {0.5f, 4.5f, 0.0f, 100.0f, 0},     // TPS
+        {0.5f, 4.5f, 20.0f, 300.0f, 0},    // MAP
+        {0.5f, 3.0f, 100.0f, -40.0f, 0}    // Inverted range
+    };
+    
+    for (uint8_t c = 0; c < 3; c++) {
+        linear_fixed_t fixed;
+        assert(calibrate_linear_fixed_prepare(&configs[c], &fixed));
+        for (uint16_t counts = 0; counts <= 4095; counts++) {
+            float expected = calibrate_linear(&configs[c], adc_counts_to_voltage(counts));
+            float actual = Q16_16_TO_FLOAT(calibrate_linear_fixed(&fixed, counts));
+            assert(float_equals(actual, expected, 0.01f));
+        }
+    }
+    
+    // Ranges that do not fit Q16.16 are refused (sensor stays on floats)
+    linear_config_t wide = {0.5f, 4.5f, 0.0f, 50000.0f, 0};
+    linear_fixed_t fixed;
+    assert(!calibrate_linear_fixed_prepare(&wide, &fixed));
+}
+
+// Test fixed-point filtering follows the float EMA
+TEST(fixed_point_filtering) {
+    for (uint16_t strength = 0; strength <= 255; strength += 51) {
+        float alpha = (255.0f - strength) / 255.0f;
+        q16_16_t alpha_q16 = filter_alpha_fixed((uint8_t)strength);
+        
+        float value = 50.0f;
+        q16_16_t value_q16 = 50 * Q16_16_ONE;
+        for (int i = 0; i < 50; i++) {
+            value = (alpha * 87.5f) + ((1.0f - alpha) * value);
+            value_q16 = apply_filter_fixed(value_q16, (q16_16_t)(87.5f * Q16_16_ONE), alpha_q16);
+        }
+        assert(float_equals(Q16_16_TO_FLOAT(value_q16), value, 0.01f));
+    }
+    
+    // A registered sensor steps exactly like the float filter did
+    test_setup();
+    g_message_bus.init();
+    input_manager_init();
+    sensor_definition_t tps[] = {
+        {
+            .pin = A0, .type = SENSOR_ANALOG_LINEAR,
+            .config.linear = {0.5f, 4.5f, 0.0f, 100.0f, 0},
+            .msg_id = MSG_THROTTLE_POSITION, .update_interval_us = 0, .filter_strength = 100, .name = "Fixed TPS"
+        }
+    };
+    input_manager_register_sensors(tps, 1);
+    
+    mock_set_analog_voltage(A0, 2.5f);
+    input_manager_update();
+    sensor_runtime_t status;
+    input_manager_get_sensor_status(0, &status);
+    float first = status.calibrated_value;
+    
+    mock_set_analog_voltage(A0, 4.0f);
+    input_manager_update();
+    input_manager_get_sensor_status(0, &status);
+    float target = calibrate_linear(&tps[0].config.linear, adc_counts_to_voltage(status.raw_counts));
+    float alpha = (255.0f - 100.0f) / 255.0f;
+    assert(float_equals(status.calibrated_value, first + alpha * (target - first), 0.01f));
+}
+
 // =============================================================================
 // ANALOG SENSOR TIMING TESTS
 // =============================================================================
@@ -764,6 +830,8 @@ int main() {
     std::cout << "\n--- Filtering Tests ---" << std::endl;
     run_test_analog_sensor_filtering();
     run_test_different_filter_strengths();
+    run_test_fixed_point_linear_calibration();
+    run_test_fixed_point_filtering();
     
     // Run timing tests
     std::cout << "\n--- Timing Tests ---" << std::endl;
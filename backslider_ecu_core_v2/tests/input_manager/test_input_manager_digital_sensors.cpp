@@ -508,6 +508,39 @@ TEST(digital_sensor_find_by_msg_id) {
     assert(nonexistent_index == -1);
 }
 
+// Test I2C GPIO sensors share one MCP23017 port read per update pass
+TEST(i2c_gpio_sensors_share_port_snapshot) {
+    test_setup();
+    g_message_bus.init();
+    input_manager_init();
+    
+    sensor_definition_t gpio_sensors[] = {
+        DEFINE_I2C_GPIO_SENSOR(0, MSG_TRANS_PARK_SWITCH, 1, 1, 0, "Park"),
+        DEFINE_I2C_GPIO_SENSOR(1, MSG_TRANS_REVERSE_SWITCH, 1, 1, 0, "Reverse"),
+        DEFINE_I2C_GPIO_SENSOR(9, MSG_TRANS_NEUTRAL_SWITCH, 1, 0, 0, "Neutral")
+    };
+    assert(input_manager_register_sensors(gpio_sensors, 3) == 3);
+    
+    // Park grounded (active low), port B pin 9 high
+    mock_set_mcp23017_pin(0, false);
+    mock_set_mcp23017_pin(1, true);
+    mock_set_mcp23017_pin(9, true);
+    input_manager_update();
+    assert(input_manager_get_gpio_port_reads() == 1);
+    
+    sensor_runtime_t status;
+    assert(input_manager_get_sensor_status(0, &status) && status.calibrated_value == 1.0f);
+    assert(input_manager_get_sensor_status(1, &status) && status.calibrated_value == 0.0f);
+    assert(input_manager_get_sensor_status(2, &status) && status.calibrated_value == 1.0f);
+    
+    // Next pass reads the ports once more and sees the change
+    mock_set_mcp23017_pin(0, true);
+    mock_advance_time_us(1000);
+    input_manager_update();
+    assert(input_manager_get_gpio_port_reads() == 2);
+    assert(input_manager_get_sensor_status(0, &status) && status.calibrated_value == 0.0f);
+}
+
 // =============================================================================
 // MAIN TEST RUNNER
 // =============================================================================
@@ -540,6 +573,7 @@ int main() {
     std::cout << "\n--- Status and Diagnostics Tests ---" << std::endl;
     run_test_digital_sensor_status();
     run_test_digital_sensor_find_by_msg_id();
+    run_test_i2c_gpio_sensors_share_port_snapshot();
     
     // Print results
     std::cout << std::endl;
@@ -292,6 +292,61 @@ TEST(mathematical_accuracy) {
     assert(test_resistance > 3000.0f && test_resistance < 4000.0f);
 }
 
+// Test counts-indexed LUT tracks table interpolation across the ADC range
+TEST(counts_lut_generation) {
+    const uint8_t table_size = 15;
+    float voltage_table[table_size];
+    float temp_table[table_size];
+    generate_thermistor_table(25.0f, 3500.0f, 110.0f, 250.0f, 2200,
+                              -40.0f, 150.0f, table_size, voltage_table, temp_table);
+    
+    float lut[THERMISTOR_LUT_SIZE];
+    generate_thermistor_counts_lut(voltage_table, temp_table, table_size, lut);
+    
+    thermistor_config_t table_config = {2200, voltage_table, temp_table, table_size, nullptr};
+    thermistor_config_t lut_config = {2200, voltage_table, temp_table, table_size, lut};
+    
+    // Grid points are exact; between them the error stays well under 1°C
+    for (uint16_t counts = 0; counts <= 4095; counts++) {
+        float expected = calibrate_thermistor_counts(&table_config, counts);
+        float actual = calibrate_thermistor_counts(&lut_config, counts);
+        if ((counts & ((1 << THERMISTOR_LUT_SHIFT) - 1)) == 0) {
+            assert(float_equal(actual, expected, 0.001f));
+        }
+        assert(float_equal(actual, expected, 1.0f));
+    }
+    
+    // Out-of-range counts clamp to the last entry instead of overrunning
+    assert(float_equal(calibrate_thermistor_counts(&lut_config, 65535), lut[THERMISTOR_LUT_SIZE - 1], 0.5f));
+}
+
+// Test compile-time standard LUTs match boot-time generation
+TEST(standard_counts_luts) {
+    float lut[THERMISTOR_LUT_SIZE];
+    
+    generate_thermistor_counts_lut(STANDARD_THERMISTOR_VOLTAGE_TABLE, STANDARD_THERMISTOR_TEMP_TABLE,
+                                   STANDARD_THERMISTOR_TABLE_SIZE, lut);
+    for (uint16_t i = 0; i < THERMISTOR_LUT_SIZE; i++) {
+        assert(float_equal(STANDARD_THERMISTOR_COUNTS_LUT[i], lut[i], 0.001f));
+    }
+    
+    generate_thermistor_counts_lut(GM_CTS_VOLTAGE_TABLE, GM_CTS_TEMP_TABLE, GM_CTS_TABLE_SIZE, lut);
+    for (uint16_t i = 0; i < THERMISTOR_LUT_SIZE; i++) {
+        assert(float_equal(GM_CTS_COUNTS_LUT[i], lut[i], 0.001f));
+    }
+    
+    generate_thermistor_counts_lut(GENERIC_IAT_VOLTAGE_TABLE, GENERIC_IAT_TEMP_TABLE, GENERIC_IAT_TABLE_SIZE, lut);
+    for (uint16_t i = 0; i < THERMISTOR_LUT_SIZE; i++) {
+        assert(float_equal(GENERIC_IAT_COUNTS_LUT[i], lut[i], 0.001f));
+    }
+    
+    // 2.5V on the standard curve is 20°C
+    thermistor_config_t config = {2200, STANDARD_THERMISTOR_VOLTAGE_TABLE, STANDARD_THERMISTOR_TEMP_TABLE,
+                                  STANDARD_THERMISTOR_TABLE_SIZE, STANDARD_THERMISTOR_COUNTS_LUT};
+    uint16_t counts = (uint16_t)(2.5f * ADC_RESOLUTION / ADC_VOLTAGE_REF + 0.5f);
+    assert(float_equal(calibrate_thermistor_counts(&config, counts), 20.0f, 0.1f));
+}
+
 // Main test runner
 int main() {
     std::cout << "=== Thermistor Table Generator Tests ===" << std::endl;
@@ -305,6 +360,8 @@ int main() {
     run_test_edge_cases_and_validation();
     run_test_table_integration_with_interpolation();
     run_test_mathematical_accuracy();
+    run_test_counts_lut_generation();
+    run_test_standard_counts_luts();
     
     // Print results
     std::cout << std::endl;
@@ -0,0 +1,322 @@
+// tests/main_application/replay_main_application.cpp
+// Replays a recorded session through the whole MainApplication stack
+//
+// Loads an SD log (LOGnnnnn.BSL) or a raw serial-bridge capture with the
+// host replay library (host/ecu_replay.h), then publishes every recorded
+// message into the message bus of a fully initialized MainApplication
+// running on the mock Arduino environment. Simulated time follows the
+// recording's publish stamps and jumps straight from one message to the
+// next, calling MainApplication::run() every --pass-us of simulated time
+// in between, so a track session replays as fast as the host allows.
+//
+// Everything recorded is injected, including messages the stack publishes
+// itself on the car; compare runs of the same recording only.
+//
+// Per replay it reports:
+//   - CPU time per module: each task's host time (total, worst run,
+//     overruns), measured with the host clock through
+//     task_executive_set_duration_clock_for_testing(). Bus handler time is
+//     inside the msg_bus task.
+//   - Queue depth: total bus queue depth sampled before every pass (peak
+//     and mean), the deepest lane watermark and overflows.
+//   - Latency: publish-to-deliver time in simulated µs across the replayed
+//     IDs, from the bus profiler (mean, p99 bucket edge, max).
+//
+// Results are written as JSON (--output FILE) and summarised on stdout.
+//
+// Usage:
+//   make replay REPLAY_LOG=LOG00012.BSL
+//   ./main_application/replay_main_application LOG00012.BSL --output replay.json
+//   ./main_application/replay_main_application capture.bin --pass-us 100
+//
+// Absolute CPU times depend on the host; compare only runs from the same
+// machine.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+// Include mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../main_application.h"
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../task_executive.h"
+#include "../../boot_sequence.h"
+#include "../../storage_manager.h"
+#include "../../spi_flash_storage_backend.h"
+#include "../../host/ecu_stream.h"
+#include "../../host/ecu_replay.h"
+
+// Global instances (needed for custom_canbus_manager linkage)
+static SPIFlashStorageBackend global_storage_backend;
+static StorageManager global_storage_manager(&global_storage_backend);
+StorageManager& g_storage_manager = global_storage_manager;
+
+static const uint32_t DEFAULT_PASS_US = 250;        // Simulated time between main-loop passes
+static const uint32_t DRAIN_US = 100000;            // Run on after the last message
+static const uint32_t START_US = 1000000;           // Simulated clock at init
+
+struct TaskTotals {
+    std::string name;
+    uint32_t runs_seen;
+    uint64_t total_us;
+    uint32_t max_us;
+    uint32_t overruns;
+};
+
+static std::vector<CANMessage> recording;
+static std::vector<TaskTotals> task_totals;
+
+static uint64_t queue_depth_sum = 0;
+static uint32_t queue_depth_samples = 0;
+static uint16_t queue_depth_peak = 0;
+static uint32_t passes = 0;
+
+// ---------------------------------------------------------------------------
+// Host clock and recording
+// ---------------------------------------------------------------------------
+
+static uint32_t host_clock_us(void) {
+    using namespace std::chrono;
+    static const steady_clock::time_point origin = steady_clock::now();
+    return (uint32_t)duration_cast<microseconds>(steady_clock::now() - origin).count();
+}
+
+static void collect_message(const CANMessage* msg, void* context) {
+    (void)context;
+    recording.push_back(*msg);
+}
+
+// Decode the whole recording up front so the replay loop only publishes
+static bool load_recording(const char* path) {
+    EcuReplay replay;
+    if (!replay.load(path)) {
+        return false;
+    }
+    EcuStreamDecoder decoder;
+    decoder.set_message_handler(collect_message, nullptr);
+    replay.start(&decoder, 0.0);
+    replay.advance(0);
+    return !recording.empty();
+}
+
+// ---------------------------------------------------------------------------
+// Replay
+// ---------------------------------------------------------------------------
+
+static void run_pass(MainApplication& app) {
+    uint16_t depth = g_message_bus.getQueueSize();
+    queue_depth_sum += depth;
+    queue_depth_samples++;
+    if (depth > queue_depth_peak) {
+        queue_depth_peak = depth;
+    }
+
+    app.run();
+    passes++;
+
+    // A task runs at most once per pass, so last_us is this pass's run
+    for (size_t i = 0; i < task_totals.size(); i++) {
+        const task_t* task = task_executive_get_task((uint8_t)i);
+        if (task->runs != task_totals[i].runs_seen) {
+            task_totals[i].runs_seen = task->runs;
+            task_totals[i].total_us += task->last_us;
+        }
+        task_totals[i].max_us = task->max_us;
+        task_totals[i].overruns = task->overruns;
+    }
+}
+
+// Run passes until simulated time reaches target_us
+static void run_until(MainApplication& app, uint32_t target_us, uint32_t pass_us) {
+    while ((int32_t)(target_us - micros()) >= (int32_t)pass_us) {
+        mock_advance_time_us(pass_us);
+        run_pass(app);
+    }
+    uint32_t rest_us = target_us - micros();
+    if ((int32_t)rest_us > 0) {
+        mock_advance_time_us(rest_us);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Output
+// ---------------------------------------------------------------------------
+
+struct LatencyTotals {
+    uint32_t ids;
+    uint32_t samples;
+    uint64_t total_us;
+    uint32_t max_us;
+    uint32_t p99_us;
+};
+
+static LatencyTotals collect_latency(void) {
+    LatencyTotals totals = {0, 0, 0, 0, 0};
+    uint32_t buckets[MSG_BUS_LATENCY_BUCKETS] = {0};
+    std::set<uint32_t> ids;
+    for (size_t i = 0; i < recording.size(); i++) {
+        ids.insert(recording[i].id);
+    }
+    for (std::set<uint32_t>::const_iterator it = ids.begin(); it != ids.end(); ++it) {
+        latency_profile_t profile;
+        if (!g_message_bus.getLatencyProfile(*it, &profile) || profile.samples == 0) {
+            continue;
+        }
+        totals.ids++;
+        totals.samples += profile.samples;
+        totals.total_us += profile.total_us;
+        if (profile.max_us > totals.max_us) {
+            totals.max_us = profile.max_us;
+        }
+        for (uint8_t b = 0; b < MSG_BUS_LATENCY_BUCKETS; b++) {
+            buckets[b] += profile.buckets[b];
+        }
+    }
+    if (totals.samples == 0) {
+        return totals;
+    }
+    // Upper edge of the bucket holding the 99th percentile, capped at the max
+    uint32_t target = totals.samples - totals.samples / 100;
+    uint32_t cumulative = 0;
+    totals.p99_us = totals.max_us;
+    for (uint8_t b = 0; b < MSG_BUS_LATENCY_BUCKETS - 1; b++) {
+        cumulative += buckets[b];
+        if (cumulative >= target) {
+            if (MessageBus::LATENCY_BUCKET_LIMITS_US[b] < totals.max_us) {
+                totals.p99_us = MessageBus::LATENCY_BUCKET_LIMITS_US[b];
+            }
+            break;
+        }
+    }
+    return totals;
+}
+
+static std::string results_json(const char* path, uint64_t session_us, uint64_t host_us,
+                                 uint32_t rejected, const LatencyTotals& latency) {
+    std::ostringstream out;
+    out << "{\n  \"suite\": \"replay\",\n  \"recording\": \"" << path << "\""
+        << ",\n  \"messages\": " << recording.size()
+        << ",\n  \"rejected\": " << rejected
+        << ",\n  \"session_us\": " << session_us
+        << ",\n  \"host_us\": " << host_us
+        << ",\n  \"passes\": " << passes
+        << ",\n  \"tasks\": [\n";
+    for (size_t i = 0; i < task_totals.size(); i++) {
+        const TaskTotals& t = task_totals[i];
+        out << "    {\"name\": \"" << t.name << "\", \"runs\": " << t.runs_seen
+            << ", \"total_us\": " << t.total_us << ", \"max_us\": " << t.max_us
+            << ", \"overruns\": " << t.overruns << "}" << (i + 1 < task_totals.size() ? "," : "") << "\n";
+    }
+    out << "  ],\n  \"queue\": {\"peak_depth\": " << queue_depth_peak
+        << ", \"mean_depth\": " << (queue_depth_samples ? (double)queue_depth_sum / queue_depth_samples : 0.0)
+        << ", \"lane_peak_depth\": " << g_message_bus.getQueuePeakDepth()
+        << ", \"overflows\": " << g_message_bus.getQueueOverflows() << "}"
+        << ",\n  \"latency\": {\"ids\": " << latency.ids << ", \"samples\": " << latency.samples
+        << ", \"mean_us\": " << (latency.samples ? (double)latency.total_us / latency.samples : 0.0)
+        << ", \"p99_us\": " << latency.p99_us << ", \"max_us\": " << latency.max_us << "}\n}\n";
+    return out.str();
+}
+
+static void print_summary(uint64_t session_us, uint64_t host_us, const LatencyTotals& latency) {
+    std::cout << "\n=== Replay: " << recording.size() << " messages, "
+              << session_us / 1000 << " ms session in " << host_us / 1000 << " ms host ===" << std::endl;
+    for (size_t i = 0; i < task_totals.size(); i++) {
+        const TaskTotals& t = task_totals[i];
+        std::cout << "  " << t.name << ": " << t.runs_seen << " runs, " << t.total_us << " us total, "
+                  << t.max_us << " us max, " << t.overruns << " overruns" << std::endl;
+    }
+    std::cout << "  queue: peak " << queue_depth_peak << ", lane peak " << g_message_bus.getQueuePeakDepth()
+              << ", overflows " << g_message_bus.getQueueOverflows() << std::endl;
+    std::cout << "  latency: " << latency.samples << " deliveries, p99 " << latency.p99_us
+              << " us, max " << latency.max_us << " us" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    const char* recording_path = NULL;
+    const char* output_path = NULL;
+    uint32_t pass_us = DEFAULT_PASS_US;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--pass-us") == 0 && i + 1 < argc) {
+            pass_us = (uint32_t)atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && recording_path == NULL) {
+            recording_path = argv[i];
+        } else {
+            recording_path = NULL;
+            break;
+        }
+    }
+    if (recording_path == NULL || pass_us == 0) {
+        std::cerr << "usage: " << argv[0] << " RECORDING [--output FILE] [--pass-us N]" << std::endl;
+        return 2;
+    }
+    if (!load_recording(recording_path)) {
+        std::cerr << "replay: nothing to replay in " << recording_path << std::endl;
+        return 1;
+    }
+
+    mock_reset_all();
+    mock_set_micros(START_US);
+    mock_set_millis(START_US / 1000);
+    MainApplication app;
+    app.init();
+
+    // Finish the deferred boot stages before measuring, so every comms
+    // task is in the table
+    for (int i = 0; i < BOOT_SEQUENCE_MAX_STAGES + 1 && !boot_sequence_is_complete(); i++) {
+        app.run();
+    }
+
+    task_executive_set_duration_clock_for_testing(host_clock_us);
+    task_executive_reset_loop_stats();
+    g_message_bus.resetStatistics();
+    g_message_bus.setProfilingEnabled(true);
+    g_message_bus.resetProfiling();
+    for (uint8_t i = 0; i < task_executive_get_task_count(); i++) {
+        const task_t* task = task_executive_get_task(i);
+        TaskTotals totals = {task->name, task->runs, 0, 0, 0};
+        task_totals.push_back(totals);
+    }
+
+    // Stamps are unwrapped like EcuReplay: forward by the 32-bit
+    // difference, a step back plays at once
+    uint32_t rejected = 0;
+    uint32_t previous_stamp = recording[0].timestamp_us;
+    uint64_t session_us = 0;
+    uint32_t start_host_us = host_clock_us();
+    for (size_t i = 0; i < recording.size(); i++) {
+        const CANMessage& msg = recording[i];
+        int32_t delta = (int32_t)(msg.timestamp_us - previous_stamp);
+        previous_stamp = msg.timestamp_us;
+        if (delta > 0) {
+            session_us += (uint64_t)delta;
+            run_until(app, micros() + (uint32_t)delta, pass_us);
+        }
+        if (!g_message_bus.publish(msg.id, msg.buf, msg.len)) {
+            rejected++;
+        }
+    }
+    run_until(app, micros() + DRAIN_US, pass_us);
+    uint64_t host_us = host_clock_us() - start_host_us;
+    task_executive_set_duration_clock_for_testing(nullptr);
+
+    LatencyTotals latency = collect_latency();
+    std::string json = results_json(recording_path, session_us, host_us, rejected, latency);
+    if (output_path) {
+        std::ofstream out(output_path);
+        out << json;
+    }
+    print_summary(session_us, host_us, latency);
+    return 0;
+}
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <cstring>
 
 // Include mock Arduino before any ECU code
 #include "../mock_arduino.h"
@@ -15,6 +16,9 @@
 #include "../../msg_definitions.h"
 #include "../../msg_bus.h"
 #include "../../input_manager.h"
+#include "../../task_executive.h"
+#include "../../boot_sequence.h"
+#include "../../parameter_registry.h"
 
 // Include storage manager for custom_canbus_manager
 #include "../../storage_manager.h"
@@ -199,6 +203,65 @@ TEST(performance_characteristics) {
     assert(last_loop_time >= 0);  // Should be non-negative
 }
 
+// Test that boot reaches engine-ready with the control tasks and finishes
+// the deferred stages from the main loop
+TEST(staged_boot) {
+    test_setup();
+    
+    MainApplication app;
+    app.init();
+    
+    // Safe outputs first, config before anything that reads it
+    assert(boot_sequence_get_stage_count() > 0);
+    assert(strcmp(boot_sequence_get_stage(0)->name, "outputs_safe") == 0);
+    assert(!boot_sequence_get_stage(0)->deferred);
+    assert(!boot_sequence_is_complete());
+    uint8_t ready_task_count = task_executive_get_task_count();
+    
+    for (int i = 0; i < BOOT_SEQUENCE_MAX_STAGES + 1 && !boot_sequence_is_complete(); i++) {
+        mock_advance_time_us(1000);
+        app.run();
+    }
+    assert(boot_sequence_is_complete());
+    assert(boot_sequence_get_complete_us() >= boot_sequence_get_ready_us());
+    for (uint8_t i = 0; i < boot_sequence_get_stage_count(); i++) {
+        assert(boot_sequence_get_stage(i)->done);
+    }
+    
+    // Comms tasks were added by their stages
+    assert(task_executive_get_task_count() > ready_task_count);
+}
+
+// Map range handlers answer on the cell, bin and commit IDs only; other
+// IDs in the map subsystems still fail lookup
+TEST(map_parameter_ranges) {
+    test_setup();
+    
+    MainApplication app;
+    app.init();
+    for (int i = 0; i < BOOT_SEQUENCE_MAX_STAGES + 1 && !boot_sequence_is_complete(); i++) {
+        mock_advance_time_us(1000);
+        app.run();
+    }
+    
+    const ParameterRangeHandler* range = ParameterRegistry::find_range_handler(MSG_FUEL_MAP_CELL(2, 3));
+    assert(range != nullptr && strcmp(range->description, "Fuel Map") == 0);
+    assert(ParameterRegistry::find_range_handler(MSG_IGNITION_MAP_X_BIN(0)) != nullptr);
+    assert(ParameterRegistry::find_range_handler(MSG_BOOST_MAP_Y_BIN(1)) != nullptr);
+    assert(ParameterRegistry::find_range_handler(MSG_BOOST_MAP_REVERT) != nullptr);
+    
+    const uint32_t non_map_ids[] = {
+        MSG_FUEL_PUMP_CONTROL,
+        MSG_FUEL_MAP_BLOB,
+        MSG_IGNITION_MAP_CELL(0x40, 0),
+        MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_BOOST, 0x8000)
+    };
+    for (uint8_t i = 0; i < sizeof(non_map_ids) / sizeof(non_map_ids[0]); i++) {
+        assert(ParameterRegistry::find_handler(non_map_ids[i]) == nullptr);
+        assert(ParameterRegistry::find_range_handler(non_map_ids[i]) == nullptr);
+    }
+}
+
 // Test system status reporting
 TEST(status_reporting) {
     test_setup();
@@ -215,8 +278,15 @@ TEST(status_reporting) {
         app.run();
     }
     
-    // Check that statistics are being tracked
-    assert(app.getLoopCount() == 10);
+    // Check that statistics are being tracked: one loop in each 1 s window,
+    // and the count restarts with every window
+    assert(app.getLoopsPerSecond() == 1);
+    assert(app.getLoopCount() == 0);
+    for (int i = 0; i < 5; i++) {
+        mock_advance_time_ms(1);
+        app.run();
+    }
+    assert(app.getLoopCount() == 5);
     
     // System health checks (module-agnostic)
     assert(input_manager_get_sensor_count() == sensor_count);  // Count should be stable
@@ -245,6 +315,8 @@ int main() {
     run_test_sensor_integration();
     run_test_message_bus_integration();
     run_test_performance_characteristics();
+    run_test_staged_boot();
+    run_test_map_parameter_ranges();
     run_test_status_reporting();
     
     // Print results
@@ -0,0 +1,267 @@
+// tests/map_tables/test_map_tables.cpp
+// Test suite for the RAM map tables and interpolation engine
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+// Include enhanced mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../storage_manager.h"
+#include "../../spi_flash_storage_backend.h"
+#include "../../map_tables.h"
+
+// Simple test framework
+int tests_run = 0;
+int tests_passed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        std::cout << "  Running test: " #name "... "; \
+        tests_run++; \
+        test_##name(); \
+        tests_passed++; \
+        std::cout << "PASSED" << std::endl; \
+    } \
+    void test_##name()
+
+static bool near(float a, float b) {
+    return fabsf(a - b) < 0.001f;
+}
+
+TEST(axis_rejects_invalid_bins) {
+    table_axis_t axis = {};
+    const float good[] = {0.0f, 10.0f, 20.0f};
+    const float flat[] = {0.0f, 10.0f, 10.0f};
+    assert(table_axis_set(&axis, good, 3));
+    assert(!table_axis_set(&axis, flat, 3));
+    assert(!table_axis_set(&axis, good, 1));
+    // Failed sets leave the axis alone
+    assert(axis.size == 3);
+    assert(axis.bins[2] == 20.0f);
+}
+
+TEST(axis_find_uses_and_moves_hint) {
+    table_axis_t axis = {};
+    const float bins[] = {0.0f, 10.0f, 20.0f, 30.0f, 40.0f, 50.0f};
+    table_axis_set(&axis, bins, 6);
+
+    float f;
+    assert(table_axis_find(&axis, 25.0f, &f) == 2 && near(f, 0.5f));
+    assert(axis.hint == 2);
+    // Neighbour cells either side of the hint
+    assert(table_axis_find(&axis, 31.0f, &f) == 3 && near(f, 0.1f));
+    assert(table_axis_find(&axis, 29.0f, &f) == 2 && near(f, 0.9f));
+    // Long jumps fall back to the search
+    assert(table_axis_find(&axis, 5.0f, &f) == 0 && near(f, 0.5f));
+    assert(table_axis_find(&axis, 45.0f, &f) == 4 && near(f, 0.5f));
+    // Exactly on a bin resolves to the cell it starts
+    assert(table_axis_find(&axis, 20.0f, &f) == 2 && near(f, 0.0f));
+    // A stale hint past the end of a shrunk axis is clamped
+    axis.hint = 200;
+    assert(table_axis_find(&axis, 15.0f, &f) == 1 && near(f, 0.5f));
+}
+
+TEST(axis_find_clamps_to_edges) {
+    table_axis_t axis = {};
+    const float bins[] = {100.0f, 200.0f, 300.0f};
+    table_axis_set(&axis, bins, 3);
+
+    float f;
+    assert(table_axis_find(&axis, -50.0f, &f) == 0 && f == 0.0f);
+    assert(table_axis_find(&axis, 900.0f, &f) == 1 && f == 1.0f);
+    assert(table_axis_find(&axis, NAN, &f) == 0 && f == 0.0f);
+}
+
+TEST(table_2d_interpolates) {
+    static float values[] = {0.0f, 100.0f, 50.0f};
+    table_2d_t curve = {};
+    const float bins[] = {0.0f, 1.0f, 3.0f};
+    table_axis_set(&curve.x, bins, 3);
+    curve.values = values;
+
+    assert(near(table_2d_lookup(&curve, 0.25f), 25.0f));
+    assert(near(table_2d_lookup(&curve, 2.0f), 75.0f));
+    assert(near(table_2d_lookup(&curve, 10.0f), 50.0f));
+}
+
+TEST(table_3d_bilinear) {
+    static float cells[3 * 3] = {
+        0.0f,  10.0f, 20.0f,     // row 0
+        100.0f, 110.0f, 120.0f,  // row 1
+        200.0f, 210.0f, 220.0f   // row 2
+    };
+    table_3d_t map = {};
+    const float x_bins[] = {1000.0f, 2000.0f, 3000.0f};
+    const float y_bins[] = {20.0f, 60.0f, 100.0f};
+    table_axis_set(&map.x, x_bins, 3);
+    table_axis_set(&map.y, y_bins, 3);
+    map.cells = cells;
+
+    assert(near(table_3d_lookup(&map, 1000.0f, 20.0f), 0.0f));
+    assert(near(table_3d_lookup(&map, 1500.0f, 40.0f), 55.0f));
+    assert(near(table_3d_lookup(&map, 2500.0f, 80.0f), 165.0f));
+    // Clamped on both axes
+    assert(near(table_3d_lookup(&map, 9000.0f, 0.0f), 20.0f));
+    assert(near(table_3d_lookup(&map, 0.0f, 500.0f), 200.0f));
+
+    assert(table_3d_get_cell(&map, 1, 2) == 120.0f);
+    assert(table_3d_set_cell(&map, 1, 2, 125.0f));
+    assert(!table_3d_set_cell(&map, 3, 0, 1.0f));
+    assert(near(table_3d_lookup(&map, 3000.0f, 60.0f), 125.0f));
+}
+
+TEST(ecu_tables_defaults_and_load) {
+    g_message_bus.init();
+    SPIFlashStorageBackend backend;
+    StorageManager storage(&backend);
+    storage.init();
+
+    map_tables_init();
+    table_3d_t* fuel = map_table_get(MAP_TABLE_FUEL);
+    table_3d_t* boost = map_table_get(MAP_TABLE_BOOST);
+    assert(fuel->x.size == FUEL_MAP_COLS && fuel->y.size == FUEL_MAP_ROWS);
+    assert(boost->x.size == BOOST_MAP_COLS && boost->y.size == BOOST_MAP_ROWS);
+    assert(near(table_3d_lookup(fuel, 3000.0f, 100.0f), 50.0f));
+
+    // One stored cell and a stored ignition axis
+    float ve = 80.0f;
+    assert(storage.save_data(MSG_FUEL_MAP_CELL(2, 3), &ve, sizeof(ve)));
+    float bins[IGNITION_MAP_COLS];
+    for (uint8_t i = 0; i < IGNITION_MAP_COLS; i++) {
+        bins[i] = 1000.0f + 200.0f * i;
+        assert(storage.save_data(MSG_IGNITION_MAP_X_BIN(i), &bins[i], sizeof(float)));
+    }
+
+    uint16_t loaded = map_tables_load(&storage);
+    assert(loaded == 1 + IGNITION_MAP_COLS);
+    fuel = map_table_get(MAP_TABLE_FUEL);
+    table_3d_t* ignition = map_table_get(MAP_TABLE_IGNITION);
+    assert(table_3d_get_cell(fuel, 2, 3) == 80.0f);
+    assert(ignition->x.bins[0] == 1000.0f);
+    assert(ignition->x.bins[IGNITION_MAP_COLS - 1] == bins[IGNITION_MAP_COLS - 1]);
+
+    // Lookup on the loaded cell's corner returns it exactly
+    float rpm = fuel->x.bins[3];
+    float kpa = fuel->y.bins[2];
+    assert(near(table_3d_lookup(fuel, rpm, kpa), 80.0f));
+}
+
+TEST(staged_edits_invisible_until_commit) {
+    map_tables_init();
+    table_3d_t* before = map_table_get(MAP_TABLE_FUEL);
+
+    assert(map_table_stage_cell(MAP_TABLE_FUEL, 4, 5, 72.0f));
+    assert(!map_table_stage_cell(MAP_TABLE_FUEL, FUEL_MAP_ROWS, 0, 1.0f));
+    assert(map_table_get_staged_count(MAP_TABLE_FUEL) == 1);
+    assert(map_table_get_staged_cell(MAP_TABLE_FUEL, 4, 5) == 72.0f);
+
+    // Lookups still see the active table
+    assert(map_table_get(MAP_TABLE_FUEL) == before);
+    assert(table_3d_get_cell(before, 4, 5) == 50.0f);
+
+    assert(map_table_commit(MAP_TABLE_FUEL));
+    table_3d_t* after = map_table_get(MAP_TABLE_FUEL);
+    assert(after != before);
+    assert(table_3d_get_cell(after, 4, 5) == 72.0f);
+    assert(map_table_get_staged_count(MAP_TABLE_FUEL) == 0);
+    assert(map_tables_get_commit_count() == 1);
+
+    // The next edit starts from the committed table, not the old buffer
+    assert(map_table_stage_cell(MAP_TABLE_FUEL, 0, 0, 40.0f));
+    assert(map_table_get_staged_cell(MAP_TABLE_FUEL, 4, 5) == 72.0f);
+    assert(map_table_commit(MAP_TABLE_FUEL));
+    assert(map_table_get(MAP_TABLE_FUEL) == before);
+    assert(table_3d_get_cell(before, 4, 5) == 72.0f);
+    assert(table_3d_get_cell(before, 0, 0) == 40.0f);
+}
+
+TEST(revert_and_invalid_axis_commit) {
+    map_tables_init();
+    table_3d_t* active = map_table_get(MAP_TABLE_IGNITION);
+
+    assert(map_table_stage_cell(MAP_TABLE_IGNITION, 1, 1, 30.0f));
+    map_table_revert(MAP_TABLE_IGNITION);
+    assert(map_table_get_staged_count(MAP_TABLE_IGNITION) == 0);
+    assert(map_table_get_staged_cell(MAP_TABLE_IGNITION, 1, 1) == 10.0f);
+    assert(map_table_commit(MAP_TABLE_IGNITION));
+    assert(map_table_get(MAP_TABLE_IGNITION) == active);
+
+    // An out-of-order axis is refused and stays staged for correction
+    float second_bin = active->x.bins[1];
+    assert(map_table_stage_axis_bin(MAP_TABLE_IGNITION, MAP_AXIS_X_ROW, 1, 100.0f));
+    assert(!map_table_commit(MAP_TABLE_IGNITION));
+    assert(map_table_get(MAP_TABLE_IGNITION) == active);
+    assert(map_table_get_staged_count(MAP_TABLE_IGNITION) == 1);
+
+    assert(map_table_stage_axis_bin(MAP_TABLE_IGNITION, MAP_AXIS_X_ROW, 1, second_bin + 50.0f));
+    assert(map_table_commit(MAP_TABLE_IGNITION));
+    table_3d_t* committed = map_table_get(MAP_TABLE_IGNITION);
+    assert(committed->x.bins[1] == second_bin + 50.0f);
+    float expected = 1.0f / (committed->x.bins[2] - committed->x.bins[1]);
+    assert(near(committed->x.inv_width[1], expected));
+}
+
+TEST(parameter_ids_stage_commit_and_persist_blob) {
+    g_message_bus.init();
+    SPIFlashStorageBackend backend;
+    StorageManager storage(&backend);
+    storage.init();
+
+    map_tables_init();
+    map_tables_load(&storage);
+
+    assert(map_tables_write_parameter(MSG_BOOST_MAP_CELL(3, 7), 180.0f));
+    assert(map_tables_write_parameter(MSG_BOOST_MAP_Y_BIN(0), -5.0f));
+    assert(map_tables_read_parameter(MSG_BOOST_MAP_CELL(3, 7)) == 180.0f);
+    assert(map_tables_read_parameter(MSG_BOOST_MAP_COMMIT) == 2.0f);
+    assert(table_3d_get_cell(map_table_get(MAP_TABLE_BOOST), 3, 7) == 100.0f);
+    assert(!map_tables_write_parameter(MSG_BOOST_MAP_CELL(BOOST_MAP_ROWS, 0), 1.0f));
+
+    assert(map_tables_write_parameter(MSG_BOOST_MAP_COMMIT, 0.0f));
+    assert(table_3d_get_cell(map_table_get(MAP_TABLE_BOOST), 3, 7) == 180.0f);
+
+    // Nothing is written until the main loop runs the persist
+    uint32_t persisted = map_tables_get_persist_count();
+    map_tables_update();
+    assert(map_tables_get_persist_count() == persisted + 1);
+    map_tables_update();
+    assert(map_tables_get_persist_count() == persisted + 1);
+
+    // A fresh load picks the blob up in one read
+    map_tables_init();
+    uint16_t loaded = map_tables_load(&storage);
+    assert(loaded == BOOST_MAP_COLS + BOOST_MAP_ROWS + BOOST_MAP_COLS * BOOST_MAP_ROWS);
+    table_3d_t* boost = map_table_get(MAP_TABLE_BOOST);
+    assert(table_3d_get_cell(boost, 3, 7) == 180.0f);
+    assert(boost->y.bins[0] == -5.0f);
+}
+
+int main() {
+    std::cout << "=== Map Table Tests ===" << std::endl;
+
+    run_test_axis_rejects_invalid_bins();
+    run_test_axis_find_uses_and_moves_hint();
+    run_test_axis_find_clamps_to_edges();
+    run_test_table_2d_interpolates();
+    run_test_table_3d_bilinear();
+    run_test_ecu_tables_defaults_and_load();
+    run_test_staged_edits_invisible_until_commit();
+    run_test_revert_and_invalid_axis_commit();
+    run_test_parameter_ids_stage_commit_and_persist_blob();
+
+    std::cout << std::endl;
+    std::cout << "Map Table Tests - Run: " << tests_run << ", Passed: " << tests_passed << std::endl;
+
+    if (tests_passed == tests_run) {
+        std::cout << "✅ ALL MAP TABLE TESTS PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME MAP TABLE TESTS FAILED!" << std::endl;
+        return 1;
+    }
+}
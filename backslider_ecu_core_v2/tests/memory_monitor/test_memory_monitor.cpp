@@ -0,0 +1,172 @@
+// tests/memory_monitor/test_memory_monitor.cpp
+// Test suite for stack painting, heap statistics and memory publishing
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <map>
+
+// Include enhanced mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../memory_monitor.h"
+
+// Simple test framework
+int tests_run = 0;
+int tests_passed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        std::cout << "  Running test: " #name "... "; \
+        tests_run++; \
+        test_##name(); \
+        tests_passed++; \
+        std::cout << "PASSED" << std::endl; \
+    } \
+    void test_##name()
+
+static const uint32_t STACK_WORDS = 8192;
+static const uint32_t PAINTED_WORDS = 8000;     // The rest was in use at init
+static uint32_t fake_stack[STACK_WORDS];
+
+static std::map<uint32_t, float> received;
+
+static void record_message(const CANMessage* msg) {
+    received[msg->id] = MSG_UNPACK_FLOAT(msg);
+}
+
+static void setup(void) {
+    mock_reset_all();
+    g_message_bus.init();
+    received.clear();
+    memory_monitor_init();
+    memory_monitor_set_stack_for_testing(fake_stack, STACK_WORDS, PAINTED_WORDS);
+}
+
+// Simulate a call chain reaching down to a word index
+static void touch_stack_down_to(uint32_t word) {
+    for (uint32_t i = word; i < PAINTED_WORDS; i++) {
+        fake_stack[i] = i;
+    }
+}
+
+// Test that an untouched painted stack reports only what was in use at init
+TEST(fresh_stack) {
+    setup();
+    memory_monitor_scan_stack_for_testing();
+    const memory_monitor_stats_t* stats = memory_monitor_get_stats();
+    assert(stats->stack_size_bytes == STACK_WORDS * 4);
+    assert(stats->stack_high_water_bytes == (STACK_WORDS - PAINTED_WORDS) * 4);
+    assert(stats->stack_free_bytes == PAINTED_WORDS * 4);
+}
+
+// Test that the high-water mark follows the deepest use and never rises
+TEST(high_water_only_moves_down) {
+    setup();
+    touch_stack_down_to(6000);
+    memory_monitor_scan_stack_for_testing();
+    assert(memory_monitor_get_stats()->stack_free_bytes == 6000 * 4);
+    assert(memory_monitor_get_stats()->stack_high_water_bytes == (STACK_WORDS - 6000) * 4);
+
+    // Deeper, with a hole the frame never wrote: the lowest word counts
+    fake_stack[3000] = 1;
+    memory_monitor_scan_stack_for_testing();
+    assert(memory_monitor_get_stats()->stack_free_bytes == 3000 * 4);
+
+    // Shallower use afterwards changes nothing
+    for (uint32_t i = 0; i < PAINTED_WORDS; i++) {
+        fake_stack[i] = MEMORY_MONITOR_PAINT_WORD;
+    }
+    memory_monitor_scan_stack_for_testing();
+    assert(memory_monitor_get_stats()->stack_free_bytes == 3000 * 4);
+}
+
+// Test that update() spreads a pass over several calls
+TEST(scan_is_sliced) {
+    setup();
+    touch_stack_down_to(5000);
+    uint32_t calls = 0;
+    while (memory_monitor_get_stats()->stack_free_bytes != 5000 * 4) {
+        memory_monitor_update();
+        calls++;
+        assert(calls < 10);
+    }
+    assert(calls == (5000 + MEMORY_MONITOR_SCAN_WORDS) / MEMORY_MONITOR_SCAN_WORDS);
+}
+
+// Test heap figures and the fragmentation measure
+TEST(heap_statistics) {
+    setup();
+    // 100K heap, 40K claimed from sbrk, 30K in use: 10K trapped, 60K above the break
+    memory_monitor_set_heap_for_testing(100000, 40000, 30000, 5);
+    const memory_monitor_stats_t* stats = memory_monitor_get_stats();
+    assert(stats->heap_high_water_bytes == 40000);
+    assert(stats->heap_in_use_bytes == 30000);
+    assert(stats->heap_free_bytes == 70000);
+    assert(stats->heap_free_chunks == 5);
+    assert(std::fabs(stats->heap_fragmentation_percent - 10000.0f * 100.0f / 70000.0f) < 0.01f);
+
+    // Arena fully used: nothing trapped
+    memory_monitor_set_heap_for_testing(100000, 40000, 40000, 0);
+    assert(stats->heap_fragmentation_percent == 0.0f);
+
+    // Heap exhausted to the end with holes: all free memory is fragmented
+    memory_monitor_set_heap_for_testing(100000, 100000, 90000, 12);
+    assert(stats->heap_fragmentation_percent == 100.0f);
+}
+
+// Test that the figures are published once per interval
+TEST(publishes_on_interval) {
+    setup();
+    g_message_bus.subscribe(MSG_MEM_STACK_HIGH_WATER, record_message);
+    g_message_bus.subscribe(MSG_MEM_STACK_FREE, record_message);
+    g_message_bus.subscribe(MSG_MEM_HEAP_IN_USE, record_message);
+    g_message_bus.subscribe(MSG_MEM_HEAP_FRAGMENTATION, record_message);
+    memory_monitor_set_heap_for_testing(100000, 40000, 30000, 5);
+    touch_stack_down_to(7000);
+
+    for (int i = 0; i < 4; i++) {       // Enough slices to reach the mark
+        memory_monitor_update();
+    }
+    g_message_bus.process();
+    assert(received.empty());
+
+    mock_advance_time_us(MEMORY_MONITOR_PUBLISH_US);
+    memory_monitor_update();
+    g_message_bus.process();
+    assert(received.size() == 4);
+    assert(received[MSG_MEM_STACK_FREE] == 7000.0f * 4);
+    assert(received[MSG_MEM_STACK_HIGH_WATER] == (STACK_WORDS - 7000) * 4.0f);
+    assert(received[MSG_MEM_HEAP_IN_USE] == 30000.0f);
+
+    received.clear();
+    mock_advance_time_us(MEMORY_MONITOR_PUBLISH_US / 2);
+    memory_monitor_update();
+    g_message_bus.process();
+    assert(received.empty());
+}
+
+// Main test runner
+int main() {
+    std::cout << "=== Memory Monitor Tests ===" << std::endl;
+
+    run_test_fresh_stack();
+    run_test_high_water_only_moves_down();
+    run_test_scan_is_sliced();
+    run_test_heap_statistics();
+    run_test_publishes_on_interval();
+
+    std::cout << std::endl;
+    std::cout << "Memory Monitor Tests - Run: " << tests_run << ", Passed: " << tests_passed << std::endl;
+
+    if (tests_passed == tests_run) {
+        std::cout << "✅ ALL MEMORY MONITOR TESTS PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME TESTS FAILED!" << std::endl;
+        return 1;
+    }
+}
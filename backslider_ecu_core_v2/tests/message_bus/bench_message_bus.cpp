@@ -0,0 +1,406 @@
+// tests/message_bus/bench_message_bus.cpp
+// Desktop microbenchmarks for the message bus
+//
+// Measures the hot paths of msg_bus.cpp on the host so throughput regressions
+// are caught before a change reaches the car:
+//   - publish() / process() cost per message
+//   - dispatch cost versus number of subscribed IDs and handler fan-out
+//   - behaviour and cost of publishing into a full lane
+//   - cost of the global broadcast handler and masked subscriptions
+//
+// Results are written as JSON (stdout, or --output FILE). Passing
+// --baseline FILE compares against a previous run and exits non-zero if any
+// benchmark is slower than the baseline by more than --tolerance percent.
+//
+// Usage:
+//   make bench-msg-bus
+//   ./message_bus/bench_message_bus --output bench.json
+//   ./message_bus/bench_message_bus --baseline bench.json --tolerance 25
+//
+// Absolute numbers depend on the host; compare only runs from the same machine.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+// Include mock Arduino before any ECU code (Serial and the clock are
+// defined in mock_arduino.cpp)
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+
+// Benchmark parameters
+static const int BATCH_SIZE = 100;        // Messages per timed batch (fits one lane)
+static const int DEFAULT_ROUNDS = 2000;   // Timed batches per benchmark
+static const int REPEATS = 5;             // Best-of repeats to reject scheduler noise
+
+struct BenchResult {
+    std::string name;
+    double ns_per_op;
+    uint32_t ops;
+};
+
+static std::vector<BenchResult> results;
+static int rounds = DEFAULT_ROUNDS;
+
+// Sink so the compiler cannot discard handler work
+static volatile uint32_t handler_sink = 0;
+
+static void counting_handler(const CANMessage* msg) {
+    handler_sink = handler_sink + msg->buf[0];
+}
+
+static void broadcast_handler(const CANMessage* msg) {
+    handler_sink = handler_sink + msg->len;
+}
+
+typedef std::chrono::steady_clock bench_clock;
+
+static inline double elapsed_ns(bench_clock::time_point start) {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start).count();
+}
+
+static void record(const char* name, double best_ns_per_op, uint32_t ops) {
+    BenchResult r;
+    r.name = name;
+    r.ns_per_op = best_ns_per_op;
+    r.ops = ops;
+    results.push_back(r);
+}
+
+// Distinct extended IDs for subscriber scaling
+static uint32_t bench_id(uint16_t index) {
+    return MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, 0x100 + index);
+}
+
+// Fill one lane with a batch of 8-byte frames for a single ID
+static void queue_batch(MessageBus& bus, uint32_t msg_id) {
+    uint8_t payload[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    for (int i = 0; i < BATCH_SIZE; i++) {
+        bus.publish(msg_id, payload, sizeof(payload));
+    }
+}
+
+// Time only publish(); the lane is drained outside the timed region
+static void bench_publish(const char* name, uint8_t length) {
+    MessageBus bus;
+    bus.init();
+    bus.subscribe(MSG_ENGINE_RPM, counting_handler);
+    uint8_t payload[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    double best = 1e30;
+    for (int rep = 0; rep < REPEATS; rep++) {
+        double total = 0;
+        for (int r = 0; r < rounds; r++) {
+            bench_clock::time_point start = bench_clock::now();
+            for (int i = 0; i < BATCH_SIZE; i++) {
+                bus.publish(MSG_ENGINE_RPM, payload, length);
+            }
+            total += elapsed_ns(start);
+            bus.process();
+        }
+        double per_op = total / ((double)rounds * BATCH_SIZE);
+        if (per_op < best) best = per_op;
+    }
+    record(name, best, (uint32_t)rounds * BATCH_SIZE);
+}
+
+// Time only process() for a full batch delivered to one handler per message
+static void bench_process(const char* name, uint16_t extra_ids, uint16_t fanout) {
+    MessageBus bus;
+    bus.init();
+    for (uint16_t i = 0; i < extra_ids; i++) {
+        bus.subscribe(bench_id(i), counting_handler);
+    }
+    for (uint16_t i = 0; i < fanout; i++) {
+        bus.subscribe(MSG_ENGINE_RPM, counting_handler);
+    }
+
+    double best = 1e30;
+    for (int rep = 0; rep < REPEATS; rep++) {
+        double total = 0;
+        for (int r = 0; r < rounds; r++) {
+            queue_batch(bus, MSG_ENGINE_RPM);
+            bench_clock::time_point start = bench_clock::now();
+            bus.process();
+            total += elapsed_ns(start);
+        }
+        double per_op = total / ((double)rounds * BATCH_SIZE);
+        if (per_op < best) best = per_op;
+    }
+    record(name, best, (uint32_t)rounds * BATCH_SIZE);
+}
+
+// publish() + process() for a stream of messages spread over many IDs
+static void bench_round_trip(const char* name, uint16_t id_count) {
+    MessageBus bus;
+    bus.init();
+    for (uint16_t i = 0; i < id_count; i++) {
+        bus.subscribe(bench_id(i), counting_handler);
+    }
+    uint8_t payload[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    double best = 1e30;
+    for (int rep = 0; rep < REPEATS; rep++) {
+        bench_clock::time_point start = bench_clock::now();
+        for (int r = 0; r < rounds; r++) {
+            for (int i = 0; i < BATCH_SIZE; i++) {
+                bus.publish(bench_id(i % id_count), payload, sizeof(payload));
+            }
+            bus.process();
+        }
+        double per_op = elapsed_ns(start) / ((double)rounds * BATCH_SIZE);
+        if (per_op < best) best = per_op;
+    }
+    record(name, best, (uint32_t)rounds * BATCH_SIZE);
+}
+
+// Cost of a rejected publish once the lane is full, and overflow accounting
+static bool bench_overflow() {
+    MessageBus bus;
+    bus.init();
+    uint8_t payload[8] = {0};
+
+    for (uint16_t i = 0; i < MessageBus::INTERNAL_QUEUE_SIZE; i++) {
+        bus.publish(MSG_ENGINE_RPM, payload, sizeof(payload));
+    }
+    if (!bus.isQueueFull()) {
+        std::cerr << "overflow benchmark: lane did not fill" << std::endl;
+        return false;
+    }
+    uint32_t overflows_before = bus.getQueueOverflows();
+    uint32_t lane_overflows_before = bus.getLaneOverflows(MSG_PRIORITY_CRITICAL);
+
+    double best = 1e30;
+    for (int rep = 0; rep < REPEATS; rep++) {
+        bench_clock::time_point start = bench_clock::now();
+        for (int r = 0; r < rounds; r++) {
+            for (int i = 0; i < BATCH_SIZE; i++) {
+                bus.publish(MSG_ENGINE_RPM, payload, sizeof(payload));
+            }
+        }
+        double per_op = elapsed_ns(start) / ((double)rounds * BATCH_SIZE);
+        if (per_op < best) best = per_op;
+    }
+    record("publish_overflow_reject", best, (uint32_t)rounds * BATCH_SIZE);
+
+    // A full critical lane must not block other lanes, and every rejected
+    // publish must be counted exactly once
+    uint32_t expected = (uint32_t)REPEATS * rounds * BATCH_SIZE;
+    bool ok = bus.getQueueOverflows() - overflows_before == expected &&
+              bus.getLaneOverflows(MSG_PRIORITY_CRITICAL) - lane_overflows_before == expected &&
+              bus.publish(MSG_STORAGE_SAVE, payload, sizeof(payload));
+    if (!ok) {
+        std::cerr << "overflow benchmark: overflow accounting mismatch" << std::endl;
+    }
+    return ok;
+}
+
+// Global broadcast handler and masked wildcard handler overhead
+static void bench_broadcast(const char* name, bool legacy_global, bool masked_wildcard) {
+    MessageBus bus;
+    bus.init();
+    bus.subscribe(MSG_ENGINE_RPM, counting_handler);
+    if (legacy_global) {
+        MessageBus::setGlobalBroadcastHandler(broadcast_handler);
+    }
+    if (masked_wildcard) {
+        bus.subscribeMasked(0, 0, broadcast_handler, sizeof(parameter_msg_t));
+    }
+
+    double best = 1e30;
+    for (int rep = 0; rep < REPEATS; rep++) {
+        double total = 0;
+        for (int r = 0; r < rounds; r++) {
+            queue_batch(bus, MSG_ENGINE_RPM);
+            bench_clock::time_point start = bench_clock::now();
+            bus.process();
+            total += elapsed_ns(start);
+        }
+        double per_op = total / ((double)rounds * BATCH_SIZE);
+        if (per_op < best) best = per_op;
+    }
+    MessageBus::clearGlobalBroadcastHandler();
+    record(name, best, (uint32_t)rounds * BATCH_SIZE);
+}
+
+// Coalesced typed publishes of the same ID (one queued slot, many updates)
+static void bench_coalesced_publish() {
+    MessageBus bus;
+    bus.init();
+    bus.subscribe(MSG_ENGINE_RPM, counting_handler);
+    bus.setCoalesce(MSG_ENGINE_RPM, true);
+
+    double best = 1e30;
+    for (int rep = 0; rep < REPEATS; rep++) {
+        double total = 0;
+        for (int r = 0; r < rounds; r++) {
+            bench_clock::time_point start = bench_clock::now();
+            for (int i = 0; i < BATCH_SIZE; i++) {
+                bus.publishFloat(MSG_ENGINE_RPM, (float)i);
+            }
+            total += elapsed_ns(start);
+            bus.process();
+        }
+        double per_op = total / ((double)rounds * BATCH_SIZE);
+        if (per_op < best) best = per_op;
+    }
+    record("publish_float_coalesced", best, (uint32_t)rounds * BATCH_SIZE);
+}
+
+// Interrupt-side publish; drained between batches (ring holds 32)
+static void bench_publish_from_isr() {
+    MessageBus bus;
+    bus.init();
+    bus.subscribe(MSG_ENGINE_RPM, counting_handler);
+    uint8_t payload[8] = {0};
+    const int isr_batch = MessageBus::ISR_QUEUE_SIZE;
+
+    double best = 1e30;
+    for (int rep = 0; rep < REPEATS; rep++) {
+        double total = 0;
+        for (int r = 0; r < rounds; r++) {
+            bench_clock::time_point start = bench_clock::now();
+            for (int i = 0; i < isr_batch; i++) {
+                bus.publishFromISR(MSG_ENGINE_RPM, payload, sizeof(payload));
+            }
+            total += elapsed_ns(start);
+            bus.process();
+        }
+        double per_op = total / ((double)rounds * isr_batch);
+        if (per_op < best) best = per_op;
+    }
+    record("publish_from_isr", best, (uint32_t)rounds * isr_batch);
+}
+
+// ---------------------------------------------------------------------------
+// Output and baseline comparison
+// ---------------------------------------------------------------------------
+
+static std::string results_json() {
+    std::ostringstream out;
+    out << "{\n  \"suite\": \"message_bus\",\n  \"batch_size\": " << BATCH_SIZE
+        << ",\n  \"rounds\": " << rounds << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        out << "    {\"name\": \"" << results[i].name << "\", \"ns_per_op\": " << results[i].ns_per_op
+            << ", \"ops\": " << results[i].ops << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+// Minimal reader for the format written above: finds each "name" and the
+// "ns_per_op" that follows it
+static bool load_baseline(const char* path, std::vector<BenchResult>& baseline) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+
+    size_t pos = 0;
+    while ((pos = text.find("\"name\": \"", pos)) != std::string::npos) {
+        pos += 9;
+        size_t end = text.find('"', pos);
+        size_t value = text.find("\"ns_per_op\": ", end);
+        if (end == std::string::npos || value == std::string::npos) break;
+        BenchResult r;
+        r.name = text.substr(pos, end - pos);
+        r.ns_per_op = atof(text.c_str() + value + 13);
+        r.ops = 0;
+        baseline.push_back(r);
+        pos = value;
+    }
+    return !baseline.empty();
+}
+
+static int compare_to_baseline(const std::vector<BenchResult>& baseline, double tolerance_pct) {
+    int regressions = 0;
+    for (size_t i = 0; i < results.size(); i++) {
+        for (size_t j = 0; j < baseline.size(); j++) {
+            if (baseline[j].name != results[i].name || baseline[j].ns_per_op <= 0) continue;
+            double change = (results[i].ns_per_op - baseline[j].ns_per_op) * 100.0 / baseline[j].ns_per_op;
+            bool regressed = change > tolerance_pct;
+            std::cerr << (regressed ? "REGRESSION " : "ok         ") << results[i].name
+                      << ": " << baseline[j].ns_per_op << " -> " << results[i].ns_per_op
+                      << " ns/op (" << (change >= 0 ? "+" : "") << change << "%)" << std::endl;
+            if (regressed) regressions++;
+        }
+    }
+    return regressions;
+}
+
+int main(int argc, char** argv) {
+    const char* output_path = NULL;
+    const char* baseline_path = NULL;
+    double tolerance_pct = 20.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance_pct = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = atoi(argv[++i]);
+            if (rounds < 1) rounds = 1;
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--output FILE] [--baseline FILE] [--tolerance PCT] [--rounds N]" << std::endl;
+            return 2;
+        }
+    }
+
+    bench_publish("publish_8_bytes", 8);
+    bench_publish("publish_4_bytes", 4);
+    bench_coalesced_publish();
+    bench_publish_from_isr();
+
+    bench_process("process_1_handler", 0, 1);
+    bench_process("process_1_handler_16_ids", 15, 1);
+    bench_process("process_1_handler_64_ids", 63, 1);
+    bench_process("process_1_handler_120_ids", 119, 1);
+    bench_process("process_fanout_4_handlers", 0, 4);
+    bench_process("process_fanout_16_handlers", 0, 16);
+    bench_process("process_no_subscribers", 0, 0);
+
+    bench_round_trip("round_trip_1_id", 1);
+    bench_round_trip("round_trip_32_ids", 32);
+    bench_round_trip("round_trip_100_ids", 100);
+
+    bool overflow_ok = bench_overflow();
+
+    bench_broadcast("process_with_global_broadcast", true, false);
+    bench_broadcast("process_with_masked_wildcard", false, true);
+    bench_broadcast("process_with_both_broadcast", true, true);
+
+    std::string json = results_json();
+    if (output_path) {
+        std::ofstream out(output_path);
+        out << json;
+    } else {
+        std::cout << json;
+    }
+
+    int status = overflow_ok ? 0 : 1;
+    if (baseline_path) {
+        std::vector<BenchResult> baseline;
+        if (!load_baseline(baseline_path, baseline)) {
+            std::cerr << "Could not read baseline " << baseline_path << std::endl;
+            return 2;
+        }
+        int regressions = compare_to_baseline(baseline, tolerance_pct);
+        if (regressions > 0) {
+            std::cerr << regressions << " benchmark(s) regressed by more than " << tolerance_pct << "%" << std::endl;
+            status = 1;
+        }
+    }
+    return status;
+}
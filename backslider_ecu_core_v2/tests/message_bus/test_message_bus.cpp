@@ -7,9 +7,6 @@
 // Include mock Arduino before any ECU code
 #include "../mock_arduino.h"
 
-// Define the Serial mock object
-MockSerial Serial;
-
 // Include message bus for testing
 #include "../../msg_definitions.h"
 #include "../../msg_bus.h"
@@ -210,6 +207,717 @@ TEST(statistics_and_diagnostics) {
     assert(bus.getMessagesProcessed() == 0);
 }
 
+// Test that many distinct IDs can subscribe and each only sees its own messages
+TEST(indexed_dispatch_many_ids) {
+    MessageBus bus;
+    bus.init();
+    
+    static int delivery_count = 0;
+    static uint32_t last_delivered_id = 0;
+    delivery_count = 0;
+    last_delivered_id = 0;
+    
+    auto counting_handler = [](const CANMessage* msg) {
+        delivery_count++;
+        last_delivered_id = msg->id;
+    };
+    
+    // Subscribe more IDs than the old 32-entry limit allowed
+    const uint16_t id_count = 100;
+    for (uint16_t i = 0; i < id_count; i++) {
+        uint32_t msg_id = MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, 0x100 + i);
+        assert(bus.subscribe(msg_id, counting_handler) == true);
+    }
+    assert(bus.getSubscriberCount() == id_count);
+    
+    // Each published ID reaches exactly one handler
+    for (uint16_t i = 0; i < id_count; i++) {
+        uint32_t msg_id = MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, 0x100 + i);
+        bus.publishUint16(msg_id, i);
+        bus.process();
+        assert(last_delivered_id == msg_id);
+    }
+    assert(delivery_count == id_count);
+    
+    // Unsubscribed ID in the same subsystem is not delivered
+    bus.publishUint16(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, 0x100 + id_count), 0);
+    bus.process();
+    assert(delivery_count == id_count);
+}
+
+// Test multiple handlers on one ID are called in subscription order
+TEST(indexed_dispatch_handler_order) {
+    MessageBus bus;
+    bus.init();
+    
+    static int call_order[3];
+    static int call_index = 0;
+    call_index = 0;
+    
+    auto first_handler = [](const CANMessage* msg) { call_order[call_index++] = 1; };
+    auto second_handler = [](const CANMessage* msg) { call_order[call_index++] = 2; };
+    auto third_handler = [](const CANMessage* msg) { call_order[call_index++] = 3; };
+    
+    // Interleave another ID between subscriptions to the same ID
+    bus.subscribe(MSG_ENGINE_RPM, first_handler);
+    bus.subscribe(MSG_COOLANT_TEMP, third_handler);
+    bus.subscribe(MSG_ENGINE_RPM, second_handler);
+    bus.subscribe(MSG_ENGINE_RPM, third_handler);
+    
+    bus.publishFloat(MSG_ENGINE_RPM, 3000.0f);
+    bus.process();
+    
+    assert(call_index == 3);
+    assert(call_order[0] == 1);
+    assert(call_order[1] == 2);
+    assert(call_order[2] == 3);
+}
+
+// Test subscriber limit and reset
+TEST(indexed_dispatch_limits_and_reset) {
+    MessageBus bus;
+    bus.init();
+    message_received = false;
+    
+    for (uint16_t i = 0; i < MessageBus::MAX_SUBSCRIBERS; i++) {
+        assert(bus.subscribe(MSG_ENGINE_RPM, test_message_handler) == true);
+    }
+    assert(bus.subscribe(MSG_COOLANT_TEMP, test_message_handler) == false);
+    assert(bus.subscribe(MSG_ENGINE_RPM, nullptr) == false);
+    assert(bus.getSubscriberCount() == MessageBus::MAX_SUBSCRIBERS);
+    
+    // After reset, nothing is delivered and new subscriptions work again
+    bus.resetSubscribers();
+    assert(bus.getSubscriberCount() == 0);
+    bus.publishFloat(MSG_ENGINE_RPM, 1000.0f);
+    bus.process();
+    assert(message_received == false);
+    
+    assert(bus.subscribe(MSG_COOLANT_TEMP, test_message_handler) == true);
+    bus.publishFloat(MSG_COOLANT_TEMP, 90.0f);
+    bus.process();
+    assert(message_received == true);
+    assert(received_message.id == MSG_COOLANT_TEMP);
+}
+
+// Test critical lane is drained before queued background traffic
+TEST(priority_lanes_drain_order) {
+    MessageBus bus;
+    bus.init();
+    
+    static uint32_t delivered_ids[8];
+    static int delivered_count = 0;
+    delivered_count = 0;
+    
+    auto recording_handler = [](const CANMessage* msg) {
+        delivered_ids[delivered_count++] = msg->id;
+    };
+    
+    bus.subscribe(MSG_STORAGE_SAVE, recording_handler);
+    bus.subscribe(MSG_BOOST_CONTROL, recording_handler);
+    bus.subscribe(MSG_ENGINE_RPM, recording_handler);
+    
+    assert(bus.getMessagePriority(MSG_ENGINE_RPM) == MSG_PRIORITY_CRITICAL);
+    assert(bus.getMessagePriority(MSG_STORAGE_SAVE) == MSG_PRIORITY_BACKGROUND);
+    
+    // Background and control traffic queued before the critical message
+    bus.publishFloat(MSG_STORAGE_SAVE, 1.0f);
+    bus.publishFloat(MSG_STORAGE_SAVE, 2.0f);
+    bus.publishFloat(MSG_BOOST_CONTROL, 10.0f);
+    bus.publishFloat(MSG_ENGINE_RPM, 3000.0f);
+    
+    assert(bus.getQueueSize() == 4);
+    assert(bus.getLaneSize(MSG_PRIORITY_BACKGROUND) == 2);
+    assert(bus.getLaneSize(MSG_PRIORITY_CRITICAL) == 1);
+    
+    bus.process();
+    
+    assert(delivered_count == 4);
+    assert(delivered_ids[0] == MSG_ENGINE_RPM);
+    assert(delivered_ids[1] == MSG_BOOST_CONTROL);
+    assert(delivered_ids[2] == MSG_STORAGE_SAVE);
+    assert(delivered_ids[3] == MSG_STORAGE_SAVE);
+    assert(bus.getQueueSize() == 0);
+}
+
+// Test a flooded lane overflows on its own without blocking critical traffic
+TEST(priority_lanes_isolated_overflow) {
+    MessageBus bus;
+    bus.init();
+    
+    // Fill the background lane past capacity
+    for (uint16_t i = 0; i < MessageBus::INTERNAL_QUEUE_SIZE + 5; i++) {
+        bus.publishFloat(MSG_STORAGE_SAVE, (float)i);
+    }
+    assert(bus.getLaneOverflows(MSG_PRIORITY_BACKGROUND) == 6);
+    assert(bus.getLaneOverflows(MSG_PRIORITY_CRITICAL) == 0);
+    assert(bus.getQueueOverflows() == 6);
+    assert(bus.isQueueFull());
+    
+    // Critical publishes still succeed
+    assert(bus.publishFloat(MSG_ENGINE_RPM, 3000.0f) == true);
+    assert(bus.getLaneSize(MSG_PRIORITY_CRITICAL) == 1);
+    
+    bus.process();
+    assert(bus.getQueueSize() == 0);
+    
+    bus.resetStatistics();
+    assert(bus.getLaneOverflows(MSG_PRIORITY_BACKGROUND) == 0);
+}
+
+// Test per-ID and per-subsystem priority overrides
+TEST(priority_lanes_overrides) {
+    MessageBus bus;
+    bus.init();
+    
+    // Per-ID override beats the subsystem default
+    assert(bus.setMessagePriority(MSG_ENGINE_RPM, MSG_PRIORITY_BACKGROUND) == true);
+    assert(bus.getMessagePriority(MSG_ENGINE_RPM) == MSG_PRIORITY_BACKGROUND);
+    assert(bus.getMessagePriority(MSG_COOLANT_TEMP) == MSG_PRIORITY_CRITICAL);
+    
+    // Subsystem override applies to every ID in that subsystem
+    assert(bus.setSubsystemPriority(SUBSYSTEM_STORAGE, MSG_PRIORITY_CRITICAL) == true);
+    assert(bus.getMessagePriority(MSG_STORAGE_SAVE) == MSG_PRIORITY_CRITICAL);
+    
+    // Invalid priorities are rejected
+    assert(bus.setMessagePriority(MSG_ENGINE_RPM, MSG_PRIORITY_COUNT) == false);
+    
+    // Override table is bounded
+    for (uint8_t i = 1; i < MessageBus::MAX_PRIORITY_OVERRIDES; i++) {
+        uint32_t msg_id = MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_DEBUG, i);
+        assert(bus.setMessagePriority(msg_id, MSG_PRIORITY_CRITICAL) == true);
+    }
+    assert(bus.setMessagePriority(MSG_BATTERY_VOLTAGE, MSG_PRIORITY_NORMAL) == false);
+    
+    // Reset restores the defaults
+    bus.resetPriorities();
+    assert(bus.getMessagePriority(MSG_ENGINE_RPM) == MSG_PRIORITY_CRITICAL);
+    assert(bus.getMessagePriority(MSG_STORAGE_SAVE) == MSG_PRIORITY_BACKGROUND);
+}
+
+// Test interrupt-published messages are delivered ahead of all lanes
+TEST(isr_publish_delivered_first) {
+    MessageBus bus;
+    bus.init();
+    
+    static uint32_t delivered_ids[4];
+    static int delivered_count = 0;
+    delivered_count = 0;
+    
+    auto recording_handler = [](const CANMessage* msg) {
+        delivered_ids[delivered_count++] = msg->id;
+    };
+    
+    bus.subscribe(MSG_ENGINE_RPM, recording_handler);
+    bus.subscribe(MSG_VEHICLE_SPEED, recording_handler);
+    
+    bus.publishFloat(MSG_ENGINE_RPM, 3000.0f);
+    float speed = 55.0f;
+    assert(bus.publishFromISR(MSG_VEHICLE_SPEED, &speed, sizeof(speed)) == true);
+    assert(bus.getQueueSize() == 2);
+    
+    bus.process();
+    
+    assert(delivered_count == 2);
+    assert(delivered_ids[0] == MSG_VEHICLE_SPEED);
+    assert(delivered_ids[1] == MSG_ENGINE_RPM);
+    assert(bus.getQueueSize() == 0);
+    assert(bus.getMessagesProcessed() == 2);
+    
+    // Oversized payloads are rejected
+    uint8_t too_long[9] = {0};
+    assert(bus.publishFromISR(MSG_VEHICLE_SPEED, too_long, sizeof(too_long)) == false);
+}
+
+// Test the ISR ring reports overflow and keeps working across many wraps
+TEST(isr_publish_overflow_and_wrap) {
+    MessageBus bus;
+    bus.init();
+    
+    static uint32_t total_received = 0;
+    static uint32_t last_value = 0;
+    total_received = 0;
+    last_value = 0;
+    
+    auto counting_handler = [](const CANMessage* msg) {
+        uint32_t value = MSG_UNPACK_UINT32(msg);
+        assert(value == last_value + 1 || total_received == 0);
+        last_value = value;
+        total_received++;
+    };
+    bus.subscribe(MSG_CRANK_POSITION, counting_handler);
+    
+    // Fill the ring; the next publish fails without blocking
+    uint32_t value = 0;
+    for (uint16_t i = 0; i < MessageBus::ISR_QUEUE_SIZE; i++) {
+        value++;
+        assert(bus.publishFromISR(MSG_CRANK_POSITION, &value, sizeof(value)) == true);
+    }
+    uint32_t dropped = 999;
+    assert(bus.publishFromISR(MSG_CRANK_POSITION, &dropped, sizeof(dropped)) == false);
+    assert(bus.getIsrQueueOverflows() == 1);
+    
+    bus.process();
+    assert(total_received == MessageBus::ISR_QUEUE_SIZE);
+    
+    // Many laps of the ring with partial fills stay in order
+    for (int lap = 0; lap < 50; lap++) {
+        for (int i = 0; i < 7; i++) {
+            value++;
+            assert(bus.publishFromISR(MSG_CRANK_POSITION, &value, sizeof(value)) == true);
+        }
+        bus.process();
+    }
+    assert(total_received == MessageBus::ISR_QUEUE_SIZE + 50 * 7);
+    assert(last_value == value);
+    assert(bus.getIsrQueueOverflows() == 1);
+}
+
+// Test coalesced IDs keep one queued copy holding the latest value
+TEST(coalesce_latest_value) {
+    MessageBus bus;
+    bus.init();
+    
+    static int rpm_deliveries = 0;
+    static float last_rpm = 0.0f;
+    rpm_deliveries = 0;
+    
+    auto rpm_handler = [](const CANMessage* msg) {
+        rpm_deliveries++;
+        last_rpm = MSG_UNPACK_FLOAT(msg);
+    };
+    bus.subscribe(MSG_ENGINE_RPM, rpm_handler);
+    bus.subscribe(MSG_COOLANT_TEMP, test_message_handler);
+    
+    assert(bus.setCoalesce(MSG_ENGINE_RPM, true) == true);
+    assert(bus.isCoalesced(MSG_ENGINE_RPM));
+    assert(!bus.isCoalesced(MSG_COOLANT_TEMP));
+    
+    // A stalled loop publishes many times - only one copy is queued
+    for (int i = 0; i < 20; i++) {
+        assert(bus.publishFloat(MSG_ENGINE_RPM, 1000.0f + i) == true);
+    }
+    bus.publishFloat(MSG_COOLANT_TEMP, 85.0f);
+    bus.publishFloat(MSG_COOLANT_TEMP, 86.0f);
+    
+    assert(bus.getQueueSize() == 3);
+    assert(bus.getMessagesCoalesced() == 19);
+    
+    bus.process();
+    assert(rpm_deliveries == 1);
+    assert(last_rpm == 1019.0f);
+    
+    // After delivery the next publish queues a new copy
+    bus.publishFloat(MSG_ENGINE_RPM, 2000.0f);
+    assert(bus.getQueueSize() == 1);
+    bus.process();
+    assert(rpm_deliveries == 2);
+    assert(last_rpm == 2000.0f);
+    
+    // Disabling restores one delivery per publish
+    assert(bus.setCoalesce(MSG_ENGINE_RPM, false) == true);
+    bus.publishFloat(MSG_ENGINE_RPM, 1.0f);
+    bus.publishFloat(MSG_ENGINE_RPM, 2.0f);
+    bus.process();
+    assert(rpm_deliveries == 4);
+}
+
+// Test raw payloads on a coalesced ID are never merged
+TEST(coalesce_raw_publish_not_merged) {
+    MessageBus bus;
+    bus.init();
+    
+    static int deliveries = 0;
+    deliveries = 0;
+    auto counting_handler = [](const CANMessage* msg) { deliveries++; };
+    bus.subscribe(MSG_TRANS_CURRENT_GEAR, counting_handler);
+    bus.setCoalesce(MSG_TRANS_CURRENT_GEAR, true);
+    
+    // Status value, then two parameter requests on the same ID
+    parameter_msg_t request = {PARAM_OP_WRITE_REQUEST, 3.0f, 1, 0, {0}};
+    bus.publishFloat(MSG_TRANS_CURRENT_GEAR, 2.0f);
+    bus.publish(MSG_TRANS_CURRENT_GEAR, &request, sizeof(request));
+    request.operation = PARAM_OP_READ_REQUEST;
+    bus.publish(MSG_TRANS_CURRENT_GEAR, &request, sizeof(request));
+    bus.publishFloat(MSG_TRANS_CURRENT_GEAR, 3.0f);
+    
+    assert(bus.getQueueSize() == 3);
+    bus.process();
+    assert(deliveries == 3);
+}
+
+// Test a handler republishing its own coalesced ID is not lost
+TEST(coalesce_republish_from_handler) {
+    MessageBus bus;
+    bus.init();
+    
+    static MessageBus* active_bus = nullptr;
+    static int deliveries = 0;
+    active_bus = &bus;
+    deliveries = 0;
+    
+    auto republishing_handler = [](const CANMessage* msg) {
+        deliveries++;
+        if (deliveries == 1) {
+            active_bus->publishFloat(MSG_ENGINE_RPM, 5000.0f);
+        }
+    };
+    bus.subscribe(MSG_ENGINE_RPM, republishing_handler);
+    bus.setCoalesce(MSG_ENGINE_RPM, true);
+    
+    bus.publishFloat(MSG_ENGINE_RPM, 4000.0f);
+    bus.process();
+    assert(deliveries == 2);
+    assert(bus.getQueueSize() == 0);
+}
+
+// Typed handlers for the compile-time API tests
+static float typed_rpm_value = 0.0f;
+static int typed_rpm_calls = 0;
+static void typed_rpm_handler(const float& rpm) {
+    typed_rpm_value = rpm;
+    typed_rpm_calls++;
+}
+
+typedef struct {
+    uint16_t pressure_kpa;
+    uint8_t gear;
+    uint8_t flags;
+} __attribute__((packed)) test_packed_status_t;
+
+static test_packed_status_t typed_status_value;
+static int typed_status_calls = 0;
+static void typed_status_handler(const test_packed_status_t& status) {
+    typed_status_value = status;
+    typed_status_calls++;
+}
+
+// Test typed publish/subscribe round trip
+TEST(typed_publish_subscribe) {
+    MessageBus bus;
+    bus.init();
+    typed_rpm_calls = 0;
+    typed_status_calls = 0;
+    
+    assert((bus.subscribe<float, MSG_ENGINE_RPM, typed_rpm_handler>()) == true);
+    assert((bus.subscribe<test_packed_status_t, MSG_TRANS_CURRENT_GEAR, typed_status_handler>()) == true);
+    assert(bus.getSubscriberCount() == 2);
+    
+    assert((bus.publish<float, MSG_ENGINE_RPM>(4500.0f)) == true);
+    test_packed_status_t status = {250, 3, 0x5A};
+    assert((bus.publish<test_packed_status_t, MSG_TRANS_CURRENT_GEAR>(status)) == true);
+    assert(bus.getQueueSize() == 2);
+    assert(bus.getMessagesPublished() == 2);
+    
+    bus.process();
+    
+    assert(typed_rpm_calls == 1);
+    assert(typed_rpm_value == 4500.0f);
+    assert(typed_status_calls == 1);
+    assert(typed_status_value.pressure_kpa == 250);
+    assert(typed_status_value.gear == 3);
+    assert(typed_status_value.flags == 0x5A);
+    
+    // Typed and untyped publishes interoperate on the same ID
+    bus.publishFloat(MSG_ENGINE_RPM, 1200.0f);
+    bus.process();
+    assert(typed_rpm_calls == 2);
+    assert(typed_rpm_value == 1200.0f);
+}
+
+// Test typed handlers ignore frames of another size on the same ID
+TEST(typed_subscribe_filters_length) {
+    MessageBus bus;
+    bus.init();
+    typed_rpm_calls = 0;
+    message_received = false;
+    
+    bus.subscribe<float, MSG_ENGINE_RPM, typed_rpm_handler>();
+    bus.subscribe(MSG_ENGINE_RPM, test_message_handler);
+    
+    parameter_msg_t request = {PARAM_OP_READ_REQUEST, 0.0f, 1, 7, {0}};
+    bus.publish(MSG_ENGINE_RPM, &request, sizeof(request));
+    bus.process();
+    
+    // Raw handler sees the request, typed float handler does not
+    assert(message_received == true);
+    assert(received_message.len == sizeof(parameter_msg_t));
+    assert(typed_rpm_calls == 0);
+}
+
+// Test typed publishes follow lanes and coalescing like untyped ones
+TEST(typed_publish_lanes_and_coalesce) {
+    MessageBus bus;
+    bus.init();
+    typed_rpm_calls = 0;
+    
+    bus.subscribe<float, MSG_ENGINE_RPM, typed_rpm_handler>();
+    bus.setCoalesce(MSG_ENGINE_RPM, true);
+    
+    for (int i = 0; i < 5; i++) {
+        bus.publish<float, MSG_ENGINE_RPM>(100.0f * i);
+    }
+    bus.publish<float, MSG_STORAGE_SAVE>(1.0f);
+    
+    assert(bus.getLaneSize(MSG_PRIORITY_CRITICAL) == 1);
+    assert(bus.getLaneSize(MSG_PRIORITY_BACKGROUND) == 1);
+    assert(bus.getMessagesCoalesced() == 4);
+    
+    bus.process();
+    assert(typed_rpm_calls == 1);
+    assert(typed_rpm_value == 400.0f);
+}
+
+// Test handler cost and latency histograms are recorded while profiling
+TEST(profiling_handler_cost_and_latency) {
+    MessageBus bus;
+    bus.init();
+    mock_set_micros(1000);
+    
+    auto slow_handler = [](const CANMessage* msg) { mock_advance_time_us(40); };
+    auto fast_handler = [](const CANMessage* msg) { mock_advance_time_us(2); };
+    bus.subscribe(MSG_ENGINE_RPM, fast_handler);
+    bus.subscribe(MSG_COOLANT_TEMP, slow_handler);
+    
+    // Nothing is recorded until profiling is enabled
+    bus.publishFloat(MSG_ENGINE_RPM, 1000.0f);
+    bus.process();
+    handler_profile_t profile;
+    assert(bus.getHandlerProfile(0, &profile) == true);
+    assert(profile.calls == 0);
+    
+    bus.setProfilingEnabled(true);
+    assert(bus.isProfilingEnabled());
+    
+    // RPM waits 300us in the queue, coolant 300us plus the RPM handler's 2us
+    bus.publishFloat(MSG_ENGINE_RPM, 2000.0f);
+    bus.publishFloat(MSG_COOLANT_TEMP, 90.0f);
+    mock_advance_time_us(300);
+    bus.process();
+    bus.publishFloat(MSG_COOLANT_TEMP, 91.0f);
+    bus.process();
+    
+    assert(bus.getHandlerProfile(0, &profile) == true);
+    assert(profile.msg_id == MSG_ENGINE_RPM);
+    assert(profile.calls == 1);
+    assert(profile.total_us == 2);
+    
+    assert(bus.getHandlerProfile(1, &profile) == true);
+    assert(profile.calls == 2);
+    assert(profile.total_us == 80);
+    assert(profile.max_us == 40);
+    assert(bus.getHottestHandler() == 1);
+    assert(bus.getHandlerProfile(2, &profile) == false);
+    
+    latency_profile_t latency;
+    assert(bus.getLatencyProfile(MSG_ENGINE_RPM, &latency) == true);
+    assert(latency.samples == 1);
+    assert(latency.max_us == 300);
+    assert(latency.buckets[3] == 1);      // 100-500us bucket
+    
+    assert(bus.getLatencyProfile(MSG_COOLANT_TEMP, &latency) == true);
+    assert(latency.samples == 2);
+    assert(latency.max_us == 302);
+    assert(latency.buckets[0] == 1);      // Second publish delivered immediately
+    assert(latency.buckets[3] == 1);
+    
+    assert(bus.getLatencyProfile(MSG_BATTERY_VOLTAGE, &latency) == false);
+    
+    // Reset clears everything but keeps subscriptions
+    bus.resetProfiling();
+    assert(bus.getHottestHandler() == -1);
+    assert(bus.getLatencyProfile(MSG_ENGINE_RPM, &latency) == false);
+    assert(bus.getSubscriberCount() == 2);
+}
+
+// Test lane depth watermarks
+TEST(profiling_queue_watermark) {
+    MessageBus bus;
+    bus.init();
+    
+    for (int i = 0; i < 12; i++) {
+        bus.publishFloat(MSG_STORAGE_SAVE, (float)i);
+    }
+    for (int i = 0; i < 3; i++) {
+        bus.publishFloat(MSG_ENGINE_RPM, (float)i);
+    }
+    bus.process();
+    
+    assert(bus.getLanePeakDepth(MSG_PRIORITY_BACKGROUND) == 12);
+    assert(bus.getLanePeakDepth(MSG_PRIORITY_CRITICAL) == 3);
+    assert(bus.getQueuePeakDepth() == 12);
+    
+    // Watermark holds after the queue drains
+    bus.publishFloat(MSG_STORAGE_SAVE, 1.0f);
+    bus.process();
+    assert(bus.getQueuePeakDepth() == 12);
+    
+    bus.resetProfiling();
+    assert(bus.getQueuePeakDepth() == 0);
+}
+
+// Test process() stops at a message-count budget and resumes next call
+TEST(budgeted_process_message_limit) {
+    MessageBus bus;
+    bus.init();
+    
+    static int deliveries = 0;
+    deliveries = 0;
+    auto counting_handler = [](const CANMessage* msg) { deliveries++; };
+    bus.subscribe(MSG_STORAGE_SAVE, counting_handler);
+    bus.subscribe(MSG_ENGINE_RPM, counting_handler);
+    
+    for (int i = 0; i < 10; i++) {
+        bus.publishFloat(MSG_STORAGE_SAVE, (float)i);
+    }
+    bus.publishFloat(MSG_ENGINE_RPM, 3000.0f);
+    
+    uint16_t deferred = bus.process(0, 4);
+    assert(deliveries == 4);
+    assert(deferred == 7);
+    assert(bus.getLastDeferredCount() == 7);
+    assert(bus.getBudgetExhaustions() == 1);
+    
+    // Critical traffic was served inside the budget
+    assert(bus.getLaneSize(MSG_PRIORITY_CRITICAL) == 0);
+    
+    // Unlimited call drains the rest
+    deferred = bus.process(0, 0);
+    assert(deferred == 0);
+    assert(deliveries == 11);
+    assert(bus.getBudgetExhaustions() == 1);
+}
+
+// Test process() stops once its time budget is spent
+TEST(budgeted_process_time_limit) {
+    MessageBus bus;
+    bus.init();
+    mock_set_micros(5000);
+    
+    static int deliveries = 0;
+    deliveries = 0;
+    auto slow_handler = [](const CANMessage* msg) {
+        deliveries++;
+        mock_advance_time_us(300);
+    };
+    bus.subscribe(MSG_STORAGE_SAVE, slow_handler);
+    
+    for (int i = 0; i < 10; i++) {
+        bus.publishFloat(MSG_STORAGE_SAVE, (float)i);
+    }
+    
+    // 1000us budget with 300us per handler: stops after the 4th message
+    uint16_t deferred = bus.process(1000);
+    assert(deliveries == 4);
+    assert(deferred == 6);
+    
+    // A budget smaller than one handler still makes progress
+    deferred = bus.process(1);
+    assert(deliveries == 5);
+    assert(deferred == 5);
+    
+    // Budget not reached - nothing deferred, no exhaustion counted
+    uint32_t exhaustions = bus.getBudgetExhaustions();
+    deferred = bus.process(100000);
+    assert(deferred == 0);
+    assert(deliveries == 10);
+    assert(bus.getBudgetExhaustions() == exhaustions);
+}
+
+// Test subsystem-masked subscriptions only see their subsystem
+TEST(masked_subscribe_subsystem_bucket) {
+    MessageBus bus;
+    bus.init();
+    
+    static int trans_messages = 0;
+    static int boost_messages = 0;
+    trans_messages = 0;
+    boost_messages = 0;
+    
+    auto trans_handler = [](const CANMessage* msg) {
+        assert(GET_SUBSYSTEM(msg->id) == SUBSYSTEM_TRANSMISSION);
+        trans_messages++;
+    };
+    auto boost_cell_handler = [](const CANMessage* msg) { boost_messages++; };
+    
+    assert(bus.subscribeMasked(SUBSYSTEM_TRANSMISSION, SUBSYSTEM_MASK, trans_handler) == true);
+    
+    // Pattern + full mask: only boost map cells of row 1 on the primary ECU
+    uint32_t row_mask = ECU_BASE_MASK | SUBSYSTEM_MASK | 0xFF00;
+    assert(bus.subscribeMasked(MSG_BOOST_MAP_CELL(1, 0), row_mask, boost_cell_handler) == true);
+    assert(bus.getMaskedSubscriberCount() == 2);
+    
+    bus.publishFloat(MSG_TRANS_CURRENT_GEAR, 3.0f);
+    bus.publishFloat(MSG_TRANS_FLUID_TEMP, 80.0f);
+    bus.publishFloat(MSG_ENGINE_RPM, 3000.0f);
+    bus.publishFloat(MSG_BOOST_MAP_CELL(1, 5), 10.0f);
+    bus.publishFloat(MSG_BOOST_MAP_CELL(2, 5), 11.0f);
+    bus.process();
+    
+    assert(trans_messages == 2);
+    assert(boost_messages == 1);
+    
+    // Duplicate subscriptions are ignored, reset clears masked subscribers
+    assert(bus.subscribeMasked(SUBSYSTEM_TRANSMISSION, SUBSYSTEM_MASK, trans_handler) == true);
+    assert(bus.getMaskedSubscriberCount() == 2);
+    bus.resetSubscribers();
+    assert(bus.getMaskedSubscriberCount() == 0);
+    bus.publishFloat(MSG_TRANS_CURRENT_GEAR, 3.0f);
+    bus.process();
+    assert(trans_messages == 2);
+}
+
+// Test wildcard subscription with a payload length filter
+TEST(masked_subscribe_length_filter) {
+    MessageBus bus;
+    bus.init();
+    
+    static int parameter_frames = 0;
+    static int all_frames = 0;
+    static int exact_calls = 0;
+    static int order_check = 0;
+    parameter_frames = 0;
+    all_frames = 0;
+    exact_calls = 0;
+    order_check = 0;
+    
+    auto parameter_handler = [](const CANMessage* msg) {
+        assert(msg->len == sizeof(parameter_msg_t));
+        parameter_frames++;
+    };
+    auto all_handler = [](const CANMessage* msg) {
+        all_frames++;
+        order_check = 1;
+    };
+    auto exact_handler = [](const CANMessage* msg) {
+        // Masked handlers run before exact ones
+        assert(order_check == 1);
+        order_check = 0;
+        exact_calls++;
+    };
+    
+    bus.subscribeMasked(0, 0, parameter_handler, sizeof(parameter_msg_t));
+    bus.subscribeMasked(0, 0, all_handler);
+    bus.subscribe(MSG_VEHICLE_SPEED, exact_handler);
+    
+    parameter_msg_t request = {PARAM_OP_READ_REQUEST, 0.0f, 1, 1, {0}};
+    bus.publish(MSG_TRANS_CURRENT_GEAR, &request, sizeof(request));
+    bus.publishFloat(MSG_VEHICLE_SPEED, 55.0f);
+    bus.publishFloat(MSG_COOLANT_TEMP, 90.0f);
+    bus.process();
+    
+    assert(parameter_frames == 1);
+    assert(all_frames == 3);
+    assert(exact_calls == 1);
+    
+    // Capacity is bounded and null handlers are rejected
+    assert(bus.subscribeMasked(0, 0, nullptr) == false);
+    for (uint16_t i = bus.getMaskedSubscriberCount(); i < MessageBus::MAX_MASKED_SUBSCRIBERS; i++) {
+        assert(bus.subscribeMasked(i, 0xFFFFFFFF, all_handler) == true);
+    }
+    assert(bus.subscribeMasked(0x7FF, 0xFFFFFFFF, all_handler) == false);
+}
+
 // Main test runner
 int main() {
     std::cout << "=== Message Bus Tests ===" << std::endl;
@@ -222,6 +930,26 @@ int main() {
     run_test_queue_management();
     run_test_message_filtering();
     run_test_statistics_and_diagnostics();
+    run_test_indexed_dispatch_many_ids();
+    run_test_indexed_dispatch_handler_order();
+    run_test_indexed_dispatch_limits_and_reset();
+    run_test_priority_lanes_drain_order();
+    run_test_priority_lanes_isolated_overflow();
+    run_test_priority_lanes_overrides();
+    run_test_isr_publish_delivered_first();
+    run_test_isr_publish_overflow_and_wrap();
+    run_test_coalesce_latest_value();
+    run_test_coalesce_raw_publish_not_merged();
+    run_test_coalesce_republish_from_handler();
+    run_test_typed_publish_subscribe();
+    run_test_typed_subscribe_filters_length();
+    run_test_typed_publish_lanes_and_coalesce();
+    run_test_profiling_handler_cost_and_latency();
+    run_test_profiling_queue_watermark();
+    run_test_budgeted_process_message_limit();
+    run_test_budgeted_process_time_limit();
+    run_test_masked_subscribe_subsystem_bucket();
+    run_test_masked_subscribe_length_filter();
     
     // Print results
     std::cout << std::endl;
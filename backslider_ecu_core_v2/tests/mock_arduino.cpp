@@ -14,6 +14,11 @@
 uint32_t mock_millis_time = 0;
 uint32_t mock_micros_time = 0;
 
+// Virtual clock (see mock_arduino.h)
+bool mock_clock_enabled = false;
+uint32_t mock_event_count = 0;
+mock_cost_model_t mock_clock_costs = MOCK_DEFAULT_COSTS;
+
 // Mock analog values (12-bit ADC)
 uint16_t mock_analog_values[42] = {0};
 
@@ -65,6 +70,140 @@ void mock_initialize() {
     }
 }
 
+// =============================================================================
+// VIRTUAL CLOCK
+// =============================================================================
+
+typedef struct {
+    uint32_t id;                // Also the FIFO order for equal times
+    uint32_t at_us;
+    uint32_t period_us;
+    mock_event_fn_t fn;
+    void* context;
+} mock_event_t;
+
+static std::vector<mock_event_t> mock_events;
+static uint32_t mock_next_event_id = 1;
+static uint32_t mock_sub_us_ns = 0;         // Charged time not yet a whole microsecond
+static bool mock_firing = false;
+
+static void mock_set_clock_us(uint32_t now_us) {
+    mock_micros_time = now_us;
+    mock_millis_time = now_us / 1000;
+}
+
+// Earliest event, FIFO among equal times; -1 if none
+static int mock_next_event_index(void) {
+    int best = -1;
+    for (size_t i = 0; i < mock_events.size(); i++) {
+        if (best < 0) {
+            best = (int)i;
+            continue;
+        }
+        int32_t diff = (int32_t)(mock_events[i].at_us - mock_events[best].at_us);
+        if (diff < 0 || (diff == 0 && mock_events[i].id < mock_events[best].id)) {
+            best = (int)i;
+        }
+    }
+    return best;
+}
+
+void mock_virtual_clock_enable(const mock_cost_model_t* costs) {
+    static const mock_cost_model_t defaults = MOCK_DEFAULT_COSTS;
+    mock_clock_costs = costs ? *costs : defaults;
+    mock_sub_us_ns = 0;
+    mock_clock_enabled = true;
+}
+
+void mock_virtual_clock_reset(void) {
+    static const mock_cost_model_t defaults = MOCK_DEFAULT_COSTS;
+    mock_clock_enabled = false;
+    mock_clock_costs = defaults;
+    mock_sub_us_ns = 0;
+    mock_events.clear();
+    mock_event_count = 0;
+    mock_firing = false;
+}
+
+void mock_clock_advance_us(uint32_t us) {
+    uint32_t target_us = mock_micros_time + us;
+    // Events charging time from inside a callback just move the clock
+    while (!mock_firing) {
+        int next = mock_next_event_index();
+        if (next < 0 || (int32_t)(mock_events[next].at_us - target_us) > 0) {
+            break;
+        }
+        mock_event_t event = mock_events[next];
+        if ((int32_t)(event.at_us - mock_micros_time) > 0) {
+            mock_set_clock_us(event.at_us);
+        }
+        if (event.period_us > 0) {
+            mock_events[next].at_us += event.period_us;
+        } else {
+            mock_events.erase(mock_events.begin() + next);
+            mock_event_count = (uint32_t)mock_events.size();
+        }
+
+        mock_firing = true;
+        event.fn(event.context);
+        mock_firing = false;
+        if ((int32_t)(mock_micros_time - target_us) > 0) {
+            target_us = mock_micros_time;
+        }
+    }
+    mock_set_clock_us(target_us);
+}
+
+void mock_clock_add_ns(uint32_t ns) {
+    uint64_t total_ns = (uint64_t)mock_sub_us_ns + ns;
+    mock_sub_us_ns = (uint32_t)(total_ns % 1000);
+    if (total_ns >= 1000) {
+        mock_clock_advance_us((uint32_t)(total_ns / 1000));
+    }
+}
+
+uint32_t mock_schedule_event(uint32_t at_us, mock_event_fn_t fn, void* context, uint32_t period_us) {
+    if (fn == nullptr) {
+        return 0;
+    }
+    mock_event_t event = {mock_next_event_id++, at_us, period_us, fn, context};
+    mock_events.push_back(event);
+    mock_event_count = (uint32_t)mock_events.size();
+    return event.id;
+}
+
+uint32_t mock_schedule_after_us(uint32_t delay_us, mock_event_fn_t fn, void* context, uint32_t period_us) {
+    return mock_schedule_event(mock_micros_time + delay_us, fn, context, period_us);
+}
+
+bool mock_cancel_event(uint32_t id) {
+    for (size_t i = 0; i < mock_events.size(); i++) {
+        if (mock_events[i].id == id) {
+            mock_events.erase(mock_events.begin() + i);
+            mock_event_count = (uint32_t)mock_events.size();
+            return true;
+        }
+    }
+    return false;
+}
+
+void mock_run_until_us(uint32_t end_us, void (*loop_fn)(void)) {
+    while ((int32_t)(mock_micros_time - end_us) < 0) {
+        uint32_t before_us = mock_micros_time;
+        if (loop_fn) {
+            loop_fn();
+        }
+        mock_clock_add_ns(mock_clock_costs.loop_overhead_ns);
+        if (mock_micros_time == before_us && mock_clock_costs.loop_overhead_ns == 0) {
+            mock_clock_advance_us(1);
+        }
+    }
+}
+
+void mock_run_for_us(uint32_t duration_us, void (*loop_fn)(void)) {
+    mock_run_until_us(mock_micros_time + duration_us, loop_fn);
+}
+
 // =============================================================================
 // MOCK FUNCTIONS
 // =============================================================================
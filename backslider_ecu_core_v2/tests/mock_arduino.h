@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <iostream>
 #include <string>
+#include <vector>
 
 // =============================================================================
 // ARDUINO CONSTANTS
@@ -101,6 +102,26 @@ struct CAN_message_t {
     }
 };
 
+// Mock CAN FD message structure (exact match to FlexCAN_T4 library)
+struct CANFD_message_t {
+    uint32_t id = 0;          // can identifier
+    uint16_t timestamp = 0;   // FlexCAN time when message arrived
+    uint8_t idhit = 0;        // filter that id came from
+    struct {
+        bool extended = 0;    // identifier is extended (29-bit)
+        bool overrun = 0;     // message overrun
+        bool reserved = 0;
+    } flags;
+    uint8_t len = 8;          // length of data
+    uint8_t buf[64] = { 0 };  // data
+    int8_t mb = 0;            // used to identify mailbox reception
+    uint8_t bus = 3;          // used to identify where the message came from when events() is used.
+    bool seq = 0;             // sequential frames
+    bool esi = 0;             // error status bit
+    bool brs = 1;             // baud rate switch for data
+    bool edl = 1;             // extended data length (for RRS)
+};
+
 // Backward compatibility typedef
 typedef CAN_message_t MockCANMessage;
 
@@ -155,6 +176,89 @@ typedef enum FLEXCAN_IDE {
   INACTIVE
 } FLEXCAN_IDE;
 
+// FIFO filter table size (each 8 filters past the first take 2 mailboxes)
+typedef enum FLEXCAN_RFFN_TABLE {
+  RFFN_8 = (uint8_t)0,
+  RFFN_16 = (uint8_t)1,
+  RFFN_24 = (uint8_t)2,
+  RFFN_32 = (uint8_t)3,
+  RFFN_40 = (uint8_t)4,
+  RFFN_48 = (uint8_t)5,
+  RFFN_56 = (uint8_t)6,
+  RFFN_64 = (uint8_t)7,
+  RFFN_72 = (uint8_t)8,
+  RFFN_80 = (uint8_t)9,
+  RFFN_88 = (uint8_t)10,
+  RFFN_96 = (uint8_t)11,
+  RFFN_104 = (uint8_t)12,
+  RFFN_112 = (uint8_t)13,
+  RFFN_120 = (uint8_t)14,
+  RFFN_128 = (uint8_t)15
+} FLEXCAN_RFFN_TABLE;
+
+// Message buffers (TX mailboxes are the ones past the FIFO and its filters)
+typedef enum FLEXCAN_MAILBOX {
+  MB0 = 0, MB1, MB2, MB3, MB4, MB5, MB6, MB7,
+  MB8, MB9, MB10, MB11, MB12, MB13, MB14, MB15,
+  MB16, MB17, MB18, MB19, MB20, MB21, MB22, MB23,
+  MB24, MB25, MB26, MB27, MB28, MB29, MB30, MB31,
+  MB32, MB33, MB34, MB35, MB36, MB37, MB38, MB39,
+  MB40, MB41, MB42, MB43, MB44, MB45, MB46, MB47,
+  MB48, MB49, MB50, MB51, MB52, MB53, MB54, MB55,
+  MB56, MB57, MB58, MB59, MB60, MB61, MB62, MB63
+} FLEXCAN_MAILBOX;
+
+// Peripheral clock for CAN FD bit timing
+typedef enum FLEXCAN_CLOCK {
+  CLK_OFF,
+  CLK_8MHz = 8,
+  CLK_16MHz = 16,
+  CLK_20MHz = 20,
+  CLK_24MHz = 24,
+  CLK_30MHz = 30,
+  CLK_40MHz = 40,
+  CLK_60MHz = 60,
+  CLK_80MHz = 80
+} FLEXCAN_CLOCK;
+
+// CAN FD nominal and data phase timing
+typedef struct CANFD_timings_t {
+  double baudrate = 1000000;
+  double baudrateFD = 2000000;
+  double propdelay = 190;
+  double bus_length = 1;
+  double sample = 75;
+  FLEXCAN_CLOCK clock = CLK_24MHz;
+} CANFD_timings_t;
+
+// Controller error state, as reported by error(); only the raw registers
+// and counters are filled in by the mock
+typedef struct CAN_error_t {
+  char state[30] = "Idle";
+  bool BIT1_ERR = 0;
+  bool BIT0_ERR = 0;
+  bool ACK_ERR = 0;
+  bool CRC_ERR = 0;
+  bool FRM_ERR = 0;
+  bool STF_ERR = 0;
+  bool RX_WRN = 0;
+  bool TX_WRN = 0;
+  char FLT_CONF[14] = { 0 };
+  uint8_t RX_ERR_COUNTER = 0;
+  uint8_t TX_ERR_COUNTER = 0;
+  uint32_t ESR1 = 0;
+  uint16_t ECR = 0;
+} CAN_error_t;
+
+// Whole-table filter settings
+typedef enum FLEXCAN_RXTX {
+  TX,
+  RX,
+  LISTEN_ONLY,
+  ACCEPT_ALL,
+  REJECT_ALL
+} FLEXCAN_RXTX;
+
 // Mock FlexCAN_T4 template class (for linter compatibility)
 template<CAN_DEV_TABLE _bus, FLEXCAN_RXQUEUE_TABLE _rxSize = RX_SIZE_16, FLEXCAN_TXQUEUE_TABLE _txSize = TX_SIZE_16>
 class FlexCAN_T4 {
@@ -162,22 +266,202 @@ public:
     void begin() { }
     void setBaudRate(uint32_t baudrate) { (void)baudrate; }
     bool write(const CAN_message_t& msg) { (void)msg; return true; }
+    int write(FLEXCAN_MAILBOX mb_num, const CAN_message_t& msg) { (void)mb_num; (void)msg; return 1; }
     bool read(CAN_message_t& msg) { (void)msg; return false; }
     void setMaxMB(uint8_t mb) { (void)mb; }
     void enableFIFO(bool enable = true) { (void)enable; }
-    void setFIFOFilter(uint8_t filter, uint32_t id, uint32_t mask) { (void)filter; (void)id; (void)mask; }
+    void setRFFN(FLEXCAN_RFFN_TABLE rffn = RFFN_8) { (void)rffn; }
+    void setFIFOFilter(const FLEXCAN_RXTX& input) { (void)input; }
+    bool setFIFOFilter(uint8_t filter, uint32_t id1, const FLEXCAN_IDE& ide, const FLEXCAN_IDE& remote = NONE) {
+        (void)filter; (void)id1; (void)ide; (void)remote; return true;
+    }
+    bool setFIFOUserFilter(uint8_t filter, uint32_t id1, uint32_t mask, const FLEXCAN_IDE& ide, const FLEXCAN_IDE& remote = NONE) {
+        (void)filter; (void)id1; (void)mask; (void)ide; (void)remote; return true;
+    }
+    void onReceive(void (*handler)(const CAN_message_t& msg)) { (void)handler; }
+    void enableFIFOInterrupt(bool status = 1) { (void)status; }
+    bool error(CAN_error_t& error, bool printDetails) { (void)error; (void)printDetails; return false; }
 };
 
-// Mock FlexCAN interface
+// Mock FlexCAN_T4FD template class (CAN3 in FD mode, for linter compatibility)
+template<CAN_DEV_TABLE _bus, FLEXCAN_RXQUEUE_TABLE _rxSize = RX_SIZE_16, FLEXCAN_TXQUEUE_TABLE _txSize = TX_SIZE_16>
+class FlexCAN_T4FD {
+public:
+    void begin() { }
+    bool setBaudRate(CANFD_timings_t config) { (void)config; return true; }
+    void setRegions(uint8_t size) { (void)size; }
+    bool setMB(const FLEXCAN_MAILBOX& mb_num, const FLEXCAN_RXTX& mb_rx_tx, const FLEXCAN_IDE& ide = STD) {
+        (void)mb_num; (void)mb_rx_tx; (void)ide; return true;
+    }
+    void setMBFilter(FLEXCAN_RXTX input) { (void)input; }
+    int write(const CANFD_message_t& msg) { (void)msg; return 1; }
+    int write(FLEXCAN_MAILBOX mb_num, const CANFD_message_t& msg) { (void)mb_num; (void)msg; return 1; }
+    void onReceive(void (*handler)(const CANFD_message_t& msg)) { (void)handler; }
+    void enableMBInterrupts(bool status = 1) { (void)status; }
+    bool error(CAN_error_t& error, bool printDetails) { (void)error; (void)printDetails; return false; }
+};
+
+// Mock FlexCAN interface: records the FIFO filter table and applies it to
+// frames put on the bus with receive(), like the controller would. With the
+// FIFO interrupt enabled, accepted frames go straight to the onReceive()
+// handler (as the ISR does when events() is never called); otherwise they
+// wait for read(). The FlexCAN_T4FD calls switch it to FD mode, where
+// receive(CANFD_message_t) feeds the FD handler and FD writes are recorded
+// separately.
 class MockFlexCAN {
 public:
+    static const uint8_t MAX_FILTERS = 128;
+
+    struct Filter {
+        uint32_t id;
+        uint32_t mask;
+        bool extended;
+        bool active;
+    };
+
+    MockFlexCAN() : filter_count(8), accept_all(true), frames_rejected(0),
+                    rx_handler(nullptr), fifo_interrupt(false), busy_mailboxes(0),
+                    fd_rx_handler(nullptr), fd_mode(false) {
+        for (uint8_t i = 0; i < MAX_FILTERS; i++) filters[i] = Filter{0, 0, false, false};
+    }
+
     bool begin(uint32_t baudrate = 500000) { (void)baudrate; return true; }
     void setBaudRate(uint32_t baudrate) { (void)baudrate; }
     bool write(const CAN_message_t& msg) { (void)msg; return true; }
-    bool read(CAN_message_t& msg) { (void)msg; return false; }
+    int write(FLEXCAN_MAILBOX mb_num, const CAN_message_t& msg) {
+        if (mb_num < 64 && (busy_mailboxes & (1ULL << mb_num))) return 0;
+        tx_frames.push_back(msg);
+        tx_mailboxes.push_back((uint8_t)mb_num);
+        return 1;
+    }
+    bool read(CAN_message_t& msg) {
+        if (rx_queue.empty()) return false;
+        msg = rx_queue.front();
+        rx_queue.erase(rx_queue.begin());
+        return true;
+    }
     void setMaxMB(uint8_t mb) { (void)mb; }
     void enableFIFO(bool enable = true) { (void)enable; }
-    void setFIFOFilter(uint8_t filter, uint32_t id, uint32_t mask) { (void)filter; (void)id; (void)mask; }
+    void setRFFN(FLEXCAN_RFFN_TABLE rffn = RFFN_8) { filter_count = (uint8_t)(8 * (rffn + 1)); }
+    void setFIFOFilter(const FLEXCAN_RXTX& input) {
+        accept_all = (input == ACCEPT_ALL);
+        for (uint8_t i = 0; i < MAX_FILTERS; i++) filters[i].active = false;
+    }
+    bool setFIFOFilter(uint8_t filter, uint32_t id1, const FLEXCAN_IDE& ide, const FLEXCAN_IDE& remote = NONE) {
+        (void)remote;
+        return setFIFOUserFilter(filter, id1, ide == EXT ? 0x1FFFFFFF : 0x7FF, ide);
+    }
+    bool setFIFOUserFilter(uint8_t filter, uint32_t id1, uint32_t mask, const FLEXCAN_IDE& ide, const FLEXCAN_IDE& remote = NONE) {
+        (void)remote;
+        if (filter >= filter_count) return false;
+        filters[filter] = Filter{id1, mask, ide == EXT, true};
+        accept_all = false;
+        return true;
+    }
+
+    void onReceive(void (*handler)(const CAN_message_t& msg)) { rx_handler = handler; }
+    void enableFIFOInterrupt(bool status = 1) { fifo_interrupt = status; }
+
+    // FlexCAN_T4FD calls: FD mode takes frames in mailbox interrupts
+    bool setBaudRate(CANFD_timings_t config) { fd_timings = config; fd_mode = true; return true; }
+    void setRegions(uint8_t size) { (void)size; }
+    bool setMB(const FLEXCAN_MAILBOX& mb_num, const FLEXCAN_RXTX& mb_rx_tx, const FLEXCAN_IDE& ide = STD) {
+        (void)mb_num; (void)mb_rx_tx; (void)ide; return true;
+    }
+    void setMBFilter(FLEXCAN_RXTX input) { accept_all = (input == ACCEPT_ALL); }
+    void onReceive(void (*handler)(const CANFD_message_t& msg)) { fd_rx_handler = handler; }
+    void enableMBInterrupts(bool status = 1) { fifo_interrupt = status; }
+    int write(FLEXCAN_MAILBOX mb_num, const CANFD_message_t& msg) {
+        if (mb_num < 64 && (busy_mailboxes & (1ULL << mb_num))) return 0;
+        fd_tx_frames.push_back(msg);
+        tx_mailboxes.push_back((uint8_t)mb_num);
+        return 1;
+    }
+
+    // Test helpers
+    bool receive(const CAN_message_t& msg) {
+        if (!accepts(msg)) {
+            frames_rejected++;
+            return false;
+        }
+        if (fifo_interrupt && rx_handler != nullptr) {
+            rx_handler(msg);
+        } else {
+            rx_queue.push_back(msg);
+        }
+        return true;
+    }
+    bool receive(const CANFD_message_t& msg) {
+        if (!accept_all || !fifo_interrupt || fd_rx_handler == nullptr) {
+            frames_rejected++;
+            return false;
+        }
+        fd_rx_handler(msg);
+        return true;
+    }
+    bool accepts(const CAN_message_t& msg) const {
+        if (accept_all) return true;
+        for (uint8_t i = 0; i < filter_count; i++) {
+            if (filters[i].active && filters[i].extended == (msg.flags.extended != 0) &&
+                ((msg.id ^ filters[i].id) & filters[i].mask) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+    bool is_accepting_all() const { return accept_all; }
+    uint8_t get_active_filter_count() const {
+        uint8_t count = 0;
+        for (uint8_t i = 0; i < filter_count; i++) count += filters[i].active ? 1 : 0;
+        return count;
+    }
+    uint32_t get_frames_rejected() const { return frames_rejected; }
+
+    // Mailbox writes, in order; a busy mailbox refuses writes like one
+    // still transmitting
+    void set_mailbox_busy(uint8_t mb, bool busy) {
+        if (busy) busy_mailboxes |= (1ULL << mb); else busy_mailboxes &= ~(1ULL << mb);
+    }
+    const std::vector<CAN_message_t>& get_tx_frames() const { return tx_frames; }
+    const std::vector<uint8_t>& get_tx_mailboxes() const { return tx_mailboxes; }
+    const std::vector<CANFD_message_t>& get_fd_tx_frames() const { return fd_tx_frames; }
+    void clear_tx_frames() { tx_frames.clear(); fd_tx_frames.clear(); tx_mailboxes.clear(); }
+    bool is_fd_mode() const { return fd_mode; }
+    const CANFD_timings_t& get_fd_timings() const { return fd_timings; }
+
+    // Controller error reports, returned by error() in order
+    bool error(CAN_error_t& error, bool printDetails) {
+        (void)printDetails;
+        if (error_reports.empty()) return false;
+        error = error_reports.front();
+        error_reports.erase(error_reports.begin());
+        return true;
+    }
+    void inject_error(uint32_t esr1, uint8_t tx_errors, uint8_t rx_errors) {
+        CAN_error_t error;
+        error.ESR1 = esr1;
+        error.TX_ERR_COUNTER = tx_errors;
+        error.RX_ERR_COUNTER = rx_errors;
+        error.ECR = (uint16_t)((rx_errors << 8) | tx_errors);
+        error_reports.push_back(error);
+    }
+
+private:
+    Filter filters[MAX_FILTERS];
+    uint8_t filter_count;
+    bool accept_all;
+    uint32_t frames_rejected;
+    void (*rx_handler)(const CAN_message_t& msg);
+    bool fifo_interrupt;
+    uint64_t busy_mailboxes;
+    std::vector<CAN_message_t> rx_queue;
+    std::vector<CAN_message_t> tx_frames;
+    std::vector<uint8_t> tx_mailboxes;
+    void (*fd_rx_handler)(const CANFD_message_t& msg);
+    bool fd_mode;
+    CANFD_timings_t fd_timings;
+    std::vector<CANFD_message_t> fd_tx_frames;
+    std::vector<CAN_error_t> error_reports;
 };
 #endif // ARDUINO
 
@@ -192,11 +476,80 @@ public:
 extern uint32_t mock_millis_time;
 extern uint32_t mock_micros_time;
 
+// -----------------------------------------------------------------------------
+// Virtual clock
+//
+// Off by default: time only moves when a test sets or advances it, exactly
+// as before. mock_virtual_clock_enable() makes time pass the way it would
+// on the Teensy, so rate-dependent code can be run for simulated seconds:
+//   - analogRead(), I2C transactions and delayMicroseconds() charge their
+//     on-target duration (mock_clock_costs) to the clock
+//   - every micros()/millis() call costs clock_read_ns, so code polling
+//     the clock makes progress
+//   - SPI DMA transfers complete as events after their wire time
+// Scheduled events (mock_schedule_event) fire in time order, FIFO for equal
+// times, whenever the clock passes them - from costs, mock_advance_time_*
+// or mock_run_until_us() - in either mode.
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    uint32_t analog_read_ns;        // One analogRead() (core default: 10-bit, 4x averaging)
+    uint32_t i2c_byte_ns;           // Per byte incl. address (400 kHz, 9 clocks with ACK)
+    uint32_t i2c_transaction_ns;    // Start, stop and bus turnaround per transaction
+    uint32_t spi_setup_ns;          // beginTransaction, chip select and DMA setup
+    uint32_t clock_read_ns;         // One micros()/millis() call
+    uint32_t loop_overhead_ns;      // Per pass of mock_run_until_us()
+} mock_cost_model_t;
+
+#define MOCK_DEFAULT_COSTS {17000, 22500, 5000, 1000, 20, 1000}
+
+typedef void (*mock_event_fn_t)(void* context);
+
+extern bool mock_clock_enabled;
+extern uint32_t mock_event_count;
+extern mock_cost_model_t mock_clock_costs;
+
+void mock_virtual_clock_enable(const mock_cost_model_t* costs = nullptr);   // nullptr = MOCK_DEFAULT_COSTS
+void mock_virtual_clock_reset(void);        // Clock off, default costs, no events
+void mock_clock_add_ns(uint32_t ns);        // Advance unconditionally, firing due events
+void mock_clock_advance_us(uint32_t us);
+
+// Returns an ID for mock_cancel_event() (never 0); period_us > 0 repeats
+uint32_t mock_schedule_event(uint32_t at_us, mock_event_fn_t fn, void* context, uint32_t period_us = 0);
+uint32_t mock_schedule_after_us(uint32_t delay_us, mock_event_fn_t fn, void* context, uint32_t period_us = 0);
+bool mock_cancel_event(uint32_t id);
+
+// Call loop_fn (may be null) until micros() reaches end_us; each pass costs
+// at least loop_overhead_ns (1 us if that is 0 and nothing else moved time)
+void mock_run_until_us(uint32_t end_us, void (*loop_fn)(void));
+void mock_run_for_us(uint32_t duration_us, void (*loop_fn)(void));
+
+// Charge simulated work to the clock (no-op while it is off)
+inline void mock_clock_charge_ns(uint32_t ns) {
+    if (mock_clock_enabled) {
+        mock_clock_add_ns(ns);
+    }
+}
+
+inline void mock_charge_i2c_transaction(uint8_t bytes) {
+    mock_clock_charge_ns(mock_clock_costs.i2c_transaction_ns + bytes * mock_clock_costs.i2c_byte_ns);
+}
+
+// Wire time of an SPI transfer: 8 clocks per byte plus setup
+inline uint32_t mock_spi_transfer_ns(uint32_t bytes, uint32_t speed_hz) {
+    if (speed_hz == 0) {
+        return mock_clock_costs.spi_setup_ns;
+    }
+    return mock_clock_costs.spi_setup_ns + (uint32_t)((uint64_t)bytes * 8 * 1000000000ULL / speed_hz);
+}
+
 inline uint32_t millis() {
+    mock_clock_charge_ns(mock_clock_costs.clock_read_ns);
     return mock_millis_time;
 }
 
 inline uint32_t micros() {
+    mock_clock_charge_ns(mock_clock_costs.clock_read_ns);
     return mock_micros_time;
 }
 
@@ -210,11 +563,19 @@ inline void mock_set_micros(uint32_t time) {
 }
 
 inline void mock_advance_time_ms(uint32_t ms) {
+    if (mock_clock_enabled || mock_event_count > 0) {
+        mock_clock_advance_us(ms * 1000);
+        return;
+    }
     mock_millis_time += ms;
     mock_micros_time += (ms * 1000);
 }
 
 inline void mock_advance_time_us(uint32_t us) {
+    if (mock_clock_enabled || mock_event_count > 0) {
+        mock_clock_advance_us(us);
+        return;
+    }
     mock_micros_time += us;
     mock_millis_time = mock_micros_time / 1000;
 }
@@ -233,6 +594,7 @@ extern uint8_t mock_digital_values[56];  // Teensy 4.1 has pins 0-55
 extern uint8_t mock_pin_modes[56];
 
 inline uint16_t analogRead(int pin) {
+    mock_clock_charge_ns(mock_clock_costs.analog_read_ns);
     if (pin >= 0 && pin < 42) {
         return mock_analog_values[pin];
     }
@@ -282,8 +644,10 @@ inline void analogWriteResolution(int resolution) {
 }
 
 inline void delayMicroseconds(unsigned int us) {
-    // Mock delay function - do nothing in testing
-    (void)us;
+    // Busy wait: only the virtual clock sees it
+    if (mock_clock_enabled) {
+        mock_clock_advance_us(us);
+    }
 }
 
 inline void attachInterrupt(uint8_t interrupt_num, void (*isr)(), int mode) {
@@ -327,6 +691,7 @@ private:
     std::vector<uint8_t> rx_buffer;
     std::vector<uint8_t> tx_buffer;
     size_t rx_index = 0;
+    int write_limit = -1;       // Bytes the port can hold before a write would block, -1 = no limit
     
 public:
     // HardwareSerial interface methods
@@ -349,6 +714,14 @@ public:
         return -1;
     }
     
+    size_t readBytes(char* buffer, size_t length) {
+        size_t count = 0;
+        while (count < length && rx_index < rx_buffer.size()) {
+            buffer[count++] = static_cast<char>(rx_buffer[rx_index++]);
+        }
+        return count;
+    }
+    
     size_t write(uint8_t byte) override {
         tx_buffer.push_back(byte);
         return 1;
@@ -365,6 +738,14 @@ public:
         // Nothing to flush in mock implementation
     }
     
+    int availableForWrite() {
+        if (write_limit < 0) {
+            return 4096;
+        }
+        int room = write_limit - static_cast<int>(tx_buffer.size());
+        return room > 0 ? room : 0;
+    }
+    
     // Test helper methods
     void add_byte_to_read(uint8_t byte) {
         rx_buffer.push_back(byte);
@@ -384,6 +765,11 @@ public:
         tx_buffer.clear();
     }
     
+    // Limit on written bytes (not yet cleared) before availableForWrite() reports 0
+    void set_write_limit(int limit) {
+        write_limit = limit;
+    }
+    
     void clear_read_data() {
         rx_buffer.clear();
         rx_index = 0;
@@ -393,6 +779,7 @@ public:
         rx_buffer.clear();
         tx_buffer.clear();
         rx_index = 0;
+        write_limit = -1;
     }
     
     // Legacy print/println methods for compatibility
@@ -506,6 +893,11 @@ inline void mock_set_analog_reading(int pin, uint16_t value) {
     }
 }
 
+// Current mock reading of a pin, without the analogRead() cost
+inline uint16_t mock_get_analog_reading(int pin) {
+    return (pin >= 0 && pin < 42) ? mock_analog_values[pin] : 2048;
+}
+
 // Set mock analog voltage for a specific pin (converts to 12-bit counts)
 inline void mock_set_analog_voltage(int pin, float voltage) {
     uint16_t counts = (uint16_t)((voltage / 3.3f) * 4095.0f);
@@ -529,6 +921,7 @@ inline int mock_get_pin_mode(int pin) {
 
 // Reset all mock values to defaults
 inline void mock_reset_all() {
+    mock_virtual_clock_reset();
     mock_millis_time = 0;
     mock_micros_time = 0;
     
@@ -574,23 +967,27 @@ public:
     void beginTransmission(uint8_t address) {
         // Mock I2C transmission start
         (void)address;
+        tx_bytes = 1;
     }
     
     uint8_t endTransmission() {
         // Mock I2C transmission end
+        mock_charge_i2c_transaction(tx_bytes);
+        tx_bytes = 0;
         return 0;  // Success
     }
     
     uint8_t requestFrom(uint8_t address, uint8_t quantity) {
         // Mock I2C request
         (void)address;
-        (void)quantity;
+        mock_charge_i2c_transaction((uint8_t)(quantity + 1));
         return 0;  // No data available
     }
     
     size_t write(uint8_t data) {
         // Mock I2C write
         (void)data;
+        tx_bytes++;
         return 1;  // Success
     }
     
@@ -603,6 +1000,9 @@ public:
         // Mock I2C read
         return 0;  // No data
     }
+    
+private:
+    uint8_t tx_bytes = 0;       // Address plus written bytes, charged at endTransmission()
 };
 
 extern MockWire Wire;
@@ -0,0 +1,261 @@
+// tests/mock_environment/test_virtual_clock.cpp
+// Test suite for the mock environment's virtual clock and event scheduler
+
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+// Include enhanced mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../input_manager.h"
+#include "../../shift_chain.h"
+
+// Simple test framework
+int tests_run = 0;
+int tests_passed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        std::cout << "  Running test: " #name "... "; \
+        tests_run++; \
+        test_##name(); \
+        tests_passed++; \
+        std::cout << "PASSED" << std::endl; \
+    } \
+    void test_##name()
+
+static std::vector<int> fired;
+static std::vector<uint32_t> fired_at_us;
+
+static void record_event(void* context) {
+    fired.push_back((int)(intptr_t)context);
+    fired_at_us.push_back(micros());
+}
+
+static void setup(void) {
+    mock_reset_all();
+    fired.clear();
+    fired_at_us.clear();
+}
+
+// Costs that make the arithmetic easy to check
+static mock_cost_model_t round_costs(void) {
+    mock_cost_model_t costs = MOCK_DEFAULT_COSTS;
+    costs.analog_read_ns = 10000;
+    costs.i2c_byte_ns = 1000;
+    costs.i2c_transaction_ns = 2000;
+    costs.spi_setup_ns = 0;
+    costs.clock_read_ns = 0;
+    costs.loop_overhead_ns = 1000;
+    return costs;
+}
+
+// Test that with the clock off time only moves when a test moves it
+TEST(off_by_default) {
+    setup();
+    assert(!mock_clock_enabled);
+    mock_set_micros(500);
+    analogRead(A0);
+    delayMicroseconds(1000);
+    Wire.beginTransmission(0x48);
+    Wire.write(0x01);
+    Wire.endTransmission();
+    assert(micros() == 500);
+    assert(micros() == 500);
+
+    mock_advance_time_us(1500);
+    assert(micros() == 2000);
+    assert(millis() == 2);
+}
+
+// Test that mocked hardware charges its cost once the clock is on
+TEST(costs_charged) {
+    setup();
+    mock_cost_model_t costs = round_costs();
+    mock_virtual_clock_enable(&costs);
+
+    analogRead(A0);
+    analogRead(A1);
+    assert(micros() == 20);
+
+    Wire.beginTransmission(0x48);       // Address + 2 bytes = 3 bytes
+    Wire.write(0x01);
+    Wire.write(0x02);
+    Wire.endTransmission();
+    assert(micros() == 25);
+    Wire.requestFrom(0x48, 2);          // Address + 2 bytes
+    assert(micros() == 30);
+
+    delayMicroseconds(470);
+    assert(micros() == 500);
+    assert(millis() == 0);
+
+    // Sub-microsecond costs accumulate instead of being lost
+    costs.analog_read_ns = 250;
+    mock_virtual_clock_enable(&costs);
+    for (int i = 0; i < 8; i++) {
+        analogRead(A0);
+    }
+    assert(micros() == 502);
+}
+
+// Test that code polling the clock makes progress on its own
+TEST(auto_advance) {
+    setup();
+    mock_virtual_clock_enable();        // Defaults: 20 ns per clock read
+    uint32_t start_us = micros();
+    uint32_t polls = 0;
+    while (micros() - start_us < 100) {
+        polls++;
+    }
+    assert(polls >= 4000 && polls <= 5100);
+}
+
+// Test event order, periodic events and cancellation
+TEST(event_scheduling) {
+    setup();
+    mock_schedule_event(300, record_event, (void*)3);
+    mock_schedule_event(100, record_event, (void*)1);
+    mock_schedule_event(300, record_event, (void*)4);    // Same time: after 3
+    uint32_t periodic = mock_schedule_event(50, record_event, (void*)9, 200);
+    uint32_t cancelled = mock_schedule_after_us(200, record_event, (void*)7);
+    assert(mock_cancel_event(cancelled));
+    assert(!mock_cancel_event(cancelled));
+
+    // Events fire from a plain advance, each at its own time
+    mock_advance_time_us(400);
+    assert(micros() == 400);
+    assert((fired == std::vector<int>{9, 1, 9, 3, 4}));
+    assert((fired_at_us == std::vector<uint32_t>{50, 100, 250, 300, 300}));
+
+    assert(mock_cancel_event(periodic));
+    mock_advance_time_ms(1);
+    assert(fired.size() == 5);
+    assert(mock_event_count == 0);
+    assert(millis() == 1);
+}
+
+// Test that time charged inside a callback delays later events, not reorders them
+static void slow_event(void* context) {
+    (void)context;
+    fired.push_back(0);
+    delayMicroseconds(150);
+}
+
+TEST(callback_charges_time) {
+    setup();
+    mock_cost_model_t costs = round_costs();
+    mock_virtual_clock_enable(&costs);
+    mock_schedule_event(100, slow_event, nullptr);
+    mock_schedule_event(200, record_event, (void*)2);
+
+    mock_advance_time_us(120);          // Callback runs at 100, ends at 250
+    assert(micros() == 250);
+    assert((fired == std::vector<int>{0, 2}));
+    assert(fired_at_us[0] == 250);      // Late, as it would be on target
+}
+
+// Test a sensor's rate under the simulated loop
+static void sensor_loop(void) {
+    input_manager_update();
+    g_message_bus.process();
+}
+
+TEST(sensor_rate_over_simulated_time) {
+    setup();
+    g_message_bus.init();
+    input_manager_init();
+    static sensor_definition_t sensor;
+    memset(&sensor, 0, sizeof(sensor));
+    sensor.msg_id = MSG_BRAKE_PEDAL;
+    sensor.pin = 5;
+    sensor.type = SENSOR_DIGITAL_PULLUP;
+    sensor.config.digital.use_pullup = 1;
+    sensor.update_interval_us = 10000;
+    sensor.name = "brake";
+    assert(input_manager_register_sensors(&sensor, 1) == 1);
+
+    mock_virtual_clock_enable();
+    uint32_t updates_before = input_manager_get_total_updates();
+    mock_run_for_us(100000, sensor_loop);
+    uint32_t updates = input_manager_get_total_updates() - updates_before;
+    assert(micros() >= 100000);
+    assert(updates >= 9 && updates <= 10);     // First one is due an interval after registering
+}
+
+// Test that an SPI chain transfer completes after its wire time
+TEST(spi_transfer_completes_later) {
+    setup();
+    mock_cost_model_t costs = round_costs();
+    mock_virtual_clock_enable(&costs);
+    shift_chain_init();
+    assert(shift_chain_configure(0, 10, 4, 1000000));    // 32 bits at 1 MHz = 32 us
+
+    shift_chain_flush();
+    assert(shift_chain_is_busy());
+    assert(shift_chain_get_transfer_count() == 0);
+    mock_advance_time_us(31);
+    assert(shift_chain_is_busy());
+    mock_advance_time_us(1);
+    assert(!shift_chain_is_busy());
+    assert(shift_chain_get_transfer_count() == 1);
+
+    // With the clock off the transfer is instant as before
+    mock_reset_all();
+    shift_chain_init();
+    assert(shift_chain_configure(0, 10, 4, 1000000));
+    shift_chain_flush();
+    assert(!shift_chain_is_busy());
+}
+
+// Test that a blocking SPI user waits for the chain DMA and defers new flushes
+TEST(spi_claim_waits_for_transfer) {
+    setup();
+    mock_cost_model_t costs = round_costs();
+    mock_virtual_clock_enable(&costs);
+    shift_chain_init();
+    assert(shift_chain_configure(0, 10, 4, 1000000));
+
+    shift_chain_flush();
+    assert(shift_chain_claim_bus(1000));
+    assert(micros() == 32);
+    assert(shift_chain_get_transfer_count() == 1);
+
+    shift_chain_set_bit(0, 3, 1);
+    shift_chain_flush();                // Held until release
+    assert(!shift_chain_is_busy());
+    shift_chain_release_bus();
+    assert(shift_chain_is_busy());
+    mock_advance_time_us(32);
+    assert(shift_chain_get_transfer_count() == 2);
+}
+
+// Main test runner
+int main() {
+    std::cout << "=== Virtual Clock Tests ===" << std::endl;
+
+    run_test_off_by_default();
+    run_test_costs_charged();
+    run_test_auto_advance();
+    run_test_event_scheduling();
+    run_test_callback_charges_time();
+    run_test_sensor_rate_over_simulated_time();
+    run_test_spi_transfer_completes_later();
+    run_test_spi_claim_waits_for_transfer();
+
+    std::cout << std::endl;
+    std::cout << "Virtual Clock Tests - Run: " << tests_run << ", Passed: " << tests_passed << std::endl;
+
+    if (tests_passed == tests_run) {
+        std::cout << "✅ ALL VIRTUAL CLOCK TESTS PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME TESTS FAILED!" << std::endl;
+        return 1;
+    }
+}
@@ -12,6 +12,10 @@
 #include "../../msg_bus.h"
 #include "../../output_manager.h"
 #include "../../output_manager_types.h"
+#include "../../pwm_driver.h"
+#include "../../shift_chain.h"
+#include "../../output_ramp.h"
+#include <cmath>
 
 // Simple test framework
 int tests_run = 0;
@@ -240,6 +244,282 @@ TEST(message_driven_control) {
     assert(output_manager_get_value(0) == 0.0f);
 }
 
+// Test control messages reach the right output among many registered ones
+TEST(many_output_lookup) {
+    test_setup();
+    g_message_bus.init();
+    output_manager_init();
+    
+    const uint8_t count = 64;
+    static output_definition_t outputs[count];
+    for (uint8_t i = 0; i < count; i++) {
+        outputs[i] = {};
+        outputs[i].type = OUTPUT_VIRTUAL;
+        outputs[i].config.virtual_out = {0.0f, 1000.0f, 0.0f, 0, 0};
+        outputs[i].msg_id = 0x5000 + ((uint32_t)i << 4);  // Clustered IDs
+        outputs[i].name = "Test_Virtual";
+    }
+    assert(output_manager_register_outputs(outputs, count) == count);
+    
+    for (uint8_t i = 0; i < count; i += 7) {
+        g_message_bus.publishFloat(outputs[i].msg_id, (float)i + 0.5f);
+    }
+    g_message_bus.process();
+    
+    for (uint8_t i = 0; i < count; i++) {
+        float expected = (i % 7 == 0) ? (float)i + 0.5f : 0.0f;
+        assert(output_manager_get_value(i) == expected);
+    }
+}
+
+// Test hardware is written only on change and drifted pins are repaired
+TEST(write_on_change_and_integrity) {
+    test_setup();
+    g_message_bus.init();
+    output_manager_init();
+    
+    output_definition_t outputs[] = {
+        {
+            .pin = 40,        // No timer route: analogWrite()
+            .type = OUTPUT_PWM,
+            .config = {.pwm = {1000, 8, 0.0f, 1.0f, 0.0f, 0}},
+            .msg_id = MSG_TRANS_LOCKUP_SOL,
+            .current_value = 0.0f,
+            .last_update_time_ms = 0,
+            .update_rate_limit_ms = 0,
+            .fault_detected = 0,
+            .name = "Test_PWM"
+        },
+        {
+            .pin = 13,
+            .type = OUTPUT_DIGITAL,
+            .config = {.digital = {1, 0, 0}},
+            .msg_id = MSG_SHIFT_LIGHT,
+            .current_value = 0.0f,
+            .last_update_time_ms = 0,
+            .update_rate_limit_ms = 0,
+            .fault_detected = 0,
+            .name = "Test_LED"
+        }
+    };
+    output_manager_register_outputs(outputs, 2);
+    const output_manager_stats_t* stats = output_manager_get_stats();
+    
+    g_message_bus.publishFloat(MSG_TRANS_LOCKUP_SOL, 0.5f);
+    g_message_bus.publishFloat(MSG_SHIFT_LIGHT, 1.0f);
+    g_message_bus.process();
+    assert(stats->hardware_writes == 2);
+    assert(get_pin_state(40) == 127);
+    assert(get_pin_state(13) == HIGH);
+    
+    // A new duty that maps to the same PWM count is not rewritten
+    g_message_bus.publishFloat(MSG_TRANS_LOCKUP_SOL, 0.5015f);
+    g_message_bus.process();
+    assert(output_manager_get_value(0) == 0.5015f);
+    assert(stats->hardware_writes == 2);
+    
+    // Updates with nothing changed write nothing
+    for (int i = 0; i < 10; i++) {
+        output_manager_update();
+    }
+    assert(stats->hardware_writes == 2);
+    assert(stats->integrity_repairs == 0);
+    
+    // A pin that no longer reads back its written level is repaired
+    mock_digital_values[13] = LOW;
+    output_manager_update();
+    assert(get_pin_state(13) == HIGH);
+    assert(stats->integrity_repairs == 1);
+    assert(stats->hardware_writes == 3);
+}
+
+// Test timer-backed PWM outputs changed in one bracket latch together
+TEST(pwm_driver_synchronised_latch) {
+    test_setup();
+    g_message_bus.init();
+    output_manager_init();
+    
+    output_definition_t outputs[3];
+    const uint8_t pins[3] = {22, 23, 18};   // FlexPWM4 SM0 A, SM1 A, QuadTimer3 ch1
+    const uint32_t ids[3] = {MSG_TRANS_PRESSURE_SOL, MSG_TRANS_LOCKUP_SOL, MSG_TRANS_OVERRUN_SOL};
+    for (int i = 0; i < 3; i++) {
+        outputs[i] = {};
+        outputs[i].pin = pins[i];
+        outputs[i].type = OUTPUT_PWM;
+        outputs[i].config.pwm = {1000, 10, 0.0f, 1.0f, 0.0f, 0};
+        outputs[i].msg_id = ids[i];
+        outputs[i].name = "Test_PWM";
+    }
+    output_manager_register_outputs(outputs, 3);
+    assert(pwm_driver_get_channel_count() == 3);
+    
+    // Counts come from the timer period, not the 10-bit resolution
+    uint32_t period = pwm_driver_get_period(0);
+    assert(period > 1023 && period <= 65535);
+    
+    output_manager_begin_update();
+    for (int i = 0; i < 3; i++) {
+        g_message_bus.publishFloat(ids[i], 0.25f * (i + 1));
+    }
+    g_message_bus.process();
+    for (int i = 0; i < 3; i++) {
+        assert(pwm_driver_get_output_counts_for_testing(i) == 0);
+    }
+    
+    // One LDOK write for FlexPWM4, one reload for the QuadTimer channel
+    uint32_t latches = pwm_driver_get_latch_count();
+    output_manager_commit_update();
+    assert(pwm_driver_get_latch_count() == latches + 2);
+    for (int i = 0; i < 3; i++) {
+        uint32_t expected = (uint32_t)(0.25f * (i + 1) * pwm_driver_get_period(i));
+        assert(pwm_driver_get_output_counts_for_testing(i) == expected);
+    }
+    
+    // Outside a bracket a change latches at once
+    output_manager_set_value(0, 0.1f);
+    assert(pwm_driver_get_output_counts_for_testing(0) == (uint32_t)(0.1f * period));
+}
+
+// Test SPI outputs batch into one chain transfer with fault readback
+TEST(spi_chain_batched_flush) {
+    test_setup();
+    g_message_bus.init();
+    output_manager_init();
+    
+    // Ten outputs on chain 0 (two bytes), one on chain 1
+    output_definition_t outputs[11];
+    for (uint8_t i = 0; i < 11; i++) {
+        outputs[i] = {};
+        outputs[i].pin = (i < 10) ? 10 : 9;     // Chip selects
+        outputs[i].type = OUTPUT_SPI;
+        outputs[i].config.spi = {(uint8_t)(i < 10 ? 0 : 1), (uint8_t)(i < 10 ? i : 0), 1, 0, 4000000, 1};
+        outputs[i].msg_id = 0x5100 + i;
+        outputs[i].name = "Test_SPI";
+    }
+    output_manager_register_outputs(outputs, 11);
+    
+    // Initial images go out at the first commit
+    output_manager_begin_update();
+    output_manager_commit_update();
+    uint32_t transfers = shift_chain_get_transfer_count();
+    assert(transfers == 2);
+    
+    // Three changes on chain 0 cost one transfer, sent at the commit
+    output_manager_begin_update();
+    g_message_bus.publishFloat(0x5100, 1.0f);
+    g_message_bus.publishFloat(0x5103, 1.0f);
+    g_message_bus.publishFloat(0x5109, 1.0f);
+    g_message_bus.process();
+    assert(shift_chain_get_transfer_count() == transfers);
+    
+    const uint8_t status[2] = {0x00, 0x08};    // Device reports output 3 faulted
+    shift_chain_set_readback_for_testing(0, status, 2);
+    output_manager_commit_update();
+    assert(shift_chain_get_transfer_count() == transfers + 1);
+    
+    // Farthest device first: bits 8-15, then bits 0-7
+    uint8_t sent[2];
+    assert(shift_chain_get_sent_for_testing(0, sent, 2) == 2);
+    assert(sent[0] == 0x02);
+    assert(sent[1] == 0x09);
+    
+    // The readback from the same transfer flags output 3 only
+    output_manager_update();
+    assert(output_manager_get_fault_count() == 1);
+    const output_fault_record_t* fault = output_manager_get_fault(0);
+    assert(fault->output_index == 3);
+    assert(fault->fault_type == OUTPUT_FAULT_OVERCURRENT);
+    
+    // Outside a bracket a change goes out at once
+    output_manager_set_value(10, 1.0f);
+    assert(shift_chain_get_transfer_count() == transfers + 2);
+}
+
+// Test ramped outputs move at the engine's tick rate, not on messages
+TEST(output_ramp_engine) {
+    test_setup();
+    g_message_bus.init();
+    output_manager_init();
+    
+    output_definition_t outputs[2];
+    const uint8_t pins[2] = {22, 23};
+    for (int i = 0; i < 2; i++) {
+        outputs[i] = {};
+        outputs[i].pin = pins[i];
+        outputs[i].type = OUTPUT_PWM;
+        outputs[i].config.pwm = {1000, 10, 0.0f, 1.0f, 0.0f, 0};
+        outputs[i].msg_id = 0x5200 + i;
+        outputs[i].update_rate_limit_ms = 1000;   // Would drop every message below
+        outputs[i].name = "Test_Ramp";
+    }
+    output_manager_register_outputs(outputs, 2);
+    
+    output_ramp_config_t linear = {OUTPUT_RAMP_LINEAR, 1.0f, 0.0f, 0.0f, 0};
+    output_ramp_config_t lag = {OUTPUT_RAMP_EXPONENTIAL, 0.0f, 10.0f, 0.0f, 0};
+    assert(output_manager_set_ramp(0, &linear));
+    assert(output_manager_set_ramp(1, &lag));
+    assert(!output_manager_set_ramp(0, &linear));
+    
+    // Messages only set targets, and none are rate limited
+    g_message_bus.publishFloat(0x5200, 0.5f);
+    g_message_bus.publishFloat(0x5201, 0.8f);
+    g_message_bus.process();
+    assert(output_manager_get_value(0) == 0.5f);
+    assert(output_ramp_get_value(0) == 0.0f);
+    
+    // 1.0 duty/s at 1 kHz: 0.1 after 100 ms, there after 500 ms
+    output_ramp_run_ticks_for_testing(100);
+    assert(std::fabs(output_ramp_get_value(0) - 0.1f) < 0.002f);
+    uint32_t period = pwm_driver_get_period(0);
+    assert(pwm_driver_get_output_counts_for_testing(0) == (uint32_t)(output_ramp_get_value(0) * period));
+    
+    // Lag: about 63% of the step after one time constant
+    float lag_value = output_ramp_get_value(1);
+    assert(lag_value > 0.0f);
+    output_ramp_run_ticks_for_testing(400);
+    assert(output_ramp_get_value(0) == 0.5f);
+    assert(std::fabs(output_ramp_get_value(1) - 0.8f) < 0.001f);
+    
+    // Safe state jumps without ramping
+    output_manager_safe_state();
+    assert(output_ramp_get_value(0) == 0.0f);
+    assert(pwm_driver_get_output_counts_for_testing(0) == 0);
+}
+
+// Test dither rides on the ramped value
+TEST(output_ramp_dither) {
+    test_setup();
+    g_message_bus.init();
+    output_manager_init();
+    
+    output_definition_t output = {};
+    output.pin = 22;
+    output.type = OUTPUT_PWM;
+    output.config.pwm = {1000, 10, 0.0f, 1.0f, 0.5f, 0};
+    output.msg_id = 0x5300;
+    output.name = "Test_Dither";
+    output_manager_register_outputs(&output, 1);
+    
+    // 10 ms cycle: 5 ticks high, 5 ticks low
+    output_ramp_config_t dither = {OUTPUT_RAMP_LINEAR, 0.0f, 0.0f, 0.05f, 10};
+    assert(output_manager_set_ramp(0, &dither));
+    uint32_t period = pwm_driver_get_period(0);
+    uint32_t high = (uint32_t)(0.55f * period);
+    uint32_t low = (uint32_t)(0.45f * period);
+    
+    uint32_t high_ticks = 0;
+    uint32_t low_ticks = 0;
+    for (int i = 0; i < 20; i++) {
+        output_ramp_run_ticks_for_testing(1);
+        uint32_t counts = pwm_driver_get_output_counts_for_testing(0);
+        if (counts == high) high_ticks++;
+        if (counts == low) low_ticks++;
+    }
+    assert(high_ticks == 10);
+    assert(low_ticks == 10);
+    assert(output_ramp_get_value(0) == 0.5f);
+}
+
 // Main test runner
 int main() {
     std::cout << "=== Output Manager Tests ===" << std::endl;
@@ -250,6 +530,12 @@ int main() {
     run_test_digital_output_registration();
     run_test_direct_output_control();
     run_test_message_driven_control();
+    run_test_many_output_lookup();
+    run_test_write_on_change_and_integrity();
+    run_test_pwm_driver_synchronised_latch();
+    run_test_spi_chain_batched_flush();
+    run_test_output_ramp_engine();
+    run_test_output_ramp_dither();
     
     // Print results
     std::cout << std::endl;
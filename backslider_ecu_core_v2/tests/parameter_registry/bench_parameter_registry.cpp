@@ -0,0 +1,96 @@
+// tests/parameter_registry/bench_parameter_registry.cpp
+// Desktop microbenchmarks for parameter lookup and request handling
+//
+//   - find_handler() hits and misses with 200 registered parameters
+//   - find_range_handler() for an ID inside a registered block
+//   - handle_parameter_request() serving a read end to end
+//
+// Usage: make bench, or ./parameter_registry/bench_parameter_registry --output FILE
+// (see tests/bench.h for --baseline, --tolerance and --rounds)
+
+// Include mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../parameter_registry.h"
+#include "../bench.h"
+
+static const int LOOKUPS_PER_ROUND = 100;
+static const int REQUESTS_PER_ROUND = 50;       // Responses fit one bus lane
+static const uint32_t PARAMETER_COUNT = 200;
+static const uint32_t RANGE_BASE = MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_FUEL, 0x8000);
+
+static uint32_t param_id(uint32_t index) {
+    return MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, 0x200 + index);
+}
+
+static float read_constant(void) {
+    return 42.0f;
+}
+
+static float read_cell(uint32_t id) {
+    return (float)(id & 0xFF);
+}
+
+static CANMessage requests[REQUESTS_PER_ROUND];
+
+static void run_benchmarks(void) {
+    mock_reset_all();
+    g_message_bus.init();
+    for (uint32_t i = 0; i < PARAMETER_COUNT; i++) {
+        if (!ParameterRegistry::register_parameter(param_id(i), read_constant, nullptr, "bench")) {
+            std::cerr << "  parameter " << i << " rejected" << std::endl;
+        }
+    }
+    ParameterRegistry::register_parameter_range(RANGE_BASE, 0xFFFFFF00, read_cell, nullptr, "bench cells");
+
+    static uint32_t next = 0;
+    bench_run("find_handler_hit", LOOKUPS_PER_ROUND, [] {}, [] {
+        uint32_t found = 0;
+        for (int i = 0; i < LOOKUPS_PER_ROUND; i++) {
+            found += ParameterRegistry::find_handler(param_id(next++ % PARAMETER_COUNT)) != nullptr;
+        }
+        bench_sink = bench_sink + found;
+    });
+
+    bench_run("find_handler_miss", LOOKUPS_PER_ROUND, [] {}, [] {
+        uint32_t found = 0;
+        for (int i = 0; i < LOOKUPS_PER_ROUND; i++) {
+            found += ParameterRegistry::find_handler(param_id(PARAMETER_COUNT + next++ % 1000)) != nullptr;
+        }
+        bench_sink = bench_sink + found;
+    });
+
+    bench_run("find_range_handler", LOOKUPS_PER_ROUND, [] {}, [] {
+        uint32_t found = 0;
+        for (int i = 0; i < LOOKUPS_PER_ROUND; i++) {
+            found += ParameterRegistry::find_range_handler(RANGE_BASE + (next++ & 0xFF)) != nullptr;
+        }
+        bench_sink = bench_sink + found;
+    });
+    if (ParameterRegistry::find_range_handler(RANGE_BASE + 1) == nullptr) {
+        std::cerr << "  find_range_handler never matched" << std::endl;
+    }
+
+    for (int i = 0; i < REQUESTS_PER_ROUND; i++) {
+        parameter_msg_t param = {};
+        param.operation = PARAM_OP_READ_REQUEST;
+        param.source_channel = CHANNEL_SERIAL_USB;
+        param.request_id = (uint8_t)i;
+        requests[i].id = param_id((uint32_t)i * 3);
+        requests[i].len = sizeof(parameter_msg_t);
+        memcpy(requests[i].buf, &param, sizeof(param));
+    }
+    bench_run("handle_read_request", REQUESTS_PER_ROUND,
+        [] { g_message_bus.process(); },
+        [] {
+            for (int i = 0; i < REQUESTS_PER_ROUND; i++) {
+                ParameterRegistry::handle_parameter_request(&requests[i]);
+            }
+        });
+}
+
+int main(int argc, char** argv) {
+    return bench_main(argc, argv, "parameter_registry", run_benchmarks);
+}
@@ -324,6 +324,324 @@ static bool test_readonly_parameter_write_error() {
     return true;
 }
 
+static uint32_t range_written_id = 0;
+static float range_written_value = 0.0f;
+
+static float range_read_handler(uint32_t param_id) {
+    return (float)(param_id & 0xFF);
+}
+
+static bool range_write_handler(uint32_t param_id, float value) {
+    range_written_id = param_id;
+    range_written_value = value;
+    return true;
+}
+
+static bool test_parameter_range_handling() {
+    range_written_id = 0;
+    range_written_value = 0.0f;
+
+    // One registration covers 0x5000-0x50FF; an exact entry inside it wins
+    ParameterRegistry::register_parameter_range(0x5000, 0xFFFFFF00,
+        range_read_handler, range_write_handler, "Range Parameter");
+    ParameterRegistry::register_parameter(0x5001,
+        []() -> float { return 1234.0f; },
+        nullptr, "Exact Parameter");
+
+    if (!ParameterRegistry::find_range_handler(0x5012) || ParameterRegistry::find_range_handler(0x5112)) {
+        return false;
+    }
+
+    CANMessage request;
+    create_parameter_request(&request, 0x5012, PARAM_OP_WRITE_REQUEST, 7.5f, CHANNEL_SERIAL_1, 5);
+    ParameterRegistry::handle_parameter_request(&request);
+    g_message_bus.process();
+
+    if (range_written_id != 0x5012 || range_written_value != 7.5f) {
+        return false;
+    }
+    CANMessage* response = find_message_by_id(0x5012);
+    parameter_msg_t* param = get_parameter_from_message(response);
+    if (!param || param->operation != PARAM_OP_WRITE_ACK) {
+        return false;
+    }
+
+    clear_captured_messages();
+    create_parameter_request(&request, 0x5012, PARAM_OP_READ_REQUEST, 0.0f, CHANNEL_SERIAL_1, 6);
+    ParameterRegistry::handle_parameter_request(&request);
+    g_message_bus.process();
+
+    param = get_parameter_from_message(find_message_by_id(0x5012));
+    if (!param || param->operation != PARAM_OP_READ_RESPONSE || param->value != 18.0f) {
+        return false;
+    }
+
+    clear_captured_messages();
+    create_parameter_request(&request, 0x5001, PARAM_OP_READ_REQUEST, 0.0f, CHANNEL_SERIAL_1, 7);
+    ParameterRegistry::handle_parameter_request(&request);
+    g_message_bus.process();
+
+    param = get_parameter_from_message(find_message_by_id(0x5001));
+    if (!param || param->value != 1234.0f) {
+        return false;
+    }
+
+    return true;
+}
+
+static float bulk_read_handler() { return 1.0f; }
+static float bulk_read_handler_updated() { return 2.0f; }
+
+static bool test_many_parameter_lookup() {
+    uint16_t before = ParameterRegistry::get_registered_count();
+    
+    // More than the old 64-entry limit, on IDs that share their low bits
+    for (uint32_t i = 0; i < 150; i++) {
+        if (!ParameterRegistry::register_parameter(0x7000 + (i << 8), bulk_read_handler, nullptr, "Bulk")) {
+            return false;
+        }
+    }
+    if (ParameterRegistry::get_registered_count() != before + 150) {
+        return false;
+    }
+    
+    // Re-registering updates in place
+    if (!ParameterRegistry::register_parameter(0x7000 + (42 << 8), bulk_read_handler_updated, nullptr, "Bulk 42") ||
+        ParameterRegistry::get_registered_count() != before + 150) {
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < 150; i++) {
+        ParameterHandler* handler = ParameterRegistry::find_handler(0x7000 + (i << 8));
+        if (!handler || handler->param_id != 0x7000 + (i << 8)) {
+            return false;
+        }
+    }
+    ParameterHandler* updated = ParameterRegistry::find_handler(0x7000 + (42 << 8));
+    return updated->read_handler == bulk_read_handler_updated &&
+           ParameterRegistry::find_handler(0x7001) == nullptr &&
+           ParameterRegistry::find_handler(0x1000)->param_id == 0x1000;
+}
+
+// Batch parameters 0x6000-0x60FF: writes of negative values are refused
+static float batch_values[256];
+
+static float batch_read_handler(uint32_t param_id) {
+    return batch_values[param_id & 0xFF];
+}
+
+static bool batch_write_handler(uint32_t param_id, float value) {
+    if (value < 0.0f) {
+        return false;
+    }
+    batch_values[param_id & 0xFF] = value;
+    return true;
+}
+
+static void create_batch_request(CANMessage* msg, uint8_t operation, uint32_t first_id, uint8_t count,
+                                 uint8_t source_channel, uint8_t request_id) {
+    parameter_batch_msg_t batch = {
+        .operation = operation,
+        .param_id = first_id,
+        .source_channel = source_channel,
+        .request_id = request_id,
+        .count = count
+    };
+    msg->id = MSG_PARAM_BATCH;
+    msg->len = sizeof(parameter_batch_msg_t);
+    memcpy(msg->buf, &batch, sizeof(batch));
+}
+
+static int count_operation(uint8_t operation) {
+    int count = 0;
+    for (auto& msg : captured_messages) {
+        if (msg.buf[0] == operation) count++;
+    }
+    return count;
+}
+
+static parameter_batch_msg_t* find_batch_complete() {
+    CANMessage* msg = find_message_by_id(MSG_PARAM_BATCH);
+    return msg ? (parameter_batch_msg_t*)msg->buf : nullptr;
+}
+
+static bool test_batch_range_read() {
+    for (int i = 0; i < 256; i++) batch_values[i] = (float)i * 0.5f;
+    ParameterRegistry::reset_batches();
+    ParameterRegistry::register_parameter_range(0x6000, 0xFFFFFF00,
+        batch_read_handler, batch_write_handler, "Batch Parameters");
+    
+    // 20 IDs stream out 8 per update under one request ID
+    CANMessage request;
+    create_batch_request(&request, PARAM_OP_BATCH_READ_RANGE, 0x6000, 20, CHANNEL_SERIAL_USB, 9);
+    ParameterRegistry::handle_parameter_request(&request);
+    ParameterRegistry::update();
+    g_message_bus.process();
+    if (count_operation(PARAM_OP_READ_RESPONSE) != ParameterRegistry::BATCH_RESPONSES_PER_UPDATE ||
+        !ParameterRegistry::is_batch_streaming(CHANNEL_SERIAL_USB)) {
+        return false;
+    }
+    
+    // A second read on the same channel waits for the first
+    clear_captured_messages();
+    create_batch_request(&request, PARAM_OP_BATCH_READ_RANGE, 0x6080, 4, CHANNEL_SERIAL_USB, 10);
+    ParameterRegistry::handle_parameter_request(&request);
+    g_message_bus.process();
+    CANMessage* busy = find_message_by_id(MSG_PARAM_BATCH);
+    if (!busy || busy->buf[0] != PARAM_OP_ERROR) {
+        return false;
+    }
+    
+    clear_captured_messages();
+    ParameterRegistry::update();
+    ParameterRegistry::update();
+    g_message_bus.process();
+    if (count_operation(PARAM_OP_READ_RESPONSE) != 12 || ParameterRegistry::is_batch_streaming(CHANNEL_SERIAL_USB)) {
+        return false;
+    }
+    parameter_msg_t* param = get_parameter_from_message(find_message_by_id(0x6013));
+    if (!param || param->value != 9.5f || param->request_id != 9) {
+        return false;
+    }
+    parameter_batch_msg_t* complete = find_batch_complete();
+    if (!complete || complete->operation != PARAM_OP_BATCH_COMPLETE || complete->param_id != 20 ||
+        complete->count != 0 || complete->request_id != 9) {
+        return false;
+    }
+    
+    // IDs past the range handler are skipped and counted
+    clear_captured_messages();
+    create_batch_request(&request, PARAM_OP_BATCH_READ_RANGE, 0x60FC, 8, CHANNEL_SERIAL_USB, 11);
+    ParameterRegistry::handle_parameter_request(&request);
+    ParameterRegistry::update();
+    g_message_bus.process();
+    complete = find_batch_complete();
+    return complete && complete->param_id == 4 && complete->count == 4 &&
+           count_operation(PARAM_OP_READ_RESPONSE) == 4;
+}
+
+static bool test_batch_list_read() {
+    ParameterRegistry::reset_batches();
+    CANMessage request;
+    
+    // Listed IDs go on their own message IDs; an unknown one gets an error
+    create_parameter_request(&request, 0x6003, PARAM_OP_BATCH_LIST_ADD, 0.0f, CHANNEL_CAN_BUS, 20);
+    ParameterRegistry::handle_parameter_request(&request);
+    create_parameter_request(&request, 0x9999, PARAM_OP_BATCH_LIST_ADD, 0.0f, CHANNEL_CAN_BUS, 21);
+    ParameterRegistry::handle_parameter_request(&request);
+    create_parameter_request(&request, 0x6042, PARAM_OP_BATCH_LIST_ADD, 0.0f, CHANNEL_CAN_BUS, 22);
+    ParameterRegistry::handle_parameter_request(&request);
+    g_message_bus.process();
+    if (!captured_messages.empty()) {
+        return false;
+    }
+    
+    create_batch_request(&request, PARAM_OP_BATCH_READ_LIST, 0, 0, CHANNEL_CAN_BUS, 23);
+    ParameterRegistry::handle_parameter_request(&request);
+    ParameterRegistry::update();
+    g_message_bus.process();
+    
+    parameter_msg_t* param = get_parameter_from_message(find_message_by_id(0x6042));
+    if (!param || param->operation != PARAM_OP_READ_RESPONSE || param->value != 33.0f) {
+        return false;
+    }
+    param = get_parameter_from_message(find_message_by_id(0x9999));
+    if (!param || param->operation != PARAM_OP_ERROR || param->request_id != 23) {
+        return false;
+    }
+    parameter_batch_msg_t* complete = find_batch_complete();
+    if (!complete || complete->param_id != 2 || complete->count != 1) {
+        return false;
+    }
+    
+    // The list is used up
+    clear_captured_messages();
+    ParameterRegistry::handle_parameter_request(&request);
+    ParameterRegistry::update();
+    g_message_bus.process();
+    complete = find_batch_complete();
+    return complete && complete->param_id == 0 && count_operation(PARAM_OP_READ_RESPONSE) == 0;
+}
+
+static bool test_batch_write_commit() {
+    ParameterRegistry::reset_batches();
+    batch_values[1] = 0.0f;
+    batch_values[2] = 0.0f;
+    CANMessage request;
+    
+    // Nothing is written until the commit
+    create_parameter_request(&request, 0x6001, PARAM_OP_BATCH_WRITE_STAGE, 1.5f, CHANNEL_SERIAL_1, 30);
+    ParameterRegistry::handle_parameter_request(&request);
+    create_parameter_request(&request, 0x6002, PARAM_OP_BATCH_WRITE_STAGE, 2.5f, CHANNEL_SERIAL_1, 31);
+    ParameterRegistry::handle_parameter_request(&request);
+    if (batch_values[1] != 0.0f) {
+        return false;
+    }
+    create_batch_request(&request, PARAM_OP_BATCH_WRITE_COMMIT, 0, 0, CHANNEL_SERIAL_1, 32);
+    ParameterRegistry::handle_parameter_request(&request);
+    g_message_bus.process();
+    parameter_batch_msg_t* complete = find_batch_complete();
+    if (batch_values[1] != 1.5f || batch_values[2] != 2.5f ||
+        !complete || complete->param_id != 2 || complete->count != 0) {
+        return false;
+    }
+    
+    // A refused value undoes the writes before it
+    clear_captured_messages();
+    create_parameter_request(&request, 0x6001, PARAM_OP_BATCH_WRITE_STAGE, 9.0f, CHANNEL_SERIAL_1, 33);
+    ParameterRegistry::handle_parameter_request(&request);
+    create_parameter_request(&request, 0x6002, PARAM_OP_BATCH_WRITE_STAGE, -1.0f, CHANNEL_SERIAL_1, 34);
+    ParameterRegistry::handle_parameter_request(&request);
+    create_batch_request(&request, PARAM_OP_BATCH_WRITE_COMMIT, 0, 0, CHANNEL_SERIAL_1, 35);
+    ParameterRegistry::handle_parameter_request(&request);
+    g_message_bus.process();
+    complete = find_batch_complete();
+    parameter_msg_t* error = get_parameter_from_message(find_message_by_id(0x6002));
+    if (batch_values[1] != 1.5f || batch_values[2] != 2.5f ||
+        !complete || complete->param_id != 0 || complete->count != 1 ||
+        !error || error->operation != PARAM_OP_ERROR) {
+        return false;
+    }
+    
+    // Read-only IDs are refused when staged
+    clear_captured_messages();
+    create_parameter_request(&request, 0x1000, PARAM_OP_BATCH_WRITE_STAGE, 1.0f, CHANNEL_SERIAL_1, 36);
+    ParameterRegistry::handle_parameter_request(&request);
+    g_message_bus.process();
+    error = get_parameter_from_message(find_message_by_id(0x1000));
+    return error && error->operation == PARAM_OP_ERROR;
+}
+
+static bool test_batch_snapshot() {
+    ParameterRegistry::reset_batches();
+    uint16_t registered = ParameterRegistry::get_registered_count();
+    
+    // Every single-ID parameter streams back without the tool naming one
+    CANMessage request;
+    create_batch_request(&request, PARAM_OP_BATCH_SNAPSHOT, 0, 0, CHANNEL_SERIAL_2, 40);
+    ParameterRegistry::handle_parameter_request(&request);
+    int updates = 0;
+    while (ParameterRegistry::is_batch_streaming(CHANNEL_SERIAL_2) && updates < 100) {
+        ParameterRegistry::update();
+        g_message_bus.process();
+        updates++;
+    }
+    if (updates != (registered + ParameterRegistry::BATCH_RESPONSES_PER_UPDATE - 1) /
+                   ParameterRegistry::BATCH_RESPONSES_PER_UPDATE) {
+        return false;
+    }
+    
+    parameter_msg_t* param = get_parameter_from_message(find_message_by_id(0x1000));
+    if (!param || param->operation != PARAM_OP_READ_RESPONSE || param->value != 42.0f ||
+        param->request_id != 40 || param->source_channel != CHANNEL_SERIAL_2) {
+        return false;
+    }
+    
+    parameter_batch_msg_t* complete = find_batch_complete();
+    return complete && complete->request_id == 40 && complete->count == 0 &&
+           complete->param_id == registered;
+}
+
 // Main test function
 int main() {
     std::cout << "=== Parameter Registry Tests ===\n";
@@ -337,6 +655,10 @@ int main() {
     g_message_bus.subscribe(0x3000, capture_message);
     g_message_bus.subscribe(0x4000, capture_message);
     g_message_bus.subscribe(0x9999, capture_message);
+    g_message_bus.subscribe(0x5001, capture_message);
+    g_message_bus.subscribe(0x5012, capture_message);
+    g_message_bus.subscribeMasked(0x6000, 0xFFFFFF00, capture_message);
+    g_message_bus.subscribe(MSG_PARAM_BATCH, capture_message);
     
     // Run tests
     run_test("Parameter Registration", test_parameter_registration);
@@ -344,6 +666,12 @@ int main() {
     run_test("Parameter Error Handling", test_parameter_error_handling);
     run_test("Write Parameter Handling", test_write_parameter_handling);
     run_test("Read-Only Parameter Write Error", test_readonly_parameter_write_error);
+    run_test("Parameter Range Handling", test_parameter_range_handling);
+    run_test("Many Parameter Lookup", test_many_parameter_lookup);
+    run_test("Batch Range Read", test_batch_range_read);
+    run_test("Batch List Read", test_batch_list_read);
+    run_test("Batch Write Commit", test_batch_write_commit);
+    run_test("Batch Snapshot", test_batch_snapshot);
     
     // Print results
     std::cout << "\n=== Test Results ===\n";
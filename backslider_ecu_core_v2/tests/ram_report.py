@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""
+Static RAM per module and memory region from a GNU ld map file.
+
+    python3 ram_report.py firmware.map
+    python3 ram_report.py firmware.map --top 30 --output ram_report.json
+
+Produce the map by linking with -Wl,-Map=firmware.map (PlatformIO:
+build_flags = -Wl,-Map,${BUILD_DIR}/firmware.map; Arduino IDE: add it to
+compiler.c.elf.extra_flags in platform.local.txt).
+
+Every input section is charged to the object it came from (module = the
+object file name without .o/.cpp, or archive(member) for libraries) and to
+the region its address falls in, using the same address ranges as
+`make link-map`. Only RAM regions are tabulated: ITCM (code copied to
+RAM1), DTCM (.data + .bss) and OCRAM (DMAMEM). ITCM and DTCM share the
+512K of RAM1, ITCM rounded up to 32K banks; what is left of RAM1 is the
+stack, so the RAM1 headroom line is the most the stack can grow to.
+
+Exits 2 if the map cannot be read.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+from collections import defaultdict
+from typing import Dict, Optional, Tuple
+
+RAM1_BYTES = 512 * 1024
+OCRAM_BYTES = 512 * 1024
+ITCM_BANK_BYTES = 32 * 1024
+RAM_REGIONS = ("ITCM", "DTCM", "OCRAM")
+
+# Input section with address, size and object on one line, or the name alone
+# (long names) with the rest on the next line
+SECTION_LINE = re.compile(r"^ (\.\S+|COMMON)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+SECTION_NAME_ONLY = re.compile(r"^ (\.\S+|COMMON)\s*$")
+CONTINUATION = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+# Not loaded: these also sit at address 0
+NON_ALLOC_PREFIXES = (".debug", ".comment", ".ARM.attributes", ".stab")
+
+
+def region_of(address: int) -> Optional[str]:
+    if address < 0x00080000:
+        return "ITCM"
+    if 0x20000000 <= address < 0x20080000:
+        return "DTCM"
+    if 0x20200000 <= address < 0x20280000:
+        return "OCRAM"
+    return None
+
+
+def module_of(obj: str) -> str:
+    obj = obj.strip()
+    match = re.match(r"^(.*\.a)\((.*)\)$", obj)
+    if match:
+        return "%s(%s)" % (os.path.basename(match.group(1)), match.group(2))
+    name = os.path.basename(obj)
+    for suffix in (".o", ".cpp", ".c", ".S"):
+        if name.endswith(suffix):
+            name = name[: -len(suffix)]
+    return name
+
+
+def parse_map(path: str) -> Dict[str, Dict[str, int]]:
+    """Module -> region -> bytes."""
+    usage: Dict[str, Dict[str, int]] = defaultdict(lambda: defaultdict(int))
+    in_memory_map = False
+    pending_name = None
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if not in_memory_map:
+                in_memory_map = line.startswith("Linker script and memory map")
+                continue
+
+            entry: Optional[Tuple[str, str, str, str]] = None
+            if pending_name is not None:
+                match = CONTINUATION.match(line)
+                if match:
+                    entry = (pending_name, match.group(1), match.group(2), match.group(3))
+                pending_name = None
+            if entry is None:
+                match = SECTION_LINE.match(line)
+                if match:
+                    entry = match.groups()
+                elif SECTION_NAME_ONLY.match(line):
+                    pending_name = line.strip()
+                    continue
+            if entry is None or entry[0].startswith(NON_ALLOC_PREFIXES):
+                continue
+
+            address, size, obj = int(entry[1], 16), int(entry[2], 16), entry[3]
+            region = region_of(address)
+            if region is None or size == 0:
+                continue
+            usage[module_of(obj)][region] += size
+    return usage
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("map", help="linker map file")
+    parser.add_argument("--top", type=int, default=25, help="modules to list (default 25, 0 = all)")
+    parser.add_argument("--output", help="also write the full table as JSON")
+    args = parser.parse_args()
+
+    try:
+        usage = parse_map(args.map)
+    except OSError as error:
+        print("Cannot read map file: %s" % error, file=sys.stderr)
+        return 2
+
+    totals = {region: sum(regions[region] for regions in usage.values()) for region in RAM_REGIONS}
+    rows = sorted(usage.items(), key=lambda item: -sum(item[1].values()))
+    shown = rows if args.top <= 0 else rows[: args.top]
+
+    print("=== Static RAM by module: %s ===" % args.map)
+    print("%-40s %9s %9s %9s %9s" % ("module", "ITCM", "DTCM", "OCRAM", "total"))
+    for module, regions in shown:
+        print("%-40s %9d %9d %9d %9d" % (module[:40], regions["ITCM"], regions["DTCM"],
+                                         regions["OCRAM"], sum(regions.values())))
+    if len(shown) < len(rows):
+        print("... %d more modules" % (len(rows) - len(shown)))
+    print("%-40s %9d %9d %9d %9d" % ("TOTAL", totals["ITCM"], totals["DTCM"], totals["OCRAM"],
+                                     sum(totals.values())))
+
+    itcm_banks = -(-totals["ITCM"] // ITCM_BANK_BYTES) * ITCM_BANK_BYTES
+    ram1_free = RAM1_BYTES - itcm_banks - totals["DTCM"]
+    print()
+    print("RAM1:  %6d ITCM (%d in 32K banks) + %6d DTCM of %d, %6d left for the stack"
+          % (totals["ITCM"], itcm_banks, totals["DTCM"], RAM1_BYTES, ram1_free))
+    print("OCRAM: %6d DMAMEM of %d, %6d left for the heap"
+          % (totals["OCRAM"], OCRAM_BYTES, OCRAM_BYTES - totals["OCRAM"]))
+
+    if args.output:
+        report = {
+            "map": args.map,
+            "totals": totals,
+            "ram1_free_bytes": ram1_free,
+            "ocram_free_bytes": OCRAM_BYTES - totals["OCRAM"],
+            "modules": [dict(name=module, **{region: regions[region] for region in RAM_REGIONS})
+                        for module, regions in rows],
+        }
+        with open(args.output, "w") as f:
+            json.dump(report, f, indent=2)
+            f.write("\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,280 @@
+// tests/sd_logger/test_sd_logger.cpp
+// Test suite for the double-buffered SD datalogger
+
+#include <iostream>
+#include <cassert>
+#include <vector>
+
+// Include enhanced mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../sd_logger.h"
+
+// Simple test framework
+int tests_run = 0;
+int tests_passed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        std::cout << "  Running test: " #name "... "; \
+        tests_run++; \
+        test_##name(); \
+        tests_passed++; \
+        std::cout << "PASSED" << std::endl; \
+    } \
+    void test_##name()
+
+// Mock card: everything written, in order, plus a settable busy flag
+static std::vector<uint8_t> card;
+static std::vector<size_t> write_sizes;
+static bool card_busy = false;
+static bool card_fails = false;
+static bool card_closed = false;
+
+static bool mock_write(const uint8_t* data, size_t length) {
+    if (card_fails) {
+        return false;
+    }
+    card.insert(card.end(), data, data + length);
+    write_sizes.push_back(length);
+    return true;
+}
+
+static bool mock_busy(void) {
+    return card_busy;
+}
+
+static void mock_close(void) {
+    card_closed = true;
+}
+
+static const sd_logger_sink_t mock_sink = {mock_write, mock_busy, mock_close};
+
+struct LoggedRecord {
+    uint32_t timestamp_us;
+    uint32_t msg_id;
+    std::vector<uint8_t> data;
+};
+
+// Reader side of the file format: every record of every block, in order
+static std::vector<LoggedRecord> parse_card(std::vector<sd_log_block_header_t>* headers = nullptr) {
+    std::vector<LoggedRecord> records;
+    size_t pos = 0;
+    while (pos < card.size()) {
+        sd_log_block_header_t header;
+        memcpy(&header, &card[pos], sizeof(header));
+        assert(header.magic == SD_LOGGER_BLOCK_MAGIC);
+        if (headers) headers->push_back(header);
+        size_t record_pos = pos + sizeof(header);
+        for (uint16_t i = 0; i < header.records; i++) {
+            LoggedRecord record;
+            memcpy(&record.timestamp_us, &card[record_pos], 4);
+            memcpy(&record.msg_id, &card[record_pos + 4], 4);
+            uint8_t length = card[record_pos + 8];
+            record.data.assign(&card[record_pos + 9], &card[record_pos + 9] + length);
+            records.push_back(record);
+            record_pos += SD_LOGGER_RECORD_HEADER + length;
+        }
+        assert(record_pos == pos + header.used);
+        pos += (header.used + SD_LOGGER_SECTOR_SIZE - 1) / SD_LOGGER_SECTOR_SIZE * SD_LOGGER_SECTOR_SIZE;
+    }
+    return records;
+}
+
+static void setup(void) {
+    mock_reset_all();
+    mock_set_micros(1000);
+    g_message_bus.init();
+    g_message_bus.resetSubscribers();
+    sd_logger_init();
+    card.clear();
+    write_sizes.clear();
+    card_busy = false;
+    card_fails = false;
+    card_closed = false;
+}
+
+static void log_float(uint32_t msg_id, float value) {
+    CANMessage msg = {};
+    msg.id = msg_id;
+    msg.len = 4;
+    msg.timestamp_us = micros();
+    memcpy(msg.buf, &value, 4);
+    sd_logger_log_message(&msg);
+}
+
+static void drain(void) {
+    for (int i = 0; i < 1000 && !sd_logger_is_idle(); i++) {
+        sd_logger_update();
+    }
+}
+
+// Test masked bus channels reach the card as timestamped records
+TEST(bus_channels_are_logged) {
+    setup();
+    assert(sd_logger_add_channels(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, 0),
+                                  ECU_BASE_MASK | SUBSYSTEM_MASK));
+    assert(sd_logger_add_channels(MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_SENSORS, 0),
+                                  ECU_BASE_MASK | SUBSYSTEM_MASK));     // Duplicate: no second handler
+    assert(sd_logger_start(&mock_sink));
+    assert(!sd_logger_start(&mock_sink));
+
+    float rpm = 3000.0f;
+    float coolant = 90.0f;
+    float pulse = 2.5f;
+    g_message_bus.publish(MSG_ENGINE_RPM, &rpm, sizeof(rpm));
+    mock_advance_time_us(250);
+    g_message_bus.publish(MSG_COOLANT_TEMP, &coolant, sizeof(coolant));
+    g_message_bus.publish(MSG_FUEL_PULSE_WIDTH, &pulse, sizeof(pulse));     // Not subscribed
+    g_message_bus.process();
+
+    sd_logger_stop();
+    drain();
+    assert(card_closed);
+
+    std::vector<LoggedRecord> records = parse_card();
+    assert(records.size() == 2);
+    assert(records[0].msg_id == MSG_ENGINE_RPM);
+    assert(records[1].msg_id == MSG_COOLANT_TEMP);
+    assert(records[0].timestamp_us == 1000);     // Publish stamps, not delivery time
+    assert(records[1].timestamp_us - records[0].timestamp_us == 250);
+    float value;
+    memcpy(&value, records[1].data.data(), 4);
+    assert(value == 90.0f);
+    assert(card.size() == SD_LOGGER_SECTOR_SIZE);    // Partial block: used sectors only
+    assert(sd_logger_get_stats()->records == 2);
+}
+
+// Test 48 channels at 1 kHz for a second: every record lands, in whole sectors
+TEST(sustained_1khz_logging) {
+    setup();
+    assert(sd_logger_start(&mock_sink));
+
+    const uint32_t channels = 48;
+    for (uint32_t ms = 0; ms < 1000; ms++) {
+        for (uint32_t c = 0; c < channels; c++) {
+            log_float(MSG_FUEL_MAP_CELL(0, c), (float)(ms * channels + c));
+        }
+        sd_logger_update();
+        mock_advance_time_us(1000);
+    }
+    sd_logger_stop();
+    drain();
+
+    const sd_logger_stats_t* stats = sd_logger_get_stats();
+    assert(stats->records == channels * 1000);
+    assert(stats->dropped == 0);
+    for (size_t size : write_sizes) {
+        assert(size % SD_LOGGER_SECTOR_SIZE == 0 && size <= SD_LOGGER_WRITE_CHUNK);
+    }
+
+    std::vector<sd_log_block_header_t> headers;
+    std::vector<LoggedRecord> records = parse_card(&headers);
+    assert(records.size() == channels * 1000);
+    for (size_t i = 0; i < records.size(); i++) {
+        float value;
+        memcpy(&value, records[i].data.data(), 4);
+        assert(value == (float)i);
+    }
+    for (size_t i = 0; i < headers.size(); i++) {
+        assert(headers[i].sequence == i);
+    }
+    assert(records.back().timestamp_us - records.front().timestamp_us == 999000);
+}
+
+// Test a busy card defers writes, then both blocks fill and records drop
+TEST(busy_card_drops_not_blocks) {
+    setup();
+    assert(sd_logger_start(&mock_sink));
+    card_busy = true;
+
+    // Two blocks' worth and then some, with the card never ready
+    // (a block is sealed once a maximum-size record might not fit)
+    uint32_t per_block = (SD_LOGGER_BLOCK_SIZE - sizeof(sd_log_block_header_t) - SD_LOGGER_RECORD_MAX) /
+                         (SD_LOGGER_RECORD_HEADER + 4) + 1;
+    for (uint32_t i = 0; i < per_block * 2 + 100; i++) {
+        log_float(MSG_ENGINE_RPM, (float)i);
+        sd_logger_update();
+    }
+    const sd_logger_stats_t* stats = sd_logger_get_stats();
+    assert(card.empty());
+    assert(stats->busy_deferrals > 0);
+    assert(stats->dropped == 100);
+
+    // Card comes back: both blocks go out. The drops came after both were
+    // sealed, so only the stats show them
+    card_busy = false;
+    sd_logger_stop();
+    drain();
+    std::vector<sd_log_block_header_t> headers;
+    std::vector<LoggedRecord> records = parse_card(&headers);
+    assert(records.size() == per_block * 2);
+    assert(headers.size() == 2);
+    assert(headers[0].dropped == 0);
+}
+
+// Test a quiet log is sealed after SD_LOGGER_SEAL_US instead of waiting for a full block
+TEST(partial_block_sealed_on_timeout) {
+    setup();
+    assert(sd_logger_start(&mock_sink));
+    log_float(MSG_ENGINE_RPM, 1.0f);
+    sd_logger_update();
+    assert(card.empty());
+
+    mock_advance_time_us(SD_LOGGER_SEAL_US);
+    sd_logger_update();     // Seals and writes the one used sector
+    assert(card.size() == SD_LOGGER_SECTOR_SIZE);
+    assert(sd_logger_is_logging());
+
+    // Logging carries on into the other block
+    log_float(MSG_ENGINE_RPM, 2.0f);
+    sd_logger_stop();
+    drain();
+    std::vector<LoggedRecord> records = parse_card();
+    assert(records.size() == 2);
+}
+
+// Test a write error stops the log and closes the sink
+TEST(write_error_stops_logging) {
+    setup();
+    assert(sd_logger_start(&mock_sink));
+    card_fails = true;
+    log_float(MSG_ENGINE_RPM, 1.0f);
+    mock_advance_time_us(SD_LOGGER_SEAL_US);
+    sd_logger_update();
+    assert(sd_logger_get_stats()->write_errors == 1);
+    assert(!sd_logger_is_logging());
+    assert(sd_logger_is_idle());
+    assert(card_closed);
+
+    // Logging after the error is a no-op
+    log_float(MSG_ENGINE_RPM, 2.0f);
+    assert(sd_logger_get_stats()->records == 1);
+
+    // No card on desktop
+    assert(!sd_logger_start_sd());
+}
+
+int main() {
+    std::cout << "=== SD Logger Tests ===" << std::endl;
+
+    run_test_bus_channels_are_logged();
+    run_test_sustained_1khz_logging();
+    run_test_busy_card_drops_not_blocks();
+    run_test_partial_block_sealed_on_timeout();
+    run_test_write_error_stops_logging();
+
+    std::cout << std::endl;
+    std::cout << "SD Logger Tests - Run: " << tests_run << ", Passed: " << tests_passed << std::endl;
+
+    if (tests_passed == tests_run) {
+        std::cout << "✅ ALL SD LOGGER TESTS PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME SD LOGGER TESTS FAILED!" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,116 @@
+// tests/signal_store/test_signal_store.cpp
+// Test suite for the shared latest-value signal store
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+// Include enhanced mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../signal_store.h"
+
+// Simple test framework
+int tests_run = 0;
+int tests_passed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        std::cout << "  Running test: " #name "... "; \
+        tests_run++; \
+        test_##name(); \
+        tests_passed++; \
+        std::cout << "PASSED" << std::endl; \
+    } \
+    void test_##name()
+
+static void setup(void) {
+    mock_reset_all();
+    g_message_bus.init();
+    signal_store_init();
+}
+
+// Test signals start missing and fill from the bus
+TEST(fed_by_bus) {
+    setup();
+    float value = -1.0f;
+    signal_sample_t sample;
+    assert(!signal_store_get(SIGNAL_THROTTLE_POSITION, &value));
+    assert(value == -1.0f);
+    assert(!signal_store_read(SIGNAL_THROTTLE_POSITION, &sample));
+    assert(signal_store_get_or(SIGNAL_THROTTLE_POSITION, 20.0f) == 20.0f);
+
+    mock_set_millis(1234);
+    g_message_bus.publishFloat(MSG_THROTTLE_POSITION, 42.5f);
+    g_message_bus.publishFloat(MSG_VEHICLE_SPEED, 61.0f);
+    g_message_bus.process();
+
+    assert(signal_store_get(SIGNAL_THROTTLE_POSITION, &value));
+    assert(value == 42.5f);
+    assert(signal_store_get_or(SIGNAL_VEHICLE_SPEED, 0.0f) == 61.0f);
+    assert(signal_store_read(SIGNAL_THROTTLE_POSITION, &sample));
+    assert(sample.value == 42.5f);
+    assert(sample.timestamp_ms == 1234);
+
+    // Other signals untouched
+    assert(!signal_store_get(SIGNAL_BRAKE_PEDAL, &value));
+    assert(signal_store_get_msg_id(SIGNAL_BRAKE_PEDAL) == MSG_BRAKE_PEDAL);
+}
+
+// Test values go stale after their max age but stay readable raw
+TEST(stale_after_max_age) {
+    setup();
+    mock_set_millis(1000);
+    signal_store_set(SIGNAL_THROTTLE_POSITION, 80.0f);     // 500 ms max age
+    signal_store_set(SIGNAL_COOLANT_TEMP, 90.0f);          // 2000 ms max age
+
+    mock_set_millis(1499);
+    assert(signal_store_get_or(SIGNAL_THROTTLE_POSITION, 20.0f) == 80.0f);
+    mock_set_millis(1500);
+    assert(signal_store_get_or(SIGNAL_THROTTLE_POSITION, 20.0f) == 20.0f);
+    assert(signal_store_get_or(SIGNAL_COOLANT_TEMP, 0.0f) == 90.0f);
+
+    signal_sample_t sample;
+    assert(signal_store_read(SIGNAL_THROTTLE_POSITION, &sample));
+    assert(sample.value == 80.0f);
+
+    // A new value is fresh again
+    signal_store_set(SIGNAL_THROTTLE_POSITION, 10.0f);
+    assert(signal_store_get_or(SIGNAL_THROTTLE_POSITION, 20.0f) == 10.0f);
+}
+
+// Test init forgets everything and invalid handles are rejected
+TEST(init_and_bounds) {
+    setup();
+    signal_store_set(SIGNAL_ENGINE_RPM, 3000.0f);
+    signal_store_init();
+    float value;
+    assert(!signal_store_get(SIGNAL_ENGINE_RPM, &value));
+
+    signal_store_set(SIGNAL_COUNT, 1.0f);
+    assert(!signal_store_get(SIGNAL_COUNT, &value));
+    assert(signal_store_get_msg_id(SIGNAL_COUNT) == 0);
+}
+
+// Main test runner
+int main() {
+    std::cout << "=== Signal Store Tests ===" << std::endl;
+
+    run_test_fed_by_bus();
+    run_test_stale_after_max_age();
+    run_test_init_and_bounds();
+
+    std::cout << std::endl;
+    std::cout << "Signal Store Tests - Run: " << tests_run << ", Passed: " << tests_passed << std::endl;
+
+    if (tests_passed == tests_run) {
+        std::cout << "✅ ALL SIGNAL STORE TESTS PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME TESTS FAILED!" << std::endl;
+        return 1;
+    }
+}
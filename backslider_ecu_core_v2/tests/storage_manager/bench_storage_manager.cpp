@@ -0,0 +1,87 @@
+// tests/storage_manager/bench_storage_manager.cpp
+// Desktop microbenchmarks for the storage manager value cache
+//
+//   - load_float() of a cached key (hash index hit)
+//   - load_float() cycling through more keys than the cache holds, so every
+//     load misses, reads the backend and evicts
+//   - save_float() to a cached key (dirty, coalesced)
+//
+// Usage: make bench, or ./storage_manager/bench_storage_manager --output FILE
+// (see tests/bench.h for --baseline, --tolerance and --rounds)
+
+// Include mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../storage_manager.h"
+#include "../../spi_flash_storage_backend.h"
+#include "../bench.h"
+
+static const int LOADS_PER_ROUND = 100;
+static const uint32_t HOT_KEYS = StorageManager::CACHE_SIZE / 4;
+static const uint32_t COLD_KEYS = StorageManager::CACHE_SIZE * 4;   // Never all cached
+
+static SPIFlashStorageBackend backend;
+static StorageManager storage(&backend);
+
+static uint32_t key_for(uint32_t index) {
+    return MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_STORAGE, 0x1000 + index);
+}
+
+static void run_benchmarks(void) {
+    mock_reset_all();
+    g_message_bus.init();
+    storage.init();
+
+    // Every key on the backend; the hot set last, so it is what is cached
+    for (uint32_t i = 0; i < COLD_KEYS; i++) {
+        storage.save_float(key_for(HOT_KEYS + i), (float)i);
+    }
+    storage.force_commit_cache();
+    for (uint32_t i = 0; i < HOT_KEYS; i++) {
+        storage.save_float(key_for(i), (float)i);
+    }
+    storage.force_commit_cache();
+
+    static uint32_t next = 0;
+    bench_run("cache_load_hit", LOADS_PER_ROUND, [] {}, [] {
+        float value = 0;
+        float sum = 0;
+        for (int i = 0; i < LOADS_PER_ROUND; i++) {
+            storage.load_float(key_for(next++ % HOT_KEYS), &value);
+            sum += value;
+        }
+        bench_sink = bench_sink + (uint32_t)sum;
+    });
+
+    uint32_t misses_before = storage.get_cache_misses();
+    bench_run("cache_load_miss", LOADS_PER_ROUND, [] {}, [] {
+        float value = 0;
+        float sum = 0;
+        for (int i = 0; i < LOADS_PER_ROUND; i++) {
+            storage.load_float(key_for(HOT_KEYS + next++ % COLD_KEYS), &value);
+            sum += value;
+        }
+        bench_sink = bench_sink + (uint32_t)sum;
+    });
+    if (storage.get_cache_misses() == misses_before) {
+        std::cerr << "  cache_load_miss never missed" << std::endl;
+    }
+
+    // Reload the hot set, then overwrite it without flushing
+    for (uint32_t i = 0; i < HOT_KEYS; i++) {
+        float value;
+        storage.load_float(key_for(i), &value);
+    }
+    bench_run("cache_save_hit", LOADS_PER_ROUND, [] {}, [] {
+        for (int i = 0; i < LOADS_PER_ROUND; i++) {
+            storage.save_float(key_for(next % HOT_KEYS), (float)next);
+            next++;
+        }
+    });
+}
+
+int main(int argc, char** argv) {
+    return bench_main(argc, argv, "storage_manager", run_benchmarks);
+}
@@ -6,6 +6,7 @@
 #include <cstring>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "../mock_arduino.h"
 #include "../../storage_manager.h"
@@ -289,6 +290,311 @@ void test_map_cell_macros() {
     std::cout << "✓ Boost map cell macro test passed" << std::endl;
 }
 
+void test_table_blobs() {
+    std::cout << "\n=== Test 5: Table Blobs ===\n" << std::endl;
+    
+    // A 30 x 30 table with its axes, saved from and loaded into separate arrays
+    uint32_t blob_key = MSG_FUEL_MAP_BLOB;
+    float bins[30];
+    float cells[900];
+    for (int i = 0; i < 30; i++) bins[i] = 100.0f * i;
+    for (int i = 0; i < 900; i++) cells[i] = 0.5f * i;
+    StorageSegment segments[2] = {{bins, sizeof(bins)}, {cells, sizeof(cells)}};
+    uint32_t writes = test_storage_manager->get_disk_writes();
+    assert(test_storage_manager->save_blob(blob_key, 3, segments, 2));
+    assert(test_storage_manager->get_disk_writes() == writes + 1);
+    
+    float loaded_bins[30] = {0};
+    float loaded_cells[900] = {0};
+    StorageSegment loaded[2] = {{loaded_bins, sizeof(loaded_bins)}, {loaded_cells, sizeof(loaded_cells)}};
+    uint32_t reads = test_storage_manager->get_disk_reads();
+    assert(test_storage_manager->load_blob(blob_key, 3, loaded, 2));
+    assert(test_storage_manager->get_disk_reads() == reads + 1);
+    assert(memcmp(loaded_bins, bins, sizeof(bins)) == 0);
+    assert(memcmp(loaded_cells, cells, sizeof(cells)) == 0);
+    std::cout << "✓ Blob round trip in one read" << std::endl;
+    
+    // Another version or layout is rejected
+    assert(!test_storage_manager->load_blob(blob_key, 4, loaded, 2));
+    StorageSegment short_layout[2] = {{loaded_bins, sizeof(loaded_bins)}, {loaded_cells, 400 * sizeof(float)}};
+    assert(!test_storage_manager->load_blob(blob_key, 3, short_layout, 2));
+    
+    // So is a payload that no longer matches its CRC
+    uint8_t raw[sizeof(StorageBlobHeader) + sizeof(bins) + sizeof(cells)];
+    assert(test_storage_manager->load_data(blob_key, raw, sizeof(raw)));
+    raw[sizeof(raw) - 1] ^= 0x01;
+    assert(test_storage_manager->save_data(blob_key, raw, sizeof(raw)));
+    assert(!test_storage_manager->load_blob(blob_key, 3, loaded, 2));
+    assert(!test_storage_manager->load_blob(MSG_IGNITION_MAP_BLOB, 3, loaded, 2));
+    std::cout << "✓ Blob version, size and CRC checks passed" << std::endl;
+}
+
+void test_hashed_clock_cache(SPIFlashStorageBackend* backend) {
+    std::cout << "\n=== Test 6: Hashed CLOCK Cache ===\n" << std::endl;
+    
+    StorageManager manager(backend);
+    const uint32_t base_key = MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_FUEL, 0x40000);
+    
+    // A full working set of parameters stays cached: every reload is a hit
+    for (uint32_t i = 0; i < StorageManager::CACHE_SIZE; i++) {
+        assert(manager.save_float(base_key + i, (float)i));
+    }
+    assert(manager.get_cache_entry_count() == StorageManager::CACHE_SIZE);
+    assert(manager.get_disk_writes() == 0);
+    assert(manager.get_dirty_count() == StorageManager::CACHE_SIZE);
+    float value = 0.0f;
+    for (uint32_t i = 0; i < StorageManager::CACHE_SIZE; i++) {
+        assert(manager.load_float(base_key + i, &value));
+        assert(value == (float)i);
+    }
+    assert(manager.get_cache_hits() == StorageManager::CACHE_SIZE);
+    assert(manager.get_cache_misses() == 0 && manager.get_cache_evictions() == 0);
+    
+    // Flush now writes everything, leaving clean entries to evict
+    manager.force_commit_cache();
+    assert(manager.get_disk_writes() == StorageManager::CACHE_SIZE);
+    assert(manager.get_dirty_count() == 0);
+    
+    // One more key: the first sweep clears every reference bit and the
+    // hand takes entry 0
+    assert(manager.save_float(base_key + 1000, 1000.0f));
+    assert(manager.get_cache_evictions() == 1);
+    assert(!manager.is_cached(base_key));
+    
+    // A value touched since then gets a second chance; the next one goes
+    assert(manager.load_float(base_key + 1, &value));
+    assert(manager.save_float(base_key + 1001, 1001.0f));
+    assert(manager.is_cached(base_key + 1));
+    assert(!manager.is_cached(base_key + 2));
+    
+    // Evicted values reload from the backend, and the probe runs stay
+    // intact after entries are pulled out of them
+    assert(manager.load_float(base_key + 2, &value) && value == 2.0f);
+    assert(manager.get_cache_misses() == 1);
+    for (uint32_t i = 3; i < StorageManager::CACHE_SIZE; i++) {
+        if (manager.is_cached(base_key + i)) {
+            assert(manager.load_float(base_key + i, &value) && value == (float)i);
+        }
+    }
+    assert(manager.get_cache_misses() == 1);
+    assert(manager.get_cache_entry_count() == StorageManager::CACHE_SIZE);
+    
+    std::cout << "✓ Hashed CLOCK cache test passed" << std::endl;
+}
+
+// Backend whose writes each take 600 µs of mock time
+class SlowBackend : public SPIFlashStorageBackend {
+public:
+    bool writeData(uint32_t storage_key, const void* data, size_t dataSize) override {
+        mock_advance_time_us(600);
+        return SPIFlashStorageBackend::writeData(storage_key, data, dataSize);
+    }
+};
+
+void test_background_flusher() {
+    std::cout << "\n=== Test 7: Background Flusher ===\n" << std::endl;
+    
+    SlowBackend backend;
+    backend.begin();
+    StorageManager manager(&backend);
+    const uint32_t key_a = MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_IGNITION, 0x50001);
+    const uint32_t key_b = MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_IGNITION, 0x50002);
+    mock_set_millis(10000);
+    
+    // A value dragged in a tuning tool: five saves, one write
+    for (int i = 1; i <= 5; i++) {
+        assert(manager.save_float(key_a, (float)i));
+    }
+    assert(manager.get_coalesced_saves() == 4);
+    mock_advance_time_ms(200);
+    assert(manager.save_float(key_b, 20.0f));
+    
+    // Nothing is written inside the coalescing window
+    mock_advance_time_ms(100);
+    manager.update();
+    assert(manager.get_disk_writes() == 0);
+    
+    // Oldest first: A is due before B
+    mock_advance_time_ms(STORAGE_FLUSH_DELAY_MS - 300);
+    manager.update();
+    assert(manager.get_disk_writes() == 1);
+    float stored = 0.0f;
+    assert(backend.readData(key_a, &stored, sizeof(stored)) && stored == 5.0f);
+    assert(!backend.hasData(key_b));
+    mock_advance_time_ms(200);
+    manager.update();
+    assert(manager.get_disk_writes() == 2 && manager.get_dirty_count() == 0);
+    
+    // A burst of 20 saves is spread over calls by the time budget: two
+    // 600 µs writes per call
+    for (uint32_t i = 0; i < 20; i++) {
+        manager.save_float(key_b + 1 + i, (float)i);
+    }
+    mock_advance_time_ms(STORAGE_FLUSH_DELAY_MS);
+    uint32_t writes = manager.get_disk_writes();
+    manager.update();
+    assert(manager.get_disk_writes() == writes + 2);
+    assert(manager.get_dirty_count() == 18);
+    
+    // Flush now for shutdown
+    manager.force_commit_cache();
+    assert(manager.get_dirty_count() == 0);
+    assert(manager.get_disk_writes() == writes + 20);
+    
+    std::cout << "✓ Background flusher test passed" << std::endl;
+}
+
+void test_batched_access() {
+    std::cout << "\n=== Test 8: Batched Access ===\n" << std::endl;
+    
+    // A module's configuration saved and loaded with one call each
+    const uint32_t base_key = MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_EXTERNAL, 0x0300);
+    uint8_t count = 3;
+    uint32_t ids[3] = {0x100, 0x200, 0x300};
+    char name[16] = "batch";
+    StorageItem items[3] = {
+        {base_key + 2, ids, sizeof(ids), false},
+        {base_key, &count, sizeof(count), false},
+        {base_key + 1, name, sizeof(name), false},
+    };
+    uint32_t writes = test_storage_manager->get_disk_writes();
+    assert(test_storage_manager->save_many(items, 3) == 3);
+    assert(test_storage_manager->get_disk_writes() == writes + 1);
+    
+    uint8_t loaded_count = 0;
+    uint32_t loaded_ids[3] = {0};
+    char loaded_name[16] = {0};
+    uint32_t missing = 0;
+    StorageItem loaded[4] = {
+        {base_key, &loaded_count, sizeof(loaded_count), false},
+        {base_key + 1, loaded_name, sizeof(loaded_name), false},
+        {base_key + 2, loaded_ids, sizeof(loaded_ids), false},
+        {base_key + 3, &missing, sizeof(missing), false},
+    };
+    uint32_t reads = test_storage_manager->get_disk_reads();
+    assert(test_storage_manager->load_many(loaded, 4) == 3);
+    assert(test_storage_manager->get_disk_reads() == reads + 1);
+    assert(loaded[0].ok && loaded[1].ok && loaded[2].ok && !loaded[3].ok);
+    assert(loaded_count == 3);
+    assert(strcmp(loaded_name, "batch") == 0);
+    assert(memcmp(loaded_ids, ids, sizeof(ids)) == 0);
+    
+    assert(test_storage_manager->load_many(nullptr, 4) == 0);
+    
+    std::cout << "✓ Batched access test passed" << std::endl;
+}
+
+// Export frames as the host sees them
+static std::vector<storage_export_key_msg_t> exported_keys;
+static storage_export_start_msg_t export_start;
+static storage_export_complete_msg_t export_complete;
+static int export_starts = 0;
+static int export_completes = 0;
+
+void test_export_start_handler(const CANMessage* msg) {
+    memcpy(&export_start, msg->buf, sizeof(export_start));
+    export_starts++;
+}
+
+void test_export_key_handler(const CANMessage* msg) {
+    storage_export_key_msg_t frame;
+    memcpy(&frame, msg->buf, sizeof(frame));
+    exported_keys.push_back(frame);
+}
+
+void test_export_complete_handler(const CANMessage* msg) {
+    memcpy(&export_complete, msg->buf, sizeof(export_complete));
+    export_completes++;
+}
+
+static void request_export(uint8_t ecu_filter, uint8_t subsystem_filter, uint8_t window, uint32_t resume_after_key) {
+    storage_export_request_msg_t request = {0, ecu_filter, subsystem_filter, window, resume_after_key};
+    g_message_bus.publish(MSG_STORAGE_EXPORT_REQUEST, &request, sizeof(request));
+    g_message_bus.process();
+}
+
+static void grant_export_credits(uint16_t credits, uint8_t abort) {
+    storage_export_credit_msg_t credit = {credits, abort, {0}};
+    g_message_bus.publish(MSG_STORAGE_EXPORT_CREDIT, &credit, sizeof(credit));
+    g_message_bus.process();
+}
+
+static void run_export_updates(int count) {
+    for (int i = 0; i < count; i++) {
+        test_storage_manager->update();
+        g_message_bus.process();
+    }
+}
+
+void test_streaming_export() {
+    std::cout << "\n=== Test 9: Streaming Export ===\n" << std::endl;
+    
+    g_message_bus.subscribe(MSG_STORAGE_EXPORT_START, test_export_start_handler);
+    g_message_bus.subscribe(MSG_STORAGE_EXPORT_KEY, test_export_key_handler);
+    g_message_bus.subscribe(MSG_STORAGE_EXPORT_COMPLETE, test_export_complete_handler);
+    
+    // 30 values on the backend, saved in descending key order, and 10
+    // below them only in the cache
+    const uint32_t base_key = MAKE_EXTENDED_CAN_ID(ECU_BASE_TUNING, SUBSYSTEM_FUEL, 0x100);
+    for (uint32_t i = 39; i >= 10; i--) {
+        float value = 100.0f + i;
+        assert(test_storage_manager->save_data(base_key + i, &value, sizeof(value)));
+    }
+    for (uint32_t i = 0; i < 10; i++) {
+        assert(test_storage_manager->save_float(base_key + i, 500.0f + i));
+    }
+    assert(test_storage_manager->save_float(MAKE_EXTENDED_CAN_ID(ECU_BASE_TUNING, SUBSYSTEM_IGNITION, 0x100), 1.0f));
+    
+    // A window of 10 stops the stream at 10 frames
+    mock_set_millis(20000);
+    exported_keys.clear();
+    request_export(ECU_BASE_TUNING >> 28, SUBSYSTEM_FUEL >> 20, 10, 0);
+    assert(export_starts == 1 && export_start.success == 1);
+    assert(export_start.total_keys == 40);
+    run_export_updates(5);
+    assert(exported_keys.size() == 10);
+    assert(test_storage_manager->is_exporting());
+    
+    // More credit drains the rest, in ascending key order
+    grant_export_credits(100, 0);
+    run_export_updates(10);
+    assert(exported_keys.size() == 40);
+    assert(export_completes == 1 && export_complete.success == 1 && export_complete.keys_sent == 40);
+    assert(!test_storage_manager->is_exporting());
+    for (uint32_t i = 0; i < 40; i++) {
+        assert(exported_keys[i].storage_key == base_key + i);
+        float expected = (i < 10) ? 500.0f + i : 100.0f + i;
+        assert(exported_keys[i].value == expected);
+    }
+    std::cout << "✓ Credit-paced export in key order" << std::endl;
+    
+    // Aborted part way, it resumes after the last key received
+    exported_keys.clear();
+    request_export(ECU_BASE_TUNING >> 28, SUBSYSTEM_FUEL >> 20, 15, 0);
+    run_export_updates(3);
+    grant_export_credits(0, 1);
+    assert(export_completes == 2 && export_complete.success == 0);
+    assert(export_complete.last_key == exported_keys.back().storage_key);
+    
+    request_export(ECU_BASE_TUNING >> 28, SUBSYSTEM_FUEL >> 20, 255, export_complete.last_key);
+    assert(export_start.total_keys == 25);
+    run_export_updates(5);
+    assert(exported_keys.size() == 40);
+    assert(exported_keys[15].storage_key == base_key + 15);
+    std::cout << "✓ Export resumed from the last key" << std::endl;
+    
+    // A host that stops granting credit is timed out
+    request_export(ECU_BASE_TUNING >> 28, 0, 0, 0);
+    assert(export_start.total_keys == 41);
+    run_export_updates(2);
+    assert(test_storage_manager->is_exporting());
+    mock_set_millis(20000 + STORAGE_EXPORT_IDLE_MS);
+    run_export_updates(1);
+    assert(!test_storage_manager->is_exporting());
+    assert(export_complete.success == 0 && export_complete.keys_sent == 0);
+    std::cout << "✓ Idle export timed out" << std::endl;
+}
+
 int main() {
     std::cout << "=== Storage Manager Test Suite (Extended CAN ID Architecture) ===" << std::endl;
     
@@ -314,6 +620,11 @@ int main() {
         test_message_responses();
         test_cache_performance();
         test_map_cell_macros();
+        test_table_blobs();
+        test_hashed_clock_cache(&storage_backend);
+        test_background_flusher();
+        test_batched_access();
+        test_streaming_export();
         
         std::cout << "\n=== ALL TESTS PASSED ===" << std::endl;
         
@@ -4,11 +4,24 @@
 #include <iostream>
 #include <cassert>
 #include <cstring>
+#include <cstdlib>
+#include <new>
 #include <vector>
 #include "../mock_arduino.h"
 #include "../../w25q128_storage_backend.h"
 #include "../../ecu_config.h"
 
+// Counts heap allocations so tests can check storage calls make none
+static size_t heap_allocations = 0;
+void* operator new(size_t size) {
+    heap_allocations++;
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
 // Mock ECU configuration for testing
 ECUConfiguration createTestConfig() {
     ECUConfiguration config = {};
@@ -281,6 +294,536 @@ void test_extended_can_id_keys() {
     std::cout << "✓ Extended CAN ID key test passed" << std::endl;
 }
 
+void test_log_append_and_supersede() {
+    std::cout << "Testing log-structured append and supersede..." << std::endl;
+    
+    ECUConfiguration config = createTestConfig();
+    W25Q128StorageBackend backend(config);
+    backend.begin();
+    backend.enableWriteCache(false);
+    
+    // 100 rewrites of one float are 100 small records in a single sector
+    uint32_t key = 0x10300001;
+    for (int i = 0; i < 100; i++) {
+        float value = (float)i;
+        assert(backend.writeData(key, &value, sizeof(value)));
+    }
+    assert(backend.getRecordsWritten() == 100);
+    assert(backend.getUsedSpace() == W25Q128_SECTOR_SIZE);
+    assert(backend.getSectorEraseCount() == 0);
+    assert(backend.getLiveBytes() == 20);   // Only the latest record is live
+    
+    float read_value = 0.0f;
+    assert(backend.readData(key, &read_value, sizeof(read_value)));
+    assert(read_value == 99.0f);
+    
+    // Fill two more sectors: the closed, all-superseded ones are compacted
+    // from sync(), one per call. They hold records newer than any index
+    // checkpoint, so the first reclaim writes one (a sector of its own).
+    for (int i = 0; i < 500; i++) {
+        float value = (float)i;
+        assert(backend.writeData(key, &value, sizeof(value)));
+    }
+    assert(backend.getUsedSpace() == 3 * W25Q128_SECTOR_SIZE);
+    assert(backend.getCheckpointCount() == 0);
+    backend.sync();
+    assert(backend.getCheckpointCount() == 1);
+    assert(backend.getUsedSpace() == 3 * W25Q128_SECTOR_SIZE);
+    assert(backend.getSectorEraseCount() == 2);
+    assert(backend.readData(key, &read_value, sizeof(read_value)));
+    assert(read_value == 499.0f);
+    
+    std::cout << "✓ Log append and supersede test passed" << std::endl;
+}
+
+void test_log_rebuild_after_restart() {
+    std::cout << "Testing log index rebuild after restart..." << std::endl;
+    
+    ECUConfiguration config = createTestConfig();
+    W25Q128StorageBackend backend(config);
+    backend.begin();
+    backend.enableWriteCache(false);
+    
+    TestCalibrationData cal_a = {0x10300001, 0.5f, 1.0f, 1};
+    TestCalibrationData cal_b = {0x10300002, 0.25f, 2.0f, 1};
+    assert(backend.writeData(cal_a.sensor_id, &cal_a, sizeof(cal_a)));
+    assert(backend.writeData(cal_b.sensor_id, &cal_b, sizeof(cal_b)));
+    cal_a.offset = 0.75f;
+    assert(backend.writeData(cal_a.sensor_id, &cal_a, sizeof(cal_a)));
+    assert(backend.deleteData(cal_b.sensor_id));
+    
+    // Power lost without end(): no checkpoint, so the index comes back
+    // from the log alone
+    backend.begin();
+    backend.enableWriteCache(false);
+    
+    TestCalibrationData read_cal;
+    assert(backend.readData(cal_a.sensor_id, &read_cal, sizeof(read_cal)));
+    assert(read_cal.offset == 0.75f);
+    assert(!backend.hasData(cal_b.sensor_id));
+    assert(backend.getStoredKeyCount() == 1);
+    
+    // Appending resumes at the head
+    cal_a.offset = 1.5f;
+    assert(backend.writeData(cal_a.sensor_id, &cal_a, sizeof(cal_a)));
+    assert(backend.getUsedSpace() == W25Q128_SECTOR_SIZE);
+    assert(backend.readData(cal_a.sensor_id, &read_cal, sizeof(read_cal)));
+    assert(read_cal.offset == 1.5f);
+    
+    std::cout << "✓ Log rebuild test passed" << std::endl;
+}
+
+void test_checkpoint_and_replay() {
+    std::cout << "Testing index checkpoint and log replay at boot..." << std::endl;
+    
+    ECUConfiguration config = createTestConfig();
+    W25Q128StorageBackend backend(config);
+    backend.begin();
+    backend.enableWriteCache(false);
+    
+    // 2000 keys fill several sectors, then a checkpoint covers them
+    const uint32_t keys = 2000;
+    for (uint32_t i = 0; i < keys; i++) {
+        float value = (float)i;
+        assert(backend.writeData(0x10500000 + i, &value, sizeof(value)));
+    }
+    assert(backend.writeCheckpoint());
+    assert(backend.getCheckpointCount() == 1);
+    
+    // Writes after the checkpoint spill into new sectors; one key is
+    // deleted. Then power is lost without end().
+    for (uint32_t i = 0; i < 300; i++) {
+        float value = 10000.0f + i;
+        assert(backend.writeData(0x10500000 + i, &value, sizeof(value)));
+    }
+    assert(backend.deleteData(0x10500000 + 1500));
+    uint32_t used_space = backend.getUsedSpace();
+    
+    backend.begin();
+    backend.enableWriteCache(false);
+    
+    // Only the checkpoint's head sector and those linked after it are read
+    assert(backend.getBootScannedSectors() <= 3);
+    assert(backend.getStoredKeyCount() == keys - 1);
+    assert(!backend.hasData(0x10500000 + 1500));
+    assert(backend.getUsedSpace() == used_space);
+    float value = 0.0f;
+    assert(backend.readData(0x10500000 + 299, &value, sizeof(value)));
+    assert(value == 10299.0f);
+    assert(backend.readData(0x10500000 + 300, &value, sizeof(value)));
+    assert(value == 300.0f);
+    
+    // A clean shutdown checkpoints, so the next boot replays one sector
+    backend.end();
+    backend.begin();
+    backend.enableWriteCache(false);
+    assert(backend.getBootScannedSectors() == 1);
+    assert(backend.getStoredKeyCount() == keys - 1);
+    
+    // Sustained rewrites with sync() from the storage task keep working
+    // through checkpoints and reclaims, and survive another power loss
+    for (uint32_t pass = 0; pass < 20; pass++) {
+        for (uint32_t i = 0; i < keys; i++) {
+            if (i == 1500) continue;
+            float next = (float)(pass * keys + i);
+            assert(backend.writeData(0x10500000 + i, &next, sizeof(next)));
+        }
+        backend.sync();
+    }
+    assert(backend.getCheckpointCount() > 2);
+    
+    backend.begin();
+    backend.enableWriteCache(false);
+    assert(backend.getBootScannedSectors() < 64);
+    for (uint32_t i = 0; i < keys; i++) {
+        if (i == 1500) {
+            assert(!backend.hasData(0x10500000 + i));
+            continue;
+        }
+        assert(backend.readData(0x10500000 + i, &value, sizeof(value)));
+        assert(value == (float)(19 * keys + i));
+    }
+    
+    std::cout << "✓ Checkpoint and replay test passed" << std::endl;
+}
+
+void test_blob_records() {
+    std::cout << "Testing whole-table blob records..." << std::endl;
+    
+    ECUConfiguration config = createTestConfig();
+    W25Q128StorageBackend backend(config);
+    backend.begin();
+    
+    // A 30 x 30 map is one record, far larger than a flash page
+    float cells[900];
+    uint8_t shape[4] = {30, 30, 0, 0};
+    for (int i = 0; i < 900; i++) cells[i] = (float)i;
+    StorageSegment segments[2] = {{shape, sizeof(shape)}, {cells, sizeof(cells)}};
+    uint32_t key = 0x10100FF2;
+    assert(backend.writeBlob(key, segments, 2));
+    
+    uint8_t read_shape[4] = {0};
+    float read_cells[900] = {0};
+    StorageSegment read_segments[2] = {{read_shape, sizeof(read_shape)}, {read_cells, sizeof(read_cells)}};
+    assert(backend.readBlob(key, read_segments, 2));
+    assert(read_shape[0] == 30 && memcmp(read_cells, cells, sizeof(cells)) == 0);
+    
+    // Rewrites move it between sectors, garbage collection relocates it,
+    // and a restart without a checkpoint still finds the latest copy
+    for (int pass = 1; pass <= 10; pass++) {
+        cells[0] = (float)pass;
+        assert(backend.writeBlob(key, segments, 2));
+        backend.sync();
+    }
+    assert(backend.getSectorEraseCount() > 0);
+    backend.begin();
+    memset(read_cells, 0, sizeof(read_cells));
+    assert(backend.readBlob(key, read_segments, 2));
+    assert(read_cells[0] == 10.0f && read_cells[899] == 899.0f);
+    
+    // Too large for one sector
+    static float too_big[1100];
+    StorageSegment oversized = {too_big, sizeof(too_big)};
+    assert(!backend.writeBlob(key + 1, &oversized, 1));
+    
+    std::cout << "✓ Blob record test passed" << std::endl;
+}
+
+void test_log_garbage_collection() {
+    std::cout << "Testing log garbage collection under sustained rewrites..." << std::endl;
+    
+    ECUConfiguration config = createTestConfig();
+    W25Q128StorageBackend backend(config);
+    backend.begin();
+    backend.enableWriteCache(false);
+    
+    // A 30 x 30 map rewritten cell by cell until the log wraps the chip
+    // (18 MB of records) - only possible if superseded space is reclaimed
+    const uint32_t cells = 900;
+    const uint32_t passes = 1000;
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        for (uint32_t cell = 0; cell < cells; cell++) {
+            float value = (float)(pass * cells + cell);
+            bool result = backend.writeData(0x10400000 + cell, &value, sizeof(value));
+            assert(result && "Write failed once the log wrapped");
+        }
+    }
+    
+    for (uint32_t cell = 0; cell < cells; cell++) {
+        float value = 0.0f;
+        assert(backend.readData(0x10400000 + cell, &value, sizeof(value)));
+        assert(value == (float)((passes - 1) * cells + cell));
+    }
+    assert(backend.getLiveBytes() == cells * 20);
+    
+    // One erase per ~200 records instead of one sector per value
+    assert(backend.getSectorEraseCount() > 0);
+    assert(backend.getSectorEraseCount() * 100 < backend.getRecordsWritten());
+    
+    std::cout << "✓ Log garbage collection test passed" << std::endl;
+}
+
+static int async_completions = 0;
+static uint32_t async_completed_address = 0;
+static bool async_completed_ok = false;
+
+static void on_flash_operation(void* context, uint32_t address, bool success) {
+    (*(int*)context)++;
+    async_completed_address = address;
+    async_completed_ok = success;
+}
+
+void test_async_operations() {
+    std::cout << "Testing asynchronous flash operations..." << std::endl;
+    
+    ECUConfiguration config = createTestConfig();
+    W25Q128StorageBackend backend(config);
+    backend.begin();
+    backend.enableWriteCache(false);
+    
+    // Writes queue their programs and return; polling completes them
+    uint32_t key = 0x10300001;
+    float value = 12.5f;
+    assert(backend.writeData(key, &value, sizeof(value)));
+    assert(backend.getPendingOperations() > 0);
+    while (backend.getPendingOperations() > 0) {
+        mock_advance_time_us(100);
+        backend.poll();
+    }
+    
+    // An erase runs across several polls; the callback reports it
+    uint32_t far = 1000 * W25Q128_SECTOR_SIZE;
+    assert(backend.submitErase(far, on_flash_operation, &async_completions));
+    backend.poll();
+    mock_advance_time_us(W25Q128_ERASE_TIME_US / 2);
+    backend.poll();
+    assert(async_completions == 0);
+    assert(backend.getPendingOperations() == 1);
+    
+    // A read elsewhere suspends the erase instead of waiting it out
+    float read_value = 0.0f;
+    assert(backend.readData(key, &read_value, sizeof(read_value)));
+    assert(read_value == 12.5f);
+    assert(backend.getReadSuspendCount() > 0);
+    assert(async_completions == 0);
+    
+    mock_advance_time_us(W25Q128_ERASE_TIME_US / 2);
+    backend.poll();
+    assert(async_completions == 1);
+    assert(async_completed_address == far && async_completed_ok);
+    assert(backend.getPendingOperations() == 0);
+    
+    // Reading a value whose programs are still queued waits for them
+    value = 13.5f;
+    assert(backend.writeData(key, &value, sizeof(value)));
+    assert(backend.getPendingOperations() > 0);
+    assert(backend.readData(key, &read_value, sizeof(read_value)));
+    assert(read_value == 13.5f);
+    
+    // A full queue makes room by waiting for the oldest operation
+    uint8_t page[W25Q128_PAGE_SIZE];
+    memset(page, 0xA5, sizeof(page));
+    for (uint32_t i = 0; i < W25Q128_OP_QUEUE_SIZE + 4; i++) {
+        assert(backend.submitProgram(far + (i % 16) * W25Q128_PAGE_SIZE, page, sizeof(page)));
+    }
+    assert(backend.getQueueFullWaits() > 0);
+    assert(backend.waitForOperations());
+    assert(backend.getPendingOperations() == 0);
+    
+    // Programs may not cross a page; erases must be sector aligned
+    assert(!backend.submitProgram(far + W25Q128_PAGE_SIZE - 4, page, 8));
+    assert(!backend.submitErase(far + 512));
+    assert(backend.getErrorCount() == 0);
+    
+    std::cout << "✓ Asynchronous flash operation test passed" << std::endl;
+}
+
+void test_fixed_pools() {
+    std::cout << "Testing fixed-capacity index and write cache..." << std::endl;
+    
+    ECUConfiguration config = createTestConfig();
+    W25Q128StorageBackend backend(config);
+    backend.begin();
+    assert(backend.getIndexCapacity() == W25Q128_INDEX_CAPACITY);
+    assert(backend.getCacheCapacity() == W25Q128_CACHE_ENTRIES);
+    
+    // After begin() nothing allocates: cached writes, write-back, large
+    // values, deletes, garbage collection and checkpoints
+    size_t allocations = heap_allocations;
+    for (uint32_t i = 0; i < W25Q128_CACHE_ENTRIES + 8; i++) {
+        float value = (float)i;
+        assert(backend.writeData(0x10500000 + i, &value, sizeof(value)));
+    }
+    assert(backend.getCacheHighWater() == W25Q128_CACHE_ENTRIES);
+    uint8_t large[W25Q128_CACHE_VALUE_SIZE * 2];
+    memset(large, 0x3C, sizeof(large));
+    assert(backend.writeData(0x10600000, large, sizeof(large)));
+    backend.flush();
+    assert(backend.deleteData(0x10500000));
+    for (int i = 0; i < 600; i++) {
+        float value = (float)i;
+        assert(backend.writeData(0x10500001, &value, sizeof(value)));
+        backend.flush();
+        backend.sync();
+    }
+    assert(backend.writeCheckpoint());
+    assert(heap_allocations == allocations);
+    
+    for (uint32_t i = 2; i < W25Q128_CACHE_ENTRIES + 8; i++) {
+        float value = 0.0f;
+        assert(backend.readData(0x10500000 + i, &value, sizeof(value)));
+        assert(value == (float)i);
+    }
+    uint8_t large_read[sizeof(large)];
+    assert(backend.readData(0x10600000, large_read, sizeof(large_read)));
+    assert(memcmp(large, large_read, sizeof(large)) == 0);
+    
+    // The index refuses new keys once full but still takes rewrites
+    backend.enableWriteCache(false);
+    uint32_t keys = backend.getIndexCount();
+    for (uint32_t i = keys; i < W25Q128_INDEX_CAPACITY; i++) {
+        float value = (float)i;
+        assert(backend.writeData(0x10700000 + i, &value, sizeof(value)));
+    }
+    assert(backend.getIndexHighWater() == W25Q128_INDEX_CAPACITY);
+    float value = 1.0f;
+    assert(!backend.writeData(0x10800000, &value, sizeof(value)));
+    assert(strcmp(backend.getLastError(), "Index full") == 0);
+    assert(backend.writeData(0x10500002, &value, sizeof(value)));
+    assert(backend.deleteData(0x10500003));
+    assert(backend.writeData(0x10800000, &value, sizeof(value)));
+    
+    // A full index survives a checkpoint round trip
+    backend.end();
+    assert(backend.begin());
+    assert(backend.getIndexCount() == W25Q128_INDEX_CAPACITY);
+    assert(backend.getBootScannedSectors() <= 1);
+    assert(backend.readData(0x10800000, &value, sizeof(value)) && value == 1.0f);
+    assert(backend.readData(0x10700000 + W25Q128_INDEX_CAPACITY - 1, &value, sizeof(value)));
+    assert(value == (float)(W25Q128_INDEX_CAPACITY - 1));
+    
+    std::cout << "✓ Fixed pool test passed" << std::endl;
+}
+
+void test_memory_mapped_reads() {
+    std::cout << "Testing memory-mapped zero-copy reads..." << std::endl;
+    
+    // Only a memory-mapped chip hands out pointers
+    ECUConfiguration config = createTestConfig();
+    W25Q128StorageBackend spi_backend(config);
+    spi_backend.begin();
+    assert(!spi_backend.isMemoryMapped());
+    const void* data = nullptr;
+    size_t size = 0;
+    assert(!spi_backend.mapData(0x10300001, &data, &size));
+    
+    config.spi.qspi_flash.memory_mapped = true;
+    W25Q128StorageBackend backend(config);
+    assert(backend.begin());
+    assert(backend.isMemoryMapped());
+    
+    // A cached value is written back, then mapped in place
+    TestCalibrationData calibration = {7, 0.25f, 1.5f, 1};
+    assert(backend.writeData(0x10300001, &calibration, sizeof(calibration)));
+    assert(backend.mapData(0x10300001, &data, &size));
+    assert(size == sizeof(calibration));
+    assert(memcmp(data, &calibration, sizeof(calibration)) == 0);
+    
+    // A rewrite maps to the new record
+    calibration.offset = -0.5f;
+    assert(backend.writeData(0x10300001, &calibration, sizeof(calibration)));
+    const void* updated = nullptr;
+    assert(backend.mapData(0x10300001, &updated, &size));
+    assert(updated != data);
+    assert(((const TestCalibrationData*)updated)->offset == -0.5f);
+    backend.releaseData();
+    
+    // Mapping during an erase suspends it until released
+    int completions = 0;
+    assert(backend.submitErase(2000 * W25Q128_SECTOR_SIZE, on_flash_operation, &completions));
+    uint32_t suspends = backend.getReadSuspendCount();
+    assert(backend.mapData(0x10300001, &data, &size));
+    assert(backend.getReadSuspendCount() == suspends + 1);
+    mock_advance_time_us(W25Q128_ERASE_TIME_US);
+    backend.poll();                 // Releases, then completes the erase
+    assert(completions == 1);
+    
+    assert(!backend.mapData(0x10399999, &data, &size));
+    
+    std::cout << "✓ Memory-mapped read test passed" << std::endl;
+}
+
+void test_batched_access() {
+    std::cout << "Testing batched reads and writes..." << std::endl;
+    
+    ECUConfiguration config = createTestConfig();
+    W25Q128StorageBackend backend(config);
+    assert(backend.begin());
+    backend.enableWriteCache(false);
+    
+    // Twelve small values one at a time: header and data programmed apart
+    uint32_t values[12];
+    for (uint8_t i = 0; i < 12; i++) {
+        values[i] = 1000 + i;
+        assert(backend.writeData(0x10310000 + i, &values[i], sizeof(values[i])));
+    }
+    backend.waitForOperations();
+    
+    // The same as a batch: staged, then a page at a time
+    StorageItem items[12];
+    for (uint8_t i = 0; i < 12; i++) {
+        items[i] = {0x10320000u + i, &values[i], sizeof(values[i]), false};
+    }
+    uint32_t ops = backend.getCompletedOperations();
+    assert(backend.writeMany(items, 12) == 12);
+    backend.waitForOperations();
+    assert(backend.getCompletedOperations() - ops <= 2);
+    for (uint8_t i = 0; i < 12; i++) {
+        assert(items[i].ok);
+    }
+    
+    // Read back in reverse: sorted by address, fetched with one read
+    uint32_t loaded[12] = {0};
+    for (uint8_t i = 0; i < 12; i++) {
+        items[i] = {0x10320000u + 11 - i, &loaded[11 - i], sizeof(loaded[0]), false};
+    }
+    uint32_t reads = backend.getFlashReadCount();
+    assert(backend.readMany(items, 12) == 12);
+    assert(backend.getFlashReadCount() - reads == 1);
+    assert(memcmp(loaded, values, sizeof(values)) == 0);
+    
+    // A missing key fails alone; a repeated key keeps its last value; a
+    // value too big to stage goes to flash on its own
+    uint8_t table[600];
+    memset(table, 0x5A, sizeof(table));
+    uint32_t first = 1, second = 2;
+    StorageItem mixed[3] = {
+        {0x10330001, &first, sizeof(first), false},
+        {0x10330002, table, sizeof(table), false},
+        {0x10330001, &second, sizeof(second), false},
+    };
+    assert(backend.writeMany(mixed, 3) == 3);
+    
+    uint32_t value = 0;
+    uint8_t table_back[600] = {0};
+    uint32_t missing = 0;
+    StorageItem lookups[3] = {
+        {0x10330001, &value, sizeof(value), false},
+        {0x10399999, &missing, sizeof(missing), false},
+        {0x10330002, table_back, sizeof(table_back), false},
+    };
+    assert(backend.readMany(lookups, 3) == 2);
+    assert(lookups[0].ok && !lookups[1].ok && lookups[2].ok);
+    assert(value == 2);
+    assert(memcmp(table_back, table, sizeof(table)) == 0);
+    
+    // Cached values are served without touching flash
+    backend.enableWriteCache(true);
+    uint32_t cached = 77;
+    assert(backend.writeData(0x10340001, &cached, sizeof(cached)));
+    StorageItem hit = {0x10340001, &value, sizeof(value), false};
+    reads = backend.getFlashReadCount();
+    assert(backend.readMany(&hit, 1) == 1);
+    assert(value == 77 && backend.getFlashReadCount() == reads);
+    
+    // Batched records are ordinary records after a restart
+    backend.end();
+    assert(backend.begin());
+    assert(backend.readData(0x10320005, &value, sizeof(value)) && value == 1005);
+    assert(backend.readData(0x10330001, &value, sizeof(value)) && value == 2);
+    assert(backend.readData(0x10340001, &value, sizeof(value)) && value == 77);
+    
+    std::cout << "✓ Batched access test passed" << std::endl;
+}
+
+void test_ordered_key_listing() {
+    std::cout << "Testing ordered key listing..." << std::endl;
+    
+    ECUConfiguration config = createTestConfig();
+    W25Q128StorageBackend backend(config);
+    assert(backend.begin());
+    
+    // Flash and cache-only keys, two subsystems, written out of order
+    uint32_t value = 1;
+    const uint32_t keys[] = {0x10300009, 0x10200001, 0x10300002, 0x10300005, 0x10300001};
+    backend.enableWriteCache(false);
+    for (uint8_t i = 0; i < 4; i++) {
+        assert(backend.writeData(keys[i], &value, sizeof(value)));
+    }
+    backend.enableWriteCache(true);
+    assert(backend.writeData(keys[4], &value, sizeof(value)));
+    
+    // The smallest above the cursor come back in order, with the full count
+    uint32_t listed[2];
+    assert(backend.listKeys(0, SUBSYSTEM_MASK, 0x00300000, listed, 2) == 4);
+    assert(listed[0] == 0x10300001 && listed[1] == 0x10300002);
+    assert(backend.listKeys(0x10300002, SUBSYSTEM_MASK, 0x00300000, listed, 2) == 2);
+    assert(listed[0] == 0x10300005 && listed[1] == 0x10300009);
+    assert(backend.listKeys(0x10300009, 0, 0, listed, 2) == 0);
+    
+    std::cout << "✓ Ordered key listing test passed" << std::endl;
+}
+
 // Main test runner
 int main() {
     std::cout << "=== W25Q128 Storage Backend Test Suite ===" << std::endl;
@@ -292,6 +835,17 @@ int main() {
         std::cout << "Starting test 2..." << std::endl;
         test_basic_read_write();
         
+        test_log_append_and_supersede();
+        test_log_rebuild_after_restart();
+        test_checkpoint_and_replay();
+        test_blob_records();
+        test_async_operations();
+        test_fixed_pools();
+        test_memory_mapped_reads();
+        test_batched_access();
+        test_ordered_key_listing();
+        test_log_garbage_collection();
+        
         // Temporarily disable problematic tests
         /*
         std::cout << "Starting test 3..." << std::endl;
@@ -0,0 +1,226 @@
+// tests/task_executive/test_task_executive.cpp
+// Test suite for the fixed-rate main loop executive
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+// Include enhanced mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../task_executive.h"
+
+// Simple test framework
+int tests_run = 0;
+int tests_passed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        std::cout << "  Running test: " #name "... "; \
+        tests_run++; \
+        test_##name(); \
+        tests_passed++; \
+        std::cout << "PASSED" << std::endl; \
+    } \
+    void test_##name()
+
+// Task bodies count their calls and take a settable amount of mock time
+static uint32_t fast_calls = 0;
+static uint32_t medium_calls = 0;
+static uint32_t slow_calls = 0;
+static uint32_t background_calls = 0;
+static uint32_t fast_cost_us = 0;
+static uint32_t background_cost_us = 0;
+
+static void fast_task(void) {
+    fast_calls++;
+    mock_advance_time_us(fast_cost_us);
+}
+
+static void medium_task(void) {
+    medium_calls++;
+}
+
+static void slow_task(void) {
+    slow_calls++;
+}
+
+static void background_task(void) {
+    background_calls++;
+    mock_advance_time_us(background_cost_us);
+}
+
+static void setup(void) {
+    mock_reset_all();
+    mock_set_micros(5000);
+    task_executive_init();
+    fast_calls = medium_calls = slow_calls = background_calls = 0;
+    fast_cost_us = 0;
+    background_cost_us = 0;
+}
+
+// Run the loop for duration_us, one pass every step_us
+static void run_for(uint32_t duration_us, uint32_t step_us) {
+    for (uint32_t t = 0; t < duration_us; t += step_us) {
+        task_executive_run();
+        mock_advance_time_us(step_us);
+    }
+}
+
+// Test each slot runs at its own rate regardless of how fast the loop spins
+TEST(slots_run_at_fixed_rates) {
+    setup();
+    assert(task_executive_add("fast", fast_task, TASK_RATE_1KHZ, 100) == 0);
+    assert(task_executive_add("medium", medium_task, TASK_RATE_100HZ, 100) == 1);
+    assert(task_executive_add("slow", slow_task, TASK_RATE_10HZ, 100) == 2);
+    assert(task_executive_add("bad", nullptr, TASK_RATE_1KHZ, 100) == -1);
+    assert(task_executive_add("bad", fast_task, TASK_RATE_COUNT, 100) == -1);
+
+    // Loop spinning every 100 µs for one second
+    run_for(1000000, 100);
+    assert(fast_calls == 1000);
+    assert(medium_calls == 100);
+    assert(slow_calls == 10);
+    assert(task_executive_get_slot_misses(TASK_RATE_1KHZ) == 0);
+    assert(task_executive_get_total_overruns() == 0);
+    assert(task_executive_get_period_us(TASK_RATE_100HZ) == 10000);
+    assert(task_executive_get_period_us(TASK_RATE_BACKGROUND) == 0);
+}
+
+// Test budgets count overruns and a slot far behind skips missed releases
+TEST(overruns_and_slot_misses) {
+    setup();
+    task_executive_add("fast", fast_task, TASK_RATE_1KHZ, 100);
+
+    // One pass per release, each 50 µs over budget
+    fast_cost_us = 150;
+    for (uint8_t i = 0; i < 10; i++) {
+        task_executive_run();
+        mock_advance_time_us(850);
+    }
+    const task_t* task = task_executive_get_task(0);
+    assert(task->runs == 10);
+    assert(task->overruns == 10);
+    assert(task->max_us == 150);
+    assert(task_executive_get_total_overruns() == 10);
+
+    // A 3.5 ms stall runs the slot once, not four times to catch up
+    fast_cost_us = 0;
+    uint32_t runs = task->runs;
+    mock_advance_time_us(3500);
+    task_executive_run();
+    task_executive_run();
+    assert(task->runs == runs + 1);
+    assert(task_executive_get_slot_misses(TASK_RATE_1KHZ) == 1);
+}
+
+// Test background tasks wait for slack but are never starved
+TEST(background_fits_in_slack) {
+    setup();
+    task_executive_add("fast", fast_task, TASK_RATE_1KHZ, 100);
+    task_executive_add("background", background_task, TASK_RATE_BACKGROUND, 400);
+
+    // Straight after a release there is room for a 400 µs budget
+    task_executive_run();
+    assert(background_calls == 1);
+
+    // 200 µs before the next release there is not
+    mock_advance_time_us(800);
+    task_executive_run();
+    assert(background_calls == 1);
+    assert(task_executive_get_task(1)->deferrals == 1);
+
+    // Never any slack: it still runs once per TASK_BACKGROUND_MAX_WAIT_US
+    background_cost_us = 900;
+    run_for(TASK_BACKGROUND_MAX_WAIT_US * 3, 1000);
+    assert(background_calls >= 3);
+}
+
+// Test idle time is the share of each window not spent in tasks
+TEST(idle_percent) {
+    setup();
+    assert(task_executive_get_idle_percent() == 100.0f);
+    task_executive_add("fast", fast_task, TASK_RATE_1KHZ, 500);
+
+    fast_cost_us = 250;     // A quarter of every millisecond
+    run_for(TASK_EXECUTIVE_WINDOW_US + 2000, 750);
+    float idle = task_executive_get_idle_percent();
+    assert(fabsf(idle - 75.0f) < 1.0f);
+}
+
+static float received_cpu_load = -1.0f;
+static float received_max_us = -1.0f;
+static float received_task_load = -1.0f;
+static void stats_handler(const CANMessage* msg) {
+    if (msg->id == MSG_CPU_LOAD) received_cpu_load = MSG_UNPACK_FLOAT(msg);
+    if (msg->id == MSG_LOOP_TIME_MAX_US) received_max_us = MSG_UNPACK_FLOAT(msg);
+    if (msg->id == MSG_TASK_LOAD(0)) received_task_load = MSG_UNPACK_FLOAT(msg);
+}
+
+// Test the loop histogram keeps min/max/p99 and a single spike shows up
+TEST(loop_histogram_and_publishing) {
+    setup();
+    g_message_bus.init();
+    g_message_bus.resetSubscribers();
+    g_message_bus.subscribe(MSG_CPU_LOAD, stats_handler);
+    g_message_bus.subscribe(MSG_LOOP_TIME_MAX_US, stats_handler);
+    g_message_bus.subscribe(MSG_TASK_LOAD(0), stats_handler);
+    task_executive_add("fast", fast_task, TASK_RATE_1KHZ, 500);
+    assert(task_executive_get_loop_p99_us() == 0);
+
+    // 300 passes of 40 µs, with empty spins between that are not counted
+    fast_cost_us = 40;
+    for (uint16_t i = 0; i < 300; i++) {
+        task_executive_run();
+        mock_advance_time_us(460);
+        task_executive_run();
+        mock_advance_time_us(500);
+    }
+    const loop_histogram_t* hist = task_executive_get_loop_histogram();
+    assert(hist->samples == 300);
+    assert(hist->min_us == 40 && hist->max_us == 40);
+    assert(task_executive_get_loop_p99_us() == 50);
+
+    // One 2.4 ms spike: max shows it, p99 of 301 samples does not
+    fast_cost_us = 2400;
+    run_for(1000, 1000);
+    fast_cost_us = 40;
+    assert(hist->max_us == 2400);
+    assert(hist->counts[11] == 1);      // 2000..3000 µs bucket
+    assert(task_executive_get_loop_p99_us() == 50);
+
+    // Window end publishes load and loop stats
+    run_for(TASK_EXECUTIVE_WINDOW_US, 1000);
+    g_message_bus.process();
+    assert(received_cpu_load > 0.0f && received_cpu_load < 10.0f);
+    assert(received_max_us == 2400.0f);
+    assert(fabsf(received_task_load - task_executive_get_task(0)->load_percent) < 0.001f);
+    assert(fabsf(task_executive_get_task(0)->load_percent - task_executive_get_cpu_load_percent()) < 0.001f);
+
+    task_executive_reset_loop_stats();
+    assert(hist->samples == 0 && task_executive_get_loop_p99_us() == 0);
+}
+
+int main() {
+    std::cout << "=== Task Executive Tests ===" << std::endl;
+
+    run_test_slots_run_at_fixed_rates();
+    run_test_overruns_and_slot_misses();
+    run_test_background_fits_in_slack();
+    run_test_idle_percent();
+    run_test_loop_histogram_and_publishing();
+
+    std::cout << std::endl;
+    std::cout << "Task Executive Tests - Run: " << tests_run << ", Passed: " << tests_passed << std::endl;
+
+    if (tests_passed == tests_run) {
+        std::cout << "✅ ALL TASK EXECUTIVE TESTS PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME TASK EXECUTIVE TESTS FAILED!" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,163 @@
+// tests/trace_buffer/test_trace_buffer.cpp
+// Test suite for the binary trace ring
+
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+// Include mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../trace_buffer.h"
+
+// Simple test framework
+int tests_run = 0;
+int tests_passed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        std::cout << "  Running test: " #name "... "; \
+        tests_run++; \
+        test_##name(); \
+        tests_passed++; \
+        std::cout << "PASSED" << std::endl; \
+    } \
+    void test_##name()
+
+// Captured drain output
+static std::vector<uint8_t> drained_bytes;
+
+static size_t capture_writer(const uint8_t* data, size_t length) {
+    drained_bytes.insert(drained_bytes.end(), data, data + length);
+    return length;
+}
+
+TEST(record_and_read_in_order) {
+    trace_init();
+    mock_set_micros(1234);
+
+    TRACE(TRACE_CAT_MSG_BUS, TRACE_MSG_BUS_OVERFLOW, 2, 0x10300001, 0);
+    TRACE(TRACE_CAT_OUTPUT, TRACE_OUTPUT_NOT_FOUND, 5, 0x10500113, 7);
+    assert(trace_get_pending() == 2);
+    assert(trace_get_recorded() == 2);
+
+    trace_record_t record;
+    assert(trace_read(&record));
+    assert(record.timestamp_us == 1234);
+    assert(record.category == TRACE_CAT_MSG_BUS);
+    assert(record.event == TRACE_MSG_BUS_OVERFLOW);
+    assert(record.arg16 == 2);
+    assert(record.arg0 == 0x10300001);
+
+    assert(trace_read(&record));
+    assert(record.category == TRACE_CAT_OUTPUT);
+    assert(record.arg16 == 5);
+    assert(record.arg1 == 7);
+
+    assert(!trace_read(&record));
+    assert(trace_get_pending() == 0);
+}
+
+TEST(full_ring_drops_newest) {
+    trace_init();
+
+    for (uint32_t i = 0; i < TRACE_BUFFER_RECORDS + 10; i++) {
+        TRACE(TRACE_CAT_SYSTEM, 1, 0, i, 0);
+    }
+    assert(trace_get_pending() == TRACE_BUFFER_RECORDS);
+    assert(trace_get_dropped() == 10);
+
+    // Oldest records are kept; after reading one, recording works again
+    trace_record_t record;
+    assert(trace_read(&record));
+    assert(record.arg0 == 0);
+    TRACE(TRACE_CAT_SYSTEM, 1, 0, 999, 0);
+    assert(trace_get_pending() == TRACE_BUFFER_RECORDS);
+    assert(trace_get_dropped() == 10);
+
+    // Wraps correctly across several laps of the ring
+    for (uint32_t i = 1; i < TRACE_BUFFER_RECORDS; i++) {
+        assert(trace_read(&record));
+        assert(record.arg0 == i);
+    }
+    assert(trace_read(&record));
+    assert(record.arg0 == 999);
+    assert(!trace_read(&record));
+}
+
+TEST(drain_frames_records) {
+    trace_init();
+    drained_bytes.clear();
+
+    for (uint32_t i = 0; i < TRACE_FRAME_MAX_RECORDS + 3; i++) {
+        TRACE(TRACE_CAT_MSG_BUS, TRACE_MSG_BUS_PARAM_PUBLISH, 8, i, 0);
+    }
+
+    // Limit is honoured, then the rest drains in a second call
+    assert(trace_drain(capture_writer, 4) == 4);
+    assert(drained_bytes.size() == 3 + 4 * sizeof(trace_record_t));
+    assert(drained_bytes[0] == TRACE_FRAME_SYNC_0);
+    assert(drained_bytes[1] == TRACE_FRAME_SYNC_1);
+    assert(drained_bytes[2] == 4);
+
+    drained_bytes.clear();
+    assert(trace_drain(capture_writer, 100) == TRACE_FRAME_MAX_RECORDS - 1);
+    assert(drained_bytes[2] == TRACE_FRAME_MAX_RECORDS - 1);
+    assert(drained_bytes.size() == 3 + (TRACE_FRAME_MAX_RECORDS - 1) * sizeof(trace_record_t));
+
+    trace_record_t first;
+    memcpy(&first, &drained_bytes[3], sizeof(first));
+    assert(first.arg0 == 4);
+    assert(first.event == TRACE_MSG_BUS_PARAM_PUBLISH);
+
+    assert(trace_drain(capture_writer, 100) == 0);
+    assert(trace_drain(nullptr, 100) == 0);
+}
+
+TEST(message_bus_overflow_is_traced) {
+    trace_init();
+    MessageBus bus;
+    bus.init();
+
+    uint8_t payload[4] = {0};
+    uint16_t accepted = 0;
+    for (uint16_t i = 0; i < MessageBus::INTERNAL_QUEUE_SIZE + 2; i++) {
+        if (bus.publish(MSG_ENGINE_RPM, payload, sizeof(payload))) {
+            accepted++;
+        }
+    }
+    uint32_t overflows = bus.getQueueOverflows();
+    assert(overflows > 0);
+    assert(trace_get_pending() == overflows);
+
+    trace_record_t record;
+    assert(trace_read(&record));
+    assert(record.category == TRACE_CAT_MSG_BUS);
+    assert(record.event == TRACE_MSG_BUS_OVERFLOW);
+    assert(record.arg16 == MSG_PRIORITY_CRITICAL);
+    assert(record.arg0 == MSG_ENGINE_RPM);
+}
+
+int main() {
+    std::cout << "=== Trace Buffer Tests ===" << std::endl;
+
+    run_test_record_and_read_in_order();
+    run_test_full_ring_drops_newest();
+    run_test_drain_frames_records();
+    run_test_message_bus_overflow_is_traced();
+
+    std::cout << std::endl;
+    std::cout << "Trace Buffer Tests - Run: " << tests_run << ", Passed: " << tests_passed << std::endl;
+
+    if (tests_passed == tests_run) {
+        std::cout << "✅ ALL TRACE BUFFER TESTS PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME TRACE BUFFER TESTS FAILED!" << std::endl;
+        return 1;
+    }
+}
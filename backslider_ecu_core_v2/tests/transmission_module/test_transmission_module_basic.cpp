@@ -28,6 +28,8 @@
 #include "../../input_manager.h"
 #include "../../sensor_calibration.h"
 #include "../../transmission_module.h"
+#include "../../output_manager.h"
+#include "../../signal_store.h"
 
 // Include storage manager for custom_canbus_manager
 #include "../../storage_manager.h"
@@ -562,6 +564,56 @@ TEST(paddle_shifting_drive_only) {
     assert(transmission_get_shift_count() > after_neutral_count);
 }
 
+// Test shifts play a line-pressure profile from the ramp timer
+TEST(shift_pressure_profile) {
+    test_setup();
+    g_message_bus.init();
+    signal_store_init();
+    input_manager_init();
+    output_manager_init();
+    transmission_module_init();
+    
+    // Drive, settled at full line pressure (pressure ramp is the only one: handle 0)
+    mock_set_millis(1000);
+    g_message_bus.publishFloat(MSG_TRANS_DRIVE_SWITCH, 1.0f);
+    g_message_bus.process();
+    transmission_module_update();
+    g_message_bus.process();
+    output_ramp_run_ticks_for_testing(1);
+    assert(output_ramp_get_value(0) == 1.0f);
+    
+    // Light throttle 1-2: dips to 55% at 20 ms, 70% at 180 ms, full at 260 ms
+    g_message_bus.publishFloat(MSG_PADDLE_UPSHIFT, 1.0f);
+    g_message_bus.process();
+    transmission_module_update();
+    g_message_bus.process();
+    assert(transmission_get_profiled_shift_count() == 1);
+    assert(output_ramp_is_playing(0));
+    output_ramp_run_ticks_for_testing(21);
+    assert(std::fabs(output_ramp_get_value(0) - 0.55f) < 0.001f);
+    output_ramp_run_ticks_for_testing(80);
+    assert(std::fabs(output_ramp_get_value(0) - 0.625f) < 0.001f);     // Halfway up the slope
+    output_ramp_run_ticks_for_testing(160);
+    assert(!output_ramp_is_playing(0));
+    assert(output_ramp_get_value(0) == 1.0f);
+    
+    // Heavy throttle 2-1 uses the firmer table: 70% at 20 ms
+    g_message_bus.publishFloat(MSG_THROTTLE_POSITION, 80.0f);
+    mock_set_millis(2000);
+    g_message_bus.publishFloat(MSG_PADDLE_DOWNSHIFT, 1.0f);
+    g_message_bus.process();
+    transmission_module_update();
+    g_message_bus.process();
+    assert(transmission_get_profiled_shift_count() == 2);
+    output_ramp_run_ticks_for_testing(21);
+    assert(std::fabs(output_ramp_get_value(0) - 0.70f) < 0.001f);
+    
+    // Safe state stops the profile and drops the pressure at once
+    output_manager_safe_state();
+    assert(!output_ramp_is_playing(0));
+    assert(output_ramp_get_value(0) == 0.0f);
+}
+
 // =============================================================================
 // OVERRUN CLUTCH CONTROL TESTS
 // =============================================================================
@@ -582,6 +634,55 @@ TEST(overrun_clutch_basic_control) {
     assert(state->overrun_state == OVERRUN_ENGAGED);  // Race car default for control
 }
 
+// Test logic only runs on input changes and data timeouts
+TEST(overrun_clutch_event_driven) {
+    test_setup();
+    g_message_bus.init();
+    signal_store_init();
+    input_manager_init();
+    setup_output_message_capture();
+    transmission_module_init();
+    
+    const transmission_state_t* state = transmission_get_state();
+    mock_set_millis(1000);
+    transmission_module_update();
+    uint32_t evaluations = transmission_get_evaluation_count();
+    assert(evaluations == 1);
+    
+    // Nothing changed: no evaluation
+    for (int i = 0; i < 10; i++) {
+        transmission_module_update();
+    }
+    assert(transmission_get_evaluation_count() == evaluations);
+    
+    // Hard throttle at speed disengages the clutch
+    g_message_bus.publishFloat(MSG_THROTTLE_POSITION, 80.0f);
+    g_message_bus.publishFloat(MSG_VEHICLE_SPEED, 50.0f);
+    g_message_bus.process();
+    transmission_module_update();
+    g_message_bus.process();
+    assert(transmission_get_evaluation_count() == evaluations + 1);
+    assert(state->overrun_state == OVERRUN_DISENGAGED);
+    assert(captured_overrun == 1.0f);
+    
+    // The same values again are not a change
+    g_message_bus.publishFloat(MSG_THROTTLE_POSITION, 80.0f);
+    g_message_bus.process();
+    transmission_module_update();
+    assert(transmission_get_evaluation_count() == evaluations + 1);
+    
+    // Data older than 500 ms falls back to the safe defaults with no new message
+    mock_set_millis(1499);
+    transmission_module_update();
+    assert(transmission_get_evaluation_count() == evaluations + 1);
+    mock_set_millis(1500);
+    transmission_module_update();
+    g_message_bus.process();
+    assert(transmission_get_evaluation_count() == evaluations + 2);
+    assert(state->overrun_state == OVERRUN_ENGAGED);
+    assert(captured_overrun == 0.0f);
+}
+
 // Test overrun clutch manual override
 TEST(overrun_clutch_manual_override) {
     test_setup();
@@ -825,10 +926,12 @@ int main() {
     std::cout << "\n--- Paddle Shifting Tests ---" << std::endl;
     run_test_paddle_shifter_debouncing();
     run_test_paddle_shifting_drive_only();
+    run_test_shift_pressure_profile();
     
     // Run overrun clutch tests
     std::cout << "\n--- Overrun Clutch Tests ---" << std::endl;
     run_test_overrun_clutch_basic_control();
+    run_test_overrun_clutch_event_driven();
     run_test_overrun_clutch_manual_override();
     run_test_overrun_clutch_tuning();
     
@@ -0,0 +1,282 @@
+// tests/trigger_decoder/test_trigger_decoder.cpp
+// Test suite for the missing-tooth crank decoder
+
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+// Include enhanced mock Arduino before any ECU code
+#include "../mock_arduino.h"
+
+#include "../../msg_definitions.h"
+#include "../../msg_bus.h"
+#include "../../trigger_decoder.h"
+
+// Simple test framework
+int tests_run = 0;
+int tests_passed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        std::cout << "  Running test: " #name "... "; \
+        tests_run++; \
+        test_##name(); \
+        tests_passed++; \
+        std::cout << "PASSED" << std::endl; \
+    } \
+    void test_##name()
+
+static uint32_t sim_time_us = 0;
+
+// Feed one crank revolution: the tooth after the gap first, then the rest
+static void feed_revolution(const trigger_wheel_config_t* wheel, uint32_t period_us) {
+    uint8_t teeth = wheel->tooth_count - wheel->missing_teeth;
+    for (uint8_t i = 0; i < teeth; i++) {
+        sim_time_us += (i == 0) ? period_us * (wheel->missing_teeth + 1) : period_us;
+        trigger_decoder_crank_edge(sim_time_us);
+    }
+}
+
+static void feed_teeth(uint8_t count, uint32_t period_us) {
+    for (uint8_t i = 0; i < count; i++) {
+        sim_time_us += period_us;
+        trigger_decoder_crank_edge(sim_time_us);
+    }
+}
+
+static trigger_wheel_config_t make_wheel(uint8_t teeth, uint8_t missing, uint8_t cam) {
+    trigger_wheel_config_t wheel = {};
+    wheel.tooth_count = teeth;
+    wheel.missing_teeth = missing;
+    wheel.use_cam_sync = cam;
+    wheel.crank_edge = TRIGGER_EDGE_RISING;
+    wheel.cam_edge = TRIGGER_EDGE_RISING;
+    wheel.first_tooth_angle_deg = 0.0f;
+    wheel.stall_timeout_us = 100000;
+    return wheel;
+}
+
+static float received_rpm = -1.0f;
+static void rpm_handler(const CANMessage* msg) {
+    received_rpm = MSG_UNPACK_FLOAT(msg);
+}
+
+// Test 36-1 gap sync, per-tooth angle, extrapolation and instantaneous RPM
+TEST(crank_sync_36_1) {
+    mock_reset_all();
+    trigger_decoder_init();
+    trigger_wheel_config_t wheel = make_wheel(36, 1, 0);
+    wheel.first_tooth_angle_deg = 90.0f;
+    assert(trigger_decoder_configure(&wheel));
+    sim_time_us = 1000;
+
+    // 500 µs per tooth = 3333 RPM; no sync until the gap is seen
+    feed_teeth(10, 500);
+    trigger_state_t state;
+    assert(!trigger_decoder_get_state(&state));
+    assert(fabsf(state.rpm - 3333.3f) < 1.0f);
+
+    feed_revolution(&wheel, 500);
+    assert(trigger_decoder_get_state(&state));
+    assert(state.sync == TRIGGER_SYNC_CRANK);
+    assert(state.tooth_index == 34);
+    assert(fabsf(state.tooth_angle_deg - (90.0f + 340.0f - 360.0f)) < 0.01f);
+
+    // The tooth after the gap is position 0 at the configured angle
+    feed_teeth(1, 1000);
+    assert(trigger_decoder_get_state(&state));
+    assert(state.tooth_index == 0 && state.tooth_period_us == 500);
+    assert(fabsf(state.tooth_angle_deg - 90.0f) < 0.01f);
+
+    // Halfway to the next tooth is half a tooth further on
+    float angle = 0.0f;
+    assert(trigger_decoder_angle_at(sim_time_us + 250, &angle));
+    assert(fabsf(angle - 95.0f) < 0.01f);
+
+    // Instantaneous: one faster tooth changes RPM straight away
+    feed_teeth(1, 400);
+    assert(trigger_decoder_get_state(&state));
+    assert(fabsf(state.rpm - 4166.7f) < 1.0f);
+    assert(trigger_decoder_get_sync_loss_count() == 0);
+    assert(trigger_decoder_get_cycle_degrees() == 360.0f);
+}
+
+// Test 60-2 with one cam edge per cycle gives a 720° angle
+TEST(cam_sync_60_2) {
+    mock_reset_all();
+    trigger_decoder_init();
+    trigger_wheel_config_t wheel = make_wheel(60, 2, 1);
+    assert(trigger_decoder_configure(&wheel));
+    sim_time_us = 1000;
+
+    feed_revolution(&wheel, 300);
+    feed_revolution(&wheel, 300);
+    trigger_state_t state;
+    assert(trigger_decoder_get_state(&state) && state.sync == TRIGGER_SYNC_CRANK);
+
+    // Cam edge during this revolution: the next gap starts the cycle
+    trigger_decoder_cam_edge(sim_time_us);
+    feed_revolution(&wheel, 300);
+    assert(trigger_decoder_get_state(&state));
+    assert(state.sync == TRIGGER_SYNC_FULL);
+    assert(state.cycle_phase == 0);
+
+    // One more revolution: second half of the cycle
+    feed_revolution(&wheel, 300);
+    assert(trigger_decoder_get_state(&state));
+    assert(state.cycle_phase == 1 && state.tooth_index == 57);
+    assert(fabsf(state.tooth_angle_deg - (360.0f + 57 * 6.0f)) < 0.01f);
+    assert(trigger_decoder_get_cycle_degrees() == 720.0f);
+
+    // Cam on time keeps the phase; a missing cam is counted, not trusted
+    trigger_decoder_cam_edge(sim_time_us);
+    feed_revolution(&wheel, 300);
+    assert(trigger_decoder_get_state(&state) && state.cycle_phase == 0);
+    assert(trigger_decoder_get_cam_error_count() == 0);
+    feed_revolution(&wheel, 300);
+    feed_revolution(&wheel, 300);
+    assert(trigger_decoder_get_state(&state) && state.cycle_phase == 0);
+    assert(trigger_decoder_get_cam_error_count() == 1);
+}
+
+// Test a noise tooth or a lost gap is counted and handled
+TEST(sync_loss) {
+    mock_reset_all();
+    trigger_decoder_init();
+    trigger_wheel_config_t wheel = make_wheel(36, 1, 0);
+    assert(trigger_decoder_configure(&wheel));
+    sim_time_us = 1000;
+
+    feed_revolution(&wheel, 500);
+    feed_revolution(&wheel, 500);
+    assert(trigger_decoder_get_sync_loss_count() == 0);
+
+    // Gap after only 20 teeth: re-synced on the new gap
+    sim_time_us += 1000;
+    trigger_decoder_crank_edge(sim_time_us);
+    feed_teeth(19, 500);
+    sim_time_us += 1000;
+    trigger_decoder_crank_edge(sim_time_us);
+    trigger_state_t state;
+    assert(trigger_decoder_get_sync_loss_count() == 1);
+    assert(trigger_decoder_get_state(&state) && state.tooth_index == 0);
+
+    // Teeth where the gap should be: sync is dropped
+    feed_teeth(40, 500);
+    assert(trigger_decoder_get_sync_loss_count() == 2);
+    assert(!trigger_decoder_get_state(&state));
+
+    // Invalid wheels are rejected
+    trigger_wheel_config_t bad = make_wheel(36, 3, 0);
+    assert(!trigger_decoder_configure(&bad));
+}
+
+static float received_prediction_error = -1.0f;
+static void prediction_error_handler(const CANMessage* msg) {
+    received_prediction_error = MSG_UNPACK_FLOAT(msg);
+}
+
+// Test the crank-speed model follows a steady acceleration
+TEST(speed_model_predicts_acceleration) {
+    mock_reset_all();
+    g_message_bus.init();
+    g_message_bus.resetSubscribers();
+    g_message_bus.subscribe(MSG_CRANK_PREDICTION_ERROR, prediction_error_handler);
+    trigger_decoder_init();
+    trigger_wheel_config_t wheel = make_wheel(36, 1, 0);
+    assert(trigger_decoder_configure(&wheel));
+    trigger_decoder_begin(2, TRIGGER_NO_PIN);
+
+    sim_time_us = 1000;
+    feed_revolution(&wheel, 500);
+    feed_revolution(&wheel, 500);
+    trigger_state_t state;
+    assert(trigger_decoder_get_state(&state));
+    assert(state.period_slope_us == 0.0f);
+    // Steady speed: the model is the last period
+    assert(trigger_decoder_predict_delay_us(&state, 50.0f) == 2500);
+
+    // Gap, then each tooth 2 µs shorter than the one before
+    sim_time_us += 1000;
+    trigger_decoder_crank_edge(sim_time_us);
+    uint32_t period = 500;
+    for (uint8_t i = 0; i < 20; i++) {
+        period -= 2;
+        feed_teeth(1, period);
+    }
+    assert(trigger_decoder_get_state(&state));
+    assert(fabsf(state.period_slope_us + 2.0f) < 0.1f);
+
+    // Ten teeth ahead: the model lands far closer than the last period does
+    uint32_t predicted = trigger_decoder_predict_delay_us(&state, 100.0f);
+    uint32_t naive = (uint32_t)(100.0f * state.us_per_degree);
+    uint32_t start_us = sim_time_us;
+    for (uint8_t i = 0; i < 10; i++) {
+        period -= 2;
+        feed_teeth(1, period);
+    }
+    int32_t actual = (int32_t)(sim_time_us - start_us);
+    assert(abs(actual - (int32_t)predicted) * 4 < abs(actual - (int32_t)naive));
+
+    // Self-checks score the model and report in crank degrees
+    assert(trigger_decoder_get_prediction_checks() > 0);
+    assert(fabsf(trigger_decoder_get_prediction_error_deg()) < 0.3f);
+    mock_set_micros(sim_time_us + 100);
+    mock_advance_time_us(TRIGGER_DECODER_PUBLISH_INTERVAL_US);
+    trigger_decoder_update();
+    g_message_bus.process();
+    assert(received_prediction_error >= 0.0f && received_prediction_error < 1.0f);
+}
+
+// Test the main-loop update publishes RPM and drops sync on a stall
+TEST(update_publishes_and_detects_stall) {
+    mock_reset_all();
+    g_message_bus.init();
+    g_message_bus.resetSubscribers();
+    g_message_bus.subscribe(MSG_ENGINE_RPM, rpm_handler);
+    trigger_decoder_init();
+    trigger_wheel_config_t wheel = make_wheel(36, 1, 0);
+    assert(trigger_decoder_configure(&wheel));
+    trigger_decoder_begin(2, TRIGGER_NO_PIN);
+
+    sim_time_us = 1000;
+    feed_revolution(&wheel, 500);
+    feed_revolution(&wheel, 500);
+    mock_set_micros(sim_time_us + 100);
+    mock_advance_time_us(TRIGGER_DECODER_PUBLISH_INTERVAL_US);
+    trigger_decoder_update();
+    g_message_bus.process();
+    // Time has moved on without teeth but is inside the stall timeout
+    assert(fabsf(received_rpm - 3333.3f) < 1.0f);
+
+    mock_advance_time_us(wheel.stall_timeout_us);
+    trigger_decoder_update();
+    g_message_bus.process();
+    trigger_state_t state;
+    assert(!trigger_decoder_get_state(&state));
+    assert(state.rpm == 0.0f);
+    assert(received_rpm == 0.0f);
+}
+
+int main() {
+    std::cout << "=== Trigger Decoder Tests ===" << std::endl;
+
+    run_test_crank_sync_36_1();
+    run_test_cam_sync_60_2();
+    run_test_sync_loss();
+    run_test_speed_model_predicts_acceleration();
+    run_test_update_publishes_and_detects_stall();
+
+    std::cout << std::endl;
+    std::cout << "Trigger Decoder Tests - Run: " << tests_run << ", Passed: " << tests_passed << std::endl;
+
+    if (tests_passed == tests_run) {
+        std::cout << "✅ ALL TRIGGER DECODER TESTS PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME TRIGGER DECODER TESTS FAILED!" << std::endl;
+        return 1;
+    }
+}
@@ -2,6 +2,7 @@
 // Implementation of thermistor table generation functions
 
 #include "thermistor_table_generator.h"
+#include "sensor_calibration.h"
 #include <math.h>
 
 // =============================================================================
@@ -95,4 +96,21 @@ float generate_thermistor_table(
     }
     
     return beta;
-}
\ No newline at end of file
+}
+
+void generate_thermistor_counts_lut(
+    const float* voltage_table,
+    const float* temp_table,
+    uint8_t table_size,
+    float* lut
+) {
+    if (lut == nullptr) {
+        return;
+    }
+    
+    for (uint16_t i = 0; i < THERMISTOR_LUT_SIZE; i++) {
+        // Same counts-to-voltage conversion as adc_counts_to_voltage()
+        float voltage = ((i << THERMISTOR_LUT_SHIFT) * ADC_VOLTAGE_REF) / ADC_RESOLUTION;
+        lut[i] = interpolate_table(voltage_table, temp_table, table_size, voltage);
+    }
+}
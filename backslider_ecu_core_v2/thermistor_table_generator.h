@@ -39,6 +39,24 @@ float generate_thermistor_table(
     float* temp_table
 );
 
+/**
+ * Resample a voltage/temperature table into a counts-indexed lookup table
+ * for thermistor_config_t.counts_lut (boot-time alternative to the
+ * compile-time tables in sensor_calibration.cpp)
+ * 
+ * @param voltage_table Voltage points (ascending or descending)
+ * @param temp_table    Corresponding temperature points
+ * @param table_size    Number of points in the tables
+ * @param lut           Output array of THERMISTOR_LUT_SIZE entries; entry i
+ *                      is the temperature at i << THERMISTOR_LUT_SHIFT counts
+ */
+void generate_thermistor_counts_lut(
+    const float* voltage_table,
+    const float* temp_table,
+    uint8_t table_size,
+    float* lut
+);
+
 /**
  * Calculate Beta coefficient from two temperature/resistance points
  * 
@@ -0,0 +1,168 @@
+// trace_buffer.cpp
+// Implementation of the binary trace ring
+
+#include "trace_buffer.h"
+#include "memory_placement.h"
+#include <string.h>
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+// Ring slot. A slot is free for position p when sequence == p and holds the
+// record for p when sequence == p + 1 (same scheme as the bus ISR queue).
+typedef struct {
+    volatile uint32_t sequence;
+    trace_record_t record;
+} trace_slot_t;
+
+static trace_slot_t trace_slots[TRACE_BUFFER_RECORDS];
+static uint32_t trace_enqueue_pos = 0;
+static uint32_t trace_dequeue_pos = 0;
+static uint32_t trace_recorded = 0;
+static uint32_t trace_dropped = 0;
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void trace_init(void) {
+    for (uint32_t i = 0; i < TRACE_BUFFER_RECORDS; i++) {
+        trace_slots[i].sequence = i;
+    }
+    trace_enqueue_pos = 0;
+    trace_dequeue_pos = 0;
+    trace_recorded = 0;
+    trace_dropped = 0;
+}
+
+ECU_HOT_CODE void trace_record(uint8_t category, uint8_t event, uint16_t arg16, uint32_t arg0, uint32_t arg1) {
+    // May run in interrupt context - claim a slot with CAS, never block
+    uint32_t pos = __atomic_load_n(&trace_enqueue_pos, __ATOMIC_RELAXED);
+    trace_slot_t* slot;
+    for (;;) {
+        slot = &trace_slots[pos & (TRACE_BUFFER_RECORDS - 1)];
+        uint32_t seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(seq - pos);
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&trace_enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Ring full (or trace_init() not called yet) - drop the new record
+            __atomic_fetch_add(&trace_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        } else {
+            pos = __atomic_load_n(&trace_enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->record.timestamp_us = micros();
+    slot->record.category = category;
+    slot->record.event = event;
+    slot->record.arg16 = arg16;
+    slot->record.arg0 = arg0;
+    slot->record.arg1 = arg1;
+
+    __atomic_fetch_add(&trace_recorded, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+}
+
+bool trace_read(trace_record_t* record) {
+    // Single consumer (main loop)
+    trace_slot_t* slot = &trace_slots[trace_dequeue_pos & (TRACE_BUFFER_RECORDS - 1)];
+    uint32_t seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    if (seq != trace_dequeue_pos + 1) {
+        return false;
+    }
+
+    *record = slot->record;
+    __atomic_store_n(&slot->sequence, trace_dequeue_pos + TRACE_BUFFER_RECORDS, __ATOMIC_RELEASE);
+    trace_dequeue_pos++;
+    return true;
+}
+
+uint16_t trace_drain(trace_writer_t writer, uint16_t max_records) {
+    if (writer == nullptr) {
+        return 0;
+    }
+
+    uint8_t frame[3 + TRACE_FRAME_MAX_RECORDS * sizeof(trace_record_t)];
+    uint16_t drained = 0;
+
+    while (drained < max_records) {
+        uint8_t count = 0;
+        uint16_t frame_limit = max_records - drained;
+        if (frame_limit > TRACE_FRAME_MAX_RECORDS) {
+            frame_limit = TRACE_FRAME_MAX_RECORDS;
+        }
+
+        trace_record_t record;
+        while (count < frame_limit && trace_read(&record)) {
+            memcpy(&frame[3 + count * sizeof(trace_record_t)], &record, sizeof(trace_record_t));
+            count++;
+        }
+        if (count == 0) {
+            break;
+        }
+
+        frame[0] = TRACE_FRAME_SYNC_0;
+        frame[1] = TRACE_FRAME_SYNC_1;
+        frame[2] = count;
+        writer(frame, 3 + count * sizeof(trace_record_t));
+        drained += count;
+    }
+
+    return drained;
+}
+
+#ifdef ARDUINO
+static size_t usb_trace_writer(const uint8_t* data, size_t length) {
+    return Serial.write(data, length);
+}
+#endif
+
+uint16_t trace_drain_usb(uint16_t max_records) {
+    #ifdef ARDUINO
+    // Only drain what fits in the USB transmit buffer so write() never blocks
+    const int frame_size = 3 + TRACE_FRAME_MAX_RECORDS * sizeof(trace_record_t);
+    uint16_t drained = 0;
+    while (drained < max_records && trace_get_pending() > 0 &&
+           Serial.availableForWrite() >= frame_size) {
+        uint16_t limit = max_records - drained;
+        if (limit > TRACE_FRAME_MAX_RECORDS) {
+            limit = TRACE_FRAME_MAX_RECORDS;
+        }
+        uint16_t count = trace_drain(usb_trace_writer, limit);
+        if (count == 0) {
+            break;
+        }
+        drained += count;
+    }
+    return drained;
+    #else
+    (void)max_records;
+    return 0;
+    #endif
+}
+
+uint16_t trace_get_pending(void) {
+    uint32_t claimed = __atomic_load_n(&trace_enqueue_pos, __ATOMIC_RELAXED);
+    return (uint16_t)(claimed - trace_dequeue_pos);
+}
+
+uint32_t trace_get_recorded(void) {
+    return trace_recorded;
+}
+
+uint32_t trace_get_dropped(void) {
+    return trace_dropped;
+}
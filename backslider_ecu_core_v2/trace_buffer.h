@@ -0,0 +1,134 @@
+// trace_buffer.h
+// Low-overhead binary tracing for hot paths
+
+/* =============================================================================
+ * TRACE BUFFER OVERVIEW
+ * =============================================================================
+ *
+ * Serial.print() in the control path can block for hundreds of microseconds
+ * when the USB buffer is full. Hot-path diagnostics use TRACE() instead: it
+ * writes one fixed-size binary record into a RAM ring and returns. The ring is
+ * drained over USB only when the main loop has slack (see
+ * MainApplication::run()), so tracing never adds blocking I/O to control work.
+ *
+ * CATEGORIES:
+ * - Each TRACE_CAT_* is one bit. TRACE_ENABLED_CATEGORIES (default: all) is a
+ *   compile-time mask; a TRACE() whose category is masked out compiles to
+ *   nothing. Build with e.g. -DTRACE_ENABLED_CATEGORIES=TRACE_CAT_MSG_BUS.
+ *
+ * RECORDS:
+ * - trace_record_t is 16 bytes: timestamp (µs), category bit, event code and
+ *   three arguments whose meaning is listed next to each event code below.
+ * - The ring is lock-free multi-producer, so TRACE() is safe from ISRs.
+ * - When the ring is full new records are dropped and counted
+ *   (trace_get_dropped()); records are never overwritten mid-drain.
+ *
+ * USB FRAMING (trace_drain_usb):
+ *   [0xEC][0x7A][count][count x trace_record_t, little-endian]
+ * A frame is only written when it fits in the USB transmit buffer. The port
+ * is shared with the USB SerialBridge, so callers only drain while the
+ * bridge TX ring is empty (a frame boundary on the wire).
+ *
+ * EXAMPLE:
+ *   TRACE(TRACE_CAT_MSG_BUS, TRACE_MSG_BUS_OVERFLOW, priority, msg_id, 0);
+ * =============================================================================
+ */
+
+#ifndef TRACE_BUFFER_H
+#define TRACE_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// =============================================================================
+// CATEGORIES
+// =============================================================================
+
+#define TRACE_CAT_MSG_BUS       (1u << 0)   // Message bus queues and dispatch
+#define TRACE_CAT_OUTPUT        (1u << 1)   // Output manager
+#define TRACE_CAT_INPUT         (1u << 2)   // Input manager / sensors
+#define TRACE_CAT_TRANSMISSION  (1u << 3)   // Transmission control
+#define TRACE_CAT_PARAMETER     (1u << 4)   // Parameter registry / requests
+#define TRACE_CAT_STORAGE       (1u << 5)   // Storage manager
+#define TRACE_CAT_EXTERNAL      (1u << 6)   // External CAN / serial
+#define TRACE_CAT_SYSTEM        (1u << 7)   // Main loop and system
+#define TRACE_CAT_ALL           0xFFu
+
+#ifndef TRACE_ENABLED_CATEGORIES
+#define TRACE_ENABLED_CATEGORIES TRACE_CAT_ALL
+#endif
+
+// =============================================================================
+// EVENT CODES (per category)
+// =============================================================================
+
+// TRACE_CAT_MSG_BUS
+#define TRACE_MSG_BUS_PARAM_PUBLISH     0x01  // arg16 = length, arg0 = CAN ID
+#define TRACE_MSG_BUS_PARAM_BROADCAST   0x02  // arg0 = CAN ID
+#define TRACE_MSG_BUS_OVERFLOW          0x03  // arg16 = lane, arg0 = CAN ID
+#define TRACE_MSG_BUS_ISR_OVERFLOW      0x04  // arg0 = CAN ID
+
+// TRACE_CAT_OUTPUT
+#define TRACE_OUTPUT_PWM_UPDATE         0x01  // arg16 = output index, arg0 = CAN ID, arg1 = float bits
+#define TRACE_OUTPUT_NOT_FOUND          0x02  // arg16 = output count, arg0 = CAN ID
+
+// TRACE_CAT_PARAMETER
+#define TRACE_PARAM_REQUEST             0x01  // arg16 = operation, arg0 = CAN ID, arg1 = channel << 8 | request ID
+#define TRACE_PARAM_NOT_FOUND           0x02  // arg16 = operation, arg0 = CAN ID
+
+// =============================================================================
+// RECORD FORMAT
+// =============================================================================
+
+typedef struct {
+    uint32_t timestamp_us;  // micros() when recorded
+    uint8_t category;       // One TRACE_CAT_* bit
+    uint8_t event;          // Category-specific event code
+    uint16_t arg16;
+    uint32_t arg0;
+    uint32_t arg1;
+} trace_record_t;
+
+#define TRACE_BUFFER_RECORDS    256     // Ring capacity (power of two, 4 KB)
+#define TRACE_FRAME_SYNC_0      0xEC
+#define TRACE_FRAME_SYNC_1      0x7A
+#define TRACE_FRAME_MAX_RECORDS 8       // Records per USB frame
+
+// Record a trace event if its category is compiled in
+#define TRACE(category, event, arg16, arg0, arg1) \
+    do { \
+        if ((TRACE_ENABLED_CATEGORIES) & (category)) { \
+            trace_record((uint8_t)(category), (uint8_t)(event), (uint16_t)(arg16), \
+                         (uint32_t)(arg0), (uint32_t)(arg1)); \
+        } \
+    } while (0)
+
+// Writer used by trace_drain(); returns bytes accepted
+typedef size_t (*trace_writer_t)(const uint8_t* data, size_t length);
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Reset the ring and counters (records made before the first call are dropped)
+void trace_init(void);
+
+// Append one record (use TRACE() so disabled categories compile out)
+void trace_record(uint8_t category, uint8_t event, uint16_t arg16, uint32_t arg0, uint32_t arg1);
+
+// Remove the oldest record; returns false when the ring is empty
+bool trace_read(trace_record_t* record);
+
+// Frame up to max_records and pass them to writer; returns records drained
+uint16_t trace_drain(trace_writer_t writer, uint16_t max_records);
+
+// Drain to USB Serial without blocking; no-op on desktop builds. Call only
+// between USB SerialBridge frames (its TX ring empty).
+uint16_t trace_drain_usb(uint16_t max_records);
+
+// Statistics
+uint16_t trace_get_pending(void);
+uint32_t trace_get_recorded(void);
+uint32_t trace_get_dropped(void);
+
+#endif
@@ -26,7 +26,9 @@
 #include "custom_canbus_manager.h"
 #include "external_message_broadcasting.h"
 #include "output_manager.h"
+#include "signal_store.h"
 #include <Arduino.h>
+#include <math.h>
 
 // Forward declarations to avoid header conflicts
 
@@ -47,6 +49,10 @@ extern CustomCanBusManager g_custom_canbus_manager;
 #define PADDLE_FILTER_STRENGTH           0       // No filtering for paddle shifters
 #define GEAR_SWITCH_FILTER_STRENGTH      0       // No filtering for gear switches
 
+// Publish-on-change for the fluid temperature (steady for minutes at a time)
+#define TRANS_TEMP_PUBLISH_DEADBAND_C    0.5f    // Publish on a 0.5°C change...
+#define TRANS_TEMP_HEARTBEAT_US          1000000 // ...or at least once a second
+
 // PWM frequency constants
 #define TRANS_PRESSURE_PWM_FREQ     250     // 250Hz for line pressure solenoid (typical auto solenoid range)
 #define TRANS_SOLENOID_PWM_FREQ     200     // 200Hz for digital solenoids (typical auto solenoid range)
@@ -69,6 +75,7 @@ extern CustomCanBusManager g_custom_canbus_manager;
 // Static lookup tables for transmission fluid temperature sensor
 static float trans_temp_voltage_table[TRANS_TEMP_TABLE_SIZE];
 static float trans_temp_temp_table[TRANS_TEMP_TABLE_SIZE];
+static float trans_temp_counts_lut[THERMISTOR_LUT_SIZE];
 
 // Transmission state
 static transmission_state_t trans_state;
@@ -86,21 +93,58 @@ static float overrun_minimum_speed_mph = OVERRUN_MINIMUM_SPEED_MPH;
 static float overrun_braking_speed_threshold = OVERRUN_BRAKING_SPEED_THRESHOLD;
 static float overrun_moderate_throttle_threshold = OVERRUN_MODERATE_THROTTLE_THRESHOLD;
 
-// External data caching for overrun control (from message bus)
-#define EXTERNAL_DATA_TIMEOUT_MS 500  // 500ms timeout for external data validity
-static float cached_throttle_position = 20.0f;  // Safe default
-static float cached_vehicle_speed = 35.0f;      // Safe default
-static bool cached_brake_active = false;        // Safe default
-static uint32_t last_throttle_update_ms = 0;
-static uint32_t last_speed_update_ms = 0;
-static uint32_t last_brake_update_ms = 0;
+// Driving conditions for overrun control, read from the signal store.
+// Missing or stale signals read as the safe defaults below.
+typedef struct {
+    float throttle_position;    // 0-100%
+    float vehicle_speed;        // MPH
+    bool braking;
+} overrun_inputs_t;
+static const overrun_inputs_t OVERRUN_INPUT_DEFAULTS = {20.0f, 35.0f, false};
+static overrun_inputs_t overrun_inputs = OVERRUN_INPUT_DEFAULTS;     // As last evaluated
+
+// Event-driven evaluation: handlers mark what changed, update() only runs
+// the logic when something is marked or the overrun inputs differ from
+// those last evaluated
+#define TRANS_DIRTY_GEAR_SWITCHES   0x01
+#define TRANS_DIRTY_SHIFT_REQUEST   0x02
+#define TRANS_DIRTY_OVERRUN         0x04
+#define TRANS_DIRTY_ALL             0x07
+static uint8_t dirty_flags = TRANS_DIRTY_ALL;
+static uint32_t evaluation_count = 0;
 
 // Overrun clutch override control (for testing/diagnostics)
 static bool overrun_manual_override_active = false;
 static overrun_clutch_state_t overrun_manual_override_state = OVERRUN_DISENGAGED;
 
+// Line pressure through a shift, played by the output ramp timer (1 ms
+// resolution) on the pressure solenoid: a dip as the shift solenoids
+// switch, a slope through the clutch handover, then back to full pressure.
+// One table per gear change and load band; heavy throttle keeps more
+// pressure for a shorter, firmer handover. Starting points - calibrate on
+// the car.
+#define SHIFT_PROFILE_POINTS            4
+#define SHIFT_PROFILE_HEAVY_THROTTLE    50.0f   // Heavy-load tables at or above 50% throttle
+#define SHIFT_PROFILE_LOAD_BANDS        2
+#define SHIFT_PROFILE_GEAR_CHANGES      6       // 1-2, 2-3, 3-4, 2-1, 3-2, 4-3
+
+static const output_ramp_point_t SHIFT_PROFILES[SHIFT_PROFILE_GEAR_CHANGES][SHIFT_PROFILE_LOAD_BANDS][SHIFT_PROFILE_POINTS] = {
+    // Upshifts                        light throttle                                     heavy throttle
+    /* 1-2 */ {{{0, 1.0f}, {20, 0.55f}, {180, 0.70f}, {260, 1.0f}}, {{0, 1.0f}, {15, 0.75f}, {110, 0.85f}, {160, 1.0f}}},
+    /* 2-3 */ {{{0, 1.0f}, {20, 0.55f}, {200, 0.70f}, {280, 1.0f}}, {{0, 1.0f}, {15, 0.75f}, {120, 0.85f}, {170, 1.0f}}},
+    /* 3-4 */ {{{0, 1.0f}, {20, 0.60f}, {220, 0.75f}, {300, 1.0f}}, {{0, 1.0f}, {15, 0.80f}, {130, 0.90f}, {180, 1.0f}}},
+    // Downshifts
+    /* 2-1 */ {{{0, 1.0f}, {25, 0.50f}, {200, 0.60f}, {300, 1.0f}}, {{0, 1.0f}, {20, 0.70f}, {120, 0.80f}, {180, 1.0f}}},
+    /* 3-2 */ {{{0, 1.0f}, {25, 0.50f}, {220, 0.60f}, {320, 1.0f}}, {{0, 1.0f}, {20, 0.70f}, {130, 0.80f}, {190, 1.0f}}},
+    /* 4-3 */ {{{0, 1.0f}, {25, 0.55f}, {240, 0.65f}, {340, 1.0f}}, {{0, 1.0f}, {20, 0.75f}, {140, 0.85f}, {200, 1.0f}}},
+};
+
+// Pressure solenoid output, given a ramp so profiles can play on it
+static int16_t pressure_output_index = -1;
+
 // Statistics
 static uint32_t shift_count = 0;
+static uint32_t profiled_shift_count = 0;
 static uint32_t invalid_gear_count = 0;
 static uint32_t overrun_change_count = 0;
 
@@ -141,10 +185,13 @@ static void init_transmission_sensor_array(sensor_definition_t* sensors,
     sensors[0].config.thermistor.voltage_table = temp_voltage_table;
     sensors[0].config.thermistor.temp_table = temp_temp_table;
     sensors[0].config.thermistor.table_size = TRANS_TEMP_TABLE_SIZE;
+    sensors[0].config.thermistor.counts_lut = trans_temp_counts_lut;
     sensors[0].msg_id = MSG_TRANS_FLUID_TEMP;
     sensors[0].update_interval_us = TRANS_TEMP_UPDATE_INTERVAL_US;
     sensors[0].filter_strength = TRANS_TEMP_FILTER_STRENGTH;
     sensors[0].name = "Trans Fluid Temp";
+    sensors[0].publish_deadband = TRANS_TEMP_PUBLISH_DEADBAND_C;
+    sensors[0].publish_heartbeat_us = TRANS_TEMP_HEARTBEAT_US;
     
     // Paddle upshift
     sensors[1].pin = PIN_PADDLE_UPSHIFT;
@@ -311,13 +358,10 @@ static void init_transmission_output_array(output_definition_t* outputs) {
     outputs[4].name = "Trans Lockup Sol";
 }
 static void subscribe_to_transmission_messages(void);
-static void handle_trans_fluid_temp(const CANMessage* msg);
+static void handle_trans_fluid_temp(const float& temperature_c);
 static void handle_paddle_upshift(const CANMessage* msg);
 static void handle_paddle_downshift(const CANMessage* msg);
 static void handle_gear_position_switches(const CANMessage* msg);
-static void handle_throttle_position(const CANMessage* msg);
-static void handle_vehicle_speed(const CANMessage* msg);
-static void handle_brake_pedal(const CANMessage* msg);
 static void update_gear_position(void);
 static void process_shift_requests(void);
 static void publish_transmission_state(void);
@@ -327,6 +371,7 @@ static bool execute_downshift(void);
 static void set_shift_solenoid_pattern(uint8_t gear);
 static void set_line_pressure_for_gear(gear_position_t gear);
 static void set_line_pressure(float pressure_percent);
+static void play_shift_pressure_profile(uint8_t from_gear, uint8_t to_gear);
 
 // Solenoid state getters for parameter requests
 static float get_shift_solenoid_a_state(void);
@@ -341,6 +386,7 @@ static void set_overrun_clutch(overrun_clutch_state_t state);
 static void update_overrun_clutch_control(void);
 
 // Helper functions for external data
+static void read_overrun_inputs(overrun_inputs_t* inputs);
 static float get_throttle_position_with_timeout(void);
 static float get_vehicle_speed_with_timeout(void);
 static bool get_brake_pedal_with_timeout(void);
@@ -380,6 +426,15 @@ uint8_t transmission_module_init(void) {
     
     (void)registered_outputs;  // Suppress unused variable warning
     
+    // Line pressure follows its messages instantly; the ramp is only there
+    // so shift profiles can play on the pressure solenoid from the timer
+    pressure_output_index = output_manager_find_output_by_msg_id(MSG_TRANS_PRESSURE_SOL);
+    output_ramp_config_t pressure_ramp = {OUTPUT_RAMP_LINEAR, 0.0f, 0.0f, 0.0f, 0};
+    if (pressure_output_index >= 0 &&
+        !output_manager_set_ramp((uint8_t)pressure_output_index, &pressure_ramp)) {
+        pressure_output_index = -1;     // No timer behind the pin: shifts step the pressure
+    }
+    
     // Configure external CAN bus mappings for transmission data
     configure_external_canbus_mappings();
     
@@ -396,7 +451,7 @@ uint8_t transmission_module_init(void) {
     ParameterRegistry::register_parameter(MSG_VEHICLE_SPEED,
                                         []() -> float { 
                                             // Return actual vehicle speed from cached value
-                                            return get_vehicle_speed_with_timeout();
+                                            return signal_store_get_or(SIGNAL_VEHICLE_SPEED, OVERRUN_INPUT_DEFAULTS.vehicle_speed);
                                         }, 
                                         nullptr, "Vehicle Speed");
     ParameterRegistry::register_parameter(MSG_TRANS_OVERRUN_STATE, 
@@ -442,6 +497,7 @@ uint8_t transmission_module_init(void) {
     // Debug output removed to reduce serial clutter
     
     // Initialize state
+    current_auto_gear = 1;
     trans_state.current_gear = GEAR_UNKNOWN;
     trans_state.fluid_temperature = 0.0f;
     trans_state.shift_request = SHIFT_NONE;
@@ -459,13 +515,16 @@ uint8_t transmission_module_init(void) {
     
     // Reset statistics
     shift_count = 0;
+    profiled_shift_count = 0;
     invalid_gear_count = 0;
     overrun_change_count = 0;
     
-    // Initialize cached external data timestamps
-    last_throttle_update_ms = 0;
-    last_speed_update_ms = 0;
-    last_brake_update_ms = 0;
+    // Overrun inputs are read from the signal store on the first update
+    overrun_inputs = OVERRUN_INPUT_DEFAULTS;
+    
+    // First update evaluates everything from the initial state
+    dirty_flags = TRANS_DIRTY_ALL;
+    evaluation_count = 0;
     
     // Set transmission outputs to safe state initially
     transmission_outputs_safe_state();
@@ -502,26 +561,48 @@ static void configure_external_canbus_mappings(void) {
 }
 
 void transmission_module_update(void) {
-    // Debug output removed to reduce serial clutter
+    // New external data, or data going stale, changes the overrun inputs
+    overrun_inputs_t inputs;
+    read_overrun_inputs(&inputs);
+    if (inputs.throttle_position != overrun_inputs.throttle_position ||
+        inputs.vehicle_speed != overrun_inputs.vehicle_speed ||
+        inputs.braking != overrun_inputs.braking) {
+        overrun_inputs = inputs;
+        dirty_flags |= TRANS_DIRTY_OVERRUN;
+    }
+    
+    if (dirty_flags == 0) {
+        return;     // Nothing changed since the last evaluation
+    }
+    uint8_t flags = dirty_flags;
+    dirty_flags = 0;
+    evaluation_count++;
     
     // Update gear position based on switch states
-    update_gear_position();
+    if (flags & TRANS_DIRTY_GEAR_SWITCHES) {
+        gear_position_t previous_gear = trans_state.current_gear;
+        update_gear_position();
+        if (trans_state.current_gear != previous_gear) {
+            flags |= TRANS_DIRTY_OVERRUN;
+        }
+    }
     
     // Process any pending shift requests
-    process_shift_requests();
+    if (flags & TRANS_DIRTY_SHIFT_REQUEST) {
+        process_shift_requests();
+        flags |= TRANS_DIRTY_OVERRUN;
+    }
     
     // Update overrun clutch control based on driving conditions (race car logic)
-    update_overrun_clutch_control();
-    
-    // Publish current transmission state to message bus (reduced frequency)
-    static uint32_t last_publish_time = 0;
-    uint32_t now = millis();
-    if (now - last_publish_time >= 50) {  // Publish every 50ms (20Hz) instead of every update
-        publish_transmission_state();
-        last_publish_time = now;
+    if (flags & TRANS_DIRTY_OVERRUN) {
+        update_overrun_clutch_control();
     }
 }
 
+void transmission_module_publish_state(void) {
+    publish_transmission_state();
+}
+
 const transmission_state_t* transmission_get_state(void) {
     return &trans_state;
 }
@@ -530,6 +611,7 @@ void transmission_clear_shift_request(void) {
     trans_state.upshift_requested = false;
     trans_state.downshift_requested = false;
     trans_state.shift_request = SHIFT_NONE;
+    dirty_flags |= TRANS_DIRTY_OVERRUN;
 }
 
 bool transmission_is_overheating(float threshold_c) {
@@ -577,8 +659,17 @@ uint32_t transmission_get_overrun_change_count(void) {
     return overrun_change_count;
 }
 
+uint32_t transmission_get_profiled_shift_count(void) {
+    return profiled_shift_count;
+}
+
+uint32_t transmission_get_evaluation_count(void) {
+    return evaluation_count;
+}
+
 void transmission_reset_statistics(void) {
     shift_count = 0;
+    profiled_shift_count = 0;
     invalid_gear_count = 0;
     overrun_change_count = 0;
 }
@@ -593,7 +684,8 @@ void transmission_set_overrun_override(overrun_clutch_state_t state, bool overri
         
         // Debug output removed to reduce serial clutter
     } else {
-        // Debug output removed to reduce serial clutter
+        // Back to automatic control on the next update
+        dirty_flags |= TRANS_DIRTY_OVERRUN;
     }
 }
 
@@ -613,7 +705,7 @@ void transmission_set_overrun_tuning(float throttle_disengage_pct, float throttl
     overrun_braking_speed_threshold = (braking_speed_mph < 10.0f) ? 10.0f : 
                                      (braking_speed_mph > 100.0f) ? 100.0f : braking_speed_mph;
     
-    // Debug output removed to reduce serial clutter
+    dirty_flags |= TRANS_DIRTY_OVERRUN;
 }
 
 void transmission_get_overrun_tuning(float* throttle_disengage_pct, float* throttle_engage_pct,
@@ -670,6 +762,10 @@ static void init_transmission_temp_tables(void) {
         trans_temp_temp_table                       // Output temperature table
     );
     
+    // Resample into the counts-indexed table used per reading
+    generate_thermistor_counts_lut(trans_temp_voltage_table, trans_temp_temp_table,
+                                   TRANS_TEMP_TABLE_SIZE, trans_temp_counts_lut);
+    
     // Debug output removed to reduce serial clutter
     #ifndef ARDUINO
     (void)beta;  // Suppress unused variable warning in tests
@@ -678,7 +774,7 @@ static void init_transmission_temp_tables(void) {
 
 static void subscribe_to_transmission_messages(void) {
     // Subscribe to sensor messages
-    g_message_bus.subscribe(MSG_TRANS_FLUID_TEMP, handle_trans_fluid_temp);
+    g_message_bus.subscribe<float, MSG_TRANS_FLUID_TEMP, handle_trans_fluid_temp>();
     g_message_bus.subscribe(MSG_PADDLE_UPSHIFT, handle_paddle_upshift);
     g_message_bus.subscribe(MSG_PADDLE_DOWNSHIFT, handle_paddle_downshift);
     
@@ -690,18 +786,23 @@ static void subscribe_to_transmission_messages(void) {
     g_message_bus.subscribe(MSG_TRANS_SECOND_SWITCH, handle_gear_position_switches);
     g_message_bus.subscribe(MSG_TRANS_FIRST_SWITCH, handle_gear_position_switches);
     
-    // Subscribe to external data for overrun clutch control
-    g_message_bus.subscribe(MSG_THROTTLE_POSITION, handle_throttle_position);
-    g_message_bus.subscribe(MSG_VEHICLE_SPEED, handle_vehicle_speed);
-    g_message_bus.subscribe(MSG_BRAKE_PEDAL, handle_brake_pedal);
+    // Throttle, speed and brake for overrun control come from the signal store
+    
+    // Periodic state broadcasts only need the latest value queued
+    g_message_bus.setCoalesce(MSG_TRANS_CURRENT_GEAR, true);
+    g_message_bus.setCoalesce(MSG_TRANS_DRIVE_GEAR, true);
+    g_message_bus.setCoalesce(MSG_TRANS_SHIFT_REQUEST, true);
+    g_message_bus.setCoalesce(MSG_TRANS_STATE_VALID, true);
+    g_message_bus.setCoalesce(MSG_TRANS_OVERRUN_STATE, true);
+    g_message_bus.setCoalesce(MSG_VEHICLE_SPEED, true);
     
     // Subscribe to parameter requests for transmission status (handled by parameter registry)
     // Note: Individual parameter subscriptions are no longer needed as the parameter registry
     // handles all parameter requests centrally
 }
 
-static void handle_trans_fluid_temp(const CANMessage* msg) {
-    trans_state.fluid_temperature = MSG_UNPACK_FLOAT(msg);
+static void handle_trans_fluid_temp(const float& temperature_c) {
+    trans_state.fluid_temperature = temperature_c;
     // Temporarily disabled to avoid serial corruption
     /*
     #ifdef ARDUINO
@@ -717,21 +818,6 @@ static void handle_trans_fluid_temp(const CANMessage* msg) {
     */
 }
 
-static void handle_throttle_position(const CANMessage* msg) {
-    cached_throttle_position = MSG_UNPACK_FLOAT(msg);
-    last_throttle_update_ms = millis();
-}
-
-static void handle_vehicle_speed(const CANMessage* msg) {
-    cached_vehicle_speed = MSG_UNPACK_FLOAT(msg);
-    last_speed_update_ms = millis();
-}
-
-static void handle_brake_pedal(const CANMessage* msg) {
-    cached_brake_active = (MSG_UNPACK_FLOAT(msg) > 0.5f);  // Convert to boolean
-    last_brake_update_ms = millis();
-}
-
 static void handle_paddle_upshift(const CANMessage* msg) {
     if (MSG_UNPACK_FLOAT(msg) > 0.5f) {  // Paddle pressed
         uint32_t now_ms = millis();
@@ -740,6 +826,7 @@ static void handle_paddle_upshift(const CANMessage* msg) {
             trans_state.shift_request = SHIFT_UP;
             trans_state.last_paddle_time_ms = now_ms;
             shift_count++;
+            dirty_flags |= TRANS_DIRTY_SHIFT_REQUEST;
             
                     // Debug output removed to reduce serial clutter
         }
@@ -754,6 +841,7 @@ static void handle_paddle_downshift(const CANMessage* msg) {
             trans_state.shift_request = SHIFT_DOWN;
             trans_state.last_paddle_time_ms = now_ms;
             shift_count++;
+            dirty_flags |= TRANS_DIRTY_SHIFT_REQUEST;
             
                     // Debug output removed to reduce serial clutter
         }
@@ -770,13 +858,18 @@ static void handle_gear_position_switches(const CANMessage* msg) {
            msg->id, MSG_UNPACK_FLOAT(msg), switch_active);
     #endif
     
+    bool* switch_state = nullptr;
     switch (msg->id) {
-        case MSG_TRANS_PARK_SWITCH:     trans_state.park_switch = switch_active; break;
-        case MSG_TRANS_REVERSE_SWITCH:  trans_state.reverse_switch = switch_active; break;
-        case MSG_TRANS_NEUTRAL_SWITCH:  trans_state.neutral_switch = switch_active; break;
-        case MSG_TRANS_DRIVE_SWITCH:    trans_state.drive_switch = switch_active; break;
-        case MSG_TRANS_SECOND_SWITCH:   trans_state.second_switch = switch_active; break;
-        case MSG_TRANS_FIRST_SWITCH:    trans_state.first_switch = switch_active; break;
+        case MSG_TRANS_PARK_SWITCH:     switch_state = &trans_state.park_switch; break;
+        case MSG_TRANS_REVERSE_SWITCH:  switch_state = &trans_state.reverse_switch; break;
+        case MSG_TRANS_NEUTRAL_SWITCH:  switch_state = &trans_state.neutral_switch; break;
+        case MSG_TRANS_DRIVE_SWITCH:    switch_state = &trans_state.drive_switch; break;
+        case MSG_TRANS_SECOND_SWITCH:   switch_state = &trans_state.second_switch; break;
+        case MSG_TRANS_FIRST_SWITCH:    switch_state = &trans_state.first_switch; break;
+    }
+    if (switch_state != nullptr && *switch_state != switch_active) {
+        *switch_state = switch_active;
+        dirty_flags |= TRANS_DIRTY_GEAR_SWITCHES;
     }
 }
 
@@ -788,43 +881,28 @@ static void handle_gear_position_switches(const CANMessage* msg) {
 // This function is no longer needed as parameters are registered centrally
 
 // =============================================================================
-// EXTERNAL DATA HELPER FUNCTIONS (MESSAGE BUS WITH TIMEOUT)
+// EXTERNAL DATA HELPER FUNCTIONS (SIGNAL STORE)
 // =============================================================================
 
+static void read_overrun_inputs(overrun_inputs_t* inputs) {
+    inputs->throttle_position = signal_store_get_or(SIGNAL_THROTTLE_POSITION, OVERRUN_INPUT_DEFAULTS.throttle_position);
+    inputs->vehicle_speed = signal_store_get_or(SIGNAL_VEHICLE_SPEED, OVERRUN_INPUT_DEFAULTS.vehicle_speed);
+    float brake_value;
+    inputs->braking = signal_store_get(SIGNAL_BRAKE_PEDAL, &brake_value) ? (brake_value > 0.5f)
+                                                                          : OVERRUN_INPUT_DEFAULTS.braking;
+}
+
+// The inputs as of the current update (read before any logic runs)
 static float get_throttle_position_with_timeout(void) {
-    uint32_t now_ms = millis();
-    
-    // Check if data is fresh (within timeout)
-    if (now_ms - last_throttle_update_ms < EXTERNAL_DATA_TIMEOUT_MS) {
-        return cached_throttle_position;
-    } else {
-        // Return safe default if data is stale
-        return 20.0f;  // Safe light throttle default
-    }
+    return overrun_inputs.throttle_position;
 }
 
 static float get_vehicle_speed_with_timeout(void) {
-    uint32_t now_ms = millis();
-    
-    // Check if data is fresh (within timeout)
-    if (now_ms - last_speed_update_ms < EXTERNAL_DATA_TIMEOUT_MS) {
-        return cached_vehicle_speed;
-    } else {
-        // Return safe default if data is stale
-        return 35.0f;  // Safe moderate speed default
-    }
+    return overrun_inputs.vehicle_speed;
 }
 
 static bool get_brake_pedal_with_timeout(void) {
-    uint32_t now_ms = millis();
-    
-    // Check if data is fresh (within timeout)
-    if (now_ms - last_brake_update_ms < EXTERNAL_DATA_TIMEOUT_MS) {
-        return cached_brake_active;
-    } else {
-        // Return safe default if data is stale
-        return false;  // Safe default (no braking)
-    }
+    return overrun_inputs.braking;
 }
 
 static bool is_decelerating_with_timeout(void) {
@@ -911,11 +989,11 @@ static void process_shift_requests(void) {
 
 static void publish_transmission_state(void) {
     // Publish combined transmission state messages
-    g_message_bus.publishFloat(MSG_TRANS_CURRENT_GEAR, (float)trans_state.current_gear);
-    g_message_bus.publishFloat(MSG_TRANS_DRIVE_GEAR, (float)current_auto_gear);
-    g_message_bus.publishFloat(MSG_TRANS_SHIFT_REQUEST, (float)trans_state.shift_request);
-    g_message_bus.publishFloat(MSG_TRANS_STATE_VALID, trans_state.valid_gear_position ? 1.0f : 0.0f);
-    g_message_bus.publishFloat(MSG_TRANS_OVERRUN_STATE, (float)trans_state.overrun_state);
+    g_message_bus.publish<float, MSG_TRANS_CURRENT_GEAR>((float)trans_state.current_gear);
+    g_message_bus.publish<float, MSG_TRANS_DRIVE_GEAR>((float)current_auto_gear);
+    g_message_bus.publish<float, MSG_TRANS_SHIFT_REQUEST>((float)trans_state.shift_request);
+    g_message_bus.publish<float, MSG_TRANS_STATE_VALID>(trans_state.valid_gear_position ? 1.0f : 0.0f);
+    g_message_bus.publish<float, MSG_TRANS_OVERRUN_STATE>((float)trans_state.overrun_state);
     
     // Publish vehicle speed - get from sensor or default to 0.0 when stopped
     float vehicle_speed = 0.0f;  // Default for stopped vehicle
@@ -926,7 +1004,7 @@ static void publish_transmission_state(void) {
             vehicle_speed = status.calibrated_value;  // Use actual speed if available
         }
     }
-    g_message_bus.publishFloat(MSG_VEHICLE_SPEED, vehicle_speed);
+    g_message_bus.publish<float, MSG_VEHICLE_SPEED>(vehicle_speed);
 }
 
 static bool is_shift_safe(void) {
@@ -959,10 +1037,11 @@ static bool execute_upshift(void) {
         return false;
     }
     
-    // Shift to next gear
+    // Shift to next gear, pressure profile first so the dip starts with the solenoids
+    play_shift_pressure_profile(current_auto_gear, current_auto_gear + 1);
     current_auto_gear++;
     set_shift_solenoid_pattern(current_auto_gear);
-    // Line pressure remains at 100% for all moving gears
+    // Line pressure returns to 100% (all moving gears) at the end of the profile
     
             // Debug output removed to reduce serial clutter
     
@@ -978,10 +1057,11 @@ static bool execute_downshift(void) {
         return false;
     }
     
-    // Shift to lower gear
+    // Shift to lower gear, pressure profile first so the dip starts with the solenoids
+    play_shift_pressure_profile(current_auto_gear, current_auto_gear - 1);
     current_auto_gear--;
     set_shift_solenoid_pattern(current_auto_gear);
-    // Line pressure remains at 100% for all moving gears
+    // Line pressure returns to 100% (all moving gears) at the end of the profile
     
             // Debug output removed to reduce serial clutter
     
@@ -1076,6 +1156,20 @@ static void set_line_pressure_for_gear(gear_position_t gear) {
     }
 }
 
+static void play_shift_pressure_profile(uint8_t from_gear, uint8_t to_gear) {
+    if (pressure_output_index < 0) {
+        return;
+    }
+    // Upshifts index by the gear left (1-3), downshifts by the gear entered (1-3)
+    uint8_t change = (to_gear > from_gear) ? (from_gear - 1) : (3 + to_gear - 1);
+    uint8_t band = (get_throttle_position_with_timeout() >= SHIFT_PROFILE_HEAVY_THROTTLE) ? 1 : 0;
+    
+    if (output_manager_play_profile((uint8_t)pressure_output_index,
+                                    SHIFT_PROFILES[change][band], SHIFT_PROFILE_POINTS)) {
+        profiled_shift_count++;
+    }
+}
+
 static void set_line_pressure(float pressure_percent) {
     // Manual line pressure control (for testing/diagnostics)
     // Clamp to safe range
@@ -13,6 +13,7 @@
 // - Shift Solenoid B (Pin 41): Digital ON/OFF  
 // - Overrun Solenoid (Pin 42): Digital ON/OFF (Race car logic: aggressive engagement for control)
 // - Line Pressure Solenoid (Pin 43): PWM 0-100% (0% Park/Neutral, 100% all moving gears)
+//   Shifts play a timed pressure profile on it from the output ramp timer
 // - Lockup Solenoid (Pin 44): Digital ON/OFF (automatic - ON in 4th gear only)
 
 #ifndef TRANSMISSION_MODULE_H
@@ -22,6 +23,7 @@
 #include "input_manager_types.h"
 #include "msg_definitions.h"
 #include "pin_assignments.h"
+#include "can_router.h"
 
 #ifdef ARDUINO
 #include <Arduino.h>
@@ -57,6 +59,17 @@ inline uint32_t millis() { return 0; }
 #define OVERRUN_MODERATE_THROTTLE_THRESHOLD     60.0f   // Keep engaged below 60% in lower gears
 #define OVERRUN_MODERATE_THROTTLE_THRESHOLD     60.0f   // Keep engaged below 60% in lower gears
 
+// Traffic outside SUBSYSTEM_TRANSMISSION, for running the module on another
+// ECU (can_router.h): it reads throttle and brake from the engine side and
+// owns the vehicle speed sensor
+static const uint32_t TRANSMISSION_MODULE_INPUTS[] = { MSG_THROTTLE_POSITION, MSG_BRAKE_PEDAL };
+static const uint32_t TRANSMISSION_MODULE_OUTPUTS[] = { MSG_VEHICLE_SPEED };
+static const can_module_routes_t TRANSMISSION_MODULE_ROUTES = {
+    MAKE_EXTENDED_CAN_ID(ECU_BASE_PRIMARY, SUBSYSTEM_TRANSMISSION, 0), ECU_BASE_MASK | SUBSYSTEM_MASK,
+    TRANSMISSION_MODULE_INPUTS, sizeof(TRANSMISSION_MODULE_INPUTS) / sizeof(TRANSMISSION_MODULE_INPUTS[0]),
+    TRANSMISSION_MODULE_OUTPUTS, sizeof(TRANSMISSION_MODULE_OUTPUTS) / sizeof(TRANSMISSION_MODULE_OUTPUTS[0])
+};
+
 // =============================================================================
 // TRANSMISSION TYPES
 // =============================================================================
@@ -116,14 +129,23 @@ typedef struct {
 uint8_t transmission_module_init(void);
 
 /**
- * Update transmission logic (call from main loop)
+ * Update transmission logic (100 Hz executive task)
  * - Processes shift requests
  * - Updates overrun clutch control based on driving conditions
- * - Updates combined state messages
  * - Handles safety logic
+ * Event driven: the message handlers mark what changed (gear switches, a
+ * paddle request) and only that logic runs. Throttle, speed and brake are
+ * read from the signal store each call; the overrun logic runs when they
+ * differ from the last evaluation, including when one goes stale. Needs
+ * signal_store_init().
  */
 void transmission_module_update(void);
 
+/**
+ * Publish combined transmission state messages (10 Hz executive task)
+ */
+void transmission_module_publish_state(void);
+
 /**
  * Get current transmission state (read-only)
  * @return Pointer to current transmission state
@@ -238,6 +260,18 @@ uint32_t transmission_get_overrun_change_count(void);
  */
 void transmission_reset_statistics(void);
 
+/**
+ * Get number of shifts that played a line-pressure profile
+ * @return Profiled shift count (shifts step the pressure when the solenoid has no timer)
+ */
+uint32_t transmission_get_profiled_shift_count(void);
+
+/**
+ * Get number of updates that ran any transmission logic
+ * @return Evaluations since init (update calls with nothing changed are not counted)
+ */
+uint32_t transmission_get_evaluation_count(void);
+
 // =============================================================================
 // TRANSMISSION OUTPUT CONTROL
 // =============================================================================
@@ -287,8 +321,8 @@ void transmission_outputs_safe_state(void);
 
 /**
  * These functions allow the transmission module to get driving condition data
- * from other ECU modules via the message bus. The transmission module subscribes
- * to the appropriate messages and caches the data with timeout protection.
+ * from other ECU modules. The transmission module reads them from the signal
+ * store (signal_store.h), which falls back to safe defaults for stale data.
  */
 
 /**
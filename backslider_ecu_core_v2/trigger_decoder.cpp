@@ -0,0 +1,473 @@
+// trigger_decoder.cpp
+// Tooth-edge crank decoding: gap detection, cam phase, per-tooth angle/RPM
+
+#include "trigger_decoder.h"
+#include "msg_definitions.h"
+#include "msg_bus.h"
+#include "memory_placement.h"
+#include <math.h>
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include "tests/mock_arduino.h"
+#endif
+
+// Orders the shared-state writes/reads around the sequence counter
+#if defined(__arm__)
+    #define TRIGGER_MEMORY_BARRIER() asm volatile("dmb" ::: "memory")
+#else
+    #define TRIGGER_MEMORY_BARRIER() asm volatile("" ::: "memory")
+#endif
+
+// =============================================================================
+// PRIVATE DATA
+// =============================================================================
+
+static trigger_wheel_config_t wheel;
+
+// Derived from the wheel at configure time so the ISR has no divisions by it
+static uint8_t teeth_present;           // tooth_count - missing_teeth
+static float degrees_per_tooth;
+static float rpm_per_tooth_hz;          // RPM = this / tooth period in µs
+
+// ISR working state (written only by the crank/cam ISRs and, with
+// interrupts off, by resets in the main loop)
+typedef struct {
+    uint32_t last_edge_us;
+    uint32_t last_period_us;        // Per-position period of the previous tooth
+    uint16_t tooth_index;
+    uint8_t have_edge;
+    uint8_t sync;
+    uint8_t cycle_phase;
+    uint32_t revolutions;
+    float period_slope_us;
+    float period_curve_us;
+    uint8_t check_pending;          // A self-check prediction is waiting for its tooth
+    uint16_t check_tooth;
+    uint32_t check_time_us;         // Predicted arrival of check_tooth
+    uint32_t check_sync_losses;     // Sync losses when armed; a change voids the check
+} decoder_isr_data_t;
+
+static decoder_isr_data_t isr ECU_HOT_DATA;
+static volatile uint8_t cam_pending = 0;
+
+// Published snapshot: odd sequence = write in progress
+static volatile uint32_t state_sequence = 0;
+static trigger_state_t shared_state ECU_HOT_DATA;
+
+static volatile uint32_t tooth_edges = 0;
+static volatile uint32_t sync_losses = 0;
+static volatile uint32_t cam_errors = 0;
+
+// Self-check results: latest error, and the sum since the last publish
+static volatile float prediction_error_deg = 0.0f;
+static volatile uint32_t prediction_checks = 0;
+static float prediction_error_sum_deg = 0.0f;
+static uint16_t prediction_error_samples = 0;
+
+static trigger_tooth_callback_t tooth_callbacks[TRIGGER_DECODER_MAX_CALLBACKS];
+static volatile uint8_t tooth_callback_count = 0;
+
+static uint32_t last_publish_us = 0;
+static bool started = false;
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static void derive_wheel_constants(void) {
+    teeth_present = wheel.tooth_count - wheel.missing_teeth;
+    degrees_per_tooth = 360.0f / (float)wheel.tooth_count;
+    rpm_per_tooth_hz = 60000000.0f / (float)wheel.tooth_count;
+}
+
+static void reset_isr_data(void) {
+    isr.last_edge_us = 0;
+    isr.last_period_us = 0;
+    isr.tooth_index = 0;
+    isr.have_edge = 0;
+    isr.sync = TRIGGER_SYNC_NONE;
+    isr.cycle_phase = 0;
+    isr.revolutions = 0;
+    isr.period_slope_us = 0.0f;
+    isr.period_curve_us = 0.0f;
+    isr.check_pending = 0;
+    cam_pending = 0;
+}
+
+static float wrap_angle(float angle, float cycle_deg) {
+    angle = fmodf(angle, cycle_deg);
+    return (angle < 0.0f) ? angle + cycle_deg : angle;
+}
+
+// Copy the ISR state out for readers (writer side of the sequence counter)
+ECU_HOT_CODE static void publish_state(uint32_t time_us, uint32_t period_us) {
+    state_sequence++;
+    TRIGGER_MEMORY_BARRIER();
+
+    shared_state.tooth_time_us = time_us;
+    shared_state.tooth_period_us = period_us;
+    shared_state.rpm = (period_us > 0) ? rpm_per_tooth_hz / (float)period_us : 0.0f;
+    shared_state.us_per_degree = (float)period_us / degrees_per_tooth;
+    shared_state.period_slope_us = isr.period_slope_us;
+    shared_state.period_curve_us = isr.period_curve_us;
+    shared_state.tooth_index = isr.tooth_index;
+    shared_state.sync = isr.sync;
+    shared_state.cycle_phase = isr.cycle_phase;
+    shared_state.revolutions = isr.revolutions;
+    if (isr.sync == TRIGGER_SYNC_NONE) {
+        shared_state.tooth_angle_deg = 0.0f;
+    } else {
+        float angle = wheel.first_tooth_angle_deg + (float)isr.tooth_index * degrees_per_tooth;
+        if (isr.sync == TRIGGER_SYNC_FULL) {
+            shared_state.tooth_angle_deg = wrap_angle(angle + (isr.cycle_phase ? 360.0f : 0.0f), 720.0f);
+        } else {
+            shared_state.tooth_angle_deg = wrap_angle(angle, 360.0f);
+        }
+    }
+
+    TRIGGER_MEMORY_BARRIER();
+    state_sequence++;
+}
+
+// Fold a new per-position period into the filtered slope and curve
+ECU_HOT_CODE static void update_speed_model(uint32_t period_us) {
+    float slope = (float)period_us - (float)isr.last_period_us;
+    float new_slope = isr.period_slope_us + (slope - isr.period_slope_us) * TRIGGER_PREDICT_FILTER;
+    float curve = new_slope - isr.period_slope_us;
+    isr.period_curve_us += (curve - isr.period_curve_us) * TRIGGER_PREDICT_FILTER;
+    isr.period_slope_us = new_slope;
+}
+
+// Score the pending prediction if its tooth has arrived, then arm the next
+ECU_HOT_CODE static void check_prediction(uint32_t time_us) {
+    if (isr.sync == TRIGGER_SYNC_NONE) {
+        isr.check_pending = 0;
+        return;
+    }
+
+    if (isr.check_pending && isr.check_sync_losses != sync_losses) {
+        isr.check_pending = 0;      // Tooth positions were re-counted
+    }
+    if (isr.check_pending && isr.tooth_index == isr.check_tooth) {
+        float error_deg = (float)(int32_t)(time_us - isr.check_time_us) / shared_state.us_per_degree;
+        prediction_error_deg = error_deg;
+        prediction_error_sum_deg += fabsf(error_deg);
+        prediction_error_samples++;
+        prediction_checks++;
+        isr.check_pending = 0;
+    }
+
+    if (!isr.check_pending) {
+        uint16_t target = isr.tooth_index + TRIGGER_PREDICT_CHECK_TEETH;
+        uint16_t positions = TRIGGER_PREDICT_CHECK_TEETH;
+        if (target >= teeth_present) {
+            positions = wheel.tooth_count - isr.tooth_index;     // First tooth after the gap
+            target = 0;
+        }
+        isr.check_tooth = target;
+        isr.check_time_us = time_us + trigger_decoder_predict_delay_us(&shared_state, positions * degrees_per_tooth);
+        isr.check_sync_losses = sync_losses;
+        isr.check_pending = 1;
+    }
+}
+
+// Hand the new state to the schedulers (same context as the writer)
+ECU_HOT_CODE static void run_tooth_callbacks(void) {
+    for (uint8_t i = 0; i < tooth_callback_count; i++) {
+        tooth_callbacks[i](&shared_state);
+    }
+}
+
+// Gap handling: position 0, then cam phase
+ECU_HOT_CODE static void handle_gap(void) {
+    if (isr.sync != TRIGGER_SYNC_NONE && isr.tooth_index != teeth_present - 1) {
+        sync_losses++;      // Gap where a tooth should have been
+        isr.sync = TRIGGER_SYNC_CRANK;
+    }
+    isr.tooth_index = 0;
+    isr.revolutions++;
+
+    if (!wheel.use_cam_sync) {
+        isr.sync = TRIGGER_SYNC_CRANK;
+        return;
+    }
+
+    if (cam_pending) {
+        // The revolution just finished was the second half of the cycle
+        if (isr.sync == TRIGGER_SYNC_FULL && isr.cycle_phase != 1) {
+            cam_errors++;
+        }
+        cam_pending = 0;
+        isr.cycle_phase = 0;
+        isr.sync = TRIGGER_SYNC_FULL;
+    } else if (isr.sync == TRIGGER_SYNC_FULL) {
+        isr.cycle_phase ^= 1;
+        if (isr.cycle_phase == 0) {
+            cam_errors++;   // Cam edge missing; keep the alternating phase
+        }
+    } else {
+        isr.sync = TRIGGER_SYNC_CRANK;
+    }
+}
+
+#ifdef ARDUINO
+
+ECU_HOT_CODE static void crank_isr(void) {
+    trigger_decoder_crank_edge(micros());
+}
+
+ECU_HOT_CODE static void cam_isr(void) {
+    trigger_decoder_cam_edge(micros());
+}
+
+#endif
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void trigger_decoder_init(void) {
+    wheel.tooth_count = 36;
+    wheel.missing_teeth = 1;
+    wheel.use_cam_sync = 0;
+    wheel.crank_edge = TRIGGER_EDGE_RISING;
+    wheel.cam_edge = TRIGGER_EDGE_RISING;
+    wheel.first_tooth_angle_deg = 0.0f;
+    wheel.stall_timeout_us = TRIGGER_DECODER_DEFAULT_STALL_US;
+    derive_wheel_constants();
+
+    reset_isr_data();
+    state_sequence = 0;
+    publish_state(0, 0);
+    tooth_edges = 0;
+    sync_losses = 0;
+    cam_errors = 0;
+    tooth_callback_count = 0;
+    prediction_error_deg = 0.0f;
+    prediction_checks = 0;
+    prediction_error_sum_deg = 0.0f;
+    prediction_error_samples = 0;
+    last_publish_us = micros();
+    started = false;
+}
+
+bool trigger_decoder_configure(const trigger_wheel_config_t* config) {
+    if (config == nullptr || config->tooth_count < 4 ||
+        config->missing_teeth < 1 || config->missing_teeth > 2 ||
+        config->missing_teeth * 4 > config->tooth_count) {
+        return false;
+    }
+
+    #ifdef ARDUINO
+    noInterrupts();
+    #endif
+    wheel = *config;
+    if (wheel.stall_timeout_us == 0) {
+        wheel.stall_timeout_us = TRIGGER_DECODER_DEFAULT_STALL_US;
+    }
+    derive_wheel_constants();
+    reset_isr_data();
+    publish_state(0, 0);
+    #ifdef ARDUINO
+    interrupts();
+    #endif
+    return true;
+}
+
+bool trigger_decoder_add_tooth_callback(trigger_tooth_callback_t callback) {
+    if (callback == nullptr || tooth_callback_count >= TRIGGER_DECODER_MAX_CALLBACKS) {
+        return false;
+    }
+    tooth_callbacks[tooth_callback_count] = callback;
+    tooth_callback_count++;     // Visible to the ISR only once stored
+    return true;
+}
+
+void trigger_decoder_begin(uint8_t crank_pin, uint8_t cam_pin) {
+    #ifdef ARDUINO
+    pinMode(crank_pin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(crank_pin), crank_isr,
+                    wheel.crank_edge == TRIGGER_EDGE_FALLING ? FALLING : RISING);
+    if (cam_pin != TRIGGER_NO_PIN) {
+        pinMode(cam_pin, INPUT);
+        attachInterrupt(digitalPinToInterrupt(cam_pin), cam_isr,
+                        wheel.cam_edge == TRIGGER_EDGE_FALLING ? FALLING : RISING);
+    }
+    // Tooth timestamps must not wait behind bus or serial interrupts
+    NVIC_SET_PRIORITY(IRQ_GPIO6789, 16);
+    #else
+    (void)crank_pin;
+    (void)cam_pin;
+    #endif
+    started = true;
+}
+
+ECU_HOT_CODE void trigger_decoder_crank_edge(uint32_t time_us) {
+    tooth_edges++;
+    if (!isr.have_edge) {
+        isr.have_edge = 1;
+        isr.last_edge_us = time_us;
+        return;
+    }
+
+    uint32_t period_us = time_us - isr.last_edge_us;
+    isr.last_edge_us = time_us;
+    if (isr.last_period_us == 0) {
+        isr.last_period_us = period_us;     // First period only sets the reference
+        publish_state(time_us, period_us);
+        run_tooth_callbacks();
+        return;
+    }
+
+    uint32_t position_period_us = period_us;
+    if (period_us * 2 > isr.last_period_us * (wheel.missing_teeth + 2)) {
+        position_period_us = period_us / (wheel.missing_teeth + 1);
+        handle_gap();
+    } else if (isr.sync != TRIGGER_SYNC_NONE) {
+        isr.tooth_index++;
+        if (isr.tooth_index >= teeth_present) {
+            sync_losses++;      // More teeth than the wheel has: missed the gap
+            isr.sync = TRIGGER_SYNC_NONE;
+            isr.tooth_index = 0;
+        }
+    }
+    update_speed_model(position_period_us);
+    isr.last_period_us = position_period_us;
+    publish_state(time_us, position_period_us);
+    check_prediction(time_us);
+    run_tooth_callbacks();
+}
+
+ECU_HOT_CODE void trigger_decoder_cam_edge(uint32_t time_us) {
+    (void)time_us;
+    cam_pending = 1;
+}
+
+void trigger_decoder_update(void) {
+    if (!started) {
+        return;
+    }
+    uint32_t now_us = micros();
+
+    trigger_state_t state;
+    bool synced = trigger_decoder_get_state(&state);
+    if (isr.have_edge && now_us - state.tooth_time_us > wheel.stall_timeout_us) {
+        #ifdef ARDUINO
+        noInterrupts();
+        #endif
+        // Re-check with the ISR held off: a tooth may have just arrived
+        if (now_us - isr.last_edge_us > wheel.stall_timeout_us) {
+            reset_isr_data();
+            publish_state(now_us, 0);
+            run_tooth_callbacks();
+            synced = false;
+            state.rpm = 0.0f;
+        }
+        #ifdef ARDUINO
+        interrupts();
+        #endif
+    }
+
+    if (now_us - last_publish_us >= TRIGGER_DECODER_PUBLISH_INTERVAL_US) {
+        last_publish_us = now_us;
+        g_message_bus.publishFloat(MSG_ENGINE_RPM, state.rpm);
+        float angle = 0.0f;
+        if (synced && trigger_decoder_angle_at(now_us, &angle)) {
+            g_message_bus.publishFloat(MSG_CRANK_POSITION, angle);
+        }
+
+        #ifdef ARDUINO
+        noInterrupts();
+        #endif
+        float error_sum_deg = prediction_error_sum_deg;
+        uint16_t error_samples = prediction_error_samples;
+        prediction_error_sum_deg = 0.0f;
+        prediction_error_samples = 0;
+        #ifdef ARDUINO
+        interrupts();
+        #endif
+        if (error_samples > 0) {
+            g_message_bus.publishFloat(MSG_CRANK_PREDICTION_ERROR, error_sum_deg / (float)error_samples);
+        }
+    }
+}
+
+bool trigger_decoder_get_state(trigger_state_t* state) {
+    uint32_t sequence;
+    do {
+        sequence = state_sequence;
+        TRIGGER_MEMORY_BARRIER();
+        *state = shared_state;
+        TRIGGER_MEMORY_BARRIER();
+    } while ((sequence & 1) || sequence != state_sequence);
+    return state->sync != TRIGGER_SYNC_NONE;
+}
+
+ECU_HOT_CODE bool trigger_decoder_angle_at(uint32_t time_us, float* angle_deg) {
+    trigger_state_t state;
+    if (!trigger_decoder_get_state(&state) || state.tooth_period_us == 0) {
+        return false;
+    }
+    float elapsed_teeth = (float)(time_us - state.tooth_time_us) / (float)state.tooth_period_us;
+    float cycle_deg = (state.sync == TRIGGER_SYNC_FULL) ? 720.0f : 360.0f;
+    *angle_deg = wrap_angle(state.tooth_angle_deg + elapsed_teeth * degrees_per_tooth, cycle_deg);
+    return true;
+}
+
+ECU_HOT_CODE uint32_t trigger_decoder_predict_delay_us(const trigger_state_t* state, float delta_deg) {
+    if (state->tooth_period_us == 0 || delta_deg <= 0.0f) {
+        return 0;
+    }
+    float period = (float)state->tooth_period_us;
+    float teeth = delta_deg / degrees_per_tooth;
+
+    // Integral of p(x) over the modelled horizon, then the end period held flat
+    float x = (teeth < (float)TRIGGER_PREDICT_HORIZON_TEETH) ? teeth : (float)TRIGGER_PREDICT_HORIZON_TEETH;
+    float slope = state->period_slope_us;
+    float curve = state->period_curve_us;
+    float delay = x * (period + x * (slope * 0.5f + x * curve * (1.0f / 6.0f)));
+    float end_period = period + x * (slope + x * curve * 0.5f);
+    if (end_period < period * 0.5f) {
+        end_period = period * 0.5f;
+    } else if (end_period > period * 2.0f) {
+        end_period = period * 2.0f;
+    }
+    delay += (teeth - x) * end_period;
+
+    float min_delay = teeth * period * 0.5f;
+    float max_delay = teeth * period * 2.0f;
+    if (delay < min_delay) {
+        delay = min_delay;
+    } else if (delay > max_delay) {
+        delay = max_delay;
+    }
+    return (uint32_t)delay;
+}
+
+float trigger_decoder_get_cycle_degrees(void) {
+    trigger_state_t state;
+    trigger_decoder_get_state(&state);
+    return (state.sync == TRIGGER_SYNC_FULL) ? 720.0f : 360.0f;
+}
+
+uint32_t trigger_decoder_get_tooth_edges(void) {
+    return tooth_edges;
+}
+
+uint32_t trigger_decoder_get_sync_loss_count(void) {
+    return sync_losses;
+}
+
+uint32_t trigger_decoder_get_cam_error_count(void) {
+    return cam_errors;
+}
+
+float trigger_decoder_get_prediction_error_deg(void) {
+    return prediction_error_deg;
+}
+
+uint32_t trigger_decoder_get_prediction_checks(void) {
+    return prediction_checks;
+}
@@ -0,0 +1,159 @@
+// trigger_decoder.h
+// Missing-tooth crank wheel decoder with optional cam phase sync
+
+/* =============================================================================
+ * TRIGGER DECODER OVERVIEW
+ * =============================================================================
+ *
+ * The crank ISR timestamps every tooth edge and keeps, per tooth:
+ * - the tooth position since the missing-tooth gap and its crank angle
+ * - the time per tooth position and the instantaneous RPM it implies
+ *
+ * Gap detection: a tooth period more than (missing + 2) / 2 times the
+ * previous per-position period is the gap (1.5x for 36-1, 2x for 60-2).
+ * The first tooth after the gap is position 0. A gap at the wrong position,
+ * or more teeth than the wheel carries, counts a sync loss.
+ *
+ * Sync levels:
+ * - TRIGGER_SYNC_NONE:  no gap seen yet; RPM only
+ * - TRIGGER_SYNC_CRANK: gap found; angle is 0..360 (wasted spark/batch fuel)
+ * - TRIGGER_SYNC_FULL:  cam edge seen; angle is 0..720 (sequential)
+ *
+ * With use_cam_sync, one cam edge per 720° marks the crank revolution that
+ * ends at the next gap as the second half of the cycle; later revolutions
+ * alternate, and each cam edge re-checks the phase.
+ *
+ * Shared state: the ISR is the only writer. It publishes each tooth through
+ * a sequence counter (odd while writing), so readers in the main loop or a
+ * lower-priority interrupt copy a consistent snapshot without disabling
+ * interrupts; they retry only if a tooth arrived mid-copy.
+ *
+ * Crank-speed model: each tooth also updates a filtered first and second
+ * difference of the tooth period (period_slope_us, period_curve_us), so the
+ * period x teeth ahead is modelled as
+ *
+ *   p(x) = P + slope * x + curve * x^2 / 2
+ *
+ * trigger_decoder_predict_delay_us() integrates that to turn an angle ahead
+ * of the latest tooth into a delay, instead of assuming the last period
+ * holds - the difference is largest at high RPM under hard acceleration.
+ * The model is followed for TRIGGER_PREDICT_HORIZON_TEETH and held flat
+ * beyond, and a period is never predicted below half or above twice the
+ * last one.
+ *
+ * The decoder checks itself: every TRIGGER_PREDICT_CHECK_TEETH it predicts
+ * the arrival of a tooth that far ahead, and compares when it comes. The
+ * mean absolute error in crank degrees goes out as
+ * MSG_CRANK_PREDICTION_ERROR for tuning the schedulers' lead times.
+ *
+ * Tooth callbacks (the ignition and injection schedulers) run in the crank
+ * ISR right after each tooth is published, and once more from the main
+ * loop with interrupts off when a stall drops sync.
+ *
+ * trigger_decoder_update() runs in the main loop: it drops sync after
+ * stall_timeout_us without a tooth and publishes MSG_ENGINE_RPM,
+ * MSG_CRANK_POSITION and MSG_CRANK_PREDICTION_ERROR every
+ * TRIGGER_DECODER_PUBLISH_INTERVAL_US. Timing
+ * consumers read the state directly, never through the bus.
+ *
+ * Hardware note: Teensy 4.1 pins share one fast-GPIO interrupt vector, so
+ * trigger_decoder_begin() raises that vector's priority for every pin
+ * interrupt, including the input_manager edge counters.
+ * =============================================================================
+ */
+
+#ifndef TRIGGER_DECODER_H
+#define TRIGGER_DECODER_H
+
+#include <stdint.h>
+
+#define TRIGGER_SYNC_NONE       0
+#define TRIGGER_SYNC_CRANK      1
+#define TRIGGER_SYNC_FULL       2
+
+#define TRIGGER_EDGE_RISING     0
+#define TRIGGER_EDGE_FALLING    1
+
+#define TRIGGER_NO_PIN          0xFF
+
+#define TRIGGER_DECODER_PUBLISH_INTERVAL_US     20000   // 50 Hz RPM/angle on the bus
+#define TRIGGER_DECODER_DEFAULT_STALL_US        500000
+#define TRIGGER_DECODER_MAX_CALLBACKS           4
+#define TRIGGER_PREDICT_HORIZON_TEETH           12      // Teeth the slope/curve are extrapolated over
+#define TRIGGER_PREDICT_CHECK_TEETH             6       // Look-ahead of the self-check predictions
+#define TRIGGER_PREDICT_FILTER                  0.25f   // Weight of each new tooth in the slope/curve
+
+typedef struct {
+    uint8_t tooth_count;            // Tooth positions including missing (36 for 36-1)
+    uint8_t missing_teeth;          // 1 or 2
+    uint8_t use_cam_sync;           // 1 = cam edge gives 720° sync
+    uint8_t crank_edge;             // TRIGGER_EDGE_*
+    uint8_t cam_edge;               // TRIGGER_EDGE_*
+    float first_tooth_angle_deg;    // Crank angle of position 0 (degrees after TDC #1)
+    uint32_t stall_timeout_us;      // No tooth for this long = engine stopped
+} trigger_wheel_config_t;
+
+// Snapshot of the decoder at the latest tooth
+typedef struct {
+    uint32_t tooth_time_us;         // Timestamp of the latest tooth edge
+    uint32_t tooth_period_us;       // Time per tooth position (gap divided out)
+    float tooth_angle_deg;          // Crank angle at that edge, 0..360 or 0..720
+    float rpm;                      // Instantaneous, from that one tooth period
+    float us_per_degree;            // tooth_period_us per crank degree
+    float period_slope_us;          // Filtered change in period per tooth (<0 accelerating)
+    float period_curve_us;          // Filtered change in slope per tooth
+    uint16_t tooth_index;           // Position since the gap, 0 = first after it
+    uint8_t sync;                   // TRIGGER_SYNC_*
+    uint8_t cycle_phase;            // 0/1 = first/second revolution (FULL sync only)
+    uint32_t revolutions;           // Gaps seen since sync
+} trigger_state_t;
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+// Reset to an unsynced 36-1 crank-only wheel with no pins attached
+void trigger_decoder_init(void);
+
+// Replace the wheel configuration and drop sync.
+// Returns false (keeping the old configuration) if it is not a valid wheel.
+bool trigger_decoder_configure(const trigger_wheel_config_t* config);
+
+// Called with the new state after every tooth (ISR context)
+typedef void (*trigger_tooth_callback_t)(const trigger_state_t* state);
+
+// Add a tooth callback. Returns false if all TRIGGER_DECODER_MAX_CALLBACKS are used.
+bool trigger_decoder_add_tooth_callback(trigger_tooth_callback_t callback);
+
+// Attach the crank (and optionally cam) pin interrupts. cam_pin may be TRIGGER_NO_PIN.
+void trigger_decoder_begin(uint8_t crank_pin, uint8_t cam_pin);
+
+// Stall detection and bus publishing; called once per main loop
+void trigger_decoder_update(void);
+
+// Consistent copy of the latest tooth. Returns false if there is no crank sync.
+bool trigger_decoder_get_state(trigger_state_t* state);
+
+// Crank angle extrapolated from the latest tooth to time_us.
+// Returns false if there is no crank sync.
+bool trigger_decoder_angle_at(uint32_t time_us, float* angle_deg);
+
+// Time for the crank to turn delta_deg past the tooth in state, from the
+// crank-speed model. Pure function of the snapshot; safe in tooth callbacks.
+uint32_t trigger_decoder_predict_delay_us(const trigger_state_t* state, float delta_deg);
+
+// Degrees per engine cycle at the current sync level (360 or 720)
+float trigger_decoder_get_cycle_degrees(void);
+
+// Interrupt bodies; the attached ISRs call these with micros()
+void trigger_decoder_crank_edge(uint32_t time_us);
+void trigger_decoder_cam_edge(uint32_t time_us);
+
+// Diagnostics
+uint32_t trigger_decoder_get_tooth_edges(void);
+uint32_t trigger_decoder_get_sync_loss_count(void);
+uint32_t trigger_decoder_get_cam_error_count(void);
+float trigger_decoder_get_prediction_error_deg(void);     // Latest check, signed (+ = tooth late)
+uint32_t trigger_decoder_get_prediction_checks(void);
+
+#endif
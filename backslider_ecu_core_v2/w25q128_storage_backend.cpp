@@ -8,18 +8,30 @@
 #include "tests/mock_arduino.h"
 #else
 #include <SPI.h>
+#include "shift_chain.h"
+#endif
+
+#if defined(ARDUINO) && defined(__IMXRT1062__)
+#include "flexspi_flash.h"
 #endif
 
 #include <cstring>
+#include <cstddef>
 #include <algorithm>
+#include <new>
 
 // =============================================================================
 // Static Constants
 // =============================================================================
 
-const uint32_t W25Q128StorageBackend::STORAGE_MAGIC;
-const uint32_t W25Q128StorageBackend::MAX_CACHE_SIZE;
 const uint32_t W25Q128StorageBackend::MAX_DATA_SIZE;
+const uint32_t W25Q128StorageBackend::NOT_FOUND;
+
+// Checksum covers the record from storage_key to the end of its data
+static const size_t RECORD_CHECKED_OFFSET = offsetof(LogRecordHeader, storage_key);
+
+static_assert((W25Q128_INDEX_CAPACITY & (W25Q128_INDEX_CAPACITY - 1)) == 0,
+              "W25Q128_INDEX_CAPACITY must be a power of two");
 
 // =============================================================================
 // Constructor and Destructor
@@ -27,30 +39,44 @@ const uint32_t W25Q128StorageBackend::MAX_DATA_SIZE;
 
 W25Q128StorageBackend::W25Q128StorageBackend(const ECUConfiguration& config) 
     : ecu_config(config), flash_initialized(false), flash_id(0), total_sectors(0), used_sectors(0),
-      cache_enabled(true), cache_size_limit(MAX_CACHE_SIZE), cache_hits(0), cache_misses(0),
-      error_count(0) {
+      write_cache(nullptr), cache_count(0), cache_limit(W25Q128_CACHE_ENTRIES), cache_high_water(0),
+      cache_enabled(true), cache_hits(0), cache_misses(0),
+      error_count(0), index_slots(nullptr), index_count(0), index_high_water(0), active_sector(NOT_FOUND), write_offset(0), next_sequence(0), collecting(false),
+      sectors_since_checkpoint(0), checkpoint_generation(0), checkpoint_sectors(0), checkpoints_written(0),
+      boot_scanned_sectors(0), sector_erases(0), records_written(0), op_head(0), op_count(0),
+      op_running(false), op_started_ms(0), ops_completed(0), read_suspends(0), queue_full_waits(0),
+      flash_reads(0) {
     
     // Extract SPI configuration from ECU config
     cs_pin = config.spi.qspi_flash.cs_pin;
     spi_frequency = config.spi.qspi_flash.frequency;
+    memory_mapped = config.spi.qspi_flash.memory_mapped;
+    mapped_flash = nullptr;
+    map_held = false;
+    map_suspended = false;
     
     // Initialize sector tracking
     total_sectors = W25Q128_FLASH_SIZE / W25Q128_SECTOR_SIZE;
-    sector_allocated.resize(total_sectors, false);
-    
-    // Reserve space for cache
-    write_cache.reserve(256); // Pre-allocate for 256 cache entries
+    sector_allocated.resize(W25Q128_LOG_SECTORS, false);
+    sector_live_bytes.resize(W25Q128_LOG_SECTORS, 0);
+    sector_dead_bytes.resize(W25Q128_LOG_SECTORS, 0);
+    sector_uncheckpointed.resize(W25Q128_LOG_SECTORS, false);
     
     // Clear error message
     strcpy(last_error, "No errors");
+    
+#ifdef TESTING
+    mock_busy_until_us = 0;
+#endif
 }
 
 W25Q128StorageBackend::~W25Q128StorageBackend() {
     // Flush any pending writes
     flush();
+    waitForOperations();
     
-    // Clear cache
-    write_cache.clear();
+    delete[] write_cache;
+    delete[] index_slots;
 }
 
 // =============================================================================
@@ -58,6 +84,12 @@ W25Q128StorageBackend::~W25Q128StorageBackend() {
 // =============================================================================
 
 bool W25Q128StorageBackend::begin() {
+    if (!allocatePools()) {
+        strcpy(last_error, "Out of memory for index and cache");
+        error_count++;
+        return false;
+    }
+    
     if (!initializeFlash()) {
         strcpy(last_error, "Flash initialization failed");
         error_count++;
@@ -80,6 +112,14 @@ bool W25Q128StorageBackend::end() {
     // Disable cache
     enableWriteCache(false);
     
+    // Checkpoint so the next begin() has nothing to replay
+    if (flash_initialized && sectors_since_checkpoint > 0) {
+        writeCheckpoint();
+    }
+    
+    // Nothing may still be in flight when the chip is handed back
+    waitForOperations();
+    
     flash_initialized = false;
     return true;
 }
@@ -92,12 +132,11 @@ bool W25Q128StorageBackend::readData(uint32_t storage_key, void* data, size_t da
     }
     
     // Check cache first for performance
-    auto cache_it = write_cache.find(storage_key);
-    if (cache_it != write_cache.end()) {
+    const CacheEntry* entry = findCacheEntry(storage_key);
+    if (entry) {
         cache_hits++;
-        const CacheEntry& entry = cache_it->second;
-        if (entry.data.size() == dataSize) {
-            memcpy(data, entry.data.data(), dataSize);
+        if (entry->size == dataSize) {
+            memcpy(data, entry->data, dataSize);
             return true;
         } else {
             // Size mismatch - this shouldn't happen in normal operation
@@ -109,16 +148,18 @@ bool W25Q128StorageBackend::readData(uint32_t storage_key, void* data, size_t da
     
     cache_misses++;
     
-#ifdef TESTING
-    // In test environment, if not in cache, return false
-    // Don't try to read from flash as it's not properly mocked
-    strcpy(last_error, "Data not found in cache (test environment)");
-    error_count++;
-    return false;
-#else
-    // Read from flash
-    return readStorageEntry(storage_key, data, dataSize);
-#endif
+    // Read from flash. Small values are only copied out once verified.
+    uint8_t buffer[W25Q128_PAGE_SIZE];
+    if (dataSize > sizeof(buffer)) {
+        StorageSegment segment = {data, dataSize};
+        return readStorageEntry(storage_key, &segment, 1);
+    }
+    StorageSegment segment = {buffer, dataSize};
+    if (!readStorageEntry(storage_key, &segment, 1)) {
+        return false;
+    }
+    memcpy(data, buffer, dataSize);
+    return true;
 }
 
 bool W25Q128StorageBackend::writeData(uint32_t storage_key, const void* data, size_t dataSize) {
@@ -129,30 +170,237 @@ bool W25Q128StorageBackend::writeData(uint32_t storage_key, const void* data, si
     }
     
     if (dataSize > MAX_DATA_SIZE) {
-        strcpy(last_error, "Data too large for single page");
+        strcpy(last_error, "Data too large for single record");
+        error_count++;
+        return false;
+    }
+    
+    if (dataSize == 0) {
+        strcpy(last_error, "Zero-length data");   // Reserved for tombstones
         error_count++;
         return false;
     }
     
     // Add to write cache for performance
-    if (cache_enabled) {
-        CacheEntry& entry = write_cache[storage_key];
-        entry.storage_key = storage_key;
-        entry.data.resize(dataSize);
-        memcpy(entry.data.data(), data, dataSize);
-        entry.timestamp = millis();
-        entry.dirty = true;
+    CacheEntry* entry = findCacheEntry(storage_key);
+    if (cache_enabled && dataSize <= W25Q128_CACHE_VALUE_SIZE && (entry || cache_limit > 0)) {
+        if (!entry) {
+            if (cache_count >= cache_limit) {
+                // Full: write everything back and start over
+                flush();
+                cache_count = 0;
+            }
+            entry = &write_cache[cache_count++];
+            entry->storage_key = storage_key;
+            if (cache_count > cache_high_water) {
+                cache_high_water = cache_count;
+            }
+        }
+        entry->size = dataSize;
+        memcpy(entry->data, data, dataSize);
+        entry->timestamp = millis();
+        entry->dirty = true;
+        return true;
+    }
+    
+    // Direct write to flash; a cached copy would shadow it
+    removeCacheEntry(storage_key);
+    StorageSegment segment = {(void*)data, dataSize};
+    return writeStorageEntry(storage_key, &segment, 1);
+}
+
+bool W25Q128StorageBackend::writeBlob(uint32_t storage_key, const StorageSegment* segments, uint8_t count) {
+    if (!flash_initialized) {
+        strcpy(last_error, "Flash not initialized");
+        error_count++;
+        return false;
+    }
+    
+    // Blobs bypass the write cache; drop any cached value it would shadow
+    removeCacheEntry(storage_key);
+    return writeStorageEntry(storage_key, segments, count);
+}
+
+bool W25Q128StorageBackend::readBlob(uint32_t storage_key, const StorageSegment* segments, uint8_t count) {
+    if (!flash_initialized) {
+        strcpy(last_error, "Flash not initialized");
+        error_count++;
+        return false;
+    }
+    
+    // A value written with writeData() may still be in the cache
+    const CacheEntry* entry = findCacheEntry(storage_key);
+    if (entry) {
+        size_t offset = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            offset += segments[i].size;
+        }
+        if (offset != entry->size) {
+            strcpy(last_error, "Cache data size mismatch");
+            error_count++;
+            return false;
+        }
+        offset = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            memcpy(segments[i].data, &entry->data[offset], segments[i].size);
+            offset += segments[i].size;
+        }
+        cache_hits++;
+        return true;
+    }
+    
+    cache_misses++;
+    return readStorageEntry(storage_key, segments, count);
+}
+
+uint8_t W25Q128StorageBackend::readMany(StorageItem* items, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        items[i].ok = false;
+    }
+    if (!flash_initialized) {
+        strcpy(last_error, "Flash not initialized");
+        error_count++;
+        return 0;
+    }
+    
+    // Cache hits are served now; the misses are sorted by flash address
+    uint8_t done = 0;
+    uint8_t misses = 0;
+    uint8_t order[UINT8_MAX];
+    RecordLocation locations[UINT8_MAX];
+    for (uint8_t i = 0; i < count; i++) {
+        StorageItem& item = items[i];
+        const CacheEntry* entry = findCacheEntry(item.storage_key);
+        if (entry) {
+            cache_hits++;
+            if (entry->size == item.size) {
+                memcpy(item.data, entry->data, item.size);
+                item.ok = true;
+                done++;
+            } else {
+                strcpy(last_error, "Cache data size mismatch");
+                error_count++;
+            }
+            continue;
+        }
         
-        // Check cache size limit
-        if (write_cache.size() > cache_size_limit / 1024) { // Rough estimate
-            flush(); // Flush to make room
+        cache_misses++;
+        const IndexSlot* slot = findRecord(item.storage_key);
+        if (!slot) {
+            strcpy(last_error, "Storage entry not found");
+            error_count++;
+            continue;
+        }
+        locations[i] = slot->location;
+        order[misses++] = i;
+    }
+    std::sort(order, order + misses, [&locations](uint8_t a, uint8_t b) {
+        return locations[a].address < locations[b].address;
+    });
+    
+    // Each run of records that fits the buffer is fetched with one read
+    uint8_t buffer[W25Q128_PAGE_SIZE];
+    uint8_t first = 0;
+    while (first < misses) {
+        const RecordLocation& start = locations[order[first]];
+        if (start.size > sizeof(buffer)) {
+            StorageItem& item = items[order[first++]];
+            StorageSegment segment = {item.data, item.size};
+            item.ok = readStorageEntry(item.storage_key, &segment, 1);
+            done += item.ok;
+            continue;
         }
         
-        return true;
+        uint8_t last = first + 1;
+        while (last < misses &&
+               locations[order[last]].address + locations[order[last]].size - start.address <= sizeof(buffer)) {
+            last++;
+        }
+        const RecordLocation& end = locations[order[last - 1]];
+        if (!readPage(start.address, buffer, end.address + end.size - start.address)) {
+            strcpy(last_error, "Failed to read storage entry");
+            error_count++;
+            first = last;
+            continue;
+        }
+        
+        for (; first < last; first++) {
+            StorageItem& item = items[order[first]];
+            const uint8_t* record = buffer + (locations[order[first]].address - start.address);
+            if (checkRecord(record, item.storage_key, item.size)) {
+                memcpy(item.data, record + sizeof(LogRecordHeader), item.size);
+                item.ok = true;
+                done++;
+            }
+        }
+    }
+    return done;
+}
+
+uint8_t W25Q128StorageBackend::writeMany(StorageItem* items, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        items[i].ok = false;
+    }
+    if (!flash_initialized) {
+        strcpy(last_error, "Flash not initialized");
+        error_count++;
+        return 0;
     }
     
-    // Direct write to flash
-    return writeStorageEntry(storage_key, data, dataSize);
+    StagedRecords staged;
+    staged.fill = 0;
+    staged.count = 0;
+    uint8_t done = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        StorageItem& item = items[i];
+        if (!item.data || item.size == 0 || item.size > MAX_DATA_SIZE) {
+            strcpy(last_error, "Invalid data size for single record");
+            error_count++;
+            continue;
+        }
+        
+        // Batches bypass the write cache; drop any cached value it would shadow
+        removeCacheEntry(item.storage_key);
+        StorageSegment segment = {item.data, item.size};
+        uint32_t size = recordSize(item.size);
+        if (size > sizeof(staged.page)) {
+            done += commitStaged(staged, items);
+            item.ok = writeStorageEntry(item.storage_key, &segment, 1);
+            done += item.ok;
+            continue;
+        }
+        
+        // Staged records go to flash before the head can move to another
+        // sector, and before the index check needs them counted
+        if (staged.fill + size > sizeof(staged.page) || staged.count == sizeof(staged.items) ||
+            active_sector == NOT_FOUND || write_offset + size > W25Q128_SECTOR_SIZE ||
+            index_count + staged.count >= W25Q128_INDEX_CAPACITY) {
+            done += commitStaged(staged, items);
+        }
+        if (index_count >= W25Q128_INDEX_CAPACITY && !findRecord(item.storage_key)) {
+            strcpy(last_error, "Index full");
+            error_count++;
+            continue;
+        }
+        
+        uint32_t address;
+        if (!reserveRecord(size, &address)) {
+            continue;
+        }
+        if (staged.count == 0) {
+            staged.address = address;
+        }
+        LogRecordHeader header;
+        buildRecordHeader(&header, item.storage_key, &segment, 1);
+        uint8_t* record = staged.page + staged.fill;
+        memcpy(record, &header, sizeof(header));
+        memcpy(record + sizeof(header), item.data, item.size);
+        memset(record + sizeof(header) + item.size, 0xFF, size - sizeof(header) - item.size);
+        staged.fill += size;
+        staged.items[staged.count++] = i;
+    }
+    done += commitStaged(staged, items);
+    return done;
 }
 
 bool W25Q128StorageBackend::deleteData(uint32_t storage_key) {
@@ -163,7 +411,7 @@ bool W25Q128StorageBackend::deleteData(uint32_t storage_key) {
     }
     
     // Remove from cache
-    write_cache.erase(storage_key);
+    removeCacheEntry(storage_key);
     
     // Delete from flash
     return deleteStorageEntry(storage_key);
@@ -173,12 +421,12 @@ bool W25Q128StorageBackend::hasData(uint32_t storage_key) {
     if (!flash_initialized) return false;
     
     // Check cache first
-    if (write_cache.find(storage_key) != write_cache.end()) {
+    if (findCacheEntry(storage_key)) {
         return true;
     }
     
     // Check flash
-    return key_to_sector.find(storage_key) != key_to_sector.end();
+    return findRecord(storage_key) != nullptr;
 }
 
 uint32_t W25Q128StorageBackend::getTotalSpace() {
@@ -186,60 +434,117 @@ uint32_t W25Q128StorageBackend::getTotalSpace() {
 }
 
 uint32_t W25Q128StorageBackend::getFreeSpace() {
-    return (total_sectors - used_sectors) * W25Q128_SECTOR_SIZE;
+    return (total_sectors - used_sectors - checkpoint_sectors) * W25Q128_SECTOR_SIZE;
 }
 
 uint32_t W25Q128StorageBackend::getUsedSpace() {
-    return used_sectors * W25Q128_SECTOR_SIZE;
+    return (used_sectors + checkpoint_sectors) * W25Q128_SECTOR_SIZE;
 }
 
 void W25Q128StorageBackend::sync() {
-    // No-op for SPI flash (no filesystem sync needed)
+    // Background maintenance, one sector or one checkpoint per call so the
+    // caller's time slot stays bounded
+    if (!flash_initialized) return;
+    
+    if (sectors_since_checkpoint >= W25Q128_CHECKPOINT_INTERVAL_SECTORS) {
+        writeCheckpoint();
+        return;
+    }
+    
+    uint32_t sector = findGarbageSector();
+    if (sector != NOT_FOUND && sector_dead_bytes[sector] >= W25Q128_GC_DEAD_THRESHOLD) {
+        reclaimSector(sector);
+    }
+}
+
+void W25Q128StorageBackend::poll() {
+    releaseData();
+    if (op_running) {
+        if (chipBusy()) {
+            if (millis() - op_started_ms < W25Q128_OP_TIMEOUT_MS) {
+                return;
+            }
+            completeOperation(false);
+        } else {
+            completeOperation(true);
+        }
+    }
+    startOperation();
 }
 
 void W25Q128StorageBackend::flush() {
     if (!cache_enabled) return;
     
-#ifdef TESTING
-    // In test environment, just mark all entries as not dirty
-    // Don't actually write to flash as it's not properly mocked
-    for (auto& pair : write_cache) {
-        CacheEntry& entry = pair.second;
-        entry.dirty = false;
-    }
-#else
     // Write all dirty cache entries to flash
-    for (auto& pair : write_cache) {
-        CacheEntry& entry = pair.second;
+    for (uint16_t i = 0; i < cache_count; i++) {
+        CacheEntry& entry = write_cache[i];
         if (entry.dirty) {
-            writeStorageEntry(entry.storage_key, entry.data.data(), entry.data.size());
+            StorageSegment segment = {entry.data, entry.size};
+            writeStorageEntry(entry.storage_key, &segment, 1);
             entry.dirty = false;
         }
     }
-#endif
 }
 
 uint32_t W25Q128StorageBackend::getStoredKeyCount() {
-    return key_to_sector.size() + write_cache.size();
+    // Cached keys already on flash are counted once
+    uint32_t count = index_count;
+    for (uint16_t i = 0; i < cache_count; i++) {
+        if (!findRecord(write_cache[i].storage_key)) {
+            count++;
+        }
+    }
+    return count;
 }
 
 bool W25Q128StorageBackend::getStoredKey(uint32_t index, uint32_t* storage_key) {
     if (index >= getStoredKeyCount()) return false;
     
-    // Return keys from flash first, then cache
-    if (index < key_to_sector.size()) {
-        auto it = key_to_sector.begin();
-        std::advance(it, index);
-        *storage_key = it->first;
-        return true;
+    // Return keys from flash first, in slot order, then cache-only keys
+    if (index < index_count) {
+        for (uint32_t slot = 0; slot < W25Q128_INDEX_SLOTS; slot++) {
+            if (index_slots[slot].storage_key == W25Q128_EMPTY_KEY) continue;
+            if (index == 0) {
+                *storage_key = index_slots[slot].storage_key;
+                return true;
+            }
+            index--;
+        }
+        return false;
     }
     
-    // Return from cache
-    index -= key_to_sector.size();
-    auto it = write_cache.begin();
-    std::advance(it, index);
-    *storage_key = it->first;
-    return true;
+    index -= index_count;
+    for (uint16_t i = 0; i < cache_count; i++) {
+        if (findRecord(write_cache[i].storage_key)) continue;
+        if (index == 0) {
+            *storage_key = write_cache[i].storage_key;
+            return true;
+        }
+        index--;
+    }
+    return false;
+}
+
+uint32_t W25Q128StorageBackend::listKeys(uint32_t after_key, uint32_t mask, uint32_t match,
+                                         uint32_t* keys, uint32_t max) {
+    // One pass over the index slots and the cache, not one per key
+    uint32_t count = 0;
+    uint32_t filled = 0;
+    for (uint32_t slot = 0; index_slots && slot < W25Q128_INDEX_SLOTS; slot++) {
+        uint32_t key = index_slots[slot].storage_key;
+        if (key != W25Q128_EMPTY_KEY && key > after_key && (key & mask) == match) {
+            count++;
+            insertListedKey(key, keys, &filled, max);
+        }
+    }
+    for (uint16_t i = 0; i < cache_count; i++) {
+        uint32_t key = write_cache[i].storage_key;
+        if (key > after_key && (key & mask) == match && !findRecord(key)) {
+            count++;
+            insertListedKey(key, keys, &filled, max);
+        }
+    }
+    return count;
 }
 
 void W25Q128StorageBackend::printDebugInfo() {
@@ -260,6 +565,12 @@ void W25Q128StorageBackend::printDebugInfo() {
     Serial.print("Cache Hit Rate: ");
     Serial.print(getCacheHitRate());
     Serial.println("%");
+    Serial.print("Live Bytes: ");
+    Serial.println(getLiveBytes());
+    Serial.print("Records Written: ");
+    Serial.println(records_written);
+    Serial.print("Sector Erases: ");
+    Serial.println(sector_erases);
     Serial.print("Error Count: ");
     Serial.println(error_count);
     Serial.print("Last Error: ");
@@ -273,11 +584,28 @@ void W25Q128StorageBackend::printDebugInfo() {
 
 bool W25Q128StorageBackend::initializeFlash() {
 #ifdef TESTING
-    // Mock initialization for testing
+    // Mock initialization for testing - the image survives end()/begin()
+    if (mock_flash.empty()) {
+        mock_flash.assign(W25Q128_FLASH_SIZE, 0xFF);
+    }
     flash_id = 0xEF4018; // Mock W25Q128 ID
+    mapped_flash = memory_mapped ? mock_flash.data() : nullptr;
     flash_initialized = true;
     return true;
 #else
+#if defined(__IMXRT1062__)
+    if (memory_mapped) {
+        if (!flexspi_flash_init()) {
+            strcpy(last_error, "No flash on the FlexSPI2 pads");
+            return false;
+        }
+        mapped_flash = flexspi_flash_window();
+        flash_id = getFlashID();
+        flash_initialized = true;
+        return true;
+    }
+#endif
+    
     // Initialize SPI
     SPI.begin();
     // Note: Teensy SPI doesn't have setFrequency, setDataMode, setBitOrder methods
@@ -317,11 +645,15 @@ bool W25Q128StorageBackend::verifyFlash() {
 void W25Q128StorageBackend::formatFlash() {
     if (!flash_initialized) return;
     
+    // Queued operations would land on the erased chip
+    waitForOperations();
+    
     // Erase entire flash chip
+#ifdef TESTING
+    std::fill(mock_flash.begin(), mock_flash.end(), 0xFF);
+#endif
     writeEnable();
-    selectChip();
-    spiTransfer(W25Q128_CMD_CHIP_ERASE);
-    deselectChip();
+    flashCommand(W25Q128_CMD_CHIP_ERASE, 0, false, nullptr, nullptr, 0);
     
     // Wait for erase to complete
     while (!waitForWriteComplete()) {
@@ -333,19 +665,14 @@ void W25Q128StorageBackend::formatFlash() {
     }
     
     // Clear tracking structures
-    sector_allocated.clear();
-    sector_allocated.resize(total_sectors, false);
-    key_to_sector.clear();
-    write_cache.clear();
-    used_sectors = 0;
+    resetIndex();
+    cache_count = 0;
 }
 
 uint32_t W25Q128StorageBackend::getFlashID() {
-    selectChip();
-    spiTransfer(W25Q128_CMD_READ_JEDEC_ID);
-    uint32_t id = (spiTransfer(0) << 16) | (spiTransfer(0) << 8) | spiTransfer(0);
-    deselectChip();
-    return id;
+    uint8_t id[3];
+    flashCommand(W25Q128_CMD_READ_JEDEC_ID, 0, false, nullptr, id, sizeof(id));
+    return ((uint32_t)id[0] << 16) | ((uint32_t)id[1] << 8) | id[2];
 }
 
 void W25Q128StorageBackend::printFlashInfo() {
@@ -368,7 +695,7 @@ void W25Q128StorageBackend::printFlashInfo() {
 }
 
 bool W25Q128StorageBackend::isFlashReady() {
-    return flash_initialized && waitForWriteComplete();
+    return flash_initialized && waitForOperations() && waitForWriteComplete();
 }
 
 // =============================================================================
@@ -388,7 +715,13 @@ void W25Q128StorageBackend::enableWriteCache(bool enable) {
 }
 
 void W25Q128StorageBackend::setCacheSize(uint32_t size) {
-    cache_size_limit = std::min(size, MAX_CACHE_SIZE);
+    // Bytes, in whole values; shrinking writes back what no longer fits
+    uint32_t entries = std::min<uint32_t>(size / W25Q128_CACHE_VALUE_SIZE, W25Q128_CACHE_ENTRIES);
+    if (entries < cache_count) {
+        flush();
+        cache_count = 0;
+    }
+    cache_limit = entries;
 }
 
 uint32_t W25Q128StorageBackend::getCacheHitRate() {
@@ -398,11 +731,51 @@ uint32_t W25Q128StorageBackend::getCacheHitRate() {
 }
 
 void W25Q128StorageBackend::clearCache() {
-    write_cache.clear();
+    cache_count = 0;
     cache_hits = 0;
     cache_misses = 0;
 }
 
+// =============================================================================
+// Log Maintenance
+// =============================================================================
+
+uint32_t W25Q128StorageBackend::collectGarbage(uint32_t max_sectors) {
+    uint32_t reclaimed = 0;
+    while (reclaimed < max_sectors) {
+        uint32_t sector = findGarbageSector();
+        if (sector == NOT_FOUND || !reclaimSector(sector)) {
+            break;
+        }
+        reclaimed++;
+    }
+    return reclaimed;
+}
+
+uint32_t W25Q128StorageBackend::getSectorEraseCount() {
+    return sector_erases;
+}
+
+uint32_t W25Q128StorageBackend::getRecordsWritten() {
+    return records_written;
+}
+
+uint32_t W25Q128StorageBackend::getCheckpointCount() {
+    return checkpoints_written;
+}
+
+uint32_t W25Q128StorageBackend::getBootScannedSectors() {
+    return boot_scanned_sectors;
+}
+
+uint32_t W25Q128StorageBackend::getLiveBytes() {
+    uint32_t live = 0;
+    for (uint32_t sector = 0; sector < W25Q128_LOG_SECTORS; sector++) {
+        live += sector_live_bytes[sector];
+    }
+    return live;
+}
+
 // =============================================================================
 // Error Handling
 // =============================================================================
@@ -424,12 +797,24 @@ const char* W25Q128StorageBackend::getLastError() {
 // Private SPI Communication Methods
 // =============================================================================
 
+// LPSPI is shared with the output shift chains: a command holds the bus
+// from chip select to deselect, after any chain DMA in flight
 void W25Q128StorageBackend::selectChip() {
+#ifndef TESTING
+    if (!shift_chain_claim_bus(W25Q128_SPI_CLAIM_TIMEOUT_US)) {
+        strcpy(last_error, "SPI bus busy");
+    }
+    SPI.beginTransaction(SPISettings(spi_frequency, MSBFIRST, SPI_MODE0));
+#endif
     digitalWrite(cs_pin, LOW);
 }
 
 void W25Q128StorageBackend::deselectChip() {
     digitalWrite(cs_pin, HIGH);
+#ifndef TESTING
+    SPI.endTransaction();
+    shift_chain_release_bus();
+#endif
 }
 
 uint8_t W25Q128StorageBackend::spiTransfer(uint8_t data) {
@@ -465,19 +850,42 @@ void W25Q128StorageBackend::spiWrite(const uint8_t* data, size_t length) {
 // Flash Command Methods
 // =============================================================================
 
-void W25Q128StorageBackend::writeEnable() {
+void W25Q128StorageBackend::flashCommand(uint8_t opcode, uint32_t address, bool addressed,
+                                         const uint8_t* tx, uint8_t* rx, size_t length) {
+#if defined(ARDUINO) && defined(__IMXRT1062__)
+    if (memory_mapped) {
+        flexspi_flash_command(opcode, address, addressed, tx, rx, length);
+        return;
+    }
+#endif
     selectChip();
-    spiTransfer(W25Q128_CMD_WRITE_ENABLE);
+    spiTransfer(opcode);
+    if (addressed) {
+        spiTransfer((address >> 16) & 0xFF);
+        spiTransfer((address >> 8) & 0xFF);
+        spiTransfer(address & 0xFF);
+    }
+    if (tx) {
+        spiWrite(tx, length);
+    } else if (rx) {
+        spiTransfer(rx, rx, length);
+    }
     deselectChip();
 }
 
+void W25Q128StorageBackend::writeEnable() {
+    flashCommand(W25Q128_CMD_WRITE_ENABLE, 0, false, nullptr, nullptr, 0);
+}
+
 void W25Q128StorageBackend::writeDisable() {
-    selectChip();
-    spiTransfer(W25Q128_CMD_WRITE_DISABLE);
-    deselectChip();
+    flashCommand(W25Q128_CMD_WRITE_DISABLE, 0, false, nullptr, nullptr, 0);
 }
 
 bool W25Q128StorageBackend::waitForWriteComplete() {
+#ifdef TESTING
+    // The mock image completes every operation immediately
+    return true;
+#endif
     uint32_t timeout = 10000; // 10 second timeout
     uint32_t start = millis();
     
@@ -497,19 +905,14 @@ bool W25Q128StorageBackend::waitForWriteComplete() {
 }
 
 uint8_t W25Q128StorageBackend::readStatus() {
-    selectChip();
-    spiTransfer(W25Q128_CMD_READ_STATUS1);
-    uint8_t status = spiTransfer(0);
-    deselectChip();
+    uint8_t status;
+    flashCommand(W25Q128_CMD_READ_STATUS1, 0, false, nullptr, &status, 1);
     return status;
 }
 
 void W25Q128StorageBackend::writeStatus(uint8_t status) {
     writeEnable();
-    selectChip();
-    spiTransfer(W25Q128_CMD_WRITE_STATUS);
-    spiTransfer(status);
-    deselectChip();
+    flashCommand(W25Q128_CMD_WRITE_STATUS, 0, false, &status, nullptr, 1);
     waitForWriteComplete();
 }
 
@@ -517,205 +920,1282 @@ void W25Q128StorageBackend::writeStatus(uint8_t status) {
 // Flash Operation Methods
 // =============================================================================
 
-bool W25Q128StorageBackend::readPage(uint32_t page_address, uint8_t* buffer, size_t length) {
-    selectChip();
-    spiTransfer(W25Q128_CMD_READ_DATA);
-    spiTransfer((page_address >> 16) & 0xFF);
-    spiTransfer((page_address >> 8) & 0xFF);
-    spiTransfer(page_address & 0xFF);
-    
-    // Use dynamic allocation to avoid VLA
-    uint8_t* temp_buffer = new uint8_t[length];
-    spiTransfer(temp_buffer, temp_buffer, length);
-    deselectChip();
+bool W25Q128StorageBackend::readPage(uint32_t address, uint8_t* buffer, size_t length) {
+    releaseData();
     
-    memcpy(buffer, temp_buffer, length);
-    delete[] temp_buffer;
-    return true;
+    // Queued writes to this range land first; an erase elsewhere is paused
+    completeOverlapping(address, length);
+    bool suspended = suspendErase();
+    flash_reads++;
+    
+#ifdef TESTING
+    bool success = address + length <= mock_flash.size();
+    if (success) {
+        memcpy(buffer, &mock_flash[address], length);
+    }
+#else
+    bool success = address + length <= W25Q128_FLASH_SIZE;
+    if (success && mapped_flash) {
+        memcpy(buffer, mapped_flash + address, length);
+    } else if (success) {
+        // Reads run on across page boundaries
+        flashCommand(W25Q128_CMD_READ_DATA, address, true, nullptr, buffer, length);
+    }
+#endif
+    
+    if (suspended) {
+        resumeErase();
+    }
+    return success;
 }
 
-bool W25Q128StorageBackend::writePage(uint32_t page_address, const uint8_t* buffer, size_t length) {
-    if (length > W25Q128_PAGE_SIZE) {
-        return false;
+bool W25Q128StorageBackend::programBytes(uint32_t address, const uint8_t* buffer, size_t length) {
+    while (length > 0) {
+        size_t chunk = W25Q128_PAGE_SIZE - (address % W25Q128_PAGE_SIZE);
+        if (chunk > length) {
+            chunk = length;
+        }
+        if (!submitProgram(address, buffer, chunk)) {
+            return false;
+        }
+        address += chunk;
+        buffer += chunk;
+        length -= chunk;
     }
-    
-    writeEnable();
-    selectChip();
-    spiTransfer(W25Q128_CMD_PAGE_PROGRAM);
-    spiTransfer((page_address >> 16) & 0xFF);
-    spiTransfer((page_address >> 8) & 0xFF);
-    spiTransfer(page_address & 0xFF);
-    
-    spiWrite(buffer, length);
-    deselectChip();
-    
-    return waitForWriteComplete();
+    return true;
 }
 
 bool W25Q128StorageBackend::eraseSector(uint32_t sector_address) {
-    writeEnable();
-    selectChip();
-    spiTransfer(W25Q128_CMD_SECTOR_ERASE_4K);
-    spiTransfer((sector_address >> 16) & 0xFF);
-    spiTransfer((sector_address >> 8) & 0xFF);
-    spiTransfer(sector_address & 0xFF);
-    deselectChip();
-    
-    return waitForWriteComplete();
+    sector_erases++;
+    return submitErase(sector_address);
 }
 
 bool W25Q128StorageBackend::eraseBlock(uint32_t block_address) {
+    waitForOperations();
     writeEnable();
-    selectChip();
-    spiTransfer(W25Q128_CMD_BLOCK_ERASE_64K);
-    spiTransfer((block_address >> 16) & 0xFF);
-    spiTransfer((block_address >> 8) & 0xFF);
-    spiTransfer(block_address & 0xFF);
-    deselectChip();
+    flashCommand(W25Q128_CMD_BLOCK_ERASE_64K, block_address, true, nullptr, nullptr, 0);
     
-    return waitForWriteComplete();
+    bool success = waitForWriteComplete();
+#if defined(ARDUINO) && defined(__IMXRT1062__)
+    if (mapped_flash) {
+        flexspi_flash_invalidate(block_address, W25Q128_BLOCK_SIZE);
+    }
+#endif
+    return success;
 }
 
+
 // =============================================================================
-// Storage Management Methods
+// Asynchronous Operation Queue
 // =============================================================================
 
-uint32_t W25Q128StorageBackend::findStorageEntry(uint32_t storage_key) {
-    // Check if we have this key mapped
-    auto it = key_to_sector.find(storage_key);
-    if (it != key_to_sector.end()) {
-        return it->second;
-    }
-    
-#ifdef TESTING
-    // In test environment, don't scan flash - just return not found
-    return 0xFFFFFFFF;
-#else
-    // Search through flash for the entry
-    for (uint32_t sector = 0; sector < total_sectors; sector++) {
-        if (!sector_allocated[sector]) continue;
-        
-        // Read sector header to check for our key
-        uint8_t buffer[W25Q128_PAGE_SIZE];
-        if (readPage(sector * W25Q128_SECTORS_PER_BLOCK, buffer, W25Q128_PAGE_SIZE)) {
-            StorageEntry* entry = (StorageEntry*)buffer;
-            if (entry->magic == STORAGE_MAGIC && entry->storage_key == storage_key) {
-                // Found it - add to mapping
-                key_to_sector[storage_key] = sector * W25Q128_SECTORS_PER_BLOCK;
-                return key_to_sector[storage_key];
-            }
-        }
+bool W25Q128StorageBackend::submitProgram(uint32_t address, const uint8_t* data, size_t length,
+                                          FlashOperationCallback callback, void* context) {
+    // A page program wraps within its page, so it must not cross one
+    if (length == 0 || (address % W25Q128_PAGE_SIZE) + length > W25Q128_PAGE_SIZE ||
+        address + length > W25Q128_FLASH_SIZE) {
+        return false;
     }
     
-    return 0xFFFFFFFF; // Not found
-#endif
+    FlashOperation* op = queueOperation();
+    op->type = FLASH_OP_PROGRAM;
+    op->address = address;
+    op->length = length;
+    op->callback = callback;
+    op->context = context;
+    memcpy(op->data, data, length);
+    op_count++;
+    startOperation();
+    return true;
 }
 
-bool W25Q128StorageBackend::writeStorageEntry(uint32_t storage_key, const void* data, size_t dataSize) {
-    // Find a free sector
-    uint32_t sector = findFreeSector();
-    if (sector == 0xFFFFFFFF) {
-        strcpy(last_error, "No free sectors available");
-        error_count++;
+bool W25Q128StorageBackend::submitErase(uint32_t sector_address, FlashOperationCallback callback, void* context) {
+    if (sector_address % W25Q128_SECTOR_SIZE != 0 || sector_address >= W25Q128_FLASH_SIZE) {
         return false;
     }
     
-    // Prepare storage entry
-    size_t entry_size = sizeof(StorageEntry) + dataSize;
-    uint8_t* entry_buffer = new uint8_t[entry_size];
-    
-    StorageEntry* entry = (StorageEntry*)entry_buffer;
-    entry->magic = STORAGE_MAGIC;
-    entry->storage_key = storage_key;
-    entry->data_size = dataSize;
-    entry->checksum = calculateChecksum(data, dataSize);
-    entry->timestamp = millis();
-    memcpy(entry->data, data, dataSize);
-    
-    // Write to flash
-    uint32_t page_address = sector * W25Q128_SECTORS_PER_BLOCK;
-    bool success = writePage(page_address, entry_buffer, entry_size);
-    
-    delete[] entry_buffer;
-    
-    if (success) {
-        // Update tracking
-        sector_allocated[sector] = true;
-        key_to_sector[storage_key] = page_address;
-        used_sectors++;
-    } else {
-        strcpy(last_error, "Failed to write storage entry");
-        error_count++;
+    FlashOperation* op = queueOperation();
+    op->type = FLASH_OP_ERASE_SECTOR;
+    op->address = sector_address;
+    op->length = 0;
+    op->callback = callback;
+    op->context = context;
+    op_count++;
+    startOperation();
+    return true;
+}
+
+bool W25Q128StorageBackend::waitForOperations() {
+    bool success = true;
+    while (op_count > 0) {
+        if (!finishRunningOperation()) {
+            success = false;
+        }
     }
-    
     return success;
 }
 
-bool W25Q128StorageBackend::readStorageEntry(uint32_t storage_key, void* data, size_t dataSize) {
-    uint32_t page_address = findStorageEntry(storage_key);
-    if (page_address == 0xFFFFFFFF) {
-        strcpy(last_error, "Storage entry not found");
-        error_count++;
-        return false;
-    }
+uint8_t W25Q128StorageBackend::getPendingOperations() {
+    return op_count;
+}
+
+uint32_t W25Q128StorageBackend::getCompletedOperations() {
+    return ops_completed;
+}
+
+uint32_t W25Q128StorageBackend::getReadSuspendCount() {
+    return read_suspends;
+}
+
+uint32_t W25Q128StorageBackend::getQueueFullWaits() {
+    return queue_full_waits;
+}
+
+uint32_t W25Q128StorageBackend::getFlashReadCount() {
+    return flash_reads;
+}
+
+W25Q128StorageBackend::FlashOperation* W25Q128StorageBackend::queueOperation() {
+    releaseData();
     
-    // Read the page
-    uint8_t buffer[W25Q128_PAGE_SIZE];
-    if (!readPage(page_address, buffer, W25Q128_PAGE_SIZE)) {
+    // Full: make room by waiting out the oldest
+    if (op_count == W25Q128_OP_QUEUE_SIZE) {
+        queue_full_waits++;
+        finishRunningOperation();
+    }
+    return &op_queue[(op_head + op_count) % W25Q128_OP_QUEUE_SIZE];
+}
+
+void W25Q128StorageBackend::startOperation() {
+    if (op_running || op_count == 0) {
+        return;
+    }
+    
+    const FlashOperation& op = op_queue[op_head];
+    op_running = true;
+    op_started_ms = millis();
+    
+#ifdef TESTING
+    mock_busy_until_us = micros() + (op.type == FLASH_OP_PROGRAM ? W25Q128_PROGRAM_TIME_US : W25Q128_ERASE_TIME_US);
+#else
+    writeEnable();
+    if (op.type == FLASH_OP_PROGRAM) {
+        flashCommand(W25Q128_CMD_PAGE_PROGRAM, op.address, true, op.data, nullptr, op.length);
+    } else {
+        flashCommand(W25Q128_CMD_SECTOR_ERASE_4K, op.address, true, nullptr, nullptr, 0);
+    }
+#endif
+}
+
+void W25Q128StorageBackend::completeOperation(bool success) {
+    // Pop before the callback, which may submit more
+    FlashOperation op = op_queue[op_head];
+    op_head = (op_head + 1) % W25Q128_OP_QUEUE_SIZE;
+    op_count--;
+    op_running = false;
+    ops_completed++;
+    
+#ifdef TESTING
+    // NOR semantics: program clears bits, erase sets them
+    if (success && op.type == FLASH_OP_PROGRAM) {
+        for (uint16_t i = 0; i < op.length; i++) {
+            mock_flash[op.address + i] &= op.data[i];
+        }
+    } else if (success) {
+        memset(&mock_flash[op.address], 0xFF, W25Q128_SECTOR_SIZE);
+    }
+#elif defined(ARDUINO) && defined(__IMXRT1062__)
+    // Window lines cached before the change are stale now
+    if (mapped_flash) {
+        flexspi_flash_invalidate(op.address, (op.type == FLASH_OP_PROGRAM) ? op.length : W25Q128_SECTOR_SIZE);
+    }
+#endif
+    
+    if (!success) {
+        strcpy(last_error, "Flash operation timed out");
+        error_count++;
+    }
+    if (op.callback) {
+        op.callback(op.context, op.address, success);
+    }
+}
+
+bool W25Q128StorageBackend::finishRunningOperation() {
+    // A suspended erase reads as not busy, so it must be resumed first
+    releaseData();
+    startOperation();
+    if (!op_running) {
+        return true;
+    }
+    
+#ifdef TESTING
+    // No chip to wait for: the operation finishes now
+    mock_busy_until_us = micros();
+#endif
+    bool success = true;
+    while (chipBusy()) {
+        if (millis() - op_started_ms >= W25Q128_OP_TIMEOUT_MS) {
+            success = false;
+            break;
+        }
+    }
+    completeOperation(success);
+    startOperation();
+    return success;
+}
+
+bool W25Q128StorageBackend::chipBusy() {
+#ifdef TESTING
+    return (int32_t)(mock_busy_until_us - micros()) > 0;
+#else
+    return (readStatus() & W25Q128_STATUS_BUSY) != 0;
+#endif
+}
+
+void W25Q128StorageBackend::completeOverlapping(uint32_t address, size_t length) {
+    // FIFO: finishing an operation means finishing everything before it
+    for (;;) {
+        bool overlaps = false;
+        for (uint8_t i = 0; i < op_count && !overlaps; i++) {
+            const FlashOperation& op = op_queue[(op_head + i) % W25Q128_OP_QUEUE_SIZE];
+            uint32_t span = (op.type == FLASH_OP_PROGRAM) ? op.length : W25Q128_SECTOR_SIZE;
+            overlaps = address < op.address + span && op.address < address + length;
+        }
+        if (!overlaps) {
+            return;
+        }
+        finishRunningOperation();
+    }
+}
+
+bool W25Q128StorageBackend::suspendErase() {
+    // A page program is over in well under a millisecond: wait it out
+    while (op_running && op_queue[op_head].type == FLASH_OP_PROGRAM) {
+        finishRunningOperation();
+    }
+    if (!op_running || !chipBusy()) {
+        return false;
+    }
+    
+#ifndef TESTING
+    flashCommand(W25Q128_CMD_ERASE_SUSPEND, 0, false, nullptr, nullptr, 0);
+    // Suspended within tSUS (20 µs); WIP reads clear until resumed
+    while (readStatus() & W25Q128_STATUS_BUSY) {
+    }
+#endif
+    read_suspends++;
+    return true;
+}
+
+void W25Q128StorageBackend::resumeErase() {
+#ifdef TESTING
+    // The mock clock does not run during the read, so nothing to extend
+#else
+    flashCommand(W25Q128_CMD_ERASE_RESUME, 0, false, nullptr, nullptr, 0);
+#endif
+}
+
+bool W25Q128StorageBackend::mapData(uint32_t storage_key, const void** data, size_t* size) {
+    releaseData();
+    if (!flash_initialized || !mapped_flash) {
+        strcpy(last_error, "Flash not memory-mapped");
+        error_count++;
+        return false;
+    }
+    
+    // A newer value still in the write cache goes to flash first
+    CacheEntry* entry = findCacheEntry(storage_key);
+    if (entry && entry->dirty) {
+        StorageSegment segment = {entry->data, entry->size};
+        if (!writeStorageEntry(storage_key, &segment, 1)) {
+            return false;
+        }
+        entry->dirty = false;
+    }
+    
+    const IndexSlot* slot = findRecord(storage_key);
+    if (!slot) {
+        strcpy(last_error, "Storage entry not found");
+        error_count++;
+        return false;
+    }
+    RecordLocation location = slot->location;
+    
+    // The record must be on flash and the window readable until released
+    completeOverlapping(location.address, location.size);
+    map_suspended = suspendErase();
+    map_held = true;
+    
+    LogRecordHeader header;
+    memcpy(&header, mapped_flash + location.address, sizeof(header));
+    const uint8_t* value = mapped_flash + location.address + sizeof(LogRecordHeader);
+    uint32_t checksum = calculateChecksum((const uint8_t*)&header + RECORD_CHECKED_OFFSET,
+                                          sizeof(LogRecordHeader) - RECORD_CHECKED_OFFSET);
+    if (header.magic != W25Q128_LOG_RECORD_MAGIC || header.state != LOG_RECORD_VALID ||
+        header.storage_key != storage_key || header.data_size > MAX_DATA_SIZE ||
+        calculateChecksum(value, header.data_size, checksum) != header.checksum) {
+        releaseData();
+        strcpy(last_error, "Invalid storage entry");
+        error_count++;
+        return false;
+    }
+    
+    *data = value;
+    *size = header.data_size;
+    return true;
+}
+
+void W25Q128StorageBackend::releaseData() {
+    if (map_held) {
+        map_held = false;
+        if (map_suspended) {
+            map_suspended = false;
+            resumeErase();
+        }
+    }
+}
+
+bool W25Q128StorageBackend::isMemoryMapped() {
+    return mapped_flash != nullptr;
+}
+
+
+// =============================================================================
+// Storage Management Methods
+// =============================================================================
+
+uint32_t W25Q128StorageBackend::findStorageEntry(uint32_t storage_key) {
+    // The index covers every record on flash, so a miss is absent
+    const IndexSlot* slot = findRecord(storage_key);
+    return slot ? slot->location.address : NOT_FOUND;
+}
+
+bool W25Q128StorageBackend::writeStorageEntry(uint32_t storage_key, const StorageSegment* segments, uint8_t count) {
+    size_t dataSize = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        dataSize += segments[i].size;
+    }
+    if (dataSize == 0 || dataSize > MAX_DATA_SIZE) {
+        strcpy(last_error, "Invalid data size for single record");
+        error_count++;
+        return false;
+    }
+    
+    // Refuse a new key before its record reaches flash unindexed
+    if (index_count >= W25Q128_INDEX_CAPACITY && !findRecord(storage_key)) {
+        strcpy(last_error, "Index full");
+        error_count++;
+        return false;
+    }
+    
+    RecordLocation location;
+    if (!appendRecord(storage_key, segments, count, &location)) {
+        return false;
+    }
+    
+    indexRecord(storage_key, location);
+    return true;
+}
+
+bool W25Q128StorageBackend::readStorageEntry(uint32_t storage_key, const StorageSegment* segments, uint8_t count) {
+    uint32_t address = findStorageEntry(storage_key);
+    if (address == NOT_FOUND) {
+        strcpy(last_error, "Storage entry not found");
+        error_count++;
+        return false;
+    }
+    
+    size_t dataSize = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        dataSize += segments[i].size;
+    }
+    
+    LogRecordHeader header;
+    if (!readPage(address, (uint8_t*)&header, sizeof(header))) {
         strcpy(last_error, "Failed to read storage entry");
         error_count++;
         return false;
     }
     
-    // Parse storage entry
-    StorageEntry* entry = (StorageEntry*)buffer;
-    if (entry->magic != STORAGE_MAGIC || entry->storage_key != storage_key) {
+    if (header.magic != W25Q128_LOG_RECORD_MAGIC || header.state != LOG_RECORD_VALID ||
+        header.storage_key != storage_key) {
         strcpy(last_error, "Invalid storage entry");
         error_count++;
         return false;
     }
     
-    if (entry->data_size != dataSize) {
+    if (header.data_size != dataSize) {
         strcpy(last_error, "Data size mismatch");
         error_count++;
         return false;
     }
     
-    // Verify checksum
-    uint32_t calculated_checksum = calculateChecksum(entry->data, dataSize);
-    if (entry->checksum != calculated_checksum) {
+    // Data goes straight to the segments, checksummed on the way
+    uint32_t checksum = calculateChecksum((const uint8_t*)&header + RECORD_CHECKED_OFFSET,
+                                          sizeof(LogRecordHeader) - RECORD_CHECKED_OFFSET);
+    address += sizeof(LogRecordHeader);
+    for (uint8_t i = 0; i < count; i++) {
+        if (!readPage(address, (uint8_t*)segments[i].data, segments[i].size)) {
+            strcpy(last_error, "Failed to read storage entry");
+            error_count++;
+            return false;
+        }
+        checksum = calculateChecksum(segments[i].data, segments[i].size, checksum);
+        address += segments[i].size;
+    }
+    
+    if (header.checksum != checksum) {
         strcpy(last_error, "Checksum verification failed");
         error_count++;
         return false;
     }
-    
-    // Copy data
-    memcpy(data, entry->data, dataSize);
     return true;
 }
 
 bool W25Q128StorageBackend::deleteStorageEntry(uint32_t storage_key) {
-    uint32_t page_address = findStorageEntry(storage_key);
-    if (page_address == 0xFFFFFFFF) {
+    if (findStorageEntry(storage_key) == NOT_FOUND) {
         return false; // Not found
     }
     
-    // Mark sector as free
-    uint32_t sector = page_address / W25Q128_SECTORS_PER_BLOCK;
+    // The tombstone lets a checkpoint replay see the delete
+    RecordLocation tombstone;
+    if (!appendRecord(storage_key, nullptr, 0, &tombstone)) {
+        return false;
+    }
+    retireRecord(tombstone);
+    
+    IndexSlot* slot = findRecord(storage_key);
+    supersedeRecord(slot->location);
+    eraseRecord(slot);
+    return true;
+}
+
+// =============================================================================
+// Log Methods
+// =============================================================================
+
+bool W25Q128StorageBackend::reserveRecord(uint32_t size, uint32_t* address) {
+    if (active_sector == NOT_FOUND || write_offset + size > W25Q128_SECTOR_SIZE) {
+        if (!openSector()) {
+            return false;
+        }
+    }
+    
+    // Taken whether or not the program succeeds: a failed one may have left
+    // part of a record behind, so the space is never reused
+    *address = active_sector * W25Q128_SECTOR_SIZE + write_offset;
+    write_offset += size;
+    return true;
+}
+
+bool W25Q128StorageBackend::finishRecord(uint32_t address, uint32_t size, bool programmed, RecordLocation* location) {
+    uint32_t sector = address / W25Q128_SECTOR_SIZE;
+    if (!programmed) {
+        sector_dead_bytes[sector] += size;
+        strcpy(last_error, "Failed to write storage entry");
+        error_count++;
+        return false;
+    }
+    
+    sector_live_bytes[sector] += size;
+    records_written++;
+    location->address = address;
+    location->size = size;
+    return true;
+}
+
+void W25Q128StorageBackend::buildRecordHeader(LogRecordHeader* header, uint32_t storage_key,
+                                              const StorageSegment* segments, uint8_t count) {
+    header->magic = W25Q128_LOG_RECORD_MAGIC;
+    header->state = LOG_RECORD_VALID;
+    header->reserved = 0xFF;
+    header->storage_key = storage_key;
+    header->data_size = 0;
+    header->padding = 0xFFFF;
+    for (uint8_t i = 0; i < count; i++) {
+        header->data_size += segments[i].size;
+    }
+    
+    uint32_t checksum = calculateChecksum((const uint8_t*)header + RECORD_CHECKED_OFFSET,
+                                          sizeof(LogRecordHeader) - RECORD_CHECKED_OFFSET);
+    for (uint8_t i = 0; i < count; i++) {
+        checksum = calculateChecksum(segments[i].data, segments[i].size, checksum);
+    }
+    header->checksum = checksum;
+}
+
+bool W25Q128StorageBackend::appendRecord(uint32_t storage_key, const StorageSegment* segments, uint8_t count,
+                                         RecordLocation* location) {
+    LogRecordHeader header;
+    buildRecordHeader(&header, storage_key, segments, count);
+    
+    uint32_t size = recordSize(header.data_size);
+    uint32_t address;
+    if (!reserveRecord(size, &address)) {
+        return false;
+    }
+    
+    // Header, then each segment after it
+    bool success = programBytes(address, (const uint8_t*)&header, sizeof(header));
+    uint32_t offset = address + sizeof(header);
+    for (uint8_t i = 0; success && i < count; i++) {
+        success = programBytes(offset, (const uint8_t*)segments[i].data, segments[i].size);
+        offset += segments[i].size;
+    }
+    return finishRecord(address, size, success, location);
+}
+
+void W25Q128StorageBackend::indexRecord(uint32_t storage_key, const RecordLocation& location) {
+    // Look the old copy up after appending - garbage collection may have moved it
+    IndexSlot* slot = findRecord(storage_key);
+    if (slot) {
+        supersedeRecord(slot->location);
+    } else {
+        slot = insertRecord(storage_key);
+    }
+    slot->location = location;
+}
+
+bool W25Q128StorageBackend::checkRecord(const uint8_t* record, uint32_t storage_key, size_t dataSize) {
+    LogRecordHeader header;
+    memcpy(&header, record, sizeof(header));
+    if (header.magic != W25Q128_LOG_RECORD_MAGIC || header.state != LOG_RECORD_VALID ||
+        header.storage_key != storage_key) {
+        strcpy(last_error, "Invalid storage entry");
+        error_count++;
+        return false;
+    }
+    
+    if (header.data_size != dataSize) {
+        strcpy(last_error, "Data size mismatch");
+        error_count++;
+        return false;
+    }
+    
+    // Header tail and data are contiguous here, so one pass covers both
+    if (calculateChecksum(record + RECORD_CHECKED_OFFSET,
+                          sizeof(LogRecordHeader) - RECORD_CHECKED_OFFSET + dataSize) != header.checksum) {
+        strcpy(last_error, "Checksum verification failed");
+        error_count++;
+        return false;
+    }
+    return true;
+}
+
+uint8_t W25Q128StorageBackend::commitStaged(StagedRecords& staged, StorageItem* items) {
+    if (staged.count == 0) {
+        return 0;
+    }
+    
+    // One program per page touched, for all the staged records
+    bool programmed = programBytes(staged.address, staged.page, staged.fill);
+    uint8_t done = 0;
+    uint32_t address = staged.address;
+    for (uint8_t k = 0; k < staged.count; k++) {
+        StorageItem& item = items[staged.items[k]];
+        uint32_t size = recordSize(item.size);
+        RecordLocation location;
+        if (finishRecord(address, size, programmed, &location)) {
+            indexRecord(item.storage_key, location);
+            item.ok = true;
+            done++;
+        }
+        address += size;
+    }
+    staged.fill = 0;
+    staged.count = 0;
+    return done;
+}
+
+bool W25Q128StorageBackend::relocateRecord(const RecordLocation& from, RecordLocation* to) {
+    uint32_t address;
+    if (!reserveRecord(from.size, &address)) {
+        return false;
+    }
+    
+    // Byte for byte: the checksum does not cover the address
+    uint8_t buffer[W25Q128_PAGE_SIZE];
+    bool success = true;
+    for (uint32_t done = 0; success && done < from.size; done += sizeof(buffer)) {
+        uint32_t chunk = std::min<uint32_t>(sizeof(buffer), from.size - done);
+        success = readPage(from.address + done, buffer, chunk) && programBytes(address + done, buffer, chunk);
+    }
+    return finishRecord(address, from.size, success, to);
+}
+
+void W25Q128StorageBackend::supersedeRecord(const RecordLocation& location) {
+    // Clearing bits needs no erase
+    uint8_t state = LOG_RECORD_SUPERSEDED;
+    programBytes(location.address + offsetof(LogRecordHeader, state), &state, 1);
+    retireRecord(location);
+}
+
+void W25Q128StorageBackend::retireRecord(const RecordLocation& location) {
+    uint32_t sector = location.address / W25Q128_SECTOR_SIZE;
+    sector_live_bytes[sector] -= location.size;
+    sector_dead_bytes[sector] += location.size;
+}
+
+bool W25Q128StorageBackend::openSector() {
+    // Keep the reserve free for garbage collection to copy into
+    for (uint8_t attempt = 0; attempt < 2 * W25Q128_GC_RESERVE_SECTORS && !collecting &&
+         (W25Q128_LOG_SECTORS - used_sectors) <= W25Q128_GC_RESERVE_SECTORS; attempt++) {
+        uint32_t victim = findGarbageSector();
+        if (victim == NOT_FOUND || !reclaimSector(victim)) {
+            break;
+        }
+    }
+    
+    uint32_t free_sectors = W25Q128_LOG_SECTORS - used_sectors;
+    if (free_sectors == 0 || (!collecting && free_sectors <= W25Q128_GC_RESERVE_SECTORS)) {
+        strcpy(last_error, "No free sectors available");
+        error_count++;
+        return false;
+    }
+    
+    // A sector opened just before a power loss is free in a replayed index
+    // but not erased
+    uint32_t sector = findFreeSector();
+    if (!sectorHeaderErased(sector) && !eraseSector(sector * W25Q128_SECTOR_SIZE)) {
+        strcpy(last_error, "Sector erase failed");
+        error_count++;
+        return false;
+    }
+    
+    LogSectorHeader header;
+    memset(&header, 0xFF, sizeof(header));
+    header.magic = W25Q128_LOG_SECTOR_MAGIC;
+    header.sequence = next_sequence;
+    if (!programBytes(sector * W25Q128_SECTOR_SIZE, (const uint8_t*)&header, sizeof(header))) {
+        strcpy(last_error, "Failed to open log sector");
+        error_count++;
+        return false;
+    }
+    
+    if (active_sector != NOT_FOUND) {
+        // Link only once the new header is on flash, so a replay never
+        // follows a link into an erased sector
+        uint32_t link = sector;
+        programBytes(active_sector * W25Q128_SECTOR_SIZE + offsetof(LogSectorHeader, next_sector),
+                     (const uint8_t*)&link, sizeof(link));
+        
+        // The unused tail of the old head can only be reclaimed by an erase
+        sector_dead_bytes[active_sector] += W25Q128_SECTOR_SIZE - write_offset;
+    }
+    
+    next_sequence++;
+    sector_allocated[sector] = true;
+    sector_live_bytes[sector] = 0;
+    sector_dead_bytes[sector] = 0;
+    sector_uncheckpointed[sector] = true;
+    sectors_since_checkpoint++;
+    used_sectors++;
+    active_sector = sector;
+    write_offset = sizeof(LogSectorHeader);
+    return true;
+}
+
+bool W25Q128StorageBackend::reclaimSector(uint32_t sector) {
+    if (sector == active_sector || !sector_allocated[sector]) {
+        return false;
+    }
+    
+    // Records newer than the checkpoint must be covered before they go
+    if (sector_uncheckpointed[sector] && !writeCheckpoint()) {
+        return false;
+    }
+    
+    // Copy live records to the head, then erase
+    collecting = true;
+    uint32_t base = sector * W25Q128_SECTOR_SIZE;
+    uint32_t offset = sizeof(LogSectorHeader);
+    bool success = true;
+    
+    while (success && sector_live_bytes[sector] > 0 &&
+           offset + sizeof(LogRecordHeader) <= W25Q128_SECTOR_SIZE) {
+        LogRecordHeader header;
+        if (!readPage(base + offset, (uint8_t*)&header, sizeof(header)) ||
+            header.magic != W25Q128_LOG_RECORD_MAGIC || header.data_size > MAX_DATA_SIZE) {
+            break;
+        }
+        uint32_t size = recordSize(header.data_size);
+        
+        IndexSlot* slot = findRecord(header.storage_key);
+        if (slot && slot->location.address == base + offset) {
+            RecordLocation location;
+            success = relocateRecord(slot->location, &location);
+            if (success) {
+                slot->location = location;
+                sector_live_bytes[sector] -= size;
+            }
+        }
+        offset += size;
+    }
+    collecting = false;
+    
+    if (!success || sector_live_bytes[sector] > 0) {
+        strcpy(last_error, "Garbage collection failed");
+        error_count++;
+        return false;
+    }
+    
+    if (!eraseSector(base)) {
+        strcpy(last_error, "Sector erase failed");
+        error_count++;
+        return false;
+    }
+    
     sector_allocated[sector] = false;
-    key_to_sector.erase(storage_key);
+    sector_dead_bytes[sector] = 0;
+    sector_uncheckpointed[sector] = false;
     used_sectors--;
+    return true;
+}
+
+uint32_t W25Q128StorageBackend::findGarbageSector() {
+    // Greedy: the closed sector with the most dead bytes, if reclaiming it
+    // gains more than a record's worth of space. Sectors the checkpoint
+    // covers come first - the others cost a checkpoint to reclaim.
+    uint32_t best[2] = {NOT_FOUND, NOT_FOUND};
+    uint32_t best_dead[2] = {W25Q128_PAGE_SIZE, W25Q128_PAGE_SIZE};
+    for (uint32_t sector = 0; sector < W25Q128_LOG_SECTORS; sector++) {
+        uint8_t kind = sector_uncheckpointed[sector] ? 1 : 0;
+        if (sector_allocated[sector] && sector != active_sector && sector_dead_bytes[sector] > best_dead[kind]) {
+            best[kind] = sector;
+            best_dead[kind] = sector_dead_bytes[sector];
+        }
+    }
+    return (best[0] != NOT_FOUND) ? best[0] : best[1];
+}
+
+uint32_t W25Q128StorageBackend::scanSector(uint32_t sector, uint32_t offset) {
+    uint32_t base = sector * W25Q128_SECTOR_SIZE;
+    boot_scanned_sectors++;
     
+    while (offset + sizeof(LogRecordHeader) <= W25Q128_SECTOR_SIZE) {
+        LogRecordHeader header;
+        if (!readPage(base + offset, (uint8_t*)&header, sizeof(header)) || header.magic == 0xFFFF) {
+            break;  // End of the log in this sector
+        }
+        
+        uint32_t size = recordSize(header.data_size);
+        bool intact = header.magic == W25Q128_LOG_RECORD_MAGIC && header.data_size <= MAX_DATA_SIZE &&
+                      offset + size <= W25Q128_SECTOR_SIZE && verifyRecord(base + offset, header);
+        if (!intact) {
+            // Torn or corrupt: nothing after it can be trusted or appended to
+            sector_dead_bytes[sector] += W25Q128_SECTOR_SIZE - offset;
+            return W25Q128_SECTOR_SIZE;
+        }
+        
+        RecordLocation location = {base + offset, (uint16_t)size};
+        sector_live_bytes[sector] += size;
+        if (header.state == LOG_RECORD_VALID) {
+            // A later record of a key replaces the earlier one, even if power
+            // was lost before the earlier one was superseded
+            IndexSlot* slot = findRecord(header.storage_key);
+            if (slot) {
+                retireRecord(slot->location);
+                eraseRecord(slot);
+            }
+            slot = (header.data_size > 0) ? insertRecord(header.storage_key) : nullptr;
+            if (slot) {
+                slot->location = location;
+            } else {
+                // Tombstone, or no room left in the index
+                retireRecord(location);
+                if (header.data_size > 0) {
+                    strcpy(last_error, "Index full");
+                    error_count++;
+                }
+            }
+        } else {
+            retireRecord(location);
+        }
+        offset += size;
+    }
+    return offset;
+}
+
+bool W25Q128StorageBackend::verifyRecord(uint32_t address, const LogRecordHeader& header) {
+    // Page by page, so a record of any size needs no buffer of its size
+    uint32_t checksum = calculateChecksum((const uint8_t*)&header + RECORD_CHECKED_OFFSET,
+                                          sizeof(LogRecordHeader) - RECORD_CHECKED_OFFSET);
+    uint8_t buffer[W25Q128_PAGE_SIZE];
+    uint32_t data_size = header.data_size;
+    for (uint32_t done = 0; done < data_size; done += sizeof(buffer)) {
+        uint32_t chunk = std::min<uint32_t>(sizeof(buffer), data_size - done);
+        if (!readPage(address + sizeof(LogRecordHeader) + done, buffer, chunk)) {
+            return false;
+        }
+        checksum = calculateChecksum(buffer, chunk, checksum);
+    }
+    return checksum == header.checksum;
+}
+
+bool W25Q128StorageBackend::sectorHeaderErased(uint32_t sector) {
+    LogSectorHeader header;
+    if (!readPage(sector * W25Q128_SECTOR_SIZE, (uint8_t*)&header, sizeof(header))) {
+        return false;
+    }
+    const uint8_t* bytes = (const uint8_t*)&header;
+    for (size_t i = 0; i < sizeof(header); i++) {
+        if (bytes[i] != 0xFF) {
+            return false;
+        }
+    }
     return true;
 }
 
+// =============================================================================
+// Index Checkpoint Methods
+// =============================================================================
+
+size_t W25Q128StorageBackend::checkpointPayloadSize(uint32_t sector_count, uint32_t entry_count) {
+    // Allocation bitmap, live/dead bytes of each allocated sector, then the index
+    return (W25Q128_LOG_SECTORS + 7) / 8 + sector_count * 2 * sizeof(uint16_t) +
+           entry_count * sizeof(IndexCheckpointEntry);
+}
+
+bool W25Q128StorageBackend::writeCheckpoint() {
+    if (!flash_initialized || active_sector == NOT_FOUND) {
+        return false;
+    }
+    
+    IndexCheckpointHeader header;
+    header.magic = W25Q128_CHECKPOINT_MAGIC;
+    header.generation = checkpoint_generation + 1;
+    header.entry_count = index_count;
+    header.sector_count = used_sectors;
+    header.head_sector = active_sector;
+    header.head_offset = write_offset;
+    header.head_sequence = next_sequence - 1;
+    
+    size_t payload_size = checkpointPayloadSize(header.sector_count, header.entry_count);
+    uint32_t sectors = (sizeof(header) + payload_size + W25Q128_SECTOR_SIZE - 1) / W25Q128_SECTOR_SIZE;
+    if (sectors > W25Q128_CHECKPOINT_SLOT_SECTORS) {
+        strcpy(last_error, "Index too large to checkpoint");
+        error_count++;
+        return false;
+    }
+    
+    // Alternate slots so the previous checkpoint survives a torn write;
+    // the header goes last and makes the new one valid
+    uint32_t slot = header.generation % 2;
+    uint32_t base = (W25Q128_LOG_SECTORS + slot * W25Q128_CHECKPOINT_SLOT_SECTORS) * W25Q128_SECTOR_SIZE;
+    for (uint32_t i = 0; i < sectors; i++) {
+        if (!eraseSector(base + i * W25Q128_SECTOR_SIZE)) {
+            strcpy(last_error, "Checkpoint erase failed");
+            error_count++;
+            return false;
+        }
+    }
+    
+    // Stream the payload to flash, checksumming it on the way
+    PayloadStream stream;
+    stream.address = base + sizeof(header);
+    stream.fill = 0;
+    stream.crc = 0;
+    stream.ok = true;
+    for (uint32_t sector = 0; sector < W25Q128_LOG_SECTORS; sector += 8) {
+        uint8_t bits = 0;
+        for (uint32_t bit = 0; bit < 8 && sector + bit < W25Q128_LOG_SECTORS; bit++) {
+            bits |= sector_allocated[sector + bit] ? (1 << bit) : 0;
+        }
+        streamWrite(stream, &bits, 1);
+    }
+    for (uint32_t sector = 0; sector < W25Q128_LOG_SECTORS; sector++) {
+        if (sector_allocated[sector]) {
+            uint16_t bytes[2] = {sector_live_bytes[sector], sector_dead_bytes[sector]};
+            streamWrite(stream, bytes, sizeof(bytes));
+        }
+    }
+    for (uint32_t i = 0; i < W25Q128_INDEX_SLOTS; i++) {
+        const IndexSlot& record = index_slots[i];
+        if (record.storage_key != W25Q128_EMPTY_KEY) {
+            IndexCheckpointEntry entry = {record.storage_key, record.location.address, record.location.size};
+            streamWrite(stream, &entry, sizeof(entry));
+        }
+    }
+    header.payload_checksum = stream.crc;
+    header.header_checksum = calculateChecksum(&header, offsetof(IndexCheckpointHeader, header_checksum));
+    
+    if (!streamFlush(stream) || !programBytes(base, (const uint8_t*)&header, sizeof(header))) {
+        strcpy(last_error, "Checkpoint write failed");
+        error_count++;
+        return false;
+    }
+    
+    checkpoint_generation = header.generation;
+    checkpoint_sectors = sectors;
+    checkpoints_written++;
+    sectors_since_checkpoint = 0;
+    sector_uncheckpointed.assign(W25Q128_LOG_SECTORS, false);
+    sector_uncheckpointed[active_sector] = true;     // Appends continue here
+    return true;
+}
+
+bool W25Q128StorageBackend::loadCheckpoint(IndexCheckpointHeader* header) {
+    // Newest valid slot
+    uint32_t best_slot = NOT_FOUND;
+    for (uint32_t slot = 0; slot < 2; slot++) {
+        IndexCheckpointHeader candidate;
+        uint32_t base = (W25Q128_LOG_SECTORS + slot * W25Q128_CHECKPOINT_SLOT_SECTORS) * W25Q128_SECTOR_SIZE;
+        if (!readPage(base, (uint8_t*)&candidate, sizeof(candidate)) ||
+            candidate.magic != W25Q128_CHECKPOINT_MAGIC ||
+            candidate.header_checksum != calculateChecksum(&candidate, offsetof(IndexCheckpointHeader, header_checksum))) {
+            continue;
+        }
+        if (best_slot == NOT_FOUND || candidate.generation > header->generation) {
+            *header = candidate;
+            best_slot = slot;
+        }
+    }
+    if (best_slot == NOT_FOUND || header->head_sector >= W25Q128_LOG_SECTORS ||
+        header->head_offset > W25Q128_SECTOR_SIZE) {
+        return false;
+    }
+    
+    size_t payload_size = checkpointPayloadSize(header->sector_count, header->entry_count);
+    uint32_t sectors = (sizeof(IndexCheckpointHeader) + payload_size + W25Q128_SECTOR_SIZE - 1) / W25Q128_SECTOR_SIZE;
+    if (sectors > W25Q128_CHECKPOINT_SLOT_SECTORS) {
+        return false;
+    }
+    if (header->entry_count > W25Q128_INDEX_CAPACITY) {
+        return false;
+    }
+    
+    // Two page-buffered passes: verify the checksum, then load, so the
+    // index is only touched once the whole payload is known good
+    uint32_t base = (W25Q128_LOG_SECTORS + best_slot * W25Q128_CHECKPOINT_SLOT_SECTORS) * W25Q128_SECTOR_SIZE;
+    PayloadStream stream = {};
+    stream.address = base + sizeof(IndexCheckpointHeader);
+    stream.end = stream.address + payload_size;
+    stream.ok = true;
+    uint8_t chunk[W25Q128_PAGE_SIZE];
+    for (size_t done = 0; done < payload_size; done += sizeof(chunk)) {
+        streamRead(stream, chunk, std::min(sizeof(chunk), payload_size - done));
+    }
+    if (!stream.ok || stream.crc != header->payload_checksum) {
+        return false;
+    }
+    
+    stream = {};
+    stream.address = base + sizeof(IndexCheckpointHeader);
+    stream.end = stream.address + payload_size;
+    stream.ok = true;
+    for (uint32_t sector = 0; sector < W25Q128_LOG_SECTORS; sector += 8) {
+        uint8_t bits;
+        streamRead(stream, &bits, 1);
+        for (uint32_t bit = 0; bit < 8 && sector + bit < W25Q128_LOG_SECTORS; bit++) {
+            sector_allocated[sector + bit] = bits & (1 << bit);
+        }
+    }
+    for (uint32_t sector = 0; sector < W25Q128_LOG_SECTORS && used_sectors < header->sector_count; sector++) {
+        if (sector_allocated[sector]) {
+            uint16_t bytes[2];
+            streamRead(stream, bytes, sizeof(bytes));
+            sector_live_bytes[sector] = bytes[0];
+            sector_dead_bytes[sector] = bytes[1];
+            used_sectors++;
+        }
+    }
+    for (uint32_t i = 0; i < header->entry_count; i++) {
+        IndexCheckpointEntry entry;
+        streamRead(stream, &entry, sizeof(entry));
+        insertRecord(entry.storage_key)->location = {entry.address, entry.size};
+    }
+    if (!stream.ok) {
+        resetIndex();
+        return false;
+    }
+    
+    checkpoint_generation = header->generation;
+    checkpoint_sectors = sectors;
+    return true;
+}
+
+bool W25Q128StorageBackend::replayLog(const IndexCheckpointHeader& header) {
+    // Records appended after the checkpoint: the rest of its head sector,
+    // then every sector linked on from it
+    uint32_t sector = header.head_sector;
+    uint32_t offset = header.head_offset;
+    uint32_t sequence = header.head_sequence;
+    
+    while (true) {
+        sector_uncheckpointed[sector] = true;
+        uint32_t end = scanSector(sector, offset);
+        
+        LogSectorHeader sector_header;
+        if (!readPage(sector * W25Q128_SECTOR_SIZE, (uint8_t*)&sector_header, sizeof(sector_header)) ||
+            sector_header.magic != W25Q128_LOG_SECTOR_MAGIC || sector_header.sequence != sequence) {
+            return false;
+        }
+        
+        uint32_t next = sector_header.next_sector;
+        if (next == 0xFFFFFFFF) {
+            // Reached the head
+            active_sector = sector;
+            write_offset = end;
+            next_sequence = sequence + 1;
+            return true;
+        }
+        
+        LogSectorHeader next_header;
+        if (next >= W25Q128_LOG_SECTORS ||
+            !readPage(next * W25Q128_SECTOR_SIZE, (uint8_t*)&next_header, sizeof(next_header)) ||
+            next_header.magic != W25Q128_LOG_SECTOR_MAGIC || next_header.sequence != sequence + 1) {
+            return false;
+        }
+        
+        // The closed sector's tail is dead; the next one was opened after
+        // the checkpoint, possibly over a sector reclaimed since
+        sector_dead_bytes[sector] += W25Q128_SECTOR_SIZE - end;
+        if (!sector_allocated[next]) {
+            sector_allocated[next] = true;
+            used_sectors++;
+        }
+        sector_live_bytes[next] = 0;
+        sector_dead_bytes[next] = 0;
+        sectors_since_checkpoint++;
+        
+        sector = next;
+        offset = sizeof(LogSectorHeader);
+        sequence++;
+    }
+}
+
+void W25Q128StorageBackend::scanWholeLog() {
+    // Sector headers first, then records in the order the sectors were opened
+    std::vector<std::pair<uint32_t, uint32_t>> log_order;    // (sequence, sector)
+    for (uint32_t sector = 0; sector < W25Q128_LOG_SECTORS; sector++) {
+        LogSectorHeader header;
+        if (!readPage(sector * W25Q128_SECTOR_SIZE, (uint8_t*)&header, sizeof(header))) {
+            continue;
+        }
+        if (header.magic == W25Q128_LOG_SECTOR_MAGIC) {
+            uint32_t sequence = header.sequence;
+            log_order.push_back(std::make_pair(sequence, sector));
+            sector_allocated[sector] = true;
+            sector_uncheckpointed[sector] = true;
+            used_sectors++;
+        } else if (header.magic != 0xFFFFFFFF || header.sequence != 0xFFFFFFFF) {
+            // Interrupted erase or foreign data
+            eraseSector(sector * W25Q128_SECTOR_SIZE);
+        }
+    }
+    std::sort(log_order.begin(), log_order.end());
+    
+    for (size_t i = 0; i < log_order.size(); i++) {
+        uint32_t sector = log_order[i].second;
+        uint32_t end = scanSector(sector, sizeof(LogSectorHeader));
+        if (i + 1 < log_order.size()) {
+            sector_dead_bytes[sector] += W25Q128_SECTOR_SIZE - end;
+        } else {
+            active_sector = sector;
+            write_offset = end;
+            next_sequence = log_order[i].first + 1;
+        }
+    }
+    
+    // Nothing is covered by a checkpoint yet
+    sectors_since_checkpoint = used_sectors;
+}
+
+void W25Q128StorageBackend::resetIndex() {
+    clearRecords();
+    sector_allocated.assign(W25Q128_LOG_SECTORS, false);
+    sector_live_bytes.assign(W25Q128_LOG_SECTORS, 0);
+    sector_dead_bytes.assign(W25Q128_LOG_SECTORS, 0);
+    sector_uncheckpointed.assign(W25Q128_LOG_SECTORS, false);
+    used_sectors = 0;
+    active_sector = NOT_FOUND;
+    write_offset = 0;
+    next_sequence = 0;
+    sectors_since_checkpoint = 0;
+    checkpoint_generation = 0;
+    checkpoint_sectors = 0;
+}
+
+// =============================================================================
+// Fixed Pools
+// =============================================================================
+
+static inline uint32_t index_home_slot(uint32_t storage_key) {
+    uint32_t h = storage_key;
+    h ^= h >> 16;
+    h *= 0x45D9F3B;
+    h ^= h >> 16;
+    return h & (W25Q128_INDEX_SLOTS - 1);
+}
+
+bool W25Q128StorageBackend::allocatePools() {
+    // Once, for the life of the object
+    if (!index_slots) {
+        index_slots = new (std::nothrow) IndexSlot[W25Q128_INDEX_SLOTS];
+        if (!index_slots) {
+            return false;
+        }
+        clearRecords();
+    }
+    if (!write_cache) {
+        write_cache = new (std::nothrow) CacheEntry[W25Q128_CACHE_ENTRIES];
+        cache_count = 0;
+    }
+    return write_cache != nullptr;
+}
+
+W25Q128StorageBackend::IndexSlot* W25Q128StorageBackend::findRecord(uint32_t storage_key) {
+    if (!index_slots) {
+        return nullptr;
+    }
+    uint32_t slot = index_home_slot(storage_key);
+    while (index_slots[slot].storage_key != W25Q128_EMPTY_KEY) {
+        if (index_slots[slot].storage_key == storage_key) {
+            return &index_slots[slot];
+        }
+        slot = (slot + 1) & (W25Q128_INDEX_SLOTS - 1);
+    }
+    return nullptr;
+}
+
+W25Q128StorageBackend::IndexSlot* W25Q128StorageBackend::insertRecord(uint32_t storage_key) {
+    IndexSlot* existing = findRecord(storage_key);
+    if (existing || index_count >= W25Q128_INDEX_CAPACITY) {
+        return existing;
+    }
+    
+    // Never more than half full, so a free slot ends every probe
+    uint32_t slot = index_home_slot(storage_key);
+    while (index_slots[slot].storage_key != W25Q128_EMPTY_KEY) {
+        slot = (slot + 1) & (W25Q128_INDEX_SLOTS - 1);
+    }
+    index_slots[slot].storage_key = storage_key;
+    index_count++;
+    if (index_count > index_high_water) {
+        index_high_water = index_count;
+    }
+    return &index_slots[slot];
+}
+
+void W25Q128StorageBackend::eraseRecord(IndexSlot* record) {
+    const uint32_t mask = W25Q128_INDEX_SLOTS - 1;
+    uint32_t gap = record - index_slots;
+    index_slots[gap].storage_key = W25Q128_EMPTY_KEY;
+    index_count--;
+    
+    // Backward shift: pull later members of the probe run into the gap
+    // when the gap lies between their home and where they sit
+    uint32_t next = (gap + 1) & mask;
+    while (index_slots[next].storage_key != W25Q128_EMPTY_KEY) {
+        uint32_t home = index_home_slot(index_slots[next].storage_key);
+        if (((next - home) & mask) >= ((next - gap) & mask)) {
+            index_slots[gap] = index_slots[next];
+            index_slots[next].storage_key = W25Q128_EMPTY_KEY;
+            gap = next;
+        }
+        next = (next + 1) & mask;
+    }
+}
+
+void W25Q128StorageBackend::clearRecords() {
+    if (index_slots) {
+        for (uint32_t slot = 0; slot < W25Q128_INDEX_SLOTS; slot++) {
+            index_slots[slot].storage_key = W25Q128_EMPTY_KEY;
+        }
+    }
+    index_count = 0;
+}
+
+W25Q128StorageBackend::CacheEntry* W25Q128StorageBackend::findCacheEntry(uint32_t storage_key) {
+    for (uint16_t i = 0; i < cache_count; i++) {
+        if (write_cache[i].storage_key == storage_key) {
+            return &write_cache[i];
+        }
+    }
+    return nullptr;
+}
+
+void W25Q128StorageBackend::removeCacheEntry(uint32_t storage_key) {
+    // The last entry fills the hole, keeping the used ones together
+    CacheEntry* entry = findCacheEntry(storage_key);
+    if (entry) {
+        *entry = write_cache[--cache_count];
+    }
+}
+
+uint32_t W25Q128StorageBackend::getIndexCapacity() {
+    return W25Q128_INDEX_CAPACITY;
+}
+
+uint32_t W25Q128StorageBackend::getIndexCount() {
+    return index_count;
+}
+
+uint32_t W25Q128StorageBackend::getIndexHighWater() {
+    return index_high_water;
+}
+
+uint32_t W25Q128StorageBackend::getCacheCapacity() {
+    return W25Q128_CACHE_ENTRIES;
+}
+
+uint32_t W25Q128StorageBackend::getCacheHighWater() {
+    return cache_high_water;
+}
+
+void W25Q128StorageBackend::streamWrite(PayloadStream& stream, const void* data, size_t length) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    stream.crc = calculateChecksum(bytes, length, stream.crc);
+    while (length > 0) {
+        size_t chunk = std::min(sizeof(stream.page) - stream.fill, length);
+        memcpy(&stream.page[stream.fill], bytes, chunk);
+        stream.fill += chunk;
+        bytes += chunk;
+        length -= chunk;
+        if (stream.fill == sizeof(stream.page)) {
+            streamFlush(stream);
+        }
+    }
+}
+
+bool W25Q128StorageBackend::streamFlush(PayloadStream& stream) {
+    if (stream.fill > 0) {
+        stream.ok = programBytes(stream.address, stream.page, stream.fill) && stream.ok;
+        stream.address += stream.fill;
+        stream.fill = 0;
+    }
+    return stream.ok;
+}
+
+bool W25Q128StorageBackend::streamRead(PayloadStream& stream, void* data, size_t length) {
+    uint8_t* bytes = (uint8_t*)data;
+    while (length > 0 && stream.ok) {
+        if (stream.pos == stream.fill) {
+            // Refill, checksumming each page as it arrives
+            size_t chunk = std::min<size_t>(sizeof(stream.page), stream.end - stream.address);
+            stream.ok = chunk > 0 && readPage(stream.address, stream.page, chunk);
+            stream.crc = calculateChecksum(stream.page, chunk, stream.crc);
+            stream.address += chunk;
+            stream.fill = chunk;
+            stream.pos = 0;
+            continue;
+        }
+        size_t chunk = std::min(stream.fill - stream.pos, length);
+        memcpy(bytes, &stream.page[stream.pos], chunk);
+        stream.pos += chunk;
+        bytes += chunk;
+        length -= chunk;
+    }
+    return stream.ok;
+}
+
 // =============================================================================
 // Utility Methods
 // =============================================================================
 
-uint32_t W25Q128StorageBackend::calculateChecksum(const void* data, size_t length) {
-    // Simple CRC32 implementation
-    uint32_t crc = 0xFFFFFFFF;
+uint32_t W25Q128StorageBackend::calculateChecksum(const void* data, size_t length, uint32_t crc) {
+    // Simple CRC32 implementation, continuing from a previous result
+    crc = ~crc;
     const uint8_t* bytes = (const uint8_t*)data;
     
     for (size_t i = 0; i < length; i++) {
@@ -732,41 +2212,37 @@ uint32_t W25Q128StorageBackend::calculateChecksum(const void* data, size_t lengt
     return ~crc;
 }
 
+uint32_t W25Q128StorageBackend::recordSize(size_t dataSize) {
+    return (sizeof(LogRecordHeader) + dataSize + 3) & ~3u;
+}
+
 uint32_t W25Q128StorageBackend::findFreeSector() {
-    for (uint32_t sector = 0; sector < total_sectors; sector++) {
+    // Round-robin from the head spreads erases across the chip
+    uint32_t start = (active_sector == NOT_FOUND) ? 0 : active_sector + 1;
+    for (uint32_t i = 0; i < W25Q128_LOG_SECTORS; i++) {
+        uint32_t sector = (start + i) % W25Q128_LOG_SECTORS;
         if (!sector_allocated[sector]) {
             return sector;
         }
     }
-    return 0xFFFFFFFF; // No free sectors
-}
-
-void W25Q128StorageBackend::updateSectorMap() {
-    // This would scan flash to rebuild sector allocation map
-    // For now, we'll rely on the tracking we maintain
+    return NOT_FOUND; // No free sectors
 }
 
 void W25Q128StorageBackend::rebuildIndex() {
-    key_to_sector.clear();
+    resetIndex();
+    boot_scanned_sectors = 0;
     
-#ifdef TESTING
-    // In test environment, just use the existing mapping
-    // Don't scan all sectors as it's too slow with mock SPI
-    return;
-#else
-    // Scan all allocated sectors to rebuild key mapping
-    for (uint32_t sector = 0; sector < total_sectors; sector++) {
-        if (!sector_allocated[sector]) continue;
-        
-        uint8_t buffer[W25Q128_PAGE_SIZE];
-        uint32_t page_address = sector * W25Q128_SECTORS_PER_BLOCK;
-        
-        if (readPage(page_address, buffer, W25Q128_PAGE_SIZE)) {
-            StorageEntry* entry = (StorageEntry*)buffer;
-            if (entry->magic == STORAGE_MAGIC) {
-                key_to_sector[entry->storage_key] = page_address;
-            }
+    // Fast path: newest checkpoint plus the log written after it
+    IndexCheckpointHeader header;
+    if (loadCheckpoint(&header)) {
+        if (replayLog(header)) {
+            return;
         }
+        strcpy(last_error, "Checkpoint replay failed - scanning log");
+        error_count++;
+        resetIndex();
+        checkpoint_generation = header.generation;  // Keep alternating slots
     }
-#endif
-} 
\ No newline at end of file
+    
+    scanWholeLog();
+}
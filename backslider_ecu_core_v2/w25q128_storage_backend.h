@@ -7,7 +7,6 @@
 
 #include <stdint.h>
 #include <vector>
-#include <unordered_map>
 
 #include "storage_backend.h"
 #include "ecu_config.h"
@@ -51,16 +50,191 @@
 #define W25Q128_CMD_READ_ID          0x90
 #define W25Q128_CMD_READ_JEDEC_ID    0x9F
 
+#define W25Q128_STATUS_BUSY          0x01                 // WIP in status register 1
+
+// =============================================================================
+// Memory-Mapped Reads
+// =============================================================================
+/* With qspi_flash.memory_mapped set, the chip sits on the FlexSPI2 pads
+ * (see flexspi_flash.h) instead of the LPSPI bus. Commands - status,
+ * program, erase, suspend - go out as FlexSPI IP commands, and every read
+ * is a memcpy from the mapped window instead of a READ_DATA command
+ * clocked out byte by byte. The queue rules above still apply: a read
+ * completes overlapping operations and suspends a running erase, and a
+ * completed program or erase invalidates its range of the window.
+ *
+ * mapData() goes one step further for read-only consumers: it verifies a
+ * record in place and hands back a pointer into the window. The pointer
+ * stays good until the next call into the backend - any call may start
+ * an erase or move the record - so copy out or finish with it first.
+ */
+
 // =============================================================================
-// Storage Entry Structure (Optimized for W25Q128)
+// Asynchronous Operations
 // =============================================================================
-struct __attribute__((packed)) StorageEntry {
-    uint32_t magic;           // Magic number for validation (0x57463132 = "WF12")
+/* A page program takes ~0.7 ms and a sector erase 45-400 ms, during which
+ * the chip only answers status reads. Rather than spinning on WIP, programs
+ * and erases go into a FIFO of W25Q128_OP_QUEUE_SIZE operations:
+ *
+ *   submit   queue the operation (program data is copied); an idle chip
+ *            starts it at once
+ *   poll     if the running operation has finished, complete it (callback
+ *            with its result) and issue the next - never waits
+ *
+ * poll() runs from StorageManager::update(), so an erase started by
+ * garbage collection finishes over later loop passes while control work
+ * carries on. The log's RAM index is updated at submit time; the queue
+ * keeps the flash catching up in program order, which preserves every
+ * "A is on flash before B" rule in the log layout.
+ *
+ * Reads never see stale data: a read first completes any queued operation
+ * that overlaps it (blocking, but only on a real conflict). A read elsewhere
+ * while an erase is running suspends the erase (ERASE_SUSPEND), reads, and
+ * resumes it. A running program is short enough to just wait out. Submitting
+ * to a full queue waits for the oldest operation.
+ *
+ * Transfers stay programmed I/O: a command plus at most one page is ~70 µs
+ * at 30 MHz; the time worth getting back is the busy wait, not the bytes.
+ *
+ * Desktop builds model busy time with the mock clock
+ * (W25Q128_PROGRAM_TIME_US, W25Q128_ERASE_TIME_US) and change the mock
+ * image when an operation completes.
+ */
+#define W25Q128_OP_QUEUE_SIZE        16
+#define W25Q128_OP_TIMEOUT_MS        10000                // Longest a chip may stay busy
+#define W25Q128_PROGRAM_TIME_US      700                  // Typical tPP
+#define W25Q128_ERASE_TIME_US        45000                // Typical tSE
+#define W25Q128_SPI_CLAIM_TIMEOUT_US 1000                 // Wait for a shift chain DMA to finish
+
+#define FLASH_OP_PROGRAM             0
+#define FLASH_OP_ERASE_SECTOR        1
+
+// Runs from whichever call completed the operation (usually poll())
+typedef void (*FlashOperationCallback)(void* context, uint32_t address, bool success);
+
+// =============================================================================
+// Log Layout
+// =============================================================================
+/* Values are appended as small records instead of owning a 4 KB sector each.
+ *
+ * Every sector in use starts with a LogSectorHeader whose sequence number
+ * gives the order sectors were opened in; records follow back to back,
+ * 4-byte aligned, and never span sectors. A record holds up to a sector
+ * less its headers, enough for a whole map table blob. The highest
+ * sequence is the write head.
+ *
+ * Rewriting a key appends a new record and then programs the old record's
+ * state byte from LOG_RECORD_VALID to LOG_RECORD_SUPERSEDED in place (NOR
+ * flash can clear bits without an erase). Deleting a key appends a
+ * zero-length tombstone record, then supersedes.
+ *
+ * When the head moves on, the old head's header is linked to the new one
+ * (next_sector), so the log after any point can be followed without
+ * reading every sector.
+ *
+ * Index checkpoints: the key -> record index and the accounting of each
+ * allocated sector are written periodically to one of two slots in the top
+ * W25Q128_CHECKPOINT_SECTORS of the chip, together with the head position
+ * at that moment. begin() loads the newest valid checkpoint in one
+ * sequential pass and replays only the records appended after it,
+ * following the sector links. Without a valid checkpoint (first boot,
+ * broken link) it falls back to walking every sector in sequence order.
+ * A record with a bad checksum (power lost mid-program) closes its
+ * sector; if power was lost between appending and superseding, the later
+ * copy of a key wins.
+ *
+ * A sector holding records newer than the last checkpoint is never erased
+ * without writing a checkpoint first, or replay could miss them. Garbage
+ * collection prefers sectors the checkpoint already covers.
+ *
+ * Garbage collection copies the live records of the sector with the most
+ * superseded bytes to the head and erases it. It runs on demand when free
+ * sectors fall to W25Q128_GC_RESERVE_SECTORS (the reserve is what it
+ * copies into), and incrementally from sync() once a sector is at least
+ * W25Q128_GC_DEAD_THRESHOLD dead - call sync() from the storage task.
+ * sync() also writes a checkpoint every W25Q128_CHECKPOINT_INTERVAL_SECTORS
+ * sectors of log, and end() writes one so a clean restart replays nothing.
+ * Sectors are opened round-robin, which spreads erases across the chip.
+ */
+#define W25Q128_LOG_SECTOR_MAGIC     0x574C4F47           // "WLOG"
+#define W25Q128_LOG_RECORD_MAGIC     0x4C52               // "LR"
+#define LOG_RECORD_VALID             0xFE
+#define LOG_RECORD_SUPERSEDED        0x00
+#define W25Q128_GC_RESERVE_SECTORS   2
+#define W25Q128_GC_DEAD_THRESHOLD    (W25Q128_SECTOR_SIZE / 2)
+
+#define W25Q128_CHECKPOINT_MAGIC     0x57494458           // "WIDX"
+#define W25Q128_CHECKPOINT_SECTORS   32                   // Two slots at the top of the chip
+#define W25Q128_CHECKPOINT_SLOT_SECTORS (W25Q128_CHECKPOINT_SECTORS / 2)
+#define W25Q128_CHECKPOINT_INTERVAL_SECTORS 64
+#define W25Q128_LOG_SECTORS          (W25Q128_FLASH_SIZE / W25Q128_SECTOR_SIZE - W25Q128_CHECKPOINT_SECTORS)
+
+struct __attribute__((packed)) LogSectorHeader {
+    uint32_t magic;           // W25Q128_LOG_SECTOR_MAGIC
+    uint32_t sequence;        // Order the sector was opened in
+    uint32_t next_sector;     // Programmed when the head moves on; erased until then
+    uint32_t reserved;        // Left erased
+};
+
+struct __attribute__((packed)) LogRecordHeader {
+    uint16_t magic;           // W25Q128_LOG_RECORD_MAGIC; erased (0xFFFF) ends the sector
+    uint8_t state;            // LOG_RECORD_VALID or LOG_RECORD_SUPERSEDED
+    uint8_t reserved;
+    uint32_t checksum;        // CRC32 of everything after this field
     uint32_t storage_key;     // Extended CAN ID as key
-    uint32_t data_size;       // Size of data in bytes
-    uint32_t checksum;        // CRC32 checksum of data
-    uint32_t timestamp;       // Timestamp when written
-    uint8_t data[];           // Variable length data
+    uint16_t data_size;       // Size of data in bytes
+    uint16_t padding;
+    uint8_t data[];           // Variable length data; none for a tombstone
+};
+
+// Checkpoint slot: header, then the payload - allocation bitmap
+// (W25Q128_LOG_SECTORS bits), live bytes and dead bytes per log sector
+// (uint16 each), and entry_count IndexCheckpointEntry
+struct __attribute__((packed)) IndexCheckpointHeader {
+    uint32_t magic;           // W25Q128_CHECKPOINT_MAGIC
+    uint32_t generation;      // Higher is newer
+    uint32_t entry_count;
+    uint32_t sector_count;    // Allocated sectors in the bitmap
+    uint32_t head_sector;     // Replay starts at head_sector / head_offset
+    uint32_t head_offset;
+    uint32_t head_sequence;
+    uint32_t payload_checksum;
+    uint32_t header_checksum; // CRC32 of the fields above
+};
+
+// =============================================================================
+// Fixed Pools
+// =============================================================================
+/* The key -> record index and the write cache are fixed-capacity pools
+ * allocated once in begin() (on the Teensy that puts them in OCRAM), so no
+ * storage call allocates afterwards and RAM cannot fragment over a long
+ * session.
+ *
+ * Index: open addressing with linear probing over W25Q128_INDEX_SLOTS
+ * slots, kept at most half full; deletes shift the probe run back instead
+ * of leaving tombstones. A write of a new key beyond
+ * W25Q128_INDEX_CAPACITY keys fails with "Index full".
+ *
+ * Write cache: W25Q128_CACHE_ENTRIES values of up to
+ * W25Q128_CACHE_VALUE_SIZE bytes, found by a short linear scan. Larger
+ * values go straight to flash. A full cache is flushed and emptied.
+ *
+ * Checkpoints stream through a page buffer rather than a heap copy of
+ * the payload. The one allocation left after begin() is the temporary
+ * sector list of a whole-log scan, which only runs inside begin().
+ */
+#ifndef W25Q128_INDEX_CAPACITY
+#define W25Q128_INDEX_CAPACITY       2048                 // Keys; power of two
+#endif
+#define W25Q128_INDEX_SLOTS          (2 * W25Q128_INDEX_CAPACITY)
+#define W25Q128_CACHE_ENTRIES        32
+#define W25Q128_CACHE_VALUE_SIZE     64
+#define W25Q128_EMPTY_KEY            0xFFFFFFFF           // Never a 29-bit CAN ID
+
+struct __attribute__((packed)) IndexCheckpointEntry {
+    uint32_t storage_key;
+    uint32_t address;
+    uint16_t size;            // Aligned record size
 };
 
 // =============================================================================
@@ -82,6 +256,19 @@ public:
     bool deleteData(uint32_t storage_key) override;
     bool hasData(uint32_t storage_key) override;
     
+    // Blobs are single records read and written piecewise: up to
+    // MAX_DATA_SIZE, loaded straight into the segments. On a failed read
+    // the segments may hold part of the record.
+    bool writeBlob(uint32_t storage_key, const StorageSegment* segments, uint8_t count) override;
+    bool readBlob(uint32_t storage_key, const StorageSegment* segments, uint8_t count) override;
+    
+    // Batches. Reads take cache hits first, then the rest in flash address
+    // order, fetching neighbouring records with one read. Writes bypass the
+    // cache and append back to back; small records are staged and
+    // programmed a page at a time rather than header and data separately.
+    uint8_t readMany(StorageItem* items, uint8_t count) override;
+    uint8_t writeMany(StorageItem* items, uint8_t count) override;
+    
     // Storage management
     uint32_t getTotalSpace() override;
     uint32_t getFreeSpace() override;
@@ -90,10 +277,12 @@ public:
     // Maintenance
     void sync() override;
     void flush() override;
+    void poll() override;
     
     // Optional iteration support
     uint32_t getStoredKeyCount() override;
     bool getStoredKey(uint32_t index, uint32_t* storage_key) override;
+    uint32_t listKeys(uint32_t after_key, uint32_t mask, uint32_t match, uint32_t* keys, uint32_t max) override;
     
     // Debug/information
     void printDebugInfo() override;
@@ -112,6 +301,40 @@ public:
     uint32_t getCacheHitRate();
     void clearCache();
     
+    // Asynchronous flash operations (see overview). A program must not
+    // cross a page. Returns false for a bad address or length.
+    bool submitProgram(uint32_t address, const uint8_t* data, size_t length,
+                       FlashOperationCallback callback = nullptr, void* context = nullptr);
+    bool submitErase(uint32_t sector_address, FlashOperationCallback callback = nullptr, void* context = nullptr);
+    bool waitForOperations();           // Blocks until the queue is empty; false if any failed
+    uint8_t getPendingOperations();     // Queued, including the running one
+    uint32_t getCompletedOperations();
+    uint32_t getReadSuspendCount();     // Reads served while an erase was suspended
+    uint32_t getQueueFullWaits();
+    uint32_t getFlashReadCount();       // Read commands (or window copies) issued
+    
+    // Zero-copy read of a value on flash (memory-mapped builds only; see
+    // overview). releaseData() is optional - the next backend call does it.
+    bool mapData(uint32_t storage_key, const void** data, size_t* size);
+    void releaseData();
+    bool isMemoryMapped();
+    
+    // Pool capacity and high-water marks
+    uint32_t getIndexCapacity();
+    uint32_t getIndexCount();
+    uint32_t getIndexHighWater();
+    uint32_t getCacheCapacity();
+    uint32_t getCacheHighWater();
+    
+    // Log maintenance: reclaim up to max_sectors sectors, returns how many
+    uint32_t collectGarbage(uint32_t max_sectors);
+    bool writeCheckpoint();
+    uint32_t getSectorEraseCount();
+    uint32_t getRecordsWritten();
+    uint32_t getLiveBytes();
+    uint32_t getCheckpointCount();
+    uint32_t getBootScannedSectors();   // Sectors whose records begin() had to read
+    
     // Error handling
     uint32_t getErrorCount();
     void clearErrors();
@@ -122,6 +345,10 @@ private:
     const ECUConfiguration& ecu_config;
     uint8_t cs_pin;
     uint32_t spi_frequency;
+    bool memory_mapped;                 // Chip on FlexSPI2 rather than LPSPI
+    const uint8_t* mapped_flash;        // Read window, or nullptr
+    bool map_held;                      // A mapData() pointer is out
+    bool map_suspended;                 // ...and an erase is suspended for it
     
     // Flash state
     bool flash_initialized;
@@ -129,17 +356,20 @@ private:
     uint32_t total_sectors;
     uint32_t used_sectors;
     
-    // Performance cache
+    // Performance cache: W25Q128_CACHE_ENTRIES, in use ones first
     struct CacheEntry {
         uint32_t storage_key;
-        std::vector<uint8_t> data;
         uint32_t timestamp;
+        uint16_t size;
         bool dirty;
+        uint8_t data[W25Q128_CACHE_VALUE_SIZE];
     };
     
-    std::unordered_map<uint32_t, CacheEntry> write_cache;
+    CacheEntry* write_cache;
+    uint16_t cache_count;
+    uint16_t cache_limit;               // Entries allowed by setCacheSize()
+    uint16_t cache_high_water;
     bool cache_enabled;
-    uint32_t cache_size_limit;
     uint32_t cache_hits;
     uint32_t cache_misses;
     
@@ -154,39 +384,167 @@ private:
     void spiTransfer(const uint8_t* data, uint8_t* result, size_t length);
     void spiWrite(const uint8_t* data, size_t length);
     
-    // Flash command methods
+    // Flash command methods. flashCommand() sends one command on whichever
+    // bus the chip is on: opcode, optional 24-bit address, then length
+    // bytes from tx or into rx.
+    void flashCommand(uint8_t opcode, uint32_t address, bool addressed,
+                      const uint8_t* tx, uint8_t* rx, size_t length);
     void writeEnable();
     void writeDisable();
     bool waitForWriteComplete();
     uint8_t readStatus();
     void writeStatus(uint8_t status);
     
-    // Flash operation methods
-    bool readPage(uint32_t page_address, uint8_t* buffer, size_t length);
-    bool writePage(uint32_t page_address, const uint8_t* buffer, size_t length);
+    // Flash operation methods (byte addresses). Programs and sector erases
+    // are queued; readPage() waits only for queued operations it overlaps.
+    bool readPage(uint32_t address, uint8_t* buffer, size_t length);
+    bool programBytes(uint32_t address, const uint8_t* buffer, size_t length);  // Any length
     bool eraseSector(uint32_t sector_address);
     bool eraseBlock(uint32_t block_address);
     
+    // Operation queue
+    struct FlashOperation {
+        uint8_t type;                   // FLASH_OP_*
+        uint16_t length;                // Program only
+        uint32_t address;
+        FlashOperationCallback callback;
+        void* context;
+        uint8_t data[W25Q128_PAGE_SIZE];
+    };
+    FlashOperation* queueOperation();
+    void startOperation();
+    void completeOperation(bool success);
+    bool finishRunningOperation();      // Blocking
+    bool chipBusy();
+    void completeOverlapping(uint32_t address, size_t length);
+    bool suspendErase();
+    void resumeErase();
+    
     // Storage management methods
     uint32_t findStorageEntry(uint32_t storage_key);
-    bool writeStorageEntry(uint32_t storage_key, const void* data, size_t dataSize);
-    bool readStorageEntry(uint32_t storage_key, void* data, size_t dataSize);
+    bool writeStorageEntry(uint32_t storage_key, const StorageSegment* segments, uint8_t count);
+    bool readStorageEntry(uint32_t storage_key, const StorageSegment* segments, uint8_t count);
     bool deleteStorageEntry(uint32_t storage_key);
     
+    // Log methods
+    struct RecordLocation {
+        uint32_t address;
+        uint16_t size;                  // Aligned record size
+    };
+    struct IndexSlot {
+        uint32_t storage_key;           // W25Q128_EMPTY_KEY when free
+        RecordLocation location;
+    };
+    bool reserveRecord(uint32_t size, uint32_t* address);
+    bool finishRecord(uint32_t address, uint32_t size, bool programmed, RecordLocation* location);
+    void buildRecordHeader(LogRecordHeader* header, uint32_t storage_key, const StorageSegment* segments, uint8_t count);
+    bool appendRecord(uint32_t storage_key, const StorageSegment* segments, uint8_t count, RecordLocation* location);
+    void indexRecord(uint32_t storage_key, const RecordLocation& location);
+    bool checkRecord(const uint8_t* record, uint32_t storage_key, size_t dataSize);   // A copy in RAM
+    bool relocateRecord(const RecordLocation& from, RecordLocation* to);
+    void supersedeRecord(const RecordLocation& location);
+    void retireRecord(const RecordLocation& location);
+    bool openSector();
+    bool reclaimSector(uint32_t sector);
+    uint32_t findGarbageSector();
+    uint32_t scanSector(uint32_t sector, uint32_t offset);
+    bool verifyRecord(uint32_t address, const LogRecordHeader& header);
+    bool sectorHeaderErased(uint32_t sector);
+    
+    // Index checkpoint methods
+    size_t checkpointPayloadSize(uint32_t sector_count, uint32_t entry_count);
+    bool loadCheckpoint(IndexCheckpointHeader* header);
+    bool replayLog(const IndexCheckpointHeader& header);
+    void scanWholeLog();
+    void resetIndex();
+    
+    // Pool methods
+    bool allocatePools();
+    IndexSlot* findRecord(uint32_t storage_key);
+    IndexSlot* insertRecord(uint32_t storage_key);      // Existing or new; nullptr when full
+    void eraseRecord(IndexSlot* record);
+    void clearRecords();
+    CacheEntry* findCacheEntry(uint32_t storage_key);
+    void removeCacheEntry(uint32_t storage_key);
+    
+    // Batched writes: records reserved back to back in the active sector,
+    // assembled here and programmed together
+    struct StagedRecords {
+        uint8_t page[W25Q128_PAGE_SIZE];
+        uint32_t address;               // Flash address of page[0]
+        size_t fill;
+        uint8_t items[W25Q128_PAGE_SIZE / sizeof(LogRecordHeader)];
+        uint8_t count;
+    };
+    uint8_t commitStaged(StagedRecords& staged, StorageItem* items);
+    
+    // Checkpoint payload streaming through one page buffer
+    struct PayloadStream {
+        uint8_t page[W25Q128_PAGE_SIZE];
+        uint32_t address;               // Next flash byte
+        uint32_t end;                   // Reading: end of the payload
+        size_t fill;
+        size_t pos;                     // Reading: next buffered byte
+        uint32_t crc;
+        bool ok;
+    };
+    void streamWrite(PayloadStream& stream, const void* data, size_t length);
+    bool streamFlush(PayloadStream& stream);
+    bool streamRead(PayloadStream& stream, void* data, size_t length);
+    
     // Utility methods
-    uint32_t calculateChecksum(const void* data, size_t length);
+    uint32_t calculateChecksum(const void* data, size_t length, uint32_t crc = 0);
+    uint32_t recordSize(size_t dataSize);
     uint32_t findFreeSector();
-    void updateSectorMap();
     void rebuildIndex();
     
     // Sector allocation tracking
     std::vector<bool> sector_allocated;
-    std::unordered_map<uint32_t, uint32_t> key_to_sector;
+    std::vector<uint16_t> sector_live_bytes;
+    std::vector<uint16_t> sector_dead_bytes;
+    IndexSlot* index_slots;             // W25Q128_INDEX_SLOTS
+    uint32_t index_count;
+    uint32_t index_high_water;
+    
+    // Write head
+    uint32_t active_sector;
+    uint32_t write_offset;              // Next record offset in the active sector
+    uint32_t next_sequence;
+    bool collecting;                    // Garbage collection may use the reserve
+    
+    // Checkpoint state
+    std::vector<bool> sector_uncheckpointed;    // Holds records newer than the checkpoint
+    uint32_t sectors_since_checkpoint;
+    uint32_t checkpoint_generation;     // 0 = none
+    uint32_t checkpoint_sectors;        // Sectors the current checkpoint occupies
+    uint32_t checkpoints_written;
+    uint32_t boot_scanned_sectors;
+    
+    // Log statistics
+    uint32_t sector_erases;
+    uint32_t records_written;
+    
+    // Operation queue state
+    FlashOperation op_queue[W25Q128_OP_QUEUE_SIZE];
+    uint8_t op_head;
+    uint8_t op_count;
+    bool op_running;                    // The head operation is on the chip
+    uint32_t op_started_ms;
+    uint32_t ops_completed;
+    uint32_t read_suspends;
+    uint32_t queue_full_waits;
+    uint32_t flash_reads;
+    
+#ifdef TESTING
+    // Desktop builds have no chip behind the SPI mock: flash operations act
+    // on this image with NOR semantics (program clears bits, erase sets them)
+    std::vector<uint8_t> mock_flash;
+    uint32_t mock_busy_until_us;        // The running operation finishes at this micros()
+#endif
     
     // Constants
-    static const uint32_t STORAGE_MAGIC = 0x57463132;  // "WF12"
-    static const uint32_t MAX_CACHE_SIZE = 1024 * 1024; // 1MB cache limit
-    static const uint32_t MAX_DATA_SIZE = W25Q128_PAGE_SIZE - sizeof(StorageEntry);
+    static const uint32_t MAX_DATA_SIZE = W25Q128_SECTOR_SIZE - sizeof(LogSectorHeader) - sizeof(LogRecordHeader);
+    static const uint32_t NOT_FOUND = 0xFFFFFFFF;      // No sector or record
 };
 
 #endif // W25Q128_STORAGE_BACKEND_H 
\ No newline at end of file